@@ -4,12 +4,15 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 #include <arpa/inet.h>
 
 #include "canada_compress.h"
 
 static void pack(uint32_t m, uint32_t *y, unsigned char *b, int *j);
 static void unpack(uint32_t m, uint32_t *y, unsigned char *b, int *j);
+static int widths(unsigned char *b, int i, int *w);
 
 static int corrupt = 0;
 
@@ -851,3 +854,145 @@ canada_uncompress(unsigned char *b, uint32_t *y, int *n, int m, uint32_t *v0)
 
   return CANCOMP_SUCCESS;
 }
+
+/*
+ * bits/sample of the five groups of 4 samples in the 20-sample block i,
+ * from its 2 index bytes. Returns the number of packed bytes in the block.
+ */
+static int
+widths(unsigned char *b, int i, int *w)
+{
+  uint32_t x;
+
+  if (b[2*i] >= 0x80) {
+    x = ((b[2*i] & 0x7f) << 8) | b[2*i + 1];
+    w[0] = ((x >> 10) & 0x1c) + 4;
+    w[1] = ((x >> 7) & 0x1c) + 4;
+    w[2] = ((x >> 4) & 0x1c) + 4;
+    w[3] = ((x >> 1) & 0x1c) + 4;
+    w[4] = ((x << 2) & 0x1c) + 4;
+  }
+  else {
+    x = (b[2*i] << 8) | b[2*i + 1];
+    w[0] = ((x >> 11) & 0xe) + 4;
+    w[1] = ((x >> 8) & 0xe) + 4;
+    w[2] = ((x >> 5) & 0xe) + 4;
+    w[3] = ((x >> 2) & 0xe) + 4;
+    w[4] = ((x << 1) & 0xe) + 4;
+  }
+  /*
+   * 4 samples of m bits are m/2 bytes
+   */
+  return (w[0] + w[1] + w[2] + w[3] + w[4]) / 2;
+}
+
+#define BE64(p) ( (uint64_t)(p)[0] << 56 | (uint64_t)(p)[1] << 48 \
+		| (uint64_t)(p)[2] << 40 | (uint64_t)(p)[3] << 32 \
+		| (uint64_t)(p)[4] << 24 | (uint64_t)(p)[5] << 16 \
+		| (uint64_t)(p)[6] << 8 | (uint64_t)(p)[7] )
+
+/*
+ * unpack the 20 samples of a block from p into d. Each group of 4 samples
+ * starts on a byte. The first two samples are in the 8 bytes at the start
+ * of the group and the last two in the 8 bytes at the byte holding bit
+ * 2*m, so 8 bytes past the middle of the last group must be readable.
+ */
+static void
+unpack20(unsigned char *p, int *w, uint32_t *d)
+{
+  int l, m, r;
+  uint64_t x;
+  uint32_t sign;
+
+  for (l = 0; l < 5; l++, d += 4) {
+    m = w[l];
+    r = 64 - m;
+    sign = (uint32_t)1 << (m - 1);
+
+    x = BE64(p);
+    d[0] = (uint32_t)(x >> r);
+    d[1] = (uint32_t)((x << m) >> r);
+    x = BE64(p + (m >> 2)) << ((m & 3) << 1);
+    d[2] = (uint32_t)(x >> r);
+    d[3] = (uint32_t)((x << m) >> r);
+
+    d[0] = (d[0] ^ sign) - sign;
+    d[1] = (d[1] ^ sign) - sign;
+    d[2] = (d[2] ^ sign) - sign;
+    d[3] = (d[3] ^ sign) - sign;
+    p += m / 2;
+  }
+}
+
+/*
+ * Uncompresses samples start to start+npts-1 of the m samples in n bytes
+ * of compressed data b into y, in host byte order. m must be what was
+ * passed to canada_compress.
+ *
+ * The index gives the size of each block, so no blocks after the window
+ * are read. The blocks before the window are unpacked only to carry the
+ * sums that undo the differences.
+ */
+int
+canada_uncompress_window(unsigned char *b, int n, int m, int start, int npts,
+			 int32_t *y)
+{
+  int i, j, k, l, len, end, w[5];
+  uint32_t x, d1, s, t, d[20];
+  unsigned char tmp[96];
+
+  if (m % 20) return CANCOMP_NOT_20;
+  if (start < 0 || npts < 0 || start + npts > m) return CANCOMP_CORRUPT;
+
+  end = start + npts;
+
+  /*
+   * get first sample
+   */
+  j = m / 10;
+  if (j + 4 > n) return CANCOMP_EXCEED;
+  x = ((uint32_t)b[j] << 24) | (b[j + 1] << 16) | (b[j + 2] << 8) | b[j + 3];
+  j += 4;
+
+  d1 = 0;
+  for (i = 0, k = 0; k < end; i++, k += 20, j += len) {
+    len = widths(b, i, w);
+    if (j + len > n) return CANCOMP_EXCEED;
+
+    if (j + len + 8 <= n) {
+      unpack20(b + j, w, d);
+    }
+    else {
+      /*
+       * near the end of b, unpack from a padded copy
+       */
+      memset(tmp, 0, sizeof(tmp));
+      memcpy(tmp, b + j, len);
+      unpack20(tmp, w, d);
+    }
+
+    if (k + 20 <= start) {
+      /*
+       * the window starts in a later block. After the 20 steps of
+       * d1 += d[l], x += d1, x has grown by 20*d1 + sum (20-l)*d[l].
+       */
+      for (l = 0, s = t = 0; l < 20; l++) {
+	s += d[l];
+	t += (20 - l) * d[l];
+      }
+      x += 20 * d1 + t;
+      d1 += s;
+    }
+    else {
+      /*
+       * undo the second difference, then the first
+       */
+      for (l = 0; l < 20; l++) {
+	d1 += d[l];
+	if (k + l >= start && k + l < end) y[k + l - start] = (int32_t)x;
+	x += d1;
+      }
+    }
+  }
+  return CANCOMP_SUCCESS;
+}
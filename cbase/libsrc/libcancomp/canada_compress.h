@@ -1,6 +1,7 @@
 #ifndef _CANADA_COMPRESS_H
 #define _CANADA_COMPRESS_H
 
+#include <inttypes.h>
 #include <arpa/inet.h>
 
 #define CANCOMP_ERR	-1  /* unrecoverable error (malloc fails) */
@@ -14,5 +15,7 @@ int canada_uncompress(unsigned char *b, uint32_t *y, int *n, int m,
                       uint32_t *v0);
 int canada_compress(unsigned char *b, uint32_t *y, int *n, int m,
                     uint32_t *v0);
+int canada_uncompress_window(unsigned char *b, int n, int m, int start,
+                             int npts, int32_t *y);
 
 #endif /* ! _CANADA_COMPRESS_H */
@@ -14,6 +14,30 @@ int running_avg( float *data, int *state, int npts,
 		int len, int thresh, double (*fp)(double),
 		float *avg, int *avg_state );
 
+/* from detect_stream.c */
+typedef struct Detect_Stream Detect_Stream;
+
+typedef struct
+{
+	int	onset;		/* 1 for a trigger onset, 0 for an offset */
+	long	sample;		/* sample index from the start of the stream */
+	float	snr;		/* snr at onset, peak snr for an offset */
+} Detect_Event;
+
+Detect_Stream *detect_stream_create( double comp_thr, int stav_len,
+		int ltav_len, char *stav_meas, char *stav_method,
+		int stav_thresh, int ltav_thresh, char *snr_method,
+		double on_snr, double off_snr );
+int detect_stream_process( Detect_Stream *ds, float *data, float *norm,
+		int npts );
+int detect_stream_flush( Detect_Stream *ds );
+int detect_stream_process_channels( Detect_Stream **ds, int nchan,
+		float **data, float **norm, int *npts, int nthreads );
+int detect_stream_output( Detect_Stream *ds, long *first_sample,
+		float **snr, float **stav, float **ltav );
+int detect_stream_events( Detect_Stream *ds, Detect_Event **events );
+void detect_stream_reset( Detect_Stream *ds );
+void detect_stream_free( Detect_Stream *ds );
 
 
 
@@ -44,6 +44,40 @@ extern void dist_azimuth_(double	*flat1,
 			  double	*azi,
 			  double	*baz);
 
+/*
+ * Geocentric unit vectors of a set of points for dist_azimuth_batch().
+ * u is the unit vector, e and n the local east and north vectors (ez = 0).
+ */
+typedef struct geog_points {
+	int	n;
+	double	*lat;		/* geographic latitude (deg) */
+	double	*lon;		/* longitude (deg) */
+	double	*ux, *uy, *uz;
+	double	*ex, *ey;
+	double	*nx, *ny, *nz;
+} Geog_Points;
+
+extern Geog_Points *geog_points(double	*lat,
+				double	*lon,
+				int	n);
+extern void free_geog_points(Geog_Points *p);
+extern int dist_azimuth_batch(Geog_Points	*sta,
+			      Geog_Points	*ev,
+			      double		*delta,
+			      double		*azi,
+			      double		*baz,
+			      int		num_threads);
+extern int dist_azimuth_matrix(double	*slat,
+			       double	*slon,
+			       int	nsta,
+			       double	*elat,
+			       double	*elon,
+			       int	nev,
+			       double	*delta,
+			       double	*azi,
+			       double	*baz,
+			       int	num_threads);
+
 extern int read_ellip_corr_tables(char	*dir_prefix,
 				  char	**phase_list,
 				  int	num_phases);
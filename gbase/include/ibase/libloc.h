@@ -40,6 +40,43 @@ extern int locate_event(Site		*sites,
 			Ar_Info		*ar_info,
 			int		num_obs);
 
+/*
+ * One event of a batch for locate_events().  The arrival, assoc, origin,
+ * origerr and ar_info arguments are those of locate_event().
+ */
+typedef struct loc_event {
+	Arrival		*arrival;	/* (i) Arrivals of the event */
+	Assoc		*assoc;		/* (i/o) Assocs, in arrival order */
+	Origin		*origin;	/* (i/o) Origin */
+	Origerr		*origerr;	/* (i/o) Origin errors */
+	Ar_Info		*ar_info;	/* (o) Arrival-based location info */
+	int		num_obs;	/* (i) Number of arrival/assoc records */
+	int		num_iter;	/* (o) Number of iterations performed */
+	int		ierr;		/* (o) Return of locate_event() */
+} Loc_Event;
+
+extern int locate_events(Site		*sites,
+			 int		num_sites,
+			 Loc_Event	*events,
+			 int		num_events,
+			 Locator_params	*locator_params,
+			 Loc_Grid	*grid,
+			 int		num_threads);
+
+extern int grid_search_location(Site		*sites,
+				int		num_sites,
+				Arrival		*arrival,
+				Assoc		*assoc,
+				int		num_obs,
+				Locator_params	*locator_params,
+				Loc_Grid	*grid,
+				int		num_threads,
+				double		*lat,
+				double		*lon,
+				double		*otime);
+
+extern Loc_Grid initialize_loc_grid(void);
+
 extern void predsat(Locator_params	*locator_params,
 		    Site		*sites,
 		    int		num_sta,
@@ -87,6 +124,14 @@ extern int  setup_tttables(	char		*vmodel_filename,
 				char		**phase_types,
 				int		num_phase_types);
 
+extern int compile_tt_tables(char		*vmodel_filename,
+			     char		**phase_list,
+			     int		num_phases);
+
+extern int remove_compiled_tt_tables(char	*vmodel_filename,
+				     char	**phase_list,
+				     int	num_phases);
+
 extern int get_srst_region_number(void);
 
 extern int get_tt_indexes(char		*phase,
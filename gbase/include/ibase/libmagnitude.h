@@ -39,6 +39,22 @@ extern int calc_mags(MAGNITUDE  *magn_ptr,
 		     Origin	   *origin,
 		     Mag_Params *mag_params);
 
+/*
+ * One origin of a batch for calc_mags_batch().  The magn_ptr, num_magns
+ * and origin arguments are those of calc_mags().
+ */
+typedef struct mag_event {
+	MAGNITUDE	*magn_ptr;	/* (i/o) Magnitude objects of the origin */
+	int		num_magns;	/* (i) Number of elements in magn_ptr */
+	Origin		*origin;	/* (i/o) Origin */
+	int		ret;		/* (o) Return of calc_mags() */
+} Mag_Event;
+
+extern int calc_mags_batch(Mag_Event	*events,
+			   int		num_events,
+			   Mag_Params	*mag_params,
+			   int		num_threads);
+
 extern MAGNITUDE *build_mag_obj(
 				char	**list_of_magtypes, 
 				int	num_magtypes,
@@ -226,6 +242,8 @@ extern SM_Info initialize_sm_info(void);
 
 extern void free_tl_table(void);
 
+extern int compile_tl_tables(void);
+
 extern double get_delta_for_sta(char	*sta,
 				double	ev_lat,
 				double	ev_lon);
@@ -99,6 +99,24 @@ typedef struct locator_params
 						 travel-time tables           */
 } Locator_params;
 
+/*
+ * The Loc_Grid structure describes the coarse grid of trial epicenters
+ * searched by grid_search_location() for a starting location, as an
+ * alternative to best_guess().
+ */
+
+typedef struct loc_grid
+{
+				     /* DEFAULT- DESCRIPTION                  */
+	double	lat_min;	     /* -90.0  - Southern grid edge (deg)     */
+	double	lat_max;	     /* 90.0   - Northern grid edge (deg)     */
+	double	lon_min;	     /* -180.0 - Western grid edge (deg)      */
+	double	lon_max;	     /* 180.0  - Eastern grid edge (deg)      */
+	double	spacing;	     /* 5.0    - Node spacing (deg)           */
+	double	depth;		     /* 0.0    - Trial depth (km), unless
+						 depth_init is set            */
+} Loc_Grid;
+
 
 /*
  * The ar_info (arrival information) structure is used to store extended
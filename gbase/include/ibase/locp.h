@@ -24,6 +24,7 @@
 #include "origerr_Astructs.h"
 #include "arrival_Astructs.h"
 #include "assoc_Astructs.h"
+#include "ar_sasc.h"
 
 typedef struct LM_params {
    Origin          *origin;
@@ -61,6 +62,30 @@ typedef struct SOLUTION {
    int             nd;
 } best_solution;
 
+/*
+ * Working state of the locator for the calling thread.  Everything that
+ * changes from one event to the next is kept here instead of in file-scope
+ * variables, so that several events can be located at once in different
+ * threads.  The travel-time, SSSC, SASC and radial 2-D tables are read by
+ * setup_tt_facilities() and friends and are only read by the locator.
+ */
+typedef struct loc_state {
+   Ar_Info         tt_info;		/* trv_time_specific.c */
+   double          save_ev_lat;
+   double          ev_geoc_co_lat;
+   double          default_save_ev_lat;	/* trv_time_default.c */
+   double          default_ev_geoc_co_lat;
+   double          ec_save_ev_colat;	/* get_ec_from_table() */
+   double          ec_sc0;
+   double          ec_sc1;
+   double          ec_sc2;
+   Ar_SASC         *active_ar_sasc;	/* az_slow_corr.c */
+   int             ar_sasc_cnt;
+   int             srst_region_number;	/* srst.c */
+   int             hydro_per_index;	/* tt_info.c */
+   int             infra_per_index;
+} Loc_State;
+
 
 extern int compute_hypo(Origin		**w_origin,
 			Origerr		**w_origerr,
@@ -213,6 +238,26 @@ extern double crude_but_quick_trv_time(
 extern int read_ec_table(char		*file_name,
 			 EC_Table	**ec_table_ptr);
 
+extern int write_compiled_tt_tables(char		*file_name,
+				    char		*vmodel,
+				    TT_Table		*tt_table,
+				    List_of_Phases	*list_of_phases,
+				    int			num_ec_phases);
+
+extern TT_Compiled *open_compiled_tt_tables(char	*dir_pathway,
+					    char	*vmodel);
+
+extern int read_compiled_tt_table(TT_Compiled	*ttc,
+				  char		*file_name,
+				  char		*phase,
+				  Bool		want_ec,
+				  TT_Table	*tt_table);
+
+extern void release_compiled_tt_tables(TT_Compiled *ttc);
+
+extern void free_tt_table(TT_Table	*tt_table,
+			  Bool		free_ec_table);
+
 extern double get_ec_from_table(
 				EC_Table	*ec_table,
 				double		delta,
@@ -270,6 +315,12 @@ extern int get_resids_and_derivs(lm_params	*params,
 
 extern int last_leg(char *phase);
 
+extern Loc_State *loc_state(void);
+
+extern void loc_lock(void);
+
+extern void loc_unlock(void);
+
 extern double ddot(int n, double *dx, int incx, double *dy,int incy);
 
 extern double dnrm2(int n, double *dx, int incx);
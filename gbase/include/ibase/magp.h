@@ -61,6 +61,21 @@ extern int only_bound_amps(SM_Sub	*sm_sub,
 			   double	*net_mag,
 			   double	*sigmax);
 
+extern int tl_table_file_name(char	*dir_pathway,
+			      char	*TLtype,
+			      char	*tl_model,
+			      char	*phase,
+			      char	*chan,
+			      char	*file_name);
+
+extern int write_compiled_tl_table(char	*file_name,
+				   TL_Table	*tl_table);
+
+extern int read_compiled_tl_table(char	*file_name,
+				  TL_Table	*tl_table);
+
+extern void free_tl_table_entry(TL_Table	*tl_table);
+
 
 #endif /* _MAGP_H_ */
 
@@ -23,6 +23,7 @@
 #define	TLreadErr5	 6
 #define	TLreadErr6	 7
 #define	TLreadErr7	 8
+#define	TLwriteErr1	 9
 
 #endif /* _TL_DEFS_H_ */
 
@@ -42,6 +42,7 @@ typedef	struct	tl_ts_cor {
 
 
 typedef	struct	tl_table	TL_Table;
+typedef	struct	tl_compiled	TL_Compiled;	/* compiled_tl_table.c */
 
 struct tl_table {
 	char		TLtype[9];
@@ -57,6 +58,7 @@ struct tl_table {
 	TL_Mdl_Err	*tl_mdl_err;
 	int		num_ts_regions;
 	TL_TS_Cor	*tl_ts_cor;
+	TL_Compiled	*compiled;	/* Compiled file holding the arrays, or NULL */
 } ;
 
 typedef	struct	list_of_phz	List_of_Phz;
@@ -40,8 +40,6 @@ typedef struct {
 
 typedef struct {
 	double 		H_T_convert;
-	int		current_hydro_per_index;
-	int		current_infra_per_index;
 	Bool		initiated;
 	Bool		epoch_time_set;
 	Bool		use_hydro_2D_table;
@@ -42,6 +42,8 @@ typedef	struct	model_error {
 
 typedef	struct	tt_table	TT_Table;
 
+typedef	struct	tt_compiled	TT_Compiled;	/* compiled_tt_tables.c */
+
 struct tt_table {
 	char		phase[9];
 	char		vmodel[16];
@@ -54,6 +56,7 @@ struct tt_table {
 	float		**trv_time;
 	EC_Table	*ec_table;
 	Model_Error	*model_error;
+	TT_Compiled	*compiled;	/* Compiled file holding the arrays, or NULL */
 } ;
 
 typedef	struct	list_of_phases	List_of_Phases;
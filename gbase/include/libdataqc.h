@@ -69,6 +69,10 @@ typedef struct qc_mask
 } QCMask, *QCMaskP;
 
 
+/* basic quality control state for one data vector read in blocks */
+typedef struct qc_stream QCStream;
+
+
 /* from qc.c */
 extern	int qc_basic(float **data, int *npts, int ndata,
 				QCDef *def, QCMask **mask);
@@ -98,6 +102,13 @@ extern int qc_check_mask(double tdata, double	tdataend,
 				   double tstart, double  tend, double tlen);
 extern int qc_count_mask_points(QCMask *mask);
 
+/* from qc_stream.c */
+extern QCStream *qc_stream_create(QCDef *def);
+extern int qc_stream_process(QCStream *qs, float *data, int npts);
+extern int qc_stream_channels(QCStream **qs, int nchan, float **data,
+				int *npts);
+extern int qc_stream_finish(QCStream *qs, QCMask *mask);
+extern void qc_stream_destroy(QCStream *qs);
 
 extern int qc_wfm_basic(Wfmem *wfm, int nwfm, 
 				  QCDef *def, QCMask **mask);
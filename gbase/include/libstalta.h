@@ -61,6 +61,41 @@ typedef struct
 	/* parameters for grouping detections from the different bands */
 } StaLtaParam;
 
+typedef struct
+{
+	int	chan;		/* channel index */
+	long	ontime;		/* trigger on, samples from the stream start */
+	long	offtime;	/* trigger off, samples from the stream start */
+	double	maxratio;	/* maximum sta/lta during the trigger */
+} StaLtaTrigger;
+
+/* running state of stalta() for nchan channels read a block at a time */
+typedef struct
+{
+	int	nchan;
+	int	sta, lta, buf, wtrig, trgsep, method;
+	double	htrig, ltrig;
+
+	int	mask;		/* ring length - 1 */
+	float	*ring;		/* ring[(k & mask)*nchan + chan] = sample k */
+	long	n;		/* samples received on each channel */
+
+	double	*tsta;
+	double	*tlta;
+	double	*ratio;
+	double	*tmaxratio;
+	int	*trig;
+	long	*tontime;
+	int	*pending;	/* a trigger that trgsep may still reopen */
+	long	*pend_on;
+	long	*pend_off;
+	double	*pend_max;
+
+	StaLtaTrigger	*triggers;	/* triggers completed by the last call */
+	int	ntriggers;
+	int	size_triggers;
+} StaLtaStream;
+
 int
 allocStaltaSpace(StaLtaDef * s, int len);
 
@@ -73,6 +108,21 @@ applyStaLtaSamprate(StaLtaDef * staltadef, double tdel);
 int
 stalta(StaLtaDef * s, int n, float *indata);
 
+StaLtaStream *
+newStaLtaStream(StaLtaDef * s, int nchan);
+
+int
+staltaStream(StaLtaStream * ss, int n, float **indata);
+
+int
+staltaStreamFlush(StaLtaStream * ss);
+
+void
+resetStaLtaStream(StaLtaStream * ss);
+
+void
+freeStaLtaStream(StaLtaStream * ss);
+
 int
 loadStaLtaRecipe(char *station, char *recipe_dir, StaLtaParam *p, const char **err_msg);
 
@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <sys/types.h>
 
 /* ****** string.c ********/
 char *	stringToUpper(char *str);
@@ -51,6 +52,41 @@ char *  stringBaseName (const char * pathName);
 int	stringUpperToQuark(const char *s);
 int   stringArg(const char *s, const char *name, char **value);
 
+/* ****** parallel.c ********/
+#define MAX_PARALLEL_THREADS	64
+
+int	parallel_threads(int n, int num_threads);
+void	parallel_run(int n, int num_threads, void (*fn)(int i, void *arg),
+			void *arg);
+void	parallel_run_thread(int n, int num_threads,
+			void (*fn)(int i, int thread, void *arg), void *arg);
+
+/* ****** compiled_file.c ********/
+typedef struct
+{
+	char	magic[8];
+	int	version;
+	int	byte_order;
+} CompiledFileHeader;	/* first member of a compiled file header */
+
+typedef struct
+{
+	char	*base;		/* contents of the file */
+	size_t	size;		/* length of the file */
+	int	mapped;		/* base is mapped rather than read */
+	time_t	mtime;		/* modification time of the file */
+} CompiledFile;
+
+void	compiled_file_header(CompiledFileHeader *h, const char *magic,
+			int version);
+int	compiled_file_open(const char *file_name, const char *magic,
+			int version, size_t header_size, CompiledFile *cf);
+void	compiled_file_close(CompiledFile *cf);
+int	compiled_file_write_floats(FILE *fp, float *x, int n);
+float **compiled_file_rows(float *x, int nrows, int ncols);
+int	compiled_file_add_floats(size_t *nfloats, size_t max_floats,
+			int nrows, int ncols);
+
 /* ****** quark.c ********/
 int	stringToQuark(const char *name);
 int	stringNToQuark(const char *name, int len);
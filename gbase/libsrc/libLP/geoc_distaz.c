@@ -26,8 +26,10 @@
  *	alon1:		Geographic longitude position of point 1 (radians)
  *	alat2:		Geocentric co-latitude position of point 2 (radians)
  *	alon2:		Geographic longitude position of point 2 (radians)
- *	phase_index:	If > 0, 2nd pair of lat/lon coordinates have not 
- *			changed, so, some CPU efficiencies can be achieved 
+ *	phase_index:	No longer used.  The sine and cosine of the 2nd 
+ *			latitude were once saved between calls when this 
+ *			was > 0, which is not safe when called from more 
+ *			than one thread.
 
  *	---- On return ----
  *	delta:		Geocentric distance between points 1 and 2 (radians)
@@ -44,9 +46,7 @@
  *	East azi is measured clockwise from local North.  The first 
  *	lat./lon. pair should represent the station coordinates as a 
  *	general rule.  Thus, the second pair would be the event 
- *	coordinates.  If the 2nd pair of lat/lon coordinates change with 
- *	every event call, simply set phase_index to 0 at every call to 
- *	this function.
+ *	coordinates.
 
  * SEE ALSO
  *	Taken from a similar function, dist_azimuth(), located in 
@@ -86,20 +86,11 @@ geoc_distaz ( double alat1,double  alon1, double alat2, double alon2, double *de
 {
 	double	clat1, cdlon, cdel, rdlon;
 	double	slat1, sdlon, xazi, xbaz, yazi, ybaz;
-	static	double	clat2, slat2;
+	double	clat2, slat2;
 
 
-	/*
-	 * This is optimized to avoid extra sine and cosine calls when 
-	 * alat2 doesn't change between calls (such as looping over a set 
-	 * of stations for a given event).
-	 */
-
-	if (phase_index == 0)
-	{
-		clat2 = cos(alat2);
-		slat2 = sin(alat2);
-	}
+	clat2 = cos(alat2);
+	slat2 = sin(alat2);
 
 	/*
 	 * Simple case when both sets of lat/lons are the same.
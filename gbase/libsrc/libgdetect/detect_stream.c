@@ -0,0 +1,1015 @@
+/*
+ * NAME
+ *
+ *	detect_stream_create
+ *	detect_stream_process
+ *	detect_stream_flush
+ *	detect_stream_process_channels
+ *	detect_stream_output
+ *	detect_stream_events
+ *	detect_stream_reset
+ *	detect_stream_free
+ *
+ * FILE
+ *
+ *	detect_stream.c
+ *
+ * SYNOPSIS
+ *
+ *	Detect_Stream *
+ *	detect_stream_create (comp_thr, stav_len, ltav_len, stav_meas,
+ *			stav_method, stav_thresh, ltav_thresh, snr_method,
+ *			on_snr, off_snr)
+ *	double	comp_thr;	(i) norm threshold above which state is 1
+ *	int	stav_len;	(i) short term average length (samples)
+ *	int	ltav_len;	(i) long term average length (samples)
+ *	char	*stav_meas;	(i) stav measure ("square","absolute")
+ *	char	*stav_method;	(i) stav method ("recursive","sliding")
+ *	int	stav_thresh;	(i) number of samples in a valid stav window
+ *	int	ltav_thresh;	(i) number of samples in a valid ltav window
+ *	char	*snr_method;	(i) snr method ("standard","z","logz")
+ *	double	on_snr;		(i) snr at or above which a trigger turns on
+ *	double	off_snr;	(i) snr below which a trigger turns off
+ *
+ *	int
+ *	detect_stream_process (ds, data, norm, npts)
+ *	Detect_Stream	*ds;	(i/o) detector state
+ *	float	*data;		(i) next block of data
+ *	float	*norm;		(i) normalization function for data or NULL
+ *	int	npts;		(i) number of points in data, norm
+ *
+ *	int
+ *	detect_stream_flush (ds)
+ *
+ *	int
+ *	detect_stream_process_channels (ds, nchan, data, norm, npts, nthreads)
+ *	Detect_Stream	**ds;	(i/o) detector state for each channel
+ *	int	nchan;		(i) number of channels
+ *	float	**data;		(i) next block of data for each channel
+ *	float	**norm;		(i) norm for each channel or NULL
+ *	int	*npts;		(i) number of points for each channel
+ *	int	nthreads;	(i) number of threads, or <= 0 for one per
+ *				    online processor
+ *
+ *	int
+ *	detect_stream_output (ds, first_sample, snr, stav, ltav)
+ *	long	*first_sample;	(o) sample index of the first output value
+ *	float	**snr;		(o) snr values completed by the last call
+ *	float	**stav;		(o) matching short term average values
+ *	float	**ltav;		(o) matching long term average values
+ *
+ *	int
+ *	detect_stream_events (ds, events)
+ *	Detect_Event	**events; (o) events found by the last call
+ *
+ * DESCRIPTION
+ *
+ *	These routines compute the same short term average, long term
+ *	average and signal-to-noise ratio as compute_snr(), but one block
+ *	of data at a time, with memory bounded by the window lengths
+ *	instead of the length of the data.
+ *
+ *	Each average is a small pipeline stage that keeps a ring of recent
+ *	input samples and the centered running sums that init_avg()
+ *	computes, and evaluates running_avg() or recursive_avg() one
+ *	sample at a time.  A stage holds back half a window of output,
+ *	so the snr lags the input by about ltav_len samples.  The
+ *	arithmetic follows avg.c, z_stat_snr.c and standard_snr.c
+ *	statement for statement, so once detect_stream_flush() has been
+ *	called the concatenated output is identical to the vectors
+ *	returned by compute_snr() for the whole record.
+ *
+ *	detect_stream_create() returns a new detector, or NULL if the
+ *	parameters are bad.  ltav_len / 2 must be at least stav_len - 1
+ *	because the batch long term average looks back stav_len samples
+ *	from the first centered point.
+ *
+ *	detect_stream_process() appends a block of data.  A NULL norm
+ *	gives every sample a state of one.  detect_stream_flush() marks
+ *	the end of the record and completes the final half windows.  Both
+ *	return the number of snr values completed by the call, or -1 on
+ *	error.  Those values, and the trigger onsets and offsets found in
+ *	them, can be read with detect_stream_output() and
+ *	detect_stream_events() until the next call.  A trigger turns on
+ *	when the snr reaches on_snr and turns off when it drops below
+ *	off_snr.
+ *
+ *	detect_stream_process_channels() calls detect_stream_process()
+ *	for each channel.  The channels are shared among the threads by
+ *	parallel_run(), each thread taking the next channel as it finishes
+ *	the last.  The channels are independent, so the results do not
+ *	depend on nthreads.  It returns -1 if any channel failed.
+ *
+ *	detect_stream_reset() starts a new record with the same
+ *	parameters.  detect_stream_free() releases a detector.
+ *
+ * SEE ALSO
+ *
+ *	compute_snr(), running_avg(), recursive_avg()
+ *
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "libstring.h"       /* for mallocWarn, parallel_run  */
+#include "logErrorMsg.h"
+#include "aesir.h"
+#include "libdetectP.h"
+
+#define SNR_STANDARD	0
+#define SNR_Z		1
+#define SNR_LOGZ	2
+
+/* A history of values and states indexed by sample number */
+typedef struct
+{
+	float	*v;
+	int	*s;
+	int	mask;
+} Det_Ring;
+
+#define RING_V(r, i)	((r)->v[(i) & (r)->mask])
+#define RING_S(r, i)	((r)->s[(i) & (r)->mask])
+
+/* One running_avg() or recursive_avg() evaluated a sample at a time */
+typedef struct
+{
+	int	len;
+	int	start;
+	int	end;
+	int	j;		/* first centered point */
+	int	prev_len;
+	int	thresh;
+	int	recursive;
+	double	one_on_len;
+	double	(*fp)(double);
+
+	Det_Ring in;		/* input data and state */
+	Det_Ring sum;		/* centered running sums from init_avg() */
+	long	nin;		/* samples received */
+	long	nsum;		/* running sums computed */
+	long	nout;		/* averages returned */
+	int	finished;
+
+	int	initialize;
+	float	last;
+	int	last_state;
+} Det_Avg;
+
+struct Detect_Stream
+{
+	double	comp_thr;
+	int	stav_len;
+	int	ltav_len;
+	int	ltav_thresh;
+	int	snr_method;
+	int	sqr_flag;
+	double	on_snr;
+	double	off_snr;
+
+	Det_Avg	stav;
+	Det_Avg	ltav;
+	Det_Avg	logltav;	/* ltav of log10(stav), logz only */
+	Det_Avg	zavg;		/* average of squared differences, z, logz */
+
+	Det_Ring sbuf;		/* stav by sample */
+	Det_Ring lbuf;		/* ltav by sample */
+	Det_Ring logsbuf;	/* log10(stav), logz only */
+	Det_Ring loglbuf;	/* ltav of log10(stav), logz only */
+	long	nstav;
+	long	nltav;
+	long	nlogltav;
+	long	nsnr;
+
+	int	triggered;
+	float	peak_snr;
+
+	long	out_first;
+	float	*out_snr;
+	float	*out_stav;
+	float	*out_ltav;
+	int	nout;
+	int	out_size;
+
+	Detect_Event *events;
+	int	nevents;
+	int	events_size;
+};
+
+static int ring_init( Det_Ring *r, int min_size );
+static void ring_free( Det_Ring *r );
+static int avg_init( Det_Avg *a, int len, int prev_len, int thresh,
+		     int recursive, double (*fp)(double) );
+static void avg_reset( Det_Avg *a );
+static void avg_put( Det_Avg *a, float x, int st );
+static void avg_finish( Det_Avg *a );
+static int avg_ready( Det_Avg *a );
+static void avg_next( Det_Avg *a, float *v, int *s );
+static int stream_sample( Detect_Stream *ds, float x, int st );
+static int stream_drain( Detect_Stream *ds );
+static int stream_ltav( Detect_Stream *ds, float lv, int ls );
+static int stream_snr( Detect_Stream *ds, long i, float snr );
+
+
+Detect_Stream *
+detect_stream_create( double comp_thr, int stav_len, int ltav_len,
+		      char *stav_meas, char *stav_method, int stav_thresh,
+		      int ltav_thresh, char *snr_method, double on_snr,
+		      double off_snr )
+{
+	Detect_Stream *ds = NULL;
+	double	(*meas_fp)(double) = NULL;
+	int	recursive;
+	int	method;
+	int	n;
+
+	/* Error checks */
+	if (stav_len < 1 || ltav_len < stav_len || ltav_len / 2 + 1 < stav_len
+		|| !stav_meas || !stav_method || !snr_method)
+	{
+		logErrorMsg( DFX_VERBOSE0, "detect_stream_create: Bad parameters\n" );
+		return (NULL);
+	}
+
+	if (STREQ (stav_meas, "square"))
+		meas_fp = squarex;
+	else if (STREQ (stav_meas, "absolute"))
+		meas_fp = fabs;
+	else
+	{
+		logErrorMsg( DFX_VERBOSE0, "detect_stream_create: Bad stav measure\n" );
+		return (NULL);
+	}
+
+	if (STREQ (stav_method, "recursive"))
+		recursive = 1;
+	else if (STREQ (stav_method, "sliding"))
+		recursive = 0;
+	else
+	{
+		logErrorMsg( DFX_VERBOSE0, "detect_stream_create: Bad stav method\n" );
+		return (NULL);
+	}
+
+	if (STREQ (snr_method, "standard"))
+		method = SNR_STANDARD;
+	else if (STREQ (snr_method, "z"))
+		method = SNR_Z;
+	else if (STREQ (snr_method, "logz"))
+		method = SNR_LOGZ;
+	else
+	{
+		logErrorMsg( DFX_VERBOSE0, "detect_stream_create: Bad snr method\n" );
+		return (NULL);
+	}
+
+	if (!(ds = (Detect_Stream *)mallocWarn( sizeof(Detect_Stream))))
+		return (NULL);
+	memset ((void *) ds, 0, sizeof (Detect_Stream));
+
+	ds->comp_thr = comp_thr;
+	ds->stav_len = stav_len;
+	ds->ltav_len = ltav_len;
+	ds->ltav_thresh = ltav_thresh;
+	ds->snr_method = method;
+	ds->sqr_flag = (meas_fp == squarex) ? 1 : 0;
+	ds->on_snr = on_snr;
+	ds->off_snr = off_snr;
+
+	/*
+	 * The snr of sample i needs the stav back to i - stav_len, while
+	 * the stav has already been computed for about one ltav window
+	 * past i in each of the ltav and z stages.
+	 */
+	n = stav_len + 2*ltav_len + 4;
+
+	if (avg_init (&ds->stav, stav_len, 0, stav_thresh, recursive, meas_fp)
+	    || avg_init (&ds->ltav, ltav_len, stav_len, ltav_thresh, 1, samex)
+	    || ring_init (&ds->sbuf, n) || ring_init (&ds->lbuf, n))
+	{
+		detect_stream_free (ds);
+		return (NULL);
+	}
+	if (method != SNR_STANDARD &&
+	    avg_init (&ds->zavg, ltav_len, 1, ltav_thresh, 1, squarex))
+	{
+		detect_stream_free (ds);
+		return (NULL);
+	}
+	if (method == SNR_LOGZ &&
+	    (avg_init (&ds->logltav, ltav_len, stav_len, ltav_thresh, 1, samex)
+	     || ring_init (&ds->logsbuf, n) || ring_init (&ds->loglbuf, n)))
+	{
+		detect_stream_free (ds);
+		return (NULL);
+	}
+
+	return (ds);
+}
+
+
+int
+detect_stream_process( Detect_Stream *ds, float *data, float *norm, int npts )
+{
+	int	st;
+	int	i;
+
+	if (!ds || (npts > 0 && !data) || ds->stav.finished)
+		return (-1);
+
+	ds->out_first = ds->nsnr;
+	ds->nout = 0;
+	ds->nevents = 0;
+
+	for (i = 0; i < npts; i++)
+	{
+		st = (!norm || norm[i] >= ds->comp_thr) ? 1 : 0;
+
+		if (stream_sample (ds, data[i], st) < 0)
+			return (-1);
+	}
+
+	return (ds->nout);
+}
+
+
+int
+detect_stream_flush( Detect_Stream *ds )
+{
+	if (!ds || ds->stav.finished)
+		return (-1);
+
+	ds->out_first = ds->nsnr;
+	ds->nout = 0;
+	ds->nevents = 0;
+
+	/*
+	 * Finish each stage only after everything upstream of it has
+	 * been pushed through, so that the final half windows see the
+	 * full record length.
+	 */
+	avg_finish (&ds->stav);
+	if (stream_drain (ds) < 0)
+		return (-1);
+
+	avg_finish (&ds->ltav);
+	if (ds->snr_method == SNR_LOGZ)
+		avg_finish (&ds->logltav);
+	if (stream_drain (ds) < 0)
+		return (-1);
+
+	if (ds->snr_method != SNR_STANDARD)
+	{
+		avg_finish (&ds->zavg);
+		if (stream_drain (ds) < 0)
+			return (-1);
+	}
+
+	if (ds->triggered && ds->nsnr > 0)
+	{
+		ds->triggered = 0;
+		if (stream_snr (ds, -1, ds->peak_snr) < 0)
+			return (-1);
+	}
+
+	return (ds->nout);
+}
+
+
+typedef struct
+{
+	Detect_Stream	**ds;
+	float	**data;
+	float	**norm;
+	int	*npts;
+	int	ret;
+} Detect_Work;
+
+static void
+detect_channel( int i, void *arg )
+{
+	Detect_Work *w = (Detect_Work *)arg;
+
+	if (detect_stream_process (w->ds[i], w->data[i],
+			w->norm ? w->norm[i] : NULL, w->npts[i]) < 0)
+	{
+		w->ret = -1;
+	}
+}
+
+
+int
+detect_stream_process_channels( Detect_Stream **ds, int nchan, float **data,
+				float **norm, int *npts, int nthreads )
+{
+	Detect_Work	w;
+
+	if (!ds || !data || !npts || nchan < 0)
+		return (-1);
+
+	w.ds = ds;
+	w.data = data;
+	w.norm = norm;
+	w.npts = npts;
+	w.ret = 0;
+
+	parallel_run (nchan, nthreads, detect_channel, &w);
+
+	return (w.ret);
+}
+
+
+int
+detect_stream_output( Detect_Stream *ds, long *first_sample, float **snr,
+		      float **stav, float **ltav )
+{
+	if (!ds)
+		return (-1);
+
+	if (first_sample)
+		*first_sample = ds->out_first;
+	if (snr)
+		*snr = ds->out_snr;
+	if (stav)
+		*stav = ds->out_stav;
+	if (ltav)
+		*ltav = ds->out_ltav;
+
+	return (ds->nout);
+}
+
+
+int
+detect_stream_events( Detect_Stream *ds, Detect_Event **events )
+{
+	if (!ds)
+		return (-1);
+
+	if (events)
+		*events = ds->events;
+
+	return (ds->nevents);
+}
+
+
+void
+detect_stream_reset( Detect_Stream *ds )
+{
+	if (!ds)
+		return;
+
+	avg_reset (&ds->stav);
+	avg_reset (&ds->ltav);
+	avg_reset (&ds->logltav);
+	avg_reset (&ds->zavg);
+	ds->nstav = 0;
+	ds->nltav = 0;
+	ds->nlogltav = 0;
+	ds->nsnr = 0;
+	ds->triggered = 0;
+	ds->peak_snr = 0.;
+	ds->out_first = 0;
+	ds->nout = 0;
+	ds->nevents = 0;
+}
+
+
+void
+detect_stream_free( Detect_Stream *ds )
+{
+	if (!ds)
+		return;
+
+	ring_free (&ds->stav.in);
+	ring_free (&ds->stav.sum);
+	ring_free (&ds->ltav.in);
+	ring_free (&ds->ltav.sum);
+	ring_free (&ds->logltav.in);
+	ring_free (&ds->logltav.sum);
+	ring_free (&ds->zavg.in);
+	ring_free (&ds->zavg.sum);
+	ring_free (&ds->sbuf);
+	ring_free (&ds->lbuf);
+	ring_free (&ds->logsbuf);
+	ring_free (&ds->loglbuf);
+	FREE (ds->out_snr);
+	FREE (ds->out_stav);
+	FREE (ds->out_ltav);
+	FREE (ds->events);
+	free (ds);
+}
+
+
+/*
+ * Push one data sample through the stav stage and everything
+ * downstream of it.
+ */
+static int
+stream_sample( Detect_Stream *ds, float x, int st )
+{
+	avg_put (&ds->stav, x, st);
+
+	return (stream_drain (ds));
+}
+
+
+/*
+ * Move every value that is ready from each stage to the next one.
+ */
+static int
+stream_drain( Detect_Stream *ds )
+{
+	float	sv, lv, lsv;
+	int	ss, ls;
+
+	while (avg_ready (&ds->stav))
+	{
+		avg_next (&ds->stav, &sv, &ss);
+		RING_V (&ds->sbuf, ds->nstav) = sv;
+		RING_S (&ds->sbuf, ds->nstav) = ss;
+
+		avg_put (&ds->ltav, sv, ss);
+
+		if (ds->snr_method == SNR_LOGZ)
+		{
+			/* as in compute_snr_aux() */
+			if (sv <= DFX_ZERO_VALUE)
+			{
+				lsv = DFX_NULL_LOG_VALUE;
+			}
+			else
+			{
+				lsv = log10 (sv);
+			}
+			RING_V (&ds->logsbuf, ds->nstav) = lsv;
+			RING_S (&ds->logsbuf, ds->nstav) = ss;
+
+			avg_put (&ds->logltav, lsv, ss);
+		}
+		ds->nstav++;
+
+		while (avg_ready (&ds->ltav))
+		{
+			avg_next (&ds->ltav, &lv, &ls);
+			if (stream_ltav (ds, lv, ls) < 0)
+				return (-1);
+		}
+	}
+
+	/* after the stav stage is finished, the ltav stage may have more */
+	while (avg_ready (&ds->ltav))
+	{
+		avg_next (&ds->ltav, &lv, &ls);
+		if (stream_ltav (ds, lv, ls) < 0)
+			return (-1);
+	}
+
+	if (ds->snr_method == SNR_LOGZ)
+	{
+		while (avg_ready (&ds->logltav))
+		{
+			long i = ds->nlogltav;
+			int k = ds->ltav_len / 2 + 1;
+			long ims = (i < k) ? i : i - ds->stav_len;
+
+			avg_next (&ds->logltav, &lv, &ls);
+			RING_V (&ds->loglbuf, i) = lv;
+			RING_S (&ds->loglbuf, i) = ls;
+			ds->nlogltav++;
+
+			/* as in z_stat_snr() */
+			avg_put (&ds->zavg, RING_V (&ds->logsbuf, ims) - lv,
+				 RING_S (&ds->logsbuf, ims) * ls);
+		}
+	}
+
+	if (ds->snr_method != SNR_STANDARD)
+	{
+		while (avg_ready (&ds->zavg))
+		{
+			long i = ds->nsnr;
+			Det_Ring *sr, *lr;
+			double	stdv;
+			float	snp;
+			int	sntp;
+
+			avg_next (&ds->zavg, &snp, &sntp);
+
+			if (ds->snr_method == SNR_LOGZ)
+			{
+				sr = &ds->logsbuf;
+				lr = &ds->loglbuf;
+			}
+			else
+			{
+				sr = &ds->sbuf;
+				lr = &ds->lbuf;
+			}
+
+			/* as in z_stat_snr() */
+			stdv = sqrt (snp);
+			if (!sntp)
+			{
+				snp = 0;
+			}
+			else if (ds->snr_method == SNR_LOGZ && stdv <= DFX_ZERO_VALUE)
+			{
+				snp = 0;
+			}
+			else if (stdv <= (RING_V (lr, i) * DFX_ZERO_VALUE))
+			{
+				snp = 0.0;
+			}
+			else
+			{
+				snp = (RING_V (sr, i) - RING_V (lr, i)) / stdv;
+			}
+
+			if (stream_snr (ds, i, snp) < 0)
+				return (-1);
+		}
+	}
+
+	return (0);
+}
+
+
+/*
+ * Store the next ltav value.  For the standard snr the snr is ready
+ * now; for the z snr the squared difference goes on to the z stage.
+ */
+static int
+stream_ltav( Detect_Stream *ds, float lv, int ls )
+{
+	long	i = ds->nltav;
+	float	sv;
+	float	snp;
+	long	ims;
+	int	k;
+
+	RING_V (&ds->lbuf, i) = lv;
+	RING_S (&ds->lbuf, i) = ls;
+	ds->nltav++;
+
+	if (ds->snr_method == SNR_STANDARD)
+	{
+		/* as in standard_snr() */
+		sv = RING_V (&ds->sbuf, i);
+		if (lv <= DFX_ZERO_VALUE)
+		{
+			snp = 0.0;
+		}
+		else
+		{
+			snp = RING_S (&ds->sbuf, i)*ls*sv/lv;
+		}
+		if (ds->sqr_flag && snp >= 0.0)
+		{
+			snp = (float) sqrt ((double) snp);
+		}
+		return (stream_snr (ds, i, snp));
+	}
+	else if (ds->snr_method == SNR_Z)
+	{
+		/* as in z_stat_snr() */
+		k = ds->ltav_len / 2 + 1;
+		ims = (i < k) ? i : i - ds->stav_len;
+
+		avg_put (&ds->zavg, RING_V (&ds->sbuf, ims) - lv,
+			 RING_S (&ds->sbuf, ims) * ls);
+	}
+	return (0);
+}
+
+
+/*
+ * Append an snr value to the output of this call and look for trigger
+ * onsets and offsets.  An index of -1 closes an open trigger at the
+ * end of the record.
+ */
+static int
+stream_snr( Detect_Stream *ds, long i, float snr )
+{
+	Detect_Event *ev;
+	int	onset = -1;
+	int	n;
+
+	if (i >= 0)
+	{
+		if (ds->nout == ds->out_size)
+		{
+			n = (ds->out_size > 0) ? 2*ds->out_size : 1024;
+			if (!(ds->out_snr = (float *)reallocWarn( ds->out_snr,
+						n * sizeof(float)))
+			    || !(ds->out_stav = (float *)reallocWarn( ds->out_stav,
+						n * sizeof(float)))
+			    || !(ds->out_ltav = (float *)reallocWarn( ds->out_ltav,
+						n * sizeof(float))))
+			{
+				return (-1);
+			}
+			ds->out_size = n;
+		}
+		ds->out_snr[ds->nout] = snr;
+		ds->out_stav[ds->nout] = RING_V (&ds->sbuf, i);
+		ds->out_ltav[ds->nout] = RING_V (&ds->lbuf, i);
+		ds->nout++;
+		ds->nsnr++;
+
+		if (!ds->triggered && snr >= ds->on_snr)
+		{
+			ds->triggered = 1;
+			ds->peak_snr = snr;
+			onset = 1;
+		}
+		else if (ds->triggered)
+		{
+			if (snr < ds->off_snr)
+			{
+				ds->triggered = 0;
+				onset = 0;
+				snr = ds->peak_snr;
+			}
+			else if (snr > ds->peak_snr)
+			{
+				ds->peak_snr = snr;
+			}
+		}
+	}
+	else
+	{
+		i = ds->nsnr - 1;
+		onset = 0;
+	}
+
+	if (onset >= 0)
+	{
+		if (ds->nevents == ds->events_size)
+		{
+			n = (ds->events_size > 0) ? 2*ds->events_size : 16;
+			if (!(ds->events = (Detect_Event *)reallocWarn( ds->events,
+						n * sizeof(Detect_Event))))
+			{
+				return (-1);
+			}
+			ds->events_size = n;
+		}
+		ev = &ds->events[ds->nevents++];
+		ev->onset = onset;
+		ev->sample = i;
+		ev->snr = snr;
+	}
+	return (0);
+}
+
+
+static int
+ring_init( Det_Ring *r, int min_size )
+{
+	int	n;
+
+	for (n = 16; n < min_size; n *= 2);
+
+	r->v = (float *)mallocWarn( n * sizeof(float));
+	r->s = (int *)mallocWarn( n * sizeof(int));
+	if (!r->v || !r->s)
+	{
+		ring_free (r);
+		return (-1);
+	}
+	memset ((void *) r->v, 0, n * sizeof(float));
+	memset ((void *) r->s, 0, n * sizeof(int));
+	r->mask = n - 1;
+
+	return (0);
+}
+
+
+static void
+ring_free( Det_Ring *r )
+{
+	FREE (r->v);
+	FREE (r->s);
+}
+
+
+static int
+avg_init( Det_Avg *a, int len, int prev_len, int thresh, int recursive,
+	  double (*fp)(double) )
+{
+	memset ((void *) a, 0, sizeof (Det_Avg));
+
+	/* Determine odd number of samples for centered averages */
+	a->len = len;
+	a->start = a->end = len / 2;
+	if (len % 2 == 0)
+	{
+		a->end -= 1;
+	}
+	a->prev_len = prev_len;
+	a->thresh = thresh;
+	a->recursive = recursive;
+	a->one_on_len = 1.0 / (double) len;
+	a->fp = fp;
+
+	if (ring_init (&a->in, len + prev_len + 2)
+	    || ring_init (&a->sum, len + prev_len + 2))
+	{
+		return (-1);
+	}
+	avg_reset (a);
+
+	return (0);
+}
+
+
+static void
+avg_reset( Det_Avg *a )
+{
+	a->j = a->start + 1;
+	a->nin = 0;
+	a->nsum = 0;
+	a->nout = 0;
+	a->finished = 0;
+	a->initialize = 0;
+	a->last = 0.0;
+	a->last_state = 0;
+}
+
+
+/*
+ * Add the next input sample and extend the centered running sums
+ * exactly as init_avg() does.
+ */
+static void
+avg_put( Det_Avg *a, float x, int st )
+{
+	double	term;
+	double	av;
+	int	isum;
+	long	i, ipe, imj;
+
+	RING_V (&a->in, a->nin) = x;
+	RING_S (&a->in, a->nin) = st;
+	a->nin++;
+
+	if (a->nin == a->len)
+	{
+		av = 0.0;
+		isum = 0;
+		for (i = 0; i < a->len; i++)
+		{
+			av += (*a->fp) (RING_V (&a->in, i)) * RING_S (&a->in, i);
+			isum += RING_S (&a->in, i);
+		}
+		for (i = 0; i < a->j; i++)
+		{
+			RING_V (&a->sum, i) = av;
+			RING_S (&a->sum, i) = isum;
+		}
+		a->nsum = a->j;
+	}
+	else if (a->nin > a->len)
+	{
+		i = a->nsum;
+		ipe = i + a->end;
+		imj = i - a->j;
+
+		RING_S (&a->sum, i) = RING_S (&a->sum, i - 1) +
+			RING_S (&a->in, ipe) - RING_S (&a->in, imj);
+
+		term = (*a->fp) (RING_V (&a->in, ipe)) * RING_S (&a->in, ipe) -
+			(*a->fp) (RING_V (&a->in, imj)) * RING_S (&a->in, imj);
+		RING_V (&a->sum, i) = RING_V (&a->sum, i - 1) + term;
+		a->nsum++;
+	}
+}
+
+
+/*
+ * End of the record.  A record shorter than one window is summed as a
+ * whole, as init_avg() does.
+ */
+static void
+avg_finish( Det_Avg *a )
+{
+	double	av;
+	int	isum;
+	long	i;
+
+	a->finished = 1;
+
+	if (a->nin > 0 && a->nin < a->len)
+	{
+		av = 0.0;
+		isum = 0;
+		for (i = 0; i < a->nin; i++)
+		{
+			av += (*a->fp) (RING_V (&a->in, i)) * RING_S (&a->in, i);
+			isum += RING_S (&a->in, i);
+		}
+		for (i = 0; i < a->nin; i++)
+		{
+			RING_V (&a->sum, i) = av;
+			RING_S (&a->sum, i) = isum;
+		}
+		a->nsum = a->nin;
+		a->j = (int) a->nin;
+	}
+}
+
+
+/*
+ * An average can be returned once the input is half a window past it,
+ * or, at the end of the record, for every input sample.
+ */
+static int
+avg_ready( Det_Avg *a )
+{
+	if (a->finished)
+	{
+		return (a->nout < a->nin);
+	}
+	return (a->nout < a->nsum && a->nout + a->start < a->nin);
+}
+
+
+static void
+avg_next( Det_Avg *a, float *v, int *s )
+{
+	float	sum;
+	int	isum;
+	long	i = a->nout;
+	long	k, imp;
+	double	term;
+
+	/* The last half window keeps the last running sum */
+	k = (i < a->nsum) ? i : a->nsum - 1;
+	sum = RING_V (&a->sum, k);
+	isum = RING_S (&a->sum, k);
+
+	if (!a->recursive && a->finished && i > 0 && i >= a->nin - a->start)
+	{
+		/* running_avg() copies the last centered value to the end */
+		*v = a->last;
+		*s = a->last_state;
+	}
+	else if (i < a->j || !a->recursive)
+	{
+		if (isum >= a->thresh)
+		{
+			*v = sum / (double) isum;
+			*s = 1;
+			a->initialize = 0;
+		}
+		else
+		{
+			*v = 0.0;
+			*s = 0;
+			a->initialize = 1;
+		}
+	}
+	else if (a->initialize)
+	{
+		if (isum >= a->thresh)	/* reinit */
+		{
+			*v = sum / (double) isum;
+			*s = 1;
+			a->initialize = 0;
+		}
+		else
+		{
+			*v = 0.0;
+			*s = 0;
+		}
+	}
+	else
+	{
+		imp = i - a->prev_len;
+
+		if (RING_S (&a->in, imp))
+		{
+			term = (*a->fp)(RING_V (&a->in, imp)) - a->last;
+			*v = a->last + (term * a->one_on_len);
+			*s = 1;
+		}
+		else if (isum >= a->thresh)
+		{
+			*v = a->last;	/* carry */
+			*s = 1;
+		}
+		else
+		{
+			*v = 0.0;
+			*s = 0;
+			a->initialize = 1;
+		}
+	}
+
+	a->last = *v;
+	a->last_state = *s;
+	a->nout++;
+}
@@ -5,8 +5,10 @@
  */
 
 
-#ifndef LIBDETECT_H
-#define LIBDETECT_H
+#ifndef LIBDETECTP_H
+#define LIBDETECTP_H
+
+#include "libdetect.h"
 
 /* use syslog symbol values */
 #include <syslog.h>
@@ -76,5 +78,5 @@ extern double calc_deltime( double snr, double detsnr,double max_snr,
 double squarex( double x);
 double samex( double x );
 
-#endif /* LIBDETECT_H */
+#endif /* LIBDETECTP_H */
 
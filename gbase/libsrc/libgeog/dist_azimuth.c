@@ -23,8 +23,10 @@
  *	alon1:		Geographic longitude position of point 1 (deg)
  *	alat2:		Geographic latitude position of point 2 (deg)
  *	alon2:		Geographic longitude position of point 2 (deg)
- *	phase_index:	If > 0, 2nd pair of lat/lon coordinates have not 
- *			changed, so, some CPU efficiencies can be achieved 
+ *	phase_index:	No longer used.  The sine and cosine of the 2nd 
+ *			latitude were once saved between calls when this 
+ *			was > 0, which is not safe when called from more 
+ *			than one thread.
 
  *	---- On return ----
  *	delta:		Geocentric distance between points 1 and 2 (deg)
@@ -41,9 +43,7 @@
  *	positive North.  Longitude is positive toward the East azi is 
  *	measured clockwise from local North.  The first lat./lon. pair should 
  *	represent the station coordinates as a general rule.  Thus, the
- *	second pair would be the event coordinates.  If the 2nd pair of 
- *	lat/lon coordinates change with every event call, simply set 
- *	phase_index to 0 at every call to this function.
+ *	second pair would be the event coordinates.
 
  * SEE ALSO
  *	None.
@@ -81,25 +81,20 @@ dist_azimuth (double alat1, double alon1, double alat2, double alon2,
 {
 	double	clat1, cdlon, cdel, geoc_co_lat, geoc_lat1, geoc_lat2;
 	double	geog_co_lat, rdlon, slat1, sdlon, xazi, xbaz, yazi, ybaz;
-	static	double	clat2, slat2;
+	double	clat2, slat2;
 
 
 	/*
 	 * Convert alat2 from geographic latitude to geocentric latitude 
-	 * (radians).  This is optimized to avoid extra sine and cosine
-	 * calls when alat2 doesn't change between calls (such as looping
-	 * over a set of stations for a given event).
+	 * (radians).
 	 */
 
-	if (phase_index == 0)
-	{
-		geog_co_lat = (90.0-(alat2))*DEG_TO_RAD;
-		geoc_co_lat = GEOCENTRIC_COLAT(geog_co_lat);
-		geoc_lat2 = 90.0*DEG_TO_RAD-geoc_co_lat;
+	geog_co_lat = (90.0-(alat2))*DEG_TO_RAD;
+	geoc_co_lat = GEOCENTRIC_COLAT(geog_co_lat);
+	geoc_lat2 = 90.0*DEG_TO_RAD-geoc_co_lat;
 
-		clat2 = cos(geoc_lat2);
-		slat2 = sin(geoc_lat2);
-	}
+	clat2 = cos(geoc_lat2);
+	slat2 = sin(geoc_lat2);
 
 	/*
 	 * Simple case when both sets of lat/lons are the same.
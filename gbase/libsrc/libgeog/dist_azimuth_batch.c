@@ -0,0 +1,348 @@
+
+/*
+ * NAME
+ *	dist_azimuth_batch -- Distance and azimuth matrices between two sets
+ *			      of points on a sphere.
+
+ * FILE
+ *	dist_azimuth_batch.c
+
+ * SYNOPSIS
+ *	Geog_Points *
+ *	geog_points (lat, lon, n)
+ *	double	*lat;		(i) Geographic latitudes (deg)
+ *	double	*lon;		(i) Geographic longitudes (deg)
+ *	int	n;		(i) Number of points
+
+ *	void
+ *	free_geog_points (p)
+ *	Geog_Points *p;		(i) Points from geog_points()
+
+ *	int
+ *	dist_azimuth_batch (sta, ev, delta, azi, baz, num_threads)
+ *	Geog_Points *sta;	(i) Points 1 (typically the stations)
+ *	Geog_Points *ev;	(i) Points 2 (typically the events)
+ *	double	*delta;		(o) sta->n x ev->n distances (deg)
+ *	double	*azi;		(o) sta->n x ev->n azimuths, or NULL
+ *	double	*baz;		(o) sta->n x ev->n back-azimuths, or NULL
+ *	int	num_threads;	(i) Number of threads (<= 0: one per online
+ *				    processor)
+
+ *	int
+ *	dist_azimuth_matrix (slat, slon, nsta, elat, elon, nev, delta, azi,
+ *			     baz, num_threads)
+ *	double	*slat, *slon;	(i) Geographic positions of points 1 (deg)
+ *	int	nsta;		(i) Number of points 1
+ *	double	*elat, *elon;	(i) Geographic positions of points 2 (deg)
+ *	int	nev;		(i) Number of points 2
+ *	double	*delta;		(o) nsta x nev distances (deg)
+ *	double	*azi;		(o) nsta x nev azimuths, or NULL
+ *	double	*baz;		(o) nsta x nev back-azimuths, or NULL
+ *	int	num_threads;	(i) As for dist_azimuth_batch()
+
+ * DESCRIPTION
+ *	Functions.  dist_azimuth_batch() computes what dist_azimuth()
+ *	returns for every pair of a point of sta with a point of ev.  The
+ *	result for sta point i and ev point j is element i*ev->n + j of
+ *	delta, azi and baz.  Either of azi and baz can be NULL when it is
+ *	not wanted.
+
+ *	geog_points() converts a set of geographic positions once to
+ *	geocentric unit vectors, with the local east and north vectors at
+ *	each point, so that the sine and cosine of the latitudes and
+ *	longitudes are not computed again for each pair.  A set of stations
+ *	can be kept and used with any number of event sets.  Each pair is
+ *	then only dot products:
+
+ *		cos(delta) = u1.u2
+ *		tan(azi) = (e1.u2) / (n1.u2)
+ *		tan(baz) = (e2.u1) / (n2.u1)
+
+ *	dist_azimuth_matrix() is geog_points() on both sets, followed by
+ *	dist_azimuth_batch().
+
+ *	The rows of the matrices are shared among the threads with
+ *	parallel_run().
+
+ * DIAGNOSTICS
+ *	geog_points() returns NULL if it cannot allocate memory.
+ *	dist_azimuth_batch() returns OK, or ERR if sta, ev or delta is
+ *	NULL.  dist_azimuth_matrix() also returns ERR if it cannot allocate
+ *	memory.
+
+ * NOTES
+ *	The results agree with dist_azimuth() to its own rounding error.
+ *	cos(delta) is formed from the unit vectors instead of from
+ *	cos(lon2 - lon1), and acos() loses about half of the digits near
+ *	delta = 0 in both, so very short distances can differ in the last
+ *	1.e-6 deg.  The azimuths are not defined at a pole or between
+ *	antipodes, and there the two can return different values.  As in
+ *	dist_azimuth(), two identical positions return delta = 0, azi = 0
+ *	and baz = 180.
+
+ *	The pair loops are written without branches or calls on
+ *	contiguous arrays, so that the compiler can vectorize them.
+
+ * SEE ALSO
+ *	dist_azimuth(), parallel_run().
+ */
+
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "libgeog.h"
+#include "libstring.h"
+
+#define RAD_TO_DEG	(180.0/M_PI)
+#define DEG_TO_RAD	(M_PI/180.0)
+
+#define GEOCENTRIC_COLAT(x) \
+	(x + (((0.192436*sin(x+x)) + (0.000323*sin(4.0*x)))*DEG_TO_RAD))
+
+/* Pairs computed at a time in a row, with the temporaries on the stack */
+#define	GEOG_BLOCK		256
+
+/* Pairs given to a thread at a time */
+#define	GEOG_ROW_WORK		4096
+
+typedef struct {
+	Geog_Points	*sta;
+	Geog_Points	*ev;
+	double		*delta;
+	double		*azi;
+	double		*baz;
+	int		rows;	/* rows per work unit */
+	int		nsta;
+} Batch_Work;
+
+static void dist_rows(int k, void *arg);
+static void dist_row(Geog_Points *sta, int i, Geog_Points *ev, double *delta,
+			double *azi, double *baz);
+
+
+Geog_Points *
+geog_points (double *lat, double *lon, int n)
+{
+	Geog_Points	*p;
+	double		*a;
+	double		geog_co_lat, geoc_lat, rlon;
+	double		slat, clat, slon, clon;
+	int		i;
+
+	if (n < 0)
+	    n = 0;
+
+	if ((p = (Geog_Points *) malloc (sizeof (Geog_Points))) == NULL)
+	    return (NULL);
+
+	/* One block for the 10 arrays */
+	if ((a = (double *) malloc ((n > 0 ? n : 1)*10*sizeof (double))) == NULL)
+	{
+	    free (p);
+	    return (NULL);
+	}
+	p->n  = n;
+	p->lat = a;
+	p->lon = a + n;
+	p->ux = a + 2*n;
+	p->uy = a + 3*n;
+	p->uz = a + 4*n;
+	p->ex = a + 5*n;
+	p->ey = a + 6*n;
+	p->nx = a + 7*n;
+	p->ny = a + 8*n;
+	p->nz = a + 9*n;
+
+	for (i = 0; i < n; i++)
+	{
+	    /*
+	     * Convert lat from geographic latitude to geocentric latitude
+	     * (radians), as in dist_azimuth().
+	     */
+	    geog_co_lat = (90.0-(lat[i]))*DEG_TO_RAD;
+	    geoc_lat = 90.0*DEG_TO_RAD - GEOCENTRIC_COLAT(geog_co_lat);
+	    rlon = DEG_TO_RAD * lon[i];
+
+	    slat = sin(geoc_lat);
+	    clat = cos(geoc_lat);
+	    slon = sin(rlon);
+	    clon = cos(rlon);
+
+	    p->lat[i] = lat[i];
+	    p->lon[i] = lon[i];
+	    p->ux[i] = clat*clon;
+	    p->uy[i] = clat*slon;
+	    p->uz[i] = slat;
+	    p->ex[i] = -slon;		/* local east, ez = 0 */
+	    p->ey[i] =  clon;
+	    p->nx[i] = -slat*clon;	/* local north */
+	    p->ny[i] = -slat*slon;
+	    p->nz[i] =  clat;
+	}
+	return (p);
+}
+
+
+void
+free_geog_points (Geog_Points *p)
+{
+	if (p)
+	{
+	    free (p->lat);
+	    free (p);
+	}
+}
+
+
+int
+dist_azimuth_batch (Geog_Points *sta, Geog_Points *ev, double *delta,
+		    double *azi, double *baz, int num_threads)
+{
+	Batch_Work	w;
+	int		nwork;
+
+	if (! sta || ! ev || ! delta)
+	    return (ERR);
+	if (sta->n <= 0 || ev->n <= 0)
+	    return (OK);
+
+	w.sta = sta;
+	w.ev = ev;
+	w.delta = delta;
+	w.azi = azi;
+	w.baz = baz;
+	w.nsta = sta->n;
+	w.rows = GEOG_ROW_WORK/ev->n;
+	if (w.rows < 1)
+	    w.rows = 1;
+	nwork = (sta->n + w.rows - 1)/w.rows;
+
+	parallel_run (nwork, num_threads, dist_rows, &w);
+
+	return (OK);
+}
+
+
+int
+dist_azimuth_matrix (double *slat, double *slon, int nsta, double *elat,
+		     double *elon, int nev, double *delta, double *azi,
+		     double *baz, int num_threads)
+{
+	Geog_Points	*sta, *ev;
+	int		ret;
+
+	if ((sta = geog_points (slat, slon, nsta)) == NULL)
+	    return (ERR);
+	if ((ev = geog_points (elat, elon, nev)) == NULL)
+	{
+	    free_geog_points (sta);
+	    return (ERR);
+	}
+	ret = dist_azimuth_batch (sta, ev, delta, azi, baz, num_threads);
+
+	free_geog_points (sta);
+	free_geog_points (ev);
+	return (ret);
+}
+
+
+static void
+dist_rows (int k, void *arg)
+{
+	Batch_Work	*w = (Batch_Work *) arg;
+	int		i, i1, i2, m;
+	long		off;
+
+	i1 = k*w->rows;
+	i2 = i1 + w->rows;
+	if (i2 > w->nsta)
+	    i2 = w->nsta;
+	m = w->ev->n;
+
+	for (i = i1; i < i2; i++)
+	{
+	    off = (long) i*m;
+	    dist_row (w->sta, i, w->ev, w->delta + off,
+		      w->azi ? w->azi + off : NULL,
+		      w->baz ? w->baz + off : NULL);
+	}
+}
+
+
+/*
+ * Distances and azimuths from point i of sta to all the points of ev.
+ */
+static void
+dist_row (Geog_Points *sta, int i, Geog_Points *ev, double *delta,
+	  double *azi, double *baz)
+{
+	double	cdel[GEOG_BLOCK], yazi[GEOG_BLOCK], xazi[GEOG_BLOCK];
+	double	ybaz[GEOG_BLOCK], xbaz[GEOG_BLOCK];
+	double	ux = sta->ux[i], uy = sta->uy[i], uz = sta->uz[i];
+	double	ex = sta->ex[i], ey = sta->ey[i];
+	double	nx = sta->nx[i], ny = sta->ny[i], nz = sta->nz[i];
+	double	lat = sta->lat[i], lon = sta->lon[i];
+	double	c, a;
+	int	j, j0, m, n;
+
+	for (j0 = 0; j0 < ev->n; j0 += GEOG_BLOCK)
+	{
+	    const double *eux = ev->ux + j0, *euy = ev->uy + j0;
+	    const double *euz = ev->uz + j0;
+	    const double *eex = ev->ex + j0, *eey = ev->ey + j0;
+	    const double *enx = ev->nx + j0, *eny = ev->ny + j0;
+	    const double *enz = ev->nz + j0;
+
+	    n = ev->n - j0;
+	    if (n > GEOG_BLOCK)
+		n = GEOG_BLOCK;
+
+	    /* The dot products; no branches, so this loop vectorizes */
+	    for (j = 0; j < n; j++)
+	    {
+		c = ux*eux[j] + uy*euy[j] + uz*euz[j];
+		c = (c <  1.0) ? c :  1.0;
+		c = (c > -1.0) ? c : -1.0;
+		cdel[j] = c;
+		yazi[j] = ex*eux[j] + ey*euy[j];
+		xazi[j] = nx*eux[j] + ny*euy[j] + nz*euz[j];
+		ybaz[j] = eex[j]*ux + eey[j]*uy;
+		xbaz[j] = enx[j]*ux + eny[j]*uy + enz[j]*uz;
+	    }
+
+	    for (j = 0; j < n; j++)
+		delta[j0+j] = RAD_TO_DEG * acos(cdel[j]);
+
+	    if (azi)
+	    {
+		for (j = 0; j < n; j++)
+		{
+		    a = RAD_TO_DEG * atan2(yazi[j], xazi[j]);
+		    azi[j0+j] = (a < 0.0) ? a + 360.0 : a;
+		}
+	    }
+	    if (baz)
+	    {
+		for (j = 0; j < n; j++)
+		{
+		    a = RAD_TO_DEG * atan2(ybaz[j], xbaz[j]);
+		    baz[j0+j] = (a < 0.0) ? a + 360.0 : a;
+		}
+	    }
+
+	    /*
+	     * Simple case when both sets of lat/lons are the same.
+	     */
+	    for (j = 0, m = j0; j < n; j++, m++)
+	    {
+		if (ev->lat[m] == lat && ev->lon[m] == lon)
+		{
+		    delta[m] = 0.0;
+		    if (azi) azi[m] = 0.0;
+		    if (baz) baz[m] = 180.0;
+		}
+	    }
+	}
+}
@@ -17,13 +17,11 @@
  *	double	*value;		(o) Percentile value from data 
  *
  *	static
- *	void
- *	merge (a, b, c, m, n)
- *	float	*a;	(i) First array of data
- *	float	*b;	(i) Second array of data
- *	float	*c;	(o) Output merged array of data in ascending order
- *	int	m	(i) Number of points in a
- *	int	n;	(i) Number of points in b
+ *	float
+ *	select_kth (a, n, k)
+ *	float	*a;	(i/o) Array of data, reordered on output
+ *	int	n;	(i) Number of points in a
+ *	int	k;	(i) Rank of the value wanted, 0 <= k < n
  *
  *
  * DESCRIPTION
@@ -32,7 +30,10 @@
  *	of the input data.  For example, the median is the 50.0 percentile.
  *	This routine assumes a non-NULL data pointer is input.
  *
- *	merge () merges two arrays in ascending order.
+ *	select_kth () returns the k'th smallest value of a, partially
+ *	reordering a in place.  It is a quickselect with median-of-three
+ *	pivots, so the percentile costs O(npts) instead of the O(npts log npts)
+ *	of the merge sort that was used before, and returns the same value.
  *	
  * NOTES
  *
@@ -58,76 +59,89 @@
 
 
 /* Local functions forward definition */
-static void merge(float *a, float *b, float *c, int m, int n);
+static float select_kth(float *a, int n, int k);
 	
 
 void
 find_percentile(double percentile, float *data, int npts, double *value)
 {
 	float	s[WORK_SPACE];
-	float	w[WORK_SPACE];
 	float	*sort = (float *) NULL;
-	float   *work = (float *) NULL;
-	int	i, j, k, m;
+	int	i;
 	
-	/* Find largest power of two in npts */
-	for (m = 1; m < npts; m *= 2);
+	/* Get percentile index */
+	i = (int) rint ((double) (percentile * npts) / 100.0) - 1;
+	i = i < 0 ? 0 : i;
 
-	/* If necessary, allocate memory for sorted data, work space */
-	if(m > WORK_SPACE)
+	/* Beyond the data, the sort was padded with the largest float value */
+	if(i >= npts)
 	{
-	    if(!(work = (float *)mallocWarn(m*sizeof(float)))) return;
-	    memset((char *) work, 0, m*sizeof(float));
-	    if(!(sort = (float *)mallocWarn(m*sizeof(float)))) return;
-	    memset((char *) sort, 0, m*sizeof(float));
+	    *value = MAXFLOAT;
+	    return;
+	}
+
+	/* If necessary, allocate memory for a copy of the data */
+	if(npts > WORK_SPACE)
+	{
+	    if(!(sort = (float *)mallocWarn(npts*sizeof(float)))) return;
 	}
 	else
 	{
-	    work = w;
 	    sort = s;
 	}
 	
 	/* Copy data into sort array */
 	memcpy((char *)sort, (char *)data,  npts*sizeof(float));
 
-	/* Pad sort array out to m with largest float value */
-	for (i = npts; i < m; sort[i++] = MAXFLOAT);
-
-	/* Mergesort the data */
-	for (k = 1; k < npts; k *= 2)
-	{
-	    for (j = 0; j < npts - k + 1; j += k * 2)
-		merge(sort+j, sort+j+k, work+j, k, k);
-			
-	    for (j = 0; j < npts; j++) sort[j] = work[j];
-	}
-
-	/* Get percentile index and percentile value */
-	i = (int) rint ((double) (percentile * npts) / 100.0) - 1;
-	i = i < 0 ? 0 : i;
-	*value = sort[i];
+	/* Get percentile value */
+	*value = select_kth(sort, npts, i);
 
-	if(m > WORK_SPACE)
+	if(npts > WORK_SPACE)
 	{
-	    FREE(work);
 	    FREE(sort);
 	}
 	
 	return;
 }	/* find_percentile */
 
-static void	
-merge(float *a, float *b, float *c, int m, int n)
+static float
+select_kth(float *a, int n, int k)
 {
-	register int	i = 0;
-	register int	j = 0;
-	register int	k = 0;
-	
-	while (i < m && j < n)
+	register int	i, j;
+	int	lo = 0;
+	int	hi = n - 1;
+	int	mid;
+	float	pivot, t;
+
+#define SWAP(x,y) {t = (x); (x) = (y); (y) = t;}
+
+	while (hi > lo + 1)
 	{
-	    if (a[i] < b[j]) c[k++] = a[i++];
-	    else c[k++] = b[j++];
+	    /* Median of a[lo], a[mid], a[hi] to a[lo+1], with sentinels */
+	    mid = lo + (hi - lo)/2;
+	    SWAP(a[mid], a[lo+1]);
+	    if (a[lo] > a[hi]) SWAP(a[lo], a[hi]);
+	    if (a[lo+1] > a[hi]) SWAP(a[lo+1], a[hi]);
+	    if (a[lo] > a[lo+1]) SWAP(a[lo], a[lo+1]);
+
+	    i = lo + 1;
+	    j = hi;
+	    pivot = a[lo+1];
+	    for (;;)
+	    {
+		do i++; while (a[i] < pivot);
+		do j--; while (a[j] > pivot);
+		if (j < i) break;
+		SWAP(a[i], a[j]);
+	    }
+	    a[lo+1] = a[j];
+	    a[j] = pivot;
+
+	    if (j >= k) hi = j - 1;
+	    if (j <= k) lo = i;
 	}
-	while (i < m) c[k++] = a[i++];
-	while (j < n) c[k++] = b[j++];
+	if (hi == lo + 1 && a[hi] < a[lo]) SWAP(a[lo], a[hi]);
+
+#undef SWAP
+	return a[k];
 }
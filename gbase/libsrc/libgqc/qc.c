@@ -132,6 +132,7 @@
  *	indices of the input data which are considered bad according to 
  *	the criteria in the QCDef structure. Basic quality control consists of 
  *	single point spike detection and gap detection.
+ *	The data vectors are checked in parallel where threads are available.
  *	If a data vectors is not masked, its mask will be empty, and will need
  *	to freed as well. Returns -1 if there is invalid input, otherwise 0.
  *
@@ -188,6 +189,9 @@
  *
  *	qc_check_segment () returns 1 if the data between indices istart
  *	and iend has any masked indices in segments of length >= seglen.
+ *	Like qc_merge_masks (), it assumes the mask segments are in
+ *	ascending order, and finds the first segment that can overlap
+ *	the interval with a binary search.
  *
  *	qc_merge_masks () merges the masks m1,m2 and returns the results
  *	in mask m.  The contents of the output mask must be freed by
@@ -235,12 +239,27 @@
 static void basic_qc(float *data, int npts, QCMask *mask);
 static void extended_qc(float **data, int *npts, int ndata, 
 		QCDef *def, int type, QCMask *imask, QCMask *mask);
+static void basic_qc_vector(int i, void *arg);
+static void basic_mean_vector(int i, void *arg);
+static void ss_spikes_vector(int i, void *arg);
+
+/* Arguments for the per-vector steps run by parallel_run() */
+typedef struct
+{
+	float	**data;
+	int	*npts;
+	QCMask	*mask;
+	float	*mean;
+	int	**ind;
+	int	*nind;
+} QCVectors;
 
 
 int 
 qc_basic(float **data, int *npts, int ndata, QCDef *def, QCMask **m)
 {
 	QCMask	*mask = NULL;		
+	QCVectors v;
 	int	i;
 
 	*m = NULL;
@@ -262,19 +281,20 @@ qc_basic(float **data, int *npts, int ndata, QCDef *def, QCMask **m)
 	if(!(mask = (QCMask *)mallocWarn(ndata*sizeof(QCMask)))) return -1;
 	memset((void *) mask, 0, sizeof(QCMask) * ndata);
 
-	/* 
-	 * Perform basic quality control on data vectors
-	 */
+	/* Copy definition structure into masks */
 	for(i = 0; i < ndata; i++)
 	{
-	    /* Copy definition structure into mask */
 	    memcpy((void *) &mask[i].def, (void *) def, sizeof(QCDef));
-
-	    /* Don't attempt masking if there is no data */
-	    if(!data[i]) continue;
-		
-	    basic_qc(data[i], npts[i], &mask[i]);
 	}
+
+	/* 
+	 * Perform basic quality control on data vectors, which are
+	 * independent, so they can be done in parallel.
+	 */
+	v.data = data;
+	v.npts = npts;
+	v.mask = mask;
+	parallel_run(ndata, 0, basic_qc_vector, &v);
 	
 	*m = mask;
 
@@ -314,6 +334,39 @@ basic_qc(float *data, int npts, QCMask *mask)
 	if(e2) free(e2);
 }
 
+static void
+basic_qc_vector(int i, void *arg)
+{
+	QCVectors *v = (QCVectors *)arg;
+
+	/* Don't attempt masking if there is no data */
+	if(v->data[i]) basic_qc(v->data[i], v->npts[i], &v->mask[i]);
+}
+
+static void
+basic_mean_vector(int i, void *arg)
+{
+	QCVectors *v = (QCVectors *)arg;
+
+	if(v->data[i])
+	{
+	    basic_qc(v->data[i], v->npts[i], &v->mask[i]);
+	    qc_mean(v->data[i], v->npts[i], &v->mask[i], &v->mean[i]);
+	}
+}
+
+static void
+ss_spikes_vector(int i, void *arg)
+{
+	QCVectors *v = (QCVectors *)arg;
+
+	if(v->data[i] && !qc_all_masked(v->npts[i], &v->mask[i]))
+	{
+	    find_ss_spikes(v->data[i], v->npts[i], &v->mask[i],
+				&v->ind[i], &v->nind[i]);
+	}
+}
+
 
 int 
 qc_extended(float **data, int *npts, int ndata, QCDef *def, int type,
@@ -341,6 +394,7 @@ qc_extended(float **data, int *npts, int ndata, QCDef *def, int type,
 	int	nover;
 	int	ndiff;			/* nsamp - nover */
 
+	QCVectors v;
 	int     ret = 0;
 	int	i, j;
 	char	*fname = "extended_qc";
@@ -490,11 +544,12 @@ qc_extended(float **data, int *npts, int ndata, QCDef *def, int type,
 		
 	    if(!(dp[i] = (float *)mallocWarn(nsamp*sizeof(float)))) goto RETURN;
 	    memset((void *)dp[i], 0, nsamp*sizeof(float));
-
-	    basic_qc(data[i], npts[i], &m1[i]);
-
-	    qc_mean(data[i], npts[i], &m1[i], &mean[i]);
 	}
+	v.data = data;
+	v.npts = npts;
+	v.mask = m1;
+	v.mean = mean;
+	parallel_run(ndata, 0, basic_mean_vector, &v);
 	
 	/* 
 	 * Iterate over extended quality control, re-computing mean
@@ -627,7 +682,7 @@ extended_qc(float **data, int *npts, int ndata, QCDef *def, int type,
 	int	**mda_ind = NULL;	/* ...for multiple data arrays... */
 	int	*mda_nind = NULL;
 	
-	float	*d = NULL;		
+	QCVectors v;
 	int	i, n;
 
 	if(type != QC_EXTENDED_ARRAY)
@@ -647,7 +702,6 @@ extended_qc(float **data, int *npts, int ndata, QCDef *def, int type,
 	 */
 	for(i = 0; i < ndata; i++)
 	{
-	    d = data[i];
 	    n = npts[i];
 
 	    /* Copy definition structure into mask */
@@ -657,18 +711,23 @@ extended_qc(float **data, int *npts, int ndata, QCDef *def, int type,
 	    if(qc_all_masked (n, &imask[i]))
 	    {
 		all_masked++;
-		continue;
-	    }
-	    /* 
-	     * Locate single data vector spikes if desired.
-	     * Save the indices for merging with multiple data 
-	     * array spike indices later. The ss_ind are allocated.
-	     */
-	    if(d && type != QC_EXTENDED_ARRAY)
-	    {
-		find_ss_spikes(d, n,&imask[i],&ss_ind[i],&ss_nind[i]);
 	    }
 	}
+
+	/* 
+	 * Locate single data vector spikes if desired, in parallel.
+	 * Save the indices for merging with multiple data 
+	 * array spike indices later. The ss_ind are allocated.
+	 */
+	if(type != QC_EXTENDED_ARRAY)
+	{
+	    v.data = data;
+	    v.npts = npts;
+	    v.mask = imask;
+	    v.ind = ss_ind;
+	    v.nind = ss_nind;
+	    parallel_run(ndata, 0, ss_spikes_vector, &v);
+	}
 	
 	/* 
 	 * Only do array masking if some data vectors are not completely
@@ -1266,6 +1325,7 @@ qc_check_segment(int istart, int iend, QCMask *mask, int seglen)
 	int	*i2 = NULL;
 	int     datalen;
 	int	ilen;
+	int	lo, hi;
 	int	i;
 
 	if(qc_all_valid(mask)) return (0);
@@ -1281,12 +1341,22 @@ qc_check_segment(int istart, int iend, QCMask *mask, int seglen)
 	i1 = mask->start;
 	i2 = mask->end;   
 
+	/* first segment that ends at or after istart */
+	lo = 0;
+	hi = mask->nseg;
+	while(lo < hi)
+	{
+	     i = (lo + hi)/2;
+	     if(i2[i] < istart) lo = i + 1;
+	     else hi = i;
+	}
+
 	/*
-	 * check all mask segments, clipping segment lengths that
-	 *  extend beyond the data interval.
+	 * check the mask segments that start before iend, clipping
+	 * segment lengths that extend beyond the data interval.
 	 */
 
-	for(i = 0; i < mask->nseg; i++)
+	for(i = lo; i < mask->nseg && i1[i] <= iend; i++)
 	{
 	     if(BETWEEN(istart, i1[i], i2[i]))
 	     {
@@ -0,0 +1,385 @@
+/*
+ * NAME
+ *
+ *	qc_stream_create
+ *	qc_stream_process
+ *	qc_stream_channels
+ *	qc_stream_finish
+ *	qc_stream_destroy
+ *
+ * FILE
+ *
+ *	qc_stream.c
+ *
+ * SYNOPSIS
+ *
+ *	QCStream *
+ *	qc_stream_create (def)
+ *	QCDef	*def;		(i) Mask definition
+ *
+ *	int
+ *	qc_stream_process (qs, data, npts)
+ *	QCStream *qs;		(i/o) Stream state
+ *	float	*data;		(i) Next block of data
+ *	int	npts;		(i) Number of points in data
+ *
+ *	int
+ *	qc_stream_channels (qs, nchan, data, npts)
+ *	QCStream **qs;		(i/o) Stream state for each data vector
+ *	int	nchan;		(i) Number of data vectors
+ *	float	**data;		(i) Next block of each data vector
+ *	int	*npts;		(i) Number of points in each block
+ *
+ *	int
+ *	qc_stream_finish (qs, mask)
+ *	QCStream *qs;		(i) Stream state
+ *	QCMask	*mask;		(o) Mask for all of the data read
+ *
+ *	void
+ *	qc_stream_destroy (qs)
+ *
+ * DESCRIPTION
+ *
+ *	These routines perform the basic quality control of qc_basic() on
+ *	data that is read one block at a time.  Only the last few samples,
+ *	the length of the current run of equal values and the bad segments
+ *	found so far are kept between blocks, so the data itself does not
+ *	need to be in memory all at once.
+ *
+ *	qc_stream_process () checks the next block of data for single
+ *	point spikes and gaps as find_points() does, and for runs of
+ *	def->drop_thr or more equal values as find_sequences() does.  The
+ *	indices are counted from the first sample given to the stream.
+ *	qc_stream_channels () calls qc_stream_process () for each data
+ *	vector, in parallel where threads are available.
+ *
+ *	qc_stream_finish () completes the checks at the end of the data and
+ *	fills mask with the merged segments.  The mask is the same as
+ *	qc_basic() returns for the whole data vector, and its contents must
+ *	be freed by the calling routine.  The stream can then be destroyed.
+ *
+ *	qc_stream_process (), qc_stream_channels () and qc_stream_finish ()
+ *	return 0 on success, -1 on error.
+ *
+ *	Only the basic checks are streamed.  The extended checks of
+ *	qc_extended() and the spike finders (find_ms_spikes(),
+ *	find_ss_spikes()) compare each sample with statistics of the whole
+ *	data vector, so they still need all of the data in memory.
+ *
+ * SEE ALSO
+ *
+ *	qc_basic(), find_points(), find_sequences()
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "dyn_array.h"
+#include "libdataqcp.h"
+#include "libstring.h"
+#include "logErrorMsg.h"
+
+#define FREE(a) if(a) {free(a); a = NULL;}
+
+#define ABS(x)		(fabs ((double)(x)))
+
+#define CHECK_ZERO(d,dp1,dm1)	( (ABS((d))<QC_ZERO_TOL) && ((dp1)*(dm1)>0.0) )
+
+/* The last samples, indexed by sample number */
+#define NHIST	8
+#define X(qs,i)	((qs)->x[(i) & (NHIST-1)])
+
+struct qc_stream
+{
+	QCDef	def;
+	int	n;		/* Number of samples read */
+	float	x[NHIST];	/* Last samples */
+	double	diff0;		/* Last first difference for find_points */
+	double	hold;		/* Current value for find_sequences */
+	int	nrun;		/* Number of consecutive equal values */
+	Array	ps, pe;		/* Point segments */
+	Array	ss, se;		/* Sequence segments */
+};
+
+static void stream_point(QCStream *qs, int i);
+static void add_segment(Array s, Array e, int start, int end);
+static void free_segments(Array s, Array e);
+static void reset_segments(Array *s, Array *e);
+
+
+QCStream *
+qc_stream_create(QCDef *def)
+{
+	QCStream *qs;
+
+	if(def == NULL) {
+	    logErrorMsg(LOG_WARNING, "qc_stream_create: Bad def input.");
+	    return NULL;
+	}
+	if(!(qs = (QCStream *)mallocWarn(sizeof(QCStream)))) return NULL;
+	memset((void *)qs, 0, sizeof(QCStream));
+
+	memcpy((void *)&qs->def, (void *)def, sizeof(QCDef));
+
+	qs->ps = array_create(sizeof(int));
+	qs->pe = array_create(sizeof(int));
+	qs->ss = array_create(sizeof(int));
+	qs->se = array_create(sizeof(int));
+
+	return qs;
+}
+
+int
+qc_stream_process(QCStream *qs, float *data, int npts)
+{
+	int	i, j;
+
+	if(qs == NULL || (npts > 0 && data == NULL)) return -1;
+
+	for(j = 0; j < npts; j++)
+	{
+	    i = qs->n++;
+	    X(qs, i) = data[j];
+
+	    /* find_sequences() */
+	    if(i == 0)
+	    {
+		qs->hold = data[j];
+		qs->nrun = 1;
+	    }
+	    else if(data[j] == qs->hold)
+	    {
+		qs->nrun++;
+	    }
+	    else
+	    {
+		if(qs->nrun >= qs->def.drop_thr)
+		{
+		    add_segment(qs->ss, qs->se, i - qs->nrun, i - 1);
+		}
+		qs->nrun = 1;
+		qs->hold = data[j];
+	    }
+
+	    /* find_points(), which needs two samples after each point */
+	    if(i == 2)
+	    {
+		if(CHECK_ZERO(X(qs,1), X(qs,2), X(qs,0)))
+		{
+		    add_segment(qs->ps, qs->pe, 1, 1);
+		}
+		qs->diff0 = X(qs,1) - X(qs,2);
+	    }
+	    else if(i >= 4)
+	    {
+		stream_point(qs, i - 2);
+	    }
+	}
+	return 0;
+}
+
+typedef struct
+{
+	QCStream	**qs;
+	float		**data;
+	int		*npts;
+	int		ret;
+} QCStreamWork;
+
+static void
+stream_channel(int i, void *arg)
+{
+	QCStreamWork *w = (QCStreamWork *)arg;
+
+	if(w->qs[i] && w->data[i] &&
+		qc_stream_process(w->qs[i], w->data[i], w->npts[i]) < 0)
+	{
+	    w->ret = -1;
+	}
+}
+
+int
+qc_stream_channels(QCStream **qs, int nchan, float **data, int *npts)
+{
+	QCStreamWork w;
+
+	if(qs == NULL || data == NULL || npts == NULL) return -1;
+
+	w.qs = qs;
+	w.data = data;
+	w.npts = npts;
+	w.ret = 0;
+
+	parallel_run(nchan, 0, stream_channel, &w);
+
+	return w.ret;
+}
+
+int
+qc_stream_finish(QCStream *qs, QCMask *mask)
+{
+	int	*s1 = NULL, *e1 = NULL, *s2 = NULL, *e2 = NULL;
+	int	*st = NULL, *en = NULL;
+	int	*start = NULL, *end = NULL;
+	int	n1 = 0, n2 = 0, nseg = 0;
+	int	i, n;
+
+	if(qs == NULL || mask == NULL) return -1;
+
+	memset((void *)mask, 0, sizeof(QCMask));
+	memcpy((void *)&mask->def, (void *)&qs->def, sizeof(QCDef));
+
+	n = qs->n;
+
+	/* The last point checked by find_points() */
+	if(n >= 3)
+	{
+	    i = n - 2;
+	    if(CHECK_ZERO(X(qs,i), X(qs,i+1), X(qs,i-1)))
+	    {
+		add_segment(qs->ps, qs->pe, i, i);
+	    }
+	}
+	/* Take the lists of the arrays, which are freed below */
+	n1 = array_count(qs->ps);
+	s1 = (int *)array_list(qs->ps);
+	e1 = (int *)array_list(qs->pe);
+	reset_segments(&qs->ps, &qs->pe);
+
+	/* The last sequence, then merge consecutive sequences */
+	if(n > 0 && n >= qs->def.drop_thr)
+	{
+	    if(qs->nrun >= qs->def.drop_thr)
+	    {
+		add_segment(qs->ss, qs->se, n - qs->nrun, n - 1);
+	    }
+	}
+	n2 = array_count(qs->ss);
+	s2 = (int *)array_list(qs->ss);
+	e2 = (int *)array_list(qs->se);
+	reset_segments(&qs->ss, &qs->se);
+
+	if(n2 > 2)
+	{
+	    st = s2;
+	    en = e2;
+
+	    array_add(qs->ss, (char *)&st[0]);
+	    for(i = 1; i < n2; i++)
+	    {
+		if(en[i-1] != st[i] - 1)
+		{
+		    array_add(qs->se, (char *)&en[i-1]);
+		    array_add(qs->ss, (char *)&st[i]);
+		}
+	    }
+	    array_add(qs->se, (char *)&en[n2-1]);
+	    FREE(st);
+	    FREE(en);
+
+	    n2 = array_count(qs->ss);
+	    s2 = (int *)array_list(qs->ss);
+	    e2 = (int *)array_list(qs->se);
+	    reset_segments(&qs->ss, &qs->se);
+	}
+
+	merge_segments(s1, e1, n1, s2, e2, n2, &start, &end, &nseg);
+
+	mask->start = start;
+	mask->end = end;
+	mask->nseg = nseg;
+
+	FREE(s1);
+	FREE(e1);
+	FREE(s2);
+	FREE(e2);
+
+	return 0;
+}
+
+void
+qc_stream_destroy(QCStream *qs)
+{
+	if(qs == NULL) return;
+
+	/* array_free() does not free the lists */
+	free_segments(qs->ps, qs->pe);
+	free_segments(qs->ss, qs->se);
+	free(qs);
+}
+
+/*
+ * The single point zero gap and spike test of find_points() for
+ * point i, which needs samples i-2 to i+2.
+ */
+static void
+stream_point(QCStream *qs, int i)
+{
+	double	diff1;
+	double	test0, test1;
+	double	d0, d1;
+	double	dp1, dp2, dm1, dm2;
+
+	dm1 = X(qs, i - 1);
+	dm2 = X(qs, i - 2);
+	dp1 = X(qs, i + 1);
+	dp2 = X(qs, i + 2);
+
+	diff1 = X(qs, i) - dp1;
+
+	if(CHECK_ZERO (X(qs, i),dp1,dm1))
+	{
+	    add_segment(qs->ps, qs->pe, i, i);
+	}
+	else if (qs->diff0 * diff1 < 0.0)
+	{
+	    d0 = ABS (qs->diff0);
+	    d1 = ABS (diff1);
+
+	    test0 = MIN (d0, d1);
+
+	    d0 = ABS (dm2 - dm1);
+	    d1 = ABS (dp1 - dp2);
+
+	    test1 = MAX (d0, d1);
+
+	    if(test0 > qs->def.single_trace_spike_thr * test1)
+	    {
+		add_segment(qs->ps, qs->pe, i, i);
+	    }
+	}
+	qs->diff0 = diff1;
+}
+
+static void
+add_segment(Array s, Array e, int start, int end)
+{
+	array_add(s, (char *)&start);
+	array_add(e, (char *)&end);
+}
+
+static void
+free_segments(Array s, Array e)
+{
+	char	*list;
+
+	if((list = array_list(s)) != NULL) free(list);
+	if((list = array_list(e)) != NULL) free(list);
+	array_free(s);
+	array_free(e);
+}
+
+/*
+ * Replace arrays whose lists have been taken by the caller with empty
+ * arrays.
+ */
+static void
+reset_segments(Array *s, Array *e)
+{
+	array_free(*s);
+	array_free(*e);
+	*s = array_create(sizeof(int));
+	*e = array_create(sizeof(int));
+}
@@ -0,0 +1,301 @@
+#include "config.h"
+#include "libstalta.h"
+#include "logErrorMsg.h"
+#include <math.h>
+
+#define Free(a) if(a){free(a); a = NULL;}
+
+/*
+ * A streaming form of stalta().  Instead of n-length ratio, vsta and vlta
+ * arrays, only the running sums and a ring of the last lta+sta+buf+2
+ * samples are kept for each channel, so the memory does not grow with the
+ * length of the data.  The channels are stored interleaved in the ring so
+ * that the sum updates for one sample run down contiguous memory for all
+ * channels; the trigger logic is applied after the sums.
+ *
+ * The arithmetic and the htrig, ltrig, wtrig and trgsep logic follow
+ * stalta() exactly, so for one channel read in any number of blocks the
+ * triggers are the same as stalta() returns for the whole trace.  Because
+ * a new trigger within trgsep of the last one reopens it, a trigger is
+ * reported only when trgsep has passed after its off time, or by
+ * staltaStreamFlush() at the end of the data.  Trigger times are sample
+ * indices from the start of the stream.
+ */
+
+static int addTrigger(StaLtaStream *ss, int c);
+static void staltaSample(StaLtaStream *ss, long i);
+
+#define ROW(ss, k) ((ss)->ring + ((k) & (ss)->mask)*(ss)->nchan)
+
+StaLtaStream *
+newStaLtaStream(StaLtaDef * s, int nchan)
+{
+	StaLtaStream *ss;
+	int size;
+
+	if (nchan < 1 || s->sta < 1 || s->lta < 1)
+	{
+	    logErrorMsg(LOG_ERR, "newStaLtaStream: invalid sta, lta or nchan.");
+	    return NULL;
+	}
+
+	ss = (StaLtaStream *) calloc(1, sizeof(StaLtaStream));
+	if (!ss)
+	{
+	    logErrorMsg(LOG_ERR, "newStaLtaStream: malloc failed.");
+	    return NULL;
+	}
+	ss->nchan = nchan;
+	ss->sta = s->sta;
+	ss->lta = s->lta;
+	ss->buf = s->buf;
+	ss->wtrig = s->wtrig;
+	ss->trgsep = s->trgsep;
+	ss->method = s->method;
+	ss->htrig = s->htrig;
+	ss->ltrig = s->ltrig;
+
+	for (size = 16; size < s->lta + s->sta + s->buf + 2; size *= 2);
+	ss->mask = size - 1;
+
+	ss->ring = (float *) malloc(size * nchan * sizeof(float));
+	ss->tsta = (double *) malloc(nchan * sizeof(double));
+	ss->tlta = (double *) malloc(nchan * sizeof(double));
+	ss->ratio = (double *) malloc(nchan * sizeof(double));
+	ss->tmaxratio = (double *) malloc(nchan * sizeof(double));
+	ss->trig = (int *) malloc(nchan * sizeof(int));
+	ss->tontime = (long *) malloc(nchan * sizeof(long));
+	ss->pending = (int *) malloc(nchan * sizeof(int));
+	ss->pend_on = (long *) malloc(nchan * sizeof(long));
+	ss->pend_off = (long *) malloc(nchan * sizeof(long));
+	ss->pend_max = (double *) malloc(nchan * sizeof(double));
+
+	if (!ss->ring || !ss->tsta || !ss->tlta || !ss->ratio
+	 || !ss->tmaxratio || !ss->trig || !ss->tontime || !ss->pending
+	 || !ss->pend_on || !ss->pend_off || !ss->pend_max)
+	{
+	    logErrorMsg(LOG_ERR, "newStaLtaStream: malloc failed.");
+	    freeStaLtaStream(ss);
+	    return NULL;
+	}
+	resetStaLtaStream(ss);
+
+	return ss;
+}
+
+void
+resetStaLtaStream(StaLtaStream * ss)
+{
+	int c;
+
+	ss->n = 0;
+	ss->ntriggers = 0;
+	for (c = 0; c < ss->nchan; c++)
+	{
+	    ss->tsta[c] = 0.0;
+	    ss->tlta[c] = 0.0;
+	    ss->ratio[c] = 0.0;
+	    ss->tmaxratio[c] = 0.0;
+	    ss->trig[c] = False;
+	    ss->tontime[c] = 0;
+	    ss->pending[c] = False;
+	}
+}
+
+void
+freeStaLtaStream(StaLtaStream * ss)
+{
+	if (!ss) return;
+
+	Free(ss->ring);
+	Free(ss->tsta);
+	Free(ss->tlta);
+	Free(ss->ratio);
+	Free(ss->tmaxratio);
+	Free(ss->trig);
+	Free(ss->tontime);
+	Free(ss->pending);
+	Free(ss->pend_on);
+	Free(ss->pend_off);
+	Free(ss->pend_max);
+	Free(ss->triggers);
+	free(ss);
+}
+
+/* Read the next n samples of each channel. Returns the number of triggers
+ * completed, which are in ss->triggers until the next call, or -1.
+ */
+int
+staltaStream(StaLtaStream * ss, int n, float **indata)
+{
+	int j, c, nchan = ss->nchan;
+	int first = ss->lta + ss->sta + ss->buf;
+	long k, i;
+	float *row;
+	double tsta, tlta;
+
+	ss->ntriggers = 0;
+
+	for (j = 0; j < n; j++)
+	{
+	    k = ss->n++;
+	    row = ROW(ss, k);
+	    for (c = 0; c < nchan; c++) row[c] = indata[c][j];
+
+	    if (k == first)
+	    {
+		/* fill the LTA and STA windows as stalta() does */
+		for (c = 0; c < nchan; c++)
+		{
+		    tlta = 0.0;
+		    tsta = 0.0;
+		    for (i = 0; i <= ss->lta; i++)
+			tlta += fabs(ROW(ss, i)[c])/ss->lta;
+		    for (i = ss->lta + ss->buf; i <= first; i++)
+			tsta += fabs(ROW(ss, i)[c])/ss->sta;
+		    ss->tlta[c] = tlta;
+		    ss->tsta[c] = tsta;
+		}
+	    }
+	    else if (k > first)
+	    {
+		staltaSample(ss, k - ss->sta);
+		if (ss->ntriggers < 0) return -1;
+	    }
+	}
+	return ss->ntriggers;
+}
+
+/* Report the triggers still waiting on trgsep. As in stalta(), a trigger
+ * that is still on at the end of the data is not reported.
+ */
+int
+staltaStreamFlush(StaLtaStream * ss)
+{
+	int c;
+
+	ss->ntriggers = 0;
+
+	for (c = 0; c < ss->nchan; c++)
+	{
+	    if (ss->pending[c] && addTrigger(ss, c) < 0) return -1;
+	}
+	return ss->ntriggers;
+}
+
+/* Advance every channel to sample i, which needs samples i-lta-1 to i+sta.
+ */
+static void
+staltaSample(StaLtaStream *ss, long i)
+{
+	int c, nchan = ss->nchan;
+	int sta = ss->sta, lta = ss->lta;
+	float *xm1 = ROW(ss, i-1);
+	float *xi = ROW(ss, i);
+	float *xs = ROW(ss, i+sta);
+	float *xl = ROW(ss, i-lta);
+	float *xl1 = ROW(ss, i-lta-1);
+	double *tsta = ss->tsta;
+	double *tlta = ss->tlta;
+	double *ratio = ss->ratio;
+	int *trig = ss->trig;
+
+	/* update the sums for all channels */
+	if (ss->method == 1)
+	{
+	    for (c = 0; c < nchan; c++)
+	    {
+		/* stalta() drops one sample later while triggered */
+		float old = trig[c] ? xl[c] : xl1[c];
+
+		tlta[c] += ((fabs(xm1[c])/lta) - (fabs(old)/lta));
+		tsta[c] += ((fabs(xs[c])/sta) - (fabs(xi[c]/sta)));
+		ratio[c] = tsta[c]/tlta[c];
+	    }
+	}
+	else
+	{
+	    for (c = 0; c < nchan; c++)
+	    {
+		/* the LTA is frozen while triggered */
+		if (!trig[c]) tlta[c] += (fabs(xm1[c])-tlta[c])/lta;
+		tsta[c] += (fabs(xs[c])-tsta[c])/sta;
+		ratio[c] = tsta[c]/tlta[c];
+	    }
+	}
+
+	/* then the trigger logic */
+	for (c = 0; c < nchan; c++)
+	{
+	    if (ss->pending[c] && (i - ss->pend_off[c]) > ss->trgsep)
+	    {
+		if (addTrigger(ss, c) < 0) return;
+	    }
+
+	    if (!trig[c])
+	    {
+		if (ratio[c] >= ss->htrig)
+		{
+		    trig[c] = True;
+		    if (ss->pending[c])
+		    {
+			/* reopen the last trigger */
+			if (ratio[c] >= ss->tmaxratio[c])
+			    ss->tmaxratio[c] = ratio[c];
+			ss->pending[c] = False;
+			ss->tontime[c] = ss->pend_on[c];
+		    }
+		    else
+		    {
+			ss->tontime[c] = i;
+			ss->tmaxratio[c] = ratio[c];
+		    }
+		}
+	    }
+	    else
+	    {
+		if (ratio[c] >= ss->tmaxratio[c]) ss->tmaxratio[c] = ratio[c];
+		if (ratio[c] <= ss->ltrig)
+		{
+		    trig[c] = False;
+		    if ((i - ss->tontime[c]) >= ss->wtrig)
+		    {
+			ss->pending[c] = True;
+			ss->pend_on[c] = ss->tontime[c];
+			ss->pend_off[c] = i;
+			ss->pend_max[c] = ss->tmaxratio[c];
+		    }
+		}
+	    }
+	}
+}
+
+static int
+addTrigger(StaLtaStream *ss, int c)
+{
+	StaLtaTrigger *t;
+	int size;
+
+	if (ss->ntriggers == ss->size_triggers)
+	{
+	    size = (ss->size_triggers > 0) ? 2*ss->size_triggers : 16;
+	    t = (StaLtaTrigger *) realloc(ss->triggers,
+				size*sizeof(StaLtaTrigger));
+	    if (!t)
+	    {
+		logErrorMsg(LOG_ERR, "staltaStream: malloc failed.");
+		ss->ntriggers = -1;
+		return -1;
+	    }
+	    ss->triggers = t;
+	    ss->size_triggers = size;
+	}
+	t = &ss->triggers[ss->ntriggers++];
+	t->chan = c;
+	t->ontime = ss->pend_on[c];
+	t->offtime = ss->pend_off[c];
+	t->maxratio = ss->pend_max[c];
+	ss->pending[c] = False;
+
+	return 0;
+}
@@ -108,9 +108,11 @@
  *	external access to correct_az_slow() is limited a single instanti-
  *	ation when arrival records are read.  If the arrival records have 
  *	not yet been corrected, function, locate_event(), will make sure
- *	the SASCs are applied.  In this case, the static Ar_SASC structure,
- *	active_ar_sasc (local to this file), must be freed upon completion
- *	of event location (see bottom of locate_event.c).  This function is
+ *	the SASCs are applied.  In this case, the Ar_SASC array,
+ *	active_ar_sasc (kept per thread in loc_state()), must be freed upon
+ *	completion of event location (see bottom of locate_event.c).
+ *	get_ar_sasc() only sees the corrections made by the calling
+ *	thread.  This function is
  *	also recommended if new arrival records are introduced by a calling
  *	application/function.
 
@@ -167,6 +169,7 @@
 #include <dirent.h>
 #include <math.h>
 #include "libloc.h"
+#include "locp.h"
 #include "loc_defs.h"
 #include "dyn_array.h"
 #include "ar_sasc.h"
@@ -206,8 +209,6 @@ typedef	struct	sasc {
 static	SASC_Tables	*sasc = (SASC_Tables *) NULL;
 static	int		num_sta_w_sasc = 0;
 static	Bool		make_sasc_adj_in_locator = TRUE;
-static	Ar_SASC		*active_ar_sasc = (Ar_SASC *) NULL;
-static	int		ar_sasc_cnt = 0;
 
 int
 #ifdef UsePrototypes
@@ -721,6 +722,7 @@ double	*tot_slow_err;	/* Total slowness error */
 	double	azr, sx, sy, adj_sx, adj_sy;
 
 	Ar_SASC	ar_sasc;
+	Loc_State *state;
 
 
 	/*
@@ -773,8 +775,10 @@ double	*tot_slow_err;	/* Total slowness error */
 
 		/* check if SASC was loaded into memory */
 
+		loc_lock ();
 		if (sasc[sta_index].num_bins == -999)
 		    load_single_sasc(sta_index);
+		loc_unlock ();
 
 		break;
 	    }
@@ -912,14 +916,16 @@ double	*tot_slow_err;	/* Total slowness error */
 	*tot_az_err = ar_sasc.tot_az_err;
 	*tot_slow_err = ar_sasc.tot_slow_err;
 
-	if ((active_ar_sasc = 
-		(Ar_SASC *) realloc (active_ar_sasc, (ar_sasc_cnt+1) * sizeof (Ar_SASC))) == (Ar_SASC *) NULL)
+	state = loc_state();
+	if ((state->active_ar_sasc = 
+		(Ar_SASC *) realloc (state->active_ar_sasc, (state->ar_sasc_cnt+1) * sizeof (Ar_SASC))) == (Ar_SASC *) NULL)
 	{
 	    fprintf (stderr, "Memory reallocation failure in correct_az_slow()\n");
+	    state->ar_sasc_cnt = 0;
 	    return;
 	}
-	MCOPY (&active_ar_sasc[ar_sasc_cnt], &ar_sasc, sizeof (Ar_SASC));
-	ar_sasc_cnt++;
+	MCOPY (&state->active_ar_sasc[state->ar_sasc_cnt], &ar_sasc, sizeof (Ar_SASC));
+	state->ar_sasc_cnt++;
 
 /*
 	if (num_active_ar_sasc != 0)
@@ -981,9 +987,11 @@ free_active_ar_sasc ()
 free_active_ar_sasc ()
 #endif
 {
-	ar_sasc_cnt = 0;	/* Reset ar_sasc counter */
-	UFREE (active_ar_sasc);
-	active_ar_sasc = (Ar_SASC *) NULL;
+	Loc_State *state = loc_state();
+
+	state->ar_sasc_cnt = 0;	/* Reset ar_sasc counter */
+	UFREE (state->active_ar_sasc);
+	state->active_ar_sasc = (Ar_SASC *) NULL;
 }
 
 
@@ -998,12 +1006,13 @@ int     arid;
          int     i;
 	 Arrival Na_Arrival = Na_Arrival_Init;
          Ar_SASC ar_sasc;
+	 Loc_State *state = loc_state();
 
          ar_sasc.arid = Na_Arrival.arid;
 
-         for (i = 0; i < ar_sasc_cnt; i++)
-             if (active_ar_sasc[i].arid == arid)
-                 return (active_ar_sasc[i]);
+         for (i = 0; i < state->ar_sasc_cnt; i++)
+             if (state->active_ar_sasc[i].arid == arid)
+                 return (state->active_ar_sasc[i]);
 
          return (ar_sasc);
 }
@@ -0,0 +1,829 @@
+
+/*
+ * NAME
+ *	compile_tt_tables -- Compile the travel-time tables of a VMSF.
+ *	remove_compiled_tt_tables -- Remove the compiled files of a VMSF.
+ *	write_compiled_tt_tables -- Write one compiled table file.
+ *	open_compiled_tt_tables -- Map a compiled table file.
+ *	read_compiled_tt_table -- Fill a tt_table entry from a compiled file.
+ *	release_compiled_tt_tables -- Release a compiled table file.
+ *	free_tt_table -- Free the arrays of a tt_table entry.
+
+ * FILE
+ *	compiled_tt_tables.c
+
+ * SYNOPSIS
+ *	int
+ *	compile_tt_tables (vmodel_filename, phase_list, num_phases)
+ *	char	*vmodel_filename;	(i) Velocity model file name location
+ *	char	**phase_list;		(i) Pointer to list of phases
+ *	int	num_phases;		(i) Number of phases in above list
+
+ *	int
+ *	remove_compiled_tt_tables (vmodel_filename, phase_list, num_phases)
+ *	char	*vmodel_filename;	(i) Velocity model file name location
+ *	char	**phase_list;		(i) Pointer to list of phases
+ *	int	num_phases;		(i) Number of phases in above list
+
+ *	int
+ *	write_compiled_tt_tables (file_name, vmodel, tt_table,
+ *				  list_of_phases, num_ec_phases)
+ *	char	*file_name;		(i) Compiled file to write
+ *	char	*vmodel;		(i) Velocity model name
+ *	TT_Table *tt_table;		(i) Travel-time table structure
+ *	List_of_Phases *list_of_phases;	(i) Phases of vmodel to write
+ *	int	num_ec_phases;		(i) Ellipticity corrections are
+ *					    written for phase indexes less
+ *					    than this
+
+ *	TT_Compiled *
+ *	open_compiled_tt_tables (dir_pathway, vmodel)
+ *	char	*dir_pathway;		(i) Travel-time table directory
+ *	char	*vmodel;		(i) Velocity model name
+
+ *	int
+ *	read_compiled_tt_table (ttc, file_name, phase, want_ec, tt_table)
+ *	TT_Compiled *ttc;		(i) Compiled file from
+ *					    open_compiled_tt_tables()
+ *	char	*file_name;		(i) Text table file for phase
+ *	char	*phase;			(i) Phase to find
+ *	Bool	want_ec;		(i) Also set ellipticity corrections
+ *	TT_Table *tt_table;		(o) Entry to fill
+
+ *	void
+ *	release_compiled_tt_tables (ttc)
+ *	TT_Compiled *ttc;		(i) Compiled file
+
+ *	void
+ *	free_tt_table (tt_table, free_ec_table)
+ *	TT_Table *tt_table;		(i) Entry to free
+ *	Bool	free_ec_table;		(i) Also free ellipticity corrections
+
+ * DESCRIPTION
+ *	Functions.  A compiled travel-time table file holds the travel-
+ *	time tables, modelling errors and ellipticity correction tables of
+ *	every phase of one velocity model, as they are held in the tt_table
+ *	structure, in a single binary file named <vmodel>.ttc in the model
+ *	directory.  read_tt_tables() uses it in place of the text tables of
+ *	the model, so that the tables need not be parsed for each session
+ *	or model change.
+
+ *	-- compile_tt_tables() reads the text tables of all velocity models
+ *	in the VMSF, vmodel_filename, for the phases in phase_list and the
+ *	station/phase/model entries, as read_tt_tables() does, then writes
+ *	a compiled file into each model directory.  Each file is written
+ *	to a temporary name and then renamed, so a process that has the
+ *	old file mapped is not disturbed.
+
+ *	-- remove_compiled_tt_tables() removes the compiled file of each
+ *	velocity model in the VMSF, so that the text tables are read again.
+
+ *	-- write_compiled_tt_tables() writes the compiled file for the
+ *	phases in list_of_phases.  Phases without a travel-time table are
+ *	skipped.
+
+ *	-- open_compiled_tt_tables() maps <dir_pathway>/<vmodel>.ttc into
+ *	memory and checks its header.  It returns NULL if there is no such
+ *	file, or if it has a different version or byte order, in which case
+ *	the text tables are to be read.
+
+ *	-- read_compiled_tt_table() sets the tables of tt_table for phase
+ *	from the mapped file.  The table arrays point directly into the
+ *	mapped file; only the row pointers are allocated.  The entry keeps
+ *	the file mapped until it is freed by free_tt_table().  If the text
+ *	table file_name is newer than the compiled file, the compiled entry
+ *	is not used.
+
+ *	-- release_compiled_tt_tables() releases the reference held by
+ *	open_compiled_tt_tables().  The file is unmapped when it is no
+ *	longer used by any tt_table entry.
+
+ *	-- free_tt_table() frees the arrays of a tt_table entry, whether read
+ *	from text tables or from a compiled file.
+
+ * DIAGNOSTICS
+ *	-- compile_tt_tables() returns OK or the error code of
+ *	read_tt_tables().  It returns TTerror2 if a compiled file cannot be
+ *	written.  remove_compiled_tt_tables() returns OK, the error code of
+ *	read_tt_tables(), or TTerror2 if a compiled file cannot be removed.
+ *	A model without a compiled file is not an error.
+
+ *	-- write_compiled_tt_tables() returns OK, or ERR if the file cannot
+ *	be written.
+
+ *	-- read_compiled_tt_table() returns OK if the entry was filled, ERR
+ *	if phase is not in the compiled file or the text table is newer,
+ *	TTerror3 for a corrupt entry and TTerror4 if memory cannot be
+ *	allocated.
+
+ * FILES
+ *	<dir_pathway>/<vmodel>.ttc compiled travel-time tables.
+
+ * NOTES
+ *	A compiled file is in the byte order of the host that wrote it,
+ *	so that it can be used in place.  A file written on a host of the
+ *	other byte order is ignored.  Compiled files should be rebuilt with
+ *	compile_tt_tables() when the text tables change.  SSSC and SRST
+ *	corrections are not included; they are read per station as before.
+
+ * SEE ALSO
+ *	read_tt_tables(), read_ec_table(), read_compiled_file() [libLP],
+ *	compiled_file_open() [libstring].
+ */
+
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "libloc.h"
+#include "libstring.h"
+#include "locp.h"
+#include "loc_defs.h"
+
+#define TTC_SUFFIX	".ttc"
+#define TTC_MAGIC	"TTCOMP\n"
+#define TTC_VERSION	1
+
+/* Bits of TTC_Entry.me_arrays */
+#define ME_DIST_SAMPLES		1
+#define ME_DEPTH_SAMPLES	2
+#define ME_DIST_VAR		4
+#define ME_DIST_DEPTH_VAR	8
+
+typedef struct
+{
+	CompiledFileHeader	file;
+	int	num_entries;
+	char	vmodel[16];
+} TTC_Header;
+
+/*
+ * The arrays of an entry follow each other as floats from offset:
+ * dist_samples, depth_samples, trv_time rows, then the ellipticity
+ * correction dist_samples, depth_samples, t0, t1 and t2 rows, then the
+ * modelling error arrays flagged in me_arrays.
+ */
+typedef struct
+{
+	char	phase[16];
+	char	vmodel[16];
+	int	last_leg;
+	int	num_dists;
+	int	num_depths;
+	float	in_hole_dist[2];
+	int	ec_num_dists;		/* 0 if no ellipticity corrections */
+	int	ec_num_depths;
+	int	me_arrays;		/* -1 if no modelling errors */
+	int	me_num_dists;
+	int	me_num_depths;
+	float	me_bulk_var;
+	int	offset;			/* Byte offset of the arrays */
+} TTC_Entry;
+
+struct tt_compiled
+{
+	int		ref_cnt;
+	CompiledFile	file;
+	TTC_Header	*header;
+	TTC_Entry	*entries;
+};
+
+static void entry_sizes(TT_Table *t, int num_ec_phases, int k,
+			TTC_Entry *e, int *nfloats);
+static void free_read_tables(TT_Table *tt_table, int total_num_phases,
+			int num_phases, Model_Descrip *model_descrip,
+			int num_models, Sta_Phase_Model *sta_phase_model);
+static Bool in_compiled_file(TT_Compiled *ttc, float *x);
+static void free_ec_rows(EC_Table *ec, Bool allocated);
+
+
+int
+compile_tt_tables (char *vmodel_filename, char **phase_list, int num_phases)
+{
+	int	n;
+	int	ierr;
+	int	total_num_phases = 0;
+	int	num_models = 0;
+	int	num_spm = 0;
+	char	file_name[FILENAMELEN];
+	char	tmp_name[FILENAMELEN+16];
+
+	TT_Table	*tt_table = (TT_Table *) NULL;
+	Model_Descrip	*model_descrip = (Model_Descrip *) NULL;
+	Sta_Phase_Model	*sta_phase_model = (Sta_Phase_Model *) NULL;
+
+
+	ierr = read_tt_tables (FALSE, vmodel_filename, phase_list, num_phases,
+				&tt_table, &total_num_phases, &model_descrip,
+				&num_models, &sta_phase_model, &num_spm);
+	if (ierr != OK)
+	    return (ierr);
+
+	for (n = 0; n < num_models && ierr == OK; n++)
+	{
+	    if (strlen (model_descrip[n].dir_pathway) +
+		strlen (model_descrip[n].vmodel) + 8 > FILENAMELEN)
+	    {
+		ierr = TTerror2;
+		break;
+	    }
+	    sprintf (file_name, "%s/%s%s", model_descrip[n].dir_pathway,
+			model_descrip[n].vmodel, TTC_SUFFIX);
+	    sprintf (tmp_name, "%s.%d", file_name, (int) getpid ());
+
+	    if (write_compiled_tt_tables (tmp_name, model_descrip[n].vmodel,
+				tt_table, model_descrip[n].list_of_phases,
+				num_phases) != OK ||
+		rename (tmp_name, file_name) != 0)
+	    {
+		fprintf (stderr, "compile_tt_tables: Cannot write %s\n",
+				file_name);
+		remove (tmp_name);
+		ierr = TTerror2;
+	    }
+	}
+
+	free_read_tables (tt_table, total_num_phases, num_phases,
+			  model_descrip, num_models, sta_phase_model);
+
+	return (ierr);
+}
+
+
+int
+remove_compiled_tt_tables (char *vmodel_filename, char **phase_list,
+			   int num_phases)
+{
+	int	n;
+	int	ierr;
+	int	total_num_phases = 0;
+	int	num_models = 0;
+	int	num_spm = 0;
+	char	file_name[FILENAMELEN];
+
+	TT_Table	*tt_table = (TT_Table *) NULL;
+	Model_Descrip	*model_descrip = (Model_Descrip *) NULL;
+	Sta_Phase_Model	*sta_phase_model = (Sta_Phase_Model *) NULL;
+
+
+	ierr = read_tt_tables (FALSE, vmodel_filename, phase_list, num_phases,
+				&tt_table, &total_num_phases, &model_descrip,
+				&num_models, &sta_phase_model, &num_spm);
+	if (ierr != OK)
+	    return (ierr);
+
+	for (n = 0; n < num_models; n++)
+	{
+	    if (strlen (model_descrip[n].dir_pathway) +
+		strlen (model_descrip[n].vmodel) + 8 > FILENAMELEN)
+	    {
+		ierr = TTerror2;
+		continue;
+	    }
+	    sprintf (file_name, "%s/%s%s", model_descrip[n].dir_pathway,
+			model_descrip[n].vmodel, TTC_SUFFIX);
+	    if (remove (file_name) != 0 && errno != ENOENT)
+	    {
+		fprintf (stderr, "remove_compiled_tt_tables: Cannot remove %s\n",
+				file_name);
+		ierr = TTerror2;
+	    }
+	}
+
+	free_read_tables (tt_table, total_num_phases, num_phases,
+			  model_descrip, num_models, sta_phase_model);
+
+	return (ierr);
+}
+
+
+int
+write_compiled_tt_tables (char *file_name, char *vmodel, TT_Table *tt_table,
+			  List_of_Phases *list_of_phases, int num_ec_phases)
+{
+	FILE	*fp;
+	int	i, k, n, nfloats, offset;
+	TTC_Header	header;
+	TTC_Entry	*entries;
+	TT_Table	*t;
+	EC_Table	*ec;
+	Model_Error	*me;
+	List_of_Phases	*ph;
+
+
+	for (n = 0, ph = list_of_phases; ph != NULL; ph = ph->next)
+	    if (tt_table[ph->phase_index].trv_time != NULL) n++;
+
+	if ((entries = (TTC_Entry *) calloc (n > 0 ? n : 1,
+					sizeof (TTC_Entry))) == NULL)
+	    return (ERR);
+
+	memset ((void *) &header, 0, sizeof (TTC_Header));
+	compiled_file_header (&header.file, TTC_MAGIC, TTC_VERSION);
+	header.num_entries = n;
+	strncpy (header.vmodel, vmodel, sizeof (header.vmodel) - 1);
+
+	offset = sizeof (TTC_Header) + n*sizeof (TTC_Entry);
+	for (i = 0, ph = list_of_phases; ph != NULL; ph = ph->next)
+	{
+	    k = ph->phase_index;
+	    if (tt_table[k].trv_time == NULL) continue;
+	    entry_sizes (&tt_table[k], num_ec_phases, k, &entries[i],
+			&nfloats);
+	    entries[i].offset = offset;
+	    offset += nfloats*sizeof (float);
+	    i++;
+	}
+
+	if ((fp = fopen (file_name, "w")) == NULL)
+	{
+	    free (entries);
+	    return (ERR);
+	}
+	fwrite (&header, sizeof (TTC_Header), 1, fp);
+	if (n > 0) fwrite (entries, sizeof (TTC_Entry), n, fp);
+
+	for (i = 0, ph = list_of_phases; ph != NULL; ph = ph->next)
+	{
+	    t = &tt_table[ph->phase_index];
+	    if (t->trv_time == NULL) continue;
+
+	    compiled_file_write_floats (fp, t->dist_samples, t->num_dists);
+	    compiled_file_write_floats (fp, t->depth_samples, t->num_depths);
+	    for (k = 0; k < t->num_depths; k++)
+		compiled_file_write_floats (fp, t->trv_time[k],
+				t->num_dists);
+
+	    if (entries[i].ec_num_dists > 0)
+	    {
+		ec = t->ec_table;
+		compiled_file_write_floats (fp, ec->dist_samples,
+				ec->num_dists);
+		compiled_file_write_floats (fp, ec->depth_samples,
+				ec->num_depths);
+		for (k = 0; k < ec->num_depths; k++)
+		    compiled_file_write_floats (fp, ec->t0[k], ec->num_dists);
+		for (k = 0; k < ec->num_depths; k++)
+		    compiled_file_write_floats (fp, ec->t1[k], ec->num_dists);
+		for (k = 0; k < ec->num_depths; k++)
+		    compiled_file_write_floats (fp, ec->t2[k], ec->num_dists);
+	    }
+
+	    if (entries[i].me_arrays > 0)
+	    {
+		me = t->model_error;
+		if (entries[i].me_arrays & ME_DIST_SAMPLES)
+		    compiled_file_write_floats (fp, me->dist_samples,
+				me->num_dists);
+		if (entries[i].me_arrays & ME_DEPTH_SAMPLES)
+		    compiled_file_write_floats (fp, me->depth_samples,
+				me->num_depths);
+		if (entries[i].me_arrays & ME_DIST_VAR)
+		    compiled_file_write_floats (fp, me->dist_var,
+				me->num_dists);
+		if (entries[i].me_arrays & ME_DIST_DEPTH_VAR)
+		    for (k = 0; k < me->num_depths; k++)
+			compiled_file_write_floats (fp, me->dist_depth_var[k],
+				me->num_dists);
+	    }
+	    i++;
+	}
+	free (entries);
+
+	if (ferror (fp))
+	{
+	    fclose (fp);
+	    return (ERR);
+	}
+	return (fclose (fp) == 0 ? OK : ERR);
+}
+
+
+TT_Compiled *
+open_compiled_tt_tables (char *dir_pathway, char *vmodel)
+{
+	int	n, ret;
+	char	file_name[FILENAMELEN];
+	TT_Compiled	*ttc;
+	TTC_Header	*h;
+
+	static	char	routine[] = "open_compiled_tt_tables";
+
+
+	if (strlen (dir_pathway) + strlen (vmodel) + 8 > FILENAMELEN)
+	    return ((TT_Compiled *) NULL);
+	sprintf (file_name, "%s/%s%s", dir_pathway, vmodel, TTC_SUFFIX);
+
+	if ((ttc = (TT_Compiled *) calloc (1, sizeof (TT_Compiled))) == NULL)
+	    return ((TT_Compiled *) NULL);
+
+	if ((ret = compiled_file_open (file_name, TTC_MAGIC, TTC_VERSION,
+				sizeof (TTC_Header), &ttc->file)) != 0)
+	{
+	    if (ret == -2)
+		fprintf (stderr, "%s: Cannot read %s: %s\n", routine,
+			file_name, strerror (errno));
+	    else if (ret == -3)
+		fprintf (stderr, "%s: %s is not a compiled table file for this host, using text tables\n", routine, file_name);
+	    free (ttc);
+	    return ((TT_Compiled *) NULL);
+	}
+	ttc->ref_cnt = 1;
+
+	h = ttc->header = (TTC_Header *) ttc->file.base;
+	ttc->entries = (TTC_Entry *) (ttc->file.base + sizeof (TTC_Header));
+	n = h->num_entries;
+
+	if (n < 0 || (size_t) n > (ttc->file.size - sizeof (TTC_Header))/
+			sizeof (TTC_Entry))
+	{
+	    fprintf (stderr, "%s: %s is not a compiled table file for this host, using text tables\n", routine, file_name);
+	    release_compiled_tt_tables (ttc);
+	    return ((TT_Compiled *) NULL);
+	}
+	return (ttc);
+}
+
+
+int
+read_compiled_tt_table (TT_Compiled *ttc, char *file_name, char *phase,
+			Bool want_ec, TT_Table *tt_table)
+{
+	int	i;
+	size_t	nfloats, max_floats;
+	float	*x;
+	struct	stat	buf;
+	TTC_Entry	*e = (TTC_Entry *) NULL;
+	TTC_Entry	check;
+	EC_Table	*ec;
+	Model_Error	*me;
+
+
+	for (i = 0; i < ttc->header->num_entries; i++)
+	{
+	    if (!strncmp (ttc->entries[i].phase, phase,
+			  sizeof (ttc->entries[i].phase)))
+	    {
+		e = &ttc->entries[i];
+		break;
+	    }
+	}
+	if (e == NULL)
+	    return (ERR);
+
+	/* A text table edited since compiling takes precedence */
+
+	if (stat (file_name, &buf) == 0 && buf.st_mtime > ttc->file.mtime)
+	    return (ERR);
+
+	/* Check the entry against the size of the file */
+
+	check = *e;
+	if (memchr (check.phase, '\0', sizeof (check.phase)) == NULL ||
+	    memchr (check.vmodel, '\0', sizeof (check.vmodel)) == NULL ||
+	    check.num_dists < 0 || check.num_depths < 0 ||
+	    check.ec_num_dists < 0 || check.ec_num_depths < 0 ||
+	    check.me_num_dists < 0 || check.me_num_depths < 0)
+	    return (TTerror3);
+	if (check.offset < 0 || (check.offset & (sizeof (float) - 1)) ||
+	    (size_t) check.offset > ttc->file.size)
+	    return (TTerror3);
+	max_floats = (ttc->file.size - (size_t) check.offset)/sizeof (float);
+	nfloats = 0;
+	if (!compiled_file_add_floats (&nfloats, max_floats,
+			check.num_dists, 1) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.num_depths, 1) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.num_dists, check.num_depths) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.ec_num_dists, 1) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.ec_num_depths, 1) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.ec_num_dists, check.ec_num_depths) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.ec_num_dists, check.ec_num_depths) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			check.ec_num_dists, check.ec_num_depths))
+	    return (TTerror3);
+	if (check.me_arrays > 0)
+	{
+	    if (((check.me_arrays & ME_DIST_SAMPLES) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			check.me_num_dists, 1)) ||
+		((check.me_arrays & ME_DEPTH_SAMPLES) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			check.me_num_depths, 1)) ||
+		((check.me_arrays & ME_DIST_VAR) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			check.me_num_dists, 1)) ||
+		((check.me_arrays & ME_DIST_DEPTH_VAR) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			check.me_num_dists, check.me_num_depths)))
+		return (TTerror3);
+	}
+
+	x = (float *) (ttc->file.base + e->offset);
+
+	strcpy (tt_table->phase, e->phase);
+	strncpy (tt_table->vmodel, e->vmodel, sizeof (tt_table->vmodel) - 1);
+	tt_table->vmodel[sizeof (tt_table->vmodel) - 1] = '\0';
+	tt_table->last_leg = e->last_leg;
+	tt_table->num_dists = e->num_dists;
+	tt_table->num_depths = e->num_depths;
+	tt_table->in_hole_dist[0] = e->in_hole_dist[0];
+	tt_table->in_hole_dist[1] = e->in_hole_dist[1];
+	tt_table->dist_samples = x;
+	x += e->num_dists;
+	tt_table->depth_samples = x;
+	x += e->num_depths;
+	if ((tt_table->trv_time = compiled_file_rows (x, e->num_depths,
+					e->num_dists)) == NULL)
+	    return (TTerror4);
+	x += e->num_depths*e->num_dists;
+	tt_table->compiled = ttc;
+	ttc->ref_cnt++;
+
+	if (e->ec_num_dists > 0)
+	{
+	    if (want_ec)
+	    {
+		if ((ec = (EC_Table *) calloc (1, sizeof (EC_Table))) == NULL)
+		    return (TTerror4);
+		tt_table->ec_table = ec;
+		ec->num_dists = e->ec_num_dists;
+		ec->num_depths = e->ec_num_depths;
+		ec->dist_samples = x;
+		x += ec->num_dists;
+		ec->depth_samples = x;
+		x += ec->num_depths;
+		ec->t0 = compiled_file_rows (x, ec->num_depths,
+				ec->num_dists);
+		x += ec->num_depths*ec->num_dists;
+		ec->t1 = compiled_file_rows (x, ec->num_depths,
+				ec->num_dists);
+		x += ec->num_depths*ec->num_dists;
+		ec->t2 = compiled_file_rows (x, ec->num_depths,
+				ec->num_dists);
+		x += ec->num_depths*ec->num_dists;
+		if (!ec->t0 || !ec->t1 || !ec->t2)
+		    return (TTerror4);
+	    }
+	    else
+		x += e->ec_num_dists + e->ec_num_depths
+			+ 3*e->ec_num_dists*e->ec_num_depths;
+	}
+
+	if (e->me_arrays >= 0)
+	{
+	    if ((me = (Model_Error *) calloc (1, sizeof (Model_Error))) == NULL)
+		return (TTerror4);
+	    tt_table->model_error = me;
+	    me->bulk_var = e->me_bulk_var;
+	    me->num_dists = e->me_num_dists;
+	    me->num_depths = e->me_num_depths;
+	    if (e->me_arrays & ME_DIST_SAMPLES)
+	    {
+		me->dist_samples = x;
+		x += me->num_dists;
+	    }
+	    if (e->me_arrays & ME_DEPTH_SAMPLES)
+	    {
+		me->depth_samples = x;
+		x += me->num_depths;
+	    }
+	    if (e->me_arrays & ME_DIST_VAR)
+	    {
+		me->dist_var = x;
+		x += me->num_dists;
+	    }
+	    if (e->me_arrays & ME_DIST_DEPTH_VAR)
+	    {
+		if ((me->dist_depth_var = compiled_file_rows (x, me->num_depths,
+						me->num_dists)) == NULL)
+		    return (TTerror4);
+	    }
+	}
+
+	return (OK);
+}
+
+
+void
+release_compiled_tt_tables (TT_Compiled *ttc)
+{
+	if (ttc == NULL || --ttc->ref_cnt > 0)
+	    return;
+
+	compiled_file_close (&ttc->file);
+	free (ttc);
+}
+
+
+void
+free_tt_table (TT_Table *tt_table, Bool free_ec_table)
+{
+	int	j;
+	EC_Table	*ec = tt_table->ec_table;
+	Model_Error	*me = tt_table->model_error;
+
+
+	if (tt_table->compiled != NULL)
+	{
+	    /* Only the row pointers and structures were allocated */
+
+	    UFREE (tt_table->trv_time);
+	    if (free_ec_table && ec != NULL)
+	    {
+		/*
+		 * The ellipticity corrections of a phase compiled without
+		 * them are read from the text tables.
+		 */
+
+		free_ec_rows (ec, !in_compiled_file (tt_table->compiled,
+						ec->dist_samples));
+		UFREE (tt_table->ec_table);
+	    }
+	    if (me != NULL)
+	    {
+		UFREE (me->dist_depth_var);
+		UFREE (tt_table->model_error);
+	    }
+	    release_compiled_tt_tables (tt_table->compiled);
+	    tt_table->compiled = (TT_Compiled *) NULL;
+	}
+	else
+	{
+	    if (tt_table->trv_time != NULL)
+	    {
+		for (j = 0; j < tt_table->num_depths; j++)
+		    UFREE (tt_table->trv_time[j]);
+		UFREE (tt_table->trv_time);
+	    }
+	    if (free_ec_table && ec != NULL)
+	    {
+		free_ec_rows (ec, TRUE);
+		UFREE (tt_table->ec_table);
+	    }
+	    if (me != NULL)
+	    {
+		UFREE (me->depth_samples);
+		UFREE (me->dist_var);
+		UFREE (me->dist_samples);
+		if (me->dist_depth_var != NULL)
+		{
+		    for (j = 0; j < me->num_depths; j++)
+			UFREE (me->dist_depth_var[j]);
+		    UFREE (me->dist_depth_var);
+		}
+		UFREE (tt_table->model_error);
+	    }
+	    UFREE (tt_table->depth_samples);
+	    UFREE (tt_table->dist_samples);
+	}
+	tt_table->ec_table = (EC_Table *) NULL;
+	tt_table->model_error = (Model_Error *) NULL;
+	tt_table->dist_samples = (float *) NULL;
+	tt_table->depth_samples = (float *) NULL;
+	tt_table->num_depths = 0;
+	tt_table->num_dists = 0;
+}
+
+
+/*
+ * Fill the header entry for tt_table[k] and count its floats.
+ */
+static void
+entry_sizes (TT_Table *t, int num_ec_phases, int k, TTC_Entry *e,
+		int *nfloats)
+{
+	EC_Table	*ec = t->ec_table;
+	Model_Error	*me = t->model_error;
+	int	n;
+
+	strcpy (e->phase, t->phase);
+	strcpy (e->vmodel, t->vmodel);
+	e->last_leg = t->last_leg;
+	e->num_dists = t->num_dists;
+	e->num_depths = t->num_depths;
+	e->in_hole_dist[0] = t->in_hole_dist[0];
+	e->in_hole_dist[1] = t->in_hole_dist[1];
+	n = t->num_dists + t->num_depths + t->num_dists*t->num_depths;
+
+	if (k < num_ec_phases && ec != NULL && ec->num_dists > 0 &&
+		ec->num_depths > 0)
+	{
+	    e->ec_num_dists = ec->num_dists;
+	    e->ec_num_depths = ec->num_depths;
+	    n += ec->num_dists + ec->num_depths
+		+ 3*ec->num_dists*ec->num_depths;
+	}
+
+	e->me_arrays = -1;
+	if (me != NULL)
+	{
+	    e->me_arrays = 0;
+	    e->me_num_dists = me->num_dists;
+	    e->me_num_depths = me->num_depths;
+	    e->me_bulk_var = me->bulk_var;
+	    if (me->dist_samples != NULL)
+	    {
+		e->me_arrays |= ME_DIST_SAMPLES;
+		n += me->num_dists;
+	    }
+	    if (me->depth_samples != NULL)
+	    {
+		e->me_arrays |= ME_DEPTH_SAMPLES;
+		n += me->num_depths;
+	    }
+	    if (me->dist_var != NULL)
+	    {
+		e->me_arrays |= ME_DIST_VAR;
+		n += me->num_dists;
+	    }
+	    if (me->dist_depth_var != NULL)
+	    {
+		e->me_arrays |= ME_DIST_DEPTH_VAR;
+		n += me->num_dists*me->num_depths;
+	    }
+	}
+	*nfloats = n;
+}
+
+/*
+ * Free the tables read by read_tt_tables() for compile_tt_tables() and
+ * remove_compiled_tt_tables().  Non-default models share the ellipticity
+ * corrections of the default model.
+ */
+static void
+free_read_tables (TT_Table *tt_table, int total_num_phases, int num_phases,
+		  Model_Descrip *model_descrip, int num_models,
+		  Sta_Phase_Model *sta_phase_model)
+{
+	int	i, n;
+	List_of_Phases	*ph, *next;
+
+	for (i = 0; i < total_num_phases; i++)
+	    free_tt_table (&tt_table[i], (i < num_phases) ? TRUE : FALSE);
+	UFREE (tt_table);
+	UFREE (sta_phase_model);
+	for (n = 0; n < num_models; n++)
+	{
+	    ph = model_descrip[n].list_of_phases;
+	    while (ph != (List_of_Phases *) NULL)
+	    {
+		next = ph->next;
+		UFREE (ph);
+		ph = next;
+	    }
+	    UFREE (model_descrip[n].dir_pathway);
+	}
+	UFREE (model_descrip);
+}
+
+
+/*
+ * Is x an array of the compiled file?
+ */
+static Bool
+in_compiled_file (TT_Compiled *ttc, float *x)
+{
+	return ((char *) x >= ttc->file.base &&
+		(char *) x < ttc->file.base + ttc->file.size ?
+		TRUE : FALSE);
+}
+
+
+/*
+ * Free the arrays of an ellipticity correction table.  If they were not
+ * allocated, they point into a compiled file and only the row pointers
+ * are freed.
+ */
+static void
+free_ec_rows (EC_Table *ec, Bool allocated)
+{
+	int	j;
+
+	if (allocated)
+	{
+	    for (j = 0; j < ec->num_depths; j++)
+	    {
+		UFREE (ec->t0[j]);
+		UFREE (ec->t1[j]);
+		UFREE (ec->t2[j]);
+	    }
+	    UFREE (ec->dist_samples);
+	    UFREE (ec->depth_samples);
+	}
+	UFREE (ec->t0);
+	UFREE (ec->t1);
+	UFREE (ec->t2);
+}
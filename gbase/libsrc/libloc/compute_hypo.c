@@ -323,8 +323,12 @@
 
 #define SWAP(a,b) {temp=(a);(a)=(b);(b)=temp;}
 
-static double maxarg1,maxarg2;
-#define DMAX(a,b) (maxarg1=(a),maxarg2=(b),(maxarg1) > (maxarg2) ? (maxarg1) : (maxarg2))
+/* A function rather than a macro with static temporaries, to be reentrant */
+static double
+DMAX (double a, double b)
+{
+	return ((a > b) ? a : b);
+}
 
 
 
@@ -291,9 +291,7 @@ get_ec_from_table (EC_Table *ec_table, double delta, double esaz,
 	double	azim, dist_fac, depth_fac;
 	double	a, b, c, d;
 	double	tau0, tau1, tau2;
-
-	static	double	sc0, sc1, sc2;
-	static	double	save_ev_colat = 99.0;
+	Loc_State *state = loc_state();
 
 
 	azim  = esaz*DEG_TO_RAD;	/* Event to station azimuth (rad.) */
@@ -302,12 +300,12 @@ get_ec_from_table (EC_Table *ec_table, double delta, double esaz,
 	 * Set up reference constants, if event co-latitude has changed.
 	 */
 
-	if (ev_geoc_co_lat != save_ev_colat)
+	if (ev_geoc_co_lat != state->ec_save_ev_colat)
 	{
-	    sc0 = 0.25*(1.0 + 3.0*cos(2.0*ev_geoc_co_lat));
-	    sc1 = SQRT3_OVER2*sin(2.0*ev_geoc_co_lat);
-	    sc2 = SQRT3_OVER2*sin(ev_geoc_co_lat)*sin(ev_geoc_co_lat);
-	    save_ev_colat = ev_geoc_co_lat;
+	    state->ec_sc0 = 0.25*(1.0 + 3.0*cos(2.0*ev_geoc_co_lat));
+	    state->ec_sc1 = SQRT3_OVER2*sin(2.0*ev_geoc_co_lat);
+	    state->ec_sc2 = SQRT3_OVER2*sin(ev_geoc_co_lat)*sin(ev_geoc_co_lat);
+	    state->ec_save_ev_colat = ev_geoc_co_lat;
 	}
 
 	/*
@@ -370,7 +368,8 @@ get_ec_from_table (EC_Table *ec_table, double delta, double esaz,
 	 * of Dziewonski and Gilbert (1976).
 	 */
 
-	ellip_corr = sc0*tau0 + sc1*cos(azim)*tau1 + sc2*cos(2.0*azim)*tau2;
+	ellip_corr = state->ec_sc0*tau0 + state->ec_sc1*cos(azim)*tau1 +
+		     state->ec_sc2*cos(2.0*azim)*tau2;
 
 	return (ellip_corr);
 }
@@ -0,0 +1,144 @@
+
+/*
+ * NAME
+ *	loc_state -- Get the locator working state of the calling thread.
+ *	loc_lock -- Lock the tables that are read on demand.
+ *	loc_unlock -- Unlock the tables that are read on demand.
+
+ * FILE
+ *	loc_state.c
+
+ * SYNOPSIS
+ *	Loc_State *
+ *	loc_state ()
+
+ *	void
+ *	loc_lock ()
+
+ *	void
+ *	loc_unlock ()
+
+ * DESCRIPTION
+ *	-- loc_state() returns the Loc_State structure of the calling
+ *	thread, creating it on the first call from that thread.  It holds
+ *	the values that locate_event() and the travel-time functions used
+ *	to keep in file-scope variables between calls: the current tt_info
+ *	and ar_sasc information, the SRST region number, the radial 2-D
+ *	table period indexes and the co-latitude caches.  Each thread that
+ *	locates events therefore has its own copy, while the travel-time
+ *	tables themselves are shared.  The state of a thread is freed
+ *	when the thread exits.
+
+ *	-- loc_lock() and loc_unlock() serialize the reading of SSSC, SASC
+ *	and acoustic travel-time files that are only read when a station
+ *	is first used during a location.
+
+ * NOTES
+ *	Without pthreads, a single static state is returned and the lock
+ *	functions do nothing.
+
+ * SEE ALSO
+ *	locate_events(), grid_search_location()
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include "libloc.h"
+#include "locp.h"
+#include "loc_defs.h"
+
+static	Loc_State	default_state;
+static	Bool		default_state_init = FALSE;
+
+static void init_loc_state(Loc_State *s);
+
+#ifdef HAVE_PTHREAD
+static	pthread_key_t	state_key;
+static	pthread_once_t	state_once = PTHREAD_ONCE_INIT;
+static	pthread_mutex_t	table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+free_loc_state (void *p)
+{
+	Loc_State *s = (Loc_State *) p;
+
+	UFREE (s->active_ar_sasc);
+	free (s);
+}
+
+static void
+create_state_key (void)
+{
+	pthread_key_create (&state_key, free_loc_state);
+}
+#endif /* HAVE_PTHREAD */
+
+
+Loc_State *
+loc_state (void)
+{
+#ifdef HAVE_PTHREAD
+	Loc_State *s;
+
+	pthread_once (&state_once, create_state_key);
+
+	if ((s = (Loc_State *) pthread_getspecific (state_key)) != NULL)
+	    return (s);
+
+	if ((s = (Loc_State *) malloc (sizeof (Loc_State))) != NULL)
+	{
+	    init_loc_state (s);
+	    if (pthread_setspecific (state_key, s) == 0)
+		return (s);
+	    free (s);
+	}
+	fprintf (stderr, "loc_state: cannot create thread state, using shared state\n");
+#endif /* HAVE_PTHREAD */
+
+	if (! default_state_init)
+	{
+	    init_loc_state (&default_state);
+	    default_state_init = TRUE;
+	}
+	return (&default_state);
+}
+
+
+void
+loc_lock (void)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock (&table_lock);
+#endif
+}
+
+
+void
+loc_unlock (void)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock (&table_lock);
+#endif
+}
+
+
+static void
+init_loc_state (Loc_State *s)
+{
+	memset ((void *) s, 0, sizeof (Loc_State));
+
+	s->tt_info = initialize_ar_info ();
+	s->save_ev_lat = 99.0;
+	s->default_save_ev_lat = 99.0;
+	s->ec_save_ev_colat = 99.0;
+	s->active_ar_sasc = (Ar_SASC *) NULL;
+	s->ar_sasc_cnt = 0;
+	s->srst_region_number = -1;
+	s->hydro_per_index = 0;
+	s->infra_per_index = 0;
+}
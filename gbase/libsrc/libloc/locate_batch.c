@@ -0,0 +1,478 @@
+
+/*
+ * NAME
+ *	locate_events -- Locate a batch of events in parallel.
+ *	grid_search_location -- Find a starting location by grid search.
+ *	initialize_loc_grid -- Set a Loc_Grid structure to default values.
+
+ * FILE
+ *	locate_batch.c
+
+ * SYNOPSIS
+ *	int
+ *	locate_events (sites, num_sites, events, num_events, locator_params,
+ *		       grid, num_threads)
+ *	Site	*sites;			(i) Station structure
+ *	int	num_sites;		(i) Number of stations in sites table
+ *	Loc_Event *events;		(i/o) Events to locate
+ *	int	num_events;		(i) Number of events
+ *	Locator_params *locator_params; (i) Locator parameter info structure
+ *	Loc_Grid *grid;			(i) Starting location grid or NULL
+ *	int	num_threads;		(i) Number of threads (<= 0: one per
+ *					    online processor)
+
+ *	int
+ *	grid_search_location (sites, num_sites, arrival, assoc, num_obs,
+ *			      locator_params, grid, num_threads, lat, lon,
+ *			      otime)
+ *	Site	*sites;			(i) Station structure
+ *	int	num_sites;		(i) Number of stations in sites table
+ *	Arrival	*arrival;		(i) Arrivals of the event
+ *	Assoc	*assoc;			(i) Assocs, in arrival order
+ *	int	num_obs;		(i) Number of arrival/assoc records
+ *	Locator_params *locator_params; (i) Locator parameter info structure
+ *	Loc_Grid *grid;			(i) Grid of trial epicenters
+ *	int	num_threads;		(i) Number of threads (<= 0: one per
+ *					    online processor)
+ *	double	*lat;			(o) Latitude of best node (deg)
+ *	double	*lon;			(o) Longitude of best node (deg)
+ *	double	*otime;			(o) Origin time at best node (epoch)
+
+ *	Loc_Grid
+ *	initialize_loc_grid ()
+
+ * DESCRIPTION
+ *	-- locate_events() calls locate_event() for each of the events,
+ *	sharing the events among the threads.  Each thread takes the next
+ *	event as it finishes the last, so events with many arrivals balance
+ *	out.  Each event is located with its own copy of locator_params,
+ *	so the number of iterations is returned in events[i].num_iter, and
+ *	the return of locate_event() in events[i].ierr.  When more than one
+ *	thread is used, verbose output is turned off, since the events
+ *	would all write to the same output.  If grid is not NULL, events
+ *	without a usable starting epicenter (those that locate_event()
+ *	would give to best_guess()) are started from grid_search_location()
+ *	instead.  The origin of such an event is only changed if its
+ *	location is filled in by locate_event().
+
+ *	-- grid_search_location() computes the travel times of the defining
+ *	arrival times to every node of the grid, at the depth_init of
+ *	locator_params, or at grid->depth if depth_init is not set.  The
+ *	origin time of each node is the weighted mean of the observed minus
+ *	predicted times (or origin_time_init, if the origin time is fixed),
+ *	and the node with a prediction for the most arrivals, and then the
+ *	smallest weighted rms residual, is returned.  The weights are
+ *	1/deltim.  The distances and azimuths from the stations to the
+ *	nodes of a row are computed together by dist_azimuth_batch().  The
+ *	grid rows are shared among the threads; the result does not depend
+ *	on the number of threads.
+
+ *	-- initialize_loc_grid() returns the whole Earth at 5 degree spacing
+ *	and zero depth.
+
+ * DIAGNOSTICS
+ *	-- locate_events() returns the number of events located without
+ *	error (events[i].ierr == 0).
+
+ *	-- grid_search_location() returns ERR if there are fewer than two
+ *	defining arrival times with a travel time at any node of the grid.
+
+ * NOTES
+ *	The travel-time tables must already have been read by function,
+ *	setup_tt_facilities(), and are only read here.  Other working state
+ *	of the locator is kept for each thread (see loc_state()).
+
+ * SEE ALSO
+ *	locate_event(), best_guess(), dist_azimuth_batch()
+ */
+
+
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "libloc.h"
+#include "locp.h"
+#include "libgeog.h"
+#include "loc_defs.h"
+#include "libstring.h"
+
+#define	VALID_TIME(x)	((x) > -9999999999.000)
+
+/* A defining arrival time used by the grid search */
+typedef struct {
+	char	*phase;
+	int	sta_index;
+	int	phase_index;
+	int	spm_index;
+	double	time;		/* Relative to the first arrival */
+	double	wt2;		/* Square of the weight, 1/deltim */
+} Grid_Datum;
+
+/* The best node of each grid row */
+typedef struct {
+	int	n;		/* Number of predicted arrivals */
+	int	j;		/* Longitude index */
+	double	misfit;		/* Weighted mean square residual */
+	double	torg;		/* Relative origin time */
+} Grid_Node;
+
+typedef struct {
+	Site		*sites;
+	Grid_Datum	*data;
+	int		num_data;
+	Geog_Points	*sta;		/* Station of each datum */
+	Loc_Grid	*grid;
+	int		nlon;
+	double		*lon;		/* Longitudes of the grid columns */
+	double		depth;
+	Bool		fix_origin_time;
+	double		torg;
+	Grid_Node	*rows;
+} Grid_Work;
+
+typedef struct {
+	Site		*sites;
+	int		num_sites;
+	Loc_Event	*events;
+	Locator_params	*locator_params;
+	Loc_Grid	*grid;
+	Bool		quiet;
+} Batch_Work;
+
+static void search_row(int i, void *arg);
+static void locate_one(int i, void *arg);
+
+
+int
+locate_events (Site *sites, int num_sites, Loc_Event *events, int num_events,
+	       Locator_params *locator_params, Loc_Grid *grid, int num_threads)
+{
+	int	i, nthreads, num_located;
+	Batch_Work w;
+
+	if (num_events <= 0 || ! events || ! locator_params)
+	    return (0);
+
+	nthreads = parallel_threads (num_events, num_threads);
+
+	w.sites = sites;
+	w.num_sites = num_sites;
+	w.events = events;
+	w.locator_params = locator_params;
+	w.grid = grid;
+	w.quiet = (nthreads > 1);
+
+	parallel_run (num_events, nthreads, locate_one, &w);
+
+	for (i = 0, num_located = 0; i < num_events; i++)
+	    if (events[i].ierr == 0)
+		num_located++;
+
+	return (num_located);
+}
+
+
+static void
+locate_one (int i, void *arg)
+{
+	Batch_Work	*w = (Batch_Work *) arg;
+	Loc_Event	*ev = &w->events[i];
+	Locator_params	lp;
+	Origin		origin;
+	Bool		grid_start = FALSE;
+	double		lat, lon, otime;
+
+	lp = *w->locator_params;
+	if (w->quiet)
+	    lp.verbose = '0';
+
+	/*
+	 * Start from the grid if locate_event() would otherwise have to
+	 * call best_guess().
+	 */
+
+	if (w->grid && ev->origin && ! lp.fix_lat_lon &&
+	    (! lp.use_location || fabs(ev->origin->lat) > 90.0 ||
+	     fabs(ev->origin->lon) > 180.0))
+	{
+	    if (grid_search_location (w->sites, w->num_sites, ev->arrival,
+				ev->assoc, ev->num_obs, &lp, w->grid, 1,
+				&lat, &lon, &otime) == OK)
+	    {
+		MCOPY (&origin, ev->origin, sizeof (Origin));
+		origin.lat = lat;
+		origin.lon = lon;
+		origin.time = otime;
+		lp.use_location = TRUE;
+		grid_start = TRUE;
+	    }
+	}
+
+	ev->ierr = locate_event (w->sites, w->num_sites, ev->arrival,
+				 ev->assoc, grid_start ? &origin : ev->origin,
+				 ev->origerr, &lp, ev->ar_info, ev->num_obs);
+	ev->num_iter = lp.num_iter;
+
+	if (grid_start && (ev->ierr == 0 || lp.refill_if_loc_fails))
+	    MCOPY (ev->origin, &origin, sizeof (Origin));
+}
+
+
+int
+grid_search_location (Site *sites, int num_sites, Arrival *arrival,
+		      Assoc *assoc, int num_obs, Locator_params *locator_params,
+		      Loc_Grid *grid, int num_threads, double *lat,
+		      double *lon, double *otime)
+{
+	int	i, j, k, n, nlat, nlon, best;
+	double	time_offset;
+	double	*slat, *slon, *glon;
+	Grid_Datum *data;
+	Grid_Node *rows;
+	Geog_Points *sta;
+	Grid_Work w;
+
+	if (num_obs <= 0 || ! arrival || ! assoc || ! grid ||
+	    grid->spacing <= 0.0 || grid->lat_max < grid->lat_min ||
+	    grid->lon_max < grid->lon_min)
+	    return (ERR);
+
+	/*
+	 * Collect the defining arrival times with a valid station and
+	 * travel-time table.  Path-dependent phases are not used.
+	 */
+
+	if ((data = UALLOC (Grid_Datum, num_obs)) == (Grid_Datum *) NULL)
+	    return (ERR);
+
+	time_offset = 0.0;
+	for (i = 0, k = 0; i < num_obs; i++)
+	{
+	    if (! STREQ (assoc[i].timedef, "d") || ! VALID_TIME(arrival[i].time))
+		continue;
+
+	    for (j = 0; j < num_sites; j++)
+		if (STREQ (arrival[i].sta, sites[j].sta))
+		    break;
+	    if (j == num_sites)
+		continue;
+
+	    data[k].phase = assoc[i].phase;
+	    data[k].sta_index = j;
+	    data[k].phase_index =
+		get_tt_indexes (assoc[i].phase, j, &data[k].spm_index);
+	    if (data[k].phase_index < 0 ||
+		data[k].phase_index >= I_PHASE_INDEX)
+		continue;
+
+	    data[k].time = arrival[i].time;
+	    data[k].wt2 = (arrival[i].deltim > 0.0) ?
+			1.0/(arrival[i].deltim*arrival[i].deltim) : 1.0;
+
+	    if (k == 0 || arrival[i].time < time_offset)
+		time_offset = arrival[i].time;
+	    k++;
+	}
+	if (k < 2)
+	{
+	    UFREE (data);
+	    return (ERR);
+	}
+	for (i = 0; i < k; i++)
+	    data[i].time -= time_offset;
+
+	nlat = (int) floor ((grid->lat_max - grid->lat_min)/grid->spacing
+				+ 1.0e-6) + 1;
+	nlon = (int) floor ((grid->lon_max - grid->lon_min)/grid->spacing
+				+ 1.0e-6) + 1;
+	if (nlon > 1 && (nlon-1)*grid->spacing >= 360.0 - 1.0e-6)
+	    nlon--;		/* Do not search the same meridian twice */
+
+	/*
+	 * The stations are converted for dist_azimuth_batch() once, and
+	 * each row is then one station by node matrix.
+	 */
+
+	slat = UALLOC (double, 2*k);
+	glon = UALLOC (double, nlon);
+	rows = UALLOC (Grid_Node, nlat);
+	if (! slat || ! glon || ! rows)
+	{
+	    UFREE (slat);
+	    UFREE (glon);
+	    UFREE (rows);
+	    UFREE (data);
+	    return (ERR);
+	}
+	slon = slat + k;
+	for (i = 0; i < k; i++)
+	{
+	    slat[i] = sites[data[i].sta_index].lat;
+	    slon[i] = sites[data[i].sta_index].lon;
+	}
+	sta = geog_points (slat, slon, k);
+	UFREE (slat);
+	if (! sta)
+	{
+	    UFREE (glon);
+	    UFREE (rows);
+	    UFREE (data);
+	    return (ERR);
+	}
+	for (j = 0; j < nlon; j++)
+	    glon[j] = grid->lon_min + j*grid->spacing;
+
+	w.sites = sites;
+	w.data = data;
+	w.num_data = k;
+	w.sta = sta;
+	w.grid = grid;
+	w.nlon = nlon;
+	w.lon = glon;
+	w.depth = (locator_params->depth_init >= 0.0) ?
+			locator_params->depth_init : grid->depth;
+	if (w.depth < 0.0)
+	    w.depth = 0.0;
+	w.fix_origin_time = locator_params->fix_origin_time;
+	w.torg = locator_params->origin_time_init - time_offset;
+	w.rows = rows;
+
+	parallel_run (nlat, num_threads, search_row, &w);
+
+	/*
+	 * Combine the rows in order, so that ties go to the first node.
+	 */
+
+	for (i = 0, best = -1; i < nlat; i++)
+	{
+	    if (rows[i].n < 2)
+		continue;
+	    if (best < 0 || rows[i].n > rows[best].n ||
+		(rows[i].n == rows[best].n &&
+		 rows[i].misfit < rows[best].misfit))
+		best = i;
+	}
+
+	if (best >= 0)
+	{
+	    n = rows[best].j;
+	    *lat = grid->lat_min + best*grid->spacing;
+	    *lon = grid->lon_min + n*grid->spacing;
+	    if (*lon > 180.0)
+		*lon -= 360.0;
+	    *otime = rows[best].torg + time_offset;
+	}
+
+	free_geog_points (sta);
+	UFREE (glon);
+	UFREE (rows);
+	UFREE (data);
+
+	return ((best >= 0) ? OK : ERR);
+}
+
+
+Loc_Grid
+initialize_loc_grid (void)
+{
+	Loc_Grid	Default_Loc_Grid;
+
+	Default_Loc_Grid.lat_min	= -90.0;
+	Default_Loc_Grid.lat_max	= 90.0;
+	Default_Loc_Grid.lon_min	= -180.0;
+	Default_Loc_Grid.lon_max	= 180.0;
+	Default_Loc_Grid.spacing	= 5.0;
+	Default_Loc_Grid.depth		= 0.0;
+
+	return (Default_Loc_Grid);
+}
+
+
+/*
+ * Find the best node of grid row i.
+ */
+static void
+search_row (int i, void *arg)
+{
+	Grid_Work	*w = (Grid_Work *) arg;
+	Grid_Datum	*d;
+	Grid_Node	*row = &w->rows[i];
+	Geog_Points	*nodes = NULL;
+	int	j, k, m, n, interp_err;
+	double	lat, tt, r, misfit, torg;
+	double	sw, swr, swrr;
+	double	prin_deriv[4];
+	double	*glat = NULL, *delta = NULL, *esaz = NULL;
+
+	row->n = 0;
+	row->j = 0;
+	row->misfit = 0.0;
+	row->torg = 0.0;
+
+	lat = w->grid->lat_min + i*w->grid->spacing;
+	if (lat > 90.0)
+	    lat = 90.0;
+
+	/*
+	 * The distances and event-to-station azimuths from every node of
+	 * the row to every station, element k*nlon + j.  The rows are
+	 * already shared among the threads, so one thread is used here.
+	 */
+
+	m = w->num_data*w->nlon;
+	if ((glat = UALLOC (double, w->nlon)) == (double *) NULL ||
+	    (delta = UALLOC (double, 2*m)) == (double *) NULL)
+	    goto done;
+	esaz = delta + m;
+
+	for (j = 0; j < w->nlon; j++)
+	    glat[j] = lat;
+	if ((nodes = geog_points (glat, w->lon, w->nlon)) == NULL ||
+	    dist_azimuth_batch (w->sta, nodes, delta, NULL, esaz, 1) != OK)
+	    goto done;
+
+	for (j = 0; j < w->nlon; j++)
+	{
+	    sw = swr = swrr = 0.0;
+	    for (k = 0, n = 0; k < w->num_data; k++)
+	    {
+		d = &w->data[k];
+		tt = trv_time_w_ellip_elev (FALSE, FALSE, lat,
+				delta[k*w->nlon + j], w->depth,
+				esaz[k*w->nlon + j], d->phase,
+				w->sites[d->sta_index].elev,
+				d->phase_index, d->spm_index, prin_deriv,
+				&interp_err);
+		if (tt < 0.0)
+		    continue;
+
+		r = d->time - tt;
+		sw   += d->wt2;
+		swr  += d->wt2*r;
+		swrr += d->wt2*r*r;
+		n++;
+	    }
+	    if (n < 2 || n < row->n)
+		continue;
+
+	    torg = (w->fix_origin_time) ? w->torg : swr/sw;
+	    misfit = (swrr - 2.0*torg*swr + torg*torg*sw)/sw;
+	    if (misfit < 0.0)
+		misfit = 0.0;
+
+	    if (n > row->n || misfit < row->misfit)
+	    {
+		row->n = n;
+		row->j = j;
+		row->misfit = misfit;
+		row->torg = torg;
+	    }
+	}
+
+done:
+	free_geog_points (nodes);
+	UFREE (glat);
+	UFREE (delta);
+}
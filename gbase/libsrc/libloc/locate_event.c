@@ -43,6 +43,10 @@
  *	azimuth and slowness within the arrival attributes, azimuth and
  *	slowness, locally.  We will also added the modeling errors to the
  *	delaz and delslo fields.
+ *	Apart from the tables read by setup_tt_facilities(), all working
+ *	state is local to the call or to the calling thread (loc_state()),
+ *	so events may be located from several threads at once.  See
+ *	locate_events().
 
  * SEE ALSO
  *	user_locate() function calls this routine in ARS.  main() calls 
@@ -100,10 +104,6 @@
 
 #define	VALID_TIME(x)	((x) > -9999999999.000)
 
-static	Bool	first_call = TRUE;
-
-Locator_info	*locator_info;
-
 
 int
 locate_event (Site *sites, int num_sites, Arrival *arrival, Assoc *assoc, 
@@ -126,6 +126,7 @@ locate_event (Site *sites, int num_sites, Arrival *arrival, Assoc *assoc,
 	char str[100];
 	FILE	*ofp = (FILE *) NULL;
 	Origin Na_Origin_rec = Na_Origin_Init;
+	Locator_info	info, *locator_info = &info;
 
 
 	/* Check input */
@@ -337,16 +338,10 @@ locate_event (Site *sites, int num_sites, Arrival *arrival, Assoc *assoc,
 
 
 	/*
-	 * If not already done, allocate memory for typedef structure, 
-	 * locator_info.  Always initialize its local variables.
+	 * Initialize the locator_info structure for this event.  It is
+	 * local to this call, so that events can be located concurrently.
 	 */
 
-	if (first_call)
-	{
-	    locator_info = UALLOC (Locator_info, 1);
-	    first_call = FALSE;
-	}
-
 	locator_info->sta_index   = UALLOCA (int, num_obs);
 	locator_info->phase_index = UALLOCA (int, num_obs);
 	locator_info->spm_index   = UALLOCA (int, num_obs);
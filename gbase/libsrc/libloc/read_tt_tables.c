@@ -63,6 +63,9 @@
 
  * FILES
  *	Read travel-time, modelling error and ellipticity correction tables.
+ *	If a velocity model directory holds a compiled table file written by
+ *	compile_tt_tables(), the tables of the phases it contains are mapped
+ *	from it instead.
 
  * NOTES
  *	If input file will not open, then the structure, tt_table, will be 
@@ -148,6 +151,7 @@ read_tt_tables (Bool only_read_default_tt_tables, char *vmodel_filename,
 	Bool	use_2D_tables;
 
 	TT_Table	*tt_table = (TT_Table *) NULL;
+	TT_Compiled	*ttc;
 	EC_Table	*ec_table_ptr = (EC_Table *) NULL;
 	Model_Descrip	*model_descrip = (Model_Descrip *) NULL;
 	Sta_Phase_Model	*sta_phase_model = (Sta_Phase_Model *) NULL;
@@ -687,6 +691,13 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 
 	for (n = 0; n < num_models; n++)
 	{
+	    /*
+	     * Use the compiled tables of the model, if there are any.
+	     */
+
+	    ttc = open_compiled_tt_tables (model_descrip[n].dir_pathway,
+					   model_descrip[n].vmodel);
+
 	    ph = model_descrip[n].list_of_phases;
 	    while (ph != (List_of_Phases *) NULL)
 	    {
@@ -710,6 +721,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		tt_table[k].trv_time = (float **) NULL;
 		tt_table[k].ec_table = (EC_Table *) NULL;
 		tt_table[k].model_error = (Model_Error *) NULL;
+		tt_table[k].compiled = (TT_Compiled *) NULL;
 
 		/*
 		 * Is the last leg of given phase of type P or S ?
@@ -718,6 +730,23 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		if ((tt_table[k].last_leg = last_leg (ph->phase)) < OK)
 		    fprintf (stdout, "Warning: Last leg of phase: %s has no definition in function, last_leg()!\n", ph->phase);
 
+		if (ttc != NULL)
+		{
+		    status = read_compiled_tt_table (ttc, file_name, ph->phase,
+				(n == 0 && separate_ec_tables_exist), &tt_table[k]);
+		    if (status == OK)
+		    {
+			++open_cnt;
+			++num_files;
+			goto table_read;
+		    }
+		    else if (status != ERR)
+		    {
+			release_compiled_tt_tables (ttc);
+			return (status);
+		    }
+		}
+
 		/* Open travel-time file */
  
 		if ((tfp = fopen (file_name, "r")) == NULL)
@@ -734,6 +763,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    READ_ERR("1st line of travel-time table");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror3);
 		}
 		if (STREQ (vm1, "#"))
@@ -747,6 +777,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    READ_ERR("number of depth samples");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror3);
 		}
 		tt_table[k].num_depths = ntbz;
@@ -756,6 +787,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    CALLOC_ERR ("tt_table[].depth_samples");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror4);
 		}
 
@@ -765,6 +797,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		    {
 			READ_ERR("depth sample value");
 			fclose (tfp);
+			release_compiled_tt_tables (ttc);
 			return (TTerror3);
 		    }
 		}
@@ -775,6 +808,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    READ_ERR("number of distance samples");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror3);
 		}
 		tt_table[k].num_dists = ntbd;
@@ -784,6 +818,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    CALLOC_ERR ("tt_table[].dist_samples");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror4);
 		}
 
@@ -793,6 +828,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		    {
 			READ_ERR("distance sample value");
 			fclose (tfp);
+			release_compiled_tt_tables (ttc);
 			return (TTerror3);
 		    }
 		}
@@ -804,6 +840,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    CALLOC_ERR ("tt_table[].trv_time");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror4);
 		}
 		for (i = 0; i < ntbz; i++)
@@ -813,6 +850,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		    {
 			CALLOC_ERR ("tt_table[].trv_time[]");
 			fclose (tfp);
+			release_compiled_tt_tables (ttc);
 			return (TTerror4);
 		    }
 		}
@@ -828,6 +866,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    READ_ERR("travel-time value");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror3);
 			}
 		    }
@@ -890,6 +929,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		{
 		    CALLOC_ERR ("tt_table[].model_error");
 		    fclose (tfp);
+		    release_compiled_tt_tables (ttc);
 		    return (TTerror4);
 		}
 
@@ -915,6 +955,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    READ_ERR("premature EOF");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror3);
 			}
 			if (fscanf (tfp, "%f%*[^\n]", 
@@ -922,6 +963,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    READ_ERR("single bulk modelling error");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror3);
 			}
 		    }
@@ -938,6 +980,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    CALLOC_ERR ("tt_table[].model_error->dist_samples");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror4);
 			}
 			if ((tt_table[k].model_error->dist_var = 
@@ -945,6 +988,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    CALLOC_ERR ("tt_table[].model_error->dist_var");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror4);
 			}
 
@@ -958,6 +1002,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			    {
 				READ_ERR("modelling error distance sample value");
 				fclose (tfp);
+				release_compiled_tt_tables (ttc);
 				return (TTerror3);
 			    }
 			}
@@ -965,6 +1010,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    READ_ERR("premature EOF");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror3);
 			}
 			for (i = 0; i < ntbd; i++)
@@ -973,6 +1019,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			    {
 				READ_ERR("distance-dependent modelling error");
 				fclose (tfp);
+				release_compiled_tt_tables (ttc);
 				return (TTerror3);
 			    }
 			}
@@ -993,6 +1040,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		    {
 			CALLOC_ERR ("tt_table[].model_error->dist_samples");
 			fclose (tfp);
+			release_compiled_tt_tables (ttc);
 			return (TTerror4);
 		    }
 		    if ((tt_table[k].model_error->depth_samples = 
@@ -1000,6 +1048,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		    {
 			CALLOC_ERR ("tt_table[].model_error->depth_samples");
 			fclose (tfp);
+			release_compiled_tt_tables (ttc);
 			return (TTerror4);
 		    }
 		    if ((tt_table[k].model_error->dist_depth_var = 
@@ -1007,6 +1056,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 		    {
 			CALLOC_ERR ("tt_table[].model_error->dist_depth_var");
 			fclose (tfp);
+			release_compiled_tt_tables (ttc);
 			return (TTerror4);
 		    }
 		    for (i = 0; i < ntbz; i++)
@@ -1016,6 +1066,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    CALLOC_ERR ("tt_table[].model_error->dist_depth_var[]");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror4);
 			}
 		    }
@@ -1030,6 +1081,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    READ_ERR("modelling error distance sample value");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror3);
 			}
 		    }
@@ -1039,6 +1091,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			{
 			    READ_ERR("modelling error depth sample value");
 			    fclose (tfp);
+			    release_compiled_tt_tables (ttc);
 			    return (TTerror3);
 			}
 		    }
@@ -1059,6 +1112,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 			    {
 				READ_ERR("distance/depth modelling error");
 				fclose (tfp);
+				release_compiled_tt_tables (ttc);
 				return (TTerror3);
 			    }
 			}
@@ -1068,6 +1122,7 @@ while (fgets (input_string, BUFSIZ, vm_fp) != NULL)
 eof_found:
 		++num_files;
 		fclose (tfp);
+table_read:
 
 		/*
 		 * If separate distance/depth-dependent ellipticity 
@@ -1078,7 +1133,7 @@ eof_found:
 
 		if (separate_ec_tables_exist)
 		{
-		    if (n == 0)
+		    if (n == 0 && tt_table[k].ec_table == NULL)
 		    {
 			strcpy (file_name, el_prefix);
 			strcat (file_name, tt_table[k].phase);
@@ -1094,9 +1149,12 @@ eof_found:
 			if (status == OK)
 			    tt_table[k].ec_table = ec_table_ptr;
 			else if (status < OK)
-	    		    return (ECerror1);
+			{
+			    release_compiled_tt_tables (ttc);
+			    return (ECerror1);
+			}
 		    }
-		    else
+		    else if (n > 0)
 		    {
 			/*
 			 * Link with appropriate EC_Table pointer from default
@@ -1117,6 +1175,7 @@ eof_found:
 
 		ph = ph->next;
 	    }
+	    release_compiled_tt_tables (ttc);
 	}
 
 	*tt_table_ptr = &tt_table[0];
@@ -60,7 +60,8 @@
  *	number to NULL value (-1).
 
  *	-- get_srst_region_number() gets the current SRST region number.
- *	This is currently only needed by ARS for display purposes.
+ *	This is currently only needed by ARS for display purposes.  The
+ *	region number is kept for each thread (see loc_state()).
 
  * DIAGNOSTICS
  *	-- read_srst() will return with an error code of ERR (-1) if input
@@ -108,7 +109,6 @@
 #include "srst.h"
 
 static	Srst	*srst = (Srst *) NULL;
-static	int	current_srst_region_number = -1;
 
 
 int
@@ -329,7 +329,7 @@ apply_srst (char *sta, double ev_geoc_lat, double ev_lon,
 	 * display purposes, but could be used in other ways.
 	 */
 
-	current_srst_region_number = srst[ireg].reg_num;
+	loc_state()->srst_region_number = srst[ireg].reg_num;
 
 	return (TRUE);
 }
@@ -338,7 +338,7 @@ apply_srst (char *sta, double ev_geoc_lat, double ev_lon,
 void
 set_srst_region_number (void)
 {
-	current_srst_region_number = -1;
+	loc_state()->srst_region_number = -1;
 	return;
 }
 
@@ -346,5 +346,5 @@ set_srst_region_number (void)
 int
 get_srst_region_number (void)
 {
-	return (current_srst_region_number);
+	return (loc_state()->srst_region_number);
 }
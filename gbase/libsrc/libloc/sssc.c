@@ -789,15 +789,23 @@ apply_sssc (double ev_lat, double ev_lon, Sta_Phase_Model spm,
      * If spm.sssc->sssc_path != NULL, read SSSC file(s) for the phase of the
      * station.
     */
+      loc_lock ();
       if (spm.sssc->sssc_path != (char *) NULL)
       {
 	if (!strcmp(spm.sssc->sssc_path, "ERR_OPEN_FILE!"))
+	{
 		/* couldn't open file by read_single_sssc_file!*/
+         loc_unlock ();
          return (FALSE);
+	}
 	 
 	if(read_single_sssc_file(spm, sssc_level, verbose))
+	{
+         loc_unlock ();
          return (FALSE);
+	}
       }
+      loc_unlock ();
    /*
     * Determine whether event is located within one of the regional
     * source regions -- If not, return w/o a correction. dlat and
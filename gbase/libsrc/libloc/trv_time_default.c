@@ -208,34 +208,7 @@ setup_default_tt_tables_only (char *vmodel_filename, char **phase_types,
 
 	    UFREE (prev_vmodel_filename);
 	    for (i = 0; i < num_phases; i++)
-	    {
-		for (j = 0; j < tt_table[i].num_depths; j++)
-		    UFREE (tt_table[i].trv_time[j]);
-		UFREE (tt_table[i].trv_time);
-		if (tt_table[i].ec_table != NULL)
-		{
-		    for (j = 0; j < tt_table[i].ec_table->num_depths; j++)
-		    {
-			UFREE (tt_table[i].ec_table->t0[j]);
-			UFREE (tt_table[i].ec_table->t1[j]);
-			UFREE (tt_table[i].ec_table->t2[j]);
-		    }
-		    UFREE (tt_table[i].ec_table->t0);
-		    UFREE (tt_table[i].ec_table->t1);
-		    UFREE (tt_table[i].ec_table->t2);
-		    UFREE (tt_table[i].ec_table);
-		}
-		if (tt_table[i].model_error != NULL)
-		{
-		    if (tt_table[i].model_error->dist_depth_var != NULL)
-		    {
-			for (j = 0; j < tt_table[i].model_error->num_depths;j++)
-			    UFREE (tt_table[i].model_error->dist_depth_var[j]);
-			UFREE (tt_table[i].model_error->dist_depth_var);
-		    }
-		    UFREE (tt_table[i].model_error);
-		}
-	    }
+		free_tt_table (&tt_table[i], TRUE);
 	    UFREE (tt_table);
 
 	    for (i = 0; i < num_models; i++)
@@ -299,9 +272,8 @@ fast_travel_time (Bool extrapolate, char *phase, double ev_lat, double ev_lon,
 	double	surf_vel;
 	double	trv_time;
 	double	*LP_trv_time = (double *) NULL ;
+	Loc_State *state = loc_state();
 
-	static	double	save_ev_lat = 99.0;
-	static	double	ev_geoc_co_lat = 0.0;
 	static	double	period[] = { 20.0 };
 
 
@@ -342,10 +314,11 @@ fast_travel_time (Bool extrapolate, char *phase, double ev_lat, double ev_lon,
 	 * geocetric co-latitude (radians).
 	 */
 
-	if (ev_lat != save_ev_lat)
+	if (ev_lat != state->default_save_ev_lat)
 	{
-	    ev_geoc_co_lat = lat_conv (ev_lat, TRUE, TRUE, FALSE, TRUE, FALSE);
-	    save_ev_lat = ev_lat;
+	    state->default_ev_geoc_co_lat =
+		lat_conv (ev_lat, TRUE, TRUE, FALSE, TRUE, FALSE);
+	    state->default_save_ev_lat = ev_lat;
 	}
 
 	/*
@@ -402,10 +375,11 @@ fast_travel_time (Bool extrapolate, char *phase, double ev_lat, double ev_lon,
 	if (tt_table[phase_index].ec_table != (EC_Table *) NULL)
 	    ellip_corr = 
 	    get_ec_from_table (tt_table[phase_index].ec_table, distance, esaz, 
-			       ev_geoc_co_lat, ev_depth);
+			       state->default_ev_geoc_co_lat, ev_depth);
 	else
 	    ellip_corr = 
-	    ellipticity_corr (distance, esaz, ev_geoc_co_lat, ev_depth, phase);
+	    ellipticity_corr (distance, esaz, state->default_ev_geoc_co_lat,
+			      ev_depth, phase);
 
 	/* 
 	 * Calculate elevation correction 
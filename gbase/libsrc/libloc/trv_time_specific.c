@@ -364,7 +364,6 @@ static	TT_Table	*tt_table = (TT_Table *) NULL;
 static	Model_Descrip	*model_descrip = (Model_Descrip *) NULL;
 static	Sta_Phase_Model	*sta_phase_model = (Sta_Phase_Model *) NULL;
 static	Sta_Pt		*sta_pt = (Sta_Pt *) NULL;
-static	Ar_Info		tt_info;
 
 
 int
@@ -439,46 +438,8 @@ setup_tttables (char *vmodel_filename, char **phase_types, int num_phase_types)
 	    /* for (i = 0; i < num_phases; i++) */
 	    for (i = 0; i < total_num_phases; i++)
 	    {
-		for (j = 0; j < tt_table[i].num_depths; j++)
-		    UFREE (tt_table[i].trv_time[j]);
-		UFREE (tt_table[i].trv_time);
-		if (i < num_phases)
-		{
-		    if (tt_table[i].ec_table != NULL)
-		    {
-			for (j = 0; j < tt_table[i].ec_table->num_depths; j++)
-			{
-			    UFREE (tt_table[i].ec_table->t0[j]);
-			    UFREE (tt_table[i].ec_table->t1[j]);
-			    UFREE (tt_table[i].ec_table->t2[j]);
-			}
-			UFREE (tt_table[i].ec_table->t0);
-			UFREE (tt_table[i].ec_table->t1);
-			UFREE (tt_table[i].ec_table->t2);
-			UFREE (tt_table[i].ec_table->dist_samples);
-			UFREE (tt_table[i].ec_table->depth_samples);
-			UFREE (tt_table[i].ec_table);
-		    }
-		}
-		else
-		    tt_table[i].ec_table = (EC_Table *) NULL;
-
-		if (tt_table[i].model_error != NULL)
-		{
-		    UFREE(tt_table[i].model_error->depth_samples);
-		    UFREE(tt_table[i].model_error->dist_var);
-		    UFREE(tt_table[i].model_error->dist_samples);
-
-		    if (tt_table[i].model_error->dist_depth_var != NULL)
-		    {
-			for (j = 0; j < tt_table[i].model_error->num_depths;j++)
-			    UFREE (tt_table[i].model_error->dist_depth_var[j]);
-			UFREE (tt_table[i].model_error->dist_depth_var);
-		    }
-		    UFREE (tt_table[i].model_error);
-		}
-		UFREE (tt_table[i].depth_samples);
-		UFREE (tt_table[i].dist_samples);
+		/* Other models share the default ellipticity corrections */
+		free_tt_table (&tt_table[i], (i < num_phases) ? TRUE : FALSE);
 	    }
 	    UFREE (tt_table);
 
@@ -625,6 +586,7 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 	double	*LQ_trv_time = (double *) NULL ;	
         double  *LR_trv_time = (double *) NULL ;
 	int     blocked;        /*Hydro phases only. JG*/
+	Ar_Info	*tt_info = &loc_state()->tt_info;
 
 
 	static	double	dsdv[] = {	/* In degress */
@@ -657,11 +619,11 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 	me_factor	 = 1.0;		/* SSSC modelling error factor */
 	me_sssc		 = -1.0;	/* SSSC modelling error at source */
 
-	tt_info = *ar_info;
+	*tt_info = *ar_info;
 
-	tt_info.meas_error = data_std_err;
-	tt_info.model_plus_meas_error = data_std_err;
-	tt_info.src_dpnt_corr_type = NO_SRC_DPNT_CORR;
+	tt_info->meas_error = data_std_err;
+	tt_info->model_plus_meas_error = data_std_err;
+	tt_info->src_dpnt_corr_type = NO_SRC_DPNT_CORR;
 
 	/*
 	 * Grab travel time along with derivative information.  Handle path-
@@ -683,7 +645,7 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 		    trv_time = LQ_trv_time[0];
                     free(LQ_trv_time);		    
 	        }
-		strcpy (tt_info.vmodel, "path_dpnt_LQ");
+		strcpy (tt_info->vmodel, "path_dpnt_LQ");
 		LQ_trv_time = (double *) NULL ;		
 	    }
 	    else
@@ -697,7 +659,7 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 		    trv_time = LR_trv_time[0];
                     free(LR_trv_time);
 	        }
-		strcpy (tt_info.vmodel, "path_dpnt_LR");
+		strcpy (tt_info->vmodel, "path_dpnt_LR");
 		LR_trv_time = (double *) NULL ;		
 	    }
 
@@ -728,7 +690,7 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 	    tt_deriv[1] = -(prin_deriv[0]/depth_corr)*sin_esr;
 	    tt_deriv[2] = -(prin_deriv[0]/depth_corr)*cos_esr;
 
-	    tt_info.model_error	= 10.0;		/* For now, always 10 sec. */
+	    tt_info->model_error	= 10.0;		/* For now, always 10 sec. */
 	}
 
 
@@ -739,17 +701,17 @@ total_travel_time (Locator_params *locator_params, Site *sites,
         {
 
             get_acoustic_tt(sites[sta_index].sta, ev_lat, ev_lon, &trv_time,
-			&tt_info.model_error,&blocked);
+			&tt_info->model_error,&blocked);
 	    if(phase_index==T_PHASE_INDEX)
-		tt_info.model_error += (get_H_T_convert());
-	    tt_info.tt_table_value = trv_time; /* No need for ellip/elev corrections*/
-	    tt_info.total_travel_time = trv_time;
+		tt_info->model_error += (get_H_T_convert());
+	    tt_info->tt_table_value = trv_time; /* No need for ellip/elev corrections*/
+	    tt_info->total_travel_time = trv_time;
 	    if (blocked>3)
 	    	*interp_code = 20;
 	    else
                 *interp_code = 0;
 
-            strcpy (tt_info.vmodel, (char *)(get_current_radial_2D_period_name(sites[sta_index].sta)));
+            strcpy (tt_info->vmodel, (char *)(get_current_radial_2D_period_name(sites[sta_index].sta)));
  
             /* Get sub-set of derivatives pertainent to Hydro data */
  
@@ -778,12 +740,12 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 
             if (locator_params->dist_var_wgt)
             {
-                if (tt_info.meas_error < 0.0)
-                    tt_info.model_plus_meas_error = -1.0;
+                if (tt_info->meas_error < 0.0)
+                    tt_info->model_plus_meas_error = -1.0;
                 else
-                    tt_info.model_plus_meas_error =
-                        sqrt (tt_info.model_error*tt_info.model_error +
-                              tt_info.meas_error*tt_info.meas_error);
+                    tt_info->model_plus_meas_error =
+                        sqrt (tt_info->model_error*tt_info->model_error +
+                              tt_info->meas_error*tt_info->meas_error);
             }
         }
 /* JG addition ends here. */
@@ -819,7 +781,7 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 		    return (-1.0);	
 		}
 		if (tscor_found)
-		    tt_info.src_dpnt_corr_type = TEST_SITE_CORR;
+		    tt_info->src_dpnt_corr_type = TEST_SITE_CORR;
 	    }
 
 	    /*
@@ -833,13 +795,13 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 		    if (apply_sssc (ev_lat, ev_lon, sta_phase_model[spm_index], 
 				    src_dpnt_corr, &me_factor, &me_sssc,
 				    locator_params->sssc_level, locator_params->verbose))
-			tt_info.src_dpnt_corr_type = SSSC_LEVEL_1_CORR;
+			tt_info->src_dpnt_corr_type = SSSC_LEVEL_1_CORR;
 		}
 	    }
 
 	    /*
 	     * Finally, look for an SRST correction.  Here, 
-	     * tt_info.model_error is the SRST data variance.  It's 
+	     * tt_info->model_error is the SRST data variance.  It's 
 	     * inverse is the applied weight
 	     */
 
@@ -853,15 +815,15 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 		    ev_geoc_lat = 90.0-ev_geoc_co_lat*RAD_TO_DEG;
 		    if (apply_srst (sites[sta_index].sta, ev_geoc_lat, 
 				    ev_lon, ev_geoc_co_lat, ev_depth, 
-				    &src_dpnt_corr[0], &tt_info.model_error))
+				    &src_dpnt_corr[0], &tt_info->model_error))
 		    {
-			tt_info.src_dpnt_corr_type = SRST_CORR;
+			tt_info->src_dpnt_corr_type = SRST_CORR;
 			if (locator_params->srst_var_wgt)
 			{
 			    for (i = 1; i < (signed int)NUM_ELEMENTS(dsdv); i++)
 				if (distance <= dsdv[i])
 				    break;
-			    tt_info.model_error = 
+			    tt_info->model_error = 
 				sdv[i] + ((distance-dsdv[i]) /
 					 (dsdv[i-1]-dsdv[i]))*(sdv[i-1]-sdv[i]);
 			}
@@ -876,11 +838,11 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 
 	    if (locator_params->user_var_wgt > 0.0)
 	    {
-		tt_info.model_error = (double) locator_params->user_var_wgt;
-		tt_info.model_plus_meas_error = tt_info.model_error;
+		tt_info->model_error = (double) locator_params->user_var_wgt;
+		tt_info->model_plus_meas_error = tt_info->model_error;
 	    }
 
-	    if (tt_info.src_dpnt_corr_type > NO_SRC_DPNT_CORR)
+	    if (tt_info->src_dpnt_corr_type > NO_SRC_DPNT_CORR)
 	    {
 		depth_corr = DEG_TO_RAD*(RADIUS_EARTH-ev_depth);
 		src_dpnt_corr[1] /= depth_corr;
@@ -888,8 +850,8 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 		trv_time += src_dpnt_corr[0];
 	    }
 
-	    tt_info.total_travel_time = trv_time;
-	    tt_info.src_dpnt_corr = src_dpnt_corr[0];
+	    tt_info->total_travel_time = trv_time;
+	    tt_info->src_dpnt_corr = src_dpnt_corr[0];
 
 	    /*
 	     * Correct travel-time derivative relative to sum of all time
@@ -897,14 +859,14 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 	     */
 
 	    /*
-	    tt_deriv_corr = (trv_time - tt_info.tt_table_value)/distance;
+	    tt_deriv_corr = (trv_time - tt_info->tt_table_value)/distance;
 	    prin_deriv[0] += tt_deriv_corr;
 	    printf ("horiz_slow: %8.4f  tt_deriv_corr: %8.4f\n",
 		prin_deriv[0], tt_deriv_corr);
 		*/
 
 	    /*
-	     * Get model error (tt_info.model_error) from travel-time tables
+	     * Get model error (tt_info->model_error) from travel-time tables
 	     * if distance variance weighting has been requested.  Better yet,
 	     * if a SSSC modeling error is available, then it takes precedance
 	     * over all other modeling errors.
@@ -913,23 +875,23 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 	    if (locator_params->dist_var_wgt)
 	    {
 		if (me_sssc > 0.0)
-		    tt_info.model_error = me_sssc;
+		    tt_info->model_error = me_sssc;
 		else
 		{
 		    /* 
 		     * The last two argument can be NULL, since when called from
 		     * here, get_model_error is only getting 1-D models.
 		     */
-		    tt_info.model_error = 
+		    tt_info->model_error = 
 			get_model_error (phase_index, distance, ev_depth, 0.0, NULL);
-		    tt_info.model_error *= me_factor;
+		    tt_info->model_error *= me_factor;
 		}
-		if (tt_info.meas_error < 0.0)
-		    tt_info.model_plus_meas_error = -1.0;
+		if (tt_info->meas_error < 0.0)
+		    tt_info->model_plus_meas_error = -1.0;
 		else
-		    tt_info.model_plus_meas_error = 
-			sqrt (tt_info.model_error*tt_info.model_error + 
-			      tt_info.meas_error*tt_info.meas_error);
+		    tt_info->model_plus_meas_error = 
+			sqrt (tt_info->model_error*tt_info->model_error + 
+			      tt_info->meas_error*tt_info->meas_error);
 	    }
 
 	    esr	= esaz*DEG_TO_RAD;
@@ -974,7 +936,7 @@ total_travel_time (Locator_params *locator_params, Site *sites,
 	    az_deriv[3] = 0.0;			/* Points Up */
 	}
 
-	*ar_info = tt_info;
+	*ar_info = *tt_info;
 
 	return (trv_time);
 }
@@ -993,6 +955,7 @@ compute_ttime_w_corrs (Locator_params *locator_params, Site *sites,
 	int	interp_code;
 	double	trv_time = -1.0;
 	double	prin_deriv[4], tt_deriv[4], slow_deriv[4], az_deriv[4];
+	Ar_Info	*tt_info = &loc_state()->tt_info;
 
 
 	/*
@@ -1002,8 +965,8 @@ compute_ttime_w_corrs (Locator_params *locator_params, Site *sites,
 	 * theoreticals, no guarantee is made that this has been initialized.
 	 */
 
-	tt_info = initialize_ar_info ();
-	*ar_info = tt_info;
+	*tt_info = initialize_ar_info ();
+	*ar_info = *tt_info;
 
 	/*
 	 * Get phase and station/phase/model indexes given phase
@@ -1048,12 +1011,11 @@ trv_time_w_ellip_elev (Bool extrapolate, Bool do_we_need_z_derivs,
 	double	el, elev_corr, ellip_corr;
 	double	surf_vel;
 	double	trv_time;
-
-	static	double	save_ev_lat = 99.0;
-	static	double	ev_geoc_co_lat = 0.0;
+	Loc_State *state = loc_state();
+	Ar_Info	*tt_info = &state->tt_info;
 
 
-	tt_info.src_dpnt_corr_type = NO_SRC_DPNT_CORR;
+	tt_info->src_dpnt_corr_type = NO_SRC_DPNT_CORR;
 
 	if (phase_index < 0)
 	    return (-1.0);		/* Indicates phase index not found */
@@ -1069,10 +1031,11 @@ trv_time_w_ellip_elev (Bool extrapolate, Bool do_we_need_z_derivs,
 	 * geocetric co-latitude (radians).
 	 */
 
-	if (ev_lat != save_ev_lat)
+	if (ev_lat != state->save_ev_lat)
 	{
-	    ev_geoc_co_lat = lat_conv (ev_lat, TRUE, TRUE, FALSE, TRUE, FALSE);
-	    save_ev_lat = ev_lat;
+	    state->ev_geoc_co_lat =
+		lat_conv (ev_lat, TRUE, TRUE, FALSE, TRUE, FALSE);
+	    state->save_ev_lat = ev_lat;
 	}
 
 	/*
@@ -1137,10 +1100,11 @@ trv_time_w_ellip_elev (Bool extrapolate, Bool do_we_need_z_derivs,
 	if (tt_table[phase_index].ec_table != (EC_Table *) NULL)
 	    ellip_corr = 
 	    get_ec_from_table (tt_table[phase_index].ec_table, distance, esaz, 
-			       ev_geoc_co_lat, ev_depth);
+			       state->ev_geoc_co_lat, ev_depth);
 	else
 	    ellip_corr = 
-	    ellipticity_corr (distance, esaz, ev_geoc_co_lat, ev_depth, phase);
+	    ellipticity_corr (distance, esaz, state->ev_geoc_co_lat, ev_depth,
+			      phase);
 
 	/* 
 	 * Calculate elevation correction 
@@ -1191,12 +1155,12 @@ trv_time_w_ellip_elev (Bool extrapolate, Bool do_we_need_z_derivs,
 	 * Populate tt_info structure here
 	 */
 
-	tt_info.tt_table_value		= (double) value;
-	tt_info.ellip_corr		= ellip_corr;
-	tt_info.elev_corr		= elev_corr;
-	tt_info.bulk_static_sta_corr	= bulk_static_sta_corr;
+	tt_info->tt_table_value		= (double) value;
+	tt_info->ellip_corr		= ellip_corr;
+	tt_info->elev_corr		= elev_corr;
+	tt_info->bulk_static_sta_corr	= bulk_static_sta_corr;
 
-	strcpy (tt_info.vmodel, tt_table[phase_index].vmodel);
+	strcpy (tt_info->vmodel, tt_table[phase_index].vmodel);
 
 	return (trv_time);
 }
@@ -1204,7 +1168,7 @@ trv_time_w_ellip_elev (Bool extrapolate, Bool do_we_need_z_derivs,
 char *
 get_vmodel()
 {
-    return(tt_info.vmodel);
+    return(loc_state()->tt_info.vmodel);
 }
 
 /* trv_time:Input travel-time (sec.) at Earth's surface
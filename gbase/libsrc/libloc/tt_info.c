@@ -128,6 +128,7 @@
 #include "config.h"
 #include <string.h>
 #include "libloc.h"
+#include "locp.h"
 #include "tt_info.h"
 #include "loc_info.h"
 #include "libgeog.h"
@@ -154,7 +155,7 @@ static 	Period_Info 	*infra_period = (Period_Info *)(NULL);
 static 	Period_Time 	*hydro_period_time = (Period_Time *)(NULL);
 static 	Period_Time 	*infra_period_time = (Period_Time *)(NULL);
 static	int		number_of_periods[] = {0,0};
-static  Control_Flags  control = {20.0,0,0,0,0,0,0,HYDRO_INDEX};
+static  Control_Flags  control = {20.0,0,0,0,0,HYDRO_INDEX};
 
 int read_HY_info(char *list_file)
 {
@@ -181,8 +182,8 @@ int read_HY_info(char *list_file)
 
 	free_whole_table(hydro_period);
 	free_whole_table(infra_period);
-	control.current_hydro_per_index = 0;
-	control.current_infra_per_index = 0;
+	loc_state()->hydro_per_index	= 0;
+	loc_state()->infra_per_index	= 0;
 	control.initiated		= 0;
 	control.epoch_time_set		= 0;
 	control.use_hydro_2D_table      = 0;
@@ -472,13 +473,13 @@ int initialize_radial_2D_tables (char *sta_names[], int num_sta_names, char *tt_
 int station_in_radial_2D_tables(char *sta)
 {
     int i,j;
-    i = control.current_hydro_per_index;
+    i = loc_state()->hydro_per_index;
     if(control.use_hydro_2D_table && hydro_period!=NULL && hydro_period[i].station!=NULL)
 	for(j=0;j<hydro_period[i].num_station;j++)
 	    if(STREQ(hydro_period[i].station[j].sta,sta))
 		return HYDRO_INDEX;
 
-    i = control.current_infra_per_index;
+    i = loc_state()->infra_per_index;
     if(control.use_infra_2D_table && infra_period!=NULL && infra_period[i].station!=NULL)
 	for(j=0;j<infra_period[i].num_station;j++)
 	    if(STREQ(infra_period[i].station[j].sta,sta))
@@ -671,12 +672,12 @@ void get_acoustic_tt(char *sta, double ev_lat,double ev_lon,double *travel_time,
     if(tech_index == HYDRO_INDEX)
     {
 	period = hydro_period;
-	i = control.current_hydro_per_index;
+	i = loc_state()->hydro_per_index;
     }
     else if(tech_index == INFRA_INDEX)
     {
 	period = infra_period;
-	i = control.current_infra_per_index;
+	i = loc_state()->infra_per_index;
     }
     else
     {
@@ -767,24 +768,27 @@ float delta_rad;
 if(tech_index == HYDRO_INDEX)
 {
     period = hydro_period;
-    i = control.current_hydro_per_index;
+    i = loc_state()->hydro_per_index;
 }
 else
 {
     period = infra_period;
-    i = control.current_infra_per_index;
+    i = loc_state()->infra_per_index;
 }
 
 j = station_index;
 
 /* If the travel time table is not loaded, get it */
 
+loc_lock();
 if(period[i].station[j].num_azimuth == -999) {
   if (load_acoustic_tt(period, i, j) == ERR) {
+    loc_unlock();
     fprintf(stderr, "Failed to load travel time table\n");
     return;
   }
 }
+loc_unlock();
 while(azimuth<0.0) azimuth+=360.0;
 while(azimuth>360.0) azimuth -= 360.0; 
 k=0;
@@ -923,12 +927,12 @@ void set_epoch_travel_time(double etime)
     if(control.use_hydro_2D_table)
     {
 	for(n=0; hydro_period_time[n].last_doy < doy; n++);
-	control.current_hydro_per_index = hydro_period_time[n].index;
+	loc_state()->hydro_per_index = hydro_period_time[n].index;
     }
     if(control.use_infra_2D_table)
     {
 	for(n=0; infra_period_time[n].last_doy < doy; n++);
-	control.current_infra_per_index = infra_period_time[n].index;
+	loc_state()->infra_per_index = infra_period_time[n].index;
     }
     control.initiated         = TRUE;
 }
@@ -939,9 +943,9 @@ char *get_current_radial_2D_period_name(char *sta)
     int tech_index;
     tech_index = station_in_radial_2D_tables(sta);
     if(tech_index==HYDRO_INDEX)
-	return hydro_period[control.current_hydro_per_index].per;
+	return hydro_period[loc_state()->hydro_per_index].per;
     if(tech_index==INFRA_INDEX)
-	return infra_period[control.current_infra_per_index].per;
+	return infra_period[loc_state()->infra_per_index].per;
     return("ERROR");
 }
 
@@ -956,12 +960,12 @@ double get_2D_model_error(char *sta, double dist, double azimuth)
 	if(tech_index == HYDRO_INDEX)
 	{
 	    period = hydro_period;
-	    i = control.current_hydro_per_index;
+	    i = loc_state()->hydro_per_index;
 	}
 	else
 	{
 	    period = infra_period;
-	    i = control.current_infra_per_index;
+	    i = loc_state()->infra_per_index;
 	}
 	/* find station_index j */
 
@@ -25,9 +25,10 @@
  *	"TL: Input error code is out-of-range!", will be returned.
 
  * NOTES
- *	Error codes are broken down into 3 distinct areas, prefixed as:
+ *	Error codes are broken down into 4 distinct areas, prefixed as:
  *	    TLreadErr:	Problem encountered while reading TL info
  *	    TLreadWarn:	Warning condition encountered while reading TL info
+ *	    TLwriteErr:	Problem encountered while writing compiled TL info
  *	    TLgetErr:	Failure encountered during access to TL info
 
  * SEE ALSO
@@ -54,7 +55,8 @@ char
 /* 5 */ "TLreadErr4: TL table incorrectly formatted!",
 /* 6 */ "TLreadErr5: TL modelling error table incorrectly formatted!",
 /* 7 */ "TLreadErr6: TL test-site corr. file incorrectly formatted!",
-/* 8 */ "TLreadErr7: Error allocating memory while reading TL info!"
+/* 8 */ "TLreadErr7: Error allocating memory while reading TL info!",
+/* 9 */ "TLwriteErr1: Cannot write compiled TL table!"
 };
 
 char
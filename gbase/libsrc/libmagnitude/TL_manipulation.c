@@ -14,6 +14,7 @@
  *	set_sta_TL_pt -- Set station pointers for rapid search of TLtype
  *	get_TL_ts_corr -- Get TL test-site correction
  *	free_tl_table -- Free memory associated with individual TL tables
+ *	compile_tl_tables -- Write compiled forms of the TL tables read
  *	get_delta_for_sta -- Get distance (arc deg) to event for input station
  
  * FILE
@@ -90,6 +91,9 @@
  *	void
  *	free_tl_table ()
 
+ *	int
+ *	compile_tl_tables ()
+
  *	double
  *	get_delta_for_sta (sta, ev_lat, ev_lon)
  *	char	*sta;			(i) Station name
@@ -154,6 +158,13 @@
  *	handling of these tables is done local to this file and the lower-
  *	level file, read_tl_table.c.
 
+ *	-- compile_tl_tables(), writes the compiled form of every TL table
+ *	read by the last call to read_tlsf() (i.e., by setup_mag_facilities())
+ *	next to its text table, so that later sessions can map the tables
+ *	instead of parsing them (see read_compiled_tl_table()).  Each file
+ *	is written to a temporary name and then renamed, so a process that
+ *	has the old file mapped is not disturbed.
+
  *	-- get_delta_for_sta() computes the event-to-station distance (arc
  *	deg) given the input station name and event latitude and longitude.
 
@@ -208,6 +219,10 @@
  *	-- get_TL_ts_corr() will return a condition of TRUE, if the requested
  *	test-site correction is found.  Else, a condition of FALSE is returned.
 
+ *	-- compile_tl_tables() will return an error code of TLwriteErr1 if a
+ *	compiled TL table cannot be written, or TLreadErr3 if no TL tables
+ *	have been read.
+
  *	-- get_delta_for_sta() will return the event-to-station distance (arc
  *	deg) if successful.  If input station is not found in static site
  *	table, then -1.0 will be returned.
@@ -232,9 +247,13 @@
  */
 
 
+#include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #include "libinterp.h"
 #include "libgeog.h"
 #include "libmagnitude.h"
@@ -1628,36 +1647,61 @@ double	*ts_corr;
 void
 free_tl_table () 
 {
-	int	 i, j;
-	TL_Table *mc_table = NULL;
+	int	 i;
 
 	for (i = 0; i < num_TL_tables; i++)
 	{
-	    mc_table = tl_table_ptr[i];
-	    for (j = 0; j < mc_table->num_depths; j++)
-		UFREE (mc_table->tl[j]);
-	    UFREE (mc_table->tl);
+	    free_tl_table_entry (tl_table_ptr[i]);
+	    UFREE (tl_table_ptr[i]);
+	}
+	UFREE (tl_table_ptr);
+	tl_table_ptr = (TL_Table **) NULL;
+	num_TL_tables = 0;
+}
+
 
-	    if (mc_table->tl_mdl_err != NULL)
+int
+compile_tl_tables () 
+{
+	int	i, k;
+	int	iret = OK;
+	char	file_name[FILENAMELEN];
+	char	tmp_name[FILENAMELEN+16];
+	TL_Table *mc_table;
+
+
+	if (num_TL_tables < 1)
+	    return (TLreadErr3);
+
+	for (i = 0; i < num_TL_tables; i++)
+	{
+	    mc_table = tl_table_ptr[i];
+	    for (k = 0; k < num_TL_models; k++)
+		if (STREQ (mc_table->model, tl_model_path[k].model))
+		    break;
+	    if (k == num_TL_models ||
+		tl_table_file_name (tl_model_path[k].dir_pathway,
+				    mc_table->TLtype, mc_table->model,
+				    mc_table->phase, mc_table->chan,
+				    file_name) != OK)
 	    {
-		if (mc_table->tl_mdl_err->dist_depth_var != NULL)
-		{
-		    for (j = 0; j < mc_table->tl_mdl_err->num_depths;j++)
-			UFREE (mc_table->tl_mdl_err->dist_depth_var[j]);
-		    UFREE (mc_table->tl_mdl_err->dist_depth_var);
-		}
-		UFREE (mc_table->tl_mdl_err);
+		iret = TLwriteErr1;
+		continue;
 	    }
-	    if (mc_table->tl_ts_cor != NULL)
+	    sprintf (tmp_name, "%s.tlc.%d", file_name, (int) getpid ());
+	    strcat (file_name, ".tlc");
+
+	    if (write_compiled_tl_table (tmp_name, mc_table) != OK ||
+		rename (tmp_name, file_name) != 0)
 	    {
-		for (j = 0; j < mc_table->num_ts_regions; j++)
-		    UFREE (mc_table->tl_ts_cor[j].ts_corr);
-		UFREE (mc_table->tl_ts_cor);
-		mc_table->tl_ts_cor = (TL_TS_Cor *) NULL;
+		fprintf (stderr, "compile_tl_tables: Cannot write %s\n",
+				 file_name);
+		remove (tmp_name);
+		iret = TLwriteErr1;
 	    }
 	}
-	UFREE (mc_table);
-	mc_table = (TL_Table *) NULL;
+
+	return (iret);
 }
 
 
@@ -0,0 +1,102 @@
+
+/*
+ * NAME
+ *	calc_mags_batch -- Compute the magnitudes of a batch of origins.
+
+ * FILE
+ *	calc_mags_batch.c
+
+ * SYNOPSIS
+ *	int
+ *	calc_mags_batch (events, num_events, mag_params, num_threads)
+ *	Mag_Event	*events;	(i/o) Origins and their magnitude
+ *					      objects
+ *	int		num_events;	(i)   Number of events
+ *	Mag_Params	*mag_params;	(i)   Magnitude parameter controls
+ *	int		num_threads;	(i)   Number of threads (<= 0: one per
+ *					      online processor)
+
+ * DESCRIPTION
+ *	Function.  calc_mags_batch() calls calc_mags() for each of the
+ *	events, sharing the events among the threads.  Each thread takes
+ *	the next event as it finishes the last, so origins with many
+ *	station amplitudes balance out.  The return of calc_mags() is
+ *	returned in events[i].ret.  When more than one thread is used,
+ *	verbose output is turned off, since the events would all write to
+ *	the same output.
+
+ * DIAGNOSTICS
+ *	Returns the number of events for which calc_mags() did not return
+ *	an error (events[i].ret >= 0).
+
+ * NOTES
+ *	The MDF and TL tables must already have been read by function,
+ *	setup_mag_facilities(), and are only read here, so they are loaded
+ *	once for the whole batch.  The magnitude objects of different
+ *	events must not share their amplitude or stamag records.
+
+ * SEE ALSO
+ *	calc_mags(), locate_events() [libloc].
+ */
+
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "libmagnitude.h"
+#include "libstring.h"
+
+typedef struct {
+	Mag_Event	*events;
+	Mag_Params	*mag_params;
+	Bool		quiet;
+} Batch_Work;
+
+static void calc_one(int i, void *arg);
+
+
+int
+calc_mags_batch (Mag_Event *events, int num_events, Mag_Params *mag_params,
+		 int num_threads)
+{
+	int	i, num_done;
+	Batch_Work w;
+
+	if (num_events <= 0 || ! events || ! mag_params)
+	    return (0);
+
+	num_threads = parallel_threads (num_events, num_threads);
+
+	w.events = events;
+	w.mag_params = mag_params;
+	w.quiet = (num_threads > 1);
+
+	parallel_run (num_events, num_threads, calc_one, &w);
+
+	for (i = 0, num_done = 0; i < num_events; i++)
+	    if (events[i].ret >= 0)
+		num_done++;
+
+	return (num_done);
+}
+
+
+static void
+calc_one (int i, void *arg)
+{
+	Batch_Work	*w = (Batch_Work *) arg;
+	Mag_Event	*ev = &w->events[i];
+	Mag_Params	mp;
+
+	mp = *w->mag_params;
+	if (w->quiet)
+	    mp.verbose = 0;
+
+	if (ev->origin == (Origin *) NULL)
+	{
+	    ev->ret = ERR;
+	    return;
+	}
+	ev->ret = calc_mags (ev->magn_ptr, ev->num_magns, ev->origin, &mp);
+}
+
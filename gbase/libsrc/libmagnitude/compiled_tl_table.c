@@ -0,0 +1,426 @@
+
+/*
+ * NAME
+ *	tl_table_file_name -- Build the file name of a TL table.
+ *	write_compiled_tl_table -- Write a compiled TL table file.
+ *	read_compiled_tl_table -- Fill a TL table from its compiled file.
+ *	free_tl_table_entry -- Free the arrays of a single TL table.
+
+ * FILE
+ *	compiled_tl_table.c
+
+ * SYNOPSIS
+ *	int
+ *	tl_table_file_name (dir_pathway, TLtype, tl_model, phase, chan,
+ *			    file_name)
+ *	char	*dir_pathway;		(i) Directory pathway of TL model
+ *	char	*TLtype;		(i) TL type
+ *	char	*tl_model;		(i) TL model name
+ *	char	*phase;			(i) Phase type (not required dependency)
+ *	char	*chan;			(i) Chan type (not required dependency)
+ *	char	*file_name;		(o) TL table file name (FILENAMELEN)
+
+ *	int
+ *	write_compiled_tl_table (file_name, tl_table)
+ *	char	*file_name;		(i) Compiled file to write
+ *	TL_Table *tl_table;		(i) TL table to write
+
+ *	int
+ *	read_compiled_tl_table (file_name, tl_table)
+ *	char	*file_name;		(i) Text TL table file name
+ *	TL_Table *tl_table;		(i/o) TL table to fill
+
+ *	void
+ *	free_tl_table_entry (tl_table)
+ *	TL_Table *tl_table;		(i) TL table to free
+
+ * DESCRIPTION
+ *	Functions.  A compiled TL table file holds the TL table and the
+ *	modelling errors of one text TL table, as they are held in the
+ *	tl_table structure, in a binary file named <file_name>.tlc next
+ *	to the text table.  read_tl_table() uses it in place of the text
+ *	table, so that the tables need not be parsed for each session.
+
+ *	-- tl_table_file_name() builds the name of the text TL table as
+ *	<dir_pathway>/<tl_model>.<TLtype>[.<phase>[.<chan>]], where phase
+ *	and chan are only used if they are neither NULL nor "-".
+
+ *	-- write_compiled_tl_table() writes the compiled form of tl_table.
+ *	compile_tl_tables() calls it for every table read by read_tlsf().
+
+ *	-- read_compiled_tl_table() maps <file_name>.tlc into memory and
+ *	sets the tables and modelling errors of tl_table from it.  The
+ *	arrays point directly into the mapped file; only the row pointers
+ *	are allocated.  The TLtype, model, phase and chan of tl_table must
+ *	already be set.  Test-site corrections are not part of the
+ *	compiled file.  If the text table is newer than the compiled file,
+ *	the compiled file is not used.
+
+ *	-- free_tl_table_entry() frees the arrays and test-site corrections
+ *	of tl_table, whether read from a text table or a compiled file,
+ *	but not the structure itself.
+
+ * DIAGNOSTICS
+ *	-- tl_table_file_name() returns ERR if the name is too long.
+
+ *	-- write_compiled_tl_table() returns OK, or ERR if the file cannot
+ *	be written.
+
+ *	-- read_compiled_tl_table() returns OK if tl_table was filled, ERR
+ *	if there is no usable compiled file, TLreadErr4 for a corrupt file
+ *	and TLreadErr7 if memory cannot be allocated.
+
+ * FILES
+ *	<file_name>.tlc compiled TL table.
+
+ * NOTES
+ *	A compiled file is in the byte order of the host that wrote it, so
+ *	that it can be used in place.  A file written on a host of the
+ *	other byte order is ignored.
+
+ * SEE ALSO
+ *	read_tl_table(), compile_tl_tables(), compile_tt_tables() [libloc],
+ *	compiled_file_open() [libstring].
+ */
+
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "libmagnitude.h"
+#include "libstring.h"
+#include "magp.h"
+#include "tl_defs.h"
+
+#define TLC_SUFFIX	".tlc"
+#define TLC_MAGIC	"TLCOMP\n"
+#define TLC_VERSION	1
+
+/* Bits of TLC_Header.me_arrays */
+#define ME_DIST_SAMPLES		1
+#define ME_DEPTH_SAMPLES	2
+#define ME_DIST_VAR		4
+#define ME_DIST_DEPTH_VAR	8
+
+/*
+ * The arrays follow the header as floats: depth_samples, dist_samples,
+ * tl rows, then the modelling error arrays flagged in me_arrays.
+ */
+typedef struct
+{
+	CompiledFileHeader	file;
+	int	num_dists;
+	int	num_depths;
+	float	in_hole_dist[2];
+	int	me_arrays;		/* -1 if no modelling errors */
+	int	me_num_dists;
+	int	me_num_depths;
+	float	me_bulk_var;
+} TLC_Header;
+
+struct tl_compiled
+{
+	CompiledFile	file;
+};
+
+static void release_compiled_tl_table(TL_Compiled *tlc);
+
+
+int
+tl_table_file_name (char *dir_pathway, char *TLtype, char *tl_model,
+		    char *phase, char *chan, char *file_name)
+{
+	int	len;
+
+	len = strlen (dir_pathway) + strlen (tl_model) + strlen (TLtype) + 3;
+	if (phase != (char *) NULL && strcmp (phase, "-"))
+	{
+	    len += strlen (phase) + 1;
+	    if (chan != (char *) NULL && strcmp (chan, "-"))
+		len += strlen (chan) + 1;
+	}
+	if (len + (int) strlen (TLC_SUFFIX) + 8 > FILENAMELEN)
+	    return (ERR);
+
+	strcpy (file_name, dir_pathway);
+	strcat (file_name, "/");
+	strcat (file_name, tl_model);
+	strcat (file_name, ".");
+	strcat (file_name, TLtype);
+	if (phase != (char *) NULL && strcmp (phase, "-"))
+	{
+	    strcat (file_name, ".");
+	    strcat (file_name, phase);
+	    if (chan != (char *) NULL && strcmp (chan, "-"))
+	    {
+		strcat (file_name, ".");
+		strcat (file_name, chan);
+	    }
+	}
+	return (OK);
+}
+
+
+int
+write_compiled_tl_table (char *file_name, TL_Table *tl_table)
+{
+	FILE	*fp;
+	int	j;
+	TLC_Header	h;
+	TL_Mdl_Err	*me = tl_table->tl_mdl_err;
+
+
+	memset ((void *) &h, 0, sizeof (TLC_Header));
+	compiled_file_header (&h.file, TLC_MAGIC, TLC_VERSION);
+	h.num_dists = tl_table->num_dists;
+	h.num_depths = tl_table->num_depths;
+	h.in_hole_dist[0] = tl_table->in_hole_dist[0];
+	h.in_hole_dist[1] = tl_table->in_hole_dist[1];
+	h.me_arrays = -1;
+	if (me != (TL_Mdl_Err *) NULL)
+	{
+	    h.me_arrays = 0;
+	    h.me_num_dists = me->num_dists;
+	    h.me_num_depths = me->num_depths;
+	    h.me_bulk_var = me->bulk_var;
+	    if (me->dist_samples != NULL)
+		h.me_arrays |= ME_DIST_SAMPLES;
+	    if (me->depth_samples != NULL)
+		h.me_arrays |= ME_DEPTH_SAMPLES;
+	    if (me->dist_var != NULL)
+		h.me_arrays |= ME_DIST_VAR;
+	    if (me->dist_depth_var != NULL)
+		h.me_arrays |= ME_DIST_DEPTH_VAR;
+	}
+
+	if ((fp = fopen (file_name, "w")) == NULL)
+	    return (ERR);
+	fwrite (&h, sizeof (TLC_Header), 1, fp);
+
+	compiled_file_write_floats (fp, tl_table->depth_samples, tl_table->num_depths);
+	compiled_file_write_floats (fp, tl_table->dist_samples, tl_table->num_dists);
+	for (j = 0; j < tl_table->num_depths; j++)
+	    compiled_file_write_floats (fp, tl_table->tl[j], tl_table->num_dists);
+
+	if (h.me_arrays > 0)
+	{
+	    if (h.me_arrays & ME_DIST_SAMPLES)
+		compiled_file_write_floats (fp, me->dist_samples, me->num_dists);
+	    if (h.me_arrays & ME_DEPTH_SAMPLES)
+		compiled_file_write_floats (fp, me->depth_samples, me->num_depths);
+	    if (h.me_arrays & ME_DIST_VAR)
+		compiled_file_write_floats (fp, me->dist_var, me->num_dists);
+	    if (h.me_arrays & ME_DIST_DEPTH_VAR)
+		for (j = 0; j < me->num_depths; j++)
+		    compiled_file_write_floats (fp, me->dist_depth_var[j], me->num_dists);
+	}
+
+	if (ferror (fp))
+	{
+	    fclose (fp);
+	    return (ERR);
+	}
+	return (fclose (fp) == 0 ? OK : ERR);
+}
+
+
+int
+read_compiled_tl_table (char *file_name, TL_Table *tl_table)
+{
+	int	ret;
+	size_t	nfloats, max_floats;
+	char	tlc_name[FILENAMELEN+8];
+	float	*x;
+	struct	stat	text_buf;
+	TL_Compiled	*tlc;
+	TLC_Header	h;
+	TL_Mdl_Err	*me;
+
+
+	sprintf (tlc_name, "%s%s", file_name, TLC_SUFFIX);
+	if ((tlc = (TL_Compiled *) calloc (1, sizeof (TL_Compiled))) == NULL)
+	    return (ERR);
+
+	if ((ret = compiled_file_open (tlc_name, TLC_MAGIC, TLC_VERSION,
+				sizeof (TLC_Header), &tlc->file)) != 0)
+	{
+	    if (ret == -3)
+		fprintf (stderr, "read_tl_table: %s is not a compiled TL table for this host, using text table\n", tlc_name);
+	    free (tlc);
+	    return (ERR);
+	}
+
+	/* A text table edited since compiling takes precedence */
+
+	if (stat (file_name, &text_buf) == 0 &&
+	    text_buf.st_mtime > tlc->file.mtime)
+	{
+	    release_compiled_tl_table (tlc);
+	    return (ERR);
+	}
+	memcpy ((void *) &h, tlc->file.base, sizeof (TLC_Header));
+
+	/* Check the arrays against the size of the file */
+
+	max_floats = (tlc->file.size - sizeof (TLC_Header))/sizeof (float);
+	nfloats = 0;
+	if (!compiled_file_add_floats (&nfloats, max_floats, h.num_dists, 1) ||
+	    !compiled_file_add_floats (&nfloats, max_floats, h.num_depths, 1) ||
+	    !compiled_file_add_floats (&nfloats, max_floats,
+			h.num_dists, h.num_depths) ||
+	    h.me_num_dists < 0 || h.me_num_depths < 0)
+	{
+	    release_compiled_tl_table (tlc);
+	    return (TLreadErr4);
+	}
+	if (h.me_arrays > 0)
+	{
+	    if (((h.me_arrays & ME_DIST_SAMPLES) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			h.me_num_dists, 1)) ||
+		((h.me_arrays & ME_DEPTH_SAMPLES) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			h.me_num_depths, 1)) ||
+		((h.me_arrays & ME_DIST_VAR) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			h.me_num_dists, 1)) ||
+		((h.me_arrays & ME_DIST_DEPTH_VAR) &&
+		 !compiled_file_add_floats (&nfloats, max_floats,
+			h.me_num_dists, h.me_num_depths)))
+	    {
+		release_compiled_tl_table (tlc);
+		return (TLreadErr4);
+	    }
+	}
+
+	x = (float *) (tlc->file.base + sizeof (TLC_Header));
+
+	tl_table->compiled = tlc;
+	tl_table->num_dists = h.num_dists;
+	tl_table->num_depths = h.num_depths;
+	tl_table->in_hole_dist[0] = h.in_hole_dist[0];
+	tl_table->in_hole_dist[1] = h.in_hole_dist[1];
+	tl_table->depth_samples = x;
+	x += h.num_depths;
+	tl_table->dist_samples = x;
+	x += h.num_dists;
+	if ((tl_table->tl = compiled_file_rows (x, h.num_depths,
+					h.num_dists)) == NULL)
+	    return (TLreadErr7);
+	x += h.num_depths*h.num_dists;
+
+	if (h.me_arrays >= 0)
+	{
+	    if ((me = (TL_Mdl_Err *) calloc (1, sizeof (TL_Mdl_Err))) == NULL)
+		return (TLreadErr7);
+	    tl_table->tl_mdl_err = me;
+	    me->bulk_var = h.me_bulk_var;
+	    me->num_dists = h.me_num_dists;
+	    me->num_depths = h.me_num_depths;
+	    if (h.me_arrays & ME_DIST_SAMPLES)
+	    {
+		me->dist_samples = x;
+		x += me->num_dists;
+	    }
+	    if (h.me_arrays & ME_DEPTH_SAMPLES)
+	    {
+		me->depth_samples = x;
+		x += me->num_depths;
+	    }
+	    if (h.me_arrays & ME_DIST_VAR)
+	    {
+		me->dist_var = x;
+		x += me->num_dists;
+	    }
+	    if (h.me_arrays & ME_DIST_DEPTH_VAR)
+	    {
+		if ((me->dist_depth_var = compiled_file_rows (x, me->num_depths,
+						me->num_dists)) == NULL)
+		    return (TLreadErr7);
+	    }
+	}
+
+	return (OK);
+}
+
+
+void
+free_tl_table_entry (TL_Table *tl_table)
+{
+	int	i, j;
+	TL_Mdl_Err	*me = tl_table->tl_mdl_err;
+	TL_TS_Cor	*tsc;
+
+
+	if (tl_table->compiled != NULL)
+	{
+	    /* Only the row pointers and structures were allocated */
+
+	    UFREE (tl_table->tl);
+	    if (me != NULL)
+	    {
+		UFREE (me->dist_depth_var);
+		UFREE (tl_table->tl_mdl_err);
+	    }
+	    release_compiled_tl_table (tl_table->compiled);
+	    tl_table->compiled = (TL_Compiled *) NULL;
+	}
+	else
+	{
+	    if (tl_table->tl != NULL)
+	    {
+		for (j = 0; j < tl_table->num_depths; j++)
+		    UFREE (tl_table->tl[j]);
+		UFREE (tl_table->tl);
+	    }
+	    if (me != NULL)
+	    {
+		UFREE (me->depth_samples);
+		UFREE (me->dist_var);
+		UFREE (me->dist_samples);
+		if (me->dist_depth_var != NULL)
+		{
+		    for (j = 0; j < me->num_depths; j++)
+			UFREE (me->dist_depth_var[j]);
+		    UFREE (me->dist_depth_var);
+		}
+		UFREE (tl_table->tl_mdl_err);
+	    }
+	    UFREE (tl_table->depth_samples);
+	    UFREE (tl_table->dist_samples);
+	}
+
+	if (tl_table->tl_ts_cor != NULL)
+	{
+	    for (i = 0; i < tl_table->num_ts_regions; i++)
+	    {
+		tsc = &tl_table->tl_ts_cor[i];
+		if (tsc->sta != NULL)
+		{
+		    for (j = 0; j < tsc->num_sta; j++)
+			UFREE (tsc->sta[j]);
+		    UFREE (tsc->sta);
+		}
+		UFREE (tsc->ts_corr);
+	    }
+	    UFREE (tl_table->tl_ts_cor);
+	}
+	tl_table->tl_mdl_err = (TL_Mdl_Err *) NULL;
+	tl_table->tl_ts_cor = (TL_TS_Cor *) NULL;
+	tl_table->num_ts_regions = 0;
+	tl_table->dist_samples = (float *) NULL;
+	tl_table->depth_samples = (float *) NULL;
+	tl_table->num_depths = 0;
+	tl_table->num_dists = 0;
+}
+
+
+static void
+release_compiled_tl_table (TL_Compiled *tlc)
+{
+	compiled_file_close (&tlc->file);
+	free (tlc);
+}
@@ -396,7 +396,6 @@ static	int	num_mst = 0;
 
 static	Mag_Descrip	*mag_descrip = (Mag_Descrip *) NULL;
 static	Mag_Sta_TLType	*mag_sta_tltype = (Mag_Sta_TLType *) NULL;
-static	SM_Info		SM_struct;
 
 
 int
@@ -547,6 +546,7 @@ SM_Info	*sm_info;
 	double	sta_magnitude;
 	double	mag_cor_deriv[4];
 	char	model[16];
+	SM_Info	SM_struct;
         Stamag  Na_Stamag_rec = Na_Stamag_Init;
 
 
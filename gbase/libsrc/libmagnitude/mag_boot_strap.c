@@ -45,6 +45,11 @@
  * 	If fewer than num_boots re-samples are needed for convergence, 
  *	then this routine will break from main loop early.
 
+ *	The random number generator is seeded once per process.  Each call
+ *	then draws from its own erand48() state, seeded from the shared
+ *	generator under a lock, so that calc_mags() may be called from
+ *	several threads at once (see calc_mags_batch()).
+
  * SEE ALSO
  *	Local function, mag_max_lik().
 
@@ -60,17 +65,24 @@
 
 
 
+#include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <sys/time.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 #include "magp.h"
 
-extern	double	drand48();
+extern	double	erand48();
 extern	void	srand48();
 extern	long	lrand48();
 
 static	Bool	first_call = FALSE;
+#ifdef HAVE_PTHREAD
+static	pthread_mutex_t	rand_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 
 int
@@ -98,6 +110,7 @@ int	verbose;
 	int	index, isig, num_data, num_signals;
 	int	mlk_code = 0;
 	long int ran1;
+	unsigned short xsubi[3];
 	double	ave, chk, fmag0, fmag2, num_boot_resamples, sig0, sig2;
 	SM_Sub	*t_sm_sub = (SM_Sub *) NULL;
 	SM_Sub	*b_sm_sub = (SM_Sub *) NULL;
@@ -147,6 +160,9 @@ int	verbose;
 	}
 	b_sm_sub = UALLOCA (SM_Sub, num_data);
 
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock (&rand_lock);
+#endif
 	if (! first_call)
 	{
 	    /*
@@ -165,6 +181,9 @@ int	verbose;
 	    if(gettimeofday(&t,&tz) == -1)
 	    {
 		    fprintf (stderr, "mag_boot_strap: Cannot generate epoch time for random number generation!\n");
+#ifdef HAVE_PTHREAD
+		    pthread_mutex_unlock (&rand_lock);
+#endif
 		    return (ERR);
 	    }
 	    ran1 = (long int) t.tv_sec;
@@ -173,6 +192,16 @@ int	verbose;
 	    first_call = TRUE;
 	}
 
+	/* State of the generator for this call */
+
+	ran1 = lrand48();
+	xsubi[0] = (unsigned short) (ran1 & 0xffff);
+	xsubi[1] = (unsigned short) ((ran1 >> 16) & 0xffff);
+	xsubi[2] = (unsigned short) lrand48();
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock (&rand_lock);
+#endif
+
 	for (num_boot_resamples = 0.0, j = 0; j < num_boots; j++)
 	{
 	    /*
@@ -185,7 +214,7 @@ try_rand_num_gen_again:
 
 	    for (num_signals = 0, i = 0; i < num_data; i++)
 	    {
-		index = (int)(drand48()*(double)num_data);
+		index = (int)(erand48(xsubi)*(double)num_data);
 		if (index == num_data)    /* Memory check */
 		    --index;
 		b_sm_sub[i] = t_sm_sub[index];
@@ -39,7 +39,10 @@
 
  * FILES
  *	Read TL and associated modelling error tables.  Also read test-site
- *	correction information, if available.
+ *	correction information, if available.  If a compiled form of the
+ *	TL table (file_name.tlc, see compile_tl_tables()) exists and is not
+ *	older than the text table, the TL and modelling error tables are
+ *	mapped from it instead.
 
  * NOTES
  *	If input file will not open, then the structure, tl_table, will be 
@@ -57,6 +60,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "libmagnitude.h"
+#include "magp.h"
 #include "tl_defs.h"
 
 
@@ -89,6 +93,7 @@ char *chan,TL_Table **tl_table_ptr)
 	FILE	*tl_fp, *ts_fp;
 	Bool	ok_so_far;
 	int	i, j, k;	
+	int	iret;
 	int	ntbd, ntbz;
 	int	sta_len;
 	char	file_name[FILENAMELEN];
@@ -109,29 +114,11 @@ char *chan,TL_Table **tl_table_ptr)
 	 * a chan dependency, but not the other way around.
 	 */
 
-	strcpy (file_name, dir_pathway);
-	strcat (file_name, "/");
-	strcat (file_name, tl_model);
-	strcat (file_name, ".");
-	strcat (file_name, TLtype);
-	if (phase != (char *) NULL && strcmp (phase, "-"))
+	if (tl_table_file_name (dir_pathway, TLtype, tl_model, phase, chan,
+				file_name) != OK)
 	{
-	    strcat (file_name, ".");
-	    strcat (file_name, phase);
-	    if (chan != (char *) NULL && strcmp (chan, "-"))
-	    {
-		strcat (file_name, ".");
-		strcat (file_name, chan);
-	    }
-	}
-
-	/* 
-	 * Open transmission loss (TL) file given input tl_filename
-	 */
-
-	if ((tl_fp = fopen (file_name, "r")) == NULL)
-	{
-	    fprintf (stderr, "\nWarning: File %s will not open!\n", file_name);
+	    fprintf (stderr, "\nWarning: TL table name too long in %s!\n",
+			     dir_pathway);
 	    return (TLreadWarn1);
 	}
 
@@ -161,7 +148,32 @@ char *chan,TL_Table **tl_table_ptr)
 	tl_table->tl_mdl_err = (TL_Mdl_Err *) NULL;
 	tl_table->num_ts_regions = 0;
 	tl_table->tl_ts_cor = (TL_TS_Cor *) NULL;
+	tl_table->compiled = (TL_Compiled *) NULL;
+
+	/*
+	 * Use the compiled form of the table, if there is one.
+	 */
 
+	if ((iret = read_compiled_tl_table (file_name, tl_table)) == OK)
+	    goto read_test_site;
+	else if (iret != ERR)
+	{
+	    fprintf (stderr, "\nread_tl_table: Error reading compiled form of file: %s\n", file_name);
+	    free_tl_table_entry (tl_table);
+	    UFREE (tl_table);
+	    return (iret);
+	}
+
+	/* 
+	 * Open transmission loss (TL) file given input tl_filename
+	 */
+
+	if ((tl_fp = fopen (file_name, "r")) == NULL)
+	{
+	    fprintf (stderr, "\nWarning: File %s will not open!\n", file_name);
+	    UFREE (tl_table);
+	    return (TLreadWarn1);
+	}
 
 	/* 
 	 * Begin reading TL info.  Just skip first comment line, then read
@@ -486,6 +498,8 @@ char *chan,TL_Table **tl_table_ptr)
 	}
 	fclose (tl_fp);
 
+read_test_site:
+
 	/*
 	 * Finally, is there a directory pointer for test-site
 	 * corrections associated with this TL table ?  If so,
@@ -528,7 +542,7 @@ char *chan,TL_Table **tl_table_ptr)
 					  sizeof (TL_TS_Cor))) == NULL)
 		{
 		    CALLOC_ERR ("tl_table[].ts_cor");
-		    fclose (tl_fp);
+		    fclose (ts_fp);
 		    return (TLreadErr7);
 		}
 
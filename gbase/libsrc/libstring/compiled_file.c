@@ -0,0 +1,218 @@
+/*
+ * NAME
+ *	compiled_file_header
+ *	compiled_file_open
+ *	compiled_file_close
+ *	compiled_file_write_floats
+ *	compiled_file_rows
+ *	compiled_file_add_floats
+ *
+ * FILE
+ *	compiled_file.c
+ *
+ * SYNOPSIS
+ *
+ *	void
+ *	compiled_file_header (h, magic, version)
+ *	CompiledFileHeader *h;	(o) Header to set
+ *	const char *magic;	(i) Magic string of the file format
+ *	int	version;	(i) Version of the file format
+ *
+ *	int
+ *	compiled_file_open (file_name, magic, version, header_size, cf)
+ *	const char *file_name;	(i) Compiled file to open
+ *	const char *magic;	(i) Magic string of the file format
+ *	int	version;	(i) Version of the file format
+ *	size_t	header_size;	(i) Size of the format's header, which
+ *				    starts with a CompiledFileHeader
+ *	CompiledFile *cf;	(o) The open file
+ *
+ *	void
+ *	compiled_file_close (cf)
+ *	CompiledFile *cf;	(i) File to close
+ *
+ *	int
+ *	compiled_file_write_floats (fp, x, n)
+ *	FILE	*fp;		(i) Stream to write
+ *	float	*x;		(i) Array to write
+ *	int	n;		(i) Length of x
+ *
+ *	float **
+ *	compiled_file_rows (x, nrows, ncols)
+ *	float	*x;		(i) Rows of a table, one after the other
+ *	int	nrows;		(i) Number of rows
+ *	int	ncols;		(i) Number of columns
+ *
+ *	int
+ *	compiled_file_add_floats (nfloats, max_floats, nrows, ncols)
+ *	size_t	*nfloats;	(i/o) Running total of floats
+ *	size_t	max_floats;	(i) Floats available in the file
+ *	int	nrows;		(i) Rows of the array
+ *	int	ncols;		(i) Columns of the array
+ *
+ * DESCRIPTION
+ *
+ *	Functions shared by the compiled table files of libloc and
+ *	libmagnitude.  A compiled file starts with a CompiledFileHeader,
+ *	is written in the byte order of its host and is used in place.
+ *
+ *	compiled_file_header () clears h and sets its magic, version and
+ *	byte order.
+ *
+ *	compiled_file_open () maps file_name into memory, or reads it if it
+ *	cannot be mapped, and checks its header against magic, version and
+ *	the byte order of this host.  cf->base holds the file, cf->size its
+ *	length and cf->mtime its modification time.  Returns 0 if the file
+ *	is open, -1 if it does not exist or is shorter than header_size, -2
+ *	if it cannot be read (errno is set), and -3 if it is not a compiled
+ *	file of this format and host.  cf is only open if 0 is returned.
+ *
+ *	compiled_file_close () unmaps or frees the contents of cf.
+ *
+ *	compiled_file_write_floats () writes n floats to fp.  Returns 0, or
+ *	-1 if they cannot be written.
+ *
+ *	compiled_file_rows () allocates the row pointers of a nrows by
+ *	ncols table held in x.  Returns NULL if they cannot be allocated.
+ *
+ *	compiled_file_add_floats () adds the nrows*ncols floats of an array
+ *	to nfloats.  Returns 1, or 0 if the sum would be more than
+ *	max_floats, so that the arrays of a header can be checked against
+ *	the size of the file without overflow.
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef _POSIX_MAPPED_FILES
+#include <sys/mman.h>
+#endif
+#include "libstring.h"
+
+#define COMPILED_FILE_BYTE_ORDER	0x01020304
+
+void
+compiled_file_header(CompiledFileHeader *h, const char *magic, int version)
+{
+	memset((void *)h, 0, sizeof(CompiledFileHeader));
+	strncpy(h->magic, magic, sizeof(h->magic));
+	h->version = version;
+	h->byte_order = COMPILED_FILE_BYTE_ORDER;
+}
+
+int
+compiled_file_open(const char *file_name, const char *magic, int version,
+		size_t header_size, CompiledFile *cf)
+{
+	int	fd, err;
+	struct stat	buf;
+	CompiledFileHeader	h;
+
+	memset((void *)cf, 0, sizeof(CompiledFile));
+
+	if((fd = open(file_name, O_RDONLY)) < 0) return -1;
+
+	if(fstat(fd, &buf) != 0 || buf.st_size < (off_t)header_size
+		|| header_size < sizeof(CompiledFileHeader))
+	{
+	    close(fd);
+	    return -1;
+	}
+	cf->size = (size_t)buf.st_size;
+	cf->mtime = buf.st_mtime;
+
+#ifdef _POSIX_MAPPED_FILES
+	cf->base = (char *)mmap(NULL, cf->size, PROT_READ, MAP_SHARED, fd, 0);
+	if(cf->base == (char *)MAP_FAILED) {
+	    cf->base = NULL;
+	}
+	else {
+	    cf->mapped = 1;
+	}
+#endif
+	if(cf->base == NULL)
+	{
+	    /* Read it instead */
+	    if((cf->base = (char *)malloc(cf->size)) != NULL &&
+		read(fd, cf->base, cf->size) != (ssize_t)cf->size)
+	    {
+		err = errno;
+		free(cf->base);
+		cf->base = NULL;
+		errno = err;
+	    }
+	}
+	err = errno;
+	close(fd);
+
+	if(cf->base == NULL) {
+	    errno = err;
+	    return -2;
+	}
+
+	memcpy((void *)&h, cf->base, sizeof(CompiledFileHeader));
+	if(strncmp(h.magic, magic, sizeof(h.magic)) || h.version != version
+		|| h.byte_order != COMPILED_FILE_BYTE_ORDER)
+	{
+	    compiled_file_close(cf);
+	    return -3;
+	}
+	return 0;
+}
+
+void
+compiled_file_close(CompiledFile *cf)
+{
+	if(cf->base == NULL) return;
+#ifdef _POSIX_MAPPED_FILES
+	if(cf->mapped) {
+	    munmap((void *)cf->base, cf->size);
+	}
+	else
+#endif
+	free(cf->base);
+	cf->base = NULL;
+	cf->size = 0;
+	cf->mapped = 0;
+}
+
+int
+compiled_file_write_floats(FILE *fp, float *x, int n)
+{
+	if(n <= 0) return 0;
+	return (fwrite(x, sizeof(float), n, fp) == (size_t)n) ? 0 : -1;
+}
+
+float **
+compiled_file_rows(float *x, int nrows, int ncols)
+{
+	float	**rows;
+	int	i;
+
+	rows = (float **)malloc((nrows > 0 ? nrows : 1)*sizeof(float *));
+	if(rows == NULL) return NULL;
+
+	for(i = 0; i < nrows; i++) rows[i] = x + (size_t)i*ncols;
+	return rows;
+}
+
+int
+compiled_file_add_floats(size_t *nfloats, size_t max_floats, int nrows,
+		int ncols)
+{
+	size_t	n;
+
+	if(nrows < 0 || ncols < 0) return 0;
+	if(ncols > 0 && (size_t)nrows > max_floats/(size_t)ncols) return 0;
+	n = (size_t)nrows*(size_t)ncols;
+	if(n > max_floats - *nfloats) return 0;
+	*nfloats += n;
+	return 1;
+}
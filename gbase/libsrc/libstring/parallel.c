@@ -0,0 +1,177 @@
+/*
+ * NAME
+ *	parallel_threads
+ *	parallel_run
+ *	parallel_run_thread
+ *
+ * FILE
+ *	parallel.c
+ *
+ * SYNOPSIS
+ *
+ *	int
+ *	parallel_threads (n, num_threads)
+ *	int	n;		(i) Number of calls
+ *	int	num_threads;	(i) Requested threads, or <= 0 for one per
+ *				    online processor
+ *
+ *	void
+ *	parallel_run (n, num_threads, fn, arg)
+ *	int	n;		(i) Number of calls
+ *	int	num_threads;	(i) Requested threads, or <= 0 for one per
+ *				    online processor
+ *	void	(*fn)();	(i) Function called as fn(i, arg) for each i
+ *	void	*arg;		(i) Argument passed to fn
+ *
+ *	void
+ *	parallel_run_thread (n, num_threads, fn, arg)
+ *	int	n;		(i) Number of calls
+ *	int	num_threads;	(i) Requested threads, or <= 0 for one per
+ *				    online processor
+ *	void	(*fn)();	(i) Function called as fn(i, thread, arg) for
+ *				    each i
+ *	void	*arg;		(i) Argument passed to fn
+ *
+ * DESCRIPTION
+ *
+ *	parallel_threads () returns the number of threads parallel_run ()
+ *	uses for n calls: num_threads, or the number of online processors
+ *	if num_threads <= 0, but no more than n or MAX_PARALLEL_THREADS,
+ *	and at least 1.
+ *
+ *	parallel_run () calls fn(i, arg) for i = 0 to n-1.  Where pthreads
+ *	are available, the calls are shared among parallel_threads (n,
+ *	num_threads) threads, each taking the next i as it finishes the
+ *	last, so that calls of different lengths balance out.  The calling
+ *	thread is one of the workers.  fn must only change the data for its
+ *	own i.  Returns when all calls are done.  Without pthreads, or with
+ *	one thread, the calls are made in order by the calling thread.
+ *
+ *	parallel_run_thread () is parallel_run () with the index of the
+ *	calling thread, 0 to parallel_threads (n, num_threads)-1, passed to
+ *	fn, so that fn can select a work buffer of its thread.  fn must only
+ *	change the data for its own i and thread.  Without pthreads, or with
+ *	one thread, thread is 0.
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include "libstring.h"
+
+#ifdef HAVE_PTHREAD
+typedef struct
+{
+	pthread_mutex_t	lock;
+	int	next;
+	int	n;
+	int	thread;
+	void	(*fn)(int i, void *arg);
+	void	(*thread_fn)(int i, int thread, void *arg);
+	void	*arg;
+} ParallelWork;
+
+static void *
+parallel_worker(void *p)
+{
+	ParallelWork	*w = (ParallelWork *)p;
+	int	i, thread;
+
+	pthread_mutex_lock(&w->lock);
+	thread = w->thread++;
+	pthread_mutex_unlock(&w->lock);
+
+	for(;;)
+	{
+	    pthread_mutex_lock(&w->lock);
+	    i = w->next++;
+	    pthread_mutex_unlock(&w->lock);
+
+	    if(i >= w->n) break;
+
+	    if(w->thread_fn) (*w->thread_fn)(i, thread, w->arg);
+	    else (*w->fn)(i, w->arg);
+	}
+	return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+int
+parallel_threads(int n, int num_threads)
+{
+	long	ncpu;
+
+	if(num_threads <= 0)
+	{
+	    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	    num_threads = (ncpu > 1) ? (int)ncpu : 1;
+	}
+	if(num_threads > n) num_threads = n;
+	if(num_threads > MAX_PARALLEL_THREADS)
+	{
+	    num_threads = MAX_PARALLEL_THREADS;
+	}
+	return (num_threads > 1) ? num_threads : 1;
+}
+
+static void
+parallel_start(int n, int num_threads, void (*fn)(int i, void *arg),
+		void (*thread_fn)(int i, int thread, void *arg), void *arg)
+{
+	int	i;
+#ifdef HAVE_PTHREAD
+	pthread_t	tid[MAX_PARALLEL_THREADS];
+	ParallelWork	w;
+	int	nthreads, started;
+
+	nthreads = parallel_threads(n, num_threads);
+
+	if(nthreads > 1)
+	{
+	    pthread_mutex_init(&w.lock, NULL);
+	    w.next = 0;
+	    w.n = n;
+	    w.thread = 0;
+	    w.fn = fn;
+	    w.thread_fn = thread_fn;
+	    w.arg = arg;
+
+	    /* The calling thread is one of the workers */
+	    for(started = 1; started < nthreads; started++)
+	    {
+		if(pthread_create(&tid[started], NULL, parallel_worker, &w))
+		{
+		    break;
+		}
+	    }
+	    parallel_worker(&w);
+
+	    for(i = 1; i < started; i++) pthread_join(tid[i], NULL);
+
+	    pthread_mutex_destroy(&w.lock);
+	    return;
+	}
+#endif /* HAVE_PTHREAD */
+
+	for(i = 0; i < n; i++)
+	{
+	    if(thread_fn) (*thread_fn)(i, 0, arg);
+	    else (*fn)(i, arg);
+	}
+}
+
+void
+parallel_run(int n, int num_threads, void (*fn)(int i, void *arg), void *arg)
+{
+	parallel_start(n, num_threads, fn, NULL, arg);
+}
+
+void
+parallel_run_thread(int n, int num_threads,
+		void (*fn)(int i, int thread, void *arg), void *arg)
+{
+	parallel_start(n, num_threads, NULL, fn, arg);
+}
@@ -10,6 +10,22 @@
  *  C++ classes for core interface elements.
  */
 
+/** The program properties used by Amp::measure_SP_pp_amplitude.
+ *  @ingroup libgx
+ */
+typedef struct
+{
+    string	filt_type;	//!< filter type
+    int		zero_phase;	//!< zero phase filter
+    double	locut;		//!< filter low cut frequency
+    double	hicut;		//!< filter high cut frequency
+    int		filt_order;	//!< filter order
+    double	amp_threshold1;	//!< percent of max peak to trough to omit
+    double	filter_margin;	//!< filter transient time before and after
+    double	lead;		//!< part of the window before the pick
+    double	length;		//!< the length of the measurement window
+} AmpMeasureParams;
+
 /** A class with functions for automated amplitude and period measurement.
  *  @ingroup libgx
  */
@@ -19,10 +35,20 @@ class Amp
 	static bool autoMeasureAmpPer(GTimeSeries *ts,
 		const string &amptype, double time, bool mb_allow_counts,
 		const string &mb_counts_amptype, CssAmplitudeClass *amp);
+	static bool countsToNms(GTimeSeries *ts, GSegment *s,
+		double max_amplitude, double period,
+		double time_of_max_amplitude, bool mb_allow_counts,
+		const string &mb_counts_amptype, CssAmplitudeClass *amp);
 	static int measure_SP_pp_amplitude(float *beam, double samprate,
 		int nsamples, double waveform_start_time,
 		double time_of_the_pick, double *max_amplitude, double *period,
 		double *time_of_max_amplitude, double *bandw);
+	static int measure_SP_pp_amplitude(float *beam, double samprate,
+		int nsamples, double waveform_start_time,
+		double time_of_the_pick, AmpMeasureParams *p,
+		double *max_amplitude, double *period,
+		double *time_of_max_amplitude, double *bandw);
+	static void getMeasureParams(AmpMeasureParams *p);
 	static int automb_new2(float *beam, int *istart_inp,
 		int *nsamples_in_window_inp, int *nsamples_inp,
 		int filter_order, int zero_phase, double hicut,
@@ -0,0 +1,142 @@
+#ifndef _AMP_BATCH_H
+#define _AMP_BATCH_H
+
+#include <vector>
+
+#include "Amp.h"
+
+/** The parameters of the mb and ml measurements of one arrival. They are
+ *  copied from the AmplitudeParams and the program properties in the calling
+ *  thread, so that the measurement threads do not read them.
+ *  @ingroup libgx
+ */
+typedef struct
+{
+    AmpMeasureParams mp;	//!< the measure_SP_pp_amplitude parameters
+    string	mb_amptype;	//!< the amptype of the mb amplitude
+    double	mb_filter_margin; //!< filter transient time before and after
+    double	mb_lead;	//!< the part of the mb window before the pick
+    double	mb_length;	//!< the length of the mb window
+    double	mb_taper_frac;	//!< the mb taper fraction
+    string	mb_filter_type;	//!< the mb filter type
+    int		mb_filter_order; //!< the mb filter order
+    double	mb_filter_locut; //!< the mb filter low cut frequency
+    double	mb_filter_hicut; //!< the mb filter high cut frequency
+    bool	mb_filter_zp;	//!< the mb filter is zero phase
+    bool	mb_allow_counts; //!< save mb in counts without a response
+    string	mb_counts_amptype; //!< the amptype of an mb in counts
+    string	ml_amptype;	//!< the amptype of the ml amplitude
+    double	ml_sta_lead;	//!< the ml short term window lead
+    double	ml_sta_window;	//!< the ml short term search window
+    double	ml_sta_length;	//!< the ml short term window length
+    double	ml_lta_lead;	//!< the ml long term window lead
+    double	ml_lta_length;	//!< the ml long term window length
+    string	ml_filter_type;	//!< the ml filter type
+    int		ml_filter_order; //!< the ml filter order
+    double	ml_filter_locut; //!< the ml filter low cut frequency
+    double	ml_filter_hicut; //!< the ml filter high cut frequency
+    bool	ml_filter_zp;	//!< the ml filter is zero phase
+    double	stav_len;	//!< the mb snr short term window length
+    double	ltav_len;	//!< the mb snr long term window length
+} AmpBatchParams;
+
+/** An arrival of an AmpBatch and its amplitudes.
+ *  @ingroup libgx
+ */
+typedef struct
+{
+    CssArrivalClass	*arrival;	//!< the arrival
+    bool		mb;		//!< an mb amplitude was requested
+    bool		ml;		//!< an ml amplitude was requested
+    CssAmplitudeClass	*mb_amp;	//!< the mb amplitude or NULL
+    CssAmplitudeClass	*ml_amp;	//!< the ml amplitude or NULL
+} AmpBatchResult;
+
+/** A waveform span of an AmpBatch. The span covers the amplitude windows of
+ *  all of the arrivals that are measured on the waveform. It is read once,
+ *  and each amplitude window is cut from it and filtered on its own.
+ *  @ingroup libgx
+ */
+typedef struct
+{
+    GTimeSeries	*ts;		//!< the input waveform
+    double	tbeg;		//!< the start of the span
+    double	tend;		//!< the end of the span
+    GTimeSeries	*raw_ts;	//!< the unprocessed data of the span, or NULL
+} AmpBatchChannel;
+
+/** The measurements of one arrival of an AmpBatch. The windows are cut and
+ *  filtered before the threads start, so each thread only works on the
+ *  windows of its own task.
+ *  @ingroup libgx
+ */
+typedef struct
+{
+    CssArrivalClass *arrival;	//!< the arrival
+    int		chan;		//!< the index of the AmpBatchChannel
+    int		params;		//!< the index of the parameters
+    bool	mb;		//!< measure mb
+    bool	ml;		//!< measure ml
+    GTimeSeries	*mb_ts;		//!< the filtered mb window, or NULL
+    GSegment	*mb_seg;	//!< the segment of mb_ts that is measured
+    int		mb_ret;		//!< the measure_SP_pp_amplitude return
+    double	max_amplitude;	//!< the mb half peak to peak in counts
+    double	period;		//!< the mb period
+    double	time_of_max;	//!< the time of the mb amplitude
+    double	bandw;		//!< the mb filter bandwidth
+    double	mb_snr;		//!< the mb signal to noise ratio
+    GTimeSeries	*ml_ts;		//!< the filtered ml window, or NULL
+    GSegment	*ml_seg;	//!< the segment of ml_ts that is measured
+    double	ml_amp;		//!< the ml amplitude
+    double	ml_snr;		//!< the ml signal to noise ratio
+} AmpBatchTask;
+
+/** Batch measurement of mb and ml amplitudes. The arrivals are added with
+ *  the GTimeSeries to measure them on and their parameters. measure() reads
+ *  the raw data of each GTimeSeries once for the span of all of its windows.
+ *  Each window is tapered and filtered on its own, with the same margins as
+ *  WaveformPlot::measureAmplitudes, so the amplitudes are the same. The
+ *  measurements are made on a thread pool. The class does not use the
+ *  widgets or the program properties, so it can be used by any program that
+ *  has GTimeSeries objects and arrivals.
+ *  @ingroup libgx
+ */
+class AmpBatch
+{
+    public:
+	AmpBatch(void);
+	~AmpBatch(void);
+
+	void add(GTimeSeries *ts, CssArrivalClass *arrival, bool mb, bool ml,
+		const AmpBatchParams &params);
+	int measure(int num_threads, vector<AmpBatchResult> &results);
+
+	/** Get the number of arrivals added.
+	 *  @returns the number of arrivals.
+	 */
+	int size(void) { return (int)tasks.size(); }
+
+	static void mlppn(float *databuf, int dim, int atPoint, double sps,
+		const AmpBatchParams *p, double *amp, double *snr);
+
+    protected:
+	vector<AmpBatchParams> params;
+	vector<AmpBatchChannel> chans;
+	vector<AmpBatchTask> tasks;
+
+	int addParams(const AmpBatchParams &p);
+	void readChannel(AmpBatchChannel *c);
+	void filterWindows(AmpBatchTask *t);
+	GTimeSeries *filterWindow(AmpBatchChannel *c, double tbeg, double tend,
+		int taper_percent, int order, const string &type, double locut,
+		double hicut, bool zp);
+	CssAmplitudeClass *mbAmplitude(AmpBatchTask *t);
+	CssAmplitudeClass *mlAmplitude(AmpBatchTask *t);
+	static void measureTask(int k, int thread, void *arg);
+
+    private:
+	AmpBatch(const AmpBatch &a);
+	AmpBatch & operator=(const AmpBatch &a);
+};
+
+#endif
@@ -55,6 +55,8 @@ class CSSTable : public Table, public DataReceiver, public Parser
         void list(void);
 	void list(int record_no);
 	void listKeepOrder(void);
+	bool cellText(int row, int col, char *buf, int buf_len);
+	int cellSortKey(int row, int col, double *value, const char **s);
 
 	gvector<CssTableClass *> * getRecords(void) { return &records; }
 	int getRecords(gvector<CssTableClass *> &v) {
@@ -92,11 +94,14 @@ class CSSTable : public Table, public DataReceiver, public Parser
 	gvector<CssTableClass *> backup_order;
 	gvector<CssTableClass *> backup_copy;
 	gvector<CssTableClass *> copy_rows;
+	vector<int> member_index; // record member of each column, or -1
 
 	void modifyVerify(Widget w, XtPointer calldata);
 	bool undoTableChange(UndoTableChange *undo);
 
 	virtual bool getExtra(int i, CssTableClass *, TAttribute *, string &);
+	void formatCell(int k, CssTableClass *o, TAttribute *a, int j,
+			char *value, int maxlen);
 
     private:
 	static Boolean convertSelection(Widget w, Atom *selection, Atom *target,
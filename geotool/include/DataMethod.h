@@ -164,6 +164,7 @@ class DataMethod : public Gobject
 
 	static bool doMethods(gvector<DataMethod *> *methods, int num,
 			GTimeSeries **ts);
+	const char *profileStage(void);
 
 	string method_name;
 	string string_rep; //!< The string representation of the method.
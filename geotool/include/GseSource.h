@@ -11,6 +11,7 @@ extern "C" {
 }
 
 class GseData;
+struct GseFile;
 
 /*
  *  @ingroup libgio
@@ -26,12 +27,15 @@ class GseSource : public TableSource
 	bool makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
 		int pts, GTimeSeries **ts, const char **err_msg);
 	bool reread(GTimeSeries *ts);
-	GSegment * readSegment(const string &full_path, int offset,
-		double start_time, double end_time, int pts_wanted);
+	GSegment * readSegment(GseData *gd, double start_time,
+		double end_time, int pts_wanted);
 
     protected:
 	string read_path;
 	vector<GseData *> gse_data;
+	GseFile *gse_file;
+
+	int *readWaveform(GseData *gd, int *nsamp, int *err);
 
     private:
 
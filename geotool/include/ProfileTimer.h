@@ -0,0 +1,40 @@
+#ifndef _PROFILE_TIMER_H_
+#define _PROFILE_TIMER_H_
+
+extern "C" {
+#include "libgmath.h"
+}
+
+/** A scoped timer for the profile of libgmath profile.c. The time from the
+ *  constructor to the destructor is recorded as one call of the stage, when
+ *  the profile is running. The stage name must be a static string or a name
+ *  from profile_name(). Nothing is recorded for a NULL stage.
+ *  <pre>
+ *	void FT::compute(bool warning)
+ *	{
+ *	    ProfileTimer pt("FT::compute");
+ *	    ...
+ *	}
+ *  </pre>
+ *  The profile is started, stopped and reported with the script command
+ *  "profile".
+ */
+class ProfileTimer
+{
+    public:
+	ProfileTimer(const char *stage_name) : stage(stage_name),
+		t0(PROFILE_RUNNING() ? profile_clock() : -1) { }
+	~ProfileTimer(void) {
+	    if(t0 >= 0) profile_record(stage, t0, profile_clock());
+	}
+
+    protected:
+	const char *stage;
+	long long t0;
+
+    private:
+	ProfileTimer(const ProfileTimer &p);
+	ProfileTimer & operator=(const ProfileTimer &p);
+};
+
+#endif
@@ -25,6 +25,9 @@ class SacSource : public TableSource
 		int pts, GTimeSeries **ts, const char **err_msg);
 	bool reread(GTimeSeries *ts);
 
+	static void indexFiles(const vector<string> &files, int num_threads=0);
+	static void clearIndex(void);
+
     protected:
 	string read_path;
 	bool css_arrival;
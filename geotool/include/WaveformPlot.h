@@ -13,6 +13,7 @@
 #include "IIRFilter.h"
 #include "ArrivalParams.h"
 #include "AmplitudeParams.h"
+#include "AmpBatch.h"
 #include "gobject++/CssTables.h"
 
 extern "C" {
@@ -422,6 +423,13 @@ class WaveformPlot : public TtPlotClass, public DataReceiver, public PrintClient
 	bool saveAmp(DataSource *ds, CssArrivalClass *arrival, CssAmplitudeClass *amp);
 	bool measureAmps(CssArrivalClass *arrival, Waveform *w,
 		AmpMeasureMode mode=AUTO_MEASURE);
+	int measureAmpsBatch(cvector<CssArrivalClass> &arrivals,
+		AmpMeasureMode mode=AUTO_MEASURE, int num_threads=0);
+	void getAmpBatchParams(AmpBatchParams *p);
+	void ampMeasureTypes(CssArrivalClass *arrival,
+		cvector<CssAssocClass> &assocs, cvector<CssOriginClass> &origins,
+		AmpMeasureMode mode, CssAssocClass **assoc,
+		CssOriginClass **origin, bool *measure_mb, bool *measure_ml);
 	void measureArrayAmp(gvector<Waveform *> &wvec, CssArrivalClass *arrival,
 		CssOriginClass *origin, const string &phase,
 		bool measure_mb, CssAmplitudeClass *amp);
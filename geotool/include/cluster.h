@@ -49,6 +49,8 @@ double CALL clusterdistance (int nrows, int ncolumns, double** data, int** mask,
   char method, int transpose);
 double** CALL distancematrix (int ngenes, int ndata, double** data,
   int** mask, double* weight, char dist, int transpose);
+double** CALL trianglematrix (int n);
+void CALL freetrianglematrix (double** matrix);
 
 /* Chapter 3 */
 int getclustercentroids(int nclusters, int nrows, int ncolumns,
@@ -25,6 +25,7 @@ int cssioDecompG2(int npts, unsigned char *data_in, void *data_out, int outtype)
 int cssioDecompV4(int npts, float *data_in, float *data_out);
 int cssioDecompC24(int start, int npts, char *data_in, void *data_out, const char *datatype, int outtype);
 int cssioDecompCa(unsigned char *data_in, int data_in_len, void *data_out, int npts, int outtype);
+int cssioDecompCaWindow(int start, int npts, int nsamp, unsigned char *data_in, int data_in_len, void *data_out, int outtype);
 
 
 /* ****** cssio/dcpress.c ********/
@@ -41,10 +42,11 @@ ssize_t
 #ifdef HAVE_LIBZ
 cssioReadDotw(const char *path, gzFile zfd, int fd, off_t foff, ssize_t start,
 	      ssize_t npts, void *data, const char *datatype, int outtype,
-	      ssize_t rd_len);
+	      ssize_t rd_len, ssize_t nsamp);
 #else /* HAVE_LIBZ */
 cssioReadDotw(const char *path, int fd, off_t foff, ssize_t start, ssize_t npts,
-	      void *data, const char *datatype, int outtype, ssize_t rd_len);
+	      void *data, const char *datatype, int outtype, ssize_t rd_len,
+	      ssize_t nsamp);
 #endif /* HAVE_LIBZ */
 ssize_t
 #ifdef HAVE_LIBZ
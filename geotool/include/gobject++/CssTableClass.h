@@ -338,6 +338,10 @@ class CssTableClass : public Gobject
 	}
 	static int sort(gvector<CssTableClass *> &tables, const string &member_name);
 	static int sort(int num, CssTableClass **tables, const string &member_name);
+	static int sort(gvector<CssTableClass *> &tables,
+		vector<string> &member_names);
+	static int sort(int num, CssTableClass **tables,
+		vector<string> &member_names, int *order);
 	static CssTableClass *find(gvector<CssTableClass *> &tables,
 		const string &member_name, long value);
 	static int archive(CssTableClass ***t);
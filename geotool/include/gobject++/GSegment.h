@@ -5,8 +5,29 @@
 
 class GTimeSeries;
 
+/** A reference counted array of data samples. A GSampleBuffer is shared by
+ *  all GSegment copies of the same data. It is held with Gobject::retain()
+ *  and Gobject::release(), and freed when the last GSegment releases it.
+ *  @ingroup libgobject
+ */
+class GSampleBuffer : public Gobject
+{
+    public:
+	GSampleBuffer(int buffer_length) throw(int);
+	~GSampleBuffer(void);
+
+	float	*samples;	//!< the sample array
+	int	length;		//!< the allocated length of samples[]
+
+    private:
+	GSampleBuffer(const GSampleBuffer &b);
+	GSampleBuffer & operator=(const GSampleBuffer &b);
+};
+
 /** A class that holds a segment of waveform data. The segment has a uniform
- *  sample time interval with no data gaps.
+ *  sample time interval with no data gaps. Copies of a GSegment share the
+ *  same sample buffer until one of them calls unshare(), which must be done
+ *  before writing to the data[] array.
  *  @ingroup libgobject
  */
 class GSegment : public Gobject
@@ -29,6 +50,11 @@ class GSegment : public Gobject
 	Gobject *clone(void);
 
 	void setData(float *seg_data);
+	void unshare(void) throw(int);
+	/** Check if the data samples are shared with another GSegment.
+	 *  @returns true if another GSegment holds the same sample buffer.
+	 */
+	bool sharedData(void) { return (buffer->refCount() > 1); }
 
 	void setCalibration(double calibration, double calperiod);
 	/** Get the beginning time of this GSegment.
@@ -84,9 +110,12 @@ class GSegment : public Gobject
 	double	initial_calper;	//!< the initial calibration period
 	double	Calib;		//!< the calibration factor
 	double	Calper;		//!< the calibration period
+	GSampleBuffer *buffer;	//!< the buffer that holds data[]
 
 	void init(int seg_data_length, double tbeg, double tdel,
 		double calibration, double calperiod) throw(int);
+	void shareData(GSegment *s, int offset);
+	void newBuffer(int len, bool copy_data) throw(int);
 	void setTdel(double tdel);
 	void truncate(int i1, int i2) throw(int);
 	/** Set the length of the segment.
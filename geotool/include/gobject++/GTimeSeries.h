@@ -86,6 +86,7 @@ class GTimeSeries : public Gobject
 	GTimeSeries *subseries(double t1, double t2);
 	bool truncate(double t1, double t2);
 	void makeCopy(void);
+	void unshare(void);
 
 	/** Get the time of the first data sample.
 	 *  @returns the epochal time of the first data sample or returns 0., if
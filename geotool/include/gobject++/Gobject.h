@@ -3,6 +3,7 @@
 
 #include <sstream>
 #include <vector>
+#include <set>
 #include <stdlib.h>
 #include <string.h>
 
@@ -30,24 +31,31 @@ int sortGVectorElements(const void *a, const void *b);
 class Gobject;
 class GDouble;
 
-/** Base class.
+/** Base class. Gobjects are shared between owners. An object is kept alive
+ *  while it has at least one owner registered with addOwner() or one
+ *  anonymous reference taken with retain(). The number of owners and
+ *  references is held in an atomic counter, so hasOwners(), retain() and
+ *  release() are safe to call from worker threads. Named owners are held in
+ *  a set that is only allocated when an object has more than one owner.
+ *  Compile with -DGOBJECT_DEBUG_OWNERS to keep a list of every owner for
+ *  debugging.
  *  @ingroup libgobject
  */
 class Gobject : public CommandParser
 {
     public:
-	Gobject(void) : owners() {}	// constructor
+	Gobject(void) : ref_count(0), owner_lock(0), owner(NULL),
+		owner_set(NULL) {}	// constructor
 	virtual ~Gobject(void);	// destructor
 	/** Clone or copy a Gobject.
 	 *  @returns a copy of this Gobject.
 	 */
         Gobject & operator=(const Gobject &o) {
 	    // do not copy owners
-	    if(this == &o) return *this;
-	    owners.clear();
 	    return *this;
 	}
-	Gobject(const Gobject &o) {
+	Gobject(const Gobject &o) : ref_count(0), owner_lock(0), owner(NULL),
+		owner_set(NULL) {
 	    // do not copy owners
 	}
 	virtual Gobject *clone(void) { return new Gobject(); }
@@ -55,11 +63,30 @@ class Gobject : public CommandParser
 	bool hasOwners(void);
 	void addOwner(Gobject *owner);
 	bool removeOwner(Gobject *owner, bool do_delete=true);
+	void retain(void);
+	bool release(bool do_delete=true);
+	/** Get the number of owners and references.
+	 *  @returns the number of registered owners plus retain() references.
+	 */
+	int refCount(void) { return __sync_add_and_fetch(&ref_count, 0); }
 	char *errorMsg(void);
 
     private:
 	void debug(void);
+	void lockOwners(void) {
+	    while(__sync_lock_test_and_set(&owner_lock, 1)) {
+		while(owner_lock) ;
+	    }
+	}
+	void unlockOwners(void) { __sync_lock_release(&owner_lock); }
+
+	volatile int ref_count;	//!< owners plus anonymous references
+	volatile int owner_lock; //!< spin lock for owner and owner_set
+	Gobject *owner;		//!< the first owner
+	set<Gobject *> *owner_set; //!< additional owners
+#ifdef GOBJECT_DEBUG_OWNERS
 	vector<Gobject *> owners; // list of owner Gobjects
+#endif
 };
 
 /** A class to hold a void pointer.
@@ -152,7 +152,7 @@ class ghashtable<Gobject *> : public Gobject
 	~ghashtable(void) {
 	    for(int i = 0; i < (int)elements.size(); i++) {
 		delete elements[i]->first;
-		elements[i]->second->removeOwner(this);
+		elements[i]->second->release();
 		delete elements[i];
 	    }
 	}
@@ -160,8 +160,8 @@ class ghashtable<Gobject *> : public Gobject
 	    for(int i = 0; i < (int)elements.size(); i++) {
 		if( !elements[i]->first->compare(key) ) {
 		    if(value != elements[i]->second) {
-			value->addOwner(this);
-			elements[i]->second->removeOwner(this);
+			value->retain();
+			elements[i]->second->release();
 			elements[i]->second = value;
 		    }
 		    return;
@@ -169,7 +169,7 @@ class ghashtable<Gobject *> : public Gobject
 	    }
 	    elements.push_back(
 		new pair<string *, Gobject *>(new string(key), value));
-	    value->addOwner(this);
+	    value->retain();
 	}
 	bool get(const string &key, Gobject* *value) {
 	    for(int i = 0; i < (int)elements.size(); i++) {
@@ -184,7 +184,7 @@ class ghashtable<Gobject *> : public Gobject
 	    for(int i = 0; i < (int)elements.size(); i++) {
 		if( !elements[i]->first->compare(key) ) {
 		    delete elements[i]->first; //  the key string
-		    elements[i]->second->removeOwner(this);
+		    elements[i]->second->release();
 		    delete elements[i];
 		    elements.erase(elements.begin() + i);
 		}
@@ -193,7 +193,7 @@ class ghashtable<Gobject *> : public Gobject
 	void copy(const ghashtable &h) {
 	    for(int i = 0; i < (int)h.elements.size(); i++) {
 		Gobject *g = h.elements[i]->second->clone();
-		g->addOwner(this);
+		g->retain();
 		elements.push_back(new pair<string *,Gobject *>(
 		new string(h.elements[i]->first->c_str()), g));
 	    }
@@ -78,7 +78,8 @@ template <class Type> class gvector : public Gobject
 	    element_data = (Type *)realloc(element_data, capacity*sizeof(Type));
 	}
 	element_data[element_count++] = element;
-	if(own_elements) element->addOwner(this);
+	if(own_elements) element->retain();
+	changed();
     }
 
     bool remove(Type element)
@@ -94,15 +95,9 @@ template <class Type> class gvector : public Gobject
 		    element_data[j] = element_data[j+1];
 		}
 		element_count--;
-		if(own_elements) {
-		    /* if this is the only occurrence of this object, remove
-		     * ownership of it.
-		     */
-		    for(j = i; j < element_count; j++) {
-			if(element_data[j] == element) break;
-		    }
-		    if(j == element_count) element->removeOwner(this);
-		}
+		// each occurrence holds one reference
+		if(own_elements) element->release();
+		changed();
 		return true;
 	    }
 	}
@@ -128,7 +123,8 @@ template <class Type> class gvector : public Gobject
 	}
 	element_data[position] = element;
 	element_count++;
-	if(own_elements) element->addOwner(this);
+	if(own_elements) element->retain();
+	changed();
     }
 
     bool removeAt(int position)
@@ -143,33 +139,23 @@ template <class Type> class gvector : public Gobject
 		element_data[i] = element_data[i+1];
 	    }
 	    element_count--;
-	    if(own_elements) {
-		// if this is the only occurrence of this object, unregister it.
-		for(i = position; i < element_count; i++) {
-		    if(element_data[i] == element) break;
-		}
-		if(i == element_count) element->removeOwner(this);
-	    }
+	    if(own_elements) element->release();
+	    changed();
 	    return true;
 	}
     }
 
     void removeAll(void)
     {
-	if(own_elements && element_count > 0)
-	{
-	    qsort(element_data,element_count,sizeof(Type),sortGVectorElements);
-	    element_data[0]->removeOwner(this);
-	    for(int i = 1; i < element_count; i++) {
-		// unregister duplicates only once.
-		if(element_data[i] != element_data[i-1]) {
-		    element_data[i]->removeOwner(this);
-		}
+	if(own_elements) {
+	    for(int i = 0; i < element_count; i++) {
+		element_data[i]->release();
 	    }
 	}
 	element_count = 0;
 	capacity = capacity_increment;
 	element_data = (Type *)realloc(element_data, capacity*sizeof(Type));
+	changed();
     }
 
     void set(Type element, int position)
@@ -180,14 +166,10 @@ template <class Type> class gvector : public Gobject
 	    Type o = element_data[position];
 	    element_data[position] = element;
 	    if(own_elements) {
-		int i;
-		for(i = 0; i < element_count; i++) if(i != position) {
-		    if(element_data[position] == element_data[i]) break;
-		}
-		// if this is the only occurrence, unregister it.
-		if(i == element_count) o->removeOwner(this);
-		element->addOwner(this);
+		element->retain();
+		o->release();
 	    }
+	    changed();
 	}
     }
     void exchange(int i, int j)
@@ -197,6 +179,7 @@ template <class Type> class gvector : public Gobject
 	Type o = element_data[i];
 	element_data[i] = element_data[j];
 	element_data[j] = o;
+	changed();
     }
 
     /** Move the indicated element to the first position.
@@ -216,6 +199,7 @@ template <class Type> class gvector : public Gobject
 	    element_data[j] = element_data[j-1];
 	}
 	element_data[0] = o;
+	changed();
     }
 
     void load(gvector<Type> *v) {
@@ -293,6 +277,7 @@ template <class Type> class gvector : public Gobject
      */
     void sort(qsort_compar_ptr_t compar) {
 	qsort(element_data, element_count, sizeof(Type), compar);
+	changed();
     }
     void sort(qsort_compar_ptr_t compar, int start, int num) {
 	if(start < 0 || start >= element_count) {
@@ -303,9 +288,31 @@ template <class Type> class gvector : public Gobject
 	}
 	else {
 	    qsort(element_data+start, num, sizeof(Type), compar);
+	    changed();
 	}
     }
 
+    /** Put the elements in a new order. The new element i is the old
+     *  element order[i].
+     *  @param[in] order a permutation of 0 to size()-1.
+     */
+    void reorder(const int *order) {
+	Type *o;
+	if(element_count <= 1) return;
+	if(!(o = (Type *)malloc(element_count*sizeof(Type)))) return;
+	memcpy(o, element_data, element_count*sizeof(Type));
+	for(int i = 0; i < element_count; i++) element_data[i] = o[order[i]];
+	free(o);
+	changed();
+    }
+
+    /** Get the change stamp. It is a new number each time that elements
+     *  are added, removed or moved, and no two gvectors of the same Type
+     *  have the same stamp.
+     *  @returns the change stamp.
+     */
+    long stamp(void) const { return change_stamp; }
+
     Type operator[](int i) { return at(i); }
 
     virtual bool nameIs(const string &s) {
@@ -319,6 +326,14 @@ template <class Type> class gvector : public Gobject
     int	element_count;  //!< The number of Gobjects in element_data.
     int	capacity;      //!< The current space allocated to element_data.
     bool own_elements;  //!< if true, the gvector owns the elements
+    long change_stamp;  //!< set from stamp_count by each change.
+    static long stamp_count; //!< the last change stamp of any gvector<Type>
+
+    //! Take a new stamp. gvectors can be changed in different threads, so
+    //! stamp_count is incremented atomically.
+    void changed(void) {
+	change_stamp = __sync_add_and_fetch(&stamp_count, 1L);
+    }
 
     private:
     void init(int initial_capacity, int capacity_incre, bool element_owner)
@@ -330,6 +345,7 @@ template <class Type> class gvector : public Gobject
 	capacity_increment = capacity_incre;
 	element_count = 0;
 	own_elements = element_owner;
+	changed();
     }
     bool goodIndex(int position, const string &func)
     {
@@ -346,6 +362,8 @@ template <class Type> class gvector : public Gobject
     }
 };
 
+template <class Type> long gvector<Type>::stamp_count = 0;
+
 /** An enumeration class for a gvector object.
  *  @ingroup libgobject
  */
@@ -26,6 +26,7 @@ bool cssWriteCDC(const char *prefix, const char *wa, gvector<Waveform *> &wvec,
 		const char *remark, int raw);
 bool sacWriteCDC(const char *prefix, const char *wa, gvector<Waveform *> &wvec,
 		const char *remark, int raw, CssOriginClass **origins);
+void sacFlipFloats(int n, const void *in, float *out);
 bool asciiWriteCDC(const char *prefix, const char *wa,
 		gvector<Waveform *> &wvec, const char *remark, int raw);
 void GParseWriteTimeSeries(const char *prefix,  const char *sta,
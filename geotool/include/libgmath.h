@@ -25,6 +25,10 @@ void deltaz(double slat, double slon, double rlat, double rlon, double *delta,
 			double *az, double *baz);
 
 
+/* ****** eigen3.c ********/
+void eigen3(double *s, double *d, double *v);
+
+
 /* ****** euler.c ********/
 void euler(double *theta, double *phi, double a, double b, double g);
 void euler2(double *theta, double *phi, double a1, double b1, double g1,
@@ -46,7 +50,23 @@ void get_regional(CrustModel *crust, const char *phase, double depth,
 			int *npts, float *x, float *y);
 
 /* ****** hilbert.c ********/
+typedef struct AnalyticWork_s
+{
+	int	block;	/* overlap-save FFT length, or 0 for whole traces */
+	int	half;	/* half-length of the FIR filter when block > 0 */
+	int	size;	/* length of x */
+	double	*x;	/* FFT scratch */
+	double	*b;	/* FIR filter spectrum H[j] = i*b[j], j <= block/2 */
+} AnalyticWork;
+
 int Hilbert_data(int npts, float *data);
+AnalyticWork *analytic_work(int block, int half);
+void analytic_free(AnalyticWork *w);
+int analytic_signal(AnalyticWork *w, int npts, float *data, double dt,
+		float *hilbert, float *envelope, float *phase, float *freq);
+int analytic_batch(int ntraces, int *npts, float **data, double dt, int block,
+		int half, float **hilbert, float **envelope, float **phase,
+		float **freq);
 
 
 /* ****** jbsim.c ********/
@@ -67,6 +87,27 @@ void nicex(double ax1, double ax2, int minlb, int maxlb, int *nlab, double *x,
 int nint(double f);
 
 
+/* ****** polar_trace.c ********/
+int polar_trace(int npts, float *e, float *n, float *z, int window_pts,
+		double c[3][3], int num_threads, float *recti, float *az,
+		float *incidence);
+
+
+/* ****** profile.c ********/
+extern int profile_running;
+/* non-zero if the profile is running, read as an atomic */
+#define PROFILE_RUNNING() __sync_add_and_fetch(&profile_running, 0)
+
+long long profile_clock(void);
+void profile_start(void);
+void profile_stop(void);
+void profile_reset(void);
+const char *profile_name(const char *name);
+void profile_record(const char *stage, long long t0, long long t1);
+int profile_report(FILE *fp);
+int profile_trace(const char *file);
+
+
 /* ****** regional.c ********/
 int regional(CrustModel *crust, const char *phase, double delta, double depth,
 			float *ttime, Derivatives *dd);
@@ -17,6 +17,11 @@
  *  vol.102, no.B4, pp. 8269-8283 (Apr. 1997).
  */ 
 
+/** The lag window, in seconds, over which pairs of waveforms are
+ *  correlated.
+ */
+#define MCCC_TAU_RANGE 1.0
+
 /* Data type Method */
 enum Method {
   VANDECAR_CROSSON,
@@ -31,3 +36,18 @@ GTimeSeries ** multiChannelCCTS(GTimeSeries ** ts_list,
 				double lag, 
 				double ** ccmatrix,
 				bool ** ccmatrix_mask);
+
+/** @ingroup libmccc
+ */
+int allPairsCC(int n, int m, const float *const *x, int max_lag,
+	       int num_threads, double **coef, double **lag);
+
+/** @ingroup libmccc
+ */
+int slidingCC(int nwin, int m, const float *const *x, int n, const float *y,
+	      int num_threads, double **c);
+
+/** @ingroup libmccc
+ */
+int pairsCC(int n, int m, const double *const *x, const double *const *y,
+	    int lag_min, int lag_max, int num_threads, double ***c);
@@ -308,6 +308,7 @@ class AppParse : public Component
 			char *sep);
 	bool printOpenFile(const string &c);
 	bool writeOpenFile(const string &c);
+	bool profileCmd(const string &c);
 	bool checkLine(char *line, string &msg);
 	void getScriptFiles(void);
 	void initCreateMethods(void);
@@ -102,6 +102,8 @@ class MapImage
 #define MAX_POLAR_AZ	18
 #define MAX_POLAR_DIST	10
 
+#define MAX_THEME_LEVELS 5
+
 typedef struct
 {
 	int	x;
@@ -145,6 +147,12 @@ class MapTheme
 		dist[i].border = False;
 	    }
 	    td = NULL;
+	    tree = NULL;
+	    nlevels = 0;
+	    for(int i = 0; i < MAX_THEME_LEVELS; i++) {
+		level_tol[i] = 0.;
+		level[i] = NULL;
+	    }
 	}
 	int		id;
 	int		theme_type;	/* THEME_SHAPE, THEME_IMAGE */
@@ -162,9 +170,56 @@ class MapTheme
 	PolarLabel	dist[MAX_POLAR_DIST];
 	MapPlotTheme	theme;
 	ThemeDisplay	*td;
+	SHPTree		*tree;		/* quadtree of the shape bounds */
+	int		nlevels;	/* number of simplified shape copies */
+	double		level_tol[MAX_THEME_LEVELS]; /* tolerance (deg) */
+	SHPObject	**level[MAX_THEME_LEVELS];   /* simplified shapes */
 	MapImage	map_image;
 };
 
+/* The projection state that the pixel position of a lon,lat depends on.
+ */
+typedef struct
+{
+	int		projection;
+	double		x1, x2, y1, y2;		/* zoomed axes limits */
+	double		x1_0, x2_0;		/* unzoomed axes x limits */
+	double		mercator_max_lat;
+	double		c[3][3];
+	char		utm_cell_letter;
+	int		utm_cell_zone;
+	double		utm_center_lon;
+	double		utm_center_lat;
+	int		ix1, iy1;
+	double		sx1, sy1, unscalex, unscaley;
+} MapProjKey;
+
+#define MAP_SYMBOL_CELL	16
+
+/* Pixel positions of a set of symbols, kept while the projection is
+ * unchanged. A symbol is projected again only if its lon,lat changes.
+ * The symbols in front (z > 0) are bucketed into cells of MAP_SYMBOL_CELL
+ * pixels, in index order, for the hit-tests.
+ */
+typedef struct
+{
+	MapProjKey	key;
+	Boolean		valid;
+	Boolean		changed;
+	int		n;
+	int		size;
+	double		*lon;
+	double		*lat;
+	int		*x;
+	int		*y;
+	char		*in;		/* z > 0 */
+	int		width, height;	/* widget size of the cells */
+	int		nx, ny;
+	int		size_cells;
+	int		*cell;		/* start of each cell in sym[] */
+	int		*sym;		/* symbol indices by cell */
+} SymbolCache;
+
 typedef struct
 {
 	Pixel		map_water_color;
@@ -236,6 +291,12 @@ typedef struct
 	MapSource	**src;
 	int		nsrc;
 	int		size_src;
+	SymbolCache	sta_cache;
+	SymbolCache	src_cache;
+	SymbolCache	symbol_cache;
+	int		*pixel_stamp;	/* symbol drawn at a pixel */
+	int		size_pixel_stamp;
+	int		last_pixel_stamp;
 	MapArc		**arc;
 	int		narc;
 	int		size_arc;
@@ -121,6 +121,11 @@ extern WidgetClass	mmTableWidgetClass;
 #define CELL_TOGGLE_ON		999998
 #define CELL_TOGGLE_OFF		999997
 
+/* Table::cellSortKey returns */
+#define CELL_KEY_TEXT	0
+#define CELL_KEY_VALUE	1
+#define CELL_KEY_STRING	2
+
 enum TableSelectionType {
 	TABLE_COPY_ROWS,
 	TABLE_COPY_ALL,
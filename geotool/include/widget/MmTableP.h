@@ -32,6 +32,18 @@ typedef struct
 	int	cols_length;
 } SortUnique;
 
+/* The text of a virtual row, formatted by Table::cellText when the row is
+ * displayed. The formatted rows are kept in a small LRU list.
+ */
+typedef struct
+{
+	int	row;		/* data row, or -1 */
+	int	prev, next;	/* LRU list, most recent first */
+	char	**cells;	/* text of the unformatted cells */
+} LazyRow;
+
+#define MM_TABLE_LAZY_ROWS	512
+
 typedef struct
 {
 	Table		*table_class;
@@ -101,6 +113,15 @@ typedef struct
 	CellIndex	*cell_non_editable;
 	SortUnique	sort_unique;
 	CellChoice	*cell_choice;
+	Boolean		have_virtual;	/* some cells are NULL */
+	Boolean		lazy_wider;
+	LazyRow		*lazy;
+	int		nlazy;
+	int		lazy_ncols;	/* size of LazyRow.cells */
+	int		lazy_head, lazy_tail;
+	int		*lazy_slot;	/* slot of each data row, or -1 */
+	int		size_lazy_slot;
+	int		*lazy_width;	/* widest formatted virtual cell */
 	Boolean		edit_row_state;
 	Boolean		start_edit_cursor;
 	Boolean		have_focus;
@@ -196,6 +217,10 @@ typedef struct _MmTableClassRec
 extern MmTableClassRec	mmTableClassRec;
 
 void _MmTableResetInfo(MmTableWidget w);
+char *_MmTableCell(MmTableWidget w, int row, int col);
+void _MmTableFormatRow(MmTableWidget w, int row);
+void _MmTableFormatCells(MmTableWidget w);
+Boolean _MmTableLoadRows(MmTableWidget w, int i1, int i2);
 
 /// @endcond
 
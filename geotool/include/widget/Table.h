@@ -44,6 +44,22 @@ class Table : public Component
 	void addRowWithLabel(const char **row, const string &label,bool redraw){
 		addRowWithLabel(row, label.c_str(), redraw);
 	}
+	void addVirtualRows(int num, bool redraw);
+	/** Format the text of a cell of a row added with addVirtualRows.
+	 *  Return false if there is no data for the cell.
+	 */
+	virtual bool cellText(int row, int col, char *buf, int buf_len) {
+		return false;
+	}
+	/** Get the sort key of a cell of a row added with addVirtualRows.
+	 *  Return CELL_KEY_VALUE with the value, CELL_KEY_STRING with a string
+	 *  that stays valid during the sort, or CELL_KEY_TEXT to sort by the
+	 *  cell text.
+	 */
+	virtual int cellSortKey(int row, int col, double *value, const char **s)
+	{
+		return CELL_KEY_TEXT;
+	}
 	int getRowHeight(void);
 	void removeRow(int i);
 	void removeRows(int *rows, int num) {
@@ -2578,6 +2578,8 @@ microarrays using their measured gene expression data. Several distance measures
 can be used. The routine returns a pointer to a ragged array containing the
 distances between the genes. As the distance matrix is symmetric, with zeros on
 the diagonal, only the lower triangular half of the distance matrix is saved.
+The rows are stored one after the other in a single block allocated by
+trianglematrix, and the matrix should be deallocated with freetrianglematrix.
 The distancematrix routine allocates space for the distance matrix. If the
 parameter transpose is set to a nonzero value, the distances between the columns
 (microarrays) are calculated, otherwise distances between the rows (genes) are
@@ -2644,19 +2646,8 @@ when microarrays are being clustered.
   if (n < 2) return NULL;
 
   /* Set up the ragged array */
-  matrix = malloc(n*sizeof(double*));
+  matrix = trianglematrix(n);
   if(matrix==NULL) return NULL; /* Not enough memory available */
-  matrix[0] = NULL;
-  /* The zeroth row has zero columns. We allocate it anyway for convenience.*/
-  for (i = 1; i < n; i++)
-  { matrix[i] = malloc(i*sizeof(double));
-    if (matrix[i]==NULL) break; /* Not enough memory available */
-  }
-  if (i < n) /* break condition encountered */
-  { j = i;
-    for (i = 1; i < j; i++) free(matrix[i]);
-    return NULL;
-  }
 
   /* Calculate the distances and save them in the ragged array */
   for (i = 1; i < n; i++)
@@ -2668,6 +2659,74 @@ when microarrays are being clustered.
 
 /* ******************************************************************** */
 
+double** CALL trianglematrix (int n)
+/*
+Purpose
+=======
+
+The trianglematrix routine allocates a ragged array for the lower triangular
+half of a symmetric n by n matrix, such as a distance matrix. Row i has i
+columns. The rows are stored one after the other in a single contiguous block
+of n*(n-1)/2 values, so that element [i][j] (j < i) is at offset i*(i-1)/2+j
+of the block, and matrix[0] points to the start of the block. The matrix
+should be deallocated with freetrianglematrix. If sufficient memory cannot be
+allocated, the routine returns a NULL pointer.
+
+Arguments
+=========
+
+n          (input) int
+The number of rows of the matrix.
+
+========================================================================
+*/
+{ int i;
+  double** matrix;
+  double* block;
+
+  if (n < 1) return NULL;
+  matrix = malloc(n*sizeof(double*));
+  if (matrix==NULL) return NULL; /* Not enough memory available */
+  block = malloc((n > 1 ? (size_t)n*(n-1)/2 : 1)*sizeof(double));
+  if (block==NULL)
+  { free(matrix);
+    return NULL;
+  }
+  for (i = 0; i < n; i++) matrix[i] = block + (size_t)i*(i-1)/2;
+  matrix[0] = block;
+  return matrix;
+}
+
+/* ******************************************************************** */
+
+void CALL freetrianglematrix (double** matrix)
+/*
+Purpose
+=======
+
+The freetrianglematrix routine deallocates a matrix allocated by
+trianglematrix or returned by distancematrix.
+
+========================================================================
+*/
+{ if (matrix==NULL) return;
+  free(matrix[0]);
+  free(matrix);
+}
+
+/* ******************************************************************** */
+
+static
+int istrianglematrix (int n, double** matrix)
+/* Returns 1 if the rows of matrix are stored as by trianglematrix. */
+{ int i;
+  for (i = 1; i < n; i++)
+    if (matrix[i] != matrix[0] + (size_t)i*(i-1)/2) return 0;
+  return 1;
+}
+
+/* ******************************************************************** */
+
 double* calculate_weights(int nrows, int ncolumns, double** data, int** mask,
   double weights[], int transpose, char dist, double cutoff, double exponent)
 
@@ -3122,7 +3181,8 @@ If a memory error occurs, pslcluster returns NULL.
     free(temp);
     return NULL;
   }
-  result = malloc(nnodes*sizeof(Node));
+  /* The pointer representation needs a distance for the last element too */
+  result = malloc(nelements*sizeof(Node));
   if(!result)
   { free(vector);
     free(index);
@@ -3130,13 +3190,11 @@ If a memory error occurs, pslcluster returns NULL.
     return NULL;
   }
 
-  for (i = 0; i < nnodes; i++)
-  { vector[i] = i;
-    result[i].distance = DBL_MAX;
-  }
+  for (i = 0; i < nnodes; i++) vector[i] = i;
+  for (i = 0; i < nelements; i++) result[i].distance = DBL_MAX;
 
   if(distmatrix)
-  { for (i = 0; i < nrows; i++)
+  { for (i = 0; i < nelements; i++)
     { for (j = 0; j < i; j++) temp[j] = distmatrix[i][j];
       for (j = 0; j < i; j++)
       { k = vector[j];
@@ -3194,89 +3252,39 @@ If a memory error occurs, pslcluster returns NULL.
 }
 /* ******************************************************************** */
 
-static Node* pmlcluster (int nelements, double** distmatrix)
-/*
-
-Purpose
-=======
-
-The pmlcluster routine performs clustering using pairwise maximum- (complete-)
-linking on the given distance matrix.
-
-Arguments
-=========
-
-nelements     (input) int
-The number of elements to be clustered.
-
-distmatrix (input) double**
-The distance matrix, with nelements rows, each row being filled up to the
-diagonal. The elements on the diagonal are not used, as they are assumed to be
-zero. The distance matrix will be modified by this routine.
+/* A merge made by pnncluster, of the clusters stored at indices lo and hi. */
+typedef struct {double distance; int order; int lo; int hi;} Merge;
 
-Return value
-============
-
-A pointer to a newly allocated array of Node structs, describing the
-hierarchical clustering solution consisting of nelements-1 nodes. Depending on
-whether genes (rows) or microarrays (columns) were clustered, nelements is
-equal to nrows or ncolumns. See src/cluster.h for a description of the Node
-structure.
-If a memory error occurs, pmlcluster returns NULL.
-========================================================================
-*/
-{ int j;
-  int n;
-  int* clusterid;
-  Node* result;
-
-  clusterid = malloc(nelements*sizeof(int));
-  if(!clusterid) return NULL;
-  result = malloc((nelements-1)*sizeof(Node));
-  if (!result)
-  { free(clusterid);
-    return NULL;
-  }
-
-  /* Setup a list specifying to which cluster a gene belongs */
-  for (j = 0; j < nelements; j++) clusterid[j] = j;
-
-  for (n = nelements; n > 1; n--)
-  { int is = 1;
-    int js = 0;
-    result[nelements-n].distance = find_closest_pair(n, distmatrix, &is, &js);
-
-    /* Fix the distances */
-    for (j = 0; j < js; j++)
-      distmatrix[js][j] = max(distmatrix[is][j],distmatrix[js][j]);
-    for (j = js+1; j < is; j++)
-      distmatrix[j][js] = max(distmatrix[is][j],distmatrix[j][js]);
-    for (j = is+1; j < n; j++)
-      distmatrix[j][js] = max(distmatrix[j][is],distmatrix[j][js]);
-
-    for (j = 0; j < is; j++) distmatrix[is][j] = distmatrix[n-1][j];
-    for (j = is+1; j < n-1; j++) distmatrix[j][is] = distmatrix[n-1][j];
-
-    /* Update clusterids */
-    result[nelements-n].left = clusterid[is];
-    result[nelements-n].right = clusterid[js];
-    clusterid[js] = n-nelements-1;
-    clusterid[is] = clusterid[n-1];
-  }
-  free(clusterid);
-
-  return result;
+static
+int mergecompare(const void* a, const void* b)
+/* Helper function for qsort: order merges by distance, then by the order in
+ * which they were made. */
+{ const Merge* merge1 = (const Merge*)a;
+  const Merge* merge2 = (const Merge*)b;
+  if (merge1->distance < merge2->distance) return -1;
+  if (merge1->distance > merge2->distance) return +1;
+  return merge1->order - merge2->order;
 }
 
-/* ******************************************************************* */
+/* ---------------------------------------------------------------------- */
+
+#define TRI(i,j) ((i) > (j) ? (size_t)(i)*((i)-1)/2+(j) \
+                            : (size_t)(j)*((j)-1)/2+(i))
 
-static Node* palcluster (int nelements, double** distmatrix)
+static Node* pnncluster (int nelements, double* d, char method)
 /*
+
 Purpose
 =======
 
-The palcluster routine performs clustering using pairwise average
-linking on the given distance matrix.
+The pnncluster routine performs clustering using pairwise maximum- (complete-)
+or average-linking on the given distance matrix, using the nearest-neighbor
+chain algorithm. Starting from any cluster, a chain of nearest neighbors is
+followed until two clusters are each other's nearest neighbor; these are then
+merged and the chain is continued from its remaining end. As maximum and
+average linkage are reducible, this gives the same hierarchy as repeatedly
+merging the closest pair, in O(n^2) time instead of O(n^3). Only the order of
+merges at equal distances may differ.
 
 Arguments
 =========
@@ -3284,95 +3292,141 @@ Arguments
 nelements     (input) int
 The number of elements to be clustered.
 
-distmatrix (input) double**
-The distance matrix, with nelements rows, each row being filled up to the
-diagonal. The elements on the diagonal are not used, as they are assumed to be
-zero. The distance matrix will be modified by this routine.
+d          (input) double[nelements*(nelements-1)/2]
+The lower triangular half of the distance matrix, stored row after row as by
+trianglematrix. The distance matrix will be modified by this routine.
+
+method     (input) char
+method=='m': pairwise maximum- (or complete-) linkage clustering
+method=='a': pairwise average-linkage clustering
 
 Return value
 ============
 
 A pointer to a newly allocated array of Node structs, describing the
-hierarchical clustering solution consisting of nelements-1 nodes. Depending on
-whether genes (rows) or microarrays (columns) were clustered, nelements is
-equal to nrows or ncolumns. See src/cluster.h for a description of the Node
+hierarchical clustering solution consisting of nelements-1 nodes, in order of
+increasing distance. See src/cluster.h for a description of the Node
 structure.
-If a memory error occurs, palcluster returns NULL.
+If a memory error occurs, pnncluster returns NULL.
 ========================================================================
 */
-{ int j;
-  int n;
-  int* clusterid;
+{ int i, j, k, a, b, lo, hi;
+  int nchain = 0;
+  int first;
+  double dist, dab;
+  const int nnodes = nelements - 1;
+  int* chain;
   int* number;
+  int* next;
+  int* prev;
+  int* parent;
+  int* label;
+  Merge* merge;
   Node* result;
 
-  clusterid = malloc(nelements*sizeof(int));
-  if(!clusterid) return NULL;
-  number = malloc(nelements*sizeof(int));
-  if(!number)
-  { free(clusterid);
-    return NULL;
-  }
-  result = malloc((nelements-1)*sizeof(Node));
-  if (!result)
-  { free(clusterid);
-    free(number);
+  result = malloc(nnodes*sizeof(Node));
+  merge = malloc(nnodes*sizeof(Merge));
+  chain = malloc(6*nelements*sizeof(int));
+  if (!result || !merge || !chain)
+  { free(result);
+    free(merge);
+    free(chain);
     return NULL;
   }
-
-  /* Setup a list specifying to which cluster a gene belongs, and keep track
-   * of the number of elements in each cluster (needed to calculate the
-   * average). */
-  for (j = 0; j < nelements; j++)
-  { number[j] = 1;
-    clusterid[j] = j;
+  number = chain + nelements;
+  next = number + nelements;
+  prev = next + nelements;
+  parent = prev + nelements;
+  label = parent + nelements;
+
+  /* A doubly linked list of the active clusters, each stored in the row and
+   * column of one of its elements. */
+  for (i = 0; i < nelements; i++)
+  { number[i] = 1;
+    next[i] = i + 1;
+    prev[i] = i - 1;
   }
-
-  for (n = nelements; n > 1; n--)
-  { int sum;
-    int is = 1;
-    int js = 0;
-    result[nelements-n].distance = find_closest_pair(n, distmatrix, &is, &js);
-
-    /* Save result */
-    result[nelements-n].left = clusterid[is];
-    result[nelements-n].right = clusterid[js];
-
-    /* Fix the distances */
-    sum = number[is] + number[js];
-    for (j = 0; j < js; j++)
-    { distmatrix[js][j] = distmatrix[is][j]*number[is]
-                        + distmatrix[js][j]*number[js];
-      distmatrix[js][j] /= sum;
-    }
-    for (j = js+1; j < is; j++)
-    { distmatrix[j][js] = distmatrix[is][j]*number[is]
-                        + distmatrix[j][js]*number[js];
-      distmatrix[j][js] /= sum;
+  next[nelements-1] = -1;
+  first = 0;
+
+  for (k = 0; k < nnodes; k++)
+  { if (nchain == 0) chain[nchain++] = first;
+
+    /* Follow nearest neighbors until two clusters are mutual neighbors. On
+     * a tie, the previous cluster in the chain is kept. */
+    for (;;)
+    { a = chain[nchain-1];
+      if (nchain >= 2)
+      { b = chain[nchain-2];
+        dab = d[TRI(a,b)];
+      }
+      else
+      { b = (first != a) ? first : next[first];
+        dab = d[TRI(a,b)];
+      }
+      for (i = first; i >= 0; i = next[i])
+      { if (i == a) continue;
+        dist = d[TRI(a,i)];
+        if (dist < dab)
+        { dab = dist;
+          b = i;
+        }
+      }
+      if (nchain >= 2 && b == chain[nchain-2]) break;
+      chain[nchain++] = b;
     }
-    for (j = is+1; j < n; j++)
-    { distmatrix[j][js] = distmatrix[j][is]*number[is]
-                        + distmatrix[j][js]*number[js];
-      distmatrix[j][js] /= sum;
+    nchain -= 2;
+
+    /* Merge a and b into the cluster stored at the lower index */
+    lo = min(a, b);
+    hi = max(a, b);
+    merge[k].distance = dab;
+    merge[k].order = k;
+    merge[k].lo = lo;
+    merge[k].hi = hi;
+
+    for (i = first; i >= 0; i = next[i])
+    { if (i == a || i == b) continue;
+      if (method == 'm')
+        d[TRI(lo,i)] = max(d[TRI(a,i)], d[TRI(b,i)]);
+      else
+        d[TRI(lo,i)] = (d[TRI(a,i)]*number[a] + d[TRI(b,i)]*number[b])
+                    / (number[a] + number[b]);
     }
+    number[lo] = number[a] + number[b];
 
-    for (j = 0; j < is; j++) distmatrix[is][j] = distmatrix[n-1][j];
-    for (j = is+1; j < n-1; j++) distmatrix[j][is] = distmatrix[n-1][j];
+    if (prev[hi] >= 0) next[prev[hi]] = next[hi];
+    else first = next[hi];
+    if (next[hi] >= 0) prev[next[hi]] = prev[hi];
+  }
 
-    /* Update number of elements in the clusters */
-    number[js] = sum;
-    number[is] = number[n-1];
+  /* Put the merges in order of distance and number the nodes */
+  qsort(merge, nnodes, sizeof(Merge), mergecompare);
 
-    /* Update clusterids */
-    clusterid[js] = n-nelements-1;
-    clusterid[is] = clusterid[n-1];
+  for (i = 0; i < nelements; i++)
+  { parent[i] = i;
+    label[i] = i;
+  }
+  for (k = 0; k < nnodes; k++)
+  { hi = merge[k].hi;
+    lo = merge[k].lo;
+    while (parent[hi] != hi) hi = parent[hi] = parent[parent[hi]];
+    while (parent[lo] != lo) lo = parent[lo] = parent[parent[lo]];
+    result[k].left = label[hi];
+    result[k].right = label[lo];
+    result[k].distance = merge[k].distance;
+    j = min(hi, lo);
+    parent[max(hi, lo)] = j;
+    label[j] = -k-1;
   }
-  free(clusterid);
-  free(number);
+  free(merge);
+  free(chain);
 
   return result;
 }
 
+#undef TRI
+
 /* ******************************************************************* */
 
 Node* CALL treecluster (int nrows, int ncolumns, double** data, int** mask,
@@ -3442,6 +3496,10 @@ deallocated before treecluster returns. If the distance matrix is passed by the
 calling routine, treecluster will modify the contents of the distance matrix as
 part of the clustering algorithm, but will not deallocate it. The calling
 routine should deallocate the distance matrix after the return from treecluster.
+Only the lower triangular half (j < i) of the distance matrix is used. For
+pairwise maximum- and average-linkage clustering, a distance matrix allocated
+by trianglematrix is used in place; other distance matrices are first copied
+into one.
 
 Return value
 ============
@@ -3458,6 +3516,8 @@ If a memory error occurs, treecluster returns NULL.
 { Node* result = NULL;
   const int nelements = (transpose==0) ? nrows : ncolumns;
   const int ldistmatrix = (distmatrix==NULL && method!='s') ? 1 : 0;
+  double** packed = NULL;
+  int i, j;
 
   if (nelements < 2) return NULL;
 
@@ -3474,10 +3534,17 @@ If a memory error occurs, treecluster returns NULL.
                           dist, transpose);
       break;
     case 'm':
-      result = pmlcluster(nelements, distmatrix);
-      break;
     case 'a':
-      result = palcluster(nelements, distmatrix);
+      if (istrianglematrix(nelements, distmatrix))
+        packed = distmatrix;
+      else
+      { packed = trianglematrix(nelements);
+        if (!packed) break;
+        for (i = 1; i < nelements; i++)
+          for (j = 0; j < i; j++) packed[i][j] = distmatrix[i][j];
+      }
+      result = pnncluster(nelements, packed[0], method);
+      if (packed != distmatrix) freetrianglematrix(packed);
       break;
     case 'c':
       result = pclcluster(nrows, ncolumns, data, mask, weight, distmatrix,
@@ -3486,11 +3553,7 @@ If a memory error occurs, treecluster returns NULL.
   }
 
   /* Deallocate space for distance matrix, if it was allocated by treecluster */
-  if(ldistmatrix)
-  { int i;
-    for (i = 1; i < nelements; i++) free(distmatrix[i]);
-    free (distmatrix);
-  }
+  if(ldistmatrix) freetrianglematrix(distmatrix);
  
   return result;
 }
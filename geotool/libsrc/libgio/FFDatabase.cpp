@@ -17,6 +17,7 @@
 #include "FFDatabase.h"
 #include "gobject++/DataSource.h"
 #include "motif++/Application.h"
+#include "ProfileTimer.h"
 
 extern "C" {
 #include "libstring.h"
@@ -696,6 +697,7 @@ bool FFDatabase::queryTable(const string &query, const string &cssTableName,
 FFDBQuery * FFDatabase::startQuery(const string &query,
 				const string &cssTableName)
 {
+    ProfileTimer pt("FFDBQuery::startQuery");
     FFDBQuery *q = new FFDBQuery(this);
     CssClassDescription *des;
 
@@ -763,6 +765,7 @@ FFDBQuery * FFDatabase::startQuery(const string &query,
 int FFDBQuery::getResults(int numToFetch, int *numFetched,
 		gvector<CssTableClass *> *v)
 {
+    ProfileTimer pt("FFDBQuery::getResults");
     int search_value;
 
     *numFetched = 0;
@@ -2008,6 +2011,7 @@ bool FFDBQuery::readFile(const char *path, int num_c, QConstraint *c,
 	int num_tables, QTable **tables, const string &tableName,
 	gvector<CssTableClass *> &r)
 {
+    ProfileTimer pt("FFDBQuery::readFile");
     int ret;
     FFDB_FILE *fp;
     struct stat buf;
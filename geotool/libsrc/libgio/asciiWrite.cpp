@@ -111,6 +111,7 @@ write_ts(GTimeSeries *ts, Waveform *w, const char *wa,
 	calib = (seg->calib() != 0.) ? seg->calib() : 1.;
 	calper = (seg->calper() != 0.) ? seg->calper() : 1.;
 	if(calib_applied && calib != 1.) {
+	    seg->unshare();
 	    n = seg->length();
 	    for(int l = 0; l < n; l++) {
 		seg->data[l] /= calib;
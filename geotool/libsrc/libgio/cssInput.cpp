@@ -1051,6 +1051,7 @@ write_ts(FILE *fp, FILE *fpw, const char *sta, const char *chan,
 	    return false;
 	}
 	if(remove_calib  && w.calib != 1.){
+	    ts->segment(k)->unshare();
 	    for(j = 0; j < w.nsamp; j++) {
 		ts->segment(k)->data[j] /= w.calib;
 	    }
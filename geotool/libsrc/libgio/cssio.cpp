@@ -156,10 +156,12 @@ cssioReadData(CssWfdiscClass *wfdisc, const string &working_dir, double start_ti
 	{
 #ifdef HAVE_LIBZ
 	    *npts = cssioReadDotw(path, zfd, fd, wfdisc->foff, start, *npts, data,
-			wfdisc->datatype, FLOAT_DATA, wfdisc->commid);
+			wfdisc->datatype, FLOAT_DATA, wfdisc->commid,
+			wfdisc->nsamp);
 #else
 	    *npts = cssioReadDotw(path, fd, wfdisc->foff, start, *npts, data,
-			wfdisc->datatype, FLOAT_DATA, wfdisc->commid);
+			wfdisc->datatype, FLOAT_DATA, wfdisc->commid,
+			wfdisc->nsamp);
 #endif
 	}
 	else
@@ -503,12 +505,12 @@ cssioReadSpectra(CssFsdiscClass fs, const char *working_dir, int *npts, float **
 
 #ifdef HAVE_LIBZ
 	*npts = cssioReadDotw(path, zfd, fd, fs->foff, start, *npts, data, datatype,
-				FLOAT_DATA, rd_len);
+				FLOAT_DATA, rd_len, (ssize_t)0);
 	if (zfd != Z_NULL) gzclose(zfd);
 	else close(fd);
 #else
 	*npts = cssioReadDotw(path, fd, fs->foff, start, *npts, data, datatype,
-				FLOAT_DATA, rd_len);
+				FLOAT_DATA, rd_len, (ssize_t)0);
 	close(fd);
 #endif
 
@@ -58,6 +58,8 @@ typedef union
 } Word2;
 
 static int bigEndian(void);
+static int caWindow(unsigned char *data_in, int data_in_len, int nsamp,
+		int start, int npts, void *data_out, int outtype);
 static int vftoif(VAX *from, IEEE *to, int num);
 
 #define False 0
@@ -622,15 +624,56 @@ cssioDecompC24(int start, int npts, char *data_in, void *data_out,
 }
 
 
+/**
+ * Decompress a "ca" (Canadian compressed) record of npts samples.
+ * @param data_in The compressed record.
+ * @param data_in_len The number of bytes in data_in.
+ * @param data_out An integer or float array of length npts.
+ * @param npts The number of samples in the record (a multiple of 20).
+ * @param outtype The desired data type of the output values (FLOAT_DATA or INT_DATA).
+ * @return the number of values returned.
+ */
 int
 cssioDecompCa(unsigned char *data_in, int data_in_len, void *data_out, int npts,
 		int outtype)
+{
+	return caWindow(data_in, data_in_len, npts, 0, npts, data_out, outtype);
+}
+
+/**
+ * Decompress samples start to start+npts-1 of a "ca" record. The blocks
+ * after the last sample are not decoded.
+ * @param start The first sample to return.
+ * @param npts The number of samples to return. It is reduced if the
+ *	waveform ends before start+npts.
+ * @param nsamp The number of samples in the waveform (the wfdisc nsamp).
+ *	The record holds nsamp rounded up to a multiple of 20 samples, which
+ *	sets where the block index ends.
+ * @param data_in The compressed record.
+ * @param data_in_len The number of bytes in data_in.
+ * @param data_out An integer or float array of length npts.
+ * @param outtype The desired data type of the output values (FLOAT_DATA or INT_DATA).
+ * @return the number of values returned.
+ */
+int
+cssioDecompCaWindow(int start, int npts, int nsamp, unsigned char *data_in,
+		int data_in_len, void *data_out, int outtype)
+{
+	if(start + npts > nsamp) npts = nsamp - start;
+	if(npts <= 0) return 0;
+
+	return caWindow(data_in, data_in_len, ((nsamp + 19)/20)*20, start,
+			npts, data_out, outtype);
+}
+
+static int
+caWindow(unsigned char *data_in, int data_in_len, int nsamp, int start,
+		int npts, void *data_out, int outtype)
 {
 	int	status;
-	long	v0;
 
-	status = canada_uncompress(data_in, (uint32_t *)data_out, &data_in_len,
-					npts, (uint32_t *)&v0);
+	status = canada_uncompress_window(data_in, data_in_len, nsamp, start,
+				npts, (int32_t *)data_out);
 
 	if(status != CANCOMP_SUCCESS)
 	{
@@ -650,27 +693,6 @@ cssioDecompCa(unsigned char *data_in, int data_in_len, void *data_out, int npts,
 	    return(0);
 	}
 
-	if( !bigEndian() )
-	{
-	    int i, *idata;
-	    union
-	    {
-		char	a[4];
-		int	i;
-	    } e1, e2;
-
-	    idata = (int *)data_out;
-	    for(i = 0; i < npts; i++)
-	    {
-		memcpy(&e1.i, &idata[i], sizeof(int));
-		e2.a[0] = e1.a[3];
-		e2.a[1] = e1.a[2];
-		e2.a[2] = e1.a[1];
-		e2.a[3] = e1.a[0];
-		idata[i] = e2.i;
-	    }
-	}
-
 	if(outtype == FLOAT_DATA)
 	{
 	    int *idata = (int *)data_out;
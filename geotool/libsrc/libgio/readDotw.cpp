@@ -46,10 +46,31 @@ typedef struct vax_single {
 
 static void itoi(char *from, char *to, int num);
 static int vftoif(VAX *from, IEEE *to, int num);
-static ssize_t decompress_e(unsigned long *in, void *data, int outtype,
-			    ssize_t start, ssize_t npts);
-static void b_lshift(unsigned long *input, int nwords, int size);
-static long b_lval(unsigned long input, int size);
+
+/**
+ * @private
+ */
+typedef struct
+{
+	const char	*path;
+#ifdef HAVE_LIBZ
+	gzFile		zfd;
+#endif
+	int		fd;
+	ssize_t		sample;	/* the first sample of the next record */
+	unsigned char	*rec;	/* the current record */
+	int32_t		*out;	/* its samples */
+} E1Reader;
+
+#ifdef HAVE_LIBZ
+static int e1Open(E1Reader *r, const char *path, gzFile zfd, int fd,
+			off_t foff);
+#else
+static int e1Open(E1Reader *r, const char *path, int fd, off_t foff);
+#endif
+static void e1Close(E1Reader *r);
+static ssize_t e1Next(E1Reader *r, ssize_t want, ssize_t *first);
+static ssize_t e1Decode(const unsigned char *rec, ssize_t lr, int32_t *out);
 
 
 static vector<int> files;
@@ -101,7 +122,7 @@ static void errorRead(const char *path, int seeking)
 ssize_t
 cssioReadDotw(const char *path, gzFile zfd, int fd, off_t foff, ssize_t start,
 	      ssize_t npts, void *data, const char *datatype, int outtype,
-	      ssize_t rd_len)
+	      ssize_t rd_len, ssize_t nsamp)
 #else /* HAVE_LIBZ */
 /**
  * Read a waveform dotw file.
@@ -114,20 +135,21 @@ cssioReadDotw(const char *path, gzFile zfd, int fd, off_t foff, ssize_t start,
  * @param outtype The desired data type of the output data values (FLOAT_DATA \
  * 	or INT_DATA).
  * @param rd_len The read length (bytes) for "ca" datatype.
+ * @param nsamp The number of samples in the waveform (the wfdisc nsamp) for
+ *	"ca" datatype.
  */
 ssize_t
 cssioReadDotw(const char *path, int fd, off_t foff, ssize_t start, ssize_t npts,
-	      void *data, const char *datatype, int outtype, ssize_t rd_len)
+	      void *data, const char *datatype, int outtype, ssize_t rd_len,
+	      ssize_t nsamp)
 #endif /* HAVE_LIBZ */
 {
 	ssize_t k = 0, m = 0;
-	ssize_t	lr, ns, data_size;
-	ssize_t e_ret;
+	ssize_t	ns, data_size;
 	float	*fdata = NULL;
 	int	*idata;
 	char	*cdata = NULL;
 	off_t	offset = 0;
-        ssize_t  sample;
 
 	cssioSetErrorMsg("");
 
@@ -317,242 +339,41 @@ cssioReadDotw(const char *path, int fd, off_t foff, ssize_t start, ssize_t npts,
 	}
         else if(!strcmp(datatype, "e1"))
 	{
-	    long buf[COMPRESSED_BUF_SIZE];
+	    E1Reader r;
+	    ssize_t i, first, s;
+	    int32_t *out;
+
 #ifdef HAVE_LIBZ
-	    if(zfd != Z_NULL) {
-		if (gzseek(zfd, foff, SEEK_SET) == -1) { errorRead(path, 1); return(0); }
-	    }
-	    else {
-		if (lseek(fd, foff, SEEK_SET) == -1) { errorRead(path, 1); return(0); }
-	    }
+	    if(e1Open(&r, path, zfd, fd, foff)) return(0);
 #else /* HAVE_LIBZ */
-	    if (lseek(fd, foff, SEEK_SET) == -1) { errorRead(path, 1); return(0); }
+	    if(e1Open(&r, path, fd, foff)) return(0);
 #endif /* HAVE_LIBZ */
 
-	    sample = 0;
+	    /* decode only the records that hold samples start to start+npts-1
+	     */
+	    ns = 0;
 	    k = 0;
-#ifdef HAVE_LIBZ
-	    if(zfd != Z_NULL) {
-	      while((ssize_t)gzread(zfd, buf, 8) == 8)
-	      {
-		ssize_t nbytes;
-		int16_t i16;
-//		lr = (ssize_t) ((int16_t *) (&buf[0]))[0];
-//		ns = (ssize_t) ((int16_t *) (&buf[0]))[1];
-		memcpy(&i16, buf, sizeof(i16));
-		lr = (ssize_t)i16;
-		memcpy(&i16, buf+2, sizeof(i16));
-		ns = (ssize_t)i16;
-
-		if(sample + ns < start)
-		{
-		    /* skip to the next record */
-		  if (gzseek(zfd, lr - 8, SEEK_CUR) == -1) {
-		    break;
-		  }
-		  sample += ns;
-		  continue;
-		}
-		nbytes = lr - 8;
-		m = (ssize_t)gzread(zfd, &buf[2], nbytes);
-		if (m == -1) {
-		  errorRead(path, 0);
-		  npts = k;
-		}
-		else if (m != nbytes) {
-		  npts = k;
-		  break;
-		}
-		else {
-		  /* Nothing */
-		}
-		if (outtype == FLOAT_DATA) {
-		    fdata = (float *)data;
-		    e_ret = decompress_e((unsigned long *)buf, fdata+k,
-					 outtype, start-sample,
-					 npts-k);
-		    if (e_ret < 0) {
-		      if (e_ret == -1) {
-			cssioSetErrorMsg("e1 format decompress error.");
-		      }
-		      else {
-			cssioSetErrorMsg("decompress_e: malloc error.");
-		      }
-		      npts = k;
-		      break;
-		    }
-		}
-		else {
-		    idata = (int *) data;
-		    e_ret = decompress_e((unsigned long *)buf, idata+k,
-					 outtype, start-sample,
-					 npts-k);
-		    if (e_ret < 0) {
-		      if(e_ret == -1) {
-			cssioSetErrorMsg("e1 format decompress error.");
-		      }
-		      else {
-			cssioSetErrorMsg("decompress_e: malloc error.");
-		      }
-		      npts = k;
-		      break;
-		    }
-		}
-
-		ns = (ssize_t)e_ret;
-
-		k += (start > sample) ? ns - (start-sample) : ns;
-		sample += ns;
-
-		if(k >= npts) break;
-	      }
-	    }
-	    else
+	    while(k < npts && (ns = e1Next(&r, start + k, &first)) > 0)
 	    {
-	      while(read(fd, buf, 8) == 8)
-	      {
-		ssize_t nbytes;
-		int16_t i16;
-//		lr = (ssize_t) ((int16_t *) (&buf[0]))[0];
-//		ns = (ssize_t) ((int16_t *) (&buf[0]))[1];
-		memcpy(&i16, buf, sizeof(i16));
-		lr = (ssize_t)i16;
-		memcpy(&i16, buf+2, sizeof(i16));
-		ns = (ssize_t)i16;
-
-		if(sample + ns < start)
-		{
-		  // skip to the next record
-		  if (lseek(fd, lr - 8, SEEK_CUR) == -1) {
-		    break;
-		  }
-		  sample += ns;
-		  continue;
-		}
-		nbytes = lr - 8;
-		m = read(fd, &buf[2], nbytes);
-		if (m == -1) {
-		  errorRead(path, 0);
-		  npts = k;
-		}
-		else if (m != nbytes) {
-		  npts = k;
-		  break;
+		s = start + k - first;
+		m = ns - s;
+		if(m > npts - k) m = npts - k;
+		out = r.out + s;
+		if(outtype == FLOAT_DATA) {
+		    fdata = (float *)data + k;
+		    for(i = 0; i < m; i++) fdata[i] = (float)out[i];
 		}
 		else {
-		  // Nothing
-		}
-		if (outtype == FLOAT_DATA) {
-		    fdata = (float *)data;
-		    e_ret = decompress_e((unsigned long *)buf, fdata+k,
-					 outtype, start-sample,
-					 npts-k);
-		    if (e_ret < 0) {
-		      if (e_ret == -1) {
-			cssioSetErrorMsg("e1 format decompress error.");
-		      }
-		      else {
-			cssioSetErrorMsg("decompress_e: malloc error.");
-		      }
-		      npts = k;
-		      break;
-		    }
+		    idata = (int *)data + k;
+		    for(i = 0; i < m; i++) idata[i] = (int)out[i];
 		}
-		else {
-		    idata = (int *) data;
-		    e_ret = decompress_e((unsigned long *)buf, idata+k,
-					 outtype, start-sample,
-					 npts-k);
-		    if (e_ret < 0) {
-		      if(e_ret == -1) {
-			cssioSetErrorMsg("e1 format decompress error.");
-		      }
-		      else {
-			cssioSetErrorMsg("decompress_e: malloc error.");
-		      }
-		      npts = k;
-		      break;
-		    }
-		}
-
-		ns = (ssize_t)e_ret;
-
-		k += (start > sample) ? ns - (start-sample) : ns;
-		sample += ns;
-
-		if(k >= npts) break;
-	      }
+		k += m;
 	    }
-#else /* HAVE_LIBZ */
-	    while(read(fd, buf, 8) == 8)
-	    {
-		ssize_t nbytes;
-		lr = (ssize_t) ((int16_t *) (&buf[0]))[0];
-		ns = (ssize_t) ((int16_t *) (&buf[0]))[1];
-
-		if(sample + ns < start)
-		{
-		  // skip to the next record
-		  if (lseek(fd, lr - 8, SEEK_CUR) == -1) {
-		    break;
-		  }
-		  sample += ns;
-		  continue;
-		}
-		nbytes = lr - 8;
-		m = read(fd, &buf[2], nbytes);
-		if (m == -1) {
-		  errorRead(path, 0);
-		  npts = k;
-		}
-		else if (m != nbytes) {
-		  npts = k;
-		  break;
-		}
-		else {
-		  // Nothing
-		}
-		if (outtype == FLOAT_DATA) {
-		    fdata = (float *)data;
-		    e_ret = decompress_e((unsigned long *)buf, fdata+k,
-					 outtype, start-sample,
-					 npts-k);
-		    if (e_ret < 0) {
-		      if (e_ret == -1) {
-			cssioSetErrorMsg("e1 format decompress error.");
-		      }
-		      else {
-			cssioSetErrorMsg("decompress_e: malloc error.");
-		      }
-		      npts = k;
-		      break;
-		    }
-		}
-		else {
-		    idata = (int *) data;
-		    e_ret = decompress_e((unsigned long *)buf, idata+k,
-					 outtype, start-sample,
-					 npts-k);
-		    if (e_ret < 0) {
-		      if(e_ret == -1) {
-			cssioSetErrorMsg("e1 format decompress error.");
-		      }
-		      else {
-			cssioSetErrorMsg("decompress_e: malloc error.");
-		      }
-		      npts = k;
-		      break;
-		    }
-		}
-
-		ns = (ssize_t)e_ret;
-
-		k += (start > sample) ? ns - (start-sample) : ns;
-		sample += ns;
-
-		if(k >= npts) break;
+	    if(ns == -1) {
+		cssioSetErrorMsg("e1 format decompress error.");
 	    }
-#endif /* HAVE_LIBZ */
+	    e1Close(&r);
+	    npts = k;
 	}
 	else if(!strcmp(datatype, "ca"))
 	{
@@ -575,34 +396,32 @@ cssioReadDotw(const char *path, int fd, off_t foff, ssize_t start, ssize_t npts,
 		return(0);
 	    }
 
-	    if (rd_len > (ssize_t)(npts * sizeof(int)))
-	    {
-		cssioSetErrorMsg("rd_len > (npts * sizeof(int))!");
-	    }
 #ifdef HAVE_LIBZ
 	    if(zfd != Z_NULL) {
 		if((k = gzread(zfd, comp, rd_len)) != rd_len)
 		{
 		    errorRead(path, 0);
-		    npts = k;
+		    if(k < 0) k = 0;
 		}
 	    }
 	    else {
 		if((k = read(fd, comp, rd_len)) != rd_len)
 		{
 		    errorRead(path, 0);
-		    npts = k;
+		    if(k < 0) k = 0;
 		}
 	    }
 #else /* HAVE_LIBZ */
             if((k = read(fd, comp, rd_len)) != rd_len)
             {
 	      errorRead(path, 0);
-	      npts = k;
+	      if(k < 0) k = 0;
 	    }
 #endif /* HAVE_LIBZ */
 
-	    npts = cssioDecompCa((unsigned char*)comp, rd_len, data, npts, outtype);
+	    /* the record holds the whole waveform; decode only the window */
+	    npts = cssioDecompCaWindow(start, npts, nsamp,
+				(unsigned char *)comp, k, data, outtype);
 
 	    free(comp);
 	    return npts;
@@ -1191,6 +1010,62 @@ cssioReadDotwDeci(const char *path, int fd, off_t foff, ssize_t start,
 		}
 	    }
 	}
+	else if(!strcmp(datatype, "e1"))
+	{
+	    E1Reader r;
+	    ssize_t first, ns = 0;
+	    int32_t *out;
+
+#ifdef HAVE_LIBZ
+	    if(e1Open(&r, path, zfd, fd, foff)) return(0);
+#else /* HAVE_LIBZ */
+	    if(e1Open(&r, path, fd, foff)) return(0);
+#endif /* HAVE_LIBZ */
+	    xlo = xhi = 0;
+	    l = m = 0;
+	    for(k = 0; k < npts && (ns = e1Next(&r, start + k, &first)) > 0; )
+	    {
+		out = r.out + start + k - first;
+		n = first + ns - start - k;
+		if(n > npts - k) n = npts - k;
+
+		for(i = 0; i < n; i++, k++)
+		{
+		    fl_tmp = (float)out[i];
+		    if(fl_tmp > interval_hi)
+		    {
+			xhi = k;
+			interval_hi = fl_tmp;
+		    }
+		    if(fl_tmp < interval_lo)
+		    {
+			xlo = k;
+			interval_lo = fl_tmp;
+		    }
+		    l++;
+		    if(l == num_per_interval)
+		    {
+			if(xlo < xhi)
+			{
+			    data[m] = interval_lo; m++;
+			    data[m] = interval_hi; m++;
+			}
+			else
+			{
+			    data[m] = interval_hi; m++;
+			    data[m] = interval_lo; m++;
+			}
+			interval_hi = -1.e+60;
+			interval_lo =  1.e+60;
+			l = 0;
+		    }
+		}
+	    }
+	    if(ns == -1) {
+		cssioSetErrorMsg("e1 format decompress error.");
+	    }
+	    e1Close(&r);
+	}
 	else
 	{
 	    return(0);
@@ -1284,124 +1159,184 @@ vftoif(register VAX *from, register IEEE *to, register int num)
 	return(1);
 }
 
-static ssize_t samples_per_block[6] = { 7,  3, 4,  5, 4, 1 };
-static ssize_t words_per_block[6]   = { 2,  1, 1,  2, 2, 1 };
-static ssize_t bits_per_sample[6]   = { 9, 10, 7, 12, 15, 28 };
-static int initial_shift[6]     = { 1,  2, 4,  4,  4,  4 };
-
-static ssize_t
-decompress_e(unsigned long *in, void *data, int outtype, ssize_t start,
-	     ssize_t npts)
+/* e1 records. A record is lr bytes of big-endian 32-bit words:
+ *	word 0		lr (int16), ns (int16)
+ *	word 1		the number of differences (8 bits), the last sample
+ *			(signed 24 bits) as a check
+ *	words 2...	blocks of 1 or 2 words of packed differences
+ * The top bits of a block give its layout. e1_blocks is indexed by the top
+ * four bits.
+ */
+typedef struct
 {
-	ssize_t i, j, k, nd, lr;
-	ssize_t ms;
-	long check;
-	unsigned long *out = NULL;
-	float	*fdata;
-	int	*idata;
+	int	nsamp;		/* samples in the block */
+	int	nwords;		/* 32-bit words in the block */
+	int	shift;		/* bits of the code */
+	int	bits;		/* bits per sample */
+} E1Block;
+
+static const E1Block e1_blocks[16] = {
+	{7, 2, 1, 9}, {7, 2, 1, 9}, {7, 2, 1, 9}, {7, 2, 1, 9},		/* 0 */
+	{7, 2, 1, 9}, {7, 2, 1, 9}, {7, 2, 1, 9}, {7, 2, 1, 9},
+	{3, 1, 2, 10}, {3, 1, 2, 10}, {3, 1, 2, 10}, {3, 1, 2, 10},	/* 10 */
+	{4, 1, 4, 7},							/* 1100 */
+	{5, 2, 4, 12},							/* 1101 */
+	{4, 2, 4, 15},							/* 1110 */
+	{1, 1, 4, 28},							/* 1111 */
+};
 
-	unsigned int code, idx;
-	long *signed_out;
+/* The largest record and the most samples it can hold (4 per word). */
+#define E1_MAX_RECORD	32768
+#define E1_MAX_SAMPLES	(E1_MAX_RECORD)
 
-	lr   = (ssize_t) ((int16_t *) (&in[0]))[0] / 4;
-	nd   = (ssize_t) ((char  *) (&in[1]))[0];
-	
-	b_lshift(&in[1], 1, 8);
-	check = b_lval(in[1], 24);
+#define E1_WORD(p) ( ((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) \
+		| ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3] )
 
-	out = (unsigned long *)malloc(7*lr*sizeof(long));
-	if(out == NULL) {
-	  return(-2);
+#ifdef HAVE_LIBZ
+static int
+e1Open(E1Reader *r, const char *path, gzFile zfd, int fd, off_t foff)
+#else /* HAVE_LIBZ */
+static int
+e1Open(E1Reader *r, const char *path, int fd, off_t foff)
+#endif /* HAVE_LIBZ */
+{
+	r->path = path;
+	r->fd = fd;
+	r->sample = 0;
+	r->rec = NULL;
+	r->out = NULL;
+#ifdef HAVE_LIBZ
+	r->zfd = zfd;
+	if(zfd != Z_NULL) {
+	    if (gzseek(zfd, foff, SEEK_SET) == -1) { errorRead(path, 1); return(-1); }
 	}
-	signed_out = (long *) out;
-
-	ms   = 0;
-	i    = 2;
+	else {
+	    if (lseek(fd, foff, SEEK_SET) == -1) { errorRead(path, 1); return(-1); }
+	}
+#else /* HAVE_LIBZ */
+	if (lseek(fd, foff, SEEK_SET) == -1) { errorRead(path, 1); return(-1); }
+#endif /* HAVE_LIBZ */
 
-	while( i < lr)
-	{
-	    code = in[i] >> 28;
+	r->rec = (unsigned char *)malloc(E1_MAX_RECORD);
+	r->out = (int32_t *)malloc(E1_MAX_SAMPLES*sizeof(int32_t));
+	if(r->rec == NULL || r->out == NULL) {
+	    cssioSetErrorMsg("e1: malloc error.");
+	    e1Close(r);
+	    return(-1);
+	}
+	return(0);
+}
 
-	    if(code < 8) idx = 0;
-	    else if (code < 0xc) idx = 1;
-	    else if(code >= 0xc) idx = 2 + (code & 0x3);
-		
-	    b_lshift(&in[i], words_per_block[idx], initial_shift[idx]);
+static void
+e1Close(E1Reader *r)
+{
+	Free(r->rec);
+	Free(r->out);
+}
 
-	    for(j = 0; j < samples_per_block[idx]; j++)
-	    {
-		out[ms++] = b_lval(in[i], bits_per_sample[idx]);
+/* Read the next record that holds sample want or a later one, skipping
+ * the records before it, and decode it into r->out. Returns the number of
+ * samples and their index in *first, 0 at the end of the data, or -1 if
+ * the record is not valid e1.
+ */
+static ssize_t
+e1Next(E1Reader *r, ssize_t want, ssize_t *first)
+{
+	ssize_t lr, ns, n;
 
-		b_lshift(&in[i], words_per_block[idx], bits_per_sample[idx]);
-	    }
-	    i += words_per_block[idx];
-	}
-	
-	for(k = 0; k < nd; k ++)
+	for(;;)
 	{
-	  for(j = 1; j < (ssize_t)ms; signed_out[j] += signed_out[j-1], j++);
-	}
+#ifdef HAVE_LIBZ
+	    if(r->zfd != Z_NULL) n = (ssize_t)gzread(r->zfd, r->rec, 4);
+	    else n = read(r->fd, r->rec, 4);
+#else /* HAVE_LIBZ */
+	    n = read(r->fd, r->rec, 4);
+#endif /* HAVE_LIBZ */
+	    if(n != 4) {
+		if(n == -1) errorRead(r->path, 0);
+		return(0);
+	    }
+	    lr = (int16_t)((r->rec[0] << 8) | r->rec[1]);
+	    ns = (int16_t)((r->rec[2] << 8) | r->rec[3]);
+	    if(lr < 8) return(-1);
 
-	if(check != signed_out[ms-1])
-	{
-	    Free(out);
-	    return(-1);
-	}
-	else
-	{
-	    if (outtype == FLOAT_DATA)
+	    if(r->sample + ns <= want)
 	    {
-		fdata = (float *) data;
-
-		for(i = 0; i < (ssize_t)ms && i < npts; i++)
-		{
-		    if(i >= start) *fdata++ = (float)signed_out[i];
+		/* skip to the next record */
+#ifdef HAVE_LIBZ
+		if(r->zfd != Z_NULL) {
+		    if(gzseek(r->zfd, lr - 4, SEEK_CUR) == -1) return(0);
 		}
+		else if(lseek(r->fd, lr - 4, SEEK_CUR) == -1) return(0);
+#else /* HAVE_LIBZ */
+		if(lseek(r->fd, lr - 4, SEEK_CUR) == -1) return(0);
+#endif /* HAVE_LIBZ */
+		r->sample += ns;
+		continue;
 	    }
-	    else if (outtype == INT_DATA)
-	    {
-		idata = (int *) data;
-
-		for(i = 0; i < (ssize_t)ms && i < npts; i++)
-		{
-		    if(i >= start) *idata++ = (int)signed_out[i];
-		}
+#ifdef HAVE_LIBZ
+	    if(r->zfd != Z_NULL) n = (ssize_t)gzread(r->zfd, r->rec+4, lr-4);
+	    else n = read(r->fd, r->rec+4, lr-4);
+#else /* HAVE_LIBZ */
+	    n = read(r->fd, r->rec+4, lr-4);
+#endif /* HAVE_LIBZ */
+	    if(n != lr - 4) {
+		if(n == -1) errorRead(r->path, 0);
+		return(0);
 	    }
-	    Free(out);
-	    return(ms);
+	    if((ns = e1Decode(r->rec, lr, r->out)) < 0) return(-1);
+
+	    *first = r->sample;
+	    r->sample += ns;
+	    if(r->sample > want) return(ns);
 	}
 }
 
-static void
-b_lshift(unsigned long *input, int nwords, int size)
+/* Decode the record rec of lr bytes into out. The block is loaded into a
+ * 64-bit word with its code in the top bits, and the samples are taken
+ * from the top. Returns the number of samples, or -1 if the last sample
+ * does not match the check value.
+ */
+static ssize_t
+e1Decode(const unsigned char *rec, ssize_t lr, int32_t *out)
 {
-	register int  i;
-	unsigned long ltmp, rtmp;
-	int left    = size;
-	int right   = sizeof(long) * 8 - size;
-	
-	ltmp = input[0] << left;
-
-	for(i = 0; i < nwords - 1; i++)
+	ssize_t i, j, nw, ms;
+	int k, nd;
+	int32_t check;
+	uint32_t sum, v, sign;
+	uint64_t x;
+	const E1Block *b;
+
+	nw = lr/4;
+	nd = (signed char)rec[4];
+	v = E1_WORD(rec+4) & 0xffffff;
+	check = (int32_t)((v ^ 0x800000) - 0x800000);
+
+	ms = 0;
+	for(i = 2; i < nw; i += b->nwords)
 	{
-	    rtmp = ((unsigned) input[i+1]) >> right;
-	    input[i] = ltmp | rtmp;
-	    ltmp = (input[i+1]) << left;
+	    x = (uint64_t)E1_WORD(rec+4*i) << 32;
+	    if(i+1 < nw) x |= E1_WORD(rec+4*i+4);
+
+	    b = &e1_blocks[x >> 60];
+	    x <<= b->shift;
+	    sign = (uint32_t)1 << (b->bits - 1);
+	    for(j = 0; j < b->nsamp; j++) {
+		v = (uint32_t)(x >> (64 - b->bits));
+		out[ms++] = (int32_t)((v ^ sign) - sign);
+		x <<= b->bits;
+	    }
 	}
-	
-	input[nwords - 1] = ltmp;
-	
-	return;
-}
 
-static long
-b_lval(unsigned long input, int size)
-{
-	unsigned long val = input >> (sizeof(long) * 8 - size);
-	unsigned long emask  = 0xffffffff << (size -1);
+	/* the samples are nd times differenced */
+	for(k = 0; k < nd; k++) {
+	    for(j = 0, sum = 0; j < ms; j++) {
+		sum += (uint32_t)out[j];
+		out[j] = (int32_t)sum;
+	    }
+	}
 
-	if(val & emask) val |= emask;
-	
-	return(val);
-}
+	if(ms == 0 || out[ms-1] != check) return(-1);
 
+	return(ms);
+}
@@ -5,11 +5,17 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <pwd.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "libgio.h"
 #include "DataMethod.h"
@@ -21,9 +27,52 @@ extern "C" {
 #include "libtime.h"
 }
 
+#define SAC_WRITE_THREADS	4
+#define SAC_WRITE_QUEUE		64
+
+/* A SAC file for the writer threads. The header and data are in one buffer
+ * that is written with one call. The file is created by the calling thread,
+ * so that newSacFile does not choose the same name again.
+ */
+typedef struct
+{
+    int		fd;
+    char	*buf;
+    size_t	len;
+    char	path[MAXPATHLEN+1];
+} SacWriteFile;
+
+/* The files are written by SAC_WRITE_THREADS threads while the calling
+ * thread prepares the next files. At most SAC_WRITE_QUEUE files wait.
+ */
+typedef struct
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t	lock;
+    pthread_cond_t	added;
+    pthread_cond_t	taken;
+    pthread_t		tid[SAC_WRITE_THREADS];
+    int			nthreads;
+    SacWriteFile	*queue[SAC_WRITE_QUEUE];
+    int			head;
+    int			count;
+    bool		done;
+#endif
+    int			err;
+    char		err_path[MAXPATHLEN+1];
+} SacWriter;
+
+static void writerStart(SacWriter *w);
+static void writerAdd(SacWriter *w, SacWriteFile *f);
+static bool writerFinish(SacWriter *w);
+static void writeFile(SacWriter *w, SacWriteFile *f);
+#ifdef HAVE_PTHREAD
+static void *writerThread(void *p);
+#endif
+
 static bool write_ts(GTimeSeries *ts, Waveform *w, SAC_HEADER *s,
 		CssOriginClass *origin, const char *wa, const char *prefix,
-		char *sac_file, int raw);
+		char *sac_file, int raw, SacWriter *writer);
 static void newSacFile(const char *prefix, const char *sta, const char *chan,
 		char *sac_file, size_t size);
 static void stringToSac(char *a, const char *b, int n);
@@ -41,7 +90,10 @@ sacWriteCDC(const char *prefix, const char *wa, gvector<Waveform *> &wvec,
     gvector<DataMethod *> methods;
     SAC_HEADER	s, sac_header_null = SAC_HEADER_NULL;
     double	dlat, dlon, delta;
-	
+    SacWriter	writer;
+
+    writerStart(&writer);
+
     for(i = 0; i < wvec.size(); i++)
     {
 	memcpy(&s, &sac_header_null, sizeof(SAC_HEADER));
@@ -105,9 +157,11 @@ sacWriteCDC(const char *prefix, const char *wa, gvector<Waveform *> &wvec,
 		    methods[k]->applyMethod(1, &ts);
 		}
 	    }
-	    if(!write_ts(ts, wvec[i], &s, origin, wa, prefix, sac_file, raw))
+	    if(!write_ts(ts, wvec[i], &s, origin, wa, prefix, sac_file, raw,
+			&writer))
 	    {
 		ts->deleteObject();
+		writerFinish(&writer);
 		return false;
 	    }
 	    ts->deleteObject();
@@ -128,35 +182,39 @@ sacWriteCDC(const char *prefix, const char *wa, gvector<Waveform *> &wvec,
 		    methods[k]->applyMethod(1, &ts);
 		}
 	    }
-	    if(!write_ts(ts, wvec[i], &s, origin, wa, prefix, sac_file, raw))
+	    if(!write_ts(ts, wvec[i], &s, origin, wa, prefix, sac_file, raw,
+			&writer))
 	    {
 		ts->deleteObject();
+		writerFinish(&writer);
 		return false;
 	    }
 	    ts->deleteObject();
 	}
     }
-    return true;
+    return writerFinish(&writer);
 }
 
 static bool
 write_ts(GTimeSeries *ts, Waveform *w, SAC_HEADER *s, CssOriginClass *origin,
-	const char *wa, const char *prefix, char *sac_file, int raw)
+	const char *wa, const char *prefix, char *sac_file, int raw,
+	SacWriter *writer)
 {
     char error[MAXPATHLEN+100];
-    int k, l, npts, err;
+    int k, l, npts, fd;
     int inum;
     double calib;
     bool calib_applied = false;
-    FILE *fp;
     int flip_bytes;
+    float *y;
+    SacWriteFile *f;
     union
     {
 	char    a[4];
 	float   f;
 	int    i;
 	short   s;
-    } e1, e2;
+    } e1;
     e1.a[0] = 0; e1.a[1] = 0;
     e1.a[2] = 0; e1.a[3] = 1;
     flip_bytes = (e1.i == 1) ? 0 : 1;
@@ -210,66 +268,196 @@ flip_bytes = 0; // write in native byte order
 
 	newSacFile(prefix, w->sta(), w->chan(), sac_file, MAXPATHLEN);
 
-	if((fp = fopen(sac_file, wa)) == NULL) {
+	if((fd = open(sac_file, O_WRONLY | O_CREAT |
+		(wa[0] == 'a' ? O_APPEND : O_TRUNC), 0666)) < 0)
+	{
 	    snprintf(error, sizeof(error),"sac: cannot open %s", sac_file);
 	    logErrorMsg(LOG_WARNING, error);
 	    return false;
 	}
-	if(flip_bytes) sacFlipHeader((SAC *)s);
-	err = fwrite(s, sizeof(SAC_HEADER), 1, fp);
-	if(flip_bytes) sacFlipHeader((SAC *)s);
-
-	if(err != 1)
-	{
-	    if(errno > 0) {
-		snprintf(error, sizeof(error),
-			"write error: %s\n%s", sac_file, strerror(errno));
-	    }
-	    else {
-		snprintf(error, sizeof(error), "write error: %s", sac_file);
-	    }
+	f = (SacWriteFile *)malloc(sizeof(SacWriteFile));
+	if(f) f->buf = (char *)malloc(sizeof(SAC_HEADER) + npts*sizeof(float));
+	if(!f || !f->buf) {
+	    snprintf(error, sizeof(error), "write error: %s", sac_file);
 	    logErrorMsg(LOG_WARNING, error);
-	    fclose(fp);
+	    if(f) free(f);
+	    close(fd);
 	    return false;
 	}
+	f->fd = fd;
+	f->len = sizeof(SAC_HEADER) + npts*sizeof(float);
+	stringcpy(f->path, sac_file, sizeof(f->path));
+
+	/* the header and the data, without calib if it has been applied */
+	memcpy(f->buf, s, sizeof(SAC_HEADER));
+	if(flip_bytes) sacFlipHeader((SAC *)f->buf);
 
+	y = (float *)(f->buf + sizeof(SAC_HEADER));
 	if(calib_applied && calib != 1.) {
-	    for(l = 0; l < npts; l++) {
-		seg->data[l] /= calib;
-	    }
+	    for(l = 0; l < npts; l++) y[l] = seg->data[l]/calib;
 	}
-
-	if(flip_bytes) {
-	    for(l = 0; l < npts; l++) {
-		e1.f = seg->data[l];
-		e2.a[0] = e1.a[3];
-		e2.a[1] = e1.a[2];
-		e2.a[2] = e1.a[1];
-		e2.a[3] = e1.a[0];
-		seg->data[l] = e2.f;
-	    }
+	else {
+	    memcpy(y, seg->data, npts*sizeof(float));
 	}
+	if(flip_bytes) sacFlipFloats(npts, y, y);
 
-	err = fwrite(seg->data, sizeof(float), npts, fp);
+	writerAdd(writer, f);
+    }
+    return true;
+}
 
-	if(err != npts)
-	{
-	    if(errno > 0) {
-		snprintf(error, sizeof(error), "write error: %s\n%s",
-				sac_file, strerror(errno));
-	    }
-	    else {
-		snprintf(error, sizeof(error), "write error: %s", sac_file);
-	    }
-	    logErrorMsg(LOG_WARNING, error);
-	    fclose(fp);
-	    return false;
+/** Swap the bytes of n 4-byte floats. The swap is done with shifts of
+ *  unsigned ints in a loop that the compiler can vectorize. in can be out,
+ *  and in need not be aligned.
+ */
+void
+sacFlipFloats(int n, const void *in, float *out)
+{
+    const unsigned char *a = (const unsigned char *)in;
+    uint32_t x;
+    int i;
+
+    for(i = 0; i < n; i++) {
+	memcpy(&x, a + 4*i, 4);
+	x = (x >> 24) | ((x >> 8) & 0xff00) | ((x & 0xff00) << 8) | (x << 24);
+	memcpy(out + i, &x, 4);
+    }
+}
+
+static void
+writerStart(SacWriter *w)
+{
+    w->err = 0;
+    w->err_path[0] = '\0';
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->added, NULL);
+    pthread_cond_init(&w->taken, NULL);
+    w->head = 0;
+    w->count = 0;
+    w->done = false;
+
+    for(w->nthreads = 0; w->nthreads < SAC_WRITE_THREADS; w->nthreads++) {
+	if(pthread_create(&w->tid[w->nthreads], NULL, writerThread, w)) break;
+    }
+#endif
+}
+
+/* Queue a file for the writer threads, or write it now if there are no
+ * threads. Waits while the queue is full.
+ */
+static void
+writerAdd(SacWriter *w, SacWriteFile *f)
+{
+#ifdef HAVE_PTHREAD
+    if(w->nthreads > 0) {
+	pthread_mutex_lock(&w->lock);
+	while(w->count == SAC_WRITE_QUEUE) {
+	    pthread_cond_wait(&w->taken, &w->lock);
 	}
-	fclose(fp);
+	w->queue[(w->head + w->count) % SAC_WRITE_QUEUE] = f;
+	w->count++;
+	pthread_cond_signal(&w->added);
+	pthread_mutex_unlock(&w->lock);
+	return;
+    }
+#endif
+    writeFile(w, f);
+}
+
+/* Wait for the queued files to be written and stop the threads.
+ * Returns false if a write failed.
+ */
+static bool
+writerFinish(SacWriter *w)
+{
+    char error[MAXPATHLEN+100];
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&w->lock);
+    w->done = true;
+    pthread_cond_broadcast(&w->added);
+    pthread_mutex_unlock(&w->lock);
+
+    for(int i = 0; i < w->nthreads; i++) pthread_join(w->tid[i], NULL);
+
+    pthread_cond_destroy(&w->taken);
+    pthread_cond_destroy(&w->added);
+    pthread_mutex_destroy(&w->lock);
+#endif
+
+    if(w->err) {
+	snprintf(error, sizeof(error), "write error: %s\n%s", w->err_path,
+			strerror(w->err));
+	logErrorMsg(LOG_WARNING, error);
+	return false;
     }
     return true;
 }
 
+/* Write, close and free a file. The first error is kept for writerFinish.
+ */
+static void
+writeFile(SacWriter *w, SacWriteFile *f)
+{
+    size_t n = 0;
+    ssize_t m;
+    int err = 0;
+
+    while(n < f->len) {
+	if((m = write(f->fd, f->buf + n, f->len - n)) < 0) {
+	    if(errno == EINTR) continue;
+	    err = errno;
+	    break;
+	}
+	n += (size_t)m;
+    }
+    if(close(f->fd) && !err) err = errno;
+
+    if(err) {
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&w->lock);
+#endif
+	if(!w->err) {
+	    w->err = err;
+	    stringcpy(w->err_path, f->path, sizeof(w->err_path));
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&w->lock);
+#endif
+    }
+    free(f->buf);
+    free(f);
+}
+
+#ifdef HAVE_PTHREAD
+static void *
+writerThread(void *p)
+{
+    SacWriter *w = (SacWriter *)p;
+    SacWriteFile *f;
+
+    for(;;) {
+	pthread_mutex_lock(&w->lock);
+	while(w->count == 0 && !w->done) {
+	    pthread_cond_wait(&w->added, &w->lock);
+	}
+	if(w->count == 0) {
+	    pthread_mutex_unlock(&w->lock);
+	    break;
+	}
+	f = w->queue[w->head];
+	w->head = (w->head + 1) % SAC_WRITE_QUEUE;
+	w->count--;
+	pthread_cond_signal(&w->taken);
+	pthread_mutex_unlock(&w->lock);
+
+	writeFile(w, f);
+    }
+    return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
 static void
 newSacFile(const char *prefix, const char *sta, const char *chan,
 		char *sac_file, size_t size)
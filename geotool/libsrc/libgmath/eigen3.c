@@ -0,0 +1,223 @@
+#include "config.h"
+#include <stdio.h>
+#include <math.h>
+
+#include "libgmath.h"
+
+static void evecFirst(double a[3][3], double eval, double *evec);
+static void evecPlane(double a[3][3], double *evec0, double *x1,
+			double *x2);
+static void complement(double *w, double *u, double *v);
+static void cross(double *a, double *b, double *c);
+
+/**
+ * Compute eigenvalues and eigenvectors of a symmetric 3 by 3 matrix.
+ * <p>
+ * The eigenvalues are the roots of the characteristic cubic, found in
+ * closed form with the trigonometric solution. The eigenvector of the
+ * eigenvalue that is farthest from the other two is the largest cross
+ * product of the rows of (A - lambda*I). The other two are found with a
+ * plane rotation in the plane orthogonal to the first, so the three are
+ * orthonormal also when two eigenvalues are equal. (D. Eberly, A Robust
+ * Eigensolver for 3x3 Symmetric Matrices, Geometric Tools 2014.) The
+ * eigenvalues are then the Rayleigh quotients of the eigenvectors.
+ * <p>
+ * The results are in the order and layout of tred2() followed by tql2().
+ * <pre>
+ *	double *s	(i) 3 by 3 symmetric matrix s[i+j*3]
+ *	double *d	(o) eigenvalues in ascending order
+ *	double *v	(o) eigenvectors: v[j*3+i] is component i of the
+ *			eigenvector of d[j]
+ * </pre>
+ */
+void
+eigen3(double *s, double *d, double *v)
+{
+	int i, j;
+	double a[3][3], scale, q, p, p1, p2, halfdet, angle, beta[3];
+	double b00, b11, b22, b01, b02, b12;
+
+	for(j = 0, scale = 0.; j < 3; j++) {
+	    for(i = 0; i < 3; i++) {
+		if(fabs(s[i+j*3]) > scale) scale = fabs(s[i+j*3]);
+	    }
+	}
+	for(i = 0; i < 9; i++) v[i] = 0.;
+	v[0] = v[4] = v[8] = 1.;
+
+	if(scale == 0.) {
+	    d[0] = d[1] = d[2] = 0.;
+	    return;
+	}
+
+	/* scale to avoid overflow and underflow */
+	for(j = 0; j < 3; j++) {
+	    for(i = 0; i < 3; i++) a[j][i] = s[i+j*3]/scale;
+	}
+
+	p1 = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+	if(p1 == 0.) {
+	    /* diagonal: sort the diagonal with its unit vectors */
+	    int k[3] = {0, 1, 2}, t;
+	    for(i = 0; i < 2; i++) {
+		for(j = i+1; j < 3; j++) {
+		    if(a[k[j]][k[j]] < a[k[i]][k[i]]) {
+			t = k[i]; k[i] = k[j]; k[j] = t;
+		    }
+		}
+	    }
+	    for(j = 0; j < 3; j++) {
+		d[j] = a[k[j]][k[j]]*scale;
+		for(i = 0; i < 3; i++) v[j*3+i] = (i == k[j]) ? 1. : 0.;
+	    }
+	    return;
+	}
+
+	q = (a[0][0] + a[1][1] + a[2][2])/3.;
+	b00 = a[0][0] - q;
+	b11 = a[1][1] - q;
+	b22 = a[2][2] - q;
+	p2 = b00*b00 + b11*b11 + b22*b22 + 2.*p1;
+	p = sqrt(p2/6.);
+
+	b00 /= p; b11 /= p; b22 /= p;
+	b01 = a[0][1]/p;
+	b02 = a[0][2]/p;
+	b12 = a[1][2]/p;
+	halfdet = .5*(b00*(b11*b22 - b12*b12) - b01*(b01*b22 - b12*b02)
+			+ b02*(b01*b12 - b11*b02));
+	if(halfdet > 1.) halfdet = 1.;
+	else if(halfdet < -1.) halfdet = -1.;
+
+	/* the largest and smallest roots */
+	angle = acos(halfdet)/3.;
+	beta[2] = 2.*cos(angle);
+	beta[0] = 2.*cos(angle + 2.*M_PI/3.);
+
+	if(halfdet >= 0.) {
+	    /* d[2] is the farthest from the others */
+	    evecFirst(a, q + p*beta[2], v+6);
+	    evecPlane(a, v+6, v, v+3);
+	}
+	else {
+	    evecFirst(a, q + p*beta[0], v);
+	    evecPlane(a, v, v+3, v+6);
+	}
+
+	/* The closed-form roots lose about half of their digits when two
+	 * are close. The Rayleigh quotients of the eigenvectors are accurate
+	 * to the square of the eigenvector error. Sort them ascending.
+	 */
+	for(j = 0; j < 3; j++) {
+	    double *x = v+j*3;
+	    d[j] = 0.;
+	    for(i = 0; i < 3; i++) {
+		d[j] += x[i]*(a[i][0]*x[0] + a[i][1]*x[1] + a[i][2]*x[2]);
+	    }
+	}
+	for(j = 1; j < 3; j++) {
+	    for(i = j; i > 0 && d[i] < d[i-1]; i--) {
+		int k;
+		double t = d[i]; d[i] = d[i-1]; d[i-1] = t;
+		for(k = 0; k < 3; k++) {
+		    t = v[i*3+k]; v[i*3+k] = v[(i-1)*3+k]; v[(i-1)*3+k] = t;
+		}
+	    }
+	}
+	for(j = 0; j < 3; j++) d[j] *= scale;
+}
+
+/* The eigenvector of an eigenvalue of multiplicity 1.
+ */
+static void
+evecFirst(double a[3][3], double eval, double *evec)
+{
+	int i, imax;
+	double r0[3], r1[3], r2[3], c[3][3], d[3], dmax;
+
+	for(i = 0; i < 3; i++) {
+	    r0[i] = a[0][i];
+	    r1[i] = a[1][i];
+	    r2[i] = a[2][i];
+	}
+	r0[0] -= eval;
+	r1[1] -= eval;
+	r2[2] -= eval;
+
+	cross(r0, r1, c[0]);
+	cross(r0, r2, c[1]);
+	cross(r1, r2, c[2]);
+	for(i = 0; i < 3; i++) {
+	    d[i] = c[i][0]*c[i][0] + c[i][1]*c[i][1] + c[i][2]*c[i][2];
+	}
+	imax = 0;
+	dmax = d[0];
+	if(d[1] > dmax) { dmax = d[1]; imax = 1; }
+	if(d[2] > dmax) { dmax = d[2]; imax = 2; }
+
+	if(dmax > 0.) {
+	    dmax = 1./sqrt(dmax);
+	    for(i = 0; i < 3; i++) evec[i] = c[imax][i]*dmax;
+	}
+	else {
+	    evec[0] = 1.; evec[1] = 0.; evec[2] = 0.;
+	}
+}
+
+/* The eigenvectors x1 and x2 that are orthogonal to evec0, from a Jacobi
+ * rotation of the 2 by 2 matrix of a in the plane orthogonal to evec0.
+ */
+static void
+evecPlane(double a[3][3], double *evec0, double *x1, double *x2)
+{
+	int i;
+	double u[3], v[3], au[3], av[3], m00, m01, m11, theta, c, s;
+
+	complement(evec0, u, v);
+
+	for(i = 0; i < 3; i++) {
+	    au[i] = a[i][0]*u[0] + a[i][1]*u[1] + a[i][2]*u[2];
+	    av[i] = a[i][0]*v[0] + a[i][1]*v[1] + a[i][2]*v[2];
+	}
+	m00 = u[0]*au[0] + u[1]*au[1] + u[2]*au[2];
+	m01 = u[0]*av[0] + u[1]*av[1] + u[2]*av[2];
+	m11 = v[0]*av[0] + v[1]*av[1] + v[2]*av[2];
+
+	theta = .5*atan2(2.*m01, m00 - m11);
+	c = cos(theta);
+	s = sin(theta);
+	for(i = 0; i < 3; i++) {
+	    x1[i] =  c*u[i] + s*v[i];
+	    x2[i] = -s*u[i] + c*v[i];
+	}
+}
+
+/* Unit vectors u and v that make w,u,v an orthonormal set.
+ */
+static void
+complement(double *w, double *u, double *v)
+{
+	double f;
+
+	if(fabs(w[0]) > fabs(w[1])) {
+	    f = 1./sqrt(w[0]*w[0] + w[2]*w[2]);
+	    u[0] = -w[2]*f;
+	    u[1] = 0.;
+	    u[2] = w[0]*f;
+	}
+	else {
+	    f = 1./sqrt(w[1]*w[1] + w[2]*w[2]);
+	    u[0] = 0.;
+	    u[1] = w[2]*f;
+	    u[2] = -w[1]*f;
+	}
+	cross(w, u, v);
+}
+
+static void
+cross(double *a, double *b, double *c)
+{
+	c[0] = a[1]*b[2] - a[2]*b[1];
+	c[1] = a[2]*b[0] - a[0]*b[2];
+	c[2] = a[0]*b[1] - a[1]*b[0];
+}
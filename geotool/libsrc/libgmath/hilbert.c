@@ -2,12 +2,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 #ifdef HAVE_GSL
 #include "gsl/gsl_fft_real.h"
 #include "gsl/gsl_fft_halfcomplex.h"
 #endif
 #include "libgmath.h"
 
+#ifdef HAVE_GSL
+static int hilbertWhole(AnalyticWork *w, int npts, float *data);
+static void hilbertBlocks(AnalyticWork *w, int npts, float *data, double dt,
+		float *hilbert, float *envelope, float *phase, float *freq);
+static void attributes(int s, int e, int npts, float *data, double *h,
+		double dt, double *hlast, float *hilbert, float *envelope,
+		float *phase, float *freq);
+#endif
+static int growScratch(AnalyticWork *w, int size);
+
 /**
  * Hilbert tranformation.
  */
@@ -16,36 +27,303 @@ int
 Hilbert_data(int npts, float *data)
 {
 #ifdef HAVE_GSL
-	int	i, np2, n2;
-	double	re, im, *x=NULL;
+	AnalyticWork *w;
+	int i;
+
+	if( !(w = analytic_work(0, 0)) ) return -1;
+
+	if(hilbertWhole(w, npts, data)) {
+	    analytic_free(w);
+	    return -1;
+	}
+	for(i = 0; i < npts; i++) data[i] = w->x[i];
+
+	analytic_free(w);
+
+	return 0;
+#else
+fprintf(stderr, "Operation unavailable without libgsl.\n");
+return -1;
+#endif
+}
+
+/**
+ * Allocate the work space for analytic_signal().
+ * <p>
+ * If block is 0, each trace is transformed whole, zero-padded to a power
+ * of two, as by Hilbert_data(). The FFT scratch is kept and only grown, so
+ * the traces of a batch share it.
+ * <p>
+ * If block > 0, long traces are processed in overlap-save blocks of block
+ * points (rounded up to a power of two) with a FIR Hilbert filter of
+ * 2*half+1 coefficients (a Hamming-windowed ideal filter), so the memory
+ * does not depend on the trace length. Each block gives block - 2*half
+ * output points. If half <= 0, half is block/8.
+ * @param block The overlap-save FFT length, or 0.
+ * @param half The half-length of the FIR filter, when block > 0.
+ * @return the work space, or NULL if memory cannot be allocated.
+ */
+AnalyticWork *
+analytic_work(int block, int half)
+{
+	AnalyticWork *w;
+	int j, k, n;
+	double h, theta, sum;
+
+	if( !(w = (AnalyticWork *)malloc(sizeof(AnalyticWork))) ) return NULL;
+
+	w->block = 0;
+	w->half = 0;
+	w->size = 0;
+	w->x = NULL;
+	w->b = NULL;
+
+	if(block <= 0) return w;
+
+	for(n = 2; n < block; n *= 2);
+	if(half <= 0) half = n/8;
+	while(n <= 4*half) n *= 2;
+	w->block = n;
+	w->half = half;
+
+	if( growScratch(w, n) ||
+		!(w->b = (double *)malloc((n/2+1)*sizeof(double))) )
+	{
+	    analytic_free(w);
+	    return NULL;
+	}
+
+	/* The filter is odd, so its spectrum is imaginary:
+	 * H[j] = -2i sum_k h[k] sin(2 pi j k/n), h[k] = 2/(pi k), k odd.
+	 */
+	for(j = 0; j <= n/2; j++) {
+	    theta = 2.*M_PI*j/n;
+	    for(k = 1, sum = 0.; k <= half; k += 2) {
+		h = 2./(M_PI*k) * (0.54 + 0.46*cos(M_PI*k/half));
+		sum += h*sin(theta*k);
+	    }
+	    w->b[j] = -2.*sum;
+	}
+	return w;
+}
+
+/**
+ * Free the work space from analytic_work().
+ */
+void
+analytic_free(AnalyticWork *w)
+{
+	if(w) {
+	    free(w->x);
+	    free(w->b);
+	    free(w);
+	}
+}
+
+/**
+ * Compute the analytic signal of a trace and its attributes.
+ * <p>
+ * The analytic signal is z = data + i*hilbert. The outputs are
+ * <pre>
+ *	hilbert		the Hilbert transform of data
+ *	envelope	|z|
+ *	phase		the instantaneous phase, atan2(hilbert, data) (radians)
+ *	freq		the instantaneous frequency (Hz), from the phase
+ *			difference of the neighbouring samples
+ * </pre>
+ * Any output can be NULL. When w->block is 0, hilbert can be data.
+ * @param w The work space from analytic_work().
+ * @param npts The number of samples.
+ * @param data The trace.
+ * @param dt The sample interval.
+ * @return 0 for success, -1 if memory cannot be allocated or libgsl is
+ * unavailable.
+ */
+int
+analytic_signal(AnalyticWork *w, int npts, float *data, double dt,
+		float *hilbert, float *envelope, float *phase, float *freq)
+{
+#ifdef HAVE_GSL
+	double hlast[2] = {0., 0.};
+
+	if(npts <= 0) return 0;
+
+	if(w->block > 0) {
+	    hilbertBlocks(w, npts, data, dt, hilbert, envelope, phase, freq);
+	}
+	else {
+	    if(hilbertWhole(w, npts, data)) return -1;
+	    attributes(0, npts, npts, data, w->x, dt, hlast, NULL,
+			envelope, phase, freq);
+	    if(hilbert) {
+		int i;
+		for(i = 0; i < npts; i++) hilbert[i] = w->x[i];
+	    }
+	}
+	return 0;
+#else
+fprintf(stderr, "Operation unavailable without libgsl.\n");
+return -1;
+#endif
+}
+
+/**
+ * Compute the analytic signal and its attributes for a number of traces
+ * with the same sample interval. The FFT scratch and filter are set up
+ * once for all the traces. The arguments are those of analytic_work()
+ * and analytic_signal(), with one element for each trace. Any of the
+ * output arrays can be NULL.
+ * @return 0 for success, -1 for error.
+ */
+int
+analytic_batch(int ntraces, int *npts, float **data, double dt, int block,
+		int half, float **hilbert, float **envelope, float **phase,
+		float **freq)
+{
+	AnalyticWork *w;
+	int i, ret = 0;
+	if( !(w = analytic_work(block, half)) ) return -1;
+	for(i = 0; i < ntraces && !ret; i++) {
+	    ret = analytic_signal(w, npts[i], data[i], dt,
+			hilbert ? hilbert[i] : NULL, envelope ? envelope[i] : NULL,
+			phase ? phase[i] : NULL, freq ? freq[i] : NULL);
+	}
+	analytic_free(w);
+	return ret;
+}
+
+/* Grow the FFT scratch w->x to at least size points.
+ */
+static int
+growScratch(AnalyticWork *w, int size)
+{
+	double *x;
+
+	if(size <= w->size) return 0;
+	if( !(x = (double *)realloc(w->x, size*sizeof(double))) ) return -1;
+	w->x = x;
+	w->size = size;
+	return 0;
+}
+
+#ifdef HAVE_GSL
+/* The Hilbert transform of the whole trace in w->x[0..npts-1].
+ */
+static int
+hilbertWhole(AnalyticWork *w, int npts, float *data)
+{
+	int i, np2, n2;
+	double re, im, *x;
 
 	for(np2 = 2; np2 < npts; np2 *= 2);
 	n2 = np2/2;
 
-	if( !(x = (double *)malloc(np2*sizeof(double))) ) return -1;
+	if(growScratch(w, np2)) return -1;
+	x = w->x;
 
 	for(i = 0; i < npts; i++) x[i] = data[i];
 	for(i = npts; i < np2; i++) x[i] = 0.;
 
 	gsl_fft_real_radix2_transform(x, 1, np2);
 
-	x[0] = x[np2-1] = 0.;
+	/* multiply by -i*sign(f); zero the DC and Nyquist terms */
+	x[0] = x[n2] = 0.;
 	for(i = 1; i < n2; i++) {
 	    re = x[i];
-	    im = x[np2-1-i];
+	    im = x[np2-i];
 	    x[i] = im;
-	    x[np2-1-i] = -re;
+	    x[np2-i] = -re;
 	}
 
 	gsl_fft_halfcomplex_radix2_inverse(x, 1, np2);
 
-	for(i = 0; i < npts; i++) data[i] = x[i];
+	return 0;
+}
 
-	if(x) free(x);
+/* Overlap-save with the FIR filter of analytic_work(). The block that
+ * starts at input sample s-half gives the output samples s to
+ * s+block-2*half-1.
+ */
+static void
+hilbertBlocks(AnalyticWork *w, int npts, float *data, double dt,
+		float *hilbert, float *envelope, float *phase, float *freq)
+{
+	int i, j, k, s, e, n = w->block, half = w->half, step;
+	double re, im, *x = w->x, hlast[2] = {0., 0.};
 
-	return 0;
-#else
-fprintf(stderr, "Operation unavailable without libgsl.\n");
-return -1;
-#endif
+	step = n - 2*half;
+
+	for(s = 0; s < npts; s += step)
+	{
+	    for(i = 0, k = s - half; i < n; i++, k++) {
+		x[i] = (k >= 0 && k < npts) ? data[k] : 0.;
+	    }
+	    gsl_fft_real_radix2_transform(x, 1, n);
+
+	    x[0] = x[n/2] = 0.;
+	    for(j = 1; j < n/2; j++) {
+		re = x[j];
+		im = x[n-j];
+		x[j] = -im*w->b[j];
+		x[n-j] = re*w->b[j];
+	    }
+	    gsl_fft_halfcomplex_radix2_inverse(x, 1, n);
+
+	    e = (s + step < npts) ? s + step : npts;
+	    attributes(s, e, npts, data, x + half, dt, hlast, hilbert,
+			envelope, phase, freq);
+	}
 }
+
+/* The attributes of samples s to e-1, whose Hilbert transform is in
+ * h[0..e-s-1]. The frequency of a sample needs the next sample, so it
+ * is set for samples s-1 to e-2, and for e-1 when e is npts. hlast keeps
+ * the Hilbert transform of the last two samples of the previous call.
+ */
+static void
+attributes(int s, int e, int npts, float *data, double *h, double dt,
+		double *hlast, float *hilbert, float *envelope, float *phase,
+		float *freq)
+{
+	int n;
+	double hn, h1, h2, re, im, scale;
+
+	h1 = (s > 0) ? hlast[1] : 0.;	/* h[n-1] */
+	h2 = (s > 1) ? hlast[0] : 0.;	/* h[n-2] */
+	scale = (dt > 0.) ? 1./(2.*M_PI*dt) : 0.;
+
+	for(n = s; n < e; n++)
+	{
+	    hn = h[n-s];
+	    if(hilbert) hilbert[n] = hn;
+	    if(envelope) envelope[n] = sqrt(data[n]*data[n] + hn*hn);
+	    if(phase) phase[n] = atan2(hn, data[n]);
+
+	    if(freq && n > 0) {
+		/* arg(z[n] * conj(z[n-2])) over 2 samples, or z[1]*conj(z[0])
+		 */
+		int m = (n > 1) ? n-2 : n-1;
+		double hm = (n > 1) ? h2 : h1;
+		re = data[n]*data[m] + hn*hm;
+		im = hn*data[m] - data[n]*hm;
+		freq[n-1] = atan2(im, re)*scale/(n-m);
+	    }
+	    h2 = h1;
+	    h1 = hn;
+	}
+	hlast[0] = h2;
+	hlast[1] = h1;
+
+	if(freq && e == npts) {
+	    if(npts > 1) {
+		n = npts - 1;
+		re = data[n]*data[n-1] + h1*h2;
+		im = h1*data[n-1] - data[n]*h2;
+		freq[n] = atan2(im, re)*scale;
+	    }
+	    else {
+		freq[0] = 0.;
+	    }
+	}
+}
+#endif
@@ -0,0 +1,163 @@
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "libgmath.h"
+#include "libstring.h"
+
+/* Windows given to a thread at a time. Each piece starts with a full
+ * covariance sum, which also keeps the rounding of the running sums from
+ * growing.
+ */
+#define POLAR_PIECE		8192
+
+typedef struct
+{
+	int	npts;
+	float	*e, *n, *z;
+	int	window_pts;
+	double	(*c)[3];
+	float	*recti, *az, *incidence;
+	int	piece;
+	int	nwin;
+} PolarWork;
+
+static void polarPiece(int k, int thread, void *arg);
+
+/**
+ * Compute polarization attributes for a sliding window.
+ * <p>
+ * The 3-component covariance matrix of a window of window_pts samples is
+ * computed as by covar() at every sample, by adding the products of the
+ * sample that enters the window to running sums and subtracting those of
+ * the sample that leaves it. Each matrix is diagonalized with eigen3().
+ * The windows are divided among num_threads threads by
+ * parallel_run_thread().
+ * <p>
+ * Window k covers samples k to k+window_pts-1. The attributes of the
+ * eigenvector v of the largest eigenvalue are those of the Polarization
+ * plugin:
+ * <pre>
+ *	recti		1 - (d[0] + d[1])/(2*d[2])
+ *	az		azimuth of v from north (degrees)
+ *	incidence	angle of v from vertical (degrees)
+ *
+ *	int npts	number of samples of e, n, z
+ *	float *e,*n,*z	the three components
+ *	int window_pts	samples per window
+ *	double c[3][3]	rotation from the e,n,z components to east, north,
+ *			up, or NULL if they are east, north, up.
+ *	int num_threads	number of threads, or <= 0 for one per processor
+ *	float *recti	(o) npts-window_pts+1 values or NULL
+ *	float *az	(o) npts-window_pts+1 values or NULL
+ *	float *incidence (o) npts-window_pts+1 values or NULL
+ * </pre>
+ * @return the number of windows, npts-window_pts+1, or 0 if npts <
+ * window_pts.
+ */
+int
+polar_trace(int npts, float *e, float *n, float *z, int window_pts,
+		double c[3][3], int num_threads, float *recti, float *az,
+		float *incidence)
+{
+	PolarWork w;
+	int nwin, npieces;
+
+	if(window_pts <= 0 || npts < window_pts) return 0;
+
+	nwin = npts - window_pts + 1;
+
+	w.npts = npts;
+	w.e = e;
+	w.n = n;
+	w.z = z;
+	w.window_pts = window_pts;
+	w.c = c;
+	w.recti = recti;
+	w.az = az;
+	w.incidence = incidence;
+	w.nwin = nwin;
+	/* keep the full sums a small part of the work */
+	w.piece = (window_pts > POLAR_PIECE) ? window_pts : POLAR_PIECE;
+	npieces = (nwin + w.piece - 1)/w.piece;
+
+	parallel_run_thread(npieces, num_threads, polarPiece, &w);
+
+	return nwin;
+}
+
+static void
+polarPiece(int k, int thread, void *arg)
+{
+	PolarWork *w = (PolarWork *)arg;
+	int i, l, l1, l2, sgn;
+	float *e = w->e, *n = w->n, *z = w->z;
+	double ee, nn, zz, en, ez, nz, scale;
+	double s[9], d[3], v[9], vx, vy, vz;
+	double (*c)[3] = w->c;
+
+	l1 = k*w->piece;
+	l2 = l1 + w->piece;
+	if(l2 > w->nwin) l2 = w->nwin;
+
+	/* the full sums of the first window of the piece */
+	ee = nn = zz = en = ez = nz = 0.;
+	for(i = l1; i < l1 + w->window_pts; i++) {
+	    ee += (double)e[i]*e[i];
+	    nn += (double)n[i]*n[i];
+	    zz += (double)z[i]*z[i];
+	    en += (double)e[i]*n[i];
+	    ez += (double)e[i]*z[i];
+	    nz += (double)n[i]*z[i];
+	}
+	scale = 1./w->window_pts;
+
+	for(l = l1; l < l2; l++)
+	{
+	    if(l > l1) {
+		/* slide: sample l-1 leaves, sample i enters */
+		int j = l - 1;
+		i = l + w->window_pts - 1;
+		ee += (double)e[i]*e[i] - (double)e[j]*e[j];
+		nn += (double)n[i]*n[i] - (double)n[j]*n[j];
+		zz += (double)z[i]*z[i] - (double)z[j]*z[j];
+		en += (double)e[i]*n[i] - (double)e[j]*n[j];
+		ez += (double)e[i]*z[i] - (double)e[j]*z[j];
+		nz += (double)n[i]*z[i] - (double)n[j]*z[j];
+	    }
+	    s[0] = ee*scale;
+	    s[4] = nn*scale;
+	    s[8] = zz*scale;
+	    s[1] = s[3] = en*scale;
+	    s[2] = s[6] = ez*scale;
+	    s[5] = s[7] = nz*scale;
+
+	    eigen3(s, d, v);
+	    for(i = 0; i < 3; i++) if(d[i] < 0.) d[i] = 0.;
+
+	    if(w->recti) {
+		w->recti[l] = (d[2] == 0.) ? 0. : 1. - .5*(d[0] + d[1])/d[2];
+	    }
+	    /* If the components are not E,N,UP, then find the coordinates
+	     * of the eigenvector v[6],v[7],v[8] in the E,N,UP system.
+	     */
+	    if(c) {
+		vx = c[0][0]*v[6] + c[0][1]*v[7] + c[0][2]*v[8];
+		vy = c[1][0]*v[6] + c[1][1]*v[7] + c[1][2]*v[8];
+		vz = c[2][0]*v[6] + c[2][1]*v[7] + c[2][2]*v[8];
+		v[6] = vx;
+		v[7] = vy;
+		v[8] = vz;
+	    }
+	    if(w->az) {
+		sgn = (v[8] > 0.) ? -1 : 1;
+		w->az[l] = atan2(sgn*v[6], sgn*v[7])*180./M_PI;
+	    }
+	    if(w->incidence) {
+		vz = fabs(v[8]);
+		if(vz > 1.) vz = 1.;
+		w->incidence[l] = acos(vz)*180./M_PI;
+	    }
+	}
+}
@@ -0,0 +1,506 @@
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include "libgmath.h"
+
+/* Events are kept in chunks, so that a thread's buffer grows without
+ * moving the events already recorded.
+ */
+#define PROFILE_CHUNK		4096
+
+/* The most events kept for one thread between profile_start calls. Later
+ * events are counted as dropped.
+ */
+#define PROFILE_MAX_EVENTS	(256*PROFILE_CHUNK)
+
+typedef struct
+{
+	const char	*stage;
+	long long	t0;	/* profile_clock() at the start and end */
+	long long	t1;
+} ProfileEvent;
+
+typedef struct ProfileChunk_s
+{
+	int			n;
+	ProfileEvent		e[PROFILE_CHUNK];
+	struct ProfileChunk_s	*next;
+} ProfileChunk;
+
+/* The events of one thread. Only the owning thread adds events. The lock
+ * keeps a report from reading a chunk as it is added.
+ */
+typedef struct ProfileBuffer_s
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t		lock;
+#endif
+	int			tid;
+	int			nevents;
+	int			dropped;
+	ProfileChunk		*first;
+	ProfileChunk		*last;
+	struct ProfileBuffer_s	*next;
+} ProfileBuffer;
+
+typedef struct ProfileName_s
+{
+	char			*name;
+	struct ProfileName_s	*next;
+} ProfileName;
+
+typedef struct
+{
+	const char	*stage;
+	int		count;
+	long long	total;
+	long long	max;
+} ProfileStage;
+
+/** Non-zero between profile_start() and profile_stop(). It is read and
+ * written with the __sync builtins, as by PROFILE_RUNNING().
+ */
+int profile_running = 0;
+
+static long long profile_t0 = 0;
+static ProfileBuffer *buffers = NULL;
+static ProfileBuffer *retired = NULL;
+static int num_buffers = 0;
+static ProfileName *names = NULL;
+
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t buffers_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t names_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t buffer_key;
+static pthread_once_t buffer_once = PTHREAD_ONCE_INIT;
+
+static void retireBuffer(void *arg);
+
+static void
+makeKey(void)
+{
+	pthread_key_create(&buffer_key, retireBuffer);
+}
+#endif
+
+static ProfileBuffer *getBuffer(void);
+static void clearBuffer(ProfileBuffer *b);
+static void writeString(FILE *fp, const char *s);
+static int sortStages(const void *A, const void *B);
+
+/**
+ * Return a nanosecond clock. The clock is monotonic when clock_gettime is
+ * available.
+ */
+long long
+profile_clock(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec*1000000000LL + ts.tv_nsec;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (long long)tv.tv_sec*1000000000LL + tv.tv_usec*1000LL;
+#endif
+}
+
+/**
+ * Start recording profile events. The events of a previous start are
+ * discarded, as by profile_reset().
+ */
+void
+profile_start(void)
+{
+	profile_reset();
+	__sync_fetch_and_or(&profile_running, 1);
+}
+
+/**
+ * Stop recording profile events. The recorded events are kept for
+ * profile_report() and profile_trace().
+ */
+void
+profile_stop(void)
+{
+	__sync_fetch_and_and(&profile_running, 0);
+}
+
+/**
+ * Discard the recorded events. The buffers of the threads that have exited
+ * are freed. The buffers of the running threads are emptied and kept.
+ */
+void
+profile_reset(void)
+{
+	ProfileBuffer *b, *next;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&buffers_lock);
+#endif
+	for(b = buffers; b != NULL; b = b->next) {
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_lock(&b->lock);
+#endif
+	    clearBuffer(b);
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_unlock(&b->lock);
+#endif
+	}
+	for(b = retired; b != NULL; b = next) {
+	    next = b->next;
+	    clearBuffer(b);
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_destroy(&b->lock);
+#endif
+	    free(b);
+	}
+	retired = NULL;
+	profile_t0 = profile_clock();
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&buffers_lock);
+#endif
+}
+
+/**
+ * Return a copy of a stage name that is kept for the life of the program.
+ * It is for stage names that are not static strings, such as the name of
+ * a class instance. The same copy is returned for the same name.
+ * @return the copy, or NULL if malloc fails.
+ */
+const char *
+profile_name(const char *name)
+{
+	ProfileName *p;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&names_lock);
+#endif
+	for(p = names; p != NULL && strcmp(p->name, name); p = p->next);
+
+	if(!p && (p = (ProfileName *)malloc(sizeof(ProfileName))) ) {
+	    if( (p->name = strdup(name)) ) {
+		p->next = names;
+		names = p;
+	    }
+	    else {
+		free(p);
+		p = NULL;
+	    }
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&names_lock);
+#endif
+	return p ? p->name : NULL;
+}
+
+/**
+ * Record the time of one call of a stage, in the buffer of the calling
+ * thread. Nothing is recorded if the profile is not running.
+ * <pre>
+ *	const char *stage	the stage name. It must be a static string or
+ *				a name from profile_name().
+ *	long long t0		profile_clock() at the start of the call
+ *	long long t1		profile_clock() at the end of the call
+ * </pre>
+ */
+void
+profile_record(const char *stage, long long t0, long long t1)
+{
+	ProfileBuffer *b;
+	ProfileChunk *c;
+
+	if(!PROFILE_RUNNING() || !stage || !(b = getBuffer())) return;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&b->lock);
+#endif
+	if(b->nevents >= PROFILE_MAX_EVENTS) {
+	    b->dropped++;
+	}
+	else {
+	    if(!b->last || b->last->n == PROFILE_CHUNK) {
+		if( !(c = (ProfileChunk *)malloc(sizeof(ProfileChunk))) ) {
+		    b->dropped++;
+#ifdef HAVE_PTHREAD
+		    pthread_mutex_unlock(&b->lock);
+#endif
+		    return;
+		}
+		c->n = 0;
+		c->next = NULL;
+		if(b->last) b->last->next = c;
+		else b->first = c;
+		b->last = c;
+	    }
+	    c = b->last;
+	    c->e[c->n].stage = stage;
+	    c->e[c->n].t0 = t0;
+	    c->e[c->n].t1 = t1;
+	    c->n++;
+	    b->nevents++;
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&b->lock);
+#endif
+}
+
+/**
+ * Print the number of calls and the total, mean and maximum times of each
+ * stage, with the stages that took the most time first.
+ * @return the number of events.
+ */
+int
+profile_report(FILE *fp)
+{
+	ProfileBuffer *b;
+	ProfileChunk *c;
+	ProfileEvent *e;
+	ProfileStage *s = NULL, *ptr;
+	int i, j, k, nstages = 0, size = 0, nevents = 0, dropped = 0;
+	long long dt;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&buffers_lock);
+#endif
+	/* the running threads, then the threads that have exited */
+	for(k = 0; k < 2; k++)
+	for(b = (k == 0) ? buffers : retired; b != NULL; b = b->next)
+	{
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_lock(&b->lock);
+#endif
+	    for(c = b->first; c != NULL; c = c->next) {
+		for(i = 0; i < c->n; i++) {
+		    e = &c->e[i];
+		    /* the same name can be at different addresses in
+		     * different libraries.
+		     */
+		    for(j = 0; j < nstages && strcmp(s[j].stage, e->stage); j++);
+		    if(j == nstages) {
+			if(nstages == size) {
+			    size += 32;
+			    ptr = (ProfileStage *)realloc(s,
+					size*sizeof(ProfileStage));
+			    if(!ptr) {
+				size -= 32;
+				continue;
+			    }
+			    s = ptr;
+			}
+			s[j].stage = e->stage;
+			s[j].count = 0;
+			s[j].total = 0;
+			s[j].max = 0;
+			nstages++;
+		    }
+		    dt = e->t1 - e->t0;
+		    s[j].count++;
+		    s[j].total += dt;
+		    if(dt > s[j].max) s[j].max = dt;
+		}
+	    }
+	    nevents += b->nevents;
+	    dropped += b->dropped;
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_unlock(&b->lock);
+#endif
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&buffers_lock);
+#endif
+
+	if(nstages > 1) qsort(s, nstages, sizeof(ProfileStage), sortStages);
+
+	fprintf(fp, "%-32s %9s %12s %12s %12s\n", "stage", "count",
+		"total(ms)", "mean(ms)", "max(ms)");
+	for(j = 0; j < nstages; j++) {
+	    fprintf(fp, "%-32s %9d %12.3f %12.3f %12.3f\n", s[j].stage,
+		s[j].count, 1.e-06*s[j].total, 1.e-06*s[j].total/s[j].count,
+		1.e-06*s[j].max);
+	}
+	if(dropped > 0) {
+	    fprintf(fp, "%d events dropped\n", dropped);
+	}
+	fflush(fp);
+	if(s) free(s);
+
+	return nevents;
+}
+
+/**
+ * Write the recorded events as a Chrome trace (the JSON Trace Event
+ * Format read by chrome://tracing and Perfetto). Each event is a complete
+ * event with its start and duration in microseconds and the thread that
+ * recorded it.
+ * @return 0 for success, -1 if the file cannot be written.
+ */
+int
+profile_trace(const char *file)
+{
+	FILE *fp;
+	ProfileBuffer *b;
+	ProfileChunk *c;
+	ProfileEvent *e;
+	int i, k, n = 0, ret = 0;
+
+	if( !(fp = fopen(file, "w")) ) {
+	    fprintf(stderr, "profile_trace: cannot open %s\n%s\n", file,
+			strerror(errno));
+	    return -1;
+	}
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&buffers_lock);
+#endif
+	for(k = 0; k < 2; k++)
+	for(b = (k == 0) ? buffers : retired; b != NULL; b = b->next)
+	{
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_lock(&b->lock);
+#endif
+	    for(c = b->first; c != NULL; c = c->next) {
+		for(i = 0; i < c->n; i++) {
+		    e = &c->e[i];
+		    fprintf(fp, "%s\n{\"name\":", (n > 0) ? "," : "");
+		    writeString(fp, e->stage);
+		    fprintf(fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\
+\"dur\":%.3f}", b->tid, 1.e-03*(e->t0 - profile_t0), 1.e-03*(e->t1 - e->t0));
+		    n++;
+		}
+	    }
+#ifdef HAVE_PTHREAD
+	    pthread_mutex_unlock(&b->lock);
+#endif
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&buffers_lock);
+#endif
+
+	fprintf(fp, "\n]}\n");
+	if(ferror(fp)) ret = -1;
+	if(fclose(fp)) ret = -1;
+	if(ret) {
+	    fprintf(stderr, "profile_trace: error writing %s\n", file);
+	}
+	return ret;
+}
+
+/* Return the buffer of the calling thread, making it on the first call.
+ */
+static ProfileBuffer *
+getBuffer(void)
+{
+	ProfileBuffer *b;
+
+#ifdef HAVE_PTHREAD
+	pthread_once(&buffer_once, makeKey);
+	if( (b = (ProfileBuffer *)pthread_getspecific(buffer_key)) ) return b;
+#else
+	if(buffers) return buffers;
+#endif
+	if( !(b = (ProfileBuffer *)malloc(sizeof(ProfileBuffer))) ) return NULL;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_init(&b->lock, NULL);
+	pthread_setspecific(buffer_key, b);
+#endif
+	b->nevents = 0;
+	b->dropped = 0;
+	b->first = NULL;
+	b->last = NULL;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&buffers_lock);
+#endif
+	b->tid = ++num_buffers;
+	b->next = buffers;
+	buffers = b;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&buffers_lock);
+#endif
+	return b;
+}
+
+#ifdef HAVE_PTHREAD
+/* The destructor of buffer_key. The buffer of an exiting thread is moved to
+ * the retired list, so that its events are still reported. It is freed by
+ * profile_reset().
+ */
+static void
+retireBuffer(void *arg)
+{
+	ProfileBuffer *b = (ProfileBuffer *)arg, **p;
+
+	pthread_mutex_lock(&buffers_lock);
+	for(p = &buffers; *p != NULL && *p != b; p = &(*p)->next);
+	if(*p) {
+	    *p = b->next;
+	    b->next = retired;
+	    retired = b;
+	}
+	pthread_mutex_unlock(&buffers_lock);
+}
+#endif
+
+static void
+clearBuffer(ProfileBuffer *b)
+{
+	ProfileChunk *c, *next;
+
+	for(c = b->first; c != NULL; c = next) {
+	    next = c->next;
+	    free(c);
+	}
+	b->first = NULL;
+	b->last = NULL;
+	b->nevents = 0;
+	b->dropped = 0;
+}
+
+/* Write s as a JSON string, with quotes, backslashes and control characters
+ * escaped.
+ */
+static void
+writeString(FILE *fp, const char *s)
+{
+	const unsigned char *c;
+
+	putc('"', fp);
+	for(c = (const unsigned char *)s; *c != '\0'; c++) {
+	    switch(*c) {
+		case '"':  fputs("\\\"", fp); break;
+		case '\\': fputs("\\\\", fp); break;
+		case '\b': fputs("\\b", fp); break;
+		case '\f': fputs("\\f", fp); break;
+		case '\n': fputs("\\n", fp); break;
+		case '\r': fputs("\\r", fp); break;
+		case '\t': fputs("\\t", fp); break;
+		default:
+		    if(*c < 0x20) fprintf(fp, "\\u%04x", *c);
+		    else putc(*c, fp);
+	    }
+	}
+	putc('"', fp);
+}
+
+static int
+sortStages(const void *A, const void *B)
+{
+	const ProfileStage *a = (const ProfileStage *)A;
+	const ProfileStage *b = (const ProfileStage *)B;
+
+	if(a->total > b->total) return -1;
+	if(a->total < b->total) return 1;
+	return strcmp(a->stage, b->stage);
+}
@@ -71,6 +71,7 @@ bool AmpData::applyMethod(int n, GTimeSeries **ts)
 void AmpData::ampSegment(GSegment *s, double factor)
 {
     int n = s->length();
+    s->unshare();
     for(int i = 0; i < n; i++) {
 	s->data[i] *= factor;
     }
@@ -62,6 +62,7 @@ void CalibData::calibSegment(GSegment *s)
     double cal = s->calib();
     if(cal != 0.0 && cal != 1.0) {
 	int n = s->length();
+	s->unshare();
 	float *d = s->data;
 	for(int i = 0; i < n; i++, d++) {
 	    *d *= cal;
@@ -48,6 +48,7 @@ bool Demean::applyMethod(int n, GTimeSeries **ts)
     for(int k = 0; k < n; k++)
     {
 	mean = ts[k]->mean();
+	ts[k]->unshare();
 	for(int j = 0; j < ts[k]->size(); j++) {
 	    int npts = ts[k]->segment(j)->length();
 	    for(int i = 0; i < npts; i++) {
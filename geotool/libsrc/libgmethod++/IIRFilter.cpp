@@ -436,6 +436,7 @@ void IIRFilter::applyMethod(GTimeSeries *ts)
  */
 void IIRFilter::applyMethod(GSegment *s, bool reset)
 {
+    s->unshare();
     applyMethod(s->data, s->length(), reset);
 }
 
@@ -72,6 +72,7 @@ bool OffsetData::applyMethod(int n, GTimeSeries **ts)
 void OffsetData::offsetSegment(GSegment *s, double offset)
 {
     int n = s->length();
+    s->unshare();
     for(int i = 0; i < n; i++) {
 	s->data[i] += offset;
     }
@@ -144,7 +144,9 @@ bool TaperData::applyMethod(GTimeSeries *ts)
     if(!type.compare("none")) {
 	return false;
     }
-    else if(!type.compare("hamming")) {
+    ts->unshare();
+
+    if(!type.compare("hamming")) {
 	for(i = 0; i < ts->size(); i++) {
 	    Taper_hamm(ts->segment(i)->data, ts->segment(i)->length());
 	}
@@ -7,6 +7,9 @@
 #include <errno.h>
 #include <string.h>
 #include <sys/param.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "gobject++/CssTableClass.h"
 #include "gobject++/DataSource.h"
@@ -105,14 +108,23 @@ static void trim(char *s);
 
 extern "C" {
 static int sort_names(const void *a, const void *b);
-static int sort_by_string(const void *a, const void *b);
-static int sort_by_date(const void *a, const void *b);
-static int sort_by_long(const void *a, const void *b);
-static int sort_by_int(const void *a, const void *b);
-static int sort_by_double(const void *a, const void *b);
-static int sort_by_float(const void *a, const void *b);
+static int sort_by_rank(const void *a, const void *b);
 }
 static void storeTable(CssTableClass *table);
+static void free_find_index(void);
+static CssTableClass *findIndexed(gvector<CssTableClass *> &tables,
+		int offset, long value);
+
+#ifdef HAVE_PTHREAD
+/* find can be called from worker threads, which share the indexes */
+static pthread_mutex_t find_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_FIND_INDEX	pthread_mutex_lock(&find_lock)
+#define UNLOCK_FIND_INDEX pthread_mutex_unlock(&find_lock)
+#else
+#define LOCK_FIND_INDEX
+#define UNLOCK_FIND_INDEX
+#endif
+
 static void removeTable(CssTableClass *table);
 
 
@@ -248,6 +260,9 @@ void CssTableClass::cleanUp(void)
 //    Free(ids);
 //    num_ids = 0;
     Free(tables)
+    LOCK_FIND_INDEX;
+    free_find_index();
+    UNLOCK_FIND_INDEX;
 
     if(table_defs) {
 	for(i = 0; i < num_table_defs; i++) {
@@ -1740,173 +1755,568 @@ void CssTableClass::copySourceTo(CssTableClass *dest, int id)
     }
 }
 
-static int member_offset;
+/* The sort key of a member is one or two 32-bit words for each record. The
+ * words compare as unsigned integers in the order of the member values, so
+ * the records can be radix sorted without a comparison function.
+ */
+typedef struct
+{
+    int nwords;
+    unsigned int *w[2];	/* w[0] is the most significant word */
+} SortKey;
 
-/**
- * Sort a Vector of CssTableClass objects by the specified member. Possible errors
- * are a bad Vector object, Vector objects are not all the same CssTableClass,
- * invalid member_name and unknown member type. logErrorMsg is called before
- * a error (nonzero) return.
- * @param tables a Vector containing CssTableClass objects.
- * @param member_name The table member that will be sorted.
- * @return 0 for success, nonzero for an error condition.
+/* A string and its record, sorted to rank the strings. The string is kept
+ * with the record, so that no static state is shared by concurrent sorts.
  */
-int CssTableClass::sort(gvector<CssTableClass *> &tables, const string &member_name)
+typedef struct
 {
-    int i, name, num = tables.size();
-    bool quark = false;
-    CssTableClass *table;
-    CssClassDescription *des;
+    const char *s;
+    int i;
+} RankString;
 
-    if(num <= 0) return 0;
+/* Return the index of the most significant word of a double.
+ */
+static int
+double_hi_word(void)
+{
+    union { double d; unsigned int w[2]; } u;
+    u.d = 1.;
+    return (u.w[1] == 0x3ff00000) ? 1 : 0;
+}
 
-    table = tables[0];
-    name = table->_name;
-    for(i = 1; i < num; i++) {
-	if(tables[i]->_name != name) {
-	    logErrorMsg(LOG_WARNING,
-		    "CssTableClass::sortTable: tables not all the same type.\n");
-	    return -1;
+static void
+double_key(double d, int hi_word, unsigned int *hi, unsigned int *lo)
+{
+    union { double d; unsigned int w[2]; } u;
+    u.d = d;
+    *hi = u.w[hi_word];
+    *lo = u.w[1-hi_word];
+    if(*hi & 0x80000000) { // negative: reverse the order
+	*hi = ~(*hi);
+	*lo = ~(*lo);
+    }
+    else {
+	*hi |= 0x80000000;
+    }
+}
+
+static void
+long_key(long l, unsigned int *hi, unsigned int *lo)
+{
+    // (l >> 16) >> 16 is the sign when long is 32 bits
+    *hi = (unsigned int)((l >> 16) >> 16) ^ 0x80000000;
+    *lo = (unsigned int)l;
+}
+
+static int
+sort_by_rank(const void *a, const void *b)
+{
+    return strcmp(((const RankString *)a)->s, ((const RankString *)b)->s);
+}
+
+/* Set rank[i] to the position of s[i] in the sorted list of the distinct
+ * strings.
+ */
+static int
+string_ranks(int n, const char **s, unsigned int *rank)
+{
+    int i;
+    unsigned int r;
+    RankString *order;
+
+    if(!(order = (RankString *)malloc(n*sizeof(RankString)))) return -1;
+    for(i = 0; i < n; i++) {
+	order[i].s = s[i];
+	order[i].i = i;
+    }
+    qsort(order, n, sizeof(RankString), sort_by_rank);
+    r = 0;
+    for(i = 0; i < n; i++) {
+	if(i > 0 && strcmp(order[i].s, order[i-1].s)) r++;
+	rank[order[i].i] = r;
+    }
+    free(order);
+    return 0;
+}
+
+/* Find the member to sort by. A name ending in "_quark" refers to the quark
+ * of a string member, which sorts as an int.
+ */
+static int
+sort_member(CssClassDescription *des, int num_members, const string &name,
+		int *offset, int *type)
+{
+    int i, n;
+    char buf[100];
+
+    for(i = 0; i < num_members && strcasecmp(name.c_str(), des[i].name); i++);
+    if(i < num_members) {
+	*offset = des[i].offset;
+	*type = des[i].type;
+	return 0;
+    }
+    n = (int)name.length();
+    if(n > 6 && !name.substr(n-6).compare("_quark"))
+    {
+	stringcpy(buf, name.c_str(), 100);
+	if(n-6 < 100) buf[n-6] = '\0';
+
+	for(i = 0; i < num_members && strcasecmp(buf, des[i].name); i++);
+	if(i < num_members && des[i].quark_offset > 0) {
+	    *offset = des[i].quark_offset;
+	    *type = CSS_INT;
+	    return 0;
 	}
     }
-    des = table->_des;
+    return -1;
+}
 
-    for(i = 0; i < table->_num_members
-		&& strcasecmp(member_name.c_str(), des[i].name); i++);
+/* Extract the sort key of a member from each record.
+ */
+static int
+sort_key(int num, CssTableClass **t, int offset, int type, SortKey *k)
+{
+    int i, hi_word = double_hi_word();
+    const char **s;
+    DateTime *d;
+
+    k->w[0] = k->w[1] = NULL;
+    k->nwords = (type == CSS_LONG || type == CSS_JDATE || type == CSS_DOUBLE
+		|| type == CSS_TIME || type == CSS_FLOAT) ? 2 : 1;
 
-    if(i == table->_num_members)
+    for(i = 0; i < k->nwords; i++) {
+	if(!(k->w[i] = (unsigned int *)malloc(num*sizeof(unsigned int)))) {
+	    return -4;
+	}
+    }
+
+    switch(type)
     {
-	// check for a quark reference
-	char buf[100];
-	int n = (int)member_name.length();
-	if(n > 6 && !member_name.substr(n-6).compare("_quark"))
-	{
-	    stringcpy(buf, member_name.c_str(), 100);
-	    buf[n-6] = '\0';
+	case CSS_STRING:
+	case CSS_QUARK:
+	    if(!(s = (const char **)malloc(num*sizeof(const char *)))) {
+		return -4;
+	    }
+	    for(i = 0; i < num; i++) {
+		s[i] = (type == CSS_STRING) ? (char *)t[i] + offset :
+			quarkToString(*(int *)((char *)t[i] + offset));
+	    }
+	    if(string_ranks(num, s, k->w[0])) {
+		free(s);
+		return -4;
+	    }
+	    free(s);
+	    break;
+	case CSS_DATE:
+	case CSS_LDDATE:
+	    for(i = 0; i < num; i++) {
+		d = (DateTime *)((char *)t[i] + offset);
+		k->w[0][i] = (unsigned int)(d->year*372 + d->month*31 + d->day)
+				^ 0x80000000;
+	    }
+	    break;
+	case CSS_LONG:
+	case CSS_JDATE:
+	    for(i = 0; i < num; i++) {
+		long_key(*(long *)((char *)t[i] + offset), &k->w[0][i],
+				&k->w[1][i]);
+	    }
+	    break;
+	case CSS_INT:
+	    for(i = 0; i < num; i++) {
+		k->w[0][i] = (unsigned int)(*(int *)((char *)t[i] + offset))
+				^ 0x80000000;
+	    }
+	    break;
+	case CSS_DOUBLE:
+	case CSS_TIME:
+	    for(i = 0; i < num; i++) {
+		double_key(*(double *)((char *)t[i] + offset), hi_word,
+				&k->w[0][i], &k->w[1][i]);
+	    }
+	    break;
+	case CSS_FLOAT:
+	    for(i = 0; i < num; i++) {
+		double_key((double)*(float *)((char *)t[i] + offset), hi_word,
+				&k->w[0][i], &k->w[1][i]);
+	    }
+	    break;
+	default:
+	    return -3;
+    }
+    return 0;
+}
+
+/* Stable LSD radix sort of the records by the keys, eight bits at a time,
+ * from the least significant word of the last key. A pass is skipped when
+ * all of the records have the same byte.
+ */
+static int
+radix_sort(int num, int nkeys, SortKey *keys, int *order)
+{
+    int i, j, k, shift, *a, *b, *buf, *swap, count[256];
+    unsigned int *w;
+
+    if(!(buf = (int *)malloc(num*sizeof(int)))) return -4;
 
-	    for(i = 0; i < table->_num_members
-		    && strcasecmp(buf, des[i].name); i++);
-	    if(i < table->_num_members && des[i].quark_offset > 0) {
-		quark = true;
+    a = order;
+    b = buf;
+    for(i = 0; i < num; i++) a[i] = i;
+
+    for(k = nkeys-1; k >= 0; k--) {
+	for(j = keys[k].nwords-1; j >= 0; j--) {
+	    w = keys[k].w[j];
+	    for(shift = 0; shift < 32; shift += 8)
+	    {
+		int sum = 0;
+		memset(count, 0, sizeof(count));
+		for(i = 0; i < num; i++) count[(w[i] >> shift) & 0xff]++;
+		if(count[(w[0] >> shift) & 0xff] == num) continue;
+
+		for(i = 0; i < 256; i++) {
+		    int c = count[i];
+		    count[i] = sum;
+		    sum += c;
+		}
+		for(i = 0; i < num; i++) {
+		    b[count[(w[a[i]] >> shift) & 0xff]++] = a[i];
+		}
+		swap = a;
+		a = b;
+		b = swap;
 	    }
 	}
-	if(!quark) {
+    }
+    if(a != order) memcpy(order, a, num*sizeof(int));
+    free(buf);
+    return 0;
+}
+
+/* Get the order of the records sorted by the members.
+ */
+static int
+sort_order(int num, CssTableClass **t, vector<string> &member_names,
+		int *order)
+{
+    int i, ret, offset, type, nkeys = (int)member_names.size();
+    SortKey *keys;
+    CssClassDescription *des;
+
+    des = t[0]->description();
+
+    if(!(keys = (SortKey *)malloc(nkeys*sizeof(SortKey)))) return -4;
+    for(i = 0; i < nkeys; i++) keys[i].w[0] = keys[i].w[1] = NULL;
+
+    ret = 0;
+    for(i = 0; i < nkeys && !ret; i++)
+    {
+	if(sort_member(des, t[0]->getNumMembers(), member_names[i],
+		&offset, &type))
+	{
 	    snprintf(error, sizeof(error),
 			"CssTableClass::sort: invalid member_name: %s",
-			member_name.c_str());
+			member_names[i].c_str());
+	    logErrorMsg(LOG_WARNING, error);
+	    ret = -2;
+	}
+	else if((ret = sort_key(num, t, offset, type, &keys[i])) == -3) {
+	    snprintf(error, sizeof(error),
+		    "CssTableClass::sort: unknown member type: %d\n", type);
 	    logErrorMsg(LOG_WARNING, error);
-	    return -2;
 	}
     }
+    if(!ret) ret = radix_sort(num, nkeys, keys, order);
 
-    if(quark) {
-	member_offset = des[i].quark_offset;
-	tables.sort(sort_by_int);
+    if(ret == -4) {
+	logErrorMsg(LOG_WARNING, "CssTableClass::sort: malloc failed.");
     }
-    else
-    {
-	member_offset = des[i].offset;
+    for(i = 0; i < nkeys; i++) {
+	Free(keys[i].w[0]);
+	Free(keys[i].w[1]);
+    }
+    free(keys);
+    return ret;
+}
 
-	switch(des[i].type)
-	{
-	    case CSS_STRING:
-		tables.sort(sort_by_string);
-		break;
-	    case CSS_DATE:
-	    case CSS_LDDATE:
-		tables.sort(sort_by_date);
-		break;
-	    case CSS_LONG:
-	    case CSS_JDATE:
-		tables.sort(sort_by_long);
-		break;
-	    case CSS_INT:
-	    case CSS_QUARK:
-		tables.sort(sort_by_int);
-		break;
-	    case CSS_DOUBLE:
-	    case CSS_TIME:
-		tables.sort(sort_by_double);
-		break;
-	    case CSS_FLOAT:
-		tables.sort(sort_by_float);
-		break;
-	    default:
-		snprintf(error, sizeof(error),
-		    "CssTableClass::sort: unknown member type: %d\n", des[i].type);
-		logErrorMsg(LOG_WARNING, error);
-		return -3;
-	}
+/* Split a list of member names separated by commas.
+ */
+static void
+member_list(const string &member_name, vector<string> &names)
+{
+    char *c, *tok, *last, *buf = strdup(member_name.c_str());
+
+    names.clear();
+    tok = buf;
+    while((c = strtok_r(tok, ", \t", &last)) != NULL) {
+	tok = NULL;
+	names.push_back(string(c));
     }
-    return 0;
+    free(buf);
 }
 
-static int
-sort_by_string(const void *a, const void *b)
+/**
+ * Sort a Vector of CssTableClass objects by the specified member. Possible errors
+ * are a bad Vector object, Vector objects are not all the same CssTableClass,
+ * invalid member_name and unknown member type. logErrorMsg is called before
+ * a error (nonzero) return.
+ * @param tables a Vector containing CssTableClass objects.
+ * @param member_name The table member that will be sorted, or a list of
+ *	members separated by commas, as "sta,chan,time".
+ * @return 0 for success, nonzero for an error condition.
+ */
+int CssTableClass::sort(gvector<CssTableClass *> &tables, const string &member_name)
 {
-    const char *sa = (const char *)(*(const char **)a + member_offset);
-    const char *sb = (const char *)(*(const char **)b + member_offset);
-    return(strcmp(sa, sb));
+    vector<string> names;
+
+    member_list(member_name, names);
+    return sort(tables, names);
 }
 
-static int
-sort_by_date(const void *a, const void *b)
+/**
+ * Sort a Vector of CssTableClass objects by one or more members. The
+ * records are sorted by the first member, then by the second member where
+ * the first members are equal, and so on. The sort is stable. The member
+ * values are copied into a compact array of keys which is radix sorted.
+ * CSS_STRING and CSS_QUARK members sort alphabetically. A member name with
+ * the suffix "_quark" sorts by the quark of the string member.
+ * @param tables a Vector containing CssTableClass objects.
+ * @param member_names The table members that will be sorted.
+ * @return 0 for success, nonzero for an error condition.
+ */
+int CssTableClass::sort(gvector<CssTableClass *> &tables,
+			vector<string> &member_names)
 {
-    DateTime *ta = (DateTime *)(*(DateTime **)a + member_offset);
-    DateTime *tb = (DateTime *)(*(DateTime **)b + member_offset);
-    if(ta->year != tb->year) return(ta->year - tb->year);
-    if(ta->month != tb->month) return(ta->month - tb->month);
-    return(ta->day - tb->day);
+    int ret, num = tables.size(), *order;
+    CssTableClass **t;
+
+    if(num <= 1) return 0;
+
+    if(!(t = (CssTableClass **)mallocWarn(num*sizeof(CssTableClass *)))) {
+	return -4;
+    }
+    tables.copyInto(t);
+
+    if(!(order = (int *)mallocWarn(num*sizeof(int)))) {
+	free(t);
+	return -4;
+    }
+    if(!(ret = sort(num, t, member_names, order))) {
+	tables.reorder(order);
+    }
+    free(order);
+    free(t);
+    return ret;
 }
 
-static int
-sort_by_long(const void *a, const void *b)
+/**
+ * Sort an array of CssTableClass objects by the specified member, or a list
+ * of members separated by commas.
+ * @param num the number of objects.
+ * @param tables an array of CssTableClass objects.
+ * @param member_name The table member that will be sorted.
+ * @return 0 for success, nonzero for an error condition.
+ */
+int CssTableClass::sort(int num, CssTableClass **tables,
+			const string &member_name)
 {
-    const long *la = (const long *)(*(const char **)a + member_offset);
-    const long *lb = (const long *)(*(const char **)b + member_offset);
-    return(*la - *lb);
+    int i, ret, *order;
+    CssTableClass **t;
+    vector<string> names;
+
+    if(num <= 1) return 0;
+
+    member_list(member_name, names);
+
+    if(!(order = (int *)mallocWarn(num*sizeof(int)))) return -4;
+
+    if(!(ret = sort(num, tables, names, order))) {
+	if(!(t = (CssTableClass **)mallocWarn(num*sizeof(CssTableClass *)))) {
+	    free(order);
+	    return -4;
+	}
+	memcpy(t, tables, num*sizeof(CssTableClass *));
+	for(i = 0; i < num; i++) tables[i] = t[order[i]];
+	free(t);
+    }
+    free(order);
+    return ret;
 }
 
-static int
-sort_by_int(const void *a, const void *b)
+/**
+ * Get the sorted order of an array of CssTableClass objects, without moving
+ * them.
+ * @param num the number of objects.
+ * @param tables an array of CssTableClass objects.
+ * @param member_names The table members that will be sorted.
+ * @param order returns the indices of the objects in the sorted order.
+ * @return 0 for success, nonzero for an error condition.
+ */
+int CssTableClass::sort(int num, CssTableClass **tables,
+			vector<string> &member_names, int *order)
 {
-    const int *ia = (const int *)(*(const char **)a + member_offset);
-    const int *ib = (const int *)(*(const char **)b + member_offset);
-    return(*ia - *ib);
+    int i, name;
+
+    if(num <= 0) return 0;
+
+    if((int)member_names.size() == 0) {
+	snprintf(error, sizeof(error), "CssTableClass::sort: no member_name");
+	logErrorMsg(LOG_WARNING, error);
+	return -2;
+    }
+
+    name = tables[0]->_name;
+    for(i = 1; i < num; i++) {
+	if(tables[i]->_name != name) {
+	    logErrorMsg(LOG_WARNING,
+		    "CssTableClass::sortTable: tables not all the same type.\n");
+	    return -1;
+	}
+    }
+    return sort_order(num, tables, member_names, order);
 }
 
-static int
-sort_by_double(const void *a, const void *b)
+/* The indexes that find keeps of the vectors and members searched last.
+ * The member values are sorted with the vector positions, so the vector
+ * does not need to be sorted. An index is rebuilt when its vector changes.
+ * Callers often alternate between vectors or members, so an index is kept
+ * for each of the last FIND_INDEX_SLOTS, and the least recently used one is
+ * replaced.
+ */
+#define FIND_INDEX_SLOTS 8
+
+typedef struct
+{
+    const void	*tables;
+    long	stamp;
+    int		num;
+    int		offset;
+    long	used;
+    long	*values;
+    int		*pos;
+} FindIndex;
+
+static FindIndex find_index[FIND_INDEX_SLOTS];
+static long find_index_used = 0;
+
+static void
+free_index_slot(FindIndex *f)
 {
-    const double *da = (const double *)(*(const char **)a + member_offset);
-    const double *db = (const double *)(*(const char **)b + member_offset);
-    return((int)(*da - *db));
+    Free(f->values);
+    Free(f->pos);
+    f->tables = NULL;
+    f->num = 0;
+    f->offset = -1;
+    f->used = 0;
 }
 
-static int
-sort_by_float(const void *a, const void *b)
+static void
+free_find_index(void)
+{
+    for(int i = 0; i < FIND_INDEX_SLOTS; i++) {
+	free_index_slot(&find_index[i]);
+    }
+    find_index_used = 0;
+}
+
+static bool
+build_find_index(FindIndex *f, gvector<CssTableClass *> &tables, int offset)
 {
-    const float *fa = (const float *)(*(const char **)a + member_offset);
-    const float *fb = (const float *)(*(const char **)b + member_offset);
-    return((int)(*fa - *fb));
+    int i, num = tables.size();
+    SortKey key;
+    CssTableClass **t;
+
+    free_index_slot(f);
+
+    if(!(t = (CssTableClass **)malloc(num*sizeof(CssTableClass *)))) {
+	return false;
+    }
+    tables.copyInto(t);
+
+    f->values = (long *)malloc(num*sizeof(long));
+    f->pos = (int *)malloc(num*sizeof(int));
+
+    if(!f->values || !f->pos
+	|| sort_key(num, t, offset, CSS_LONG, &key)
+	|| radix_sort(num, 1, &key, f->pos))
+    {
+	Free(key.w[0]);
+	Free(key.w[1]);
+	free(t);
+	free_index_slot(f);
+	logErrorMsg(LOG_WARNING, "CssTableClass::find: malloc failed.");
+	return false;
+    }
+    for(i = 0; i < num; i++) {
+	f->values[i] = *(long *)((char *)t[f->pos[i]] + offset);
+    }
+    Free(key.w[0]);
+    Free(key.w[1]);
+    free(t);
+
+    f->tables = &tables;
+    f->stamp = tables.stamp();
+    f->num = num;
+    f->offset = offset;
+    return true;
 }
 
-#define member(i) *(long *)((char *)tables[i] + offset)
+/* Get the index of tables and offset, building it if there is none or
+ * tables has changed since it was built. *built is set to true if the
+ * index was built by this call.
+ */
+static FindIndex *
+get_find_index(gvector<CssTableClass *> &tables, int offset, bool *built)
+{
+    FindIndex *f = NULL;
+    int i;
+
+    *built = false;
+    for(i = 0; i < FIND_INDEX_SLOTS; i++) {
+	if(find_index[i].tables == &tables && find_index[i].offset == offset) {
+	    f = &find_index[i];
+	    break;
+	}
+    }
+    if(f == NULL) {
+	// an empty slot, or the least recently used one
+	f = &find_index[0];
+	for(i = 1; i < FIND_INDEX_SLOTS && f->tables != NULL; i++) {
+	    if(find_index[i].tables == NULL || find_index[i].used < f->used) {
+		f = &find_index[i];
+	    }
+	}
+    }
+    f->used = ++find_index_used;
+
+    if(f->tables != &tables || f->offset != offset
+		|| f->stamp != tables.stamp() || f->num != tables.size())
+    {
+	if(!build_find_index(f, tables, offset)) return NULL;
+	f->used = find_index_used;
+	*built = true;
+    }
+    return f;
+}
 
 /**
  * Find a CssTableClass object that has the specified member value. The member
- * data type must be long. The input Vector must first be sorted by the member.
- * Possible errors are a bad object, invalid member_name, invalid member data
- * type.  logErrorMsg is called if an error occurred.
+ * data type must be long. The first call for a Vector and member builds an
+ * index of the member values, which is kept until the Vector changes, so the
+ * Vector does not need to be sorted. The indexes of the last few Vectors and
+ * members searched are kept. Possible errors are a bad object,
+ * invalid member_name, invalid member data type.  logErrorMsg is called if
+ * an error occurred.
  * @param tables A Vector of CssTableClass objects.
  * @param member_name The table member that will be searched.
  * @param value The value that will be search for.
  * @return a CssTableClass for success, NULL if not found or an error occurred.
+ *	If more than one object has the value, the first one in the Vector is
+ *	returned.
  */
 CssTableClass * CssTableClass::find(gvector<CssTableClass *> &tables,
 			const string &member_name, long value)
 {
-    int i, jl, ju, jm, offset;
+    int i, offset;
     CssTableClass *table;
 
     if(tables.size() <= 0) return NULL;
@@ -1931,30 +2341,68 @@ CssTableClass * CssTableClass::find(gvector<CssTableClass *> &tables,
 
     offset = table->_des[i].offset;
 
-    if(value < member(0) || value > member(tables.size()-1)) return NULL;
+    LOCK_FIND_INDEX;
+    table = findIndexed(tables, offset, value);
+    UNLOCK_FIND_INDEX;
+
+    return table;
+}
 
-    if(value == member(0)) return tables[0];
+/* Search the find index of tables and offset for value. If the index
+ * was not built by this call, a member can have been changed since it was
+ * built. A hit on a changed member rebuilds the index and searches again.
+ * A miss is checked against the members themselves, and the index is
+ * rebuilt if the value is found there, so that an absent value does not
+ * rebuild it each time. The caller holds the find lock.
+ */
+static CssTableClass *
+findIndexed(gvector<CssTableClass *> &tables, int offset, long value)
+{
+    int i, jl, ju, jm, pass;
+    bool built;
+    FindIndex *f;
+    CssTableClass *table;
 
-    jl = -1;
-    ju = tables.size();
+    if( !(f = get_find_index(tables, offset, &built)) ) return NULL;
 
-    while(ju - jl > 1)
+    for(pass = 0; pass < 2; pass++)
     {
-	jm = (ju + jl)/2;
+	jl = -1;
+	ju = f->num;
 
-	if(value > member(jm)) {
-	    jl = jm;
+	while(ju - jl > 1)
+	{
+	    jm = (ju + jl)/2;
+
+	    if(value > f->values[jm]) {
+		jl = jm;
+	    }
+	    else {
+		ju = jm;
+	    }
 	}
-	else {
-	    ju = jm;
+	if(ju < f->num && f->values[ju] == value)
+	{
+	    table = tables[f->pos[ju]];
+
+	    // the member can have been changed since the index was made
+	    if(*(long *)((char *)table + offset) == value) return table;
 	}
+	else if(!built)
+	{
+	    // the value can have been set since the index was made
+	    for(i = 0; i < tables.size(); i++) {
+		if(*(long *)((char *)tables[i] + offset) == value) break;
+	    }
+	    if(i == tables.size()) return NULL;
+	    table = tables[i];
+	    build_find_index(f, tables, offset);
+	    return table;
+	}
+	if(built || !build_find_index(f, tables, offset)) return NULL;
+	built = true;
     }
-    if(value == member(jl+1)) {
-	return tables[jl+1];
-    }
-    else {
-	return NULL;
-    }
+    return NULL;
 }
 
 /**
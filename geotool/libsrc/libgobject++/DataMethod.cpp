@@ -12,6 +12,7 @@
 #include "gobject++/GTimeSeries.h"
 #include "Waveform.h"
 #include "motif++/Component.h"
+#include "ProfileTimer.h"
 
 using namespace std;
 
@@ -41,6 +42,7 @@ GTimeSeries * DataMethod::apply(GTimeSeries *ts)
  */
 bool DataMethod::apply(int num_waveforms, GTimeSeries **ts)
 {
+    ProfileTimer pt(profileStage());
     bool ret = applyMethod(num_waveforms, ts);
     if(ret) {
 	// this method was successfully applied. Save it in ts.
@@ -82,6 +84,7 @@ bool DataMethod::apply(gvector<Waveform *> &wvec)
     for(int i = 0; i < wvec.size(); i++) {
 	ts[i] = wvec[i]->ts;
     }
+    ProfileTimer pt(profileStage());
     bool ret = applyMethod(wvec.size(), ts);
     if(ret) {
 	// this method was successfully applied. Save it in ts.
@@ -96,6 +99,16 @@ bool DataMethod::apply(gvector<Waveform *> &wvec)
     return ret;
 }
 
+/** Get the profile stage name of this method, when the profile is running.
+ *  @returns "DataMethod::apply method_name" or NULL.
+ */
+const char * DataMethod::profileStage(void)
+{
+    if(!PROFILE_RUNNING()) return NULL;
+    string s = string("DataMethod::apply ") + method_name;
+    return profile_name(s.c_str());
+}
+
 // static
 /** Apply one or more methods to an array of Waveform objects.
  *  @param[in] dm a sequence of DataMethod objects to apply.
@@ -390,6 +403,7 @@ bool DataMethod::doMethods(gvector<DataMethod *> *methods, int num,
 		GTimeSeries **ts)
 {
     for(int i = 0; i < (int)methods->size(); i++) {
+	ProfileTimer pt(methods->at(i)->profileStage());
 	if(!methods->at(i)->applyMethod(num, ts))
 	{
 	    return false;
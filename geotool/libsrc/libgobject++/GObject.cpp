@@ -15,15 +15,22 @@ using namespace std;
 /** Destructor */
 Gobject::~Gobject(void)
 {
-    if((int)owners.size() > 0) {
+    if(ref_count > 0) {
 	debug();
     }
-    owners.clear();
+    delete owner_set;
 }
 
 void Gobject::debug(void)
 {
     cerr << "warning: deleting a Gobject that has owners.\n Use deleteObject() instead." << endl;
+#ifdef GOBJECT_DEBUG_OWNERS
+    for(int i = 0; i < (int)owners.size(); i++) {
+	cerr << "  owner " << i << ": " << owners[i] << endl;
+    }
+    int n = ref_count - (int)owners.size();
+    if(n > 0) cerr << "  " << n << " retained reference(s)" << endl;
+#endif
 }
 
 /** Delete a Gobject. Delete the object if is has no owners.  If there are no
@@ -43,7 +50,7 @@ void Gobject::deleteObject(void)
  */
 bool Gobject::hasOwners(void)
 {
-    return ((int)owners.size() > 0) ? true : false;
+    return (refCount() > 0) ? true : false;
 }
 
 /** Add an owner. This prevents the object from being deleted by calls to
@@ -53,18 +60,30 @@ bool Gobject::hasOwners(void)
  *  only registered once and needs to be removed only once.
  *  @param[in] owner a Gobject that will be an owner of this Gobject.
  */
-void Gobject::addOwner(Gobject *owner)
+void Gobject::addOwner(Gobject *o)
 {
-    if( !owner ) return;
+    if( !o ) return;
+
+    lockOwners();
 
-    int i;
     /* don't register an owner twice */
-    for(i = 0; i < (int)owners.size(); i++) {
-	if(owners[i] == owner) break;
+    if(o == owner || (owner_set && owner_set->count(o))) {
+	unlockOwners();
+	return;
+    }
+    if(!owner) {
+	owner = o;
     }
-    if(i == (int)owners.size()) {
-	owners.push_back(owner);
+    else {
+	if(!owner_set) owner_set = new set<Gobject *>;
+	owner_set->insert(o);
     }
+#ifdef GOBJECT_DEBUG_OWNERS
+    owners.push_back(o);
+#endif
+    __sync_add_and_fetch(&ref_count, 1);
+
+    unlockOwners();
 }
 
 /** Remove an owner with optional delete. Remove an object as an owner of this
@@ -76,31 +95,71 @@ void Gobject::addOwner(Gobject *owner)
  *		returns false if there are still owners of this object and/or
  *		the input owner object was not actually an owner.
  */
-bool Gobject::removeOwner(Gobject *owner, bool do_delete)
+bool Gobject::removeOwner(Gobject *o, bool do_delete)
 {
     bool is_owner = false;
-    bool found = true;
 
-    /* remove owner from this->owners
-     */
-    while(found) {
-	found = false;
+    lockOwners();
+
+    if(o && o == owner) {
+	owner = NULL;
+	is_owner = true;
+    }
+    else if(o && owner_set && owner_set->erase(o) > 0) {
+	is_owner = true;
+    }
+#ifdef GOBJECT_DEBUG_OWNERS
+    if(is_owner) {
 	for(int i = 0; i < (int)owners.size(); i++) {
-	    if(owners[i] == owner) {
-		owners.erase(owners.begin()+i);
-		found = true;
-		is_owner = true;
-		break;
-	    }
+	    if(owners[i] == o) { owners.erase(owners.begin()+i); break; }
 	}
     }
+#endif
+
+    unlockOwners();
 
-    if((int)owners.size() > 0) {
+    if( !is_owner ) {
+	return false;
+    }
+    if(__sync_sub_and_fetch(&ref_count, 1) > 0) {
 	return false; // another owner
     }
+    if(do_delete) {
+	delete this;
+	return true;
+    }
+    return false;
+}
+
+/** Add an anonymous reference. The object will not be deleted until
+ *  release() has been called once for each call to retain(), and all
+ *  owners have been removed. Unlike addOwner(), every call to retain()
+ *  counts, and it does not search or lock the owner list, so it is the
+ *  cheap way to share an object with containers and worker threads.
+ */
+void Gobject::retain(void)
+{
+    __sync_add_and_fetch(&ref_count, 1);
+}
 
-    if(is_owner && do_delete) {
-	deleteObject();
+/** Release an anonymous reference taken with retain(). If there are no
+ *  remaining owners or references, delete this object only if do_delete
+ *  is true.
+ *  @param[in] do_delete delete the object only if do_delete is true.
+ *  @returns true if there are no remaining references and the object was
+ *		deleted.
+ */
+bool Gobject::release(bool do_delete)
+{
+    int n = __sync_sub_and_fetch(&ref_count, 1);
+
+    if(n < 0) {
+	__sync_add_and_fetch(&ref_count, 1);
+	cerr << "warning: Gobject::release called without retain." << endl;
+	return false;
+    }
+    if(n == 0 && do_delete) {
+	delete this;
 	return true;
     }
     return false;
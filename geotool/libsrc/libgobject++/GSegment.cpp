@@ -9,6 +9,28 @@ using namespace std;
 
 #include "gobject++/GSegment.h"
 
+/** Constructor. Allocates a sample array.
+ *  @param[in] buffer_length the number of samples. At least one sample is
+ *	always allocated.
+ *  @throws GERROR_MALLOC_ERROR
+ */
+GSampleBuffer::GSampleBuffer(int buffer_length) throw(int) :
+	samples(NULL), length(buffer_length)
+{
+    if(length <= 0) length = 1;
+    if( !(samples = (float *)malloc(length*sizeof(float))) ) {
+	GError::setMessage("GSampleBuffer: malloc failed.");
+	cerr << GError::getMessage() << endl;
+	throw GERROR_MALLOC_ERROR;
+    }
+}
+
+/** Destructor. */
+GSampleBuffer::~GSampleBuffer(void)
+{
+    Free(samples);
+}
+
 /** Constructor for float data. The data array is copied.
  *  @param[in] seg_data The float data.
  *  @param[in] seg_data_length The number of data samples.
@@ -21,7 +43,7 @@ using namespace std;
 GSegment::GSegment(float *seg_data, int seg_data_length, double tstart,
 		double dt, double calibration, double calperiod) throw(int) :
 	data(NULL), beg(0.), del(0.), data_length(0), initial_calib(0.),
-	initial_calper(0.), Calib(0.), Calper(0.)
+	initial_calper(0.), Calib(0.), Calper(0.), buffer(NULL)
 {
     init(seg_data_length, tstart, dt, calibration, calperiod);
     if(seg_data_length > 0) {
@@ -42,7 +64,7 @@ GSegment::GSegment(float *seg_data, int seg_data_length, double tstart,
 GSegment::GSegment(double *seg_data, int seg_data_length, double tstart,
 		double dt, double calibration, double calperiod) throw(int) :
 	data(NULL), beg(0.), del(0.), data_length(0), initial_calib(0.),
-	initial_calper(0.), Calib(0.), Calper(0.)
+	initial_calper(0.), Calib(0.), Calper(0.), buffer(NULL)
 {
     init(seg_data_length, tstart, dt, calibration, calperiod);
     for(int i = 0; i < seg_data_length; i++) data[i] = (float)seg_data[i];
@@ -60,7 +82,7 @@ GSegment::GSegment(double *seg_data, int seg_data_length, double tstart,
 GSegment::GSegment(int seg_data_length, double tstart, double dt,
 		double calibration, double calperiod) throw(int) :
 	data(NULL), beg(0.), del(0.), data_length(0), initial_calib(0.),
-	initial_calper(0.), Calib(0.), Calper(0.)
+	initial_calper(0.), Calib(0.), Calper(0.), buffer(NULL)
 {
     init(seg_data_length, tstart, dt, calibration, calperiod);
 }
@@ -84,18 +106,50 @@ void GSegment::init(int seg_data_length, double tstart, double dt,
     initial_calib = Calib;
     initial_calper = Calper;
 
-    if(seg_data_length > 0) {
-	data = (float *)malloc(seg_data_length*sizeof(float));
-	data_length = seg_data_length;
-    }
-    else {
-	data = (float *)malloc(sizeof(float));
-	data_length = 0;
+    data_length = (seg_data_length > 0) ? seg_data_length : 0;
+    newBuffer(data_length, false);
+}
+
+/** Replace the sample buffer with a new buffer that is not shared.
+ *  @param[in] len the length of the new buffer.
+ *  @param[in] copy_data if true, copy the first len samples of data[] to the
+ *	new buffer.
+ *  @throws GERROR_MALLOC_ERROR
+ */
+void GSegment::newBuffer(int len, bool copy_data) throw(int)
+{
+    GSampleBuffer *b = new GSampleBuffer(len);
+    b->retain();
+    if(copy_data && len > 0) {
+	memcpy(b->samples, data, len*sizeof(float));
     }
-    if(!data) {
-	GError::setMessage("GSegment.init malloc failed.");
-	cerr << GError::getMessage() << endl;
-	throw GERROR_MALLOC_ERROR;
+    if(buffer) buffer->release();
+    buffer = b;
+    data = b->samples;
+}
+
+/** Share the sample buffer of another GSegment.
+ *  @param[in] seg the GSegment that holds the buffer.
+ *  @param[in] offset the index in seg->data of the first sample of this
+ *	GSegment.
+ */
+void GSegment::shareData(GSegment *seg, int offset)
+{
+    seg->buffer->retain();
+    if(buffer) buffer->release();
+    buffer = seg->buffer;
+    data = seg->data + offset;
+}
+
+/** Make the data samples private to this GSegment. If the sample buffer is
+ *  shared with other GSegments, the samples are copied to a new buffer. This
+ *  must be called before the data[] array is modified.
+ *  @throws GERROR_MALLOC_ERROR
+ */
+void GSegment::unshare(void) throw(int)
+{
+    if(buffer->refCount() > 1) {
+	newBuffer(data_length, true);
     }
 }
 
@@ -115,7 +169,8 @@ void GSegment::setTdel(double dt)
 
 /** Creates a GSegment that is a subsegment of this GSegment.
  *  The subsegment begins at the specified begin_index and extends to
- *  the data at index end_index-1.
+ *  the data at index end_index-1. The subsegment shares the data samples of
+ *  this GSegment.
  *  @param[in] begin_index the beginning index. Must be >= 0 && < length().
  *  @param[in] end_index the ending index, exclusive. Must be >= 0 && <
  *   length() && > begin_index.
@@ -151,65 +206,58 @@ GSegment * GSegment::subsegment(int begin_index, int end_index) throw(int)
 	throw GERROR_INVALID_ARGS;
     }
 
-    seg = new GSegment(data+begin_index, end_index - begin_index,
-		beg + begin_index*del, del, initial_calib, initial_calper);
-    seg->Calib = Calib;
-    seg->Calper = Calper;
+    seg = new GSegment(this);
+    seg->data = data + begin_index;
+    seg->beg = beg + begin_index*del;
+    seg->data_length = end_index - begin_index;
     return seg;
 }
 
+/** Copy constructor. The new GSegment shares the data samples of s until
+ *  either one calls unshare().
+ *  @param[in] s the GSegment to copy.
+ */
 GSegment::GSegment(GSegment &s) :
-	data(NULL), beg(0.), del(0.), data_length(0), initial_calib(0.),
-	initial_calper(0.), Calib(0.), Calper(0.)
+	data(NULL), beg(s.beg), del(s.del), data_length(s.data_length),
+	initial_calib(s.initial_calib), initial_calper(s.initial_calper),
+	Calib(s.Calib), Calper(s.Calper), buffer(NULL)
 {
-    init(s.data_length, s.beg, s.del, s.initial_calib, s.initial_calper);
-    Calib = s.Calib;
-    Calper = s.Calper;
-    if(s.data_length > 0) {
-	memcpy(data, s.data, s.data_length*sizeof(float));
-    }
+    shareData(&s, 0);
 }
 
 GSegment::GSegment(GSegment *s) :
-	data(NULL), beg(0.), del(0.), data_length(0), initial_calib(0.),
-	initial_calper(0.), Calib(0.), Calper(0.)
+	data(NULL), beg(s->beg), del(s->del), data_length(s->data_length),
+	initial_calib(s->initial_calib), initial_calper(s->initial_calper),
+	Calib(s->Calib), Calper(s->Calper), buffer(NULL)
 {
-    init(s->data_length, s->beg, s->del, s->initial_calib, s->initial_calper);
-    Calib = s->Calib;
-    Calper = s->Calper;
-    if(s->data_length > 0) {
-	memcpy(data, s->data, s->data_length*sizeof(float));
-    }
+    shareData(s, 0);
 }
 
 GSegment & GSegment::operator=(const GSegment &s)
 {
     if(this != &s) {
-	if(data != NULL) free(data);
-	init(s.data_length, s.beg, s.del, s.initial_calib, s.initial_calper);
+	beg = s.beg;
+	del = s.del;
+	initial_calib = s.initial_calib;
+	initial_calper = s.initial_calper;
 	Calib = s.Calib;
 	Calper = s.Calper;
-	if(s.data_length > 0) {
-	    memcpy(data, s.data, s.data_length*sizeof(float));
-	}
+	shareData((GSegment *)&s, 0);
+	data_length = s.data_length;
     }
     return *this;
 }
 
 Gobject * GSegment::clone(void)
 {
-    GSegment *s = new GSegment(data, data_length, beg, del,
-				initial_calib, initial_calper);
-    s->Calib = Calib;
-    s->Calper = Calper;
-    return (Gobject *)s;
+    return (Gobject *)new GSegment(this);
 
 }
 
 /** Destructor. */
 GSegment::~GSegment(void)
 {
-    if(data != NULL) free(data);
+    if(buffer) buffer->release();
 }
 
 /** Cut the beginning and ending of the data.
@@ -226,6 +274,13 @@ void GSegment::truncate(int i1, int i2) throw(int)
 
     beg = beg + i1*del;
     data_length = i2 - i1 + 1;
+
+    if(buffer->refCount() > 1 || data != buffer->samples) {
+	// do not modify a shared buffer
+	data += i1;
+	newBuffer(data_length, true);
+	return;
+    }
     for(int i = i1, j = 0; i <= i2; i++) data[j++] = data[i];
     if(data_length > 0) {
 	data = (float *)realloc(data, data_length*sizeof(float));
@@ -238,6 +293,8 @@ void GSegment::truncate(int i1, int i2) throw(int)
 cerr << GError::getMessage() << endl;
 	throw GERROR_MALLOC_ERROR;
     }
+    buffer->samples = data;
+    buffer->length = (data_length > 0) ? data_length : 1;
 }
 
 /** Replace the data of this segment with the input array. The data is copied.
@@ -246,6 +303,9 @@ cerr << GError::getMessage() << endl;
  */
 void GSegment::setData(float *seg_data)
 {
+    if(buffer->refCount() > 1) {
+	newBuffer(data_length, false);
+    }
     if(data_length > 0) {
 	memcpy(data, seg_data, data_length*sizeof(float));
     }
@@ -1556,6 +1556,7 @@ double GTimeSeries::demean(void)
     mean_value /= (double)npts;
     for(int i = 0; i < nsegs; i++) {
 	int n = s[i]->length();
+	s[i]->unshare();
 	for(int j = 0; j < n; j++) s[i]->data[j] -= mean_value;
     }
     return mean_value;
@@ -1682,7 +1683,8 @@ bool GTimeSeries::reread(void)
 }
 
 /** Make an internal copy of the data. This copy will be used when reread()
- *  is called, instead re-reading the data.
+ *  is called, instead re-reading the data. The copy shares the data samples
+ *  with this GTimeSeries, so it costs no memory until the data is modified.
  */
 void GTimeSeries::makeCopy(void)
 {
@@ -1697,6 +1699,15 @@ void GTimeSeries::makeCopy(void)
     }
 }
 
+/** Make the data samples of all segments private to this GTimeSeries.
+ *  Segment copies share their data samples. This must be called before the
+ *  data of a GTimeSeries that might have been copied is modified.
+ */
+void GTimeSeries::unshare(void)
+{
+    for(int i = 0; i < nsegs; i++) s[i]->unshare();
+}
+
 void GTimeSeries::setDataSource(DataSource *ds)
 {
     if(ds == _data_source) return;
@@ -111,6 +111,7 @@ bool ConvolveData::applyMethod(GTimeSeries *ts)
 	GSegment *s = ts->segment(i);
 	float dt = s->tdel();
 
+	s->unshare();
 	if(! Response::convolve(&responses, direction, s->data, s->length(),
 			dt, flo, fhi, cutoff, ncalib, ncalper,
 			remove_time_shift) )
@@ -128,6 +129,7 @@ void ConvolveData::applyToSegment(GSegment *s)
 {
     float dt = s->tdel();
 
+    s->unshare();
     if(! Response::convolve(&responses, direction, s->data, s->length(),
 			dt, flo, fhi, cutoff, ncalib, ncalper,
 			remove_time_shift) )
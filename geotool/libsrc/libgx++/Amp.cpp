@@ -328,8 +328,34 @@ bool Amp::autoMeasureAmpPer(GTimeSeries *ts, const string &amptype,
 	snprintf(amp_err_msg, sizeof(amp_err_msg),
 	    "Max. amplitude determination failed.\nsta=%s time=%02d:%02d:%4.1f",
 	    ts->sta(), dt2.hour, dt2.minute, dt2.second);
+	return (amp->amp >= 0.);
     }
-    else if(max_amplitude > NA_AMPLITUDE)
+    return countsToNms(ts, s, max_amplitude, period, time_of_max_amplitude,
+			mb_allow_counts, mb_counts_amptype, amp);
+}
+
+/** Set the amplitude, period and time of a measurement made with
+ *  measure_SP_pp_amplitude, converting the amplitude from counts to
+ *  nanometers.
+ *  @param[in] ts the waveform data.
+ *  @param[in] s the segment of ts that was measured, used for calib.
+ *  @param[in] max_amplitude the amplitude in counts.
+ *  @param[in] period the period in seconds.
+ *  @param[in] time_of_max_amplitude the epochal time of the amplitude.
+ *  @param[in] mb_allow_counts if true, the units of the amplitude will be
+ *	counts when the instrument response is not available.
+ *  @param[in] mb_counts_amptype the amptype when the units of the amplitude
+ *	are counts.
+ *  @param[in,out] amp the amplitude record.
+ *  @returns true for success or false for an error. Use Amp::getAmpError() to
+ *	retrieve the error message.
+ */
+bool Amp::countsToNms(GTimeSeries *ts, GSegment *s, double max_amplitude,
+		double period, double time_of_max_amplitude,
+		bool mb_allow_counts, const string &mb_counts_amptype,
+		CssAmplitudeClass *amp)
+{
+    if(max_amplitude > NA_AMPLITUDE)
     {
 	amp->amp_cnts = max_amplitude;
 	amp->amp_Nnms = amp->amp_cnts * s->calib();
@@ -402,6 +428,52 @@ int Amp:: measure_SP_pp_amplitude(float *beam, double samprate, int nsamples,
 		double waveform_start_time, double time_of_the_pick, 
 		double *max_amplitude, double *period, 
 		double *time_of_max_amplitude, double *bandw)
+{
+    AmpMeasureParams p;
+
+    getMeasureParams(&p);
+
+    return measure_SP_pp_amplitude(beam, samprate, nsamples,
+		waveform_start_time, time_of_the_pick, &p, max_amplitude,
+		period, time_of_max_amplitude, bandw);
+}
+
+/** Get the program properties used by measure_SP_pp_amplitude.
+ *  @param[out] p the property values, or their defaults.
+ */
+void Amp::getMeasureParams(AmpMeasureParams *p)
+{
+    p->zero_phase = Application::getProperty("mb_filter_zp", true);
+    p->locut = Application::getProperty("mb_filter_locut", 0.8);
+    p->hicut = Application::getProperty("mb_filter_hicut", 4.5);
+    p->filt_order = Application::getProperty("mb_filter_order", 3);
+    p->amp_threshold1 = Application::getProperty("mb_amp_theshold1", 15.);
+    p->filter_margin = Application::getProperty("mb_filter_margin", 10.);
+    p->lead = Application::getProperty("mb_lead", 0.5);
+    p->length = Application::getProperty("mb_length", 7.0);
+    if( !Application::getProperty("mb_filter_type", p->filt_type) ) {
+	p->filt_type.assign("BP");
+    }
+}
+
+/** Measure short period peak-to-peak amplitude with the properties from
+ *  getMeasureParams. This function does not use the program properties or
+ *  any static data, so it can be called from more than one thread.
+ *  @param[in,out] beam the waveform signal. It is tapered and filtered.
+ *  @param[in] samprate the sample rate.
+ *  @param[in] nsamples the number of data values in the waveform.
+ *  @param[in] waveform_start_time epochal start time.
+ *  @param[in] time_of_the_pick epochal time of the pick.
+ *  @param[in] p the measurement parameters.
+ *  @param[out] max_amplitude the maximum amplitude in nm.
+ *  @param[out] period the period in seconds.
+ *  @param[out] time_of_max_amplitude the epochal time of the maximum amplitude.
+ *  @param[out] bandw the bandwidth of the filter.
+ */
+int Amp:: measure_SP_pp_amplitude(float *beam, double samprate, int nsamples,
+		double waveform_start_time, double time_of_the_pick, 
+		AmpMeasureParams *p, double *max_amplitude, double *period, 
+		double *time_of_max_amplitude, double *bandw)
 {
     /*
      * External resources
@@ -471,16 +543,16 @@ int Amp:: measure_SP_pp_amplitude(float *beam, double samprate, int nsamples,
     /*
      * Initialize
      */
-    zero_phase = Application::getProperty("mb_filter_zp", true);
-    loCut = Application::getProperty("mb_filter_locut", 0.8);
-    hiCut = Application::getProperty("mb_filter_hicut", 4.5);
+    zero_phase = p->zero_phase;
+    loCut = p->locut;
+    hiCut = p->hicut;
     *bandw = hiCut - loCut;
-    filt_order = Application::getProperty("mb_filter_order", 3);
-    taper_fract = Application::getProperty("mb_taper_frac", 0.05);
-    mb_amp_threshold1 = Application::getProperty("mb_amp_theshold1", 15.);
-    mb_filter_margin = Application::getProperty("mb_filter_margin", 10.);
-    mb_lead = Application::getProperty("mb_lead", 0.5);
-    mb_length = Application::getProperty("mb_length", 7.0);
+    filt_order = p->filt_order;
+    mb_amp_threshold1 = p->amp_threshold1;
+    mb_filter_margin = p->filter_margin;
+    mb_lead = p->lead;
+    mb_length = p->length;
+    filt_type = p->filt_type;
 
     *max_amplitude = NA_AMPLITUDE;
     *period = NA_PERIOD;
@@ -494,9 +566,6 @@ int Amp:: measure_SP_pp_amplitude(float *beam, double samprate, int nsamples,
     }
     fprintf(stderr, "\n");
 zz */
-    if( !Application::getProperty("mb_filter_type", filt_type) ) {
-	filt_type.assign("BP");
-    }
 
     /*
      * Filter the signal based on a defined procedure
@@ -0,0 +1,509 @@
+/** \file AmpBatch.cpp
+ *  \brief Defines class AmpBatch.
+ */
+#include "config.h"
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AmpBatch.h"
+#include "TaperData.h"
+#include "IIRFilter.h"
+
+extern "C" {
+#include "libstring.h"
+#include "logErrorMsg.h"
+}
+
+using namespace std;
+
+static double windowSnr(float *data, int n, double t0, double tdel,
+		double time, const AmpBatchParams *p);
+static bool sameFilters(const AmpBatchParams &a, const AmpBatchParams &b);
+
+/** Constructor. */
+AmpBatch::AmpBatch(void)
+{
+}
+
+/** Destructor. */
+AmpBatch::~AmpBatch(void)
+{
+    for(int j = 0; j < (int)chans.size(); j++) {
+	chans[j].ts->release();
+	if(chans[j].raw_ts) chans[j].raw_ts->release();
+    }
+    for(int k = 0; k < (int)tasks.size(); k++) {
+	if(tasks[k].mb_ts) tasks[k].mb_ts->release();
+	if(tasks[k].ml_ts) tasks[k].ml_ts->release();
+    }
+}
+
+/** Add an arrival to measure. Arrivals that are added with the same
+ *  GTimeSeries share one read of the data.
+ *  @param[in] ts the waveform of the station and channel of the arrival.
+ *  @param[in] arrival the arrival.
+ *  @param[in] mb measure the mb amplitude.
+ *  @param[in] ml measure the ml amplitude.
+ *  @param[in] p the measurement parameters. They are copied.
+ */
+void AmpBatch::add(GTimeSeries *ts, CssArrivalClass *arrival, bool mb,
+			bool ml, const AmpBatchParams &p)
+{
+    int j, k;
+    double tbeg, tend;
+    AmpBatchTask t;
+
+    if( !mb && !ml ) return;
+
+    k = addParams(p);
+
+    for(j = 0; j < (int)chans.size() && chans[j].ts != ts; j++);
+    if(j == (int)chans.size()) {
+	AmpBatchChannel c;
+	c.ts = ts;
+	c.ts->retain();
+	c.tbeg = arrival->time;
+	c.tend = arrival->time;
+	c.raw_ts = NULL;
+	chans.push_back(c);
+    }
+    AmpBatchChannel *c = &chans[j];
+
+    if(mb) {
+	tbeg = arrival->time - p.mb_lead - p.mb_filter_margin - 0.5;
+	tend = arrival->time - p.mb_lead + p.mb_length + p.mb_filter_margin
+			+ 0.5;
+	if(tbeg < c->tbeg) c->tbeg = tbeg;
+	if(tend > c->tend) c->tend = tend;
+    }
+    if(ml) {
+	tbeg = arrival->time - p.ml_lta_lead - p.mb_filter_margin - 0.5;
+	tend = arrival->time - p.ml_lta_lead + p.ml_lta_length
+			+ p.mb_filter_margin + 0.5;
+	if(tbeg < c->tbeg) c->tbeg = tbeg;
+	if(tend > c->tend) c->tend = tend;
+    }
+    memset(&t, 0, sizeof(t));
+    t.arrival = arrival;
+    t.chan = j;
+    t.params = k;
+    t.mb = mb;
+    t.ml = ml;
+    tasks.push_back(t);
+}
+
+/** Find or add a copy of the parameters.
+ *  @returns the index of the parameters.
+ */
+int AmpBatch::addParams(const AmpBatchParams &p)
+{
+    int k;
+
+    for(k = (int)params.size()-1; k >= 0; k--) {
+	const AmpBatchParams &q = params[k];
+	if(sameFilters(p, q) && p.mp.amp_threshold1 == q.mp.amp_threshold1
+		&& p.mb_lead == q.mb_lead && p.mb_length == q.mb_length
+		&& p.mb_amptype == q.mb_amptype
+		&& p.mb_allow_counts == q.mb_allow_counts
+		&& p.mb_counts_amptype == q.mb_counts_amptype
+		&& p.ml_amptype == q.ml_amptype
+		&& p.ml_sta_lead == q.ml_sta_lead
+		&& p.ml_sta_window == q.ml_sta_window
+		&& p.ml_sta_length == q.ml_sta_length
+		&& p.ml_lta_lead == q.ml_lta_lead
+		&& p.ml_lta_length == q.ml_lta_length
+		&& p.stav_len == q.stav_len && p.ltav_len == q.ltav_len) break;
+    }
+    if(k < 0) {
+	k = (int)params.size();
+	params.push_back(p);
+    }
+    return k;
+}
+
+/** Measure the amplitudes of all of the arrivals. The data is read and the
+ *  windows are filtered in the calling thread. The mb and ml measurements
+ *  are then made on num_threads threads. The conversion of
+ *  the mb amplitudes to nanometers uses the instrument responses, so it is
+ *  done in the calling thread.
+ *  @param[in] num_threads the number of threads, or <= 0 for one per
+ *	processor.
+ *  @param[out] results one entry for each arrival, in the order they were
+ *	added. The caller owns the amplitudes.
+ *  @returns the number of amplitudes measured.
+ */
+int AmpBatch::measure(int num_threads, vector<AmpBatchResult> &results)
+{
+    int j, k, num = 0;
+
+    results.clear();
+
+    for(j = 0; j < (int)chans.size(); j++) readChannel(&chans[j]);
+
+    for(k = 0; k < (int)tasks.size(); k++) filterWindows(&tasks[k]);
+
+    // the windows hold all the data that the measurements need
+    for(j = 0; j < (int)chans.size(); j++) {
+	if(chans[j].raw_ts) chans[j].raw_ts->release();
+	chans[j].raw_ts = NULL;
+    }
+
+    parallel_run_thread((int)tasks.size(), num_threads, measureTask, this);
+
+    for(k = 0; k < (int)tasks.size(); k++)
+    {
+	AmpBatchResult r;
+	r.arrival = tasks[k].arrival;
+	r.mb = tasks[k].mb;
+	r.ml = tasks[k].ml;
+	r.mb_amp = mbAmplitude(&tasks[k]);
+	r.ml_amp = mlAmplitude(&tasks[k]);
+	if(r.mb_amp) num++;
+	if(r.ml_amp) num++;
+	results.push_back(r);
+    }
+
+    // the filtered data is no longer needed
+    for(k = 0; k < (int)tasks.size(); k++) {
+	if(tasks[k].mb_ts) tasks[k].mb_ts->release();
+	if(tasks[k].ml_ts) tasks[k].ml_ts->release();
+	tasks[k].mb_ts = tasks[k].ml_ts = NULL;
+	tasks[k].mb_seg = tasks[k].ml_seg = NULL;
+    }
+    return num;
+}
+
+/** Reread the unprocessed data of the span of a channel.
+ */
+void AmpBatch::readChannel(AmpBatchChannel *c)
+{
+    char msg[200];
+    GTimeSeries *ts;
+
+    if( !(ts = c->ts->subseries(c->tbeg, c->tend)) ) {
+	snprintf(msg, sizeof(msg), "AmpBatch: no data for %s/%s",
+		c->ts->sta(), c->ts->chan());
+	logErrorMsg(LOG_WARNING, msg);
+	return;
+    }
+    ts->setOriginalStart(c->tbeg);
+    ts->setOriginalEnd(c->tend);
+
+    if( !ts->removeAllMethods() && !ts->reread() ) {
+	snprintf(msg, sizeof(msg), "AmpBatch: cannot reread %s/%s",
+		ts->sta(), ts->chan());
+	logErrorMsg(LOG_WARNING, msg);
+	ts->deleteObject();
+	return;
+    }
+    c->raw_ts = ts;
+    c->raw_ts->retain();
+}
+
+/** Cut the mb and ml windows of a task from the unprocessed span and filter
+ *  them, with the windows, taper and filters of
+ *  WaveformPlot::measureMBAmp and WaveformPlot::measureAmplitudes.
+ */
+void AmpBatch::filterWindows(AmpBatchTask *t)
+{
+    char msg[200];
+    AmpBatchChannel *c = &chans[t->chan];
+    AmpBatchParams *p = &params[t->params];
+    double tbeg, tend, time = t->arrival->time;
+
+    if( !c->raw_ts ) return;
+
+    if(t->mb) {
+	tbeg = time - p->mb_lead - p->mb_filter_margin - 0.5;
+	tend = time - p->mb_lead + p->mb_length + p->mb_filter_margin + 0.5;
+	if(c->ts->segment(tbeg) != c->ts->segment(tend)) {
+	    snprintf(msg, sizeof(msg),
+		"AmpBatch: %s/%s data is not continuous for the mb window of arid=%ld",
+		c->ts->sta(), c->ts->chan(), t->arrival->arid);
+	    logErrorMsg(LOG_WARNING, msg);
+	}
+	else if( (t->mb_ts = filterWindow(c, tbeg, tend,
+			(int)(100*p->mb_taper_frac + .5), p->mb_filter_order,
+			p->mb_filter_type, p->mb_filter_locut,
+			p->mb_filter_hicut, p->mb_filter_zp)) )
+	{
+	    t->mb_seg = t->mb_ts->segment(0);
+	}
+    }
+    if(t->ml) {
+	tbeg = time - p->ml_lta_lead - p->mb_filter_margin - 0.5;
+	tend = time - p->ml_lta_lead + p->ml_lta_length + p->mb_filter_margin
+			+ 0.5;
+	if( (t->ml_ts = filterWindow(c, tbeg, tend, 5, p->ml_filter_order,
+			p->ml_filter_type, p->ml_filter_locut,
+			p->ml_filter_hicut, p->ml_filter_zp)) )
+	{
+	    t->ml_seg = t->ml_ts->segment(time);
+	}
+    }
+}
+
+/** Cut a window from the unprocessed span of a channel, taper it and filter
+ *  it. The data of the window is not shared, so a thread can change it.
+ *  @returns the filtered window, or NULL if there is no data in it.
+ */
+GTimeSeries * AmpBatch::filterWindow(AmpBatchChannel *c, double tbeg,
+		double tend, int taper_percent, int order, const string &type,
+		double locut, double hicut, bool zp)
+{
+    GTimeSeries *ts;
+
+    if( !(ts = c->raw_ts->subseries(tbeg, tend)) ) return NULL;
+    ts->retain();
+
+    TaperData *taper = new TaperData("cosine", taper_percent, 5, 200);
+    taper->apply(ts);
+    taper->deleteObject();
+
+    IIRFilter *filter = new IIRFilter(order, type, locut, hicut,
+		c->ts->segment(0)->tdel(), zp);
+    filter->apply(ts);
+    filter->deleteObject();
+
+    for(int i = 0; i < ts->size(); i++) ts->segment(i)->unshare();
+    return ts;
+}
+
+/* Measure the amplitudes of tasks[k] on its filtered windows.
+ */
+void AmpBatch::measureTask(int k, int thread, void *arg)
+{
+    AmpBatch *b = (AmpBatch *)arg;
+    AmpBatchTask *t = &b->tasks[k];
+    AmpBatchParams *p = &b->params[t->params];
+    GSegment *s;
+    double tdel;
+    int i, n;
+
+    if( (s = t->mb_seg) ) {
+	tdel = s->tdel();
+
+	/* the max_amplitude is half peak to peak */
+	t->mb_ret = Amp::measure_SP_pp_amplitude(s->data, 1./tdel,
+			s->length(), s->tbeg(), t->arrival->time, &p->mp,
+			&t->max_amplitude, &t->period, &t->time_of_max,
+			&t->bandw);
+	if(t->mb_ret == 0) {
+	    t->mb_snr = windowSnr(s->data, s->length(), s->tbeg(), tdel,
+				t->arrival->time, p);
+	}
+    }
+
+    if( (s = t->ml_seg) ) {
+	double calib = s->calib();
+
+	tdel = s->tdel();
+	n = s->length();
+	for(i = 0; i < n; i++) {
+	    s->data[i] = fabs(calib*s->data[i]);
+	}
+	mlppn(s->data, n, (int)((t->arrival->time - s->tbeg())/tdel),
+		1./tdel, p, &t->ml_amp, &t->ml_snr);
+    }
+}
+
+/** Make the mb amplitude record of a measured task.
+ *  @returns the amplitude in nanometers, or NULL if it was not measured.
+ */
+CssAmplitudeClass * AmpBatch::mbAmplitude(AmpBatchTask *t)
+{
+    AmpBatchChannel *c = &chans[t->chan];
+    AmpBatchParams *p = &params[t->params];
+    CssAmplitudeClass *amp;
+    char *err_msg, msg[200];
+
+    if( !t->mb_seg ) return NULL;
+
+    amp = new CssAmplitudeClass();
+
+    amp->arid = t->arrival->arid;
+    strncpy(amp->chan, c->ts->chan(), sizeof(amp->chan));
+    amp->chan_quark = stringToQuark(amp->chan);
+    amp->amptime = t->arrival->time;
+    amp->start_time = t->mb_ts->tbeg();
+    amp->duration = t->mb_ts->tend() - t->mb_ts->tbeg();
+    strncpy(amp->amptype, p->mb_amptype.c_str(), sizeof(amp->amptype));
+    strncpy(amp->inarrival, "y", sizeof(amp->inarrival));
+    amp->bandw = t->bandw;
+
+    Amp::getAmpError();
+    if(t->mb_ret == 0 && Amp::countsToNms(t->mb_ts, t->mb_seg,
+		t->max_amplitude, t->period, t->time_of_max,
+		p->mb_allow_counts, p->mb_counts_amptype, amp))
+    {
+	amp->snr = t->mb_snr;
+	return amp;
+    }
+    if( (err_msg = Amp::getAmpError()) ) logErrorMsg(LOG_ERR, err_msg);
+    snprintf(msg, sizeof(msg),
+		"AmpBatch: cannot measure mb for %s/%s arid=%ld",
+		c->ts->sta(), c->ts->chan(), t->arrival->arid);
+    logErrorMsg(LOG_WARNING, msg);
+    delete amp;
+    return NULL;
+}
+
+/** Make the ml amplitude record of a measured task.
+ *  @returns the amplitude, or NULL if it was not measured.
+ */
+CssAmplitudeClass * AmpBatch::mlAmplitude(AmpBatchTask *t)
+{
+    AmpBatchChannel *c = &chans[t->chan];
+    AmpBatchParams *p = &params[t->params];
+    CssAmplitudeClass *amp;
+
+    if( !t->ml_seg ) return NULL;
+
+    amp = new CssAmplitudeClass();
+
+    amp->arid = t->arrival->arid;
+    strncpy(amp->chan, c->ts->chan(), sizeof(amp->chan));
+    amp->chan_quark = stringToQuark(amp->chan);
+    amp->amptime = t->arrival->time;
+    amp->start_time = t->ml_seg->tbeg();
+    amp->duration = t->ml_seg->tend() - t->ml_seg->tbeg();
+    strncpy(amp->amptype, p->ml_amptype.c_str(), sizeof(amp->amptype));
+    strncpy(amp->inarrival, "n", sizeof(amp->inarrival));
+    amp->bandw = p->ml_filter_hicut - p->ml_filter_locut;
+    amp->amp = t->ml_amp;
+    amp->snr = t->ml_snr;
+    return amp;
+}
+
+/**
+ * Compute the ml amplitude and snr of a window of filtered data, as
+ * WaveformPlot::mlppn does with the AmplitudeParams.
+ *         amp = sqrt(sta^2 - lta^2)
+ * @param(in)  databuf - the absolute value of the ml filtered data
+ * @param(in)  dim - length of databuf
+ * @param(in)  atPoint - position of arrival time in databuf
+ * @param(in)  sps - samples per second
+ * @param(in)  p - the ml_sta and ml_lta window parameters
+ * @param(out) amp - the amplitude
+ * @param(out) snr - sta/lta
+ */
+void AmpBatch::mlppn(float *databuf, int dim, int atPoint, double sps,
+		const AmpBatchParams *p, double *amp, double *snr)
+{
+    double tamp, sta = 0, lta = 0;
+    int i, spoint, epoint, step, npts;
+
+    /* calculate the long term average in a window starting at ml_lta_lead
+     * seconds before the arrival with a length of ml_lta_length.
+     */
+    spoint = (int)floor((atPoint - p->ml_lta_lead * sps) + 0.5);
+    epoint = (int)floor((spoint + p->ml_lta_length * sps) + 0.5);
+
+    if(spoint < 0) spoint = 0;
+    if(epoint >= dim) epoint = dim-1;
+
+    if (spoint > 0) {
+
+	for (i = spoint; i < epoint; i++)
+	    lta += fabs(databuf[i]);
+
+	lta = lta / (epoint-spoint);
+
+    }
+
+    /* calculate the short term average in a window of length ml_sta_length
+     * starting a ml_sta_lead before the arrival.
+     */
+    spoint = (int)floor((atPoint - p->ml_sta_lead * sps) + 0.5);
+    epoint = (int)floor((spoint + p->ml_sta_length * sps) + 0.5);
+
+    // compute average for the first window of length ml_sta_length
+    for (i = spoint; i < epoint; i++)
+	sta += fabs(databuf[i]);
+
+    npts = epoint - spoint; // number of values in the window
+    sta = sta / npts;
+    spoint = epoint;
+
+    // this is equal to atPoint - ml_sta_lead*sps + ml_sta_window*sps
+    epoint = (int)floor((epoint +
+		(p->ml_sta_window - p->ml_sta_length) * sps) + 0.5);
+    step = (int)floor((p->ml_sta_length * sps - 1) + 0.5);
+    tamp = sta;
+
+    for(i = spoint; i < epoint; i++) {
+
+	// subtract the oldest point and add the newest point as the end of
+	// the window slides from spoint to epoint
+	tamp = tamp + (fabs(databuf[i]) - fabs(databuf[(i - step)])) / npts;
+
+	/* keep the highest sta */
+	if( tamp > sta) sta = tamp;
+
+    }
+
+    if (sta > lta)
+	*amp = sqrt(pow(sta, 2) - pow(lta, 2));
+
+    if (lta >= sta)
+	*amp = sta;
+
+    *snr = sta/lta;
+}
+
+/* The signal to noise ratio of WaveformPlot::getSnr: the mean absolute
+ * value stav_len seconds after time over the mean ltav_len seconds before
+ * time.
+ */
+static double
+windowSnr(float *data, int n, double t0, double tdel, double time,
+		const AmpBatchParams *p)
+{
+    int i, i1, i2, np;
+    double ltav = 0., stav = 0.;
+
+    i1 = (int)ceil((time - p->ltav_len - t0)/tdel);
+    i2 = (int)floor((time - t0)/tdel);
+    if(i1 < 0) i1 = 0;
+    if(i2 > n-1) i2 = n-1;
+    for(i = i1, np = 0; i <= i2; i++, np++) ltav += fabs(data[i]);
+    if(np) ltav /= np;
+
+    i1 = (int)ceil((time - t0)/tdel);
+    i2 = (int)floor((time + p->stav_len - t0)/tdel);
+    if(i1 < 0) i1 = 0;
+    if(i2 > n-1) i2 = n-1;
+    for(i = i1, np = 0; i <= i2; i++, np++) stav += fabs(data[i]);
+    if(np) stav /= np;
+
+    return (ltav != 0.) ? stav/ltav : -1.;
+}
+
+/* True if a and b filter the data in the same way.
+ */
+static bool
+sameFilters(const AmpBatchParams &a, const AmpBatchParams &b)
+{
+    return (a.mb_filter_margin == b.mb_filter_margin
+	&& a.mb_taper_frac == b.mb_taper_frac
+	&& a.mb_filter_type == b.mb_filter_type
+	&& a.mb_filter_order == b.mb_filter_order
+	&& a.mb_filter_locut == b.mb_filter_locut
+	&& a.mb_filter_hicut == b.mb_filter_hicut
+	&& a.mb_filter_zp == b.mb_filter_zp
+	&& a.ml_filter_type == b.ml_filter_type
+	&& a.ml_filter_order == b.ml_filter_order
+	&& a.ml_filter_locut == b.ml_filter_locut
+	&& a.ml_filter_hicut == b.ml_filter_hicut
+	&& a.ml_filter_zp == b.ml_filter_zp
+	&& a.mp.filt_type == b.mp.filt_type
+	&& a.mp.zero_phase == b.mp.zero_phase
+	&& a.mp.locut == b.mp.locut
+	&& a.mp.hicut == b.mp.hicut
+	&& a.mp.filt_order == b.mp.filt_order
+	&& a.mp.filter_margin == b.mp.filter_margin
+	&& a.mp.lead == b.mp.lead
+	&& a.mp.length == b.mp.length);
+}
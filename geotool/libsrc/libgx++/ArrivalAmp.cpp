@@ -16,6 +16,7 @@
 
 #include "WaveformPlot.h"
 #include "Amp.h"
+#include "AmpBatch.h"
 #include "FKData.h"
 #include "Waveform.h"
 #include "BasicSource.h"
@@ -1282,40 +1283,25 @@ bool WaveformPlot::associateWithOrigin(DataSource *ds, CssArrivalClass *arrival,
     }
 }
 
-bool WaveformPlot::measureAmplitudes(gvector<Waveform *> &wvec,
-		CssArrivalClass *arrival, CssAmplitudeClass **amp_mb,
-		CssAmplitudeClass **amp_ml, AmpMeasureMode mode)
+/* Find the assoc and origin of an arrival and decide whether mb and ml
+ * amplitudes are measured for it from the phase, distance and depth limits
+ * of the AmplitudeParams.
+ */
+void WaveformPlot::ampMeasureTypes(CssArrivalClass *arrival,
+		cvector<CssAssocClass> &assocs, cvector<CssOriginClass> &origins,
+		AmpMeasureMode mode, CssAssocClass **assoc_found,
+		CssOriginClass **origin_found, bool *measure_mb_amp,
+		bool *measure_ml_amp)
 {
-    int i, time_pos;
-    bool measure_mb_amp = false, measure_ml_amp = false;
-    double sps;
-    GTimeSeries *ts;
-    GSegment *segment = NULL;
-    cvector<CssAssocClass> assocs;
+    int i;
     CssAssocClass *assoc=NULL;
     CssOriginClass *origin=NULL;
-    CssAmplitudeClass *mb_amp=NULL, *ml_amp=NULL;
-    AmplitudeParams *ap;
-    Application *app = Application::getApplication();
-
-    if(wvec.size() > 0) app->putParseProperty("ma_net", wvec[0]->net());
-    app->putParseProperty("ma_sta", arrival->sta);
-    app->putParseProperty("ma_chan", arrival->chan);
-    app->putParseProperty("ma_phase", arrival->phase);
-    doCallbacks(this, NULL, "measureAmplitudeCallback");
-
-    ap = amplitudeParams();
-
-    *amp_mb = NULL;
-    *amp_ml = NULL;
+    AmplitudeParams *ap = amplitudeParams();
 
-    if(wvec.size() <= 0) {
-	printLog("measureAmplitudes: num_waveforms = 0\n");
-	return false;
-    }
+    *measure_mb_amp = false;
+    *measure_ml_amp = false;
 
     // find assoc for arrival.arid
-    getTable(assocs);
     for(i = 0; i < assocs.size() && arrival->arid != assocs[i]->arid; i++);
     if(i < assocs.size()) {
 	assoc = assocs[i];
@@ -1323,8 +1309,6 @@ bool WaveformPlot::measureAmplitudes(gvector<Waveform *> &wvec,
 
     if(assoc) {
 	// find origin for assoc.orid
-	cvector<CssOriginClass> origins;
-	getTable(origins);
 	for(i = 0; i < origins.size() && assoc->orid != origins[i]->orid; i++);
 	if(i < origins.size()) {
 	    origin = origins[i];
@@ -1342,7 +1326,7 @@ bool WaveformPlot::measureAmplitudes(gvector<Waveform *> &wvec,
 	    && origin->depth >= ap->ml_depth_min
 	    && origin->depth <= ap->ml_depth_max)
 	{
-	    measure_ml_amp = true;
+	    *measure_ml_amp = true;
 	}
     }
 
@@ -1355,19 +1339,61 @@ bool WaveformPlot::measureAmplitudes(gvector<Waveform *> &wvec,
 	    && assoc->delta >= ap->mb_dist_min
 	    && assoc->delta <= ap->mb_dist_max)
 	{
-	    measure_mb_amp = true;
+	    *measure_mb_amp = true;
 	}
     }
 
     if(mode == ML_MEASURE) {
-	measure_ml_amp = true;
-	measure_mb_amp = false;
+	*measure_ml_amp = true;
+	*measure_mb_amp = false;
     }
     else if(mode == MB_MEASURE) {
-	measure_ml_amp = false;
-	measure_mb_amp = true;
+	*measure_ml_amp = false;
+	*measure_mb_amp = true;
+    }
+
+    *assoc_found = assoc;
+    *origin_found = origin;
+}
+
+bool WaveformPlot::measureAmplitudes(gvector<Waveform *> &wvec,
+		CssArrivalClass *arrival, CssAmplitudeClass **amp_mb,
+		CssAmplitudeClass **amp_ml, AmpMeasureMode mode)
+{
+    int i, time_pos;
+    bool measure_mb_amp = false, measure_ml_amp = false;
+    double sps;
+    GTimeSeries *ts;
+    GSegment *segment = NULL;
+    cvector<CssAssocClass> assocs;
+    cvector<CssOriginClass> origins;
+    CssAssocClass *assoc=NULL;
+    CssOriginClass *origin=NULL;
+    CssAmplitudeClass *mb_amp=NULL, *ml_amp=NULL;
+    AmplitudeParams *ap;
+    Application *app = Application::getApplication();
+
+    if(wvec.size() > 0) app->putParseProperty("ma_net", wvec[0]->net());
+    app->putParseProperty("ma_sta", arrival->sta);
+    app->putParseProperty("ma_chan", arrival->chan);
+    app->putParseProperty("ma_phase", arrival->phase);
+    doCallbacks(this, NULL, "measureAmplitudeCallback");
+
+    ap = amplitudeParams();
+
+    *amp_mb = NULL;
+    *amp_ml = NULL;
+
+    if(wvec.size() <= 0) {
+	printLog("measureAmplitudes: num_waveforms = 0\n");
+	return false;
     }
 
+    getTable(assocs);
+    getTable(origins);
+    ampMeasureTypes(arrival, assocs, origins, mode, &assoc, &origin,
+		&measure_mb_amp, &measure_ml_amp);
+
     if( !measure_ml_amp && !measure_mb_amp ) {
 	return false;
     }
@@ -1459,6 +1485,7 @@ bool WaveformPlot::measureAmplitudes(gvector<Waveform *> &wvec,
 		sps = 1/segment->tdel();
 		time_pos = (int)((arrival->time - segment->tbeg())/
 				segment->tdel());
+		segment->unshare();
 		for(i = 0; i < segment->length(); i++) {
 		    segment->data[i] = fabs(calib*segment->data[i]);
 		}
@@ -1579,84 +1606,172 @@ bool WaveformPlot::saveAmp(DataSource *ds, CssArrivalClass *arrival,
     return true;
 }
 
-/*
- * mlppn - calculating IDC ML amplitude namely the maximum one second
- *         average in the first four seconds after phase time arrival (sta)
- *         corrected by the noise (30 seconds before phase time arrival) (lta)
- *         amp = sqrt(sta^2 - lta^2)
- * @param(in)  databuf - array of data float for ml, it should be filtered
- *             between 2 and 4 Hz
- * @param(in)  dim - length of databuf
- * @param(in)  atPoint - position of arrival time in databuf
- * @param(in)  sps - samples per second
- * @param(out) amp - array[2] of amplitude, snr (= sta/lta)
- *
+/** Measure and save the amplitudes of many arrivals. This is the batch form
+ *  of measureAmps for reprocessing. Each arrival is measured on the waveform
+ *  of its station and channel. As in measureAmplitudes, the ma_net, ma_sta,
+ *  ma_chan and ma_phase properties are set and the measureAmplitudeCallback
+ *  is called for each arrival before its parameters are taken from the
+ *  AmplitudeParams. The arrivals are then measured together by an AmpBatch,
+ *  which reads and filters each waveform once and makes the measurements on
+ *  num_threads threads. The amplitudes are saved with saveAmp. Arrivals
+ *  without a waveform of their own channel, such as array beam arrivals, are
+ *  measured with measureAmps.
+ *  @param[in] arrivals the arrivals.
+ *  @param[in] mode AUTO_MEASURE, ML_MEASURE, or MB_MEASURE.
+ *  @param[in] num_threads the number of threads, or <= 0 for one per
+ *	processor.
+ *  @returns the number of amplitudes saved.
  */
-void WaveformPlot::mlppn(float *databuf, int dim, int atPoint, double sps,
-		   double *amp, double *snr)
+int WaveformPlot::measureAmpsBatch(cvector<CssArrivalClass> &arrivals,
+			AmpMeasureMode mode, int num_threads)
 {
+    int i, k, num, nsaved = 0, nfailed = 0;
+    bool mb, ml;
+    DataSource *ds;
+    AmpBatch batch;
+    AmpBatchParams p;
+    CssAssocClass *assoc;
+    CssOriginClass *origin;
+    cvector<CssAssocClass> assocs;
+    cvector<CssOriginClass> origins;
+    cvector<CssArrivalClass> others;
+    gvector<Waveform *> ws;
+    vector<AmpBatchResult> results;
+    Application *app = Application::getApplication();
 
-    double tamp, sta = 0, lta = 0;   
-    int i, spoint, epoint, step, npts;
-    AmplitudeParams *ap = amplitudeParams();
-
-    /* calculate the long term average in a window starting at ml_lta_lead
-     * seconds before the arrival with a length of ml_lta_length.
-     */
-    spoint = (int)floor((atPoint - ap->ml_lta_lead * sps) + 0.5);
-    epoint = (int)floor((spoint + ap->ml_lta_length * sps) + 0.5);
+    num = getWaveforms(ws);
+    getTable(assocs);
+    getTable(origins);
 
-    if(spoint < 0) spoint = 0;
-    if(epoint >= dim) epoint = dim-1;
+    for(k = 0; k < arrivals.size(); k++)
+    {
+	CssArrivalClass *arrival = arrivals[k];
 
-    if (spoint > 0) {
+	if( !arrival->getDataSource() ) continue;
 
-	for (i = spoint; i < epoint; i++)
-	    lta += fabs(databuf[i]);
+	for(i = 0; i < num; i++) {
+	    if( (!strcasecmp(ws[i]->sta(), arrival->sta) ||
+		 !strcasecmp(ws[i]->net(), arrival->sta)) &&
+		DataSource::compareChan(ws[i]->chan(), arrival->chan) &&
+		ws[i]->segment(arrival->time) ) break;
+	}
+	if(i == num) {
+	    others.push_back(arrival);
+	    continue;
+	}
+	app->putParseProperty("ma_net", ws[i]->net());
+	app->putParseProperty("ma_sta", arrival->sta);
+	app->putParseProperty("ma_chan", arrival->chan);
+	app->putParseProperty("ma_phase", arrival->phase);
+	doCallbacks(this, NULL, "measureAmplitudeCallback");
 
-	lta = lta / (epoint-spoint);
+	ampMeasureTypes(arrival, assocs, origins, mode, &assoc, &origin,
+			&mb, &ml);
+	if( !mb && !ml ) continue;
 
+	getAmpBatchParams(&p);
+	batch.add(ws[i]->ts, arrival, mb, ml, p);
     }
 
-    /* calculate the short term average in a window of length ml_sta_length
-     * starting a ml_sta_lead before the arrival.
-     */
-    spoint = (int)floor((atPoint - ap->ml_sta_lead * sps) + 0.5);
-    epoint = (int)floor((spoint + ap->ml_sta_length * sps) + 0.5);
+    batch.measure(num_threads, results);
 
-    // compute average for the first window of length ml_sta_length
-    for (i = spoint; i < epoint; i++)
-	sta += fabs(databuf[i]); 
-
-    npts = epoint - spoint; // number of values in the window
-    sta = sta / npts;
-    spoint = epoint;
+    for(k = 0; k < (int)results.size(); k++)
+    {
+	AmpBatchResult *r = &results[k];
 
-    // this is equal to atPoint - ml_sta_lead*sps + ml_sta_window*sps
-    epoint = (int)floor((epoint +
-		(ap->ml_sta_window - ap->ml_sta_length) * sps) + 0.5);
-    step = (int)floor((ap->ml_sta_length * sps - 1) + 0.5);
-    tamp = sta;
+	ds = r->arrival->getDataSource();
 
-    for(i = spoint; i < epoint; i++) {
+	if(r->mb_amp) {
+	    printLog("%s/%s: measured mb amp=%.2lf per=%.2lf\n",
+		r->arrival->sta, r->mb_amp->chan, r->mb_amp->amp,
+		r->mb_amp->per);
+	    if(saveAmp(ds, r->arrival, r->mb_amp)) nsaved++;
+	}
+	else if(r->mb) {
+	    printLog("measureAmpsBatch: cannot measure mb for %s/%s arid=%ld\n",
+		r->arrival->sta, r->arrival->chan, r->arrival->arid);
+	    nfailed++;
+	}
+	if(r->ml_amp) {
+	    printLog("%s/%s: measured ml amp=%.2lf snr=%.2lf\n",
+		r->arrival->sta, r->ml_amp->chan, r->ml_amp->amp,
+		r->ml_amp->snr);
+	    if(saveAmp(ds, r->arrival, r->ml_amp)) nsaved++;
+	}
+	else if(r->ml) {
+	    nfailed++;
+	}
+    }
 
-	// subtract the oldest point and add the newest point as the end of
-	// the window slides from spoint to epoint
-	tamp = tamp + (fabs(databuf[i]) - fabs(databuf[(i - step)])) / npts;
+    /* Arrivals that are measured on beams or other channels.
+     */
+    for(k = 0; k < others.size(); k++) {
+	measureAmps(others[k], NULL, mode);
+    }
 
-	/* keep the highest sta */
-	if( tamp > sta) sta = tamp;
+    printLog("measureAmpsBatch: %d arrivals, %d amplitudes saved, %d failed, %d measured singly\n",
+	batch.size(), nsaved, nfailed, others.size());
 
-    }
+    return nsaved;
+}
 
-    if (sta > lta)
-	*amp = sqrt(pow(sta, 2) - pow(lta, 2));
+/** Copy the amplitude parameters for an AmpBatch.
+ *  @param[out] p the parameters of the AmplitudeParams, the
+ *	measure_SP_pp_amplitude properties and the TimeParams.
+ */
+void WaveformPlot::getAmpBatchParams(AmpBatchParams *p)
+{
+    AmplitudeParams *ap = amplitudeParams();
+    TimeParams tp = getTimeParams();
 
-    if (lta >= sta)
-	*amp = sta;
+    Amp::getMeasureParams(&p->mp);
+    p->mb_amptype = ap->mb_amptype;
+    p->mb_filter_margin = ap->mb_filter_margin;
+    p->mb_lead = ap->mb_lead;
+    p->mb_length = ap->mb_length;
+    p->mb_taper_frac = ap->mb_taper_frac;
+    p->mb_filter_type = ap->mb_filter_type;
+    p->mb_filter_order = ap->mb_filter_order;
+    p->mb_filter_locut = ap->mb_filter_locut;
+    p->mb_filter_hicut = ap->mb_filter_hicut;
+    p->mb_filter_zp = ap->mb_filter_zp;
+    p->mb_allow_counts = ap->mb_allow_counts;
+    p->mb_counts_amptype = ap->mb_counts_amptype;
+    p->ml_amptype = ap->ml_amptype;
+    p->ml_sta_lead = ap->ml_sta_lead;
+    p->ml_sta_window = ap->ml_sta_window;
+    p->ml_sta_length = ap->ml_sta_length;
+    p->ml_lta_lead = ap->ml_lta_lead;
+    p->ml_lta_length = ap->ml_lta_length;
+    p->ml_filter_type = ap->ml_filter_type;
+    p->ml_filter_order = ap->ml_filter_order;
+    p->ml_filter_locut = ap->ml_filter_locut;
+    p->ml_filter_hicut = ap->ml_filter_hicut;
+    p->ml_filter_zp = ap->ml_filter_zp;
+    p->stav_len = tp.stav_len;
+    p->ltav_len = tp.ltav_len;
+}
 
-    *snr = sta/lta;
+/*
+ * mlppn - calculating IDC ML amplitude namely the maximum one second
+ *         average in the first four seconds after phase time arrival (sta)
+ *         corrected by the noise (30 seconds before phase time arrival) (lta)
+ *         amp = sqrt(sta^2 - lta^2)
+ * @param(in)  databuf - array of data float for ml, it should be filtered
+ *             between 2 and 4 Hz
+ * @param(in)  dim - length of databuf
+ * @param(in)  atPoint - position of arrival time in databuf
+ * @param(in)  sps - samples per second
+ * @param(out) amp - array[2] of amplitude, snr (= sta/lta)
+ *
+ */
+void WaveformPlot::mlppn(float *databuf, int dim, int atPoint, double sps,
+		   double *amp, double *snr)
+{
+    AmpBatchParams p;
 
+    getAmpBatchParams(&p);
+    AmpBatch::mlppn(databuf, dim, atPoint, sps, &p, amp, snr);
 }
 
 void WaveformPlot::measureArrayAmp(gvector<Waveform *> &wvec,
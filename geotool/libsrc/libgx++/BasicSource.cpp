@@ -17,6 +17,7 @@
 #include "ConvolveData.h"
 #include "gobject++/CssTables.h"
 #include "cssio.h"
+#include "ProfileTimer.h"
 
 extern "C" {
 #include "libgmath.h"
@@ -203,6 +204,7 @@ int BasicSource::readData(gvector<SegmentInfo *> *seginfo, double start_time,
     SegmentInfo	*s;
     GTimeSeries		*timeSeries = NULL;
     double		tbeg, tend, tmin, tmax;
+    ProfileTimer	pt("DataSource::readData");
 
     *err_msg = NULL;
 
@@ -236,6 +238,7 @@ int BasicSource::readData(gvector<SegmentInfo *> *seginfo, double start_time,
 	if(!timeSeries) {
 	    resetLoaded();
 	}
+	ProfileTimer mt("DataSource::makeTimeSeries");
 	makeTimeSeries(s, tbeg, tend, pts, &timeSeries, err_msg);
     }
     *ts = timeSeries;
@@ -304,8 +307,12 @@ GTimeSeries * BasicSource::readTimeSeries(cvector<CssWfdiscClass> &wfdiscs,
 	*w = *wfdiscs.at(i);
 	s.setWfdisc(w);
 
-	if(!makeTimeSeries(&s, tbeg, tend, 0, &timeSeries, &err_msg) && err_msg)
+	bool ret;
 	{
+	    ProfileTimer pt("DataSource::makeTimeSeries");
+	    ret = makeTimeSeries(&s, tbeg, tend, 0, &timeSeries, &err_msg);
+	}
+	if(!ret && err_msg) {
 	    ShowWarning(err_msg);
 	}
     }
@@ -86,6 +86,7 @@ void CSSTable::actionPerformed(ActionEvent *action_event)
 	for(i = 0; i < records.size() && tc->table != records[i]; i++);
 	if(i < records.size()) {
 	    if( !strcmp(cmd, "delete") ) {
+		editModeOff();
 		records.removeAt(i);
 		getScrolls(&horizontal_pos, &vertical_pos);
 		removeRow(i);
@@ -505,13 +506,17 @@ void CSSTable::insertRecord(int index, CssTableClass *css, bool redisplay)
 
 void CSSTable::removeRecords(vector<int> &rows)
 {
-    removeRows(rows);
+    /* Remove the records before the rows, so the rows that removeRows
+     * redisplays are formatted from the remaining records.
+     */
+    editModeOff();
     for(int i = (int)rows.size()-1; i >= 0; i--) {
 	if(rows[i] >= 0 && rows[i] < records.size()) {
 	    TableListener::removeListener(records[rows[i]], this);
 	}
 	records.removeAt(rows[i]);
     }
+    removeRows(rows);
 }
 
 void CSSTable::removeSelectedFromDB(void)
@@ -557,18 +562,12 @@ void CSSTable::listKeepOrder(void)
 
 void CSSTable::list(void)
 {
-    int i, j, k, num_columns, maxlen=200;
+    int i, j, num_columns;
     int num_members;
-    int *index;
     vector<enum TimeFormat> tc;
-    const char **row = NULL;
-    char *value;
-    string sval;
-    double time;
     CssTableClass *o;
     CssClassDescription *des;
     TAttribute **a;
-    string svalue;
 
     removeAllRows();
 
@@ -590,16 +589,15 @@ void CSSTable::list(void)
 
     num_columns = numColumns();
 
-    index = new int[num_columns];
-    row = new const char * [num_columns];
+    member_index.clear();
 
     for(i = 0; i < num_columns; i++)
     {
-	index[i] = -1;
+	member_index.push_back(-1);
 	for(j = 0; j < num_members && strcmp(des[j].name, a[i]->name); j++);
 	if(j < num_members)
 	{
-	    index[i] = j;
+	    member_index[i] = j;
             if(des[j].type == CSS_TIME)
             {
                 if(!strcmp(a[i]->format, "%t"))	      tc.push_back(YMONDHMS);
@@ -616,109 +614,167 @@ void CSSTable::list(void)
 	    else if(!strcmp(a[i]->format, "%4t")) tc.push_back(GSE21);
 	    else if(!strcmp(a[i]->format, "%5t")) tc.push_back(YMOND);
 	}
-        if(!(row[i] = (char *)mallocWarn(maxlen))) return;
-
 	if((int)tc.size() <= i) tc.push_back(NOT_TIME);
     }
 
-    for(k = 0; k < records.size(); k++)
+    /* The cells are formatted by cellText when they are displayed. */
+    addVirtualRows(records.size(), false);
+
+    setColumnTime(tc);
+    adjustColumns();
+
+    char text[200];
+    snprintf(text, sizeof(text), "%d rows,  %d columns",numRows(),numColumns());
+    info(text);
+}
+
+/** Format the text of the table cell for a record.
+ *  @param[in] k the record index.
+ *  @param[in] o the record.
+ *  @param[in] a the column attribute.
+ *  @param[in] j the index of the record member, or -1.
+ *  @param[out] value the text.
+ *  @param[in] maxlen the size of value.
+ */
+void CSSTable::formatCell(int k, CssTableClass *o, TAttribute *a, int j,
+			char *value, int maxlen)
+{
+    int num_members = o->getNumMembers();
+    CssClassDescription *des = o->description();
+    string sval;
+    double time;
+
+    memset((void *)value, 0, maxlen);
+    if(j >= 0 && j < num_members)
     {
-	o = records[k];
+	char *member_address = (char *)o + des[j].offset;
+	char *format = a->format;
 
-	for(i = 0; i < num_columns; i++)
+	switch(des[j].type)
 	{
-	    value = (char *)row[i];
-	    memset((void *)value, 0, maxlen);
-	    j = index[i];
-	    if(j >= 0 && j < num_members)
-	    {
-                char *member_address = (char *)o + des[j].offset;
-                char *format = a[i]->format;
-
-                switch(des[j].type)
-                {
-		    case CSS_STRING:
-			stringcpy(value, member_address, maxlen);
-			break;
-		    case CSS_QUARK:
-			stringcpy(value,
-				quarkToString(*(int *)member_address), maxlen);
-			break;
-		    case CSS_DATE:
-		    case CSS_LDDATE:
-			stringcpy(value, timeDateString(
-				(DateTime *)member_address), maxlen);
-			break;
-		    case CSS_LONG:
-		    case CSS_JDATE:
-			snprintf(value, maxlen, format,*(long *)member_address);
-			break;
-		    case CSS_INT:
-			snprintf(value, maxlen, format, *(int *)member_address);
-			break;
-		    case CSS_DOUBLE:
-			snprintf(value, maxlen, format,
-					*(double *)member_address);
-			    break;
-		    case CSS_FLOAT:
-			snprintf(value, maxlen,format,*(float *)member_address);
-			    break;
-		    case CSS_TIME:
-			time = *(double *)member_address;
-			if(!strcmp(format, "%t")) {
-			    timeEpochToString(time, value, maxlen,YMONDHMS);
-			}
-			else if(!strcmp(format, "%2t")) {
-			    timeEpochToString(time, value,maxlen,YMONDHMS3);
-			}
-			else if(!strcmp(format, "%3t")) {
-			    timeEpochToString(time, value, maxlen, GSE20);
-			}
-			else if(!strcmp(format, "%4t")) {
-			    timeEpochToString(time, value, maxlen, GSE21);
-			}
-			else if(!strcmp(format, "%5t")) {
-			    timeEpochToString(time, value, maxlen, YMOND);
-			}
-			else {
-			    snprintf(value, maxlen, format, time);
-			}
-			break;
-		    default:
-			stringcpy(value, "na", maxlen);
+	    case CSS_STRING:
+		stringcpy(value, member_address, maxlen);
+		break;
+	    case CSS_QUARK:
+		stringcpy(value, quarkToString(*(int *)member_address), maxlen);
+		break;
+	    case CSS_DATE:
+	    case CSS_LDDATE:
+		stringcpy(value, timeDateString((DateTime *)member_address),
+				maxlen);
+		break;
+	    case CSS_LONG:
+	    case CSS_JDATE:
+		snprintf(value, maxlen, format,*(long *)member_address);
+		break;
+	    case CSS_INT:
+		snprintf(value, maxlen, format, *(int *)member_address);
+		break;
+	    case CSS_DOUBLE:
+		snprintf(value, maxlen, format, *(double *)member_address);
+		break;
+	    case CSS_FLOAT:
+		snprintf(value, maxlen,format,*(float *)member_address);
+		break;
+	    case CSS_TIME:
+		time = *(double *)member_address;
+		if(!strcmp(format, "%t")) {
+		    timeEpochToString(time, value, maxlen,YMONDHMS);
 		}
-	    }
-	    else if(getExtra(k, o, a[i], sval)) {
-		stringcpy(value, sval.c_str(), maxlen);
-	    }
-	    else if(!strcmp(a[i]->name, "file")) {
-		snprintf(value, maxlen, "%s", quarkToString(o->getFile()) );
-	    }
-	    else if(!strcmp(a[i]->name, "file_index")) {
-		int ndx = o->getFileOffset()/(o->getLineLength()+1);
-		snprintf(value, maxlen, "%d", ndx);
-	    }
-	    else if(o->getValue(a[i]->name, svalue)) {
-		stringcpy(value, svalue.c_str(), maxlen);
-	    }
-	    else {
+		else if(!strcmp(format, "%2t")) {
+		    timeEpochToString(time, value,maxlen,YMONDHMS3);
+		}
+		else if(!strcmp(format, "%3t")) {
+		    timeEpochToString(time, value, maxlen, GSE20);
+		}
+		else if(!strcmp(format, "%4t")) {
+		    timeEpochToString(time, value, maxlen, GSE21);
+		}
+		else if(!strcmp(format, "%5t")) {
+		    timeEpochToString(time, value, maxlen, YMOND);
+		}
+		else {
+		    snprintf(value, maxlen, format, time);
+		}
+		break;
+	    default:
 		stringcpy(value, "na", maxlen);
-	    }
-            value[maxlen-1] = '\0';
-        }
-        addRow(row, false);
+	}
     }
-    for(i = 0; i < num_columns; i++) free((char *)row[i]);
+    else if(getExtra(k, o, a, sval)) {
+	stringcpy(value, sval.c_str(), maxlen);
+    }
+    else if(!strcmp(a->name, "file")) {
+	snprintf(value, maxlen, "%s", quarkToString(o->getFile()) );
+    }
+    else if(!strcmp(a->name, "file_index")) {
+	int ndx = o->getFileOffset()/(o->getLineLength()+1);
+	snprintf(value, maxlen, "%d", ndx);
+    }
+    else if(o->getValue(a->name, sval)) {
+	stringcpy(value, sval.c_str(), maxlen);
+    }
+    else {
+	stringcpy(value, "na", maxlen);
+    }
+    value[maxlen-1] = '\0';
+}
 
-    setColumnTime(tc);
-    adjustColumns();
+bool CSSTable::cellText(int row, int col, char *buf, int buf_len)
+{
+    TAttribute **a;
 
-    delete [] row;
-    delete [] index;
+    if(row < 0 || row >= records.size() || col < 0
+		|| col >= (int)member_index.size()) return false;
 
-    char text[200];
-    snprintf(text, sizeof(text), "%d rows,  %d columns",numRows(),numColumns());
-    info(text);
+    table_attributes->displayAttributes(&a);
+    formatCell(row, records[row], a[col], member_index[col], buf, buf_len);
+    return true;
+}
+
+/** Sort the numeric and time members by their values and the string members
+ *  by the record strings, without formatting the cells.
+ */
+int CSSTable::cellSortKey(int row, int col, double *value, const char **s)
+{
+    int j;
+    char *member_address;
+    CssClassDescription *des;
+
+    if(row < 0 || row >= records.size() || col < 0
+		|| col >= (int)member_index.size()) return CELL_KEY_TEXT;
+
+    if((j = member_index[col]) < 0 || j >= records[row]->getNumMembers()) {
+	return CELL_KEY_TEXT;
+    }
+    des = records[row]->description();
+    member_address = (char *)records[row] + des[j].offset;
+
+    switch(des[j].type)
+    {
+	case CSS_STRING:
+	    *s = member_address;
+	    return CELL_KEY_STRING;
+	case CSS_QUARK:
+	    *s = quarkToString(*(int *)member_address);
+	    return CELL_KEY_STRING;
+	case CSS_LONG:
+	case CSS_JDATE:
+	    *value = (double)*(long *)member_address;
+	    return CELL_KEY_VALUE;
+	case CSS_INT:
+	    *value = (double)*(int *)member_address;
+	    return CELL_KEY_VALUE;
+	case CSS_DOUBLE:
+	case CSS_TIME:
+	    *value = *(double *)member_address;
+	    return CELL_KEY_VALUE;
+	case CSS_FLOAT:
+	    *value = (double)*(float *)member_address;
+	    return CELL_KEY_VALUE;
+	default:
+	    return CELL_KEY_TEXT;
+    }
 }
 
 #ifdef HAVE_SPRINTF_RET_CHAR
@@ -779,9 +835,6 @@ void CSSTable::list(int record_no)
     int num_members;
     int *index;
     const char **row = NULL;
-    char *value;
-    string sval;
-    double time;
     CssTableClass *o;
     CssClassDescription *des;
     TAttribute **a;
@@ -817,85 +870,8 @@ void CSSTable::list(int record_no)
         if(!(row[i] = (char *)mallocWarn(maxlen))) return;
     }
 
-    for(i = 0; i < num_columns; i++)
-    {
-	value = (char *)row[i];
-	memset((void *)value, 0, maxlen);
-	j = index[i];
-	if(j >= 0 && j < num_members)
-	{
-	    char *member_address = (char *)o + des[j].offset;
-	    char *format = a[i]->format;
-
-	    switch(des[j].type)
-	    {
-		case CSS_STRING:
-		    stringcpy(value, member_address, maxlen);
-		    break;
-		case CSS_QUARK:
-		    stringcpy(value, quarkToString(*(int *)member_address),
-				maxlen);
-			break;
-		case CSS_DATE:
-		case CSS_LDDATE:
-		    stringcpy(value, timeDateString((DateTime *)member_address),
-				maxlen);
-		    break;
-		case CSS_LONG:
-		case CSS_JDATE:
-		    snprintf(value, maxlen, format,*(long *)member_address);
-		    break;
-		case CSS_INT:
-		    snprintf(value, maxlen, format, *(int *)member_address);
-		    break;
-		case CSS_DOUBLE:
-		    snprintf(value, maxlen, format, *(double *)member_address);
-		    break;
-		case CSS_FLOAT:
-		    snprintf(value, maxlen,format,*(float *)member_address);
-		    break;
-		case CSS_TIME:
-		    time = *(double *)member_address;
-		    if(!strcmp(format, "%t")) {
-			timeEpochToString(time, value, maxlen,YMONDHMS);
-		    }
-		    else if(!strcmp(format, "%2t")) {
-			timeEpochToString(time, value,maxlen,YMONDHMS3);
-		    }
-		    else if(!strcmp(format, "%3t")) {
-			timeEpochToString(time, value, maxlen, GSE20);
-		    }
-		    else if(!strcmp(format, "%4t")) {
-			timeEpochToString(time, value, maxlen, GSE21);
-		    }
-		    else if(!strcmp(format, "%5t")) {
-			timeEpochToString(time, value, maxlen, YMOND);
-		    }
-		    else {
-			snprintf(value, maxlen, format, time);
-		    }
-		    break;
-		default:
-		    stringcpy(value, "na", maxlen);
-	    }
-	}
-	else if(getExtra(record_no, o, a[i], sval)) {
-	    stringcpy(value, sval.c_str(), maxlen);
-	}
-	else if(!strcmp(a[i]->name, "file")) {
-	    snprintf(value, maxlen, "%s", quarkToString(o->getFile()) );
-	}
-	else if(!strcmp(a[i]->name, "file_index")) {
-	    int ndx = o->getFileOffset()/(o->getLineLength()+1);
-	    snprintf(value, maxlen, "%d", ndx);
-	}
-	else if(o->getValue(a[i]->name, sval)) {
-	    stringcpy(value, sval.c_str(), maxlen);
-	}
-	else {
-	    stringcpy(value, "na", maxlen);
-	}
-        value[maxlen-1] = '\0';
+    for(i = 0; i < num_columns; i++) {
+	formatCell(record_no, o, a[i], index[i], (char *)row[i], maxlen);
     }
     setRow(record_no, row);
 
@@ -1385,10 +1361,11 @@ ParseCmd CSSTable::parseRemoveRecord(const string &s, string &msg)
 
     vector<int> v;
     v.push_back(i);
-    removeRows(v);
+    editModeOff();
 
     TableListener::removeListener(records[i], this);
     records.removeAt(i);
+    removeRows(v);
 
     return COMMAND_PARSED;
 }
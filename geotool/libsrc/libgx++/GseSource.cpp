@@ -19,18 +19,6 @@ extern "C" {
 #include "libgmath.h"
 }
 
-class GseData
-{
-    public:
-    GseData() {
-        offset = 0;
-        msg_version = 0;
-    }
-    ~GseData() { }
-    int offset;
-    int msg_version;
-};
-
 typedef struct
 {
     char    sta[9];
@@ -49,6 +37,43 @@ typedef struct
     double  lon;
 } GSEParam;
 
+/* The index of one waveform: the offsets of its WID line, its data and its
+ * CHK line, and the values of the WID line. The samples are read from the
+ * offsets without parsing the file again.
+ */
+class GseData
+{
+    public:
+    GseData() {
+        offset = 0;
+        dat_offset = 0;
+        chk_offset = 0;
+        msg_version = 0;
+        ndiff = 0;
+        datatype[0] = '\0';
+        memset(&gp, 0, sizeof(gp));
+    }
+    ~GseData() { }
+    long offset;
+    long dat_offset;
+    long chk_offset;
+    int msg_version;
+    int ndiff;
+    char datatype[5]; /* 5 is to support WID1 */
+    GSEParam gp;
+};
+
+/* An open GSE file. The file of a GseSource is kept open between reads,
+ * since a gz file must be decompressed from the start when it is reopened.
+ */
+struct GseFile
+{
+    FILE *fp;
+#ifdef HAVE_LIBZ
+    gzFile zfp;
+#endif
+};
+
 /*
   when reading a message, this is the datatype which is returned
 */
@@ -121,18 +146,23 @@ static const char *parse_error_table[] =
     };
 
 
-#ifdef HAVE_LIBZ
-static int get_waveform(gzFile zfp, FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
-		int **dat, int *checksum, int *err);
-#else
-static int get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
-		int **dat, int *checksum, int *err);
-#endif
+static GseFile *gseOpen(const char *path);
+static void gseClose(GseFile *f);
+static char *gseGets(GseFile *f, char *line, int len);
+static long gseTell(GseFile *f);
+static int gseSeek(GseFile *f, long offset);
+static int gseRead(GseFile *f, char *buf, int len);
+static int nextWaveform(GseFile *f, int msg_version, int *dt_version,
+		GseData *gd, int *err);
+static int indexWaveform(GseFile *f, int msg_version, int *dt_version,
+		GseData *gd, int *err);
+static int *decodeWaveform(char *buf, int len, GseData *gd, int *nsamp,
+		int *err);
 static void remdif1(int *data, int npts);
-static int dcomp6(char *buf, int **data);
+static void remdif2(int *data, int npts);
+static int dcomp6(const char *buf, int len, int **data, int *size);
 static int dcomp7(char *buf, int **data);
 static int dcomp8(char *buf, int **data);
-static void computeChecksum(int *signal_int, int nsamp, int *checksum);
 static void returnDataType(char *line, int msg_version, int *type,
 		int *dt_version);
 static int gseVersion(char *line);
@@ -141,94 +171,63 @@ static int gseVersion(char *line);
 GseSource::GseSource(const string &name, const string &file) : TableSource(name)
 {
     read_path = file;
+    gse_file = NULL;
     openPrefix(file);
     queryAllPrefixTables();
 }
 
-GseSource::~GseSource(void) { }
+GseSource::~GseSource(void)
+{
+    gseClose(gse_file);
+    for(int i = 0; i < (int)gse_data.size(); i++) delete gse_data[i];
+}
 
 gvector<SegmentInfo *> * GseSource::getSegmentList(void)
 {
-#ifdef HAVE_LIBZ
-    gzFile  zfp = Z_NULL;
-#endif
-    FILE *fp = NULL;
-    int path_quark, offset, checksum, err, data_type;
+    GseFile *f;
+    int path_quark, err, data_type;
     int dt_version, msg_version = GSE_20;
-    int *dat = NULL;
-    struct stat buf;
     cvector<CssOriginClass> o;
-    GSEParam gp;
     char error[MAXPATHLEN+100];
     gvector<SegmentInfo *> *segs;
 
     if(read_path.empty()) return NULL;
 
-    if(read_path.length() > 3 && read_path.substr(read_path.length()-3).compare(".gz") == 0) {
-#ifdef HAVE_LIBZ
-	if(stat(read_path.c_str(), &buf) < 0 || (zfp = gzopen(read_path.c_str(), "rb")) == NULL) {
-	    snprintf(error, MAXPATHLEN+100,"gse: cannot open %s",read_path.c_str());
-	    logErrorMsg(LOG_WARNING, error);
-	    return NULL;
-	}
-#else
-	snprintf(error, MAXPATHLEN+100,"gse: cannot open %s. Compile with libz", read_path.c_str());
-	logErrorMsg(LOG_WARNING, error);
-	return NULL;
-#endif
-    }
-    else {
-	if(stat(read_path.c_str(), &buf) < 0 || (fp = fopen(read_path.c_str(), "r")) == NULL)
-	{
-	    snprintf(error, MAXPATHLEN+100,"gse: cannot open %s",read_path.c_str());
-	    logErrorMsg(LOG_WARNING, error);
-	    return NULL;
-	}
-    }
+    if( !(f = gseOpen(read_path.c_str())) ) return NULL;
+
     path_quark = (int)stringToQuark(read_path);
 
     for(int i = 0; i < (int)gse_data.size(); i++) delete gse_data[i];
     gse_data.clear();
 
-#ifdef HAVE_LIBZ
-    if(zfp != Z_NULL) offset = gztell(zfp);
-    else offset = ftell(fp);
-#else
-    offset = ftell(fp);
-#endif
+    /* Index all waveforms in one pass. The data are decoded when they are
+     * read. The file is kept open for the reads.
+     */
+    gseClose(gse_file);
+    gse_file = f;
+
     data_type = WAVEFORM;
     segs = new gvector<SegmentInfo *>;
 
     while(data_type == WAVEFORM || data_type == LOG || data_type == ERROR_LOG)
     {
-	gp.time = 0.;
-	gp.sta[0] = '\0';
-	gp.chan[0] = '\0';
-	gp.nsamp = 0;
-	
-#ifdef HAVE_LIBZ
-	if(zfp != Z_NULL) {
-	    offset = gztell(zfp);
-	    data_type = get_waveform(zfp, fp, msg_version, &dt_version, &gp, &dat, &checksum, &err);
-	}
-	else {
-	    offset = ftell(fp);
-	    data_type = get_waveform(zfp, fp, msg_version, &dt_version, &gp, &dat, &checksum, &err);
-	}
-#else
-	offset = ftell(fp);
-	data_type = get_waveform(fp, msg_version, &dt_version, &gp, &dat, &checksum, &err);
-#endif
+	GseData *gd = new GseData();
+	GSEParam *gp = &gd->gp;
+
+	gd->msg_version = msg_version;
+	gd->offset = gseTell(f);
+	data_type = indexWaveform(f, msg_version, &dt_version, gd, &err);
 
 	if(err != NO_PROBLEM)
 	{
 	    snprintf(error,MAXPATHLEN+100,"GSE2.0 format problem %s/%s: %s",
-				gp.sta, gp.chan, parse_error_table[err]);
+				gp->sta, gp->chan, parse_error_table[err]);
 	    logErrorMsg(LOG_WARNING, error);
 	}
 
 	if(data_type == STOP || data_type == END)
 	{
+	    delete gd;
 	    if ((int)segs->size() == 0) {
 		snprintf(error, MAXPATHLEN+100, "No data found in %s",
 			read_path.c_str());
@@ -237,46 +236,40 @@ gvector<SegmentInfo *> * GseSource::getSegmentList(void)
 	    break;
 	}
 
-	Free(dat);
-
-	if(gp.nsamp < 1) continue;
+	if(gp->nsamp < 1) {
+	    delete gd;
+	    continue;
+	}
 
-	if(gp.samprate <= 0.)
+	if(gp->samprate <= 0.)
 	{
 	    snprintf(error, MAXPATHLEN+100, "%s: bad samprate = %e",
-			read_path.c_str(), gp.samprate);
+			read_path.c_str(), gp->samprate);
 	    logErrorMsg(LOG_WARNING, error);
-#ifdef HAVE_LIBZ
-	    if(zfp != Z_NULL) gzclose(zfp);
-	    else fclose(fp);
-#else
-	    fclose(fp);
-#endif
+	    delete gd;
 	    return segs;
 	}
 
 	SegmentInfo *s = new SegmentInfo();
 
 	s->id = gse_data.size() + 1;
-	GseData *gd = new GseData();
 	gse_data.push_back(gd);
 	s->path = path_quark;
 	s->format = stringToQuark("gse");
 	s->file_order = (int)segs->size();
-	s->nsamp = gp.nsamp;
-	s->samprate = gp.samprate;
-	s->start = gp.time;
-	s->end = gp.time + (gp.nsamp-1)/gp.samprate;
+	s->nsamp = gp->nsamp;
+	s->samprate = gp->samprate;
+	s->start = gp->time;
+	s->end = gp->time + (gp->nsamp-1)/gp->samprate;
 	s->jdate = timeEpochToJDate(s->start);
-	gd->offset = offset;
-	stringcpy(s->sta, gp.sta, sizeof(s->sta));
-	stringcpy(s->chan, gp.chan, sizeof(s->chan));
+	stringcpy(s->sta, gp->sta, sizeof(s->sta));
+	stringcpy(s->chan, gp->chan, sizeof(s->chan));
 //	gnetGetWaveSites(1, s);
 
 	s->selected = true;
 	CssWfdiscClass *w = new CssWfdiscClass();
-	stringcpy(w->sta, gp.sta, sizeof(w->sta));
-	stringcpy(w->chan, gp.chan, sizeof(w->chan));
+	stringcpy(w->sta, gp->sta, sizeof(w->sta));
+	stringcpy(w->chan, gp->chan, sizeof(w->chan));
 	w->nsamp = s->nsamp;
 	w->samprate = s->samprate;
 	w->time = s->start;
@@ -284,12 +277,6 @@ gvector<SegmentInfo *> * GseSource::getSegmentList(void)
 	s->setWfdisc(w);
 	segs->push_back(s);
     }
-#ifdef HAVE_LIBZ
-    if(zfp != Z_NULL) gzclose(zfp);
-    else fclose(fp);
-#else
-    fclose(fp);
-#endif
 
     getNetworks(segs);
 
@@ -353,7 +340,7 @@ bool GseSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
 	}
     }
 
-    GSegment *segment = readSegment(full_path, gd->offset, tbeg, tend, pts);
+    GSegment *segment = readSegment(gd, tbeg, tend, pts);
     if(!segment) return false;
 
     (*ts)->addSegment(segment);
@@ -387,111 +374,64 @@ bool GseSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
     return true;
 }
 
-GSegment * GseSource::readSegment(const string &full_path, int offset,
-			double start_time, double end_time, int pts_wanted)
+GSegment * GseSource::readSegment(GseData *gd, double start_time,
+			double end_time, int pts_wanted)
 {
     char error[MAXPATHLEN+100];
     int *dat = NULL;
-    int npts, start, checksum, err, dt_version, msg_version = GSE_20;
-    GSEParam gp;
+    int npts, nsamp, start, err;
+    GSEParam *gp = &gd->gp;
     GSegment *seg=NULL;
-    struct stat buf;
     double tbeg, tdel, calib;
     float *data=NULL;
-#ifdef HAVE_LIBZ
-    gzFile  zfp = Z_NULL;
-    FILE *fp = NULL;
-#else
-    FILE *fp = NULL;
-#endif
-    if(full_path.length() > 3 && full_path.substr(full_path.length()-3).compare(".gz") == 0) {
-#ifdef HAVE_LIBZ
-    	if(stat(full_path.c_str(),&buf) < 0 || (zfp = gzopen(full_path.c_str(), "rb")) == NULL)
-	{
-	    snprintf(error, MAXPATHLEN+100,"gse: cannot open %s",full_path.c_str());
-	    logErrorMsg(LOG_WARNING, error);
-	    return NULL;
-	}
-#else
-	snprintf(error, MAXPATHLEN+100,"gse: cannot open %s. Compile with libz", full_path.c_str());
-	logErrorMsg(LOG_WARNING, error);
-	return NULL;
-#endif
-    }
-    else if(stat(full_path.c_str(),&buf) < 0 || (fp = fopen(full_path.c_str(), "r")) == NULL)
-    {
-	snprintf(error, MAXPATHLEN+100,"gse: cannot open %s",full_path.c_str());
-	logErrorMsg(LOG_WARNING, error);
-	return NULL;
-    }
-#ifdef HAVE_LIBZ
-    if((zfp != Z_NULL && gzseek(zfp, offset, 0) == -1) || (fp != NULL && fseek(fp, offset, 0)))
-#else
-    if(fseek(fp, offset, 0))
-#endif
-    {
-	snprintf(error, MAXPATHLEN+100, "%s: read error", full_path.c_str());
+
+    if(gp->samprate <= 0.) {
+	snprintf(error, MAXPATHLEN+100, "%s: bad samprate = %e",
+		read_path.c_str(), gp->samprate);
 	logErrorMsg(LOG_WARNING, error);
 	return NULL;
     }
-    gp.time = 0.;
-    gp.endtime = 0.;
-    gp.nsamp = 0;
-    gp.samprate = 0.;
 
-#ifdef HAVE_LIBZ
-    if(zfp != Z_NULL) {
-	get_waveform(zfp, fp, msg_version, &dt_version, &gp, &dat, &checksum, &err);
-	gzclose(zfp);
-    }
-    else {
-	get_waveform(zfp, fp, msg_version, &dt_version, &gp, &dat, &checksum, &err);
-    	fclose(fp);
-    }
-#else
-    get_waveform(fp, msg_version, &dt_version, &gp, &dat, &checksum, &err);
-    fclose(fp);
-#endif
+    dat = readWaveform(gd, &nsamp, &err);
+
     if(err != NO_PROBLEM)  {
       snprintf(error, MAXPATHLEN+100, "gse: in %s, failed to get waveform: %s",
-	       full_path.c_str(), parse_error_table[err]);
+	       read_path.c_str(), parse_error_table[err]);
       logErrorMsg(LOG_WARNING, error);
       fprintf(stderr, "%s\n", error); 
+      Free(dat);
       return NULL;
     }
     if (dat == NULL) {  /* just to make sure dat is properly allocated */
       snprintf(error, MAXPATHLEN+100, "gse: in %s, failed to get waveform: parse error",
-	       full_path.c_str());
+	       read_path.c_str());
       logErrorMsg(LOG_WARNING, error);
       return NULL;
     }
 
-    if(gp.samprate <= 0.) {
-	snprintf(error, MAXPATHLEN+100, "%s: bad samprate = %e",
-		full_path.c_str(), gp.samprate);
-	logErrorMsg(LOG_WARNING, error);
-	return NULL;
-    }
-
     start = 0;
-    if(start_time > gp.time) {
-	start = (int)((start_time - gp.time)*gp.samprate+.5);
+    if(start_time > gp->time) {
+	start = (int)((start_time - gp->time)*gp->samprate+.5);
     }
 
-    if(end_time > gp.endtime) {
-	npts = gp.nsamp - start;
+    if(end_time > gp->endtime) {
+	npts = nsamp - start;
     }
     else {
-	npts = (int)(((end_time - gp.time)*gp.samprate+.5) - start + 1);
+	npts = (int)(((end_time - gp->time)*gp->samprate+.5) - start + 1);
     }
-    if(start + npts > gp.nsamp) npts = gp.nsamp - start;
+    if(start + npts > nsamp) npts = nsamp - start;
 
-    if(npts <= 0) return NULL;
+    if(npts <= 0) {
+	Free(dat);
+	return NULL;
+    }
 
     data = (float *)malloc(npts*sizeof(float));
     if (data == NULL) {
       snprintf(error, MAXPATHLEN+100,"gse: cannot allocate memory for data buffer, needed %lu bytes", npts*sizeof(float));
       logErrorMsg(LOG_WARNING, error);
+      Free(dat);
       return NULL;
     }
     for(int i = 0; i < npts; i++) {
@@ -500,29 +440,63 @@ GSegment * GseSource::readSegment(const string &full_path, int offset,
 
     Free(dat);
 
-    calib = (gp.calib != 0.) ? gp.calib : 1.;
-    tdel = 1./gp.samprate;
-    tbeg = gp.time + start*tdel;
-    seg = new GSegment(data, npts, tbeg, tdel, calib, gp.calper);
+    calib = (gp->calib != 0.) ? gp->calib : 1.;
+    tdel = 1./gp->samprate;
+    tbeg = gp->time + start*tdel;
+    seg = new GSegment(data, npts, tbeg, tdel, calib, gp->calper);
 
     Free(data);
 
     return seg;
 }
 
+/** Read the samples of a waveform from the offsets of its index. The data
+ *  between the DAT and CHK lines are read at once and decoded. The file is
+ *  opened on the first read and kept open.
+ *  @param gd the index of the waveform.
+ *  @param nsamp returns the number of samples decoded.
+ *  @param err returns a problem decoding the data, or NO_PROBLEM.
+ *  @return the samples, or NULL if the file cannot be read.
+ */
+int * GseSource::readWaveform(GseData *gd, int *nsamp, int *err)
+{
+    char error[MAXPATHLEN+100], *buf;
+    int *dat, len;
+
+    *nsamp = 0;
+    *err = NO_PROBLEM;
+
+    if(!gse_file && !(gse_file = gseOpen(read_path.c_str()))) return NULL;
+
+    len = (int)(gd->chk_offset - gd->dat_offset);
+    if(len < 0) len = 0;
+
+    if( !(buf = (char *)malloc(len+1)) ) {
+	*err = MALLOC_FAILURE;
+	return NULL;
+    }
+    if(gseSeek(gse_file, gd->dat_offset) || gseRead(gse_file, buf, len) != len)
+    {
+	snprintf(error, MAXPATHLEN+100, "%s: read error", read_path.c_str());
+	logErrorMsg(LOG_WARNING, error);
+	Free(buf);
+	/* reopen on the next read */
+	gseClose(gse_file);
+	gse_file = NULL;
+	return NULL;
+    }
+    buf[len] = '\0';
+
+    dat = decodeWaveform(buf, len, gd, nsamp, err);
+    Free(buf);
+
+    return dat;
+}
+
 bool GseSource::reread(GTimeSeries *ts)
 {
-    char error[MAXPATHLEN+100];
-    const char *path;
-#ifdef HAVE_LIBZ
-    gzFile zfp;
-    FILE *fp;
-#else
-    FILE *fp;
-#endif
-    GSEParam gp;
     float *data;
-    int	i, j, offset, checksum, err, dt_version;
+    int	i, j, nsamp, err;
     int *dat = NULL;
     double d, tdel, tbeg, tend, calib;
     GseData *gd;
@@ -537,73 +511,34 @@ bool GseSource::reread(GTimeSeries *ts)
     ts->removeAllSegments();
 
     data = (float *)malloc(sizeof(float));
-    path = read_path.c_str();
 
     for(i = 0; i < (int)ts->waveform_io->wp.size(); i++)
     {
 	j = ts->waveform_io->wp[i].wfdisc_index;
 	if(j < 0 || j >= (int)gse_data.size()) continue;
 	gd = gse_data[j];
-	fp = NULL;
-#ifdef HAVE_LIBZ
-	zfp = Z_NULL;
-#endif
-	if(strlen(path) > 3 && !strcmp(path+strlen(path)-3, ".gz")) {
-#ifdef HAVE_LIBZ
-	    if((zfp = gzopen(path, "rb")) == NULL)
-	    {
-		snprintf(error, MAXPATHLEN+100, "gse: cannot open %s", path);
-	    	logErrorMsg(LOG_WARNING, error);
+
+	if( !(dat = readWaveform(gd, &nsamp, &err)) ) {
+	    if(!gse_file) {
+		Free(data);
 		return false;
 	    }
-#else
-	    snprintf(error, MAXPATHLEN+100,"gse: cannot open %s. Compile with libz", path.c_str());
-	    logErrorMsg(LOG_WARNING, error);
-	    return false;
-#endif
+	    continue;
 	}
-	else if((fp = fopen(path, "r")) == NULL)
-	{
-	    snprintf(error, MAXPATHLEN+100, "gse: cannot open %s", path);
-	    logErrorMsg(LOG_WARNING, error);
-	    return false;
+	if(nsamp <= 0) {
+	    Free(dat);
+	    continue;
 	}
-	offset = gd->offset;
-#ifdef HAVE_LIBZ
-	if((zfp != Z_NULL && gzseek(zfp, offset, 0) == -1) || (fp != NULL && fseek(fp, offset, 0))) {
-#else
-	if(fseek(fp, offset, 0)) {
-#endif
-	    snprintf(error, MAXPATHLEN+100, "%s: read error", path);
-	    logErrorMsg(LOG_WARNING, error);
-	    return false;
-	}
-
-#ifdef HAVE_LIBZ
-	/* gzseek(zfp, offset, 0); */
-	if(zfp != Z_NULL) {
-	    get_waveform(zfp, fp, gd->msg_version, &dt_version, &gp, &dat, &checksum, &err);
-	    gzclose(zfp);
-	}
-	else {
-	  get_waveform((gzFile)fp, fp, gd->msg_version, &dt_version, &gp, &dat, &checksum, &err);
-	    fclose(fp);
-	}
-#else
-	/* redundant ?  fseek(fp, offset, 0); */
-	get_waveform(fp, gd->msg_version, &dt_version, &gp, &dat, &checksum, &err);
-	fclose(fp);
-#endif
 
-	data = (float *)realloc(data, gp.nsamp*sizeof(float));
+	data = (float *)realloc(data, nsamp*sizeof(float));
 
-	for(j = 0; j < gp.nsamp; j++) data[j] = (float)dat[j];
+	for(j = 0; j < nsamp; j++) data[j] = (float)dat[j];
 	Free(dat);
 
-	tdel = (gp.samprate != 0.) ? 1./gp.samprate : 1.;
-	calib = (gp.calib != 0.) ? gp.calib : 1.;
-	GSegment *segment = new GSegment(data, gp.nsamp, gp.time, tdel, calib,
-				gp.calper);
+	tdel = (gd->gp.samprate != 0.) ? 1./gd->gp.samprate : 1.;
+	calib = (gd->gp.calib != 0.) ? gd->gp.calib : 1.;
+	GSegment *segment = new GSegment(data, nsamp, gd->gp.time, tdel, calib,
+				gd->gp.calper);
 	ts->addSegment(segment);
     }
     Free(data);
@@ -625,52 +560,172 @@ bool GseSource::reread(GTimeSeries *ts)
     return true;
 }
 
+static GseFile *
+gseOpen(const char *path)
+{
+    char error[MAXPATHLEN+100];
+    struct stat buf;
+    GseFile *f;
+    FILE *fp;
+    int n = (int)strlen(path);
+
+    if(n > 3 && !strcmp(path+n-3, ".gz")) {
+#ifdef HAVE_LIBZ
+	gzFile zfp;
+	if(stat(path, &buf) < 0 || (zfp = gzopen(path, "rb")) == NULL) {
+	    snprintf(error, MAXPATHLEN+100, "gse: cannot open %s", path);
+	    logErrorMsg(LOG_WARNING, error);
+	    return NULL;
+	}
+#if ZLIB_VERNUM >= 0x1240
+	gzbuffer(zfp, 65536);
+#endif
+	f = new GseFile();
+	f->fp = NULL;
+	f->zfp = zfp;
+	return f;
+#else
+	snprintf(error, MAXPATHLEN+100,"gse: cannot open %s. Compile with libz", path);
+	logErrorMsg(LOG_WARNING, error);
+	return NULL;
+#endif
+    }
+    if(stat(path, &buf) < 0 || (fp = fopen(path, "r")) == NULL)
+    {
+	snprintf(error, MAXPATHLEN+100, "gse: cannot open %s", path);
+	logErrorMsg(LOG_WARNING, error);
+	return NULL;
+    }
+    f = new GseFile();
+    f->fp = fp;
+#ifdef HAVE_LIBZ
+    f->zfp = Z_NULL;
+#endif
+    return f;
+}
+
+static void
+gseClose(GseFile *f)
+{
+    if(!f) return;
+#ifdef HAVE_LIBZ
+    if(f->zfp != Z_NULL) gzclose(f->zfp);
+#endif
+    if(f->fp) fclose(f->fp);
+    delete f;
+}
+
+static char *
+gseGets(GseFile *f, char *line, int len)
+{
+#ifdef HAVE_LIBZ
+    if(f->zfp != Z_NULL) return gzgets(f->zfp, line, len);
+#endif
+    return fgets(line, len, f->fp);
+}
+
+static long
+gseTell(GseFile *f)
+{
+#ifdef HAVE_LIBZ
+    if(f->zfp != Z_NULL) return (long)gztell(f->zfp);
+#endif
+    return ftell(f->fp);
+}
+
+static int
+gseSeek(GseFile *f, long offset)
+{
+#ifdef HAVE_LIBZ
+    if(f->zfp != Z_NULL) return (gzseek(f->zfp, offset, SEEK_SET) == -1) ? -1 : 0;
+#endif
+    return fseek(f->fp, offset, SEEK_SET);
+}
+
+static int
+gseRead(GseFile *f, char *buf, int len)
+{
+#ifdef HAVE_LIBZ
+    if(f->zfp != Z_NULL) return gzread(f->zfp, buf, len);
+#endif
+    return (int)fread(buf, 1, len, f->fp);
+}
+
 static void cleanName(char* in, char* out, int len);
 
 #define WID1	1
 #define WID2	2
 
+#define isChkLine(line) (!strncasecmp(line, "CHK2 ", 5) || \
+		!strncasecmp(line, "CHK1 ", 5) || \
+		!strncasecmp(line, "CHK2\t", 5) || \
+		!strncasecmp(line, "CHK1\t", 5))
+
 /* 
+   Index the next waveform. Parses the WID line and finds the offsets of the
+   data and the CHK line without decoding the data.
+
    returns a value which describes the next datatype
 
 	err - returns possible problem parsing this waveform, or NO_PROBLEM
 */
+static int
+indexWaveform(GseFile *f, int msg_version, int *dt_version, GseData *gd,
+		int *err)
+{
+    char line[257];
+    long pos;
+    int type;
 
-int
-#ifdef HAVE_LIBZ
-static get_waveform(gzFile zfp, FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
-		int **dat, int *checksum, int *err)
-#else /* HAVE_LIBZ */
-static get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
-		int **dat, int *checksum, int *err)
-#endif
+    type = nextWaveform(f, msg_version, dt_version, gd, err);
+    if(type != WAVEFORM || *err != NO_PROBLEM) return type;
+
+    /* count the line lengths instead of calling ftell for each line */
+    pos = gd->dat_offset = gseTell(f);
+
+    while(gseGets(f, line, 256) != NULL)
+    {
+	if(isChkLine(line)) {
+	    gd->chk_offset = pos;
+	    return WAVEFORM;
+	}
+	pos += (long)strlen(line);
+    }
+    *err = NO_CHK_LINE;
+    return END;
+}
+
+/* 
+   Parse the next WID line and read to the DAT line.
+
+   returns a value which describes the next datatype
+
+	err - returns possible problem parsing this waveform, or NO_PROBLEM
+*/
+static int
+nextWaveform(GseFile *f, int msg_version, int *dt_version, GseData *gd,
+		int *err)
 {
-    char	tmp[1024], datatype[5]; /* 5 is to support WID1 */
+    char	tmp[1024], *datatype = gd->datatype;
     char	line[257];
-    char	*buf = NULL, *endptr, *p;
     long	n;
     double	s, cb, cp, h, v, epoch, msec;
     bool	found_dat;
-    int		*d = NULL;
-    int		i, doy, type, found, ndiff, buf_len;
-    int		len, error, obs_nsamp, obs_checksum, rec_checksum, read_to_buf;
+    int		doy, type, found, len;
     DateTime	dt;
+    GSEParam	*gp = &gd->gp;
 
     gp->nsamp = -1;
     gp->time = -1.;
     gp->endtime = -1.;
     stringcpy(gp->sta, "", sizeof(gp->sta));
     stringcpy(gp->chan, "", sizeof(gp->chan));
-    ndiff = 0;
+    gd->ndiff = 0;
 
     *err = NO_PROBLEM;
 
     found = false;
-#ifdef HAVE_LIBZ
-    while( (fp != NULL && fgets(line, 256, fp) != NULL) || (zfp != Z_NULL && gzgets(zfp, line, 256) != NULL))
-#else /* HAVE_LIBZ */
-    while ( fgets(line, 256, fp) != NULL)
-#endif /* HAVE_LIBZ */
+    while( gseGets(f, line, 256) != NULL )
     {
 	if (!strncasecmp(line, "WID2", 4))
 	{
@@ -724,9 +779,9 @@ static get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
 #endif
 
 	timeParseLine(line,  39, 42, gp->auxid, sizeof(gp->auxid), "s");
-	timeParseLine(line,  44, 46, datatype, sizeof(datatype), "s");
+	timeParseLine(line,  44, 46, datatype, sizeof(gd->datatype), "s");
 
-	ndiff = !strncasecmp(datatype, "CM6", 3) ? 2 : 0;
+	gd->ndiff = !strncasecmp(datatype, "CM6", 3) ? 2 : 0;
 
 	timeParseLine(line,  48,  55, &n, sizeof(n), "ld");
 	timeParseLine(line,  57,  67, &s, sizeof(s), "lf");
@@ -756,7 +811,7 @@ static get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
 	    v = -1.0;
 	}
     }
-    else if (found == WID1)
+    else
     {
 	timeParseLine(line,   5,  9, &dt.year, sizeof(dt.year), "d");
 	timeParseLine(line,  10, 12, &doy, sizeof(doy), "d");
@@ -779,25 +834,20 @@ static get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
 
 	timeParseLine(line,  55, 65, &s, sizeof(s), "lf");
 
-	timeParseLine(line,  74, 77, datatype, sizeof(datatype), "s");
+	timeParseLine(line,  74, 77, datatype, sizeof(gd->datatype), "s");
 
-	ndiff = 0;
-	timeParseLine(line,  79, 80, &ndiff, sizeof(ndiff), "d");
+	gd->ndiff = 0;
+	timeParseLine(line,  79, 80, &gd->ndiff, sizeof(gd->ndiff), "d");
 
 	if (strlen(datatype) > 3 && !strncmp(datatype, "INT", 3))
 	{
-	    stringcpy(datatype, "INT", sizeof(datatype));
+	    stringcpy(datatype, "INT", sizeof(gd->datatype));
 	}
 
 	/* in case WID1 line extends over 2 lines */
 	if ((int)strlen(line) < 88)
 	{
-#ifdef HAVE_LIBZ
-	    if(zfp != Z_NULL) gzgets(zfp, line, 256);
-	    else fgets(line, 256, fp);
-#else /* HAVE_LIBZ */
-	    fgets(line, 256, fp);
-#endif /* HAVE_LIBZ */
+	    gseGets(f, line, 256);
 	    if (!strncasecmp(line, "DAT2", 4) || !strncasecmp(line, "DAT1", 4))
 	    {
 		found_dat = true;
@@ -828,12 +878,7 @@ static get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
     gp->hang = h;
     gp->vang = v;
 
-#ifdef HAVE_LIBZ
-    while (!found_dat && ((fp != NULL && fgets(line, 256, fp) != NULL) ||
-		(zfp != Z_NULL && gzgets(zfp, line, 256) != NULL)) )
-#else /* HAVE_LIBZ */
-    while (!found_dat && fgets(line, 256, fp) != NULL)
-#endif /* HAVE_LIBZ */
+    while (!found_dat && gseGets(f, line, 256) != NULL)
     {
 	if (!strncasecmp(line, "DAT2", 4) || !strncasecmp(line, "DAT1", 4))
 	{
@@ -846,187 +891,89 @@ static get_waveform(FILE *fp, int msg_version, int *dt_version, GSEParam *gp,
 	*err = NO_DAT_LINE;
 	return(END);
     }
+    return(WAVEFORM);
+}
 
-    read_to_buf = 1;
-    if (!strncasecmp(datatype, "INT", 3)) read_to_buf = 0;
-
-/* read the waveform */
-    buf = (char *)malloc((n+1)*sizeof(int));
-    if(!buf)
-    {
-	*err = MALLOC_FAILURE;
-	return(WAVEFORM);
-    }
-
-    d = (int *)malloc(n*sizeof(int));
-    if(!d)
-    {
-	*err = MALLOC_FAILURE;
-	return(WAVEFORM);
-    }
-
-    memset(buf, 0, n*sizeof( int ));
-    buf_len = n;
-	
-    i=0;
-    obs_nsamp=0;
-    found = false;
-
-    if(read_to_buf) {
-#ifdef HAVE_LIBZ
-	while ((fp != NULL && fgets(line, 256, fp) != NULL) || (zfp != Z_NULL && gzgets(zfp, line, 256) != NULL))
-#else
-	while ( fgets(line, 256, fp) != NULL)
-#endif
-	{
-	    if (!strncasecmp(line, "CHK2 ", 5) ||
-		!strncasecmp(line, "CHK1 ", 5) ||
-		!strncasecmp(line, "CHK2\t", 5) ||
-		!strncasecmp(line, "CHK1\t", 5))
-	    {
-		if (sscanf(line, "%s %d", tmp, &rec_checksum) != 2) {
-		    rec_checksum = -1;
-		}
-		found = true;
-		break;
-	    }
-	    len = (int) strlen(line);
-	    len -= 1;
-	    if ((i+len) > buf_len)
-	    {
-		buf = (char*)realloc(buf, (buf_len + 1024) * sizeof(int));
-		memset(buf+i, 0, 1024*sizeof( int ));
-		buf_len += 1024;
-	    }
-	    strncpy(buf+i, line, len);
-	    i += len;
-	}
-    }
-    else {
-#ifdef HAVE_LIBZ
-	while ((fp != NULL && fgets(line, 256, fp) != NULL) || (zfp != Z_NULL && gzgets(zfp, line, 256) != NULL))
-#else
-	while ( fgets(line, 256, fp) != NULL)
-#endif
-	{
-	    errno = 0;
-	    for(p = line; errno == 0 && *p != '\0' && obs_nsamp < n; p = endptr) {
-		errno = 0;
-		d[obs_nsamp] = strtol(p, &endptr, 10);
-		if(p == endptr || errno != 0) break;
-		obs_nsamp++;
-	    }
-	    if(*endptr != '\n') break;
-	}
-	while(1) { // skip blank lines before CHK line
-	    int j = 0;
-	    while(line[j] != '\0' && isspace(line[j])) j++;
-	    if(line[j] != '\0') break;
-	    if( fgets(line, 256, fp) == NULL) break;
-	}
-	if (!strncasecmp(line, "CHK2 ", 5) ||
-	    !strncasecmp(line, "CHK1 ", 5) ||
-	    !strncasecmp(line, "CHK2\t", 5) ||
-	    !strncasecmp(line, "CHK1\t", 5))
-	{
-	    if (sscanf(line, "%s %d", tmp, &rec_checksum) != 2) {
-		rec_checksum = -1;
-	    }
-	    found = true;
-	}
-    }
-    if (!found) 
-    {
-	Free(buf);
-	*err = NO_CHK_LINE;
-	return(END);
-    }
+/* 
+   Decode the data between the DAT and CHK lines and remove the differences.
 
-    if (read_to_buf) buf[i] = '\0';
+	nsamp - returns the number of samples decoded
+	err - returns possible problem decoding the data, or NO_PROBLEM
+*/
+static int *
+decodeWaveform(char *buf, int len, GseData *gd, int *nsamp, int *err)
+{
+    const char	*datatype = gd->datatype;
+    char	msg[200], *p, *endptr;
+    int		i, n, size, obs_nsamp = 0;
+    int		*d = NULL;
 
-/* convert waveform */
+    *nsamp = 0;
+    *err = NO_PROBLEM;
+    n = (int)gd->gp.nsamp;
+    size = (n > 0) ? n : 1;
 
-    error = 0;
     if (!strncasecmp(datatype, "CM6", 3) || !strncasecmp(datatype, "CMP6", 4))
     {
-	obs_nsamp = dcomp6(buf, &d);
-    }
-    else if (!strncasecmp(datatype, "CM7", 3) || !strncasecmp(datatype, "CMP7", 4))
-    {
-	obs_nsamp = dcomp7(buf, &d);
+	if( !(d = (int *)malloc(size*sizeof(int))) ) {
+	    *err = MALLOC_FAILURE;
+	    return NULL;
+	}
+	obs_nsamp = dcomp6(buf, len, &d, &size);
     }
-    else if (!strncasecmp(datatype, "CM8", 3) || !strncasecmp(datatype, "CMP8", 4))
+    else if (!strncasecmp(datatype, "CM7", 3) || !strncasecmp(datatype, "CMP7", 4)
+	|| !strncasecmp(datatype, "CM8", 3) || !strncasecmp(datatype, "CMP8", 4))
     {
-	obs_nsamp = dcomp8(buf, &d);
+	/* join the lines */
+	for(i = 0, p = buf; i < len; i++) if(buf[i] != '\n') *p++ = buf[i];
+	*p = '\0';
+
+	if(datatype[2] == '7' || datatype[3] == '7') obs_nsamp = dcomp7(buf, &d);
+	else obs_nsamp = dcomp8(buf, &d);
     }
     else if (!strncasecmp(datatype, "INT", 3))
     {
+	if( !(d = (int *)malloc(size*sizeof(int))) ) {
+	    *err = MALLOC_FAILURE;
+	    return NULL;
+	}
+	errno = 0;
+	for(p = buf; obs_nsamp < n; p = endptr) {
+	    d[obs_nsamp] = strtol(p, &endptr, 10);
+	    if(p == endptr || errno != 0) break;
+	    obs_nsamp++;
+	}
     }
     else
     {
-	/*
-	 sprintf(msg, "unknown datatype '%s'\n only CM6 and INT are supported",
-		datatype);
-	 logging(0, "parsedrm", msg);
-	*/
-	Free(buf);
 	*err = UNK_FORMAT;
-        return(WAVEFORM);
+        return NULL;
     }
 
-    *dat = d;
+    if (obs_nsamp < 0)
+    {
+	Free(d);
+	*err = MALLOC_FAILURE;
+	return NULL;
+    }
 
-    if (ndiff > 0 && obs_nsamp > 0)
+    if (gd->ndiff > 0 && obs_nsamp > 0)
     {
-	for (i = 0; i < ndiff; i++) remdif1(d, obs_nsamp);
+	if (gd->ndiff == 2) remdif2(d, obs_nsamp);
+	else for (i = 0; i < gd->ndiff; i++) remdif1(d, obs_nsamp);
 
-	if (d[0] > 16000000) d[0] = d[1];
+	if (obs_nsamp > 1 && d[0] > 16000000) d[0] = d[1];
     }
 
     if (n != obs_nsamp )
     {
-	char msg[200];
-	/*
-	sprintf(msg, "expected n=%d, obs_nsamp=%d", n, obs_nsamp);
-	logging(0, "parsedrm", msg);
-	*/
-	snprintf(msg, 200, "expected n=%ld, obs_nsamp=%d", n, obs_nsamp);
+	snprintf(msg, 200, "expected n=%d, obs_nsamp=%d", n, obs_nsamp);
 	logErrorMsg(LOG_WARNING, msg);
-
-	gp->nsamp = (long) obs_nsamp;
-	Free(buf);
 	*err = N_NE_OBS;
-	return(WAVEFORM);
-    }
-    else if ( error == -1)
-    {
-	/*
-	sprintf(msg, "error decoding waveform data");
-	logging(0, "parsedrm", msg);
-	*/
-	logErrorMsg(LOG_WARNING, "error decoding waveform data");
-	Free(buf);
-	*err = ERR_DECODING_WAVEFORM;
-	return(WAVEFORM);
     }
+    *nsamp = obs_nsamp;
 
-    computeChecksum(d, obs_nsamp, &obs_checksum); 
-/*
-    if (rec_checksum == obs_checksum)
-    {
-	logging(0, "parsedrm", "checksum passed");
-    }
-    else
-    {
-	sprintf(msg, "checksum  FAILED, observed = %d, recorded = %d\n",
-			obs_checksum, rec_checksum);
-	logging(0, "parsedrm", msg);
-    }
-*/
-    *checksum = (rec_checksum == obs_checksum) ? 1 : 0;
-
-    Free(buf);
-    return(WAVEFORM);
+    return d;
 }
 
 static void
@@ -1088,101 +1035,90 @@ remdif1(int *data, int npts)
 }
 	
 /** 
- *  Decompress 6-bit integer data. Decompress integer data that has been
- *  compressed into ascii characters. Returns values in int format.
- *  See subroutine cmprs6 for compression format.
- *  @param buf null terminated string.
- *  @return the length of *data
+ * Remove two levels of first differences in one pass. The second running
+ * sum is taken from the first as it is formed, which is the same as two
+ * calls of remdif1.
  */
-static int
-dcomp6(char *buf, int **data)
+static void
+remdif2(int *data, int npts)
 {
-    static int ch[128] = 
-    {
-	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-	 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 2, 
-	 3, 4, 5, 6, 7, 8, 9,10,11, 0, 0, 0, 0, 0, 0, 0, 
-	12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,
-	28,29,30,31,32,33,34,35,36,37, 0, 0, 0, 0, 0, 0,
-	38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,
-	54,55,56,57,58,59,60,61,62,63, 0, 0, 0, 0, 0, 0
-    };
-    int	i, j, k, ibyte, joflow, jsign, itemp, size_data = 0;
-    int	isign = 16, ioflow = 32, mask1 = 15, mask2 = 31;
-    union
-    {
-	char	a[4];
-	int	i;
-    } ai;
+	int	i, s1 = 0, s2 = 0;
 
-    ai.a[0] = '1';
-    ai.a[1] = '2';
-    ai.a[2] = '3';
-    ai.a[3] = '4';
-
-    *data = NULL;
-
-    /* work out which way bytes are stored in computer
-     */
-    ibyte = (ai.i == (((52*256+51)*256+50)*256+49)) ? 0 : 3;
-
-    /* start of decoding
-     */
-    for(i = j = 0; buf[i] != '\0'; i++)
-    {
-	while(buf[i] != '\0' && (buf[i] == '\n' || buf[i] == '\r')) i++;
-
-	if(buf[i] == '\0' || buf[i] == ' ') return(j);
-
-	ai.i = 0;
-	ai.a[ibyte] = buf[i];
-
-	/* strip off any higher order bits */
-	k = ai.i & 127;
+	for(i = 0; i < npts; i++) {
+	    s1 += data[i];
+	    s2 += s1;
+	    data[i] = s2;
+	}
+}
 
-	/* get number representation of input character */
-	ai.i = ch[k-1];
+#define CM6_SKIP	-1
+#define CM6_END		-2
 
-	/* get sign bit */
-	jsign = ai.i & isign;
+/* The values of the CM6 characters "+-0-9A-Za-z" are 0 to 63. Bit 32 is
+ * the continuation bit and bit 16 is the sign of the first character of a
+ * sample. Line ends are skipped and a space or NUL ends the data. Other
+ * characters are 0, as in the original Fortran table.
+ */
+static const signed char cm6[128] =
+{
+    -2,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0, -1,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    -2,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,
+     2,  3,  4,  5,  6,  7,  8,  9, 10, 11,  0,  0,  0,  0,  0,  0,
+     0, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,
+    27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37,  0,  0,  0,  0,  0,
+     0, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,
+    53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,  0,  0,  0,  0,  0
+};
 
-	/* get continuation bit (if any) */
-	joflow = ai.i & ioflow;
+/** 
+ *  Decompress 6-bit integer data. Decompress integer data that has been
+ *  compressed into ascii characters. Returns values in int format.
+ *  See subroutine cmprs6 for compression format. Each character is decoded
+ *  with one lookup in the cm6 table.
+ *  @param buf the characters.
+ *  @param len the number of characters.
+ *  @param data space for *size values, which is reallocated if needed.
+ *  @param size the number of values allocated for *data.
+ *  @return the length of *data, or -1 for a malloc error.
+ */
+static int
+dcomp6(const char *buf, int len, int **data, int *size)
+{
+    const char *p = buf, *end = buf + len;
+    int	c, j, itemp, jsign, *d = *data;
 
-	/* remove bits we don't want */
-	itemp = ai.i & mask1;
+    for(j = 0; p < end; )
+    {
+	if((c = cm6[*p++ & 127]) < 0) {
+	    if(c == CM6_SKIP) continue;
+	    break;
+	}
+	jsign = c & 16;
+	itemp = c & 15;
 
-	while(joflow != 0)
+	while(c & 32)
 	{
 	    /* there is another byte in this sample */
-	    itemp *= 32;
-	    i++;
-	    while(buf[i] != '\0' && (buf[i] == '\n' || buf[i] == '\r')) i++;
+	    do {
+		c = (p < end) ? cm6[*p++ & 127] : CM6_END;
+	    } while(c == CM6_SKIP);
 
-	    if(buf[i] == '\0' || buf[i] == ' ') return(j);
+	    if(c == CM6_END) return(j);
 
-	    ai.a[ibyte] = buf[i];
-	    /* strip off any higher order bits */
-	    k = ai.i & 127;
-	    ai.i = ch[k-1];
-			
-	    /* get continuation bit (if any) */
-	    joflow = ai.i & ioflow;
-	    k = ai.i & mask2;
-	    itemp += k;
+	    itemp = itemp*32 + (c & 31);
 	}
 
-	if(jsign != 0) itemp = -itemp;
-
-	if(j+1 > size_data) {
-	    size_data += 1024;
-	    if((*data = (int *)realloc(*data, size_data*sizeof(int))) == NULL) {
+	if(j == *size) {
+	    int n = 2*(*size) + 1024;
+	    if((d = (int *)realloc(*data, n*sizeof(int))) == NULL) {
 		fprintf(stderr, "dcomp6: malloc error.\n");
 		return(-1);
 	    }
+	    *data = d;
+	    *size = n;
 	}
-	(*data)[j++] = itemp;
+	d[j++] = jsign ? -itemp : itemp;
     }
     return(j);
 }
@@ -1399,43 +1335,6 @@ dcomp8(char *buf, int **data)
     return(j);
 }
 
-// Compute the GSE2.0 checksum used in the CHK2 line
-static void
-computeChecksum(int *signal_int, int nsamp, int *checksum)
-{
-    int sample_value, modulo, sum;
-    int MODULO_VALUE = 100000000;
-
-    sum = 0;
-
-    modulo = MODULO_VALUE;
-
-    for(int i = 0; i < nsamp; i++)
-    {
-	// check on sample value overflow
-
-	sample_value = signal_int[i];
-
-	if(abs(sample_value) >= modulo) {
-	    sample_value = sample_value - (sample_value/modulo)*modulo;
-	}
-
-	// add the sample value to the checksum 
-
-	sum += sample_value;
-
-	// apply modulo division to the checksum
-
-	if(abs(sum) >= modulo) {
-	    sum = sum - (sum/modulo)*modulo;
-	}
-    }
-
-    // compute absolute value of the checksum
-
-    *checksum = abs(sum);
-}
-
 static void
 returnDataType(char * line, int msg_version, int * type, int * dt_version)
 {
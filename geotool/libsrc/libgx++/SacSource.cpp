@@ -7,10 +7,15 @@
 #include <zlib.h>
 #endif
 #include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/param.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <pwd.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <map>
 
 #include "SacSource.h"
 #include "gobject++/GTimeSeries.h"
@@ -44,6 +49,64 @@ class SacData
     SAC sac;
 };
 
+#define MAX_ERROR_LEN 1024
+
+/* The headers of a SAC file, read by readHeaders. The headers of many files
+ * are read in parallel by SacSource::indexFiles and kept in header_cache
+ * until getSegmentList is called for the file, the SacSource of the file is
+ * deleted, or the files are indexed again.
+ */
+class SacHeaders
+{
+    public:
+    SacHeaders() {
+	opened = false;
+	sys_errno = 0;
+	err = 0;
+	lineno = 0;
+	binary = 0;
+	err_msg[0] = '\0';
+	mtime = 0;
+	size = 0;
+    }
+    ~SacHeaders() {
+	for(int i = 0; i < (int)sd.size(); i++) delete sd[i];
+    }
+    vector<SacData *> sd;
+    bool opened;
+    int sys_errno;
+    int err;
+    int lineno;
+    int binary;
+    char err_msg[MAX_ERROR_LEN];
+    time_t mtime;
+    off_t size;
+};
+
+static map<string, SacHeaders *> header_cache;
+
+typedef struct
+{
+    const vector<string> *files;
+    vector<SacHeaders *> *h;
+} IndexWork;
+
+/* A SAC file. An uncompressed file is mapped into memory, so that the
+ * headers and data are read from the map without stream reads. A gzip
+ * file is read with a gz stream.
+ */
+struct SacFile
+{
+    char *map;
+    long len;
+    long pos;
+#ifdef HAVE_LIBZ
+    gzFile fp;
+#else
+    FILE *fp;
+#endif
+};
+
 #define file_warn(path) \
     if(errno > 0) { \
 	snprintf(error, sizeof(error), "sac: cannot open %s\n%s", \
@@ -56,17 +119,21 @@ class SacData
 
 
 static void sacToString(char *a, char *b, int n);
-#ifdef HAVE_LIBZ
-static int read_ascii_sac_header(gzFile fp, SAC *s, int *lineno,
-			const char **err_msg);
-static int readHeader(gzFile fp, SAC *sac, int *binary, int *lineno, int *flip_bytes,
-			const char **err_msg);
-static bool sacReadWaveform(gzFile fp, int binary, int flip_bytes, float *y, int *npts, SAC *sac);
-#else
-static int read_ascii_sac_header(FILE *fp, SAC *s, int *lineno, const char **err_msg);
-static int readHeader(FILE *fp, SAC *sac, int *binary, int *lineno, int *flip_bytes, const char **err_msg);
-static bool sacReadWaveform(FILE *fp, int binary, int flip_bytes, float *y, int *npts,SAC *sac);
-#endif
+static SacFile *sacOpen(const char *path);
+static void sacClose(SacFile *f);
+static int sacGetc(SacFile *f);
+static int sacRead(SacFile *f, void *buf, int len);
+static long sacTell(SacFile *f);
+static int sacSeek(SacFile *f, long offset, int whence);
+static int sacEof(SacFile *f);
+static int read_ascii_sac_header(SacFile *fp, SAC *s, int *lineno,
+			char *err_msg);
+static int readHeader(SacFile *fp, SAC *sac, int *binary, int *lineno, int *flip_bytes,
+			char *err_msg);
+static SacHeaders *readHeaders(const char *path);
+static bool badHeader(SAC *sac);
+static bool sacReadWaveform(SacFile *fp, int binary, int flip_bytes, float *y, int *npts, SAC *sac);
+static void readHeadersTask(int i, int thread, void *arg);
 
 static void getArrivals(DataSource *ds, SacData *sd, SegmentInfo *s,
 		int path_quark, gvector<CssTableClass *> &v);
@@ -89,39 +156,54 @@ SacSource::SacSource(const string &name, const string &file) :
 
 SacSource::~SacSource(void)
 {
+    map<string, SacHeaders *>::iterator it;
+
+    // free the headers from indexFiles, if getSegmentList did not use them
+    if((it = header_cache.find(read_path)) != header_cache.end()) {
+	delete it->second;
+	header_cache.erase(it);
+    }
 }
 
 gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 {
-    int		path_quark, err, jdate, binary;
-    int		lineno, header_offset, bad_time, flip_bytes;
+    int		path_quark, err, jdate;
+    int		bad_time;
     char	error[MAXPATHLEN+100];
     double	az, baz;
     char	name[MAXPATHLEN+100];
-    const char	*err_msg = NULL;
-    char	msg[1024];
+    char	msg[MAX_ERROR_LEN+100];
     double	ref_time;
     SAC		sac;
-#ifdef HAVE_LIBZ
-    gzFile	fp;
-#else
-    FILE	*fp;
-#endif
     DateTime	dt;
+    struct stat	buf;
+    SacHeaders	*h = NULL;
     cvector<CssArrivalClass> arrivals;
     gvector<CssTableClass *> origins, assocs, wftags;	
     gvector<SegmentInfo *> *segs;
+    map<string, SacHeaders *>::iterator it;
 
     if(read_path.empty()) {
 	return NULL;
     }
-#ifdef HAVE_LIBZ
-    if((fp = gzopen(read_path.c_str(), "rb")) == NULL)
-#else
-    if((fp = fopen(read_path.c_str(), "r")) == NULL)
-#endif
-    {
+
+    /* use the headers from indexFiles, if the file has not changed */
+    if((it = header_cache.find(read_path)) != header_cache.end()) {
+	h = it->second;
+	header_cache.erase(it);
+	if(stat(read_path.c_str(), &buf) || buf.st_mtime != h->mtime
+		|| buf.st_size != h->size)
+	{
+	    delete h;
+	    h = NULL;
+	}
+    }
+    if(!h) h = readHeaders(read_path.c_str());
+
+    if(!h->opened) {
+	errno = h->sys_errno;
 	file_warn(read_path.c_str());
+	delete h;
 	return NULL;
     }    
 
@@ -132,10 +214,11 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 
     path_quark = (int)stringToQuark(read_path);
 
-    header_offset = 0;
-    lineno = 0;
-    while(!(err = readHeader(fp, &sac, &binary, &lineno, &flip_bytes, &err_msg)))
+    err = h->err;
+    for(int k = 0; k < (int)h->sd.size(); k++)
     {
+	sac = h->sd[k]->sac;
+
 	if(fNaN(sac.b)) {
 	    snprintf(error, sizeof(error),
 		    "Header format error. Bad B: %s", read_path.c_str());
@@ -173,14 +256,7 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 	    err = -1;
 	    break;
 	}
-	if(sac.iftype != ITIME) {
-#ifdef HAVE_LIBZ
-	    gzseek(fp, (long)(sac.npts*sizeof(int)), 1);
-#else
-	    fseek(fp, (long)(sac.npts*sizeof(int)), 1);
-#endif
-	    continue;
-	}
+	if(sac.iftype != ITIME) continue;
 	if(sac.nzjday == -12345) sac.nzjday = 0;
 	if(sac.nzyear == -12345) sac.nzyear = 0;
 	if(sac.nzhour == -12345) sac.nzhour = 0;
@@ -276,7 +352,8 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 	s->setWfdisc(wf);
 
 	s->id = (int)sac_data.size() + 1;
-	SacData *sd = new SacData();
+	SacData *sd = h->sd[k];
+	h->sd[k] = NULL;
 	sac_data.push_back(sd);
 	sd->sac = sac;
 	
@@ -370,31 +447,10 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 			 &s->origin_delta, &az, &baz);
 	}
 
-	sd->binary = binary;
-	sd->flip_bytes = flip_bytes;
-	sd->header_offset = header_offset;
-#ifdef HAVE_LIBZ
-	sd->data_offset = gztell(fp);
-#else
-	sd->data_offset = ftell(fp);
-#endif
        	sd->ref_time = ref_time;
 
-	if(binary) {
-#ifdef HAVE_LIBZ
-	    gzseek(fp, (long)(sac.npts*sizeof(int)), 1);
-#else
-	    fseek(fp, (long)(sac.npts*sizeof(int)), 1);
-#endif
-	}
-	else {
-	    break;
-	}
-#ifdef HAVE_LIBZ
-	header_offset = gztell(fp);
-#else
-	header_offset = ftell(fp);
-#endif
+	if(!sd->binary) break;
+
 	if(!css_arrival) { // don't have a .arrival file
 	    getArrivals(this, sd, s, path_quark, arrivals);
 
@@ -436,11 +492,6 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 	s->selected = true;
 	segs->push_back(s);
     }
-#ifdef HAVE_LIBZ
-    gzclose(fp);
-#else
-    fclose(fp);
-#endif
     storeRecords(arrivals);
     storeRecords(origins);
     storeRecords(assocs);
@@ -448,18 +499,19 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 
     if(err < -1)
     {
-	if(binary) {
-	    logErrorMsg(LOG_WARNING, strerror(errno));
+	if(h->binary) {
+	    logErrorMsg(LOG_WARNING, strerror(h->sys_errno));
 	}
 	snprintf(error, sizeof(error), "header read error: %s",
 		read_path.c_str());
 	logErrorMsg(LOG_WARNING, error);
 
-	if(err_msg != NULL) {
-	    sprintf(msg, "line %d: %s", lineno, err_msg);
+	if(h->err_msg[0] != '\0') {
+	    snprintf(msg, sizeof(msg), "line %d: %s", h->lineno, h->err_msg);
 	    logErrorMsg(LOG_WARNING, msg);
 	}
 	if((int)segs->size() == 0) {
+	    delete h;
 	    delete segs;
 	    return NULL;
 	}
@@ -470,35 +522,270 @@ gvector<SegmentInfo *> *SacSource::getSegmentList(void)
 		read_path.c_str());
 	logErrorMsg(LOG_WARNING, error);
 
-	if(err_msg != NULL) {
-	    sprintf(msg, "line %d: %s", lineno, err_msg);
+	if(h->err_msg[0] != '\0') {
+	    snprintf(msg, sizeof(msg), "line %d: %s", h->lineno, h->err_msg);
 	    logErrorMsg(LOG_WARNING, msg);
 	}
+	delete h;
 	delete segs;
 	return NULL;
     }
+    delete h;
 
     return segs;
 }
 
+/** Read the headers of SAC files with num_threads threads. The headers are
+ *  kept until getSegmentList is called for each file, so that a directory
+ *  of many SAC files is indexed in parallel before the files are opened one
+ *  at a time with a SacSource. The headers of a file are freed when its
+ *  SacSource is deleted without using them. Headers left from an earlier
+ *  call are freed first.
+ *  @param[in] files the SAC files.
+ *  @param[in] num_threads the number of threads, or <= 0 for one per
+ *	processor.
+ */
+void SacSource::indexFiles(const vector<string> &files, int num_threads)
+{
+    vector<SacHeaders *> h;
+    IndexWork w;
+    int n = (int)files.size();
+
+    clearIndex();
+
+    if(n <= 0) return;
+
+    h.resize(n, (SacHeaders *)NULL);
+    w.files = &files;
+    w.h = &h;
+
+    parallel_run_thread(n, num_threads, readHeadersTask, &w);
+
+    for(int i = 0; i < n; i++) {
+	// a file can be listed more than once
+	if(header_cache.find(files[i]) != header_cache.end()) delete h[i];
+	else header_cache[files[i]] = h[i];
+    }
+}
+
+/** Free the headers that were read by indexFiles and have not been used.
+ */
+void SacSource::clearIndex(void)
+{
+    map<string, SacHeaders *>::iterator it;
+
+    for(it = header_cache.begin(); it != header_cache.end(); it++) {
+	delete it->second;
+    }
+    header_cache.clear();
+}
+
+static void
+readHeadersTask(int i, int thread, void *arg)
+{
+    IndexWork *w = (IndexWork *)arg;
+
+    (*w->h)[i] = readHeaders((*w->files)[i].c_str());
+}
+
+/* Read all headers of a SAC file, stopping where getSegmentList stops. This
+ * does not log messages, so it can run in a thread.
+ */
+static SacHeaders *
+readHeaders(const char *path)
+{
+    SacHeaders *h = new SacHeaders();
+    SacFile *f;
+    SAC sac;
+    struct stat buf;
+    int binary = 0, flip_bytes, err;
+    long header_offset = 0;
+
+    if(!stat(path, &buf)) {
+	h->mtime = buf.st_mtime;
+	h->size = buf.st_size;
+    }
+    errno = 0;
+    if( !(f = sacOpen(path)) ) {
+	h->sys_errno = errno;
+	return h;
+    }
+    h->opened = true;
+
+    while(!(err = readHeader(f, &sac, &binary, &h->lineno, &flip_bytes,
+			h->err_msg)))
+    {
+	SacData *sd = new SacData();
+	h->sd.push_back(sd);
+	sd->sac = sac;
+	sd->binary = binary;
+	sd->flip_bytes = flip_bytes;
+	sd->header_offset = header_offset;
+	sd->data_offset = sacTell(f);
+
+	if(badHeader(&sac) || (sac.iftype == ITIME && !binary)) break;
+
+	sacSeek(f, (long)(sac.npts*sizeof(int)), SEEK_CUR);
+	header_offset = sacTell(f);
+    }
+    h->err = err;
+    h->binary = binary;
+    if(err < -1) h->sys_errno = errno;
+
+    sacClose(f);
+
+    return h;
+}
+
+/* The header errors that stop getSegmentList.
+ */
+static bool
+badHeader(SAC *sac)
+{
+    return (fNaN(sac->b) || fNaN(sac->e) || fNaN(sac->delta) ||
+	sac->delta < 0. || sac->npts < 0 ||
+	(sac->iftype != ITIME && sac->iftype != IRLIM &&
+	 sac->iftype != IAMPH && sac->iftype != IXY));
+}
+
+static SacFile *
+sacOpen(const char *path)
+{
+    SacFile *f;
+    struct stat buf;
+    int fd;
+    void *p;
+
+    if((fd = open(path, O_RDONLY)) < 0) return NULL;
+
+    f = new SacFile();
+    f->map = NULL;
+    f->len = 0;
+    f->pos = 0;
+    f->fp = NULL;
+
+    /* map the file, unless it is empty or compressed */
+    if(!fstat(fd, &buf) && buf.st_size > 2 &&
+	(p = mmap(NULL, (size_t)buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0))
+		!= MAP_FAILED)
+    {
+	unsigned char *c = (unsigned char *)p;
+	if(c[0] == 0x1f && c[1] == 0x8b) {
+	    munmap(p, (size_t)buf.st_size);
+	}
+	else {
+	    f->map = (char *)p;
+	    f->len = (long)buf.st_size;
+	    close(fd);
+	    return f;
+	}
+    }
+    close(fd);
+
+#ifdef HAVE_LIBZ
+    if((f->fp = gzopen(path, "rb")) == NULL)
+#else
+    if((f->fp = fopen(path, "r")) == NULL)
+#endif
+    {
+	delete f;
+	return NULL;
+    }
+    return f;
+}
+
+static void
+sacClose(SacFile *f)
+{
+    if(!f) return;
+    if(f->map) munmap(f->map, (size_t)f->len);
+#ifdef HAVE_LIBZ
+    if(f->fp) gzclose(f->fp);
+#else
+    if(f->fp) fclose(f->fp);
+#endif
+    delete f;
+}
+
+static int
+sacGetc(SacFile *f)
+{
+    if(f->map) {
+	return (f->pos < f->len) ? (unsigned char)f->map[f->pos++] : EOF;
+    }
+#ifdef HAVE_LIBZ
+    return gzgetc(f->fp);
+#else
+    return getc(f->fp);
+#endif
+}
+
+static int
+sacRead(SacFile *f, void *buf, int len)
+{
+    if(f->map) {
+	if(len > f->len - f->pos) len = (f->pos < f->len) ? (int)(f->len - f->pos) : 0;
+	memcpy(buf, f->map + f->pos, len);
+	f->pos += len;
+	return len;
+    }
+#ifdef HAVE_LIBZ
+    return gzread(f->fp, buf, len);
+#else
+    return (int)fread(buf, 1, len, f->fp);
+#endif
+}
+
+static long
+sacTell(SacFile *f)
+{
+    if(f->map) return f->pos;
+#ifdef HAVE_LIBZ
+    return (long)gztell(f->fp);
+#else
+    return ftell(f->fp);
+#endif
+}
+
 static int
+sacSeek(SacFile *f, long offset, int whence)
+{
+    if(f->map) {
+	long pos = (whence == SEEK_CUR) ? f->pos + offset : offset;
+	if(pos < 0) return -1;
+	f->pos = pos;
+	return 0;
+    }
 #ifdef HAVE_LIBZ
-readHeader(gzFile fp, SAC *sac, int *binary, int *lineno, int *flip_bytes, const char **err_msg)
+    return (gzseek(f->fp, offset, whence) == -1) ? -1 : 0;
 #else
-readHeader(FILE *fp, SAC *sac, int *binary, int *lineno, int *flip_bytes, const char **err_msg)
+    return fseek(f->fp, offset, whence);
 #endif
+}
+
+static int
+sacEof(SacFile *f)
 {
-    int pos, err;
+    if(f->map) return (f->pos >= f->len);
+#ifdef HAVE_LIBZ
+    return gzeof(f->fp);
+#else
+    return feof(f->fp);
+#endif
+}
+
+static int
+readHeader(SacFile *fp, SAC *sac, int *binary, int *lineno, int *flip_bytes, char *err_msg)
+{
+    long pos;
+    int err;
     SAC_HEADER s, sac_header_null = SAC_HEADER_NULL;
 
+    *flip_bytes = false;
     memcpy(&s, &sac_header_null, sizeof(SAC_HEADER));
     /* try ascii first
      */
-#ifdef HAVE_LIBZ
-    pos = gztell(fp);
-#else
-    pos = ftell(fp);
-#endif
+    pos = sacTell(fp);
     if(!(err = read_ascii_sac_header(fp, sac, lineno, err_msg))) {
 	*binary = 0;
 	return(0);
@@ -509,17 +796,10 @@ readHeader(FILE *fp, SAC *sac, int *binary, int *lineno, int *flip_bytes, const
     *binary = 1;
     memcpy(&s, &sac_header_null, sizeof(SAC_HEADER));
 
-#ifdef HAVE_LIBZ
-    gzseek(fp, pos, 0);
-    if(gzread(fp, &s, sizeof(SAC_HEADER)) != sizeof(SAC_HEADER)) {
-	return( gzeof(fp) ? -1 : -2 );
-    }
-#else
-    fseek(fp, pos, 0);
-    if(fread(&s, sizeof(SAC_HEADER), 1, fp) != 1) {
-	return( feof(fp) ? -1 : -2 );
+    sacSeek(fp, pos, SEEK_SET);
+    if(sacRead(fp, &s, sizeof(SAC_HEADER)) != sizeof(SAC_HEADER)) {
+	return( sacEof(fp) ? -1 : -2 );
     }
-#endif
 
     memcpy(sac, &s.a, sizeof(SAC_HEADER_A));
 
@@ -628,11 +908,7 @@ bool SacSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
     float	*data;
     double	calib;
     SacData	*sd;
-#ifdef HAVE_LIBZ
-    gzFile	fp;
-#else
-    FILE	*fp;
-#endif
+    SacFile	*fp;
 
     if(s->id < 1 || s->id > (int)sac_data.size()) return false;
     sd = sac_data[s->id-1];
@@ -642,20 +918,13 @@ bool SacSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
     full_path = (const char *)quarkToString(s->path);
     getDir(full_path, dir, prefix);
 
-#ifdef HAVE_LIBZ
-    if((fp = gzopen(full_path, "r")) == NULL) {
-#else
-    if((fp = fopen(full_path, "r")) == NULL) {
-#endif
+    errno = 0;
+    if((fp = sacOpen(full_path)) == NULL) {
 	file_warn(full_path);
 	return false;
     }
 
-#ifdef HAVE_LIBZ
-    if(gzseek(fp, sd->data_offset, 0) == -1)
-#else
-    if(fseek(fp, sd->data_offset, 0))
-#endif
+    if(sacSeek(fp, sd->data_offset, SEEK_SET))
     {
 	if(errno > 0) {
 	    snprintf(error, sizeof(error), "sac: cannot fseek in\n%s\n%s",
@@ -665,11 +934,7 @@ bool SacSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
 	    snprintf(error, sizeof(error), "sac: cannot fseek in %s",full_path);
 	}
 	logErrorMsg(LOG_WARNING, error);
-#ifdef HAVE_LIBZ
-	gzclose(fp);
-#else
-	fclose(fp);
-#endif
+	sacClose(fp);
 	return false;
     }
 
@@ -681,11 +946,8 @@ bool SacSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
 	{
 	    snprintf(error, sizeof(error),"read error: %s", full_path);
 	    logErrorMsg(LOG_WARNING, error);
-#ifdef HAVE_LIBZ
-	    gzclose(fp);
-#else
-	    fclose(fp);
-#endif
+	    sacClose(fp);
+	    Free(data);
 	    return false;
 	}
 	else if(s->nsamp != sd->sac.npts)
@@ -695,11 +957,7 @@ bool SacSource::makeTimeSeries(SegmentInfo *s, double tbeg, double tend,
 	    logErrorMsg(LOG_WARNING, error);
 	}
     }
-#ifdef HAVE_LIBZ
-    gzclose(fp);
-#else
-    fclose(fp);
-#endif
+    sacClose(fp);
 
     if(sd->sac.scale != FVAL_UNDEF && sd->sac.scale != 0.) {
 	calib = sd->sac.scale;
@@ -772,36 +1030,25 @@ GSegment * SacSource::readSeg(SegmentInfo *s, float *data, double calib,
 }
 
 static bool
-#ifdef HAVE_LIBZ
-sacReadWaveform(gzFile fp, int binary, int flip_bytes, float *y, int *npts, SAC *sac)
-#else
-sacReadWaveform(FILE *fp, int binary, int flip_bytes, float *y, int *npts, SAC *sac)
-#endif
+sacReadWaveform(SacFile *fp, int binary, int flip_bytes, float *y, int *npts, SAC *sac)
 {
     int i, n;
-    union
-    {
-	char    a[4];
-	float   f;
-	int     i;
-	short   s;
-    } e1, e2;
 
     if(binary) {
-#ifdef HAVE_LIBZ
-	n = gzread(fp, y, (size_t)*npts*sizeof(float))/sizeof(float);
-#else
-	n = fread(y, sizeof(float), (size_t)*npts, fp);
-#endif
-	if(flip_bytes) {
-	    for(i = 0; i < n; i++) {
-		e1.f = y[i];
-		e2.a[0] = e1.a[3];
-		e2.a[1] = e1.a[2];
-		e2.a[2] = e1.a[1];
-		e2.a[3] = e1.a[0];
-		y[i] = e2.f;
+	if(fp->map) {
+	    /* flip or copy from the map in one pass */
+	    n = *npts;
+	    if(fp->pos >= fp->len) n = 0;
+	    else if((long)n*(long)sizeof(float) > fp->len - fp->pos) {
+		n = (int)((fp->len - fp->pos)/sizeof(float));
 	    }
+	    if(flip_bytes) sacFlipFloats(n, fp->map + fp->pos, y);
+	    else memcpy(y, fp->map + fp->pos, n*sizeof(float));
+	    fp->pos += n*sizeof(float);
+	}
+	else {
+	    n = sacRead(fp, y, *npts*sizeof(float))/sizeof(float);
+	    if(flip_bytes) sacFlipFloats(n, y, y);
 	}
 	if((i = invalidData(n, y, (float)0.)) > 0) {
 	    char error[100];
@@ -812,24 +1059,18 @@ sacReadWaveform(FILE *fp, int binary, int flip_bytes, float *y, int *npts, SAC *
     }
     else
     {
-#ifdef HAVE_LIBZ
 	int c;
 	char s[51];
 	for(n = 0; n < *npts; n++) {
-	    while((c = gzgetc(fp)) != -1 && isspace(c));
+	    while((c = sacGetc(fp)) != -1 && isspace(c));
 	    if(c == -1) break;
 	    s[0] = (char)c;
-	    for(i=1; i<50 && (c = gzgetc(fp)) != -1 && !isspace(c); i++) {
+	    for(i=1; i<50 && (c = sacGetc(fp)) != -1 && !isspace(c); i++) {
 		s[i] = (char)c;
 	    }
 	    s[i] = '\0';
 	    if(sscanf(s, "%e", y+n) != 1) break;
 	}
-#else
-	for(n = 0; n < *npts; n++) {
-	    if(fscanf(fp, "%e", y+n) != 1) break;
-	}
-#endif
     }
 
     if(n != *npts)
@@ -850,11 +1091,7 @@ bool SacSource::reread(GTimeSeries *ts)
     int		j, n;
     char	error[MAXPATHLEN+100];
     const char *path;
-#ifdef HAVE_LIBZ
-    gzFile	fp;
-#else
-    FILE	*fp;
-#endif
+    SacFile	*fp;
     SacData	*sd;
     double	tbeg, tend;
     float	*data = NULL;
@@ -878,33 +1115,16 @@ bool SacSource::reread(GTimeSeries *ts)
 	if(j < 0 || j >= (int)sac_data.size()) continue;
 	sd = sac_data[j];
 
-#ifdef HAVE_LIBZ
-	if((fp = gzopen(path, "rb")) == NULL) {
-#else
-	if((fp = fopen(path, "r")) == NULL) {
-#endif
+	if((fp = sacOpen(path)) == NULL) {
 	    snprintf(error, sizeof(error), "sac: cannot open %s", path);
 	    logErrorMsg(LOG_WARNING, error);
-#ifdef HAVE_LIBZ
-	    gzclose(fp);
-#else
-	    fclose(fp);
-#endif
 	    Free(data);
 	    return false;
 	}
-#ifdef HAVE_LIBZ
-	if(gzseek(fp, sd->data_offset, 0) == -1) {
-#else
-	if(fseek(fp, sd->data_offset, 0)) {
-#endif
+	if(sacSeek(fp, sd->data_offset, SEEK_SET)) {
 	    snprintf(error, sizeof(error), "%s: read error", path);
 	    logErrorMsg(LOG_WARNING, error);
-#ifdef HAVE_LIBZ
-	    gzclose(fp);
-#else
-	    fclose(fp);
-#endif
+	    sacClose(fp);
 	    Free(data);
 	    return false;
 	}
@@ -917,15 +1137,12 @@ bool SacSource::reread(GTimeSeries *ts)
 	    if(n <= 0) {
 		snprintf(error, sizeof(error), "read error: %s", path);
 		logErrorMsg(LOG_WARNING, error);
+		sacClose(fp);
 		Free(data);
 		return false;
 	    }
 	}
-#ifdef HAVE_LIBZ
-	gzclose(fp);
-#else
-	fclose(fp);
-#endif
+	sacClose(fp);
 
 	if(n > 0) {
 	    double t0 = sd->ref_time + sd->sac.b;
@@ -1041,23 +1258,19 @@ typedef struct
 
 #define WRONG_FORMAT 1
 
-#define MAX_ERROR_LEN 1024
-static char error[MAX_ERROR_LEN];
-
 static void check_for_null(char *s, int size);
-static int read_sac_line(const char *line, SAC *s, SacLine *table, int n);
+static int read_sac_line(const char *line, SAC *s, SacLine *table, int n,
+			char *error);
 
 #define offset(field) \
 ((unsigned int) (((const char *) (&(((SAC*)NULL)->field))) - ((const char *) NULL)))
 
 #define Sizeof(field) sizeof(((SAC*)NULL)->field)
 
+/* err_msg has MAX_ERROR_LEN characters.
+ */
 static int
-#ifdef HAVE_LIBZ
-read_ascii_sac_header(gzFile fp, SAC *s, int *lineno, const char **err_msg)
-#else
-read_ascii_sac_header(FILE *fp, SAC *s, int *lineno, const char **err_msg)
-#endif
+read_ascii_sac_header(SacFile *fp, SAC *s, int *lineno, char *err_msg)
 {
 	char line[100];
 	int c, i, k, m, n;
@@ -1210,11 +1423,7 @@ read_ascii_sac_header(FILE *fp, SAC *s, int *lineno, const char **err_msg)
 
 	    /* read the next m characters up to the next '\n'
 	     */
-#ifdef HAVE_LIBZ
-	    for(n = 0; (c = gzgetc(fp)) != '\n' && c != EOF && n < m; n++)
-#else
-	    for(n = 0; (c = getc(fp)) != '\n' && c != EOF && n < m; n++)
-#endif
+	    for(n = 0; (c = sacGetc(fp)) != '\n' && c != EOF && n < m; n++)
 	    {
 		line[n] = c;
 	    }
@@ -1227,25 +1436,19 @@ read_ascii_sac_header(FILE *fp, SAC *s, int *lineno, const char **err_msg)
 	    {
 		/* read to the next '\n'
 		 */
-#ifdef HAVE_LIBZ
-		while((c = gzgetc(fp)) != '\n' && c != EOF);
-#else
-		while((c = getc(fp)) != '\n' && c != EOF);
-#endif
+		while((c = sacGetc(fp)) != '\n' && c != EOF);
 	    }
 	    m = i < 14 ? 61 : (i < 22 ? 41 : (i == 22 ? 9 : 17));
 	    if(n < m)
 	    {
-		stringcpy(error, "format error: short record.", MAX_ERROR_LEN);
-		*err_msg = error;
+		stringcpy(err_msg, "format error: short record.", MAX_ERROR_LEN);
 		return(WRONG_FORMAT);
 	    }
 
 	    m = i < 22 ? 5 : (i == 22 ? 2 : 3);
 
-	    if(read_sac_line(line, s, table+k, m))
+	    if(read_sac_line(line, s, table+k, m, err_msg))
 	    {
-		*err_msg = error;
 		return(WRONG_FORMAT);
 	    }
 	    k += m;
@@ -1268,7 +1471,7 @@ check_for_null(char *s, int size)
 }
 
 static int
-read_sac_line(const char *line, SAC *s, SacLine *table, int n)
+read_sac_line(const char *line, SAC *s, SacLine *table, int n, char *error)
 {
 	int nc;
 	char buf[20];
@@ -969,6 +969,15 @@ void WaveformWindow::readFiles(vector<string> &files, const string &query,
     }
     if(ts) delete ts;
 
+    // read the headers of many SAC files in parallel
+    vector<string> sac_files;
+    for(i = 0; i < (int)files.size(); i++) {
+	if(!table_suffix[i] && stringCaseEndsWith(files[i].c_str(), ".sac")) {
+	    sac_files.push_back(files[i]);
+	}
+    }
+    if((int)sac_files.size() > 1) SacSource::indexFiles(sac_files);
+
     for(i = 0; i < (int)files.size(); i++) if(!table_suffix[i])
     {
 	if(stringCaseEndsWith(files[i].c_str(), ".sac")) {
@@ -0,0 +1,437 @@
+/** \file allPairsCC.cpp
+ *  \brief All-pairs cross correlation from cached spectra
+ */
+
+#include "config.h"
+#include <math.h>
+#include <string.h>
+#include <new>
+
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+
+using namespace std;
+
+#include "mccc.h"
+extern "C" {
+#include "libstring.h"
+}
+
+/* Windows of the energy sums of slidingCC() between full sums, which keep
+ * the rounding of the running sum from growing
+ */
+#define ENERGY_REFRESH 1024
+
+/* The spectra of all signals and the matrices being filled, shared by the
+ * threads
+ */
+typedef struct
+{
+  int n;		/* number of signals in each set */
+  int m;		/* samples per signal */
+  int nfft;		/* transform length */
+  int lag_min;		/* lag window in samples */
+  int lag_max;
+  const float *const *xf; /* float signals, or NULL */
+  const double *const *x; /* double signals, or NULL */
+  const double *const *y; /* second set, or NULL if it is x */
+  double **spectra;	/* halfcomplex spectrum of each signal of x, then y */
+  double **peak;
+  double **lag;
+  double ***c;		/* the correlation at every lag, or NULL */
+  double **work;	/* one nfft buffer per thread */
+} CCWork;
+
+/* The trace spectrum and window energies of slidingCC(), shared by the
+ * threads
+ */
+typedef struct
+{
+  int nwin;		/* number of windows */
+  int m;		/* samples per window */
+  int n;		/* samples in the trace */
+  int nfft;		/* transform length */
+  const float *const *x; /* windows */
+  double *ys;		/* halfcomplex spectrum of the trace */
+  double *energy;	/* energy of the trace window at each lag */
+  double **c;
+  double **work;	/* one nfft buffer per thread */
+} SlideWork;
+
+static int correlatePairs(CCWork *w, int num_threads);
+static void spectrum(int i, int thread, void *arg);
+static void correlateRow(int i, int thread, void *arg);
+static void slideWindow(int i, int thread, void *arg);
+
+
+/**
+ * Compute the cross correlation peak of every pair of signals.
+ * The pairs are correlated as by pairsCC() within the lag window
+ * -max_lag to max_lag, and each peak is divided by the norms of the two
+ * signals. The lag of the peak is refined to a fraction of a sample by
+ * fitting a parabola through the peak and its two neighbors.
+ * @param[in] n Number of signals
+ * @param[in] m Number of samples in each signal
+ * @param[in] x The signals (n x m)
+ * @param[in] max_lag The lag window in samples
+ * @param[in] num_threads Number of threads, or <= 0 for one per processor
+ * @param[out] coef Preallocated matrix (n x n) of peak correlation
+ *	coefficients. The matrix is symmetric with ones on the diagonal.
+ * @param[out] lag Preallocated matrix (n x n) of the lags of the peaks in
+ *	samples, with lag[j][i] = -lag[i][j]. A positive lag[i][j] means
+ *	that x_i is late relative to x_j. If NULL, the lags are not returned.
+ * @return Returns 0 for success, or -1 if the arguments are invalid or
+ *	memory cannot be allocated.
+ */
+int allPairsCC(int n, int m, const float *const *x, int max_lag,
+	       int num_threads, double **coef, double **lag)
+{
+  CCWork w;
+
+  if (n <= 0 || m <= 0 || x == NULL || coef == NULL || max_lag < 0) {
+    return -1;
+  }
+  if (max_lag > m - 1) max_lag = m - 1;
+
+  memset(&w, 0, sizeof(w));
+  w.n = n;
+  w.m = m;
+  w.lag_min = -max_lag;
+  w.lag_max = max_lag;
+  w.xf = x;
+  w.peak = coef;
+  w.lag = lag;
+
+  if (correlatePairs(&w, num_threads)) return -1;
+
+  /* Normalize by the zero-lag autocorrelations on the diagonal */
+  for (int i = 0; i < n; i++) {
+    for (int j = i + 1; j < n; j++) {
+      double norm = sqrt(coef[i][i] * coef[j][j]);
+      coef[i][j] = coef[j][i] = (norm > 0.) ? coef[i][j] / norm : 0.;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    coef[i][i] = (coef[i][i] > 0.) ? 1. : 0.;
+  }
+  return 0;
+}
+
+/**
+ * Compute the cross correlation of pairs of signals at every lag of a
+ * window. Each signal is transformed once and its spectrum is kept while
+ * the pairs are correlated, so the cost is one FFT per signal plus one
+ * inverse FFT per pair, instead of a time domain sum for every pair and
+ * lag. The rows of pairs are shared among the threads, each taking the
+ * next row as it finishes the last.
+ * For i < j, c[i][j][l - lag_min] is set to
+ *
+ *	c_ij(l) = SUM_k x_i[k+l] * y_j[k],   lag_min <= l <= lag_max
+ *
+ * Samples outside 0 to m-1 are taken to be zero.
+ * @param[in] n Number of signals in each set
+ * @param[in] m Number of samples in each signal
+ * @param[in] x The lagged signals (n x m)
+ * @param[in] y The second set of signals (n x m), or NULL to correlate the
+ *	signals of x with each other
+ * @param[in] lag_min The first lag of the window, in samples
+ * @param[in] lag_max The last lag of the window, in samples
+ * @param[in] num_threads Number of threads, or <= 0 for one per processor
+ * @param[out] c Preallocated matrix (n x n) of arrays. For i < j, c[i][j]
+ *	holds the lag_max-lag_min+1 values of c_ij. The other elements are
+ *	not used.
+ * @return Returns 0 for success, or -1 if the arguments are invalid or
+ *	memory cannot be allocated.
+ */
+int pairsCC(int n, int m, const double *const *x, const double *const *y,
+	    int lag_min, int lag_max, int num_threads, double ***c)
+{
+  CCWork w;
+
+  if (n <= 0 || m <= 0 || x == NULL || c == NULL || lag_min > lag_max
+	|| lag_min <= -m || lag_max >= m) {
+    return -1;
+  }
+
+  memset(&w, 0, sizeof(w));
+  w.n = n;
+  w.m = m;
+  w.lag_min = lag_min;
+  w.lag_max = lag_max;
+  w.x = x;
+  w.y = (y != x) ? y : NULL;
+  w.c = c;
+
+  return correlatePairs(&w, num_threads);
+}
+
+/**
+ * Compute the normalized correlation of windows with a trace at every lag.
+ * For each window x_i of m samples, the coefficient
+ *
+ *	c_i(k) = SUM_j x_i[j] * y[k+j] / (|x_i| |y[k..k+m-1]|),
+ *
+ * for 0 <= k <= n-m, is the correlation coefficient of x_i with the window
+ * of the trace that starts at sample k, normalized by the energy of that
+ * trace window only. The trace is transformed once, and each window costs
+ * one forward and one inverse FFT of the trace length, instead of a time
+ * domain sum at every lag. The windows are shared among the threads. The
+ * caller can limit the memory of c by passing the windows in groups.
+ * @param[in] nwin Number of windows
+ * @param[in] m Number of samples in each window
+ * @param[in] x The windows (nwin x m)
+ * @param[in] n Number of samples in the trace
+ * @param[in] y The trace
+ * @param[in] num_threads Number of threads, or <= 0 for one per processor
+ * @param[out] c Preallocated matrix (nwin x n-m+1) of coefficients. A
+ *	coefficient is 0 where either window is all zero.
+ * @return Returns 0 for success, or -1 if the arguments are invalid or
+ *	memory cannot be allocated.
+ */
+int slidingCC(int nwin, int m, const float *const *x, int n, const float *y,
+	      int num_threads, double **c)
+{
+  SlideWork w;
+  double *work_buffer = NULL;
+  double e;
+  int ret = -1;
+
+  if (nwin <= 0 || m <= 0 || n < m || x == NULL || y == NULL || c == NULL) {
+    return -1;
+  }
+
+  memset(&w, 0, sizeof(w));
+  w.nwin = nwin;
+  w.m = m;
+  w.n = n;
+  w.x = x;
+  w.c = c;
+
+  num_threads = parallel_threads(nwin, num_threads);
+
+  /* Lags 0 to n-m of the circular correlation do not wrap around when
+   * the transform is as long as the trace
+   */
+  for (w.nfft = 2; w.nfft < n; w.nfft *= 2);
+
+  w.ys = new (nothrow) double[w.nfft];
+  w.energy = new (nothrow) double[n - m + 1];
+  w.work = new (nothrow) double *[num_threads];
+  if (w.work) {
+    work_buffer = new (nothrow) double[(size_t)num_threads * w.nfft];
+  }
+
+  if (w.ys && w.energy && work_buffer) {
+    for (int i = 0; i < n; i++) w.ys[i] = (double)y[i];
+    for (int i = n; i < w.nfft; i++) w.ys[i] = 0.;
+    gsl_fft_real_radix2_transform(w.ys, 1, w.nfft);
+
+    e = 0.;
+    for (int k = 0; k <= n - m; k++) {
+      if (k % ENERGY_REFRESH == 0) {
+	e = 0.;
+	for (int j = k; j < k + m; j++) e += (double)y[j] * y[j];
+      }
+      else {
+	e += (double)y[k+m-1] * y[k+m-1] - (double)y[k-1] * y[k-1];
+      }
+      w.energy[k] = (e > 0.) ? e : 0.;
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+      w.work[i] = work_buffer + (size_t)i * w.nfft;
+    }
+    parallel_run_thread(nwin, num_threads, slideWindow, &w);
+    ret = 0;
+  }
+  else {
+    cerr << "slidingCC: cannot allocate the spectrum of " << n
+	 << " samples" << endl;
+  }
+
+  delete [] w.ys;
+  delete [] w.energy;
+  delete [] work_buffer;
+  delete [] w.work;
+
+  return ret;
+}
+
+/* Transform the signals and correlate the pairs described by w.
+ */
+static int correlatePairs(CCWork *w, int num_threads)
+{
+  int n = w->n, nspectra = (w->y != NULL) ? 2*n : n;
+  int max_lag = (w->lag_max > -w->lag_min) ? w->lag_max : -w->lag_min;
+  double *spectra_buffer = NULL, *work_buffer = NULL;
+  int ret = -1;
+
+  num_threads = parallel_threads(n, num_threads);
+
+  /* The correlation is circular, so the transform must be long enough
+   * that lags within the window do not wrap around onto each other
+   */
+  for (w->nfft = 2; w->nfft < w->m + max_lag; w->nfft *= 2);
+
+  w->spectra = new (nothrow) double *[nspectra];
+  w->work = new (nothrow) double *[num_threads];
+  if (w->spectra && w->work) {
+    spectra_buffer = new (nothrow) double[(size_t)nspectra * w->nfft];
+    work_buffer = new (nothrow) double[(size_t)num_threads * w->nfft];
+  }
+
+  if (spectra_buffer && work_buffer) {
+    for (int i = 0; i < nspectra; i++) {
+      w->spectra[i] = spectra_buffer + (size_t)i * w->nfft;
+    }
+    for (int i = 0; i < num_threads; i++) {
+      w->work[i] = work_buffer + (size_t)i * w->nfft;
+    }
+
+    parallel_run_thread(nspectra, num_threads, spectrum, w);
+    parallel_run_thread(n, num_threads, correlateRow, w);
+    ret = 0;
+  }
+  else {
+    cerr << "pairsCC: cannot allocate spectra for " << n
+	 << " signals" << endl;
+  }
+
+  delete [] spectra_buffer;
+  delete [] work_buffer;
+  delete [] w->spectra;
+  delete [] w->work;
+
+  return ret;
+}
+
+/* Transform signal i of x, or signal i-n of y.
+ */
+static void spectrum(int i, int thread, void *arg)
+{
+  CCWork *w = (CCWork *)arg;
+  double *s = w->spectra[i];
+
+  if (w->xf) {
+    for (int k = 0; k < w->m; k++) s[k] = (double)w->xf[i][k];
+  }
+  else {
+    const double *d = (i < w->n) ? w->x[i] : w->y[i - w->n];
+    memcpy(s, d, w->m * sizeof(double));
+  }
+  for (int k = w->m; k < w->nfft; k++) s[k] = 0.;
+
+  gsl_fft_real_radix2_transform(s, 1, w->nfft);
+}
+
+/* Correlate signal i with each of the signals j > i. When the signals are
+ * correlated with each other, also fill the diagonal and the lower
+ * triangle.
+ */
+static void correlateRow(int i, int thread, void *arg)
+{
+  CCWork *w = (CCWork *)arg;
+  int nfft = w->nfft, n2 = w->nfft/2;
+  bool self = (w->y == NULL);
+  double *a = w->spectra[i];
+  double *r = w->work[thread];
+
+  if (self && w->peak) {
+    double sum = 0.;
+    if (w->xf) {
+      for (int k = 0; k < w->m; k++) sum += (double)w->xf[i][k]*w->xf[i][k];
+    }
+    else {
+      for (int k = 0; k < w->m; k++) sum += w->x[i][k] * w->x[i][k];
+    }
+    w->peak[i][i] = sum;
+    if (w->lag) w->lag[i][i] = 0.;
+  }
+
+  for (int j = i + 1; j < w->n; j++) {
+    double *b = w->spectra[self ? j : w->n + j];
+
+    /* A * conj(B) in the halfcomplex order of gsl: real parts in
+     * 0..nfft/2, imaginary parts in nfft-1 down to nfft/2+1
+     */
+    r[0] = a[0] * b[0];
+    r[n2] = a[n2] * b[n2];
+    for (int k = 1; k < n2; k++) {
+      double ar = a[k], ai = a[nfft-k], br = b[k], bi = b[nfft-k];
+      r[k] = ar * br + ai * bi;
+      r[nfft-k] = ai * br - ar * bi;
+    }
+    gsl_fft_halfcomplex_radix2_inverse(r, 1, nfft);
+
+    /* Negative lags are at the end of the circular correlation */
+#define R(l) r[((l) < 0) ? nfft + (l) : (l)]
+    if (w->c) {
+      for (int l = w->lag_min; l <= w->lag_max; l++) {
+	w->c[i][j][l - w->lag_min] = R(l);
+      }
+      continue;
+    }
+
+    int l_max = w->lag_min;
+    double c_max = R(l_max);
+    for (int l = w->lag_min + 1; l <= w->lag_max; l++) {
+      if (R(l) > c_max) {
+	c_max = R(l);
+	l_max = l;
+      }
+    }
+
+    double peak = (double)l_max;
+    if (l_max > w->lag_min && l_max < w->lag_max) {
+      double c0 = R(l_max - 1), c2 = R(l_max + 1);
+      double d = c0 - 2. * c_max + c2;
+      if (d < 0.) peak += 0.5 * (c0 - c2) / d;
+    }
+#undef R
+
+    w->peak[i][j] = c_max;
+    if (w->lag) w->lag[i][j] = peak;
+    if (self) {
+      w->peak[j][i] = c_max;
+      if (w->lag) w->lag[j][i] = -peak;
+    }
+  }
+}
+
+/* Correlate window i with the trace at every lag.
+ */
+static void slideWindow(int i, int thread, void *arg)
+{
+  SlideWork *w = (SlideWork *)arg;
+  int nfft = w->nfft, n2 = w->nfft/2;
+  double *a = w->ys;
+  double *r = w->work[thread];
+  double sum = 0.;
+
+  for (int k = 0; k < w->m; k++) {
+    r[k] = (double)w->x[i][k];
+    sum += r[k] * r[k];
+  }
+  for (int k = w->m; k < nfft; k++) r[k] = 0.;
+
+  if (sum <= 0.) {
+    for (int k = 0; k <= w->n - w->m; k++) w->c[i][k] = 0.;
+    return;
+  }
+  gsl_fft_real_radix2_transform(r, 1, nfft);
+
+  /* Y * conj(X) in place, in the halfcomplex order of gsl */
+  r[0] = a[0] * r[0];
+  r[n2] = a[n2] * r[n2];
+  for (int k = 1; k < n2; k++) {
+    double ar = a[k], ai = a[nfft-k], br = r[k], bi = r[nfft-k];
+    r[k] = ar * br + ai * bi;
+    r[nfft-k] = ai * br - ar * bi;
+  }
+  gsl_fft_halfcomplex_radix2_inverse(r, 1, nfft);
+
+  double norm = sqrt(sum);
+  for (int k = 0; k <= w->n - w->m; k++) {
+    w->c[i][k] = (w->energy[k] > 0.) ? r[k] / (norm * sqrt(w->energy[k])) : 0.;
+  }
+}
@@ -31,6 +31,17 @@ extern "C" {
  */
 #define STEPS_COUNT 3
 
+/* The values of equation (1) for every pair of signals i < j at every tau
+ * of the range, computed at once by calculatePhiLags
+ */
+typedef struct
+{
+  int L;		/* tau = l delta_t for -L <= l <= L */
+  int *p;		/* index of tp_i + t_0 of each signal */
+  double *buffer;
+  double ***phi;	/* phi[i][j][L + l] for i < j */
+} PhiLags;
+
 
 /* Static functions
  */
@@ -43,6 +54,26 @@ static double calculatePhi(const int m,
 		    const double tp_i,
 		    const double tp_j,
 		    const double tau);
+static bool calculatePhiLags(const int n,
+			     const int m,
+			     const double delta_t,
+			     const double *const *const x,
+			     const double T,
+			     const double t_0,
+			     const double *const tp,
+			     const double tau_range,
+			     PhiLags *lags);
+static double lookupPhi(const PhiLags *lags,
+			const int m,
+			const double delta_t,
+			const double *const *const x,
+			const double T,
+			const double t_0,
+			const double *const tp,
+			const int i,
+			const int j,
+			const double tau);
+static void freePhiLags(PhiLags *lags, const int n);
 static void calculateT(const int n,
 		const int m,
 		const double delta_t,
@@ -318,6 +349,142 @@ static double calculatePhi(const int m,
 
 }
 
+/* This function evaluates equation (1) for every pair of signals i < j
+ * and every tau = l delta_t in the range [-tau_range, tau_range] at once.
+ * For
+ *
+ *   a_i[k] = x_i[p_i - L + k],  b_j[k] = x_j[p_j + k],  k < n - p
+ *
+ * where p_i is the index of tp_i + t_0 and L the index of tau_range, and
+ * elements past n (the index of T) are zero, calculatePhi() for
+ * tau = l delta_t is the cross correlation of a_i and b_j at the lag
+ * L + l. So all the tau of a pair come from one frequency domain
+ * correlation (see pairsCC), with the pairs shared among threads. The
+ * arguments are those of calculatePhi(), and:
+ * @param(in) n the number of signals
+ * @param(in) x matrix (dimension n*m) with the elements from the signal
+ * @param(in) tp trace preliminary arrival time estimate
+ * @param(in) tau_range the range of tau, which is in [-tau_range,tau_range]
+ * @param(out) lags the values of phi, to be freed with freePhiLags()
+ * @return true if lags was filled, false if calculatePhi() must be used
+ */
+static bool calculatePhiLags(const int n,
+			     const int m,
+			     const double delta_t,
+			     const double *const *const x,
+			     const double T,
+			     const double t_0,
+			     const double *const tp,
+			     const double tau_range,
+			     PhiLags *lags)
+{
+  lags->p = NULL;
+  lags->buffer = NULL;
+  lags->phi = NULL;
+
+  int nT = INDEX(T, delta_t);
+  if (n < 2 || nT >= m) return false;
+
+  /* The number of steps of delta_t on each side of tau = 0 */
+  int L = INDEX(tau_range, delta_t);
+  if (L < 0) return false;
+  lags->L = L;
+
+  /* Indexes where the correlation windows begin */
+  lags->p = new int[n];
+  int len = 0;
+  for (int i = 0; i < n; ++i) {
+    lags->p[i] = INDEX(tp[i] + t_0, delta_t);
+    if (nT - lags->p[i] + L > len) len = nT - lags->p[i] + L;
+  }
+  if (2 * L >= len) {
+    freePhiLags(lags, n);
+    return false;
+  }
+
+  /* Elements outside of the correlation windows are zero */
+  double *a_buffer = new double[2 * n * len];
+  double *b_buffer = a_buffer + n * len;
+  double **a = new double *[n];
+  double **b = new double *[n];
+  for (int i = 0; i < n; ++i) {
+    a[i] = a_buffer + i * len;
+    b[i] = b_buffer + i * len;
+    for (int k = 0; k < len; ++k) {
+      int ka = lags->p[i] - L + k, kb = lags->p[i] + k;
+      a[i][k] = (ka >= 0 && ka < nT) ? x[i][ka] : 0.;
+      b[i][k] = (kb >= 0 && kb < nT) ? x[i][kb] : 0.;
+    }
+  }
+
+  int nl = 2 * L + 1;
+  lags->buffer = new double[(size_t)n * (n - 1) / 2 * nl];
+  lags->phi = new double **[n];
+  double *row = lags->buffer;
+  for (int i = 0; i < n; ++i) {
+    lags->phi[i] = new double *[n];
+    for (int j = 0; j < n; ++j) {
+      lags->phi[i][j] = NULL;
+    }
+    for (int j = i + 1; j < n; ++j, row += nl) {
+      lags->phi[i][j] = row;
+    }
+  }
+
+  bool ret = true;
+  if (pairsCC(n, len, a, b, 0, 2 * L, 0, lags->phi)) {
+    cerr << "calculatePhi: cannot correlate " << n << " signals" << endl;
+    freePhiLags(lags, n);
+    ret = false;
+  }
+
+  delete [] a_buffer;
+  delete [] a;
+  delete [] b;
+
+  return ret;
+}
+
+/* This function returns calculatePhi() for the pair i < j and tau from
+ * the values of calculatePhiLags(). A tau outside of the values, or for
+ * which calculatePhi() reports an invalid index, is passed to
+ * calculatePhi().
+ */
+static double lookupPhi(const PhiLags *lags,
+			const int m,
+			const double delta_t,
+			const double *const *const x,
+			const double T,
+			const double t_0,
+			const double *const tp,
+			const int i,
+			const int j,
+			const double tau)
+{
+  if (lags->phi != NULL) {
+    /* The index of calculatePhi() */
+    int i_lo = INDEX(tp[i] + t_0 + tau, delta_t);
+    int l = i_lo - lags->p[i];
+    if (l >= -lags->L && l <= lags->L && i_lo >= 0 && lags->p[j] >= 0) {
+      return lags->phi[i][j][lags->L + l];
+    }
+  }
+  return calculatePhi(m, delta_t, x[i], x[j], T, t_0, tp[i], tp[j], tau);
+}
+
+static void freePhiLags(PhiLags *lags, const int n)
+{
+  if (lags->phi != NULL) {
+    for (int i = 0; i < n; ++i) delete [] lags->phi[i];
+  }
+  delete [] lags->phi;
+  delete [] lags->buffer;
+  delete [] lags->p;
+  lags->phi = NULL;
+  lags->buffer = NULL;
+  lags->p = NULL;
+}
+
 /* This function implements the calculation of value t found in equation 
  *               1  i-1                   n 
  * (6)t^{est}_i = -(-SUM \Delta t_{ji} + SUM \Delta t_{ij}) from VD-C
@@ -382,9 +549,25 @@ static void calculateT(const int n,
   /* Allocation of memory for matrix of value coefs */
   double *coefs_buffer;
   double **coefs;
-  coefs_buffer = new double[n * m];
+  coefs_buffer = new double[n * n];
   coefs = new double *[n];
-  for (int i = 0; i < n; ++i) coefs[i] = coefs_buffer + i * m;
+  for (int i = 0; i < n; ++i) coefs[i] = coefs_buffer + i * n;
+
+  /* The cross-correlation function of each pair at every tau of the
+   * range, which the search below reads instead of summing each tau
+   */
+  PhiLags lags;
+  calculatePhiLags(n, m, delta_t, x, T, t_0, tp, tau_range, &lags);
+
+  /* The norm of each signal */
+  double *sigma = new double[n];
+  for (int i = 0; i < n; ++i) {
+    sigma[i] = 0.0;
+    for (int k = 0; k < m; k++) {
+      sigma[i] += pow(x[i][k], 2);
+    }
+    sigma[i] = sqrt(sigma[i]);
+  }
 
   /* Calculation of values dt according to 
    * (5) t_i-t_j=\Delta t_{ij}, i=1,...,n-1, j=i+1,...,n
@@ -399,8 +582,8 @@ static void calculateT(const int n,
        * has maximum) is initialized to 0, and then we calculate
        * the cross-correlation function for such tau */
       double tau_max = 0;
-      double phi_max = calculatePhi(m, delta_t, x[i], x[j], T, t_0, tp[i],
-				    tp[j], tau_max);
+      double phi_max = lookupPhi(&lags, m, delta_t, x, T, t_0, tp, i, j,
+				 tau_max);
 
       /* Evaluation of the cross-correlation function for each
        * tau from the specified range. In case there is a value tau
@@ -436,8 +619,7 @@ static void calculateT(const int n,
 	   * for current tau, in order to halt the maximum of 
            * cross-correlation function, together with the desired tau value 
            */ 
-	  double phi = calculatePhi(m, delta_t, x[i], x[j], T, t_0, tp[i],
-				    tp[j], tau);
+	  double phi = lookupPhi(&lags, m, delta_t, x, T, t_0, tp, i, j, tau);
 	  if (phi_max < phi) {
 	    tau_max = tau;
 	    phi_max = phi;
@@ -459,26 +641,17 @@ static void calculateT(const int n,
       dt[i][j] = tp[i] - tp[j] - tau_max;
       
       /* Evaluation of coefs[i][j] value according to (3) */
-      double sigma_i = 0.0;
-      double sigma_j = 0.0;
-  
-      
-      for (int k = 0; k < m; k++) {
-	sigma_i += pow(x[i][k], 2);
-	sigma_j += pow(x[j][k], 2);
-	//printf("sigma_i[%d] = %f\n", k, sigma_i);
-	//printf("sigma_j[%d] = %f\n", k, sigma_j);
-      }
-      sigma_i = sqrt(sigma_i);
-      sigma_j = sqrt(sigma_j);
-      
-      coefs[i][j] = calculatePhi(m, delta_t, x[i], x[j], T, t_0, tp[i],
-				 tp[j], tau_max) / (sigma_i*sigma_j);
+      coefs[i][j] = lookupPhi(&lags, m, delta_t, x, T, t_0, tp, i, j,
+			      tau_max) / (sigma[i]*sigma[j]);
 
 
       }  
 
   }
+
+  delete [] sigma;
+  freePhiLags(&lags, n);
+
   /* Equations (6) & (7), where (7)res_ij = \Delta t_{ij} - (t_i - t_j_)
    */
 
@@ -28,6 +28,7 @@
 extern "C" {
 #include "libtime.h"
 #include "libstring.h"
+#include "libgmath.h"
 static void * ReadInput(void *client_data);
 }
 //#define DEBUG_APP 
@@ -593,6 +594,8 @@ printf("foreach command: %s\n", line);
 	printf("print ATTRIBUTE ATTRIBUTE...\n");
 	printf("printOpen FILE [append=(true,false)]\n");
 	printf("printClose\n");
+	printf("profile (start,stop,reset,report)\n");
+	printf("profile trace file=FILE\n");
 	printf("set name=VALUE\n");
 	printf("export name\n");
 //	printf("setb name=BOOL_VALUE\n");
@@ -618,6 +621,13 @@ printf("foreach command: %s\n", line);
 	    }
 	}
     }
+    else if( parseArg(line, "profile", c) ) {
+	return profileCmd(c);
+    }
+    else if(!strcasecmp(line, "profile")) {
+	printParseError("profile: missing argument");
+	return false;
+    }
     else if( parseArg(line, "printOpen", c) ) {
 	return printOpenFile(c);
     }
@@ -1008,6 +1018,63 @@ bool AppParse::printOpenFile(const string &c)
     return true;
 }
 
+/** Start, stop, reset or report the profile of the instrumented stages. The
+ *  report lists the count, total, mean and maximum time of each stage. It is
+ *  printed to the printOpen file, if one is open, and the number of events
+ *  is put in the variable profile_events. The trace file is in the Chrome
+ *  trace format.
+ *  <pre>
+ *	profile start
+ *	profile stop
+ *	profile reset
+ *	profile report
+ *	profile trace file=FILE
+ *  </pre>
+ */
+bool AppParse::profileCmd(const string &c)
+{
+    string file, s;
+    char *prop;
+
+    if(parseCompare(c, "start")) {
+	profile_start();
+    }
+    else if(parseCompare(c, "stop")) {
+	profile_stop();
+    }
+    else if(parseCompare(c, "reset")) {
+	profile_reset();
+    }
+    else if(parseCompare(c, "report")) {
+	char num[20];
+	snprintf(num, sizeof(num), "%d",
+		profile_report(print_fp ? print_fp : stdout));
+	putGlobalVariable("profile_events", num);
+    }
+    else if( parseArg(c, "trace", s) ) {
+	if(!parseGetArg(s, "file", file)) {
+	    printParseError("profile trace: missing file argument");
+	    return false;
+	}
+	if(getVariable(file, &prop) == VARIABLE_ERROR) {
+	    return false;
+	}
+	else if(prop) {
+	    file.assign(prop);
+	    free(prop);
+	}
+	if(profile_trace(file.c_str())) {
+	    printParseError("profile trace: cannot write %s", file.c_str());
+	    return false;
+	}
+    }
+    else {
+	printParseError("profile: invalid argument: %s", c.c_str());
+	return false;
+    }
+    return true;
+}
+
 bool AppParse::writeOpenFile(const string &c)
 {
     string file;
@@ -57,6 +57,7 @@ extern "C" {
 #include "DataMethod.h"
 #include "libgio.h"
 #include "widget/CPlotClass.h"
+#include "ProfileTimer.h"
 
 #define MAPALF
 
@@ -1181,6 +1182,8 @@ CPlotRedraw(AxesWidget widget, int type, double shift)
 
 	if(w == NULL || !XtIsRealized((Widget)w)) return;
 
+	ProfileTimer pt("CPlotRedraw");
+
 	if(cp->arrival_i >= 0) {
 	    destroyInfoPopup(w);
 	    cp->arrival_i = -1;
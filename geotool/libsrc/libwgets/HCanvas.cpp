@@ -919,7 +919,8 @@ FindApplyCB(Widget widget, XtPointer client_data, XtPointer callback_data)
 	n = t->nrows + t->nhidden;
 
 	for(i = 0; i < n &&
-		strncasecmp(text, t->columns[j][t->row_order[i]], len); i++);
+		strncasecmp(text, _MmTableCell(h->table, t->row_order[i], j), len);
+		i++);
 
 	if(i < n) {
 	    t->table_class->moveToTop(t->row_order[i]);
@@ -961,7 +962,8 @@ FindNextCB(Widget widget, XtPointer client_data, XtPointer callback_data)
 	start = MmTableGetBarValue(t->vbar) + 1;
 	if(start < 0) start = 0;
 	for(i = start; i < n &&
-		strncasecmp(text, t->columns[j][t->row_order[i]], len); i++);
+		strncasecmp(text, _MmTableCell(h->table, t->row_order[i], j), len);
+		i++);
 
 	if(i < n) {
 	    t->table_class->moveToTop(t->row_order[i]);
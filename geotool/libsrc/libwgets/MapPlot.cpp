@@ -23,6 +23,7 @@
 #include <math.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <dirent.h>
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -219,6 +220,27 @@ static Boolean RedisplaySymbol(MapPlotWidget w, Window window, double lon,
 static void RedisplaySymbolGroup(MapPlotWidget w, Window window,
 			MapSymbolGroup *s);
 static void RedisplayMapSymbol(MapPlotWidget w, Window window,MapPlotSymbol *s);
+static void RedisplayStaSrc(MapPlotWidget w, Window window, Boolean station);
+static void DrawSymbolRun(MapPlotWidget w, Window window, GC gc, int type,
+			double siz, int n, XPoint *pts);
+static void AddSymbolSegs(XSegment *segs, int *j, XPoint *points,int npoints);
+static int NewPixelStamps(MapPlotWidget w, int n);
+static Boolean PixelDrawn(MapPlotWidget w, int x, int y, int k);
+static void GetProjKey(MapPlotWidget w, MapProjKey *key);
+static Boolean SymbolCacheBegin(MapPlotWidget w, SymbolCache *c, int n);
+static void SymbolCacheSet(MapPlotWidget w, SymbolCache *c, Boolean all,
+			int i, double lon, double lat);
+static void SymbolCacheEnd(MapPlotWidget w, SymbolCache *c, int n);
+static void SymbolCell(SymbolCache *c, int x, int y, int *cx, int *cy);
+static void FreeSymbolCache(SymbolCache *c);
+static void UpdateStaSrcCache(MapPlotWidget w, Boolean station);
+static void UpdateMapSymbolCache(MapPlotWidget w);
+static Boolean StationOn(MapPlotWidget w, int i, Boolean selected_on);
+static Boolean SourceOn(MapPlotWidget w, int i, Boolean selected_on);
+static Boolean MapSymbolOn(MapPlotWidget w, int i, Boolean selected_on);
+static int SymbolCacheNearest(MapPlotWidget w, SymbolCache *c, int cursor_x,
+			int cursor_y, double dlim, Boolean (*on)(MapPlotWidget,
+			int, Boolean), Boolean selected_on, double *dmin);
 static void DrawHardSymbols(MapPlotWidget w, FILE *fp, DrawStruct *d,
 			MapSymbolGroup *s, Boolean do_color);
 static Boolean DrawHardSymbol(MapPlotWidget w, FILE *fp, DrawStruct *d,
@@ -376,6 +398,14 @@ static void MapGetMerLongitudes(MapPlotWidget w, SHPObject *s, int numlat,
 			int *sizes);
 static void DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t,
 			int ishape);
+static void IndexTheme(MapTheme *t);
+static void FreeThemeIndex(MapTheme *t);
+static SHPObject *SimplifyShape(SHPObject *s, double tol);
+static int SimplifyPart(double *x, double *y, int n, double tol,
+			Boolean closed, char *keep, int *stack);
+static int ThemeLevel(MapPlotWidget w, DrawStruct *d, MapTheme *t);
+static int ThemeShapesInView(MapPlotWidget w, MapTheme *t, int ishape,
+			int **ids);
 static void DisplayArcShapeLabel(MapPlotWidget w, Window window, GC gc,
 			MapTheme *t, int i);
 static int WhichThemeShape(MapPlotWidget w, int cursor_x, int cursor_y,
@@ -735,6 +765,12 @@ Initialize(Widget w_req, Widget w_new)
 	mp->nrect = 0;
 	mp->size_rect = 0;
 	mp->rect = NULL;
+	memset(&mp->sta_cache, 0, sizeof(SymbolCache));
+	memset(&mp->src_cache, 0, sizeof(SymbolCache));
+	memset(&mp->symbol_cache, 0, sizeof(SymbolCache));
+	mp->pixel_stamp = NULL;
+	mp->size_pixel_stamp = 0;
+	mp->last_pixel_stamp = 0;
 
 	mp->n_measure_arcs = 0;
 	mp->measure_arc = (MapArc **)AxesMalloc(w_new, sizeof(MapArc *));
@@ -1823,8 +1859,9 @@ RedisplayOverlays(MapPlotWidget w, Window window)
 	int		i;
 	SymbolInfo	*sym;
 	LineInfo	*line;
-	MapStation	*sta;
-	MapSource	*src;
+	int		stamp = 0, last_type = 0, last_size = 0;
+	Pixel		fg, last_fg = 0;
+	MapPlotSymbol	*s;
 
 	if(!XtIsRealized((Widget)w)) return;
 
@@ -1848,46 +1885,42 @@ RedisplayOverlays(MapPlotWidget w, Window window)
 		RedisplaySymbolGroup(w, window, mp->symgrp[i]);
 	    }
 	}
+	/* Skip a symbol at the same pixel as an identical one drawn before it,
+	 * with nothing between them.
+	 */
+	UpdateMapSymbolCache(w);
 	for(i = 0; i < mp->nsymbol; i++)
 	{
-            if(mp->symbol[i].sym.display == MAP_ON ||
-                mp->symbol[i].sym.display == MAP_LOCKED_ON ||
-                (mp->symbol[i].sym.display == MAP_SELECTED_ON &&
-                        mp->symbol[i].sym.selected))
+	    s = &mp->symbol[i];
+            if(s->sym.display == MAP_ON || s->sym.display == MAP_LOCKED_ON ||
+                (s->sym.display == MAP_SELECTED_ON && s->sym.selected))
             {
-                RedisplayMapSymbol(w, window, &mp->symbol[i]);
+		if(i < mp->symbol_cache.n && mp->symbol_cache.in[i]) {
+		    fg = s->sym.selected ? ax->select_fg : s->sym.fg;
+		    if(stamp == 0 || fg != last_fg || s->sym.type != last_type
+			|| s->sym.size != last_size)
+		    {
+			stamp = NewPixelStamps(w, 1);
+			last_fg = fg;
+			last_type = s->sym.type;
+			last_size = s->sym.size;
+		    }
+		    if(PixelDrawn(w, mp->symbol_cache.x[i],
+				mp->symbol_cache.y[i], stamp)) continue;
+		}
+                RedisplayMapSymbol(w, window, s);
             }
 	}
 	
 	if(mp->display_circles) RedisplayCircles(w, window);
 
-	for(i = 0; i < mp->nsta; i++)
-	{
-	    sym = &mp->sta[i]->station.sym;
-	    if(sym->display == MAP_ON || sym->display == MAP_LOCKED_ON ||
-		(sym->display == MAP_SELECTED_ON && sym->selected))
-	    {
-		sta = mp->sta[i];
-		sta->visible = RedisplaySymbol(w, window, sta->station.lon,
-						sta->station.lat, sym);
-	    }
-	}
+	RedisplayStaSrc(w, window, True);
 	if(mp->display_station_tags)
 	{
 	    DrawStationTags(w, window);
 	}
 
-	for(i = 0; i < mp->nsrc; i++)
-	{
-	    sym = &mp->src[i]->source.sym;
-	    if(sym->display == MAP_ON || sym->display == MAP_LOCKED_ON ||
-		(sym->display == MAP_SELECTED_ON && sym->selected))
-	    {
-		src = mp->src[i];
-		src->visible = RedisplaySymbol(w, window, src->source.lon,
-						src->source.lat, sym);
-	    }
-	}
+	RedisplayStaSrc(w, window, False);
 	if(mp->display_source_tags)
 	{
 	    DrawSourceTags(w, window);
@@ -2709,16 +2742,559 @@ RedisplaySymbol(MapPlotWidget w, Window window, double lon, double lat,
 	return(True);
 }
 
+/* Draw the station (station = True) or source symbols that are on, in
+ * index order. The positions come from the symbol cache. A run of symbols
+ * with the same type, size and color is drawn with one request, and a
+ * symbol is skipped if the run has already drawn one at its pixel.
+ */
+static void
+RedisplayStaSrc(MapPlotWidget w, Window window, Boolean station)
+{
+	MapPlotPart	*mp = &w->map_plot;
+	AxesPart	*ax = &w->axes;
+	SymbolCache	*c = station ? &mp->sta_cache : &mp->src_cache;
+	int		i, n, npts, stamp = 0, run_type = 0, run_size = 0;
+	Pixel		fg, run_fg = 0;
+	SymbolInfo	*sym;
+	Boolean		*visible;
+	XPoint		*pts;
+	GC		gc;
+
+	n = station ? mp->nsta : mp->nsrc;
+	if(!XtIsRealized((Widget)w) || n <= 0) return;
+
+	UpdateStaSrcCache(w, station);
+	if(c->n < n) return;
+
+	if( !(pts = (XPoint *)AxesMalloc((Widget)w, n*sizeof(XPoint))) ) return;
+
+	gc = mp->symbolGC;
+	XSetClipRectangles(XtDisplay(w), gc, 0,0, &ax->clip_rect, 1, Unsorted);
+
+	for(i = npts = 0; i < n; i++)
+	{
+	    if(station) {
+		sym = &mp->sta[i]->station.sym;
+		visible = &mp->sta[i]->visible;
+	    }
+	    else {
+		sym = &mp->src[i]->source.sym;
+		visible = &mp->src[i]->visible;
+	    }
+	    if(!(sym->display == MAP_ON || sym->display == MAP_LOCKED_ON ||
+		(sym->display == MAP_SELECTED_ON && sym->selected))) continue;
+
+	    *visible = (Boolean)c->in[i];
+	    if(!c->in[i]) continue;
+
+	    fg = sym->selected ? ax->select_fg : sym->fg;
+	    if(npts > 0 && (fg != run_fg || sym->type != run_type
+			|| sym->size != run_size))
+	    {
+		XSetForeground(XtDisplay(w), gc, run_fg);
+		DrawSymbolRun(w, window, gc, run_type, (double)run_size,
+				npts, pts);
+		npts = 0;
+	    }
+	    if(npts == 0) {
+		run_fg = fg;
+		run_type = sym->type;
+		run_size = sym->size;
+		stamp = NewPixelStamps(w, 1);
+	    }
+	    if(PixelDrawn(w, c->x[i], c->y[i], stamp)) continue;
+
+	    pts[npts].x = (short int)c->x[i];
+	    pts[npts].y = (short int)c->y[i];
+	    npts++;
+	}
+	if(npts > 0) {
+	    XSetForeground(XtDisplay(w), gc, run_fg);
+	    DrawSymbolRun(w, window, gc, run_type, (double)run_size, npts, pts);
+	}
+	Free(pts);
+}
+
+/* Draw n symbols of one type, size and color centered at pts, with the
+ * shapes of RedisplaySymbol. Only the filled triangles and diamonds need a
+ * request for each symbol.
+ */
+static void
+DrawSymbolRun(MapPlotWidget w, Window window, GC gc, int type, double siz,
+		int n, XPoint *pts)
+{
+	Display		*display = XtDisplay(w);
+	int		i, j, x0, y0;
+	double		h, v;
+	XArc		*arcs = NULL;
+	XRectangle	*rects = NULL;
+	XSegment	*segs = NULL;
+	XPoint		points[5];
+
+	h = .57735*siz + .5;	/* tan(30)*siz */
+	v = sqrt(h*h + siz*siz) + .5;
+
+	if(type == CIRCLE || type == FILLED_CIRCLE)
+	{
+	    if( !(arcs = (XArc *)AxesMalloc((Widget)w, n*sizeof(XArc))) ) return;
+	    for(i = 0; i < n; i++) {
+		arcs[i].x = (short int)(pts[i].x - siz);
+		arcs[i].y = (short int)(pts[i].y - siz);
+		arcs[i].width = (short unsigned int)(2*siz);
+		arcs[i].height = (short unsigned int)(2*siz);
+		arcs[i].angle1 = 0;
+		arcs[i].angle2 = 360*64;
+	    }
+	    if(type == CIRCLE) XDrawArcs(display, window, gc, arcs, n);
+	    else XFillArcs(display, window, gc, arcs, n);
+	    Free(arcs);
+	}
+	else if(type == SQUARE || type == FILLED_SQUARE)
+	{
+	    if( !(rects = (XRectangle *)AxesMalloc((Widget)w,
+			n*sizeof(XRectangle))) ) return;
+	    for(i = 0; i < n; i++) {
+		rects[i].x = (short int)(pts[i].x - siz);
+		rects[i].y = (short int)(pts[i].y - siz);
+		rects[i].width = (short unsigned int)(2*siz);
+		rects[i].height = (short unsigned int)(2*siz);
+	    }
+	    if(type == SQUARE) XDrawRectangles(display, window, gc, rects, n);
+	    else XFillRectangles(display, window, gc, rects, n);
+	    Free(rects);
+	}
+	else if(type == TRIANGLE || type == INV_TRIANGLE || type == DIAMOND
+		|| type == PLUS)
+	{
+	    if( !(segs = (XSegment *)AxesMalloc((Widget)w,
+			4*n*sizeof(XSegment))) ) return;
+	    for(i = j = 0; i < n; i++)
+	    {
+		x0 = pts[i].x;
+		y0 = pts[i].y;
+		if(type == TRIANGLE || type == INV_TRIANGLE)
+		{
+		    int s = (type == TRIANGLE) ? 1 : -1;
+		    points[0].x = (short int)(x0 - s*siz);
+		    points[0].y = (short int)(y0 + s*h);
+		    points[1].x = (short int)(x0 + s*siz);
+		    points[1].y = (short int)(y0 + s*h);
+		    points[2].x = x0;
+		    points[2].y = (short int)(y0 - s*v);
+		    points[3] = points[0];
+		    AddSymbolSegs(segs, &j, points, 4);
+		}
+		else if(type == DIAMOND)
+		{
+		    points[0].x = x0;
+		    points[0].y = (short int)(y0 - siz);
+		    points[1].x = (short int)(x0 - siz);
+		    points[1].y = y0;
+		    points[2].x = x0;
+		    points[2].y = (short int)(y0 + siz);
+		    points[3].x = (short int)(x0 + siz);
+		    points[3].y = y0;
+		    points[4] = points[0];
+		    AddSymbolSegs(segs, &j, points, 5);
+		}
+		else
+		{
+		    segs[j].x1 = (short int)(x0 - siz);
+		    segs[j].y1 = y0;
+		    segs[j].x2 = (short int)(x0 + siz);
+		    segs[j].y2 = y0;
+		    j++;
+		    segs[j].x1 = x0;
+		    segs[j].y1 = (short int)(y0 - siz);
+		    segs[j].x2 = x0;
+		    segs[j].y2 = (short int)(y0 + siz);
+		    j++;
+		}
+	    }
+	    if(type == PLUS) {
+		XSetLineAttributes(display, gc, 2, LineSolid, CapNotLast,
+				JoinMiter);
+	    }
+	    XDrawSegments(display, window, gc, segs, j);
+	    if(type == PLUS) {
+		XSetLineAttributes(display, gc, 0, LineSolid, CapNotLast,
+				JoinMiter);
+	    }
+	    Free(segs);
+	}
+	else if(type == FILLED_TRIANGLE || type == FILLED_INV_TRIANGLE
+		|| type == FILLED_DIAMOND)
+	{
+	    for(i = 0; i < n; i++)
+	    {
+		x0 = pts[i].x;
+		y0 = pts[i].y;
+		if(type == FILLED_DIAMOND)
+		{
+		    points[0].x = x0;
+		    points[0].y = (short int)(y0 - siz);
+		    points[1].x = (short int)(x0 - siz);
+		    points[1].y = y0;
+		    points[2].x = x0;
+		    points[2].y = (short int)(y0 + siz);
+		    points[3].x = (short int)(x0 + siz);
+		    points[3].y = y0;
+		    points[4] = points[0];
+		    XFillPolygon(display, window, gc, points, 5, Nonconvex,
+				CoordModeOrigin);
+		}
+		else
+		{
+		    int s = (type == FILLED_TRIANGLE) ? 1 : -1;
+		    points[0].x = (short int)(x0 - s*siz);
+		    points[0].y = (short int)(y0 + s*h);
+		    points[1].x = (short int)(x0 + s*siz);
+		    points[1].y = (short int)(y0 + s*h);
+		    points[2].x = x0;
+		    points[2].y = (short int)(y0 - s*v);
+		    points[3] = points[0];
+		    XFillPolygon(display, window, gc, points, 4, Nonconvex,
+				CoordModeOrigin);
+		}
+	    }
+	}
+}
+
+static void
+AddSymbolSegs(XSegment *segs, int *j, XPoint *points, int npoints)
+{
+	int i;
+
+	for(i = 1; i < npoints; i++, (*j)++) {
+	    segs[*j].x1 = points[i-1].x;
+	    segs[*j].y1 = points[i-1].y;
+	    segs[*j].x2 = points[i].x;
+	    segs[*j].y2 = points[i].y;
+	}
+}
+
+/* Return n new values for PixelDrawn. A value is not used again until the
+ * stamps are cleared.
+ */
+static int
+NewPixelStamps(MapPlotWidget w, int n)
+{
+	MapPlotPart	*mp = &w->map_plot;
+	int		size, *stamp;
+
+	size = (int)w->core.width*(int)w->core.height;
+	if(size > mp->size_pixel_stamp)
+	{
+	    if( !(stamp = (int *)AxesRealloc((Widget)w, mp->pixel_stamp,
+				size*sizeof(int))) ) return 0;
+	    mp->pixel_stamp = stamp;
+	    mp->size_pixel_stamp = size;
+	    memset(mp->pixel_stamp, 0, size*sizeof(int));
+	    mp->last_pixel_stamp = 0;
+	}
+	if(mp->last_pixel_stamp > INT_MAX - n - 1) {
+	    memset(mp->pixel_stamp, 0, mp->size_pixel_stamp*sizeof(int));
+	    mp->last_pixel_stamp = 0;
+	}
+	mp->last_pixel_stamp += n;
+	return mp->last_pixel_stamp - n + 1;
+}
+
+/* Return True if a symbol stamped k has been drawn at pixel x,y. Otherwise
+ * stamp the pixel with k.
+ */
+static Boolean
+PixelDrawn(MapPlotWidget w, int x, int y, int k)
+{
+	MapPlotPart	*mp = &w->map_plot;
+	int		*p;
+
+	if(k <= 0 || x < 0 || y < 0 || x >= (int)w->core.width
+		|| y >= (int)w->core.height) return False;
+
+	p = mp->pixel_stamp + y*(int)w->core.width + x;
+	if(*p == k) return True;
+	*p = k;
+	return False;
+}
+
+static void
+GetProjKey(MapPlotWidget w, MapProjKey *key)
+{
+	MapPlotPart	*mp = &w->map_plot;
+	AxesPart	*ax = &w->axes;
+
+	/* zero the padding too, so the keys can be compared with memcmp */
+	memset(key, 0, sizeof(MapProjKey));
+	key->projection = mp->projection;
+	key->x1 = ax->x1[ax->zoom];
+	key->x2 = ax->x2[ax->zoom];
+	key->y1 = ax->y1[ax->zoom];
+	key->y2 = ax->y2[ax->zoom];
+	key->x1_0 = ax->x1[0];
+	key->x2_0 = ax->x2[0];
+	key->mercator_max_lat = mp->mercator_max_lat;
+	memcpy(key->c, mp->c, sizeof(mp->c));
+	key->utm_cell_letter = mp->utm_cell_letter;
+	key->utm_cell_zone = mp->utm_cell_zone;
+	key->utm_center_lon = mp->utm_center_lon;
+	key->utm_center_lat = mp->utm_center_lat;
+	key->ix1 = ax->d.ix1;
+	key->iy1 = ax->d.iy1;
+	key->sx1 = ax->d.sx1;
+	key->sy1 = ax->d.sy1;
+	key->unscalex = ax->d.unscalex;
+	key->unscaley = ax->d.unscaley;
+}
+
+/* Start an update of the cache for n symbols. Returns True if all of the
+ * symbols must be projected again.
+ */
+static Boolean
+SymbolCacheBegin(MapPlotWidget w, SymbolCache *c, int n)
+{
+	MapProjKey	key;
+	Boolean		all;
+
+	GetProjKey(w, &key);
+	all = (!c->valid || memcmp(&key, &c->key, sizeof(MapProjKey)));
+	c->key = key;
+	c->changed = (all || n != c->n);
+
+	if(n > c->size)
+	{
+	    if( !(c->lon = (double *)AxesRealloc((Widget)w, c->lon,
+				n*sizeof(double)))
+		|| !(c->lat = (double *)AxesRealloc((Widget)w, c->lat,
+				n*sizeof(double)))
+		|| !(c->x = (int *)AxesRealloc((Widget)w, c->x, n*sizeof(int)))
+		|| !(c->y = (int *)AxesRealloc((Widget)w, c->y, n*sizeof(int)))
+		|| !(c->in = (char *)AxesRealloc((Widget)w, c->in, n))
+		|| !(c->sym = (int *)AxesRealloc((Widget)w, c->sym,
+				n*sizeof(int))) )
+	    {
+		/* leave the cache empty */
+		FreeSymbolCache(c);
+		return True;
+	    }
+	    c->size = n;
+	}
+	return all;
+}
+
+static void
+SymbolCacheSet(MapPlotWidget w, SymbolCache *c, Boolean all, int i,
+		double lon, double lat)
+{
+	AxesPart	*ax = &w->axes;
+	double		x, y, z;
+
+	if(i >= c->size) return;
+	if(!all && i < c->n && lon == c->lon[i] && lat == c->lat[i]) return;
+
+	c->lon[i] = lon;
+	c->lat[i] = lat;
+	project(w, lon, lat, &x, &y, &z);
+	if( (c->in[i] = (z > 0.)) ) {
+	    c->x[i] = unscale_x(&ax->d, x);
+	    c->y[i] = unscale_y(&ax->d, y);
+	}
+	c->changed = True;
+}
+
+/* Finish the update and bucket the symbols into the cells.
+ */
+static void
+SymbolCacheEnd(MapPlotWidget w, SymbolCache *c, int n)
+{
+	int	i, k, nx, ny, ncells, cx, cy;
+
+	if(n > c->size) n = c->size;
+	c->n = n;
+	c->valid = (c->size > 0 || n == 0);
+	if(!c->changed && c->width == (int)w->core.width
+		&& c->height == (int)w->core.height) return;
+
+	c->width = (int)w->core.width;
+	c->height = (int)w->core.height;
+	nx = c->width/MAP_SYMBOL_CELL + 1;
+	ny = c->height/MAP_SYMBOL_CELL + 1;
+	ncells = nx*ny;
+	if(ncells + 1 > c->size_cells) {
+	    int *cell = (int *)AxesRealloc((Widget)w, c->cell,
+				(ncells+1)*sizeof(int));
+	    if(!cell) {
+		c->valid = False;
+		return;
+	    }
+	    c->cell = cell;
+	    c->size_cells = ncells + 1;
+	}
+	c->nx = nx;
+	c->ny = ny;
+
+	/* counting sort of the symbols in front by cell. A symbol outside
+	 * the widget goes in the nearest cell on the border.
+	 */
+	memset(c->cell, 0, (ncells+1)*sizeof(int));
+	for(i = 0; i < n; i++) if(c->in[i]) {
+	    SymbolCell(c, c->x[i], c->y[i], &cx, &cy);
+	    c->cell[cy*nx + cx + 1]++;
+	}
+	for(k = 0; k < ncells; k++) c->cell[k+1] += c->cell[k];
+	for(i = 0; i < n; i++) if(c->in[i]) {
+	    SymbolCell(c, c->x[i], c->y[i], &cx, &cy);
+	    c->sym[c->cell[cy*nx + cx]++] = i;
+	}
+	for(k = ncells; k > 0; k--) c->cell[k] = c->cell[k-1];
+	c->cell[0] = 0;
+	c->changed = False;
+}
+
+static void
+SymbolCell(SymbolCache *c, int x, int y, int *cx, int *cy)
+{
+	*cx = (x < 0) ? 0 : x/MAP_SYMBOL_CELL;
+	*cy = (y < 0) ? 0 : y/MAP_SYMBOL_CELL;
+	if(*cx >= c->nx) *cx = c->nx - 1;
+	if(*cy >= c->ny) *cy = c->ny - 1;
+}
+
+static void
+FreeSymbolCache(SymbolCache *c)
+{
+	Free(c->lon);
+	Free(c->lat);
+	Free(c->x);
+	Free(c->y);
+	Free(c->in);
+	Free(c->cell);
+	Free(c->sym);
+	memset(c, 0, sizeof(SymbolCache));
+}
+
+static void
+UpdateStaSrcCache(MapPlotWidget w, Boolean station)
+{
+	MapPlotPart	*mp = &w->map_plot;
+	int		i;
+	Boolean		all;
+
+	if(station) {
+	    all = SymbolCacheBegin(w, &mp->sta_cache, mp->nsta);
+	    for(i = 0; i < mp->nsta; i++) {
+		SymbolCacheSet(w, &mp->sta_cache, all, i,
+			mp->sta[i]->station.lon, mp->sta[i]->station.lat);
+	    }
+	    SymbolCacheEnd(w, &mp->sta_cache, mp->nsta);
+	}
+	else {
+	    all = SymbolCacheBegin(w, &mp->src_cache, mp->nsrc);
+	    for(i = 0; i < mp->nsrc; i++) {
+		SymbolCacheSet(w, &mp->src_cache, all, i,
+			mp->src[i]->source.lon, mp->src[i]->source.lat);
+	    }
+	    SymbolCacheEnd(w, &mp->src_cache, mp->nsrc);
+	}
+}
+
+static void
+UpdateMapSymbolCache(MapPlotWidget w)
+{
+	MapPlotPart	*mp = &w->map_plot;
+	int		i;
+	Boolean		all;
+
+	all = SymbolCacheBegin(w, &mp->symbol_cache, mp->nsymbol);
+	for(i = 0; i < mp->nsymbol; i++) {
+	    SymbolCacheSet(w, &mp->symbol_cache, all, i, mp->symbol[i].lon,
+			mp->symbol[i].lat);
+	}
+	SymbolCacheEnd(w, &mp->symbol_cache, mp->nsymbol);
+}
+
+/* The hit-test filters. With selected_on, a symbol displayed only when
+ * selected also counts.
+ */
+static Boolean
+StationOn(MapPlotWidget w, int i, Boolean selected_on)
+{
+	SymbolInfo *sym = &w->map_plot.sta[i]->station.sym;
+	return ((sym->display >= MAP_ON || (selected_on &&
+		sym->display == MAP_SELECTED_ON && sym->selected))
+		&& w->map_plot.sta[i]->visible) ? True : False;
+}
+
+static Boolean
+SourceOn(MapPlotWidget w, int i, Boolean selected_on)
+{
+	SymbolInfo *sym = &w->map_plot.src[i]->source.sym;
+	return ((sym->display >= MAP_ON || (selected_on &&
+		sym->display == MAP_SELECTED_ON && sym->selected))
+		&& w->map_plot.src[i]->visible) ? True : False;
+}
+
+static Boolean
+MapSymbolOn(MapPlotWidget w, int i, Boolean selected_on)
+{
+	SymbolInfo *sym = &w->map_plot.symbol[i].sym;
+	return (sym->display == MAP_ON || sym->display == MAP_LOCKED_ON ||
+		(selected_on && sym->display == MAP_SELECTED_ON &&
+		sym->selected)) ? True : False;
+}
+
+/* Find the symbol nearest the cursor with squared pixel distance less than
+ * dlim, searching only the cells within that distance. Ties go to the
+ * lowest index, as in a search of all of the symbols in order. Returns the
+ * index and the squared distance in *dmin, or -1.
+ */
+static int
+SymbolCacheNearest(MapPlotWidget w, SymbolCache *c, int cursor_x,
+		int cursor_y, double dlim, Boolean (*on)(MapPlotWidget, int,
+		Boolean), Boolean selected_on, double *dmin)
+{
+	int	i, k, cx, cy, cx1, cy1, cx2, cy2, which = -1;
+	double	d, r;
+
+	if(!c->valid || c->n <= 0 || dlim <= 0.) return -1;
+
+	r = sqrt(dlim) + 1.;
+	if(r > 4.*(c->width + c->height)) r = 4.*(c->width + c->height);
+	SymbolCell(c, (int)(cursor_x - r), (int)(cursor_y - r), &cx1, &cy1);
+	SymbolCell(c, (int)(cursor_x + r), (int)(cursor_y + r), &cx2, &cy2);
+
+	*dmin = dlim;
+	for(cy = cy1; cy <= cy2; cy++)
+	    for(cx = cx1; cx <= cx2; cx++)
+	{
+	    k = cy*c->nx + cx;
+	    for(i = c->cell[k]; i < c->cell[k+1]; i++)
+	    {
+		int j = c->sym[i];
+		d = (double)(c->x[j] - cursor_x)*(c->x[j] - cursor_x) +
+			(double)(c->y[j] - cursor_y)*(c->y[j] - cursor_y);
+		if((d < *dmin || (d == *dmin && which >= 0 && j < which))
+			&& (*on)(w, j, selected_on))
+		{
+		    *dmin = d;
+		    which = j;
+		}
+	    }
+	}
+	return which;
+}
+
 static void
 RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 {
 	MapPlotPart	*mp = &w->map_plot;
 	AxesPart	*ax = &w->axes;
-	int		i, n, x0, y0, siz, h, v;
+	int		i, n, x0, y0, siz, h, v, stamp, maxsize;
 	double		x, y, z;
 	GC		gc;
 	XArc		*arcs = NULL;
 	XSegment	*segs = NULL;
+	XRectangle	*rects = NULL;
 	XPoint		points[10];
 	SymbolInfo	*sym;
 
@@ -2738,6 +3314,14 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 
 	XSetClipRectangles(XtDisplay(w), gc, 0,0, &ax->clip_rect, 1, Unsorted);
 
+	/* A symbol is not drawn if one of the same size has been drawn at its
+	 * pixel. Each size has its own stamp.
+	 */
+	for(i = maxsize = 0; i < s->group.npts; i++) {
+	    if(maxsize < s->group.size[i]) maxsize = s->group.size[i];
+	}
+	stamp = NewPixelStamps(w, maxsize+1);
+
 	if(sym->type == CIRCLE || sym->type == FILLED_CIRCLE)
 	{
 	    arcs = (XArc *)AxesMalloc((Widget)w, s->group.npts*sizeof(XArc));
@@ -2750,6 +3334,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    arcs[n].x = x0 - siz/2;
 		    arcs[n].y = y0 - siz/2;
 		    arcs[n].width = siz;
@@ -2783,6 +3368,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    segs[n].x1 = x0 - siz;
 		    segs[n].y1 = y0 - siz;
 		    segs[n].x2 = x0 + siz;
@@ -2813,7 +3399,10 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 	}
 	else if(sym->type == FILLED_SQUARE)
 	{
-	    for(i = 0; i < s->group.npts; i++)
+	    rects = (XRectangle *)AxesMalloc((Widget)w,
+				s->group.npts*sizeof(XRectangle));
+
+	    for(i = n = 0; i < s->group.npts; i++)
 	    {
 		project(w, s->group.lon[i], s->group.lat[i], &x, &y, &z);
 		if(z > 0.)
@@ -2821,21 +3410,19 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
-
-		    points[0].x = x0 - siz;
-		    points[0].y = y0 - siz;
-		    points[1].x = x0 + siz;
-		    points[1].y = y0 - siz;
-		    points[2].x = x0 + siz;
-		    points[2].y = y0 + siz;
-		    points[3].x = x0 - siz;
-		    points[3].y = y0 + siz;
-		    points[4].x = x0 - siz;
-		    points[4].y = y0 - siz;
-		    XFillPolygon(XtDisplay(w), window, gc, points, 5,
-					Nonconvex, CoordModeOrigin);
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
+		    rects[n].x = x0 - siz;
+		    rects[n].y = y0 - siz;
+		    rects[n].width = 2*siz;
+		    rects[n].height = 2*siz;
+		    n++;
 		}
 	    }
+	    if(n > 0)
+	    {
+		XFillRectangles(XtDisplay(w), window, gc, rects, n);
+	    }
+	    Free(rects);
 	}
 	else if(sym->type == TRIANGLE)
 	{
@@ -2850,6 +3437,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		    v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 		    segs[n].x1 = x0 - siz;
@@ -2885,6 +3473,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		    v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 
@@ -2914,6 +3503,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		    v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 		    segs[n].x1 = x0 + siz;
@@ -2949,6 +3539,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		    v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 
@@ -2978,6 +3569,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    segs[n].x1 = x0;
 		    segs[n].y1 = y0 - siz;
 		    segs[n].x2 = x0 - siz;
@@ -3016,6 +3608,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 
 		    points[0].x = x0;
 		    points[0].y = y0 - siz;
@@ -3048,6 +3641,7 @@ RedisplaySymbolGroup(MapPlotWidget w, Window window, MapSymbolGroup *s)
 		    x0 = unscale_x(&ax->d, x);
 		    y0 = unscale_y(&ax->d, y);
 		    siz = s->group.size[i];
+		    if(siz >= 0 && PixelDrawn(w, x0, y0, stamp+siz)) continue;
 		    segs[n].x1 = x0 - siz;
 		    segs[n].y1 = y0;
 		    segs[n].x2 = x0 + siz;
@@ -3075,8 +3669,9 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 {
 	MapPlotPart	*mp = &w->map_plot;
 	AxesPart	*ax = &w->axes;
-	int		x0, y0, siz, h, v;
+	int		i, x0 = 0, y0 = 0, siz, h, v;
 	double		x, y, z;
+	Boolean		in;
 	GC		gc;
 	XArc		arc;
 	XSegment	segs[4];
@@ -3100,13 +3695,25 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 
 	XSetClipRectangles(XtDisplay(w), gc, 0,0, &ax->clip_rect, 1, Unsorted);
 
-	if(sym->type == CIRCLE || sym->type == FILLED_CIRCLE)
-	{
+	/* use the cached position if the symbol is in mp->symbol */
+	i = (int)(s - mp->symbol);
+	if(i >= 0 && i < mp->symbol_cache.n) {
+	    in = (Boolean)mp->symbol_cache.in[i];
+	    x0 = mp->symbol_cache.x[i];
+	    y0 = mp->symbol_cache.y[i];
+	}
+	else {
 	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
-	    {
+	    if( (in = (z > 0.)) ) {
 		x0 = unscale_x(&ax->d, x);
 		y0 = unscale_y(&ax->d, y);
+	    }
+	}
+
+	if(sym->type == CIRCLE || sym->type == FILLED_CIRCLE)
+	{
+	    if(in)
+	    {
 		arc.x = x0 - siz/2;
 		arc.y = y0 - siz/2;
 		arc.width = siz;
@@ -3123,11 +3730,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == SQUARE)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		segs[0].x1 = x0 - siz;
 		segs[0].y1 = y0 - siz;
 		segs[0].x2 = x0 + siz;
@@ -3153,11 +3757,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == FILLED_SQUARE)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 
 		points[0].x = x0 - siz;
 		points[0].y = y0 - siz;
@@ -3175,11 +3776,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == TRIANGLE)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 		segs[0].x1 = x0 - siz;
@@ -3202,11 +3800,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == FILLED_TRIANGLE)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 
@@ -3224,11 +3819,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == INV_TRIANGLE)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 		segs[0].x1 = x0 + siz;
@@ -3250,11 +3842,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == FILLED_INV_TRIANGLE)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		h = (int)(.57735*siz + .5);	/* tan(30)*siz */
 		v = (int)(sqrt((double)(h*h + siz*siz)) + .5);
 
@@ -3272,11 +3861,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == DIAMOND)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		segs[0].x1 = x0;
 		segs[0].y1 = y0 - siz;
 		segs[0].x2 = x0 - siz;
@@ -3301,11 +3887,8 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == FILLED_DIAMOND)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 
 		points[0].x = x0;
 		points[0].y = y0 - siz;
@@ -3323,13 +3906,10 @@ RedisplayMapSymbol(MapPlotWidget w, Window window, MapPlotSymbol *s)
 	}
 	else if(sym->type == PLUS)
 	{
-	    project(w, s->lon, s->lat, &x, &y, &z);
-	    if(z > 0.)
+	    if(in)
 	    {
 		XSetLineAttributes(XtDisplay(w), gc, 2, LineSolid,
 					CapNotLast, JoinMiter);
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
 		segs[0].x1 = x0 - siz;
 		segs[0].y1 = y0;
 		segs[0].x2 = x0 + siz;
@@ -4708,6 +5288,7 @@ MapPlotClear(MapPlotWidget w)
 
 	for(i = 0; i < mp->nthemes; i++) {
 	    int j;
+	    FreeThemeIndex(mp->theme[i]);
 	    for(j = 0; j < mp->theme[i]->theme.nshapes; j++) {
 		ThemeDisplay *td = &mp->theme[i]->td[j];
 		MapImage *mi = &mp->theme[i]->map_image;
@@ -4808,6 +5389,11 @@ Destroy(Widget widget)
 	}
 	if(mp->colorGC != NULL) XFreeGC(XtDisplay(w), mp->colorGC);
 	if(mp->barGC != NULL) XFreeGC(XtDisplay(w), mp->barGC);
+
+	FreeSymbolCache(&mp->sta_cache);
+	FreeSymbolCache(&mp->src_cache);
+	FreeSymbolCache(&mp->symbol_cache);
+	Free(mp->pixel_stamp);
 }
 
 /** 
@@ -5778,84 +6364,427 @@ DrawShapeTheme(MapPlotWidget w, DrawStruct *d, MapTheme *t)
 	    td->p.npoints = 0;
 	}
 
-	if(mp->projection != MAP_POLAR)
-	{
-	    unproject(w, xmin, ymin, &x1, &y1);
-	    unproject(w, xmax, ymax, &x2, &y2);
+	if(mp->projection != MAP_POLAR)
+	{
+	    unproject(w, xmin, ymin, &x1, &y1);
+	    unproject(w, xmax, ymax, &x2, &y2);
+
+	    t->delta_on = False;
+	    if(t->theme.lat_min > y2 || t->theme.lat_max < y1) return;
+	    if(t->theme.lon_min > x2 && t->theme.lon_max-180. < x1) return;
+	    if(t->theme.lon_max < x1 && t->theme.lon_min+180. > x2) return;
+
+	    xdif = fabs(x2 - x1);
+	    if(xdif > t->theme.on_delta || xdif < t->theme.off_delta) return;
+	    t->delta_on = True;
+	}
+
+	if(t->theme.shape_type == SHPT_POLYGON) {
+	    if(mp->projection == MAP_LINEAR_CYLINDRICAL
+		|| mp->projection == MAP_UTM
+		|| mp->projection == MAP_POLAR)
+	    {
+		DrawThemeLCFill(w, d, t, -1);	/* draw all shapes */
+	    }
+	    else if(mp->projection == MAP_CYLINDRICAL_EQUAL_AREA ||
+			mp->projection == MAP_MERCATOR ||
+			mp->projection == MAP_UTM_NEAR)
+	    {
+		DrawThemeMercatorFill(w, d, t, -1);
+	    }
+	    else {
+		DrawThemeOrthoFill(w, d, t, -1);
+	    }
+	}
+	else if(t->theme.shape_type == SHPT_ARC) {
+	    DrawThemePts(w, d, t, -1);
+	}
+	if(mp->projection != MAP_POLAR && t->theme.polar_coords) {
+	    DrawThemeGrid(w, d, t);
+	}
+}
+
+static void
+DrawThemeShape(MapPlotWidget w, DrawStruct *d, MapTheme *t, int i)
+{
+	MapPlotPart *mp = &w->map_plot;
+	ThemeDisplay *td = &t->td[i];
+
+	Free(td->fill_segs.segs);
+	td->fill_segs.size_segs = 0;
+	td->fill_segs.nsegs = 0;
+	Free(td->bndy_segs.segs);
+	td->bndy_segs.size_segs = 0;
+	td->bndy_segs.nsegs = 0;
+	Free(td->p.points);
+	td->p.size_points = 0;
+	td->p.npoints = 0;
+
+	if(!t->display) return;
+
+	if(t->theme.shape_type == SHPT_POLYGON)
+	{
+	    if(mp->projection == MAP_LINEAR_CYLINDRICAL
+		|| mp->projection == MAP_UTM
+		|| mp->projection == MAP_POLAR)
+	    {
+		DrawThemeLCFill(w, d, t, i);
+	    }
+	    else if(mp->projection == MAP_CYLINDRICAL_EQUAL_AREA ||
+		mp->projection == MAP_MERCATOR)
+	    {
+		DrawThemeMercatorFill(w, d, t, i);
+	    }
+	    else {
+		DrawThemeOrthoFill(w, d, t, i);
+	    }
+	}
+	else if(t->theme.shape_type == SHPT_ARC) {
+	    DrawThemePts(w, d, t, i);
+	}
+}
+
+/* Douglas-Peucker tolerances (degrees) of the simplified copies of the theme
+ * shapes. Each level is simplified from the previous level.
+ */
+static double theme_level_tol[MAX_THEME_LEVELS] = {.005, .02, .08, .32, 1.28};
+
+/* Build the quadtree of the shape bounds and the simplified copies of the
+ * shapes that DrawShapeTheme uses to cull and thin the shapes of a theme.
+ */
+static void
+IndexTheme(MapTheme *t)
+{
+	int i, l, n, depth, nodes, id, nverts, nprev;
+	bool failed;
+	double bmin[4], bmax[4];
+	SHPObject *s, **prev, **lev;
+
+	if(t->theme.polar_coords || t->theme.nshapes <= 0) return;
+	if(t->theme.shape_type != SHPT_POLYGON
+		&& t->theme.shape_type != SHPT_ARC) return;
+
+	n = t->theme.nshapes;
+	for(i = 0; i < 4; i++) {
+	    bmin[i] = 0.;
+	    bmax[i] = 0.;
+	}
+	bmin[0] = bmin[1] = 1.e+30;
+	bmax[0] = bmax[1] = -1.e+30;
+	nverts = 0;
+	for(i = 0; i < n; i++) {
+	    s = t->theme.shapes[i];
+	    if(s->nVertices <= 0) continue;
+	    if(bmin[0] > s->dfXMin) bmin[0] = s->dfXMin;
+	    if(bmax[0] < s->dfXMax) bmax[0] = s->dfXMax;
+	    if(bmin[1] > s->dfYMin) bmin[1] = s->dfYMin;
+	    if(bmax[1] < s->dfYMax) bmax[1] = s->dfYMax;
+	    nverts += s->nVertices;
+	}
+	if(nverts == 0) return;
+
+	/* about eight shapes per node, as SHPCreateTree picks for a file */
+	for(depth = 0, nodes = 1; nodes*4 < n; depth++) nodes *= 2;
+
+	if( !(t->tree = SHPCreateTree(NULL, 2, depth, bmin, bmax)) ) return;
+
+	/* the tree stores nShapeId, which need not be the index in theme
+	 */
+	for(i = 0; i < n; i++) {
+	    s = t->theme.shapes[i];
+	    id = s->nShapeId;
+	    s->nShapeId = i;
+	    SHPTreeAddShapeId(t->tree, s);
+	    s->nShapeId = id;
+	}
+	SHPTreeTrimExtraNodes(t->tree);
+
+	/* Keep a level only if it drops at least a quarter of the vertices
+	 * of the level before it.
+	 */
+	prev = t->theme.shapes;
+	nprev = nverts;
+	for(l = 0; l < MAX_THEME_LEVELS; l++)
+	{
+	    if( !(lev = (SHPObject **)malloc(n*sizeof(SHPObject *))) ) return;
+	    for(i = 0, nverts = 0; i < n; i++) {
+		if( !(lev[i] = SimplifyShape(prev[i], theme_level_tol[l])) ) break;
+		nverts += lev[i]->nVertices;
+	    }
+	    /* stop at a shape that cannot be simplified, but only skip a
+	     * level that does not drop enough vertices
+	     */
+	    failed = (i < n);
+	    if(failed || 4*nverts > 3*nprev) {
+		while(--i >= 0) SHPDestroyObject(lev[i]);
+		free(lev);
+		if(failed) return;
+		continue;
+	    }
+	    t->level[t->nlevels] = lev;
+	    t->level_tol[t->nlevels] = theme_level_tol[l];
+	    t->nlevels++;
+	    prev = lev;
+	    nprev = nverts;
+	}
+}
+
+static void
+FreeThemeIndex(MapTheme *t)
+{
+	int i, l;
+
+	if(t->tree) SHPDestroyTree(t->tree);
+	t->tree = NULL;
+
+	for(l = 0; l < t->nlevels; l++) {
+	    for(i = 0; i < t->theme.nshapes; i++) {
+		SHPDestroyObject(t->level[l][i]);
+	    }
+	    Free(t->level[l]);
+	}
+	t->nlevels = 0;
+}
+
+/* Return a copy of s with the vertices of each part thinned by the
+ * Douglas-Peucker algorithm. Polygon rings that collapse to fewer than four
+ * vertices are dropped.
+ */
+static SHPObject *
+SimplifyShape(SHPObject *s, double tol)
+{
+	int j, k, i0, npts, nparts, n, *start = NULL, *stack = NULL;
+	char *keep = NULL;
+	double *x = NULL, *y = NULL;
+	Boolean closed;
+	SHPObject *o = NULL;
+
+	if(s->nVertices <= 0 || s->nParts <= 0) {
+	    return SHPCreateObject(s->nSHPType, s->nShapeId, 0, NULL, NULL,
+				0, NULL, NULL, NULL, NULL);
+	}
+	if( !(start = (int *)malloc(s->nParts*sizeof(int)))
+	    || !(stack = (int *)malloc(2*s->nVertices*sizeof(int)))
+	    || !(keep = (char *)malloc(s->nVertices))
+	    || !(x = (double *)malloc(s->nVertices*sizeof(double)))
+	    || !(y = (double *)malloc(s->nVertices*sizeof(double))) )
+	{
+	    Free(start); Free(stack); Free(keep); Free(x); Free(y);
+	    return NULL;
+	}
+
+	for(j = n = nparts = 0; j < s->nParts; j++)
+	{
+	    i0 = s->panPartStart[j];
+	    npts = (j < s->nParts-1) ? s->panPartStart[j+1] - i0
+				: s->nVertices - i0;
+	    if(npts <= 0) continue;
+
+	    closed = (s->nSHPType == SHPT_POLYGON);
+	    k = SimplifyPart(s->padfX+i0, s->padfY+i0, npts, tol, closed, keep,
+			stack);
+	    if(closed && k < 4) continue;
+
+	    start[nparts++] = n;
+	    for(k = 0; k < npts; k++) if(keep[k]) {
+		x[n] = s->padfX[i0+k];
+		y[n] = s->padfY[i0+k];
+		n++;
+	    }
+	}
+	o = SHPCreateObject(s->nSHPType, s->nShapeId, nparts, start, NULL,
+				n, x, y, NULL, NULL);
+	Free(start); Free(stack); Free(keep); Free(x); Free(y);
+	return o;
+}
+
+/* Mark in keep[] the vertices of one part that the Douglas-Peucker
+ * algorithm keeps within tol and return how many there are. A closed ring
+ * is split at its vertex farthest from the first one. stack needs room for
+ * 2*n ints.
+ */
+static int
+SimplifyPart(double *x, double *y, int n, double tol, Boolean closed,
+		char *keep, int *stack)
+{
+	int i, a, b, imax, nstack, nkeep;
+	double dx, dy, d, dmax, len, tol2 = tol*tol;
 
-	    t->delta_on = False;
-	    if(t->theme.lat_min > y2 || t->theme.lat_max < y1) return;
-	    if(t->theme.lon_min > x2 && t->theme.lon_max-180. < x1) return;
-	    if(t->theme.lon_max < x1 && t->theme.lon_min+180. > x2) return;
+	for(i = 0; i < n; i++) keep[i] = (i == 0 || i == n-1);
+	if(n <= 2) return n;
 
-	    xdif = fabs(x2 - x1);
-	    if(xdif > t->theme.on_delta || xdif < t->theme.off_delta) return;
-	    t->delta_on = True;
+	nstack = 0;
+	if(closed && x[0] == x[n-1] && y[0] == y[n-1])
+	{
+	    for(i = 1, imax = 1, dmax = -1.; i < n-1; i++) {
+		dx = x[i] - x[0];
+		dy = y[i] - y[0];
+		d = dx*dx + dy*dy;
+		if(d > dmax) { dmax = d; imax = i; }
+	    }
+	    keep[imax] = 1;
+	    stack[nstack++] = 0;
+	    stack[nstack++] = imax;
+	    stack[nstack++] = imax;
+	    stack[nstack++] = n-1;
+	}
+	else {
+	    stack[nstack++] = 0;
+	    stack[nstack++] = n-1;
 	}
 
-	if(t->theme.shape_type == SHPT_POLYGON) {
-	    if(mp->projection == MAP_LINEAR_CYLINDRICAL
-		|| mp->projection == MAP_UTM
-		|| mp->projection == MAP_POLAR)
-	    {
-		DrawThemeLCFill(w, d, t, -1);	/* draw all shapes */
-	    }
-	    else if(mp->projection == MAP_CYLINDRICAL_EQUAL_AREA ||
-			mp->projection == MAP_MERCATOR ||
-			mp->projection == MAP_UTM_NEAR)
+	while(nstack > 0)
+	{
+	    b = stack[--nstack];
+	    a = stack[--nstack];
+	    if(b - a < 2) continue;
+
+	    /* squared distance from the segment a-b */
+	    dx = x[b] - x[a];
+	    dy = y[b] - y[a];
+	    len = dx*dx + dy*dy;
+	    for(i = a+1, imax = -1, dmax = tol2; i < b; i++)
 	    {
-		DrawThemeMercatorFill(w, d, t, -1);
+		double u, px = x[i] - x[a], py = y[i] - y[a];
+		u = (len > 0.) ? (px*dx + py*dy)/len : 0.;
+		if(u < 0.) u = 0.;
+		else if(u > 1.) u = 1.;
+		px -= u*dx;
+		py -= u*dy;
+		d = px*px + py*py;
+		if(d > dmax) { dmax = d; imax = i; }
 	    }
-	    else {
-		DrawThemeOrthoFill(w, d, t, -1);
+	    if(imax >= 0) {
+		keep[imax] = 1;
+		stack[nstack++] = a;
+		stack[nstack++] = imax;
+		stack[nstack++] = imax;
+		stack[nstack++] = b;
 	    }
 	}
-	else if(t->theme.shape_type == SHPT_ARC) {
-	    DrawThemePts(w, d, t, -1);
+	for(i = nkeep = 0; i < n; i++) if(keep[i]) nkeep++;
+	return nkeep;
+}
+
+/* Return the index of the coarsest simplified level of the theme whose
+ * tolerance is within half a pixel, or -1 for the full resolution shapes.
+ */
+static int
+ThemeLevel(MapPlotWidget w, DrawStruct *d, MapTheme *t)
+{
+	MapPlotPart *mp = &w->map_plot;
+	AxesPart *ax = &w->axes;
+	int i, l, ny;
+	double x, y, yp[4], lon1, lat1, lon2, lat2, pix, del, az, baz;
+
+	if(t->nlevels == 0 || d->scalex == 0. || d->scaley == 0.) return -1;
+
+	x = .5*(ax->x1[ax->zoom] + ax->x2[ax->zoom]);
+	y = .5*(ax->y1[ax->zoom] + ax->y2[ax->zoom]);
+
+	if(mp->projection == MAP_LINEAR_CYLINDRICAL
+		|| mp->projection == MAP_UTM
+		|| mp->projection == MAP_CYLINDRICAL_EQUAL_AREA
+		|| mp->projection == MAP_MERCATOR)
+	{
+	    /* Degrees per pixel in longitude, and in latitude where the
+	     * projection stretches it the most in the view.
+	     */
+	    pix = fabs(d->scalex);
+	    ny = 0;
+	    yp[ny++] = ax->y1[ax->zoom];
+	    yp[ny++] = ax->y2[ax->zoom];
+	    yp[ny++] = y;
+	    if(ax->y1[ax->zoom]*ax->y2[ax->zoom] < 0.) yp[ny++] = 0.;
+	    for(i = 0; i < ny; i++) {
+		unproject(w, x, yp[i], &lon1, &lat1);
+		unproject(w, x, yp[i] + (yp[i] < y ? 1 : -1)*fabs(d->scaley),
+				&lon2, &lat2);
+		del = fabs(lat2 - lat1);
+		if(del > 0. && del < pix) pix = del;
+	    }
 	}
-	if(mp->projection != MAP_POLAR && t->theme.polar_coords) {
-	    DrawThemeGrid(w, d, t);
+	else {
+	    unproject(w, x, y, &lon1, &lat1);
+	    unproject(w, x + fabs(d->scalex), y, &lon2, &lat2);
+	    deltaz(lat1, lon1, lat2, lon2, &pix, &az, &baz);
 	}
+	if( !(pix > 0.) ) return -1;
+
+	for(l = t->nlevels-1; l >= 0 && t->level_tol[l] > .5*pix; l--);
+	return l;
 }
 
-static void
-DrawThemeShape(MapPlotWidget w, DrawStruct *d, MapTheme *t, int i)
+/* Put in *ids the indices of the shapes of the theme that can be inside the
+ * view, in increasing order, and return how many there are. The quadtree is
+ * searched for the cylindrical projections, whose view is a longitude,
+ * latitude box. Otherwise all the shapes are returned.
+ */
+static int
+ThemeShapesInView(MapPlotWidget w, MapTheme *t, int ishape, int **ids)
 {
 	MapPlotPart *mp = &w->map_plot;
-	ThemeDisplay *td = &t->td[i];
+	AxesPart *ax = &w->axes;
+	int i, j, k, k1, k2, n, nfound, *found;
+	char *in;
+	double x1, x2, y1, y2, bmin[4], bmax[4];
 
-	Free(td->fill_segs.segs);
-	td->fill_segs.size_segs = 0;
-	td->fill_segs.nsegs = 0;
-	Free(td->bndy_segs.segs);
-	td->bndy_segs.size_segs = 0;
-	td->bndy_segs.nsegs = 0;
-	Free(td->p.points);
-	td->p.size_points = 0;
-	td->p.npoints = 0;
+	n = (ishape >= 0) ? 1 : t->theme.nshapes;
+	if( !(*ids = (int *)malloc((n > 0 ? n : 1)*sizeof(int))) ) return 0;
 
-	if(!t->display) return;
+	if(ishape >= 0) {
+	    (*ids)[0] = ishape;
+	    return 1;
+	}
+	if(!t->tree || (mp->projection != MAP_LINEAR_CYLINDRICAL
+		&& mp->projection != MAP_UTM
+		&& mp->projection != MAP_CYLINDRICAL_EQUAL_AREA
+		&& mp->projection != MAP_MERCATOR)
+		|| !(in = (char *)calloc(n, 1)))
+	{
+	    for(i = 0; i < n; i++) (*ids)[i] = i;
+	    return n;
+	}
 
-	if(t->theme.shape_type == SHPT_POLYGON)
+	unproject(w, ax->x1[ax->zoom], ax->y1[ax->zoom], &x1, &y1);
+	unproject(w, ax->x2[ax->zoom], ax->y2[ax->zoom], &x2, &y2);
+	if(x1 > x2) { double a = x1; x1 = x2; x2 = a; }
+	if(y1 > y2) { double a = y1; y1 = y2; y2 = a; }
+
+	for(i = 0; i < 4; i++) {
+	    bmin[i] = t->tree->psRoot->adfBoundsMin[i];
+	    bmax[i] = t->tree->psRoot->adfBoundsMax[i];
+	}
+	if(y1 == y1 && y2 == y2) { /* not NaN */
+	    bmin[1] = y1;
+	    bmax[1] = y2;
+	}
+
+	/* The map longitudes wrap, so search the box at each multiple of 360
+	 * degrees that overlaps the theme.
+	 */
+	if(x2 - x1 >= 360.) {
+	    k1 = k2 = 0;
+	}
+	else {
+	    k1 = (int)ceil((t->tree->psRoot->adfBoundsMin[0] - x2)/360.);
+	    k2 = (int)floor((t->tree->psRoot->adfBoundsMax[0] - x1)/360.);
+	}
+	for(k = k1; k <= k2; k++)
 	{
-	    if(mp->projection == MAP_LINEAR_CYLINDRICAL
-		|| mp->projection == MAP_UTM
-		|| mp->projection == MAP_POLAR)
-	    {
-		DrawThemeLCFill(w, d, t, i);
-	    }
-	    else if(mp->projection == MAP_CYLINDRICAL_EQUAL_AREA ||
-		mp->projection == MAP_MERCATOR)
-	    {
-		DrawThemeMercatorFill(w, d, t, i);
+	    if(x2 - x1 < 360.) {
+		bmin[0] = x1 + k*360.;
+		bmax[0] = x2 + k*360.;
 	    }
-	    else {
-		DrawThemeOrthoFill(w, d, t, i);
+	    found = SHPTreeFindLikelyShapes(t->tree, bmin, bmax, &nfound);
+	    for(i = 0; i < nfound; i++) {
+		if(found[i] >= 0 && found[i] < n) in[found[i]] = 1;
 	    }
+	    Free(found);
 	}
-	else if(t->theme.shape_type == SHPT_ARC) {
-	    DrawThemePts(w, d, t, i);
-	}
+	for(i = j = 0; i < n; i++) if(in[i]) (*ids)[j++] = i;
+	free(in);
+	return j;
 }
 
 static void
@@ -6256,7 +7185,7 @@ DrawThemeLCFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 {
 	MapPlotPart *mp = &w->map_plot;
 	AxesPart *ax = &w->axes;
-	int	i, j, l, i0, npts, nshapes, q0;
+	int	i, j, k, l, i0, npts, nshapes, lev, *ids = NULL;
 	int	i1, i2, ilat, q, numlat;
 	int	*sizes = NULL, *nlon = NULL;
 	Longitude **lon = NULL;
@@ -6299,18 +7228,13 @@ DrawThemeLCFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 
 	dlat = d->scaley;
 
-	if(ishape >= 0) {
-	    q0 = ishape;
-	    nshapes = ishape+1;
-	}
-	else {
-	    q0 = 0;
-	    nshapes = t->theme.nshapes;
-	}
+	nshapes = ThemeShapesInView(w, t, ishape, &ids);
+	lev = ThemeLevel(w, d, t);
 
-	for(q = q0; q < nshapes; q++) if(t->td[q].display)
+	for(k = 0; k < nshapes; k++) if(t->td[ids[k]].display)
 	{
-	    SHPObject *s = t->theme.shapes[q];
+	    q = ids[k];
+	    SHPObject *s = (lev >= 0) ? t->level[lev][q] : t->theme.shapes[q];
 	    ThemeDisplay *td = &t->td[q];
 
 	    if(s->nSHPType != SHPT_POLYGON) continue;
@@ -6435,6 +7359,7 @@ for(j = 1; j < nlon[l]; j++) {
 	    iflush(d);
 	}
 
+	Free(ids);
 	Free(nlon);
 	Free(sizes);
 	Free(lat);
@@ -6888,7 +7813,7 @@ DrawThemeMercatorFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 {
 	MapPlotPart *mp = &w->map_plot;
 	AxesPart *ax = &w->axes;
-	int	i, j, l, i0, npts, nshapes, q0;
+	int	i, j, k, l, i0, npts, nshapes, lev, *ids = NULL;
 	int	i1, i2, ilat, q, numlat;
 	int	*sizes = NULL, *nlon = NULL;
 	Longitude **lon = NULL;
@@ -6939,18 +7864,13 @@ DrawThemeMercatorFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	}
 	dlat = d->scaley;
 
-	if(ishape >= 0) {
-	    q0 = ishape;
-	    nshapes = ishape+1;
-	}
-	else {
-	    q0 = 0;
-	    nshapes = t->theme.nshapes;
-	}
+	nshapes = ThemeShapesInView(w, t, ishape, &ids);
+	lev = ThemeLevel(w, d, t);
 
-	for(q = q0; q < nshapes; q++) if(t->td[q].display)
+	for(k = 0; k < nshapes; k++) if(t->td[ids[k]].display)
 	{
-	    SHPObject *s = t->theme.shapes[q];
+	    q = ids[k];
+	    SHPObject *s = (lev >= 0) ? t->level[lev][q] : t->theme.shapes[q];
 	    ThemeDisplay *td = &t->td[q];
 
 	    if(s->nSHPType != SHPT_POLYGON) continue;
@@ -7062,6 +7982,7 @@ DrawThemeMercatorFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	    iflush(d);
 	}
 
+	Free(ids);
 	Free(nlon);
 	Free(sizes);
 	Free(lat);
@@ -7379,7 +8300,7 @@ DrawThemeOrthoFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 {
 	MapPlotPart *mp = &w->map_plot;
 	AxesPart *ax = &w->axes;
-	int	i, j, l, i0, npts, nshapes, q0;
+	int	i, j, k, l, i0, npts, nshapes, lev, *ids = NULL;
 	int	i1, i2, ilat, q, numlat;
 	int	*sizes = NULL, *nlon = NULL;
 	Longitude **lon = NULL;
@@ -7425,18 +8346,13 @@ DrawThemeOrthoFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	}
 	dlat = d->scaley;
 
-	if(ishape >= 0) {
-	    q0 = ishape;
-	    nshapes = ishape+1;
-	}
-	else {
-	    q0 = 0;
-	    nshapes = t->theme.nshapes;
-	}
+	nshapes = ThemeShapesInView(w, t, ishape, &ids);
+	lev = ThemeLevel(w, d, t);
 
-	for(q = q0; q < nshapes; q++) if(t->td[q].display)
+	for(k = 0; k < nshapes; k++) if(t->td[ids[k]].display)
 	{
-	    SHPObject *s = t->theme.shapes[q];
+	    q = ids[k];
+	    SHPObject *s = (lev >= 0) ? t->level[lev][q] : t->theme.shapes[q];
 	    ThemeDisplay *td = &t->td[q];
 
 	    if(s->nSHPType != SHPT_POLYGON) continue;
@@ -7545,6 +8461,7 @@ DrawThemeOrthoFill(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	    iflush(d);
 	}
 
+	Free(ids);
 	Free(nlon);
 	Free(sizes);
 	Free(lat);
@@ -7826,7 +8743,7 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 {
 	MapPlotPart *mp = &w->map_plot;
 	AxesPart *ax = &w->axes;
-	int q, q0, nshapes;
+	int j, k, q, i0, npts, nshapes, lev, *ids = NULL;
 	double xmin, xmax, ymin, ymax;
 
 	if(!XtIsRealized((Widget)w) ||
@@ -7837,14 +8754,8 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	ymin = ax->y1[ax->zoom];
 	ymax = ax->y2[ax->zoom];
 
-	if(ishape >= 0) {
-	    q0 = ishape;
-	    nshapes = ishape+1;
-	}
-	else {
-	    q0 = 0;
-	    nshapes = t->theme.nshapes;
-	}
+	nshapes = ThemeShapesInView(w, t, ishape, &ids);
+	lev = ThemeLevel(w, d, t);
 
 	if(mp->projection == MAP_LINEAR_CYLINDRICAL ||
 		mp->projection == MAP_UTM ||
@@ -7856,9 +8767,10 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	    unproject(w, xmin, ymin, &x, &y1);
 	    unproject(w, xmin, ymax, &x, &y2);
 
-	    for(q = q0; q < nshapes; q++) if(t->td[q].display)
+	    for(k = 0; k < nshapes; k++) if(t->td[ids[k]].display)
 	    {
-		SHPObject *s = t->theme.shapes[q];
+		q = ids[k];
+		SHPObject *s = (lev >= 0) ? t->level[lev][q] : t->theme.shapes[q];
 		ThemeDisplay *td = &t->td[q];
 
 		if(!t->theme.polar_coords) {
@@ -7868,7 +8780,16 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 		}
 
 		d->s = &td->bndy_segs;
-		if(!t->theme.polar_coords) {
+		if(!t->theme.polar_coords && td->npts == 0) {
+		    /* a polyline, not a great circle arc */
+		    for(j = 0; j < s->nParts; j++) {
+			i0 = s->panPartStart[j];
+			npts = (j < s->nParts-1) ? s->panPartStart[j+1] - i0
+					: s->nVertices - i0;
+			DrawLonLat(w, d, npts, s->padfX+i0, s->padfY+i0);
+		    }
+		}
+		else if(!t->theme.polar_coords) {
 		    DrawLonLat(w, d, td->npts, td->lon, td->lat);
 		}
 		else {
@@ -7880,9 +8801,10 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	{
 	    double x1, y1, z1, x2, y2, z2, x3, y3, z3, x4, y4, z4;
 
-	    for(q = q0; q < nshapes; q++) if(t->td[q].display)
+	    for(k = 0; k < nshapes; k++) if(t->td[ids[k]].display)
 	    {
-		SHPObject *s = t->theme.shapes[q];
+		q = ids[k];
+		SHPObject *s = (lev >= 0) ? t->level[lev][q] : t->theme.shapes[q];
 		ThemeDisplay *td = &t->td[q];
 
 		if(!t->theme.polar_coords) {
@@ -7895,7 +8817,16 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 
 		d->s = &td->bndy_segs;
 
-		if(!t->theme.polar_coords) {
+		if(!t->theme.polar_coords && td->npts == 0) {
+		    /* a polyline, not a great circle arc */
+		    for(j = 0; j < s->nParts; j++) {
+			i0 = s->panPartStart[j];
+			npts = (j < s->nParts-1) ? s->panPartStart[j+1] - i0
+					: s->nVertices - i0;
+			DrawLonLat(w, d, npts, s->padfX+i0, s->padfY+i0);
+		    }
+		}
+		else if(!t->theme.polar_coords) {
 		    DrawLonLat(w, d, td->npts, td->lon, td->lat);
 		}
 		else {
@@ -7904,6 +8835,7 @@ DrawThemePts(MapPlotWidget w, DrawStruct *d, MapTheme *t, int ishape)
 	    }
 	}
 	iflush(d);
+	Free(ids);
 }
 
 static void
@@ -10747,80 +11679,40 @@ static int
 WhichStaSrc(MapPlotWidget w, int cursor_x, int cursor_y, Boolean *station)
 {
 	MapPlotPart	*mp = &w->map_plot;
-	AxesPart	*ax = &w->axes;
-	int		i, which, x0, y0;
-	double		x, y, z;
-	float		d, dmin;
+	int		i, which;
+	double		d, dmin;
+	float		dc;
 
 	/* initialize dmin to a large value before seeking the minimim.
 	*/
 	dmin = 2*((int)w->core.width*(int)w->core.width +
 		  (int)w->core.height*(int)w->core.height);
-	which = -1;
 
-	if(_AxesWhichCursor((AxesWidget)w, cursor_x, cursor_y, &d, &i) >= 0)
+	if(_AxesWhichCursor((AxesWidget)w, cursor_x, cursor_y, &dc, &i) >= 0)
 	{
-		dmin = d*d;
+		dmin = dc*dc;
 	}
+	UpdateStaSrcCache(w, True);
+	UpdateStaSrcCache(w, False);
 
-	for(i = 0; i < mp->nsta; i++)
-	    if( (mp->sta[i]->station.sym.display >= MAP_ON ||
-		(mp->sta[i]->station.sym.display == MAP_SELECTED_ON
-			&& mp->sta[i]->station.sym.selected)) &&
-			mp->sta[i]->visible)
-	{
-	    project(w, mp->sta[i]->station.lon, mp->sta[i]->station.lat,
-			&x, &y, &z);
-	    if(z > 0.)
-	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
-		d = (x0 - cursor_x)*(x0 - cursor_x) + 
-		    (y0 - cursor_y)*(y0 - cursor_y);
-		if(d < dmin)
-		{
-		    dmin = d;
-		    which = i;
-		    *station = True;
-		}
-	    }
-	}
-	/* cursor must be within 20 pixels of the station
+	which = SymbolCacheNearest(w, &mp->sta_cache, cursor_x, cursor_y, dmin,
+			StationOn, True, &d);
+	*station = (which >= 0) ? True : False;
+	if(which >= 0) dmin = d;
+
+	/* cursor must be within 20 pixels of the station or source
 	 */
 	if(sqrt(fabs(dmin)) > 20)
 	{
 	    *station = False;
 	    which = -1;
+	    if(dmin > 401.) dmin = 401.;
 	}
-
-	for(i = 0; i < mp->nsrc; i++)
-	    if( (mp->src[i]->source.sym.display >= MAP_ON ||
-		(mp->src[i]->source.sym.display == MAP_SELECTED_ON
-			&& mp->src[i]->source.sym.selected)) &&
-			mp->src[i]->visible)
-	{
-	    project(w, mp->src[i]->source.lon, mp->src[i]->source.lat,
-			&x, &y, &z);
-	    if(z > 0.)
-	    {
-		x0 = unscale_x(&ax->d, x);
-		y0 = unscale_y(&ax->d, y);
-		d = (x0 - cursor_x)*(x0 - cursor_x) + 
-		    (y0 - cursor_y)*(y0 - cursor_y);
-		if(d < dmin)
-		{
-		    dmin = d;
-		    which = i;
-		    *station = False;
-		}
-	    }
-	}
-	/* cursor must be within 20 pixels of the source
-	 */
-	if(sqrt(fabs(dmin)) > 20)
+	if((i = SymbolCacheNearest(w, &mp->src_cache, cursor_x, cursor_y, dmin,
+			SourceOn, True, &d)) >= 0)
 	{
+	    which = i;
 	    *station = False;
-	    which = -1;
 	}
 	return(which);
 }
@@ -10831,8 +11723,9 @@ WhichSymbol(MapPlotWidget w, int cursor_x, int cursor_y, int max, int *imin,
 {
 	MapPlotPart	*mp = &w->map_plot;
 	AxesPart	*ax = &w->axes;
-	int		i, j, which, x0, y0, min_x0 = -1, min_y0 = -1;
-	double		x, y, z;
+	int		i, j, k, cx, cy, which, x0, y0, min_x0 = -1, min_y0 = -1;
+	double		x, y, z, dist;
+	SymbolCache	*c;
 	float		d, dmin;
 
 	/* initialize dmin to a large value before seeking the minimim.
@@ -10877,54 +11770,30 @@ WhichSymbol(MapPlotWidget w, int cursor_x, int cursor_y, int max, int *imin,
 		}
 	    }
 	}
-	for(i = 0; i < mp->nsymbol; i++)
+	UpdateMapSymbolCache(w);
+	c = &mp->symbol_cache;
+	if((i = SymbolCacheNearest(w, c, cursor_x, cursor_y, dmin, MapSymbolOn,
+			True, &dist)) >= 0)
 	{
-	    SymbolInfo *sym = &mp->symbol[i].sym;
-	    if(sym->display == MAP_ON || sym->display == MAP_LOCKED_ON ||
-		(sym->display == MAP_SELECTED_ON && sym->selected))
-	    {
-		MapPlotSymbol *s = &mp->symbol[i];
-
-		project(w, s->lon, s->lat, &x, &y, &z);
-		if(z > 0.)
-		{
-		    x0 = unscale_x(&ax->d, x);
-		    y0 = unscale_y(&ax->d, y);
-		    d = (x0 - cursor_x)*(x0 - cursor_x) +
-			(y0 - cursor_y)*(y0 - cursor_y);
-		    if(d < dmin)
-		    {
-			dmin = d;
-			imin[0] = i;
-			which = 1;
-			mp->motion_x = x0;
-			mp->motion_y = y0;
-			min_x0 = x0;
-			min_y0 = y0;
-		    }
-		}
-	    }
+	    dmin = dist;
+	    imin[0] = i;
+	    which = 1;
+	    mp->motion_x = min_x0 = c->x[i];
+	    mp->motion_y = min_y0 = c->y[i];
 	}
 	if(which >= 0 && dmin < nearDist) {
 	    *near = True;
 	    if(which == 1) {
-		for(i = 0; i < mp->nsymbol; i++) if(i != imin[0])
+		/* the other symbols at the same pixel, from its cell */
+		SymbolCell(c, min_x0, min_y0, &cx, &cy);
+		k = cy*c->nx + cx;
+		for(j = c->cell[k]; j < c->cell[k+1]; j++)
 		{
-		    SymbolInfo *sym = &mp->symbol[i].sym;
-		    if(sym->display == MAP_ON || sym->display == MAP_LOCKED_ON
-			|| (sym->display == MAP_SELECTED_ON && sym->selected))
+		    i = c->sym[j];
+		    if(i != imin[0] && which < max && c->x[i] == min_x0 &&
+			c->y[i] == min_y0 && MapSymbolOn(w, i, True))
 		    {
-			MapPlotSymbol *s = &mp->symbol[i];
-
-			project(w, s->lon, s->lat, &x, &y, &z);
-			if(z > 0.)
-			{
-			    x0 = unscale_x(&ax->d, x);
-			    y0 = unscale_y(&ax->d, y);
-			    if(which < max && x0 == min_x0 && y0 == min_y0) {
-				imin[which++] = i;
-			    }
-			}
+			imin[which++] = i;
 		    }
 		}
 	    }
@@ -10939,8 +11808,8 @@ WhichMeasure(MapPlotWidget w, Boolean stasrc, Boolean arcdel, int cursor_x,
 {
 	MapPlotPart	*mp = &w->map_plot;
 	AxesPart	*ax = &w->axes;
-	int		i, j, which, x0, y0, d_id, a_id;
-	double		x, y, z, delta_d, arc_d;
+	int		i, j, which, d_id, a_id;
+	double		delta_d, arc_d, dist;
 	float		d, dmin;
 
 	*delta_id = -1;
@@ -10962,55 +11831,24 @@ WhichMeasure(MapPlotWidget w, Boolean stasrc, Boolean arcdel, int cursor_x,
 
 	if(stasrc)
 	{
-	    for(i = 0; i < mp->nsta; i++)
-		if((mp->sta[i]->station.sym.display >= MAP_ON ||
-		   (mp->sta[i]->station.sym.display == MAP_SELECTED_ON
-			&& mp->sta[i]->station.sym.selected)) &&
-				mp->sta[i]->visible)
+	    UpdateStaSrcCache(w, True);
+	    UpdateStaSrcCache(w, False);
+	    if((i = SymbolCacheNearest(w, &mp->sta_cache, cursor_x, cursor_y,
+			dmin, StationOn, True, &dist)) >= 0)
 	    {
-		project(w, mp->sta[i]->station.lon, mp->sta[i]->station.lat,
-			&x, &y, &z);
-		if(z > 0.)
-		{
-		    x0 = unscale_x(&ax->d, x);
-		    y0 = unscale_y(&ax->d, y);
-		    d = (x0 - cursor_x)*(x0 - cursor_x) + 
-			(y0 - cursor_y)*(y0 - cursor_y);
-		    if(d < dmin)
-		    {
-			dmin = d;
-			which = i;
-			*type = MAP_STATION;
-			*ic = -1;
-		    }
-		}
-	    } 
-	}
-	if(stasrc)
-	{
-	    for(i = 0; i < mp->nsrc; i++)
-		if((mp->src[i]->source.sym.display >= MAP_ON ||
-		   (mp->src[i]->source.sym.display == MAP_SELECTED_ON
-			&& mp->src[i]->source.sym.selected))
-			&& mp->src[i]->visible)
+		dmin = dist;
+		which = i;
+		*type = MAP_STATION;
+		*ic = -1;
+	    }
+	    if((i = SymbolCacheNearest(w, &mp->src_cache, cursor_x, cursor_y,
+			dmin, SourceOn, True, &dist)) >= 0)
 	    {
-		project(w, mp->src[i]->source.lon, mp->src[i]->source.lat,
-			&x, &y, &z);
-		if(z > 0.)
-		{
-		    x0 = unscale_x(&ax->d, x);
-		    y0 = unscale_y(&ax->d, y);
-		    d = (x0 - cursor_x)*(x0 - cursor_x) + 
-			    (y0 - cursor_y)*(y0 - cursor_y);
-		    if(d < dmin)
-		    {
-			dmin = d;
-			which = i;
-			*type = MAP_SOURCE;
-			*ic = -1;
-		    }
-		}
-	    } 
+		dmin = dist;
+		which = i;
+		*type = MAP_SOURCE;
+		*ic = -1;
+	    }
 	}
 
 	if(arcdel)
@@ -11154,55 +11992,16 @@ static Boolean
 nearStaSrc(MapPlotWidget w, int cursor_x, int cursor_y, int dmin)
 {
 	MapPlotPart	*mp = &w->map_plot;
-	AxesPart	*ax = &w->axes;
-	int		i, x0, y0;
-	double		x, y, z, sta_d, d;
+	double		d;
 
-	sta_d = 2*((int)w->core.width*(int)w->core.width +
-			  (int)w->core.height*(int)w->core.height);
-	dmin = dmin*dmin;
+	UpdateStaSrcCache(w, True);
+	UpdateStaSrcCache(w, False);
 
-	for(i = 0; i < mp->nsta; i++)
-	{
-	    if(mp->sta[i]->station.sym.display >= MAP_ON && mp->sta[i]->visible)
-	    {
-		project(w, mp->sta[i]->station.lon, mp->sta[i]->station.lat,
-			&x, &y, &z);
-		if(z > 0.)
-		{
-		    x0 = unscale_x(&ax->d, x);
-		    y0 = unscale_y(&ax->d, y);
-		    d = (x0 - cursor_x)*(x0 - cursor_x) + 
-			(y0 - cursor_y)*(y0 - cursor_y);
-		    if(d < sta_d)
-		    {
-			sta_d = d;
-			if(sta_d < dmin) return True;
-		    }
-		}
-	    } 
-	}
-	for(i = 0; i < mp->nsrc; i++)
-	{
-	    if(mp->src[i]->source.sym.display >= MAP_ON && mp->src[i]->visible)
-	    {
-		project(w, mp->src[i]->source.lon, mp->src[i]->source.lat,
-			&x, &y, &z);
-		if(z > 0.)
-		{
-		    x0 = unscale_x(&ax->d, x);
-		    y0 = unscale_y(&ax->d, y);
-		    d = (x0 - cursor_x)*(x0 - cursor_x) + 
-			    (y0 - cursor_y)*(y0 - cursor_y);
-		    if(d < sta_d)
-		    {
-			sta_d = d;
-			if(sta_d < dmin) return True;
-		    }
-		}
-	    } 
-	}
-	return False;
+	return (SymbolCacheNearest(w, &mp->sta_cache, cursor_x, cursor_y,
+			(double)dmin*dmin, StationOn, False, &d) >= 0 ||
+		SymbolCacheNearest(w, &mp->src_cache, cursor_x, cursor_y,
+			(double)dmin*dmin, SourceOn, False, &d) >= 0) ?
+		True : False;
 }
 
 static Boolean
@@ -13849,6 +14648,8 @@ MapPlotAddTheme(MapPlotWidget w, MapPlotTheme *theme, Boolean display)
 	    }
 	}
 
+	IndexTheme(t);
+
 	t->id = getMapId(mp);
 
 	DrawTheme(w, &ax->d, t);
@@ -16416,6 +17217,7 @@ DeleteTheme(MapPlotWidget w, int i)
 
 	if(i < 0 || i >= mp->nthemes) return;
 
+	FreeThemeIndex(mp->theme[i]);
 	for(j = 0; j < mp->theme[i]->theme.nshapes; j++) {
 	    ThemeDisplay *td = &mp->theme[i]->td[j];
 	    SHPDestroyObject(mp->theme[i]->theme.shapes[j]);
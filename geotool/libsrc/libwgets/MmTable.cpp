@@ -197,6 +197,8 @@ static void format(MmTableWidget w, int col);
 static void increaseCapacity(MmTableWidget w);
 static void sort(MmTableWidget w, vector<int> &col, int i0, int row1, int row2);
 static void sortByString(int lo0, int hi0, String *s, int *row_order);
+static int sortKey(MmTableWidget w, int row, int col, double *value,
+			const char **s);
 static void sortByValue(int lo0, int hi0, double *values, int *row_order);
 static void verticalScroll(Widget scroll, XtPointer client_data,
 		XmScrollBarCallbackStruct *call_data);
@@ -233,6 +235,10 @@ static void setButtonPixmap(MmTableWidget widget);
 static void doSelectRowCallback(MmTableWidget w, int row);
 static void doSelectRowCB(MmTableWidget w);
 static void MmTableAddRow(MmTableWidget w, char **row, Boolean redraw);
+static void formatCell(MmTableWidget w, int row, int col, char *buf, int len);
+static void lazyMoveToHead(MmTablePart *t, int k);
+static int lazyRow(MmTableWidget w, int row);
+static void clearLazy(MmTableWidget w);
 static void MmTableAddRowWithLabel(MmTableWidget w, char **row, char *label,
 		bool redraw);
 
@@ -566,6 +572,16 @@ t->menu_button = NULL;
     t->ignore_changed_managed = False;
     t->num_cell_choices = 0;
     t->cell_choice = NULL;
+    t->have_virtual = False;
+    t->lazy_wider = False;
+    t->lazy = NULL;
+    t->nlazy = 0;
+    t->lazy_ncols = 0;
+    t->lazy_head = -1;
+    t->lazy_tail = -1;
+    t->lazy_slot = NULL;
+    t->size_lazy_slot = 0;
+    t->lazy_width = NULL;
     t->pixmap_created = False;
 
     if(t->table_info != NULL)
@@ -940,6 +956,13 @@ SetValues(MmTableWidget cur, MmTableWidget req, MmTableWidget nou)
 	doLayout(nou, False);
 	redisplay = True;
     }
+    if(cur->mmTable.ncols != req->mmTable.ncols && t->have_virtual)
+    {
+	/* format the virtual cells with the old columns */
+	t->ncols = cur->mmTable.ncols;
+	_MmTableFormatCells(nou);
+	t->ncols = req->mmTable.ncols;
+    }
     if(cur->mmTable.ncols > req->mmTable.ncols)
     {
 	for(j = req->mmTable.ncols; j < cur->mmTable.ncols; j++) {
@@ -1306,6 +1329,8 @@ Destroy(Widget widget)
 
 
     Free(t->edit_string);
+    clearLazy(w);
+    Free(t->lazy_slot);
 
     if(t->gc != NULL) XFreeGC(XtDisplay(w), t->gc);
     if(t->highlightGC != NULL) XFreeGC(XtDisplay(w), t->highlightGC);
@@ -1796,6 +1821,284 @@ MmTableAddRowWithLabel(MmTableWidget w, char **row, char *label, bool redraw)
     XtCallCallbacks((Widget)w, XtNrowChangeCallback, (XtPointer)t->nrows);
 }
 
+/** Add rows whose cells are not formatted until they are needed. The text
+ *  of a cell comes from cellText(row, col) with the data row index of the
+ *  cell. The rows that are displayed are formatted into a small LRU cache.
+ *  A cell is formatted and kept in the table when it is edited or copied,
+ *  or when the whole table is needed, as for getColumn. The records behind
+ *  the rows must be removed with removeRows, so that the data row indices
+ *  stay the same.
+ *  @param[in] num the number of rows to add.
+ *  @param[in] redraw if true, redraw the table.
+ */
+void Table::addVirtualRows(int num, bool redraw)
+{
+    int i, j, n;
+    MmTablePart *t = &tw->mmTable;
+
+    if(num <= 0 || t->ncols <= 0) return;
+
+    MmTableEditModeOff(tw);
+
+    n = t->nrows + t->nhidden;
+    if(n + num > t->capacity) {
+	/* increase the capacity once */
+	int inc = t->incremental_capacity;
+	t->incremental_capacity = n + num - t->capacity;
+	increaseCapacity(tw);
+	t->incremental_capacity = inc;
+    }
+
+    for(i = n; i < n + num; i++) {
+	for(j = 0; j < t->ncols; j++) {
+	    t->columns[j][i] = (String)NULL;
+	    t->highlight[j][i] = False;
+	    t->cell_fill[j][i] = CELL_NO_FILL_FLAG;
+	    t->backup[j][i] = (String)NULL;
+	}
+	t->row_state[i] = False;
+	t->row_editable[i] = t->editable;
+	Free(t->row_labels[i]);
+    }
+    /* move hidden rows down */
+    for(j = n + num - 1; j >= t->nrows + num; j--) {
+	t->row_order[j] = t->row_order[j-num];
+    }
+    for(i = 0; i < num; i++) t->row_order[t->nrows+i] = n + i;
+    t->nrows += num;
+    updateDisplayOrder(t);
+    t->have_virtual = True;
+
+    if(!redraw) {
+	t->need_layout = True;
+	return;
+    }
+    doLayout(tw, False);
+    _TCanvasRedisplay(t->canvas);
+    XtCallCallbacks((Widget)tw, XtNrowChangeCallback, (XtPointer)t->nrows);
+}
+
+static void
+formatCell(MmTableWidget w, int row, int col, char *buf, int len)
+{
+    Table *table = w->mmTable.table_class;
+
+    buf[0] = '\0';
+    if(table && table->cellText(row, col, buf, len)) {
+	buf[len-1] = '\0';
+	/* remove blank spaces, as in MmTableAddRow */
+	stringTrim(buf);
+    }
+}
+
+static void
+lazyMoveToHead(MmTablePart *t, int k)
+{
+    LazyRow *l = t->lazy;
+
+    if(t->lazy_head == k) return;
+
+    /* unlink */
+    l[l[k].prev].next = l[k].next;
+    if(l[k].next >= 0) l[l[k].next].prev = l[k].prev;
+    else t->lazy_tail = l[k].prev;
+
+    l[k].prev = -1;
+    l[k].next = t->lazy_head;
+    l[t->lazy_head].prev = k;
+    t->lazy_head = k;
+}
+
+/* Return the LRU slot of data row, formatting the NULL cells of the row if
+ * it is not in the cache.
+ */
+static int
+lazyRow(MmTableWidget w, int row)
+{
+    MmTablePart *t = &w->mmTable;
+    int i, j, k, len, width;
+    LazyRow *l;
+    char buf[1000];
+
+    if(t->size_lazy_slot < t->capacity) {
+	if(!(t->lazy_slot = (int *)ReallocIt(w, t->lazy_slot,
+				t->capacity*sizeof(int)))) {
+	    t->size_lazy_slot = 0;
+	    return -1;
+	}
+	for(i = t->size_lazy_slot; i < t->capacity; i++) t->lazy_slot[i] = -1;
+	t->size_lazy_slot = t->capacity;
+    }
+    if((k = t->lazy_slot[row]) >= 0) {
+	lazyMoveToHead(t, k);
+	return k;
+    }
+    if(t->nlazy == 0) {
+	if(!(t->lazy = (LazyRow *)MallocIt(w,
+			MM_TABLE_LAZY_ROWS*sizeof(LazyRow)))) return -1;
+	t->nlazy = MM_TABLE_LAZY_ROWS;
+	for(k = 0; k < t->nlazy; k++) {
+	    t->lazy[k].row = -1;
+	    t->lazy[k].prev = k-1;
+	    t->lazy[k].next = (k < t->nlazy-1) ? k+1 : -1;
+	    t->lazy[k].cells = NULL;
+	}
+	t->lazy_head = 0;
+	t->lazy_tail = t->nlazy-1;
+	t->lazy_ncols = t->ncols;
+    }
+    if(!t->lazy_width) {
+	if(!(t->lazy_width = (int *)MallocIt(w, t->ncols*sizeof(int)))) {
+	    return -1;
+	}
+	for(j = 0; j < t->ncols; j++) t->lazy_width[j] = 0;
+    }
+
+    /* reuse the least recently used slot */
+    k = t->lazy_tail;
+    l = &t->lazy[k];
+    if(l->row >= 0) {
+	t->lazy_slot[l->row] = -1;
+	l->row = -1;
+    }
+    if(!l->cells) {
+	if(!(l->cells = (char **)MallocIt(w, t->ncols*sizeof(char *)))) {
+	    return -1;
+	}
+	for(j = 0; j < t->ncols; j++) l->cells[j] = NULL;
+    }
+
+    for(j = 0; j < t->ncols; j++)
+    {
+	Free(l->cells[j]);
+	if(t->columns[j][row] != (String)NULL) continue;
+
+	formatCell(w, row, j, buf, (int)sizeof(buf));
+	l->cells[j] = strdup(buf);
+
+	width = stringWidth(w, buf) + t->cellMargin;
+	if(t->lazy_width[j] < width) {
+	    t->lazy_width[j] = width;
+	    if(t->col_width[j] < width) t->lazy_wider = True;
+	}
+	len = (int)strlen(buf);
+	if(t->col_nchars[j] < len) t->col_nchars[j] = len;
+    }
+    l->row = row;
+    t->lazy_slot[row] = k;
+    lazyMoveToHead(t, k);
+    return k;
+}
+
+/* Empty the LRU cache. Called when the data rows or the columns move.
+ */
+static void
+clearLazy(MmTableWidget w)
+{
+    MmTablePart *t = &w->mmTable;
+    int j, k;
+
+    for(k = 0; k < t->nlazy; k++) {
+	if(t->lazy[k].row >= 0 && t->lazy[k].row < t->size_lazy_slot) {
+	    t->lazy_slot[t->lazy[k].row] = -1;
+	}
+	if(t->lazy[k].cells) {
+	    /* the cells array has the number of columns of the last format */
+	    for(j = 0; j < t->lazy_ncols; j++) Free(t->lazy[k].cells[j]);
+	    Free(t->lazy[k].cells);
+	}
+    }
+    Free(t->lazy);
+    t->nlazy = 0;
+    Free(t->lazy_width);
+}
+
+/* Return the text of a cell. The text of a virtual cell is only valid until
+ * more than MM_TABLE_LAZY_ROWS other rows have been formatted. Call
+ * _MmTableFormatRow to keep it.
+ */
+char *
+_MmTableCell(MmTableWidget w, int row, int col)
+{
+    MmTablePart *t = &w->mmTable;
+    int k;
+    char *s;
+
+    if((s = t->columns[col][row]) != (String)NULL) return s;
+
+    if((k = lazyRow(w, row)) < 0 || !t->lazy[k].cells[col]) return (char *)"";
+    return t->lazy[k].cells[col];
+}
+
+/* Format the virtual cells of a data row and keep them in the table.
+ */
+void
+_MmTableFormatRow(MmTableWidget w, int row)
+{
+    MmTablePart *t = &w->mmTable;
+    int j, k;
+    char buf[1000];
+
+    if(!t->have_virtual || row < 0 || row >= t->nrows + t->nhidden) return;
+
+    k = (row < t->size_lazy_slot) ? t->lazy_slot[row] : -1;
+
+    for(j = 0; j < t->ncols; j++) if(t->columns[j][row] == (String)NULL)
+    {
+	if(k >= 0 && t->lazy[k].cells[j]) {
+	    t->columns[j][row] = t->lazy[k].cells[j];
+	    t->lazy[k].cells[j] = NULL;
+	}
+	else {
+	    formatCell(w, row, j, buf, (int)sizeof(buf));
+	    t->columns[j][row] = strdup(buf);
+	}
+    }
+}
+
+/* Format all of the virtual cells and keep them in the table.
+ */
+void
+_MmTableFormatCells(MmTableWidget w)
+{
+    MmTablePart *t = &w->mmTable;
+    int i;
+
+    if(!t->have_virtual) return;
+
+    for(i = 0; i < t->nrows + t->nhidden; i++) _MmTableFormatRow(w, i);
+    clearLazy(w);
+    t->have_virtual = False;
+}
+
+/* Format the virtual rows with display indices i1 to i2. Returns True if
+ * a cell is wider than its column.
+ */
+Boolean
+_MmTableLoadRows(MmTableWidget w, int i1, int i2)
+{
+    MmTablePart *t = &w->mmTable;
+    int i, j, ro;
+
+    if(!t->have_virtual) return False;
+
+    if(i1 < 0) i1 = 0;
+    if(i2 >= t->nrows) i2 = t->nrows-1;
+    if(i2 - i1 + 1 > MM_TABLE_LAZY_ROWS) i2 = i1 + MM_TABLE_LAZY_ROWS - 1;
+
+    for(i = i1; i <= i2; i++) {
+	ro = t->row_order[i];
+	for(j = 0; j < t->ncols && t->columns[j][ro] != (String)NULL; j++);
+	if(j < t->ncols) lazyRow(w, ro);
+    }
+    if(t->lazy_wider) {
+	t->lazy_wider = False;
+	return True;
+    }
+    return False;
+}
+
+
 int Table::getRowHeight(void)
 {
     MmTablePart *t = &tw->mmTable;
@@ -1822,6 +2125,9 @@ void Table::moveRow(int row, int dir)
     if(row < 0 || row >= t->nrows) return;
     if((dir == -1 && row == 0) || (dir == 1 && row == t->nrows-1)) return;
 
+    _MmTableFormatRow(tw, row);
+    _MmTableFormatRow(tw, row+dir);
+
     for(j = 0; j < t->ncols; j++)
     {
 	c = t->columns[j][row+dir];
@@ -1891,6 +2197,7 @@ void Table::removeRows(vector<int> &rows)
     if(t->ncols == 0 || (int)rows.size() <= 0) return;
 
     MmTableEditModeOff(tw);
+    clearLazy(tw);
 
     rows_sorted = new int[rows.size()];
     for(i = 0; i < (int)rows.size(); i++) rows_sorted[i] = rows[i];
@@ -1988,6 +2295,8 @@ void Table::removeAllRows(void)
 
     t->nrows = 0;
     t->nhidden = 0;
+    clearLazy(tw);
+    t->have_virtual = False;
     MmTableAdjustColumns(tw);
     XtCallCallbacks((Widget)tw, XtNrowChangeCallback, (XtPointer)t->nrows);
 }
@@ -2003,6 +2312,7 @@ void MmTableSetFieldWithCB(MmTableWidget w, int row, int col, const char *s,
 
     if(row < 0 || row > t->nrows+t->nhidden || col < 0 || col >t->ncols) return;
 
+    _MmTableFormatRow(w, row);
 /*
     if(!XtIsRealized((Widget)w)) return;
 
@@ -2084,6 +2394,8 @@ void MmTableSetFields(MmTableWidget w, int num, int *rows, int *cols,
 	if(rows[i] < 0 || rows[i] > t->nrows+t->nhidden ||
 	    cols[i] < 0 || cols[i] >t->ncols) continue;
 
+	_MmTableFormatRow(w, rows[i]);
+
 	if((choice = MmTableGetCellChoice(w, rows[i], cols[i])) != NULL
 		|| t->column_choice[cols[i]][0] != '\0')
 	{
@@ -2135,7 +2447,7 @@ char * Table::getField(int row, int col)
     if(row < 0 || row > t->nrows+t->nhidden || col < 0 || col >t->ncols) {
 	return (char *)NULL;
     }
-    return strdup(t->columns[col][row]);
+    return strdup(_MmTableCell(tw, row, col));
 }
 
 bool Table::findAndSetRow(int num_columns, int *col, const char **names,
@@ -2152,12 +2464,14 @@ bool Table::findAndSetRow(int num_columns, int *col, const char **names,
     for(i = 0; i < t->nrows + t->nhidden; i++) {
 	int j;
 	for(j = 0; j < num_columns; j++) {
-	    if(!strcmp(t->columns[col[j]][i], names[j])) break;
+	    if(!strcmp(_MmTableCell(tw, i, col[j]), names[j])) break;
 	}
 	if(j == num_columns) break;
     }
     if(i == t->nrows + t->nhidden) return False;  /* couldn't find row */
 
+    _MmTableFormatRow(tw, i);
+
     if(!XtIsRealized((Widget)tw)) return True;
 
     for(k = 0; k < t->ncols; k++) {
@@ -2185,6 +2499,7 @@ void Table::addColumn(const char **col, const string &label, bool isEditable,
     MmTablePart *t = &tw->mmTable;
 
     MmTableEditModeOff(tw);
+    _MmTableFormatCells(tw);
 
     t->ncols++;
     t->col_order = (int *)ReallocIt(tw, t->col_order, t->ncols*sizeof(int));
@@ -2286,6 +2601,7 @@ void Table::rollColumn(const char **col, const string &label,
     }
 	
     MmTableEditModeOff(tw);
+    _MmTableFormatCells(tw);
 
     for(j = 0; j < t->ncols; j++) {
 	if(t->col_order[j] > 0) t->col_order[j]--;
@@ -2383,6 +2699,7 @@ void Table::removeColumn(int col)
 
     if(col < 0 || col >= t->ncols || t->ncols == 0) return;
     MmTableEditModeOff(tw);
+    _MmTableFormatCells(tw);
 
     for(j = 0; j < t->ncols; j++) {
 	if(t->col_order[j] > col) t->col_order[j]--;
@@ -2616,6 +2933,8 @@ format(MmTableWidget w, int col)
     int *nd = NULL;
     MmTablePart *t = &w->mmTable;
 
+    _MmTableFormatCells(w);
+
     if(!(nd = (int *)MallocIt(w, (t->nrows + t->nhidden)*sizeof(int)))) return;
 
     ndeci = -1;
@@ -2873,6 +3192,7 @@ getNewColumnWidths(MmTableWidget w, int j1, int j2)
 	for(i = 0; i < t->nrows + t->nhidden; i++)
 	{
 	    int len;
+	    if(t->columns[t->col_order[j]][i] == (String)NULL) continue;
 	    if((c = MmTableGetCellChoice(w, i, t->col_order[j])) != NULL) {
 		width = getChoiceMaxWidth(w, c) + t->cellMargin;
 	    }
@@ -2885,6 +3205,10 @@ getNewColumnWidths(MmTableWidget w, int j1, int j2)
 	    len = (int)strlen(t->columns[t->col_order[j]][i]);
 	    if(t->col_nchars[j] < len) t->col_nchars[j] = len;
 	}
+	if(t->lazy_width && max_w < t->lazy_width[t->col_order[j]]) {
+	    /* the virtual cells formatted so far */
+	    max_w = t->lazy_width[t->col_order[j]];
+	}
 	if(t->col_width[t->col_order[j]] != max_w) {
 	    t->col_width[t->col_order[j]] = max_w;
 	    if(t->col_width[t->col_order[j]] < t->min_col_width) {
@@ -3050,8 +3374,9 @@ sort(MmTableWidget w, vector<int> &col, int i0, int row1, int row2)
     int i, j, len;
     Boolean do_values;
     double *values = (double *)NULL;
-    String *column, endptr;
+    String *column, endptr, c;
     String *s = (String *)NULL;
+    const char *key;
     MmTablePart *t = &w->mmTable;
 
     if(row2-row1 <= 0 || (int)col.size() <= 0) return;
@@ -3060,19 +3385,38 @@ sort(MmTableWidget w, vector<int> &col, int i0, int row1, int row2)
 
     column = t->columns[col[i0]];
 
+    /* A virtual cell is sorted by the key from the data model, if there is
+     * one, so that it is not formatted and parsed.
+     */
     if(t->col_time[col[i0]] != NOT_TIME) {
 	enum TimeFormat time_code = t->col_time[col[i0]];
 	for(i = row1; i <= row2; i++) {
-	    values[i] = timeStringToEpoch(column[t->row_order[i]], time_code);
+	    int ro = t->row_order[i];
+	    if((c = column[ro]) == (String)NULL) {
+		if(sortKey(w, ro, col[i0], &values[i], &key) == CELL_KEY_VALUE)
+		    continue;
+		c = _MmTableCell(w, ro, col[i0]);
+	    }
+	    values[i] = timeStringToEpoch(c, time_code);
 	}
 	do_values = True;
     }
     else {
 	do_values = True;
 	for(i = row1; i <= row2; i++) {
-	    values[i] = strtod(column[t->row_order[i]], &endptr);
-	    len = (int)strlen(column[t->row_order[i]]);
-	    if(endptr - column[t->row_order[i]] != len) {
+	    int ro = t->row_order[i];
+	    if((c = column[ro]) == (String)NULL) {
+		int k = sortKey(w, ro, col[i0], &values[i], &key);
+		if(k == CELL_KEY_VALUE) continue;
+		if(k == CELL_KEY_STRING) {
+		    do_values = False;
+		    break;
+		}
+		c = _MmTableCell(w, ro, col[i0]);
+	    }
+	    values[i] = strtod(c, &endptr);
+	    len = (int)strlen(c);
+	    if(endptr - c != len) {
 		do_values = False;
 		break;
 	    }
@@ -3083,7 +3427,20 @@ sort(MmTableWidget w, vector<int> &col, int i0, int row1, int row2)
     }
     else {
         if(!(s = (char **)MallocIt(w, t->nrows*sizeof(String)))) return;
-	for(i = row1; i <= row2; i++) s[i] = column[t->row_order[i]];
+	for(i = row1; i <= row2; i++) {
+	    int ro = t->row_order[i];
+	    if((s[i] = column[ro]) != (String)NULL) continue;
+	    if(sortKey(w, ro, col[i0], &values[i], &key) == CELL_KEY_STRING
+		&& key != NULL)
+	    {
+		s[i] = (String)key;
+	    }
+	    else {
+		/* keep the text, since the cache can drop it */
+		_MmTableFormatRow(w, ro);
+		s[i] = column[ro];
+	    }
+	}
 	sortByString(row1, row2, s, t->row_order);
     }
 
@@ -3116,6 +3473,17 @@ sort(MmTableWidget w, vector<int> &col, int i0, int row1, int row2)
     Free(values);
 }
 
+/* Get the sort key of a virtual cell from the data model.
+ */
+static int
+sortKey(MmTableWidget w, int row, int col, double *value, const char **s)
+{
+    Table *table = w->mmTable.table_class;
+
+    *s = NULL;
+    return table ? table->cellSortKey(row, col, value, s) : CELL_KEY_TEXT;
+}
+
 static void
 sortByString(int lo0, int hi0, String *s, int *row_order)
 {
@@ -3372,6 +3740,7 @@ void Table::sortUnique(vector<int> &cols)
 
     if((int)cols.size() == 0) return;
 
+    _MmTableFormatCells(tw);
     sort(tw, cols, 0, 0, t->nrows-1);
 
     col = cols[0];
@@ -3488,6 +3857,7 @@ void Table::expand(int col)
     if(col < 0 || col > t->ncols || t->nhidden == 0) return;
 
     MmTableEditModeOff(tw);
+    _MmTableFormatCells(tw);
 
     column = t->columns[col];
 
@@ -3639,6 +4009,7 @@ const char ** Table::getRow(int i)
 
     if(!(row = (const char **)MallocIt(tw, t->ncols*sizeof(const char **))))
 	return (const char **)NULL;
+    _MmTableFormatRow(tw, i);
     for(j = 0; j < t->ncols; j++) row[j] = t->columns[j][i];
     return row;
 }
@@ -3650,6 +4021,7 @@ int Table::getRow(int i, vector<const char *> &row)
     row.clear();
     if(i < 0 || i >= t->nrows + t->nhidden) return 0;
 
+    _MmTableFormatRow(tw, i);
     for(int j = 0; j < t->ncols; j++) {
 	row.push_back((const char *)t->columns[j][i]);
     }
@@ -3770,6 +4142,7 @@ const char **Table::getColumn(int j)
 
     if(j < 0 || j > t->ncols) return (const char **)NULL;
 
+    _MmTableFormatCells(tw);
     n = t->nrows + t->nhidden;
     if(!(col = (const char **)MallocIt(tw, n*sizeof(const char *))))
 	return (const char **)NULL;
@@ -3785,6 +4158,7 @@ int Table::getColumn(int j, vector<const char *> &col)
     col.clear();
     if(j < 0 || j > t->ncols) return 0;
 
+    _MmTableFormatCells(tw);
     n = t->nrows + t->nhidden;
     for(int i = 0; i < n; i++) col.push_back((const char *)t->columns[j][i]);
     return (int)col.size();
@@ -3849,6 +4223,8 @@ void Table::resetColumnOrder()
     String **s = NULL, *lab = NULL;
     Pixel *p = NULL, **cellp;
 
+    _MmTableFormatCells(tw);
+
     if(!(col = (int *)MallocIt(tw, t->ncols*sizeof(int)))) return;
 
     for(i = 0; i < t->ncols; i++) col[i] = t->col_width[i];
@@ -4309,6 +4685,7 @@ MmTableCut(MmTableWidget w, XButtonEvent *event)
 		t->select_char1 : t->select_char2;
 	c2 = (t->select_char2 > t->select_char1) ?
 		t->select_char2 : t->select_char1;
+	_MmTableFormatRow(w, t->row_order[t->select_row]);
 	s= t->columns[t->col_order[t->select_col]][t->row_order[t->select_row]];
 	s1 = substring(w, s, 0, c1);
 	s2 = substring(w, s, c2, strlen(s));
@@ -4340,6 +4717,7 @@ MmTableCopy(MmTableWidget w, XButtonEvent *event)
 		t->select_char1 : t->select_char2;
 	c2 = (t->select_char2 > t->select_char1) ?
 		t->select_char2 : t->select_char1;
+	_MmTableFormatRow(w, t->row_order[t->select_row]);
 	s= t->columns[t->col_order[t->select_col]][t->row_order[t->select_row]];
 	Free(t->field_selection);
 	t->field_selection = substring(w, s, c1, c2);
@@ -4438,8 +4816,9 @@ requestorCallback(MmTableWidget w, XButtonEvent *event, Atom *selection,
 	    int n;
     	    MmTablePart *t = &w->mmTable;
 	    String s1 = NULL, s2 = NULL;
-	    String s =
-	       t->columns[t->col_order[t->edit_col]][t->row_order[t->edit_row]];
+	    String s;
+	    _MmTableFormatRow(w, t->row_order[t->edit_row]);
+	    s = t->columns[t->col_order[t->edit_col]][t->row_order[t->edit_row]];
 	    s1 = substring(w, s, 0, t->edit_pos);
 	    s2 = substring(w, s, t->edit_pos, (int)strlen(s));
 	    if(t->backup[t->col_order[t->edit_col]][t->row_order[t->edit_row]]
@@ -4947,6 +5326,7 @@ int Table::getSelectedAndHiddenRows(vector<int> &rows)
 	key_col = t->sort_unique.cols[t->sort_unique.cols_length-1];
     }
     if(key_col >= t->ncols) key_col = -1;
+    if(key_col >= 0) _MmTableFormatCells(tw);
 
     n = 0;
     for(i = 0; i < t->nrows; i++) {
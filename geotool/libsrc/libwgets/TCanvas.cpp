@@ -668,6 +668,12 @@ _TCanvasRedraw(TCanvasWidget w)
     if(t->left >= t->ncols) t->left = t->ncols-1;
     if(t->left < 0) t->left = 0;
     t->right = _TCanvasGetRight(w, t->left);
+
+    if(_MmTableLoadRows(tc->table, t->top, t->bottom)) {
+	/* a virtual cell is wider than its column. This redisplays. */
+	MmTableAdjustColumnWidths(tc->table, 0, t->ncols-1);
+	return;
+    }
     fillSides(w);
 
     _TCanvasDrawRows(w, t->top, t->bottom, t->left, t->right);
@@ -744,8 +750,7 @@ _TCanvasDrawRows(TCanvasWidget w, int i1, int i2, int j1, int j2)
 	{
 	    int co = t->col_order[j];
 	    int x = 0;
-	    String s = t->columns[co][ro];
-	    if(s == (String)NULL) s = (char *)"";
+	    String s = _MmTableCell(tc->table, ro, co);
 	    if(t->col_alignment[co] == LEFT_JUSTIFY) {
 		x = t->col_beg[j] - t->col_beg[t->left] + t->margin + 3;
 	    }
@@ -1613,7 +1618,7 @@ TCanvasCellSelect(TCanvasWidget w, XEvent *event, int row, int col)
 	c.column = col;
 	ro = t->row_order[row];
 	co = t->col_order[col];
-	c.string = t->columns[co][ro];
+	c.string = _MmTableCell(tc->table, ro, co);
 	if(t->cell_fill[co][ro] == CELL_TOGGLE_ON) {
 	    t->cell_fill[co][ro] = CELL_TOGGLE_OFF;
 	    _TCanvasDrawRows(w, row, row, col, col);
@@ -1641,7 +1646,7 @@ TCanvasCellEnter(TCanvasWidget w, XEvent *event, int row, int col)
     {
 	c.row = row;
 	c.column = col;
-	c.string = t->columns[t->col_order[col]][t->row_order[row]];
+	c.string = _MmTableCell(tc->table, t->row_order[row], t->col_order[col]);
 	c.pixel = t->cell_fill[t->col_order[col]][t->row_order[row]];
 	c.event = event;
 	XtCallCallbacks((Widget)tc->table, XtNcellEnterCallback, &c);
@@ -1811,6 +1816,9 @@ mousePressed3(TCanvasWidget w, XEvent *event, Boolean action)
     if(!t->table_class->cellEditable(t->row_order[row], t->col_order[j])) {
 	return False;
     }
+    if(row >= 0 && row < t->nrows) {
+	_MmTableFormatRow(tc->table, t->row_order[row]);
+    }
 
     if((choice = t->table_class->getCellChoice(row, j)) != NULL ||
 	t->column_choice[t->col_order[j]][0] != '\0')
@@ -2016,6 +2024,7 @@ ChoiceSelectCB(Widget widget, XtPointer client_data, XtPointer data)
     if(i < 0 || i >= t->nrows || j < 0 || j >= t->ncols) return;
 
     c = XtName(widget);
+    _MmTableFormatRow(tc->table, t->row_order[i]);
     Free(t->columns[t->col_order[j]][t->row_order[i]]);
     t->columns[t->col_order[j]][t->row_order[i]] = strdup(c);
     _TCanvasDrawRows(w, tc->choice_menu_row, tc->choice_menu_column,
@@ -2351,9 +2360,13 @@ KeyPressed(TCanvasWidget w, XEvent *event, String *params, Cardinal *num_params)
     max_w = stringWidth(w, t->column_labels[t->col_order[j]]) + t->cellMargin;
 
     for(i = 0; i < t->nrows + t->nhidden; i++) {
+	if(t->columns[t->col_order[j]][i] == (String)NULL) continue;
 	width = stringWidth(w, t->columns[t->col_order[j]][i]) + t->cellMargin;
 	if(max_w < width) max_w = width;
     }
+    if(t->lazy_width && max_w < t->lazy_width[t->col_order[j]]) {
+	max_w = t->lazy_width[t->col_order[j]];
+    }
     if(max_w < t->min_col_width) max_w = t->min_col_width;
     t->col_width[t->col_order[j]] = max_w;
 
@@ -2569,6 +2582,7 @@ nextCell(TCanvasWidget w, enum CellDir dir)
 	t->edit_row_state = r_state;
 	t->edit_row = row;
 	t->edit_col = col;
+	_MmTableFormatRow(tc->table, t->row_order[t->edit_row]);
 	s = t->columns[t->col_order[t->edit_col]][t->row_order[t->edit_row]];
 	t->edit_pos = strlen(s);
 	t->edit_x = stringWidthLen(w, s, t->edit_pos);
@@ -2593,7 +2607,7 @@ positionEditCursor(TCanvasWidget w, XEvent *event, int col, int row)
     MmTablePart *t = &tc->table->mmTable;
     int cursor_x = ((XButtonEvent *)event)->x;
 
-    String s = t->columns[t->col_order[col]][t->row_order[row]];
+    String s = _MmTableCell(tc->table, t->row_order[row], t->col_order[col]);
     if(s == NULL) return;
     pos = -1;
     dmin = 100000;
@@ -2673,7 +2687,8 @@ drawEditCursor(TCanvasWidget w, int x, int on, int col, int row)
     }
     else if(t->col_alignment[t->col_order[col]] == RIGHT_JUSTIFY) {
 	start = t->col_end[col] - t->col_beg[t->left] + t->margin - 3
-	    - stringWidth(w, t->columns[t->col_order[col]][t->row_order[row]]);
+	    - stringWidth(w, _MmTableCell(tc->table, t->row_order[row],
+				t->col_order[col]));
     }
     x += start;
     if(on) XSetForeground(XtDisplay(w), tc->gc, w->primitive.foreground);
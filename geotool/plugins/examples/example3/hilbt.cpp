@@ -41,6 +41,7 @@ bool hilbert::applyMethod(int num_waveforms, GTimeSeries **ts)
 // static
 void hilbert::applySegment(GSegment *s)
 {
+    s->unshare();
     Hilbert_data(s->length(), s->data);
 }
 
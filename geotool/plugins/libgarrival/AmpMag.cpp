@@ -372,10 +372,14 @@ void AmpMag::actionPerformed(ActionEvent *action_event)
 ParseCmd AmpMag::parseCmd(const string &cmd, string &msg)
 {
     string c;
+    bool err;
 
     if(parseCompare(cmd, "compute_magnitudes")) {
 	computeMagnitudes();
     }
+    else if(parseCompare(cmd, "compile_mag_tables")) {
+	if( !compileMagTables(msg) ) return ARGUMENT_ERROR;
+    }
     else if(parseCompare(cmd, "measure_amplitude")) {
         measureAmplitude(AUTO_MEASURE);
     }
@@ -385,6 +389,19 @@ ParseCmd AmpMag::parseCmd(const string &cmd, string &msg)
     else if(parseCompare(cmd, "measure_mb")) {
         measureAmplitude(MB_MEASURE);
     }
+    else if(parseFind(cmd, "measure_amplitudes_batch", msg, &err,
+			"threads", false, "selected", false))
+    {
+	int num_threads = 0;
+	bool selected = false;
+
+	if(err) return ARGUMENT_ERROR;
+	if(!parseGetArg(cmd, "measure_amplitudes_batch", msg, "threads",
+			&num_threads) && !msg.empty()) return ARGUMENT_ERROR;
+	if(!parseGetArg(cmd, "measure_amplitudes_batch", msg, "selected",
+			&selected) && !msg.empty()) return ARGUMENT_ERROR;
+	measureAmplitudesBatch(selected, num_threads);
+    }
     else if(parseString(cmd, "amplitudes", c)) {
         return amp_table->parseCmd(c, msg);
     }
@@ -611,6 +628,20 @@ void AmpMag::measureAmplitude(AmpMeasureMode mode)
     }
 }
 
+void AmpMag::measureAmplitudesBatch(bool selected, int num_threads)
+{
+    cvector<CssArrivalClass> arrivals;
+
+    if(selected) data_source->getSelectedTable(arrivals);
+    else data_source->getTable(arrivals);
+
+    if(arrivals.size() <= 0) {
+	showWarning("No arrivals.");
+	return;
+    }
+    wp->measureAmpsBatch(arrivals, AUTO_MEASURE, num_threads);
+}
+
 void AmpMag::computeMagnitudes(void)
 {
     int i, j, k, l, num_mags, num_magtypes;
@@ -909,6 +940,35 @@ void AmpMag::initMagLib(CssTableClass *css)
     mag_lib_ready = true;
 }
 
+/** Compile the transmission loss tables of the magnitude library. A compiled
+ *  file is written next to each TL table read by setup_mag_facilities(),
+ *  which later sessions map in place of the text table.
+ *  @param[out] msg an error message.
+ *  @returns true for success, false if the magnitude library could not be
+ *	initialized or the compiled files could not be written.
+ */
+bool AmpMag::compileMagTables(string &msg)
+{
+    cvector<CssAmplitudeClass> amps;
+    char error[200];
+    int err;
+
+    if( !mag_lib_ready && data_source && data_source->getTable(amps) ) {
+	initMagLib(amps[0]);
+    }
+    if( !mag_lib_ready ) {
+	msg.assign("compile_mag_tables: the TL tables have not been read.");
+	return false;
+    }
+    if((err = compile_tl_tables()) != OK) {
+	snprintf(error, sizeof(error),
+		"compile_mag_tables: cannot compile TL tables (error %d)", err);
+	msg.assign(error);
+	return false;
+    }
+    return true;
+}
+
 int AmpMag::getSelectedAmps(cvector<CssAmplitudeClass> &amplitudes)
 {
     int i, j;
@@ -73,7 +73,9 @@ class AmpMag : public Frame, public DataReceiver
 	void stamagList(void);
 	void netmagList(void);
 	void computeMagnitudes(void);
+	bool compileMagTables(string &msg);
 	void measureAmplitude(AmpMeasureMode mode);
+	void measureAmplitudesBatch(bool selected, int num_threads);
 	void initMagLib(CssTableClass *css);
 	void updateTables(void);
 	void saveMagnitudes(void);
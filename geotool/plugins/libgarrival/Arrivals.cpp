@@ -681,7 +681,9 @@ ParseCmd Arrivals::parseCmd(const string &cmd, string &msg)
     else if(parseCompare(cmd, "measure_amplitude") ||
 	    parseCompare(cmd, "measure_ml") ||
 	    parseCompare(cmd, "measure_mb") ||
+	    parseCompare(cmd, "measure_amplitudes_batch", 24) ||
 	    parseCompare(cmd, "compute_magnitudes") ||
+	    parseCompare(cmd, "compile_mag_tables") ||
 	    parseCompare(cmd, "amplitudes.", 11) ||
 	    parseCompare(cmd, "stamags.", 8) ||
 	    parseCompare(cmd, "netmags.", 8) ||
@@ -753,6 +755,9 @@ void Arrivals::parseHelp(const char *prefix)
     TableAttributes::parseHelp(p);
 
     printf("%sdelete\n", prefix);
+    printf("%smeasure_amplitudes_batch [threads=N] [selected=(true,false)]\n",
+		prefix);
+    printf("%scompile_mag_tables\n", prefix);
 
     printf("%sselect_cursor PHASE\n", prefix);
 //    printf("%sposition cursor TIME\n", prefix);
@@ -23,6 +23,7 @@ extern "C" {
 #include "libstring.h"
 #include "libcalib.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgcal;
 
@@ -318,6 +319,7 @@ void Calibration::printWindow(void)
 
 void Calibration::compute(void)
 {
+    ProfileTimer pt("Calibration::compute");
     int npts;
     CalibSignal in_sig, out_sig;
     CalibOut co;
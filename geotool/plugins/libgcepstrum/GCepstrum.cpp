@@ -17,6 +17,7 @@ extern "C" {
 #include "libstring.h"
 #include "cepstrum.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgcepstrum;
 
@@ -332,6 +333,7 @@ void GCepstrum::print(void)
 
 void GCepstrum::compute(void)
 {
+    ProfileTimer pt("GCepstrum::compute");
     int i, i1, i2, num;
     double *x=NULL;
     CepstrumStruct cs[2], *signal=NULL, *noise=NULL;
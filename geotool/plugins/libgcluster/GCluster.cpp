@@ -26,6 +26,7 @@ extern "C" {
 #include "tapers.h"
 #include "cluster.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgcluster;
 
@@ -381,15 +382,17 @@ void GCluster::print(FILE *fp, PrintParam *p)
 
 void GCluster::compute(const Method mccc_method, const char cluster_method)
 {
+    ProfileTimer pt("GCluster::compute");
     double lag;
     GClusterParam cp = GCLUSTER_PARAM_NULL;
     int num_waveforms = 0, select_mode = 0;
     GTimeSeries **ts_list, **mccc_ts_list, *ts, *mccc_ts;
     gvector<Waveform *> wvec;
     double ** ccmatrix = NULL, * ccmatrix_buffer = NULL;
-    bool ** ccmatrix_mask = NULL, * ccmatrix_mask_buffer = NULL;
-    double ** distmatrix = NULL, * distmatrix_buffer = NULL;
+    float ** data = NULL, * data_buffer = NULL;
+    double ** distmatrix = NULL;
     Node * tree = NULL;
+    bool correlated = false;
     int n;
     Arg args[30];
 
@@ -429,11 +432,6 @@ void GCluster::compute(const Method mccc_method, const char cluster_method)
     for (int j = 0; j < num_waveforms; ++j) {
       ccmatrix[j] = ccmatrix_buffer + j * num_waveforms;
     }
-    ccmatrix_mask_buffer = new bool[num_waveforms * num_waveforms];
-    ccmatrix_mask = new bool *[num_waveforms];
-    for (int j = 0; j < num_waveforms; ++j) {
-      ccmatrix_mask[j] = ccmatrix_mask_buffer + j * num_waveforms;
-    }
     mccc = (MCCCStruct *)reallocWarn(mccc, (num_mccc+num_waveforms)*sizeof(MCCCStruct));
     ts_list = new GTimeSeries *[num_waveforms];
 
@@ -454,24 +452,45 @@ void GCluster::compute(const Method mccc_method, const char cluster_method)
       ts_list[i] = ts;
     }
 
+    /* The aligned waveforms come from MCCC, while the coefficient
+     * matrix comes from the all-pairs correlation, which transforms each
+     * waveform only once
+     */
     if (!(mccc_ts_list = multiChannelCCTS(ts_list, num_waveforms,
-					  mccc_method, lag, ccmatrix,
-					  ccmatrix_mask))) {
+					  mccc_method, lag, NULL, NULL))) {
       showWarning("Failed to MCCC. See terminal for details.");
     }
     else {
-      /* Fill in distmatrix */  
-      distmatrix_buffer = new double[num_waveforms * num_waveforms];
-      distmatrix = new double *[num_waveforms];
- 
+      int m = ts_list[0]->length(), max_len = m;
+      for (int i = 1; i < num_waveforms; i++) {
+	if (ts_list[i]->length() < m) m = ts_list[i]->length();
+	if (ts_list[i]->length() > max_len) max_len = ts_list[i]->length();
+      }
+      data_buffer = new float[num_waveforms * max_len];
+      data = new float *[num_waveforms];
       for (int i = 0; i < num_waveforms; i++) {
-	distmatrix[i] = distmatrix_buffer + i * num_waveforms; 
-	for (int j = 0; j < num_waveforms; j++) {
+	data[i] = data_buffer + i * max_len;
+	ts_list[i]->copyInto(data[i]);
+      }
+      int max_lag = (int)(MCCC_TAU_RANGE/ts_list[0]->segment(0)->tdel() + .5);
+
+      correlated = (allPairsCC(num_waveforms, m, data, max_lag, 0,
+			       ccmatrix, NULL) == 0);
+      if (!correlated) {
+	showWarning("Failed to correlate the waveforms.");
+      }
+    }
+    if (correlated) {
+      /* Fill in the lower triangle of distmatrix */  
+      distmatrix = trianglematrix(num_waveforms);
+ 
+      for (int i = 1; distmatrix && i < num_waveforms; i++) {
+	for (int j = 0; j < i; j++) {
 	  distmatrix[i][j] = (ccmatrix[i][j] - 1) * -1.;
 	}
       }
 
-      tree = treecluster(num_waveforms,
+      if (distmatrix) tree = treecluster(num_waveforms,
 			 num_waveforms,
 			 NULL,            /* not used if distmatrix given */
 			 NULL,            /* not used if distmatrix given */
@@ -608,16 +627,15 @@ void GCluster::compute(const Method mccc_method, const char cluster_method)
       }
 
       free(tree);
-      delete [] distmatrix_buffer;
-      delete [] distmatrix;
+      freetrianglematrix(distmatrix);
     }
 
     tab->setOnTop("All");
 
     setCursor("default");
 
-    delete [] ccmatrix_mask_buffer;
-    delete [] ccmatrix_mask;
+    delete [] data_buffer;
+    delete [] data;
     delete [] ccmatrix_buffer;
     delete [] ccmatrix;
     delete [] ts_list;
@@ -18,6 +18,7 @@ using namespace std;
 extern "C" {
 #include "libstring.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgcor;
 
@@ -419,6 +420,7 @@ void Correlation::setReference(void)
 
 void Correlation::compute(void)
 {
+    ProfileTimer pt("Correlation::compute");
     double duration = 0.;
     int i;
     bool partial_ts;
@@ -193,6 +193,7 @@ void QCData::applyqc(GTimeSeries *ts, Table *table)
 	    snprintf(&r[2][0], 25, "%d", j+1);
 	}
 	s = ts->segment(j);
+	s->unshare();
 	n = s->length();
 	if(extended) {
 	    qc_extended(&s->data, &n, 1, &qcdef, QC_EXTENDED_SS, &m);
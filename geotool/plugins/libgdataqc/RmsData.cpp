@@ -116,6 +116,7 @@ bool RmsData::applyMethod(int num_waveforms, GTimeSeries **ts)
 
 	rmsData(data, data_out, npts);
 
+	ts[l]->unshare();
 	k = 0;
 	for(int i = beg->index(); i <= i2; i++) {
 	    beg->segment()->data[i] = data_out[k++];
@@ -32,6 +32,8 @@ extern "C" {
 #include "libgmath.h"
 #include "libstring.h"
 }
+#include "ProfileTimer.h"
+
 #ifndef M_PI
 #define M_PI	3.14159265358979323846
 #endif
@@ -3243,6 +3245,7 @@ void FK::displayFirst(void)
 
 bool FK::compute(bool show_warning, bool redisplay)
 {
+    ProfileTimer pt("FK::compute");
     bool dis_data[2], dis_grid[2];
     int	i, windowed, num_bands, n_slowness;
     double slowness_max, tmin = 0., tmax = 0.;
@@ -23,6 +23,7 @@ extern "C" {
 #include "libtime.h"
 #include "tapers.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgfk;
 
@@ -525,6 +526,7 @@ int FKGram::setup(gvector<GSegmentArray*> *v, int window_overlap_npts)
 int FKGram::compute(gvector<Waveform *> &wvec, bool append,
 			double save_time_secs)
 {
+    ProfileTimer pt("FKGram::compute");
     int i, j, k, window_overlap_npts, nfks;
     FKData **fk_data = NULL;
 //    bool new_dt = false;
@@ -21,6 +21,7 @@ using namespace std;
 extern "C" {
 #include "libstring.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgft;
 
@@ -1547,6 +1548,7 @@ void FT::print(FILE *fp, PrintParam *p)
 
 void FT::compute(bool warning)
 {
+    ProfileTimer pt("FT::compute");
     int i, j, k, npts, total, num_waveforms;
     int pts, minpts;
     double dt, time;
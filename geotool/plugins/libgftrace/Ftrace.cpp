@@ -27,6 +27,7 @@ using namespace std;
 #include "Beam.h"
 #include "motif++/MotifClasses.h"
 #include "gobject++/GTimeSeries.h"
+#include "ProfileTimer.h"
 
 using namespace libgftrace;
 
@@ -195,6 +196,7 @@ void Ftrace::actionPerformed(ActionEvent *action_event)
 
 void Ftrace::compute(void)
 {
+    ProfileTimer pt("Ftrace::compute");
     int i, spts, npol;
     bool zp;
     double az, slowness, beam_lat, beam_lon, flo, fhi, snr;
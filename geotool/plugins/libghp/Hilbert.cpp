@@ -4,6 +4,8 @@
  */
 #include "config.h"
 #include <iostream>
+#include <stdlib.h>
+#include <string.h>
 #include "Hilbert.h"
 #include "gobject++/GTimeSeries.h"
 
@@ -13,11 +15,15 @@ extern "C" {
 
 namespace libghp {
 
-/**
- *
- *
+/** Constructor.
+ *  @param[in] output_type The output: the Hilbert transform, the envelope,
+ *	the instantaneous phase or the instantaneous frequency.
+ *  @param[in] block If > 0, transform in overlap-save blocks of this many
+ *	points, so that the memory does not grow with the segment length.
+ *	If 0, each segment is transformed whole (exact).
  */
-Hilbert::Hilbert(void) : DataMethod("Hilbert")
+Hilbert::Hilbert(HilbertOutput output_type, int block) : DataMethod("Hilbert"),
+		output_type(output_type), block(block)
 {
 }
 
@@ -27,35 +33,106 @@ Hilbert::~Hilbert(void)
 
 Gobject * Hilbert::clone()
 {
-    return (Gobject *) new Hilbert();
+    return (Gobject *) new Hilbert(output_type, block);
 }
 
 bool Hilbert::applyMethod(int num_waveforms, GTimeSeries **ts)
 {
-    int i, j;
+    int i, j, n, nsegs;
+    GSegment **segs;
 
     if(ts == NULL) {
 	logErrorMsg(LOG_WARNING, "Hilbert.apply: ts=NULL");
 	return false;
     }
-    for(i = 0; i < num_waveforms; i++)
-    {
-	for(j = 0; j < ts[i]->size(); j++) {
-	    applySegment(ts[i]->segment(j));
+    for(i = nsegs = 0; i < num_waveforms; i++) nsegs += ts[i]->size();
+    if(nsegs == 0) return true;
+
+    if( !(segs = (GSegment **)malloc(nsegs*sizeof(GSegment *))) ) {
+	logErrorMsg(LOG_WARNING, "Hilbert.apply: malloc failed.");
+	return false;
+    }
+    for(i = n = 0; i < num_waveforms; i++) {
+	for(j = 0; j < ts[i]->size(); j++) segs[n++] = ts[i]->segment(j);
+    }
+
+    // one batch for each run of segments with the same sample interval
+    for(i = 0; i < nsegs; i = j) {
+	for(j = i+1; j < nsegs && segs[j]->tdel() == segs[i]->tdel(); j++);
+	if( !applyBatch(j-i, segs+i) ) {
+	    free(segs);
+	    return false;
 	}
     }
+    free(segs);
     return true;
 }
 
-// static
-void Hilbert::applySegment(GSegment *s)
+bool Hilbert::applyBatch(int nsegs, GSegment **segs)
 {
-    Hilbert_data(s->length(), s->data);
+    int i, ret, *npts;
+    float **data, **y;
+    // the whole-trace transform can be returned in place
+    bool in_place = (output_type == HILBERT_TRANSFORM && block == 0);
+
+    npts = (int *)malloc(nsegs*sizeof(int));
+    data = (float **)malloc(nsegs*sizeof(float *));
+    y = (float **)calloc(nsegs, sizeof(float *));
+    if(!npts || !data || !y) {
+	logErrorMsg(LOG_WARNING, "Hilbert.apply: malloc failed.");
+	Free(npts); Free(data); Free(y);
+	return false;
+    }
+
+    for(i = 0; i < nsegs; i++) {
+	segs[i]->unshare();
+	npts[i] = segs[i]->length();
+	data[i] = segs[i]->data;
+	if(in_place) {
+	    y[i] = data[i];
+	}
+	else if( !(y[i] = (float *)malloc((npts[i] > 0 ? npts[i] : 1)
+				*sizeof(float))) )
+	{
+	    logErrorMsg(LOG_WARNING, "Hilbert.apply: malloc failed.");
+	    break;
+	}
+    }
+
+    ret = (i < nsegs) ? -1 :
+	analytic_batch(nsegs, npts, data, segs[0]->tdel(), block, 0,
+		(output_type == HILBERT_TRANSFORM) ? y : NULL,
+		(output_type == HILBERT_ENVELOPE) ? y : NULL,
+		(output_type == HILBERT_PHASE) ? y : NULL,
+		(output_type == HILBERT_FREQUENCY) ? y : NULL);
+
+    if(!in_place) {
+	for(i = 0; i < nsegs && y[i]; i++) {
+	    if(!ret) memcpy(data[i], y[i], npts[i]*sizeof(float));
+	    free(y[i]);
+	}
+    }
+    free(npts);
+    free(data);
+    free(y);
+    return !ret;
 }
 
 const char * Hilbert::toString(void)
 {
-    string_rep.assign("Hilbert transform.");
+    switch(output_type) {
+	case HILBERT_ENVELOPE:
+	    string_rep.assign("Hilbert envelope.");
+	    break;
+	case HILBERT_PHASE:
+	    string_rep.assign("Hilbert instantaneous phase.");
+	    break;
+	case HILBERT_FREQUENCY:
+	    string_rep.assign("Hilbert instantaneous frequency.");
+	    break;
+	default:
+	    string_rep.assign("Hilbert transform.");
+    }
     return string_rep.c_str();
 }
 
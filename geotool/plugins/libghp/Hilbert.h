@@ -8,10 +8,19 @@ class GSegment;
 
 namespace libghp {
 
+/** The output of the Hilbert method.
+ */
+enum HilbertOutput {
+    HILBERT_TRANSFORM,	//!< the Hilbert transform
+    HILBERT_ENVELOPE,	//!< the envelope of the analytic signal
+    HILBERT_PHASE,	//!< the instantaneous phase (radians)
+    HILBERT_FREQUENCY	//!< the instantaneous frequency (Hz)
+};
+
 class Hilbert : public DataMethod
 {
     public:
-	Hilbert(void);
+	Hilbert(HilbertOutput output_type=HILBERT_TRANSFORM, int block=0);
 	~Hilbert(void);
 
 	Gobject *clone();
@@ -19,9 +28,14 @@ class Hilbert : public DataMethod
 
 	bool applyMethod(int num_waveforms, GTimeSeries **ts);
 
+	HilbertOutput output(void) { return output_type; }
+	int blockLength(void) { return block; }
+
     protected:
+	HilbertOutput output_type;
+	int block;
 
-	static void applySegment(GSegment *s);
+	bool applyBatch(int nsegs, GSegment **segs);
 
     private:
 
@@ -85,6 +85,31 @@ void HilbertTransform::createInterface(void)
     XtSetArg(args[n], XmNset, True); n++;
     selected_toggle = new Toggle("Selected", input_rb, this, args, n);
 
+    output_label = new Label("Output", rc);
+    n = 0;
+    XtSetArg(args[n], XmNborderWidth, 1); n++;
+    XtSetArg(args[n], XtNorientation, XmHORIZONTAL); n++;
+    output_rb = new RadioBox("output_rb", rc, args, n);
+
+    n = 0;
+    XtSetArg(args[n], XmNshadowThickness, 0); n++;
+    XtSetArg(args[n], XmNset, True); n++;
+    hilbert_toggle = new Toggle("Hilbert", output_rb, this, args, n);
+    n = 0;
+    XtSetArg(args[n], XmNshadowThickness, 0); n++;
+    XtSetArg(args[n], XmNset, False); n++;
+    envelope_toggle = new Toggle("Envelope", output_rb, this, args, n);
+    phase_toggle = new Toggle("Phase", output_rb, this, args, n);
+    freq_toggle = new Toggle("Frequency", output_rb, this, args, n);
+
+    // overlap-save block length, or 0 for the whole-trace transform
+    block_label = new Label("Block", rc);
+    n = 0;
+    XtSetArg(args[n], XmNcolumns, 7); n++;
+    XtSetArg(args[n], XmNeditable, True); n++;
+    XtSetArg(args[n], XmNvalue, "0"); n++;
+    block_text = new TextField("block", rc, args, n);
+
     taper_window = new TaperWindow("Hilbert Transform Taper", this, 5, 5, 200);
 }
 
@@ -132,6 +157,29 @@ ParseCmd HilbertTransform::parseCmd(const string &cmd, string &msg)
 	}
 	else return ARGUMENT_ERROR;
     }
+    else if(parseArg(cmd, "Output", c)) {
+	if(parseCompare(c, "Hilbert")) {
+	    hilbert_toggle->set(true, true);
+	}
+	else if(parseCompare(c, "Envelope")) {
+	    envelope_toggle->set(true, true);
+	}
+	else if(parseCompare(c, "Phase")) {
+	    phase_toggle->set(true, true);
+	}
+	else if(parseCompare(c, "Frequency")) {
+	    freq_toggle->set(true, true);
+	}
+	else return ARGUMENT_ERROR;
+    }
+    else if(parseArg(cmd, "Block", c)) {
+	int block;
+	if(!stringToInt(c.c_str(), &block) || block < 0) {
+	    msg.assign("Invalid block (0 for the whole trace)");
+	    return ARGUMENT_ERROR;
+	}
+	block_text->setString(c, true);
+    }
     else if(parseString(cmd, "hilbert_transform_taper", c)
 		|| parseString(cmd, "taper", c))
     {
@@ -160,6 +208,15 @@ ParseVar HilbertTransform::parseVar(const string &name, string &value)
 	    value.assign("Selected");
 	}
     }
+    else if(parseCompare(name, "output")) {
+	if(envelope_toggle->state()) value.assign("Envelope");
+	else if(phase_toggle->state()) value.assign("Phase");
+	else if(freq_toggle->state()) value.assign("Frequency");
+	else value.assign("Hilbert");
+    }
+    else if(parseCompare(name, "block")) {
+	block_text->getString(value);
+    }
     else if(parseString(name, "taper", c)) {
         return taper_window->parseVar(c, value);
     }
@@ -174,6 +231,8 @@ void HilbertTransform::parseHelp(const char *prefix)
     printf("%sapply\n", prefix);
     printf("%sunfilter\n", prefix);
     printf("%sinput=(all,selected)\n", prefix);
+    printf("%soutput=(hilbert,envelope,phase,frequency)\n", prefix);
+    printf("%sblock=NPTS (0 for the whole trace)\n", prefix);
 }
 
 void HilbertTransform::apply(void)
@@ -195,6 +254,9 @@ void HilbertTransform::apply(void)
 	showWarning("No waveforms selected.");
 	return;
     }
+    int block;
+    if(!getBlock(&block)) return;
+
     setCursor("hourglass");
 
     npts = 0;
@@ -209,11 +271,16 @@ void HilbertTransform::apply(void)
 	working->setVisible(true);
     }
 
+    HilbertOutput output = HILBERT_TRANSFORM;
+    if(envelope_toggle->state()) output = HILBERT_ENVELOPE;
+    else if(phase_toggle->state()) output = HILBERT_PHASE;
+    else if(freq_toggle->state()) output = HILBERT_FREQUENCY;
+
     for(i = 0; i < num_waveforms; i++) {
 	DataMethod *dm[3];
 	dm[0] = new Demean();
 	dm[1] = getTaper();
-	dm[2] = new Hilbert();
+	dm[2] = new Hilbert(output, block);
 
 	wvec[i]->changeMethods(3, dm);
 
@@ -251,6 +318,23 @@ TaperData * HilbertTransform::getTaper(void)
     }
 }
 
+/** Get the overlap-save block length.
+ *  @param[out] block The block length, or 0 for the whole-trace transform.
+ *  @returns true if the Block field is valid.
+ */
+bool HilbertTransform::getBlock(int *block)
+{
+    if(block_text->empty()) {
+	*block = 0;
+	return true;
+    }
+    if(!block_text->getInt(block) || *block < 0) {
+	showWarning("Invalid block (0 for the whole trace).");
+	return false;
+    }
+    return true;
+}
+
 void HilbertTransform::unfilter(void)
 {
     int i, num_waveforms;
@@ -32,9 +32,11 @@ class HilbertTransform : public FormDialog, public DataReceiver
 	Button *close_button, *apply_button, *unfilter_button, *help_button;
 	Button *taper_button;
 	Separator *sep;
-	Label *label;
-	RadioBox *input_rb;
+	Label *label, *output_label, *block_label;
+	TextField *block_text;
+	RadioBox *input_rb, *output_rb;
 	Toggle *all_toggle, *selected_toggle;
+	Toggle *hilbert_toggle, *envelope_toggle, *phase_toggle, *freq_toggle;
 	TaperWindow *taper_window;
 
 	void actionPerformed(ActionEvent *action_event);
@@ -42,6 +44,7 @@ class HilbertTransform : public FormDialog, public DataReceiver
 	void apply(void);
 	void unfilter(void);
 	TaperData *getTaper(void);
+	bool getBlock(int *block);
 
     private:
 
@@ -53,6 +53,7 @@ void PolarFilter::createInterface(void)
     help_button = new Button("Help", controls, this);
     controls->setHelp(help_button);
 
+    envelope_toggle = new Toggle("Envelope", controls, this);
     rtd_compute_toggle = new Toggle("RTD Compute", controls, this);
     rtd_compute_toggle->setVisible(false);
 
@@ -327,6 +328,18 @@ ParseCmd PolarFilter::parseCmd(const string &cmd, string &msg)
 	}
 	recti_scaling->setString(c, true);
     }
+    else if(parseArg(cmd, "Envelope", c)) {
+	if(parseCompare(c, "true")) {
+	    envelope_toggle->set(true, true);
+	}
+	else if(parseCompare(c, "false")) {
+	    envelope_toggle->set(false, true);
+	}
+	else {
+	    msg.assign("Invalid envelope (true,false)");
+	    return ARGUMENT_ERROR;
+	}
+    }
     else if(parseCompare(cmd, "Help")) {
 	char prefix[200];
 	getParsePrefix(prefix, sizeof(prefix));
@@ -350,6 +363,7 @@ void PolarFilter::parseHelp(const char *prefix)
     printf("%sincidence=DEGREES\n", prefix);
     printf("%saperture=(1-8)\n", prefix);
     printf("%sscaling=(1-8)\n", prefix);
+    printf("%senvelope=(true,false)\n", prefix);
 }
 
 void PolarFilter::scale(Scale *sc)
@@ -425,6 +439,9 @@ void PolarFilter::apply(void)
     double	dt, tcycles, fc1, fc2, fcycles, apert, rect, thni, phi;
     double	nyquist;
     vector<double> scaled_y0;
+    vector<float *> seg_y;
+    vector<int> seg_npts;
+    vector<double> seg_tbeg, seg_tdel;
     gvector<GTimeSeries *> ts;
     GTimeSeries	*polar_ts;
     GSegment	*s;
@@ -569,14 +586,45 @@ void PolarFilter::apply(void)
 	npts = array->length();
 	for(i = 0; i < npts; i++) y[i] /= calib;
 
-	s = new GSegment(y, npts, array->tbeg(), array->tdel(), calib, calper);
-	Free(y);
-	polar_ts->addSegment(s);
+	seg_y.push_back(y);
+	seg_npts.push_back(npts);
+	seg_tbeg.push_back(array->tbeg());
+	seg_tdel.push_back(array->tdel());
 
 	array->deleteObject();
     }
     o->deleteObject();
 
+    /* the envelopes of all the segments, with one FFT work space
+     */
+    num = (int)seg_y.size();
+    if(envelope_toggle->state() && num > 0) {
+	vector<float *> env(num);
+	for(i = 0; i < num; i++) {
+	    env[i] = (float *)mallocWarn(seg_npts[i]*sizeof(float));
+	    if(!env[i]) break;
+	}
+	if(i < num || analytic_batch(num, &seg_npts[0], &seg_y[0], dt, 0, 0,
+			NULL, &env[0], NULL, NULL))
+	{
+	    showWarning("Cannot compute the envelope.");
+	    for(i = 0; i < num; i++) Free(env[i]);
+	}
+	else {
+	    for(i = 0; i < num; i++) {
+		Free(seg_y[i]);
+		seg_y[i] = env[i];
+	    }
+	}
+    }
+
+    for(i = 0; i < num; i++) {
+	s = new GSegment(seg_y[i], seg_npts[i], seg_tbeg[i], seg_tdel[i],
+			calib, calper);
+	Free(seg_y[i]);
+	polar_ts->addSegment(s);
+    }
+
     if(polar_ts->length() <= 0) {
 	delete polar_ts;
 	setCursor("default");
@@ -1000,18 +1048,15 @@ ellipse(float *z, float *n, float *e, int npts, double *values,
 	 *	vectors(3,3)	eigenvectors
 	 */
 	int i, j;
-	double s[9], d[3], o[3], v[9];
+	double s[9], d[3], v[9];
 
 	covar(npts, z, n, e, s);
 
 	/* 
 	 * compute eigenvectors and eigenvalues
+	 * eigenvalues are returned from eigen3 in ascending order
 	 */
-	tred2(3, s, d, o, v);
-	/*
-	 * eigenvalues are returned from tql2 in ascending order
-	 */
-	tql2(3, d, o, v);
+	eigen3(s, d, v);
 
 	/* order by descending eigenvalue and take sqrt
 	 */
@@ -38,7 +38,7 @@ class PolarFilter : public FormDialog, public DataReceiver
 
 	RowColumn *controls, *rc;
 	Button *close_button, *apply_button, *help_button;
-	Toggle *rtd_compute_toggle;
+	Toggle *rtd_compute_toggle, *envelope_toggle;
 	Separator *sep;
 	Label *label1, *label2, *label3, *label4, *label5, *label6, *label7;
 	Label *label8, *label9;
@@ -858,6 +858,12 @@ ParseCmd Locate::parseCmd(const string &cmd, string &msg)
     else if(parseCompare(cmd, "save")) {
 	saveOrigins();
     }
+    else if(parseCompare(cmd, "compile_tables")) {
+	if( !compileTables(msg) ) return ARGUMENT_ERROR;
+    }
+    else if(parseCompare(cmd, "remove_compiled_tables")) {
+	if( !removeCompiledTables(msg) ) return ARGUMENT_ERROR;
+    }
     else if(parseArg(cmd, "residual_colors", c)) {
 	if(!residuals_window) {
 	    residuals_window = new Residuals("Residual Colors", this);
@@ -1014,6 +1020,8 @@ void Locate::parseHelp(const char *prefix)
     printf("%sdefine_time_all\n", prefix);
     printf("%sdefine_time_none\n", prefix);
     printf("%sreload\n", prefix);
+    printf("%scompile_tables\n", prefix);
+    printf("%sremove_compiled_tables\n", prefix);
     char p[200];
     snprintf(p, sizeof(p), "%sorigins.", prefix);
     Table::parseHelp(p);
@@ -2496,6 +2504,63 @@ void Locate::saveOrigins(void)
     }
 }
 
+/** Compile the travel-time tables of the vmodel_spec_file for the acceptable
+ *  phases. A compiled file <vmodel>.ttc is written to the directory of each
+ *  velocity model, which setup_tt_facilities() then maps in place of the
+ *  text tables.
+ *  @param[out] msg an error message.
+ *  @returns true for success, false if the tables could not be read or the
+ *	compiled files could not be written.
+ */
+bool Locate::compileTables(string &msg)
+{
+    string prop;
+    char error[200];
+    int err;
+
+    if(!getProperty("locate.LocSAT.vmodel_spec_file", prop)) {
+	msg.assign("compile_tables: vmodel_spec_file is not defined.");
+	return false;
+    }
+    if((err = compile_tt_tables((char *)prop.c_str(), acceptable_phases,
+			num_acceptable_phases)) != OK)
+    {
+	snprintf(error, sizeof(error),
+		"compile_tables: cannot compile %s (error %d)", prop.c_str(), err);
+	msg.assign(error);
+	return false;
+    }
+    return true;
+}
+
+/** Remove the compiled travel-time tables written by compileTables(), so
+ *  that setup_tt_facilities() reads the text tables again.
+ *  @param[out] msg an error message.
+ *  @returns true for success, false if the vmodel_spec_file could not be
+ *	read or a compiled file could not be removed.
+ */
+bool Locate::removeCompiledTables(string &msg)
+{
+    string prop;
+    char error[200];
+    int err;
+
+    if(!getProperty("locate.LocSAT.vmodel_spec_file", prop)) {
+	msg.assign("remove_compiled_tables: vmodel_spec_file is not defined.");
+	return false;
+    }
+    if((err = remove_compiled_tt_tables((char *)prop.c_str(),
+			acceptable_phases, num_acceptable_phases)) != OK)
+    {
+	snprintf(error, sizeof(error),
+		"remove_compiled_tables: cannot remove %s tables (error %d)",
+		prop.c_str(), err);
+	msg.assign(error);
+	return false;
+    }
+    return true;
+}
+
 int Locate::getPathInfo(PathInfo **path_info)
 {
     PathInfo *path = (PathInfo *)mallocWarn(sizeof(PathInfo));
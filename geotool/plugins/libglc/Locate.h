@@ -331,6 +331,8 @@ class Locate : public Frame, public DataReceiver, public Parser
 	void setDefining(int col_index, const char *defining);
 	void columnMoved(void);
 	void saveOrigins(void);
+	bool compileTables(string &msg);
+	bool removeCompiledTables(string &msg);
 	void reload(void);
 	void loadResources(void);
 	Table *findTable(const char *name);
@@ -25,6 +25,7 @@ extern "C" {
 #include "libstring.h"
 #include "tapers.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgmccc;
 
@@ -266,6 +267,7 @@ void MultiChannelCC::print(FILE *fp, PrintParam *p)
 
 void MultiChannelCC::compute(Method method)
 {
+    ProfileTimer pt("MultiChannelCC::compute");
     double lag;
     double d, duration = 0.;
     int i, num_waveforms = 0, select_mode = 0;
@@ -33,6 +33,8 @@ extern "C" {
 #include "libgmath.h"
 #include "libstring.h"
 }
+#include "ProfileTimer.h"
+
 using namespace libgpolar;
 
 namespace libgpolar {
@@ -515,6 +517,7 @@ void Polarization::tieLimits(CPlotClass *cplot, AxesLimitsCallbackStruct *a)
 
 void Polarization::compute(void)
 {
+    ProfileTimer pt("Polarization::compute");
     int i, j, k, l, window_pts, window_width, windowed, ngroups,
 		n_windows, order, zp;
     vector<int> ncmpts;
@@ -524,9 +527,9 @@ void Polarization::compute(void)
     float *recti = NULL, *az = NULL, *slow = NULL, *incidence = NULL;
     double *x = NULL;
     char msg[1024], tlab[50], type[3];
-    double s[9], d[3], o[3], v[9], c[3][3];
+    double c[3][3];
     double a, x_min, x_max, diff, cursor_x, alpha, beta, gamma;
-    double vx, vy, vz, lo_cut, hi_cut;
+    double lo_cut, hi_cut;
     bool auto_param;
     gvector<Waveform *> wvec;
     Arg args[1];
@@ -712,49 +715,15 @@ void Polarization::compute(void)
 
 	scaleWaveforms(sa->npts, z, n, e); // not really needed
 
+	// rectilinearity, azimuth and incidence of every window, from
+	// running covariance sums
+	polar_trace(sa->npts, e, n, z, window_pts, rotated ? c : NULL, 0,
+			recti+l, az+l, incidence+l);
+
 	for(k = 0; k + window_width < sa->npts; k++, l++)
 	{
 	    // time of the middle of the window
 	    x[l] = sa->tmin + (k + .5*window_width)*dt;
-
-	    covar(window_pts, e+k, n+k, z+k, s);
-
-	    tred2(3, s, d, o, v);
-	    tql2(3, d, o, v);
-	    for(i = 0; i < 3; i++) if(d[i] < 0.) d[i] = 0.;
-/*
-	    d[0] = sqrt(d[0]);	// make units amp instead of power
-	    d[1] = sqrt(d[1]);
-	    d[2] = sqrt(d[2]);
-*/
-	    if(d[2] == 0.) {
-		recti[l] = 0.;
-	    }
-	    else {
-		recti[l] = 1. - .5*(d[0] + d[1])/d[2];
-	    }
-	    // If the stations Components are not E,N,UP, then find the
-	    // coordinates of the eignvector v[6],v[7],v[8] in the E,N,UP
-	    // coordinate system.
-	    if(rotated) {
-		vx = c[0][0]*v[6] + c[0][1]*v[7] + c[0][2]*v[8];
-		vy = c[1][0]*v[6] + c[1][1]*v[7] + c[1][2]*v[8];
-		vz = c[2][0]*v[6] + c[2][1]*v[7] + c[2][2]*v[8];
-		v[6] = vx;
-		v[7] = vy;
-		v[8] = vz;
-		vx = c[0][0]*v[0] + c[0][1]*v[1] + c[0][2]*v[2];
-		vy = c[1][0]*v[0] + c[1][1]*v[1] + c[1][2]*v[2];
-		vz = c[2][0]*v[0] + c[2][1]*v[1] + c[2][2]*v[2];
-		v[0] = vx;
-		v[1] = vy;
-		v[2] = vz;
-	    }
-
-	    i = (v[8] > 0.) ? -1 : 1;
-	    az[l] = atan2(i*v[6], i*v[7])/DEG_TO_RADIANS;
-	    i = (v[2] > 0.) ? -1 : 1;
-	    incidence[l] = acos(fabs(v[8]))/DEG_TO_RADIANS;
 	    slow[l] = ap->polar_alpha * sin(DEG_TO_RADIANS*incidence[l]/2.)
 			* DEG_TO_KM;
 	}
@@ -17,10 +17,12 @@ using namespace std;
 #include "motif++/MotifClasses.h"
 #include "libgx++.h"
 #include "Waveform.h"
+#include "mccc.h"
 
 extern "C" {
 #include "cluster.h"
 }
+#include "ProfileTimer.h"
 
 
 /* Self Scanning Algorithm (see Exploring the limits of waveform correlation 
@@ -352,15 +354,36 @@ void SelfScan::print(FILE *fp, PrintParam *p)
     Free(a);
 }
 
+/* Return the index, counting the samples of all segments, of the sample of
+ * ts nearest to time t, or -1 if t is after the last sample.
+ */
+static int
+sampleIndex(GTimeSeries *ts, double t)
+{
+    int n = 0;
+
+    for (int i = 0; i < ts->size(); i++) {
+      GSegment *seg = ts->segment(i);
+      double tdel = seg->tdel();
+      if (t - .5*tdel <= seg->tend()) {
+	int j = (int)ceil((t - seg->tbeg())/tdel - .5);
+	return n + ((j > 0) ? j : 0);
+      }
+      n += seg->length();
+    }
+    return -1;
+}
+
 void SelfScan::compute(const char cluster_method)
 {
+    ProfileTimer pt("SelfScan::compute");
     SelfScanParam cp = SELFSCAN_PARAM_NULL;
     int select_mode = 0;
     gvector<Waveform *> wvec;
-    GTimeSeries *ts = NULL, *ts_red = NULL, *ts_green = NULL, *ts_segment = NULL;
+    GTimeSeries *ts = NULL, *ts_red = NULL, *ts_segment = NULL;
     int num_segments = 0;
     double *location = NULL;
-    double **distmatrix = NULL, *distmatrix_buffer = NULL;
+    double **distmatrix = NULL;
     double *max_coefs = NULL;
     Node *tree = NULL;
     Arg args[30];
@@ -414,6 +437,18 @@ void SelfScan::compute(const char cluster_method)
 		  max_segments);
     }
 
+    /* Allocate and initialize the lower triangle of distmatrix for clustering */
+    if (!(distmatrix = trianglematrix(max_segments))) {
+      showWarning("Cannot allocate the distance matrix for %d segments.",
+		  max_segments);
+      return;
+    }
+    for (int i = 1; i < max_segments; i++) {
+      for (int j = 0; j < i; j++) {
+	distmatrix[i][j] = 0.0;
+      }
+    }
+
     /* Allocate selfscan structure */
     if(!selfscan) selfscan = (SelfScanStruct *)mallocWarn(sizeof(SelfScanStruct));
     selfscan = (SelfScanStruct *)reallocWarn(selfscan, (num_selfscan+max_segments) *  sizeof(SelfScanStruct));
@@ -421,18 +456,6 @@ void SelfScan::compute(const char cluster_method)
     /* Allocate and initialize location vector for matching data segments */
     location = new double[max_segments];
 
-    /* Allocate and initialize distmatrix for clustering */
-    distmatrix_buffer = new double[max_segments * max_segments];
-    distmatrix = new double *[max_segments];
-    for (int i = 0; i < max_segments; i++) {
-      distmatrix[i] = distmatrix_buffer + i * max_segments; 
-    }
-    for (int i = 0; i < max_segments; i++) {
-      for (int j = 0; j < max_segments; j++) {
-	distmatrix[i][j] = 0.0;
-      }
-    }
-
     /* Allocate and initialize maximum coefficient vector */
     max_coefs = new double[max_segments];
     for (int i = 0; i < max_segments; ++i) {
@@ -441,121 +464,142 @@ void SelfScan::compute(const char cluster_method)
 
     setCursor("hourglass");
 
-    /* Locate matching data segments */
+    /* The red windows start every half window length. Each red window is
+     * correlated with the green window that starts at every later sample,
+     * and each green window is normalized by its own energy. The
+     * coefficients of all green windows of a red window come from one FFT
+     * correlation with the whole trace (slidingCC).
+     */
+    int n = ts->length();
+    int m = 0;
+    if ((ts_red = ts->subseries(ts->tbeg(), ts->tbeg() + cp.windowlength))) {
+      m = ts_red->length();
+      ts_red->deleteObject();
+    }
+
+    int num_red = 0;
     for (double t = ts->tbeg();
 	 t + cp.windowlength <= ts->tend();
 	 t += cp.windowlength/2 /* red window length / 2 */
 	 ) {
+      num_red++;
+    }
+    double *red_time = new double[num_red];
+    int *red_index = new int[num_red];
 
-      if (num_segments >= max_segments) break;
-
-      ts_red = ts->subseries(t, t + cp.windowlength);
+    num_red = 0;
+    for (double t = ts->tbeg();
+	 t + cp.windowlength <= ts->tend();
+	 t += cp.windowlength/2
+	 ) {
+      int i = sampleIndex(ts, t);
+      if (i < 0 || i + m > n) continue;
+      red_time[num_red] = t;
+      red_index[num_red++] = i;
+    }
 
-      if (ts_red == NULL) continue;
+    /* Correlate the red windows in groups, to limit the coefficient
+     * memory to a few million values
+     */
+    int nlag = n - m + 1;
+    int group = (m > 0) ? (1 << 22)/nlag : 0;
+    if (group < 1) group = 1;
+    if (group > num_red) group = num_red;
+
+    float *trace = new float[n];
+    const float **red_data = new const float *[group];
+    double *coef_buffer = new double[(size_t)group * nlag];
+    double **coef = new double *[group];
+    ts->copyInto(trace);
+    for (int i = 0; i < group; i++) coef[i] = coef_buffer + (size_t)i * nlag;
 
-      float *data_red = new float[ts_red->length()];
-      double sigma_red = 0.0;
+    /* Locate matching data segments */
+    for (int g = 0; m > 0 && g < num_red && num_segments + 2 <= max_segments;
+	 g += group) {
+      int ng = (g + group <= num_red) ? group : num_red - g;
 
-      ts_red->copyInto(data_red);
+      for (int i = 0; i < ng; i++) red_data[i] = trace + red_index[g + i];
 
-      for (int i = 0; i < ts_red->length(); i++) {
-	sigma_red += pow(data_red[i], 2);
+      if (slidingCC(ng, m, red_data, n, trace, 0, coef)) {
+	showWarning("Failed to correlate the red windows.");
+	break;
       }
-      sigma_red = sqrt(sigma_red);
-
-      for (double t2 = t; /* red window start time */
-	   t2 + cp.windowlength <= ts->tend();
-	   t2 += (1/((double)ts->length()/ts->duration())) /* 1 sample */
-	   ) {
 
-	if (num_segments >= max_segments) break;
+      for (int i = 0; i < ng; i++) {
+	double t = red_time[g + i]; /* red window start time */
 
-	ts_green = ts->subseries(t2, t2 + cp.windowlength);
+	for (int k = red_index[g + i]; k < nlag; k++) {
 
-	if (ts_green == NULL) continue;
+	  /* Each match can add two segments */
+	  if (num_segments + 2 > max_segments) break;
 
-	float *data_green = new float[ts_green->length()];
-	double sigma_green = 0.0;
-	double coef = 0.0;
-	int n = ts_red->length();
+	  double t2 = ts->time(k); /* green window start time */
+	  double c = coef[i][k];
 
-	ts_green->copyInto(data_green);
-
-	for (int i = 0; i < ts_green->length(); i++) {
-	  sigma_green += pow(data_green[i], 2);
-	}
-	sigma_green = sqrt(sigma_green);
+	  /* if correlation coefficient is larger than threshold */
+	  if ((c > cp.min_corr_th) && (t != t2)) {
 
-	/* Calculate correlation coefficient */
-	for (int i = 0; i < n; i++) {
-	  coef += data_red[i] * data_green[i];
-	}
-	coef = coef / (sigma_red * sigma_green);
-	
-	/* if correlation coefficient is larger than threshold */
-	if ((coef > cp.min_corr_th) && (t != t2)) {
+	    int t_index, t2_index;
 
-	  int t_index, t2_index;
+	    /* Find location t in location vector or first free spot */
+	    /* Start at 1 to avoid diagonal in symmetric matrix */
+	    for (t_index = 1; t_index < num_segments; t_index++) {
+	      if (t == location[t_index]) break;
+	    }
+	    if (t_index == num_segments) {
+	      num_segments++;
+	    }
+	    if (t != location[t_index]) {
+	      location[t_index] = t;
+	    }
 
-	  /* Find location t in location vector or first free spot */
-	  /* Start at 1 to avoid diagonal in symmetric matrix */
-	  for (t_index = 1; t_index < num_segments; t_index++) {
-	    if (t == location[t_index]) break;
-	  }
-	  if (t_index == num_segments) {
-	    num_segments++;
-	  }
-	  if (t != location[t_index]) {
-	    location[t_index] = t;
-	  }
+	    /* Find location t2 in location vector or first free spot */
+	    /* Fill lower left part of symmetric matrix */
+	    for (t2_index = 0; t2_index < num_segments; t2_index++) {
+	      if (t2 == location[t2_index]) break;
+	    }
+	    if (t2_index == num_segments) {
+	      num_segments++;
+	    }
+	    if (t2 != location[t2_index]) {
+	      location[t2_index] = t2;
+	    }
 
-	  /* Find location t2 in location vector or first free spot */
-	  /* Fill lower left part of symmetric matrix */
-	  for (t2_index = 0; t2_index < num_segments; t2_index++) {
-	    if (t2 == location[t2_index]) break;
-	  }
-	  if (t2_index == num_segments) {
-	    num_segments++;
-	  }
-	  if (t2 != location[t2_index]) {
-	    location[t2_index] = t2;
-	  }
+	    int x, y;
 
-	  int x, y;
+	    /* Determine distmatrix coordinates */
+	    if (t_index < t2_index) {
+	      x = t2_index;
+	      y = t_index;
+	    }
+	    else {
+	      x = t_index;
+	      y = t2_index;
+	    }
 
-	  /* Determine distmatrix coordinates */
-	  if (t_index < t2_index) {
-	    x = t2_index;
-	    y = t_index;
-	  }
-	  else {
-	    x = t_index;
-	    y = t2_index;
-	  }
+	    /* Fill in distmatrix, which has no diagonal */
+	    if (x != y) distmatrix[x][y] = c;
 
-	  /* Fill in distmatrix */
-	  distmatrix[x][y] = coef;
+	    /* Save maximum coefficient */
+	    if (c > max_coefs[t_index]) max_coefs[t_index] = c;
+	    if (c > max_coefs[t2_index]) max_coefs[t2_index] = c;
 
-	  /* Save maximum coefficient */
-	  if (coef > max_coefs[t_index]) max_coefs[t_index] = coef;
-	  if (coef > max_coefs[t2_index]) max_coefs[t2_index] = coef;
+	    /*
+	    printf("DEBUG: red %f %d matches green %f %d with coef = %f, x = %d, y = %d\n", t, t_index, t2, t2_index, c, x, y);
+	    */
 
-	  /*
-	  printf("DEBUG: red %f %d matches green %f %d with coef = %f, x = %d, y = %d\n", t, t_index, t2, t2_index, coef, x, y);
-	  */
-	  
+	  }
 	}
-
-	delete [] data_green;
-	ts_green->deleteObject();
-	
       }
-
-      delete [] data_red;
-      ts_red->deleteObject();
-
     }
 
+    delete [] red_time;
+    delete [] red_index;
+    delete [] trace;
+    delete [] red_data;
+    delete [] coef_buffer;
+    delete [] coef;
+
     setCursor("default");
 
     if (num_segments < cp.nclusters) {
@@ -663,8 +707,7 @@ void SelfScan::compute(const char cluster_method)
       Free(tree);
     }
 
-    delete [] distmatrix_buffer;
-    delete [] distmatrix;
+    freetrianglematrix(distmatrix);
     delete [] location;
     
     if (select_mode == 1) {
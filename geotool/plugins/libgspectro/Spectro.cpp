@@ -28,6 +28,7 @@ extern "C" {
 #include "libstring.h"
 #include "tapers.h"
 }
+#include "ProfileTimer.h"
 
 using namespace libgspectro;
 
@@ -613,6 +614,7 @@ void Spectro::setDataSource(DataSource *ds)
 
 void Spectro::compute(bool warning)
 {
+    ProfileTimer pt("Spectro::compute");
     int num_waveforms, windowed;
     GTimeSeries *ts;
     gvector<Waveform *> wvec;
@@ -0,0 +1,172 @@
+/** \file bench.cpp
+ *  \brief Times the data reading, processing and location libraries.
+ *
+ *  bench runs without a display. It times the readers of libgio and
+ *  libgx++, the css table reader of libgobject++, the ca decoder of
+ *  libcancomp, the data methods of libgmethod++ and libgresp++, GTimeSeries,
+ *  the FK and beam of libgbeam, the correlation of the Correlation plugin
+ *  and of libmccc, and the batch routines of libgeog, libloc and
+ *  libmagnitude. It reads the test_data files and also makes synthetic data
+ *  sets whose size grows with scale=.
+ *
+ *  Each result is printed as one JSON object per line:
+ *  <pre>
+ *  {"version":"2.1.46","host":"h","bench":"iir_filter","data":"synthetic",
+ *   "n":4000000,"units":"samples","reps":5,"mean":0.0412,"best":0.0405,
+ *   "rate":9.88e+07}
+ *  </pre>
+ *  n is the work of one repetition and rate is n/best. A benchmark that
+ *  cannot be run has "skipped" with the reason instead of the times.
+ */
+#include "config.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "bench.h"
+
+using namespace std;
+
+static char host[64];
+
+static void
+usage(void)
+{
+    cerr << "Usage: bench [data=test_data_dir] [reps=5] [scale=1] [threads=0] [only=name]" << endl
+	<< "	[seed=file] [gse=file] [vmodel=vmodel_spec_file] [sasc=sasc_dir_prefix]" << endl
+	<< "	[tlmodel=file] [mdf=file] [magtype=mb] [amptype=A5/2]" << endl;
+}
+
+int
+main(int argc, const char **argv)
+{
+    BenchArgs a;
+    char *geotool_home;
+
+    for(int i = 1; i < argc; i++) {
+	if(!strncmp(argv[i], "data=", 5)) {
+	    a.data_dir = argv[i]+5;
+	}
+	else if(!strncmp(argv[i], "reps=", 5)) {
+	    a.reps = atoi(argv[i]+5);
+	}
+	else if(!strncmp(argv[i], "scale=", 6)) {
+	    a.scale = atoi(argv[i]+6);
+	}
+	else if(!strncmp(argv[i], "threads=", 8)) {
+	    a.threads = atoi(argv[i]+8);
+	}
+	else if(!strncmp(argv[i], "only=", 5)) {
+	    a.only = argv[i]+5;
+	}
+	else if(!strncmp(argv[i], "seed=", 5)) {
+	    a.seed_file = argv[i]+5;
+	}
+	else if(!strncmp(argv[i], "gse=", 4)) {
+	    a.gse_file = argv[i]+4;
+	}
+	else if(!strncmp(argv[i], "vmodel=", 7)) {
+	    a.vmodel = argv[i]+7;
+	}
+	else if(!strncmp(argv[i], "sasc=", 5)) {
+	    a.sasc_dir = argv[i]+5;
+	}
+	else if(!strncmp(argv[i], "tlmodel=", 8)) {
+	    a.tl_model = argv[i]+8;
+	}
+	else if(!strncmp(argv[i], "mdf=", 4)) {
+	    a.mdf = argv[i]+4;
+	}
+	else if(!strncmp(argv[i], "magtype=", 8)) {
+	    a.magtype = argv[i]+8;
+	}
+	else if(!strncmp(argv[i], "amptype=", 8)) {
+	    a.amptype = argv[i]+8;
+	}
+	else {
+	    usage();
+	    return 1;
+	}
+    }
+    if(a.reps < 1 || a.scale < 1) {
+	usage();
+	return 1;
+    }
+    if(a.gse_file.empty()) {
+	a.gse_file = a.data_dir + "/20183590.gse.gz";
+    }
+    /* the tables of an installation, as found by geotool */
+    if( (geotool_home = getenv("GEOTOOL_HOME")) ) {
+	string home(geotool_home);
+	if(a.vmodel.empty()) a.vmodel = home + "/tables/data/TT/vmsf/idc.defs";
+	if(a.sasc_dir.empty()) a.sasc_dir = home + "/tables/data/SASC/sasc";
+    }
+
+    if(gethostname(host, sizeof(host)-1)) strcpy(host, "-");
+    host[sizeof(host)-1] = '\0';
+
+    benchRead(&a);
+    benchMethods(&a);
+    benchLocate(&a);
+
+    return 0;
+}
+
+void BenchTimer::start(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    t0 = tv.tv_sec + 1.e-06*tv.tv_usec;
+}
+
+void BenchTimer::stop(void)
+{
+    struct timeval tv;
+    double t;
+
+    gettimeofday(&tv, NULL);
+    t = tv.tv_sec + 1.e-06*tv.tv_usec - t0;
+    total += t;
+    if(best < 0. || t < best) best = t;
+    num++;
+}
+
+/** Return true if the benchmark name is to be run. */
+bool
+benchWanted(BenchArgs *a, const char *name)
+{
+    return a->only.empty() || strstr(name, a->only.c_str()) != NULL;
+}
+
+/** Print the result of a benchmark.
+ *  @param[in] name The benchmark name.
+ *  @param[in] data The data set.
+ *  @param[in] n The work of one repetition, in units.
+ *  @param[in] units The units of n.
+ *  @param[in] t The timer of the repetitions.
+ */
+void
+benchReport(const char *name, const char *data, double n, const char *units,
+		BenchTimer &t)
+{
+    if(t.num <= 0) return;
+
+    printf("{\"version\":\"%s\",\"host\":\"%s\",\"bench\":\"%s\",\
+\"data\":\"%s\",\"n\":%.0f,\"units\":\"%s\",\"reps\":%d,\"mean\":%.6g,\
+\"best\":%.6g,\"rate\":%.6g}\n", PACKAGE_VERSION, host, name, data, n, units,
+		t.num, t.total/t.num, t.best, (t.best > 0.) ? n/t.best : 0.);
+    fflush(stdout);
+}
+
+/** Print a benchmark that was not run. */
+void
+benchSkip(const char *name, const char *data, const char *reason)
+{
+    printf("{\"version\":\"%s\",\"host\":\"%s\",\"bench\":\"%s\",\
+\"data\":\"%s\",\"skipped\":\"%s\"}\n", PACKAGE_VERSION, host, name, data,
+		reason);
+    fflush(stdout);
+}
@@ -0,0 +1,60 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <stdio.h>
+#include <string>
+
+using namespace std;
+
+/** The arguments of the bench program.
+ */
+class BenchArgs
+{
+    public:
+	string	data_dir;	//!< the test_data directory
+	string	seed_file;	//!< a SEED volume for the seed_read benchmark
+	string	gse_file;	//!< a GSE2.0 file for the gse_read benchmark
+	string	vmodel;		//!< the vmodel_spec_file for locate_event
+	string	sasc_dir;	//!< the SASC directory prefix for locate_event
+	string	tl_model;	//!< the TL model file for calc_mags
+	string	mdf;		//!< the magnitude description file
+	string	magtype;	//!< the magtype for calc_mags
+	string	amptype;	//!< the detection amptype of magtype
+	string	only;		//!< run only benchmarks whose name has this
+	int	reps;		//!< the number of timed repetitions
+	int	scale;		//!< the size of the synthetic data sets
+	int	threads;	//!< the threads of the batch benchmarks
+
+	BenchArgs(void) : data_dir("."), magtype("mb"), amptype("A5/2"),
+		reps(5), scale(1), threads(0) { }
+};
+
+/** Start and stop a timer. Each repetition is timed separately, so the
+ *  fastest repetition is reported with the mean.
+ */
+class BenchTimer
+{
+    public:
+	BenchTimer(void) : total(0.), best(-1.), num(0), t0(0.) { }
+
+	void start(void);
+	void stop(void);
+
+	double	total;
+	double	best;
+	int	num;
+
+    protected:
+	double	t0;
+};
+
+bool benchWanted(BenchArgs *a, const char *name);
+void benchReport(const char *name, const char *data, double n,
+		const char *units, BenchTimer &t);
+void benchSkip(const char *name, const char *data, const char *reason);
+
+void benchRead(BenchArgs *a);
+void benchMethods(BenchArgs *a);
+void benchLocate(BenchArgs *a);
+
+#endif
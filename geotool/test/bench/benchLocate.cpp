@@ -0,0 +1,458 @@
+/** \file benchLocate.cpp
+ *  \brief Times the distance, location and magnitude routines on a
+ *  synthetic bulletin.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "bench.h"
+#include "gobject++/Gobject.h"
+extern "C" {
+#include "ibase/libloc.h"
+#include "ibase/libgeog.h"
+#include "ibase/libmagnitude.h"
+#include "ibase/site_Astructs.h"
+#include "ibase/origin_Astructs.h"
+#include "ibase/origerr_Astructs.h"
+#include "ibase/arrival_Astructs.h"
+#include "ibase/assoc_Astructs.h"
+}
+
+/* The synthetic network and bulletin. */
+#define NUM_SITES	60
+#define BULLETIN_TIME	1.e+09
+
+typedef struct
+{
+    Site	*sites;
+    int		nsta;
+    Loc_Event	*events;
+    Origin	*start;		// the starting origins
+    int		nev;
+} Bulletin;
+
+static void distAzimuth(BenchArgs *a);
+static Site *network(int nsta);
+static bool makeBulletin(BenchArgs *a, Locator_params *lp, Bulletin *b);
+static void freeBulletin(Bulletin *b);
+static void resetOrigins(Bulletin *b, bool no_start);
+static void locate(BenchArgs *a);
+static void magnitudes(BenchArgs *a);
+
+void
+benchLocate(BenchArgs *a)
+{
+    if(benchWanted(a, "dist_azimuth")) distAzimuth(a);
+    if(benchWanted(a, "locate")) locate(a);
+    if(benchWanted(a, "calc_mags")) magnitudes(a);
+}
+
+/* The distances and azimuths from 100*scale stations to 1000 events, one
+ * pair at a time with dist_azimuth() and as a matrix with
+ * dist_azimuth_batch() on one and on all threads.
+ */
+static void
+distAzimuth(BenchArgs *a)
+{
+    BenchTimer t1, t2, t3;
+    int i, j, k, nsta = 100*a->scale, nev = 1000;
+    double *slat, *slon, *elat, *elon, *delta, *azi, *baz, n;
+    Geog_Points *sta = NULL, *ev = NULL;
+
+    slat = (double *)malloc(nsta*sizeof(double));
+    slon = (double *)malloc(nsta*sizeof(double));
+    elat = (double *)malloc(nev*sizeof(double));
+    elon = (double *)malloc(nev*sizeof(double));
+    delta = (double *)malloc(nsta*nev*sizeof(double));
+    azi = (double *)malloc(nsta*nev*sizeof(double));
+    baz = (double *)malloc(nsta*nev*sizeof(double));
+
+    if(slat && slon && elat && elon && delta && azi && baz)
+    {
+	srand48(41);
+	for(i = 0; i < nsta; i++) {
+	    slat[i] = 180.*drand48() - 90.;
+	    slon[i] = 360.*drand48() - 180.;
+	}
+	for(i = 0; i < nev; i++) {
+	    elat[i] = 180.*drand48() - 90.;
+	    elon[i] = 360.*drand48() - 180.;
+	}
+	n = (double)nsta*nev;
+
+	for(k = 0; k < a->reps; k++) {
+	    t1.start();
+	    for(i = 0; i < nsta; i++) {
+		for(j = 0; j < nev; j++) {
+		    dist_azimuth(slat[i], slon[i], elat[j], elon[j],
+			&delta[i*nev+j], &azi[i*nev+j], &baz[i*nev+j], 0);
+		}
+	    }
+	    t1.stop();
+	}
+	benchReport("dist_azimuth", "synthetic", n, "pairs", t1);
+
+	if( (sta = geog_points(slat, slon, nsta)) &&
+	    (ev = geog_points(elat, elon, nev)) )
+	{
+	    for(k = 0; k < a->reps; k++) {
+		t2.start();
+		dist_azimuth_batch(sta, ev, delta, azi, baz, 1);
+		t2.stop();
+	    }
+	    benchReport("dist_azimuth_batch", "synthetic", n, "pairs", t2);
+
+	    for(k = 0; k < a->reps; k++) {
+		t3.start();
+		dist_azimuth_batch(sta, ev, delta, azi, baz, a->threads);
+		t3.stop();
+	    }
+	    benchReport("dist_azimuth_batch_threads", "synthetic", n, "pairs",
+			t3);
+	}
+	free_geog_points(sta);
+	free_geog_points(ev);
+    }
+    Free(slat); Free(slon); Free(elat); Free(elon);
+    Free(delta); Free(azi); Free(baz);
+}
+
+/* Stations spread over the Earth.
+ */
+static Site *
+network(int nsta)
+{
+    Site na_site = Na_Site_Init;
+    Site *sites;
+
+    if( !(sites = (Site *)malloc(nsta*sizeof(Site))) ) return NULL;
+
+    srand48(31);
+    for(int i = 0; i < nsta; i++) {
+	sites[i] = na_site;
+	snprintf(sites[i].sta, sizeof(sites[i].sta), "S%03d", i);
+	sites[i].lat = 180.*drand48() - 90.;
+	sites[i].lon = 360.*drand48() - 180.;
+	sites[i].elev = 0.;
+    }
+    return sites;
+}
+
+/* Make 100*scale events for the stations b->sites, each with the P
+ * arrivals of the stations within 95 degrees. The arrival times are the
+ * predicted times plus up to 0.5s of noise. The starting origins are one
+ * degree and 5 seconds off.
+ */
+static bool
+makeBulletin(BenchArgs *a, Locator_params *lp, Bulletin *b)
+{
+    Origin na_origin = Na_Origin_Init;
+    Origerr na_origerr = Na_Origerr_Init;
+    Arrival na_arrival = Na_Arrival_Init;
+    Assoc na_assoc = Na_Assoc_Init;
+    Ar_Info ar_info;
+    int i, j, n, arid = 1;
+    double lat, lon, time, delta, esaz, seaz, tt, slow;
+
+    b->nev = 100*a->scale;
+    b->events = (Loc_Event *)calloc(b->nev, sizeof(Loc_Event));
+    b->start = (Origin *)malloc(b->nev*sizeof(Origin));
+    if(!b->events || !b->start) return false;
+
+    srand48(33);
+    for(i = 0; i < b->nev; i++)
+    {
+	Loc_Event *e = &b->events[i];
+
+	lat = 140.*drand48() - 70.;
+	lon = 360.*drand48() - 180.;
+	time = BULLETIN_TIME + i*3600.;
+
+	e->arrival = (Arrival *)malloc(b->nsta*sizeof(Arrival));
+	e->assoc = (Assoc *)malloc(b->nsta*sizeof(Assoc));
+	e->ar_info = (Ar_Info *)malloc(b->nsta*sizeof(Ar_Info));
+	e->origin = (Origin *)malloc(sizeof(Origin));
+	e->origerr = (Origerr *)malloc(sizeof(Origerr));
+	if(!e->arrival || !e->assoc || !e->ar_info || !e->origin
+		|| !e->origerr) return false;
+
+	*e->origerr = na_origerr;
+	e->origerr->orid = i+1;
+
+	for(j = n = 0; j < b->nsta; j++)
+	{
+	    dist_azimuth(lat, lon, b->sites[j].lat, b->sites[j].lon, &delta,
+			&esaz, &seaz, 0);
+	    if(delta > 95.) continue;
+
+	    tt = compute_ttime_w_corrs(lp, b->sites, FALSE, lat, lon, 0.,
+			delta, esaz, (char *)"P", j, &ar_info, &slow);
+	    if(tt <= 0.) continue;
+
+	    e->arrival[n] = na_arrival;
+	    e->arrival[n].arid = arid;
+	    strcpy(e->arrival[n].sta, b->sites[j].sta);
+	    strcpy(e->arrival[n].iphase, "P");
+	    e->arrival[n].time = time + tt + drand48() - .5;
+	    e->arrival[n].deltim = 1.;
+
+	    e->assoc[n] = na_assoc;
+	    e->assoc[n].arid = arid++;
+	    e->assoc[n].orid = i+1;
+	    strcpy(e->assoc[n].sta, b->sites[j].sta);
+	    strcpy(e->assoc[n].phase, "P");
+	    strcpy(e->assoc[n].timedef, "d");
+	    strcpy(e->assoc[n].azdef, "n");
+	    strcpy(e->assoc[n].slodef, "n");
+	    n++;
+	}
+	e->num_obs = n;
+
+	b->start[i] = na_origin;
+	b->start[i].orid = i+1;
+	b->start[i].evid = i+1;
+	b->start[i].lat = lat + 1.;
+	b->start[i].lon = lon + 1.;
+	b->start[i].depth = 0.;
+	b->start[i].time = time + 5.;
+    }
+    return true;
+}
+
+static void
+freeBulletin(Bulletin *b)
+{
+    if(b->events) {
+	for(int i = 0; i < b->nev; i++) {
+	    Free(b->events[i].arrival);
+	    Free(b->events[i].assoc);
+	    Free(b->events[i].ar_info);
+	    Free(b->events[i].origin);
+	    Free(b->events[i].origerr);
+	}
+    }
+    Free(b->events);
+    Free(b->start);
+    Free(b->sites);
+}
+
+/* Set the origins to the starting origins, or if no_start, to origins
+ * without a location, for the grid search.
+ */
+static void
+resetOrigins(Bulletin *b, bool no_start)
+{
+    for(int i = 0; i < b->nev; i++) {
+	*b->events[i].origin = b->start[i];
+	if(no_start) {
+	    b->events[i].origin->lat = -999.;
+	    b->events[i].origin->lon = -999.;
+	    b->events[i].origin->time = -9999999999.999;
+	}
+    }
+}
+
+/* Locate the synthetic bulletin one event at a time with locate_event(),
+ * with locate_events() on all threads, and with locate_events() from the
+ * default grid when there is no starting location.
+ */
+static void
+locate(BenchArgs *a)
+{
+    BenchTimer t1, t2, t3;
+    Locator_params lp;
+    Loc_Grid grid;
+    Bulletin b;
+    char *phases[1] = {(char *)"P"};
+    int i, k;
+
+    if(a->vmodel.empty()) {
+	benchSkip("locate_event", "synthetic", "no vmodel= or GEOTOOL_HOME");
+	return;
+    }
+    memset(&b, 0, sizeof(b));
+    lp = initialize_loc_params();
+    lp.verbose = '0';
+    lp.prefix = (char *)a->vmodel.c_str();
+    strcpy(lp.test_site_region, "-");
+
+    b.nsta = NUM_SITES;
+    if( !(b.sites = network(b.nsta)) ) return;
+
+    if(setup_tt_facilities(lp.prefix, phases, 1, b.sites, b.nsta) != OK) {
+	benchSkip("locate_event", "synthetic", "cannot read the T-T tables");
+	Free(b.sites);
+	return;
+    }
+    if( !a->sasc_dir.empty() ) read_sasc((char *)a->sasc_dir.c_str());
+
+    if( !makeBulletin(a, &lp, &b) ) {
+	benchSkip("locate_event", "synthetic", "out of memory");
+	freeBulletin(&b);
+	return;
+    }
+
+    for(k = 0; k < a->reps; k++) {
+	resetOrigins(&b, false);
+	t1.start();
+	for(i = 0; i < b.nev; i++) {
+	    Loc_Event *e = &b.events[i];
+	    locate_event(b.sites, b.nsta, e->arrival, e->assoc, e->origin,
+			e->origerr, &lp, e->ar_info, e->num_obs);
+	}
+	t1.stop();
+    }
+    benchReport("locate_event", "synthetic", (double)b.nev, "events", t1);
+
+    for(k = 0; k < a->reps; k++) {
+	resetOrigins(&b, false);
+	t2.start();
+	locate_events(b.sites, b.nsta, b.events, b.nev, &lp, NULL,
+			a->threads);
+	t2.stop();
+    }
+    benchReport("locate_events", "synthetic", (double)b.nev, "events", t2);
+
+    grid = initialize_loc_grid();
+    for(k = 0; k < a->reps; k++) {
+	resetOrigins(&b, true);
+	t3.start();
+	locate_events(b.sites, b.nsta, b.events, b.nev, &lp, &grid,
+			a->threads);
+	t3.stop();
+    }
+    benchReport("locate_events_grid", "synthetic", (double)b.nev, "events",
+		t3);
+
+    freeBulletin(&b);
+}
+
+/* Network magnitudes of 1000*scale origins, each with a detection
+ * amplitude at every station between 20 and 95 degrees, with calc_mags()
+ * one origin at a time, and with calc_mags_batch() on all threads.
+ */
+static void
+magnitudes(BenchArgs *a)
+{
+    BenchTimer t1, t2;
+    Mag_Params mp;
+    Site *sites;
+    Origin na_origin = Na_Origin_Init;
+    Assoc na_assoc = Na_Assoc_Init;
+    Mag_Event *events;
+    Amplitude *amp;
+    Assoc *assoc;
+    char *magtypes[1];
+    int i, j, k, n, nsta = NUM_SITES, nev = 1000*a->scale;
+    double lat, lon, delta, esaz, seaz;
+
+    if(a->tl_model.empty() || a->mdf.empty()) {
+	benchSkip("calc_mags", "synthetic", "no tlmodel= and mdf=");
+	return;
+    }
+    magtypes[0] = (char *)a->magtype.c_str();
+
+    if( !(sites = network(nsta)) ) return;
+
+    if(setup_mag_facilities((char *)a->tl_model.c_str(),
+		(char *)a->mdf.c_str(), magtypes, 1, sites, nsta) != OK)
+    {
+	benchSkip("calc_mags", "synthetic", "cannot read the TL tables");
+	free(sites);
+	return;
+    }
+
+    mp = initialize_mag_params();
+    mp.verbose = 0;
+    strcpy(mp.net, "BENCH");
+    snprintf(mp.magtype_to_origin_mb, sizeof(mp.magtype_to_origin_mb), "%s",
+		magtypes[0]);
+    mp.list_of_mb_magtypes = magtypes;
+    mp.num_mb_magtypes = 1;
+
+    events = (Mag_Event *)calloc(nev, sizeof(Mag_Event));
+    amp = (Amplitude *)calloc(nsta, sizeof(Amplitude));
+    assoc = (Assoc *)malloc(nsta*sizeof(Assoc));
+    if(!events || !amp || !assoc) {
+	Free(events); Free(amp); Free(assoc); free(sites);
+	return;
+    }
+
+    srand48(33);
+    for(i = 0; i < nev; i++)
+    {
+	Origin *o = (Origin *)malloc(sizeof(Origin));
+	if( !o ) break;
+
+	lat = 140.*drand48() - 70.;
+	lon = 360.*drand48() - 180.;
+	*o = na_origin;
+	o->orid = o->evid = i+1;
+	o->lat = lat;
+	o->lon = lon;
+	o->depth = 0.;
+	o->time = BULLETIN_TIME + i*3600.;
+
+	for(j = n = 0; j < nsta; j++)
+	{
+	    dist_azimuth(lat, lon, sites[j].lat, sites[j].lon, &delta, &esaz,
+			&seaz, 0);
+	    if(delta < 20. || delta > 95.) continue;
+
+	    assoc[n] = na_assoc;
+	    assoc[n].arid = n+1;
+	    assoc[n].orid = o->orid;
+	    strcpy(assoc[n].sta, sites[j].sta);
+	    strcpy(assoc[n].phase, "P");
+	    strcpy(assoc[n].timedef, "d");
+	    assoc[n].delta = delta;
+	    assoc[n].esaz = esaz;
+	    assoc[n].seaz = seaz;
+
+	    memset(&amp[n], 0, sizeof(Amplitude));
+	    amp[n].ampid = n+1;
+	    amp[n].arid = n+1;
+	    amp[n].parid = -1;
+	    strcpy(amp[n].chan, "sz");
+	    amp[n].amp = pow(10., 3.*drand48());
+	    amp[n].per = 1.;
+	    amp[n].snr = 10.;
+	    snprintf(amp[n].amptype, sizeof(amp[n].amptype), "%s",
+			a->amptype.c_str());
+	    n++;
+	}
+	events[i].origin = o;
+	events[i].num_magns = 1;
+	events[i].magn_ptr = build_mag_obj(magtypes, 1, o, NULL, 0, NULL, 0,
+			amp, n, NULL, 0, assoc, n, NULL, 0);
+    }
+    nev = i;
+
+    for(k = 0; k < a->reps; k++) {
+	t1.start();
+	for(i = 0; i < nev; i++) {
+	    calc_mags(events[i].magn_ptr, 1, events[i].origin, &mp);
+	}
+	t1.stop();
+    }
+    benchReport("calc_mags", "synthetic", (double)nev, "origins", t1);
+
+    for(k = 0; k < a->reps; k++) {
+	t2.start();
+	calc_mags_batch(events, nev, &mp, a->threads);
+	t2.stop();
+    }
+    benchReport("calc_mags_batch", "synthetic", (double)nev, "origins", t2);
+
+    for(i = 0; i < nev; i++) {
+	free_magnitudes(events[i].magn_ptr, 1);
+	Free(events[i].origin);
+    }
+    Free(events);
+    Free(amp);
+    Free(assoc);
+    free(sites);
+}
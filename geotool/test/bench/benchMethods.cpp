@@ -0,0 +1,562 @@
+/** \file benchMethods.cpp
+ *  \brief Times the filter, instrument, FK, beam, GTimeSeries and correlation
+ *  methods.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "bench.h"
+#include "cssio.h"
+#include "IIRFilter.h"
+#include "ConvolveData.h"
+#include "Response.h"
+#include "FKData.h"
+#include "Beam.h"
+#include "Waveform.h"
+#include "gobject++/CssTables.h"
+#include "gobject++/GTimeSeries.h"
+#ifdef HAVE_GSL
+#include "Correlation.h"
+#include "mccc.h"
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* The synthetic array: a center element and two rings, with a plane wave
+ * crossing it.
+ */
+#define ARRAY_STA	19
+#define ARRAY_LAT	50.
+#define ARRAY_LON	80.
+#define ARRAY_SLOW	.08	/* sec/km */
+#define ARRAY_BAZ	60.	/* degrees */
+#define ARRAY_DT	.025
+
+/* The number of templates of the correlate benchmark. */
+#define CORR_TEMPLATES	20
+
+static float *testData(BenchArgs *a, const char *prefix, int *npts,
+		double *tdel);
+static float *noise(int npts, double *v);
+static void elementOffset(int i, double *dn, double *de, double *delay);
+static float **makeArray(int npts);
+static void freeArray(float **x);
+static void makeWaveforms(int npts, gvector<Waveform *> &wvec,
+		vector<double> &t_lag);
+static void iirFilter(BenchArgs *a, const char *data, float *y, int npts,
+		double tdel);
+static void convolve(BenchArgs *a, int npts);
+static void fk(BenchArgs *a, gvector<Waveform *> &wvec);
+static void beam(BenchArgs *a, gvector<Waveform *> &wvec,
+		vector<double> &t_lag);
+static void tsAdd(BenchArgs *a, int npts);
+static void tsSubseries(BenchArgs *a, int npts);
+static void fftCorrelate(BenchArgs *a, int npts);
+static void correlate(BenchArgs *a, int npts);
+static void correlatePairs(BenchArgs *a, int npts);
+
+void
+benchMethods(BenchArgs *a)
+{
+    gvector<Waveform *> wvec;
+    vector<double> t_lag;
+    float *y;
+    int npts;
+    double tdel, v = 0.;
+
+    if(benchWanted(a, "iir_filter")) {
+	if( (y = testData(a, "ASAR", &npts, &tdel)) ) {
+	    iirFilter(a, "ASAR", y, npts, tdel);
+	    Free(y);
+	}
+	if( (y = testData(a, "DPRK_test", &npts, &tdel)) ) {
+	    iirFilter(a, "DPRK_test", y, npts, tdel);
+	    Free(y);
+	}
+	npts = 1000000*a->scale;
+	srand48(49);
+	if( (y = noise(npts, &v)) ) {
+	    iirFilter(a, "synthetic", y, npts, ARRAY_DT);
+	    Free(y);
+	}
+    }
+    if(benchWanted(a, "convolve")) convolve(a, 100000*a->scale);
+
+    if(benchWanted(a, "fk") || benchWanted(a, "beam")) {
+	/* ten minutes at 40 samples per second */
+	makeWaveforms(24000*a->scale, wvec, t_lag);
+	if(wvec.size() > 0) {
+	    if(benchWanted(a, "fk")) fk(a, wvec);
+	    if(benchWanted(a, "beam")) beam(a, wvec, t_lag);
+	}
+    }
+    if(benchWanted(a, "ts_add")) tsAdd(a, 1000000*a->scale);
+    if(benchWanted(a, "ts_subseries")) tsSubseries(a, 1000000*a->scale);
+    if(benchWanted(a, "correlate")) {
+	fftCorrelate(a, 100000*a->scale);
+	correlate(a, 100000*a->scale);
+	/* one minute at 40 samples per second */
+	correlatePairs(a, 2400*a->scale);
+    }
+}
+
+/* All the samples of the first waveform of a test_data wfdisc file. The
+ * waveforms of the test files have the same sample rate.
+ */
+static float *
+testData(BenchArgs *a, const char *prefix, int *npts, double *tdel)
+{
+    gvector<CssTableClass *> wf;
+    string file = a->data_dir + "/" + prefix + ".wfdisc";
+    const char *err_msg;
+    CssWfdiscClass *w;
+    double tbeg;
+    float *y;
+
+    if(CssTableClass::readFile(file, cssWfdisc, wf, &err_msg) < 0
+		|| wf.size() == 0)
+    {
+	benchSkip("iir_filter", prefix, "cannot read the wfdisc file");
+	return NULL;
+    }
+    w = (CssWfdiscClass *)wf[0];
+    if(cssioReadData(w, a->data_dir, w->time, w->endtime, 0, npts, &tbeg,
+		tdel, &y) < 0 || *npts <= 0)
+    {
+	benchSkip("iir_filter", prefix, "cssioReadData failed");
+	return NULL;
+    }
+    return y;
+}
+
+/* Band-limited noise. v holds the filter state between calls.
+ */
+static float *
+noise(int npts, double *v)
+{
+    float *y;
+
+    if( !(y = (float *)malloc(npts*sizeof(float))) ) return NULL;
+
+    for(int i = 0; i < npts; i++) {
+	*v = .9*(*v) + drand48() - .5;
+	y[i] = *v;
+    }
+    return y;
+}
+
+/* The north and east offsets (km) of element i of the synthetic array,
+ * and the delay (sec) of the plane wave at it. The center, 6 elements at
+ * 3 km and 12 at 8 km.
+ */
+static void
+elementOffset(int i, double *dn, double *de, double *delay)
+{
+    double baz = ARRAY_BAZ*M_PI/180.;
+
+    if(i == 0) {
+	*dn = *de = 0.;
+    }
+    else if(i <= 6) {
+	*dn = 3.*cos(i*M_PI/3.);
+	*de = 3.*sin(i*M_PI/3.);
+    }
+    else {
+	*dn = 8.*cos((i-6)*M_PI/6.);
+	*de = 8.*sin((i-6)*M_PI/6.);
+    }
+    /* the wave arrives from baz, so elements toward baz record it first.
+     */
+    *delay = -ARRAY_SLOW*((*de)*sin(baz) + (*dn)*cos(baz));
+}
+
+/* Make the synthetic array. Each element records the same noise and a
+ * wavelet, delayed by the plane wave, with its own noise added.
+ */
+static float **
+makeArray(int npts)
+{
+    int i, j, k, shift;
+    float *common, **x;
+    double v = 0., w = 0., dn, de, delay, t;
+
+    srand48(49);
+    if( !(x = (float **)calloc(ARRAY_STA, sizeof(float *))) ) return NULL;
+    if( !(common = noise(npts + 4000, &v)) ) {
+	free(x);
+	return NULL;
+    }
+    for(i = 0; i < ARRAY_STA; i++)
+    {
+	elementOffset(i, &dn, &de, &delay);
+	shift = (int)floor(delay/ARRAY_DT + .5);
+
+	if( !(x[i] = noise(npts, &w)) ) {
+	    freeArray(x);
+	    free(common);
+	    return NULL;
+	}
+	for(j = 0; j < npts; j++) {
+	    k = j - shift + 2000;
+	    x[i][j] = .2*x[i][j] + common[k];
+	    /* a 1 Hz wavelet at the middle of the trace */
+	    t = (j - shift - npts/2)*ARRAY_DT;
+	    if(fabs(t) < 3.) x[i][j] += 20.*exp(-t*t)*sin(2.*M_PI*t);
+	}
+    }
+    free(common);
+    return x;
+}
+
+static void
+freeArray(float **x)
+{
+    for(int i = 0; i < ARRAY_STA; i++) Free(x[i]);
+    free(x);
+}
+
+/* Make Waveforms of the synthetic array, with the station coordinates, and
+ * the lags that align the plane wave.
+ */
+static void
+makeWaveforms(int npts, gvector<Waveform *> &wvec, vector<double> &t_lag)
+{
+    int i;
+    float **x;
+    double dn, de, delay, tbeg = 1.e+09;
+    char sta[10];
+
+    if( !(x = makeArray(npts)) ) return;
+
+    for(i = 0; i < ARRAY_STA; i++)
+    {
+	elementOffset(i, &dn, &de, &delay);
+
+	GTimeSeries *ts = new GTimeSeries(
+		new GSegment(x[i], npts, tbeg, ARRAY_DT, 1., 1.));
+
+	snprintf(sta, sizeof(sta), "BK%02d", i);
+	ts->setSta(sta);
+	ts->setChan("sz");
+	ts->setNet("BK");
+	ts->setLat(ARRAY_LAT + dn/111.19);
+	ts->setLon(ARRAY_LON + de/(111.19*cos(ARRAY_LAT*M_PI/180.)));
+	ts->setElev(0.);
+	ts->setDnorth(dn);
+	ts->setDeast(de);
+
+	wvec.push_back(new Waveform(ts));
+	t_lag.push_back(-delay);
+    }
+    freeArray(x);
+}
+
+/* A 3-pole Butterworth band-pass, applied in place.
+ */
+static void
+iirFilter(BenchArgs *a, const char *data, float *y, int npts, double tdel)
+{
+    BenchTimer t;
+
+    try {
+	IIRFilter iir(3, "BP", 1., 5., tdel, 0);
+
+	for(int i = 0; i < a->reps; i++) {
+	    t.start();
+	    iir.applyMethod(y, npts, true);
+	    t.stop();
+	}
+    }
+    catch(...) {
+	benchSkip("iir_filter", data, "IIRFilter failed");
+	return;
+    }
+    benchReport("iir_filter", data, (double)npts, "samples", t);
+}
+
+/* Convolve with the response of a 1 Hz velocity seismometer, given as
+ * poles and zeros.
+ */
+static void
+convolve(BenchArgs *a, int npts)
+{
+    BenchTimer t;
+    float *y;
+    double v = 0.;
+    Response *resp;
+    ConvolveData *cd;
+    GTimeSeries *ts;
+
+    srand48(49);
+    if( !(y = noise(npts, &v)) ) return;
+
+    ts = new GTimeSeries(new GSegment(y, npts, 1.e+09, ARRAY_DT, 1., 1.));
+    free(y);
+
+    resp = new Response();
+    resp->source = "theoretical";
+    resp->type = "paz";
+    resp->input_units = "d";
+    resp->output_units = "v";
+    resp->npoles = 2;
+    resp->pole = (FComplex *)malloc(2*sizeof(FComplex));
+    resp->pole[0].re = -4.443; resp->pole[0].im =  4.443;
+    resp->pole[1].re = -4.443; resp->pole[1].im = -4.443;
+    resp->nzeros = 3;
+    resp->zero = (FComplex *)malloc(3*sizeof(FComplex));
+    memset(resp->zero, 0, 3*sizeof(FComplex));
+    resp->a0 = 1.;
+
+    cd = new ConvolveData(1, resp, "bench", 0., 0., 0., 1., 1., false);
+
+    for(int i = 0; i < a->reps; i++) {
+	t.start();
+	cd->applyMethod(ts);
+	t.stop();
+    }
+    benchReport("convolve", "synthetic", (double)npts, "samples", t);
+
+    cd->deleteObject();
+    ts->deleteObject();
+}
+
+/* One FK of 81 by 81 slownesses for 0.5 to 6 Hz over one minute at the
+ * wavelet.
+ */
+static void
+fk(BenchArgs *a, gvector<Waveform *> &wvec)
+{
+    BenchTimer t;
+    FKArgs args;
+    double tmid = .5*(wvec[0]->tbeg() + wvec[0]->tend());
+
+    args.num_bands = 1;
+    args.fmin[0] = .5;
+    args.fmax[0] = 6.;
+
+    for(int i = 0; i < a->reps; i++) {
+	try {
+	    t.start();
+	    FKData *fk = new FKData(wvec, tmid - 30., tmid + 30., args);
+	    t.stop();
+	    delete fk;
+	}
+	catch(...) {
+	    benchSkip("fk", "synthetic", "FKData failed");
+	    return;
+	}
+    }
+    benchReport("fk", "synthetic", 1., "fk", t);
+}
+
+/* Delay-and-sum beam of the whole array.
+ */
+static void
+beam(BenchArgs *a, gvector<Waveform *> &wvec, vector<double> &t_lag)
+{
+    BenchTimer t;
+    GTimeSeries *ts;
+    double n = (double)wvec.size()*wvec[0]->length();
+
+    for(int i = 0; i < a->reps; i++) {
+	t.start();
+	ts = Beam::BeamTimeSeries(wvec, t_lag, false);
+	t.stop();
+	if( !ts ) {
+	    benchSkip("beam", "synthetic", "BeamTimeSeries failed");
+	    return;
+	}
+	ts->deleteObject();
+    }
+    benchReport("beam", "synthetic", n, "samples", t);
+}
+
+/* Build a GTimeSeries from contiguous packets of 1000 samples, as a reader
+ * does. Each packet is joined to the segment before it.
+ */
+static void
+tsAdd(BenchArgs *a, int npts)
+{
+    BenchTimer t;
+    int i, j, n = 1000;
+    float *y;
+    double v = 0., tbeg = 1.e+09;
+
+    srand48(49);
+    if( !(y = noise(npts, &v)) ) return;
+
+    for(i = 0; i < a->reps; i++)
+    {
+	GTimeSeries *ts = new GTimeSeries();
+	t.start();
+	for(j = 0; j + n <= npts; j += n) {
+	    ts->addSegment(new GSegment(y+j, n, tbeg + j*ARRAY_DT, ARRAY_DT,
+				1., 1.));
+	}
+	t.stop();
+	if(ts->size() != 1) {
+	    benchSkip("ts_add", "synthetic", "the packets were not joined");
+	    ts->deleteObject();
+	    free(y);
+	    return;
+	}
+	ts->deleteObject();
+    }
+    benchReport("ts_add", "synthetic", (double)(npts/n)*n, "samples", t);
+    free(y);
+}
+
+/* Cut 100 windows of one percent from a GTimeSeries of 100 segments with
+ * gaps between them.
+ */
+static void
+tsSubseries(BenchArgs *a, int npts)
+{
+    BenchTimer t;
+    int i, j, n = npts/100;
+    float *y;
+    double v = 0., tbeg = 1.e+09, len, t1;
+    GTimeSeries *ts, *sub;
+
+    srand48(49);
+    if( !(y = noise(npts, &v)) ) return;
+
+    ts = new GTimeSeries();
+    for(j = 0; j < 100; j++) {
+	/* a gap of 10 samples after each segment */
+	ts->addSegment(new GSegment(y+j*n, n, tbeg + j*(n+10)*ARRAY_DT,
+			ARRAY_DT, 1., 1.));
+    }
+    free(y);
+    len = ts->duration();
+
+    for(i = 0; i < a->reps; i++) {
+	t.start();
+	for(j = 0; j < 100; j++) {
+	    t1 = ts->tbeg() + .0099*j*len;
+	    if( (sub = ts->subseries(t1, t1 + .01*len)) ) sub->deleteObject();
+	}
+	t.stop();
+    }
+    benchReport("ts_subseries", "synthetic", 100., "windows", t);
+    ts->deleteObject();
+}
+
+/* Correlate a 10 second template with a long trace by the Correlation
+ * plugin.
+ */
+static void
+fftCorrelate(BenchArgs *a, int npts)
+{
+#ifdef HAVE_GSL
+    BenchTimer t;
+    int nr = 400;
+    float *y, *c;
+    double v = 0.;
+
+    srand48(49);
+    if( !(y = noise(npts, &v)) ) return;
+    if( !(c = (float *)malloc((npts + nr - 1)*sizeof(float))) ) {
+	free(y);
+	return;
+    }
+    for(int i = 0; i < a->reps; i++) {
+	t.start();
+	libgcor::Correlation::fftCorrelate(y + npts/2, nr, y, npts, c,
+			libgcor::GLOBAL_MEAN);
+	t.stop();
+    }
+    benchReport("fft_correlate", "synthetic", (double)npts, "samples", t);
+    free(y);
+    free(c);
+#else
+    benchSkip("fft_correlate", "synthetic", "no libgsl");
+#endif
+}
+
+/* Correlate CORR_TEMPLATES templates of 10 seconds with a long trace by
+ * slidingCC.
+ */
+static void
+correlate(BenchArgs *a, int npts)
+{
+#ifdef HAVE_GSL
+    BenchTimer t;
+    int i, nwin = CORR_TEMPLATES, m = 400;
+    float *y, *x[CORR_TEMPLATES];
+    double v = 0., **c;
+
+    srand48(49);
+    if( !(y = noise(npts, &v)) ) return;
+    if( !(c = (double **)calloc(nwin, sizeof(double *))) ) {
+	free(y);
+	return;
+    }
+    for(i = 0; i < nwin; i++) {
+	x[i] = y + (int)((i/(double)nwin)*(npts - m));
+	if( !(c[i] = (double *)malloc((npts - m + 1)*sizeof(double))) ) break;
+    }
+    if(i == nwin) {
+	for(i = 0; i < a->reps; i++) {
+	    t.start();
+	    if(slidingCC(nwin, m, x, npts, y, a->threads, c)) {
+		t.stop();
+		benchSkip("correlate", "synthetic", "slidingCC failed");
+		break;
+	    }
+	    t.stop();
+	}
+	if(i == a->reps) {
+	    benchReport("correlate", "synthetic",
+			(double)nwin*(npts - m + 1), "lags", t);
+	}
+    }
+    for(i = 0; i < nwin; i++) Free(c[i]);
+    free(c);
+    free(y);
+#else
+    benchSkip("correlate", "synthetic", "no libgsl");
+#endif
+}
+
+/* Correlate all the pairs of the synthetic array traces by allPairsCC,
+ * within one second of lag.
+ */
+static void
+correlatePairs(BenchArgs *a, int npts)
+{
+#ifdef HAVE_GSL
+    BenchTimer t;
+    int i, max_lag = (int)(1./ARRAY_DT + .5);
+    float **x;
+    double *coef[ARRAY_STA], *lag[ARRAY_STA];
+    double buf[2*ARRAY_STA*ARRAY_STA];
+
+    if( !(x = makeArray(npts)) ) return;
+
+    for(i = 0; i < ARRAY_STA; i++) {
+	coef[i] = buf + i*ARRAY_STA;
+	lag[i] = buf + (ARRAY_STA + i)*ARRAY_STA;
+    }
+    for(i = 0; i < a->reps; i++) {
+	t.start();
+	if(allPairsCC(ARRAY_STA, npts, x, max_lag, a->threads, coef, lag)) {
+	    t.stop();
+	    benchSkip("correlate_pairs", "synthetic", "allPairsCC failed");
+	    freeArray(x);
+	    return;
+	}
+	t.stop();
+    }
+    benchReport("correlate_pairs", "synthetic",
+		(double)ARRAY_STA*(ARRAY_STA-1)/2, "pairs", t);
+    freeArray(x);
+#else
+    benchSkip("correlate_pairs", "synthetic", "no libgsl");
+#endif
+}
@@ -0,0 +1,401 @@
+/** \file benchRead.cpp
+ *  \brief Times the waveform readers, the css table reader and the ca
+ *  decoder.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+#include "bench.h"
+#include "cssio.h"
+#include "GseSource.h"
+#include "SeedToCss.h"
+#include "gobject++/CssTables.h"
+#include "gobject++/SegmentInfo.h"
+extern "C" {
+#include "canada_compress.h"
+}
+
+static void wfdiscRead(BenchArgs *a, const char *prefix);
+static void wfdiscSynthetic(BenchArgs *a);
+static void timeWfdiscs(BenchArgs *a, const char *name, const char *data,
+		const string &working_dir, gvector<CssTableClass *> &wf,
+		double window);
+static void gseRead(BenchArgs *a);
+static void seedRead(BenchArgs *a);
+static void tableRead(BenchArgs *a, const char *prefix);
+static void tableSynthetic(BenchArgs *a);
+static void timeTable(BenchArgs *a, const char *data, const string &file);
+static void caDecode(BenchArgs *a);
+
+/* Samples per second of the synthetic traces and wfdisc rows. */
+#define BENCH_SAMPRATE	40.
+
+void
+benchRead(BenchArgs *a)
+{
+    if(benchWanted(a, "wfdisc_read")) {
+	wfdiscRead(a, "ASAR");
+	wfdiscRead(a, "DPRK_test");
+	wfdiscSynthetic(a);
+    }
+    if(benchWanted(a, "gse_read")) gseRead(a);
+    if(benchWanted(a, "seed_read")) seedRead(a);
+    if(benchWanted(a, "table_read")) {
+	tableRead(a, "ASAR");
+	tableRead(a, "DPRK_test");
+	tableSynthetic(a);
+    }
+    if(benchWanted(a, "ca_decode")) caDecode(a);
+}
+
+/* Read all the waveforms of a test_data wfdisc file.
+ */
+static void
+wfdiscRead(BenchArgs *a, const char *prefix)
+{
+    gvector<CssTableClass *> wf;
+    string file = a->data_dir + "/" + prefix + ".wfdisc";
+    const char *err_msg;
+
+    if(CssTableClass::readFile(file, cssWfdisc, wf, &err_msg) < 0
+		|| wf.size() == 0)
+    {
+	benchSkip("wfdisc_read", prefix, "cannot read the wfdisc file");
+	return;
+    }
+    timeWfdiscs(a, "wfdisc_read", prefix, a->data_dir, wf, 0.);
+}
+
+/* Write s4 waveforms of scale*10^6 samples in all and read them whole and
+ * in windows of one percent.
+ */
+static void
+wfdiscSynthetic(BenchArgs *a)
+{
+    gvector<CssTableClass *> wf;
+    char path[MAXPATHLEN+1];
+    const char *tmpdir;
+    int i, j, fd, nsta = 10, nsamp = 100000*a->scale;
+    int32_t *buf;
+    double v = 0.;
+
+    if( !(tmpdir = getenv("TMPDIR")) ) tmpdir = "/tmp";
+    snprintf(path, sizeof(path), "%s/benchXXXXXX", tmpdir);
+    if((fd = mkstemp(path)) < 0) {
+	benchSkip("wfdisc_read", "synthetic", "cannot create a tmp file");
+	return;
+    }
+    if( !(buf = (int32_t *)malloc(nsamp*sizeof(int32_t))) ) {
+	close(fd);
+	unlink(path);
+	return;
+    }
+    srand48(49);
+
+    for(i = 0; i < nsta; i++)
+    {
+	CssWfdiscClass *w = new CssWfdiscClass();
+
+	for(j = 0; j < nsamp; j++) {
+	    v = .99*v + 1000.*(drand48() - .5);
+	    buf[j] = htonl((int32_t)v);
+	}
+	if(write(fd, buf, nsamp*sizeof(int32_t)) != (ssize_t)(nsamp*sizeof(int32_t))) {
+	    benchSkip("wfdisc_read", "synthetic", "cannot write a tmp file");
+	    delete w;
+	    free(buf);
+	    close(fd);
+	    unlink(path);
+	    return;
+	}
+	snprintf(w->sta, sizeof(w->sta), "B%02d", i);
+	strcpy(w->chan, "sz");
+	w->time = 1.e+09;
+	w->nsamp = nsamp;
+	w->samprate = BENCH_SAMPRATE;
+	w->endtime = w->time + (nsamp-1)/w->samprate;
+	strcpy(w->datatype, "s4");
+	snprintf(w->dir, sizeof(w->dir), "%s", tmpdir);
+	snprintf(w->dfile, sizeof(w->dfile), "%s", path + strlen(tmpdir) + 1);
+	w->foff = (long)i*nsamp*sizeof(int32_t);
+	wf.push_back(w);
+    }
+    free(buf);
+    close(fd);
+
+    timeWfdiscs(a, "wfdisc_read", "synthetic", ".", wf, 0.);
+    timeWfdiscs(a, "wfdisc_window", "synthetic", ".", wf, .01);
+
+    unlink(path);
+}
+
+/* Read each waveform whole, or if window > 0, in 10 windows of that
+ * fraction of the waveform, spread over its length.
+ */
+static void
+timeWfdiscs(BenchArgs *a, const char *name, const char *data,
+		const string &working_dir, gvector<CssTableClass *> &wf,
+		double window)
+{
+    BenchTimer t;
+    int i, j, k, npts;
+    float *y;
+    double n = 0., tbeg, tdel, t1, t2;
+
+    for(i = 0; i < a->reps; i++)
+    {
+	n = 0.;
+	t.start();
+	for(j = 0; j < (int)wf.size(); j++)
+	{
+	    CssWfdiscClass *w = (CssWfdiscClass *)wf[j];
+	    double len = w->endtime - w->time;
+
+	    for(k = 0; k < (window > 0. ? 10 : 1); k++)
+	    {
+		if(window > 0.) {
+		    t1 = w->time + k*.1*len;
+		    t2 = t1 + window*len;
+		}
+		else {
+		    t1 = w->time;
+		    t2 = w->endtime;
+		}
+		if(cssioReadData(w, working_dir, t1, t2, 0, &npts, &tbeg,
+				&tdel, &y) < 0)
+		{
+		    t.stop();
+		    benchSkip(name, data, "cssioReadData failed");
+		    return;
+		}
+		Free(y);
+		n += npts;
+	    }
+	}
+	t.stop();
+    }
+    benchReport(name, data, n, "samples", t);
+}
+
+/* Index a GSE2.0 file and read all its waveforms.
+ */
+static void
+gseRead(BenchArgs *a)
+{
+    BenchTimer t;
+    struct stat buf;
+    const char *err_msg = NULL;
+    double n = 0.;
+    GTimeSeries *ts;
+
+    if(stat(a->gse_file.c_str(), &buf)) {
+	benchSkip("gse_read", "20183590.gse", "no GSE file");
+	return;
+    }
+    GseSource *gse = new GseSource("bench", a->gse_file);
+
+    for(int i = 0; i < a->reps; i++)
+    {
+	gvector<SegmentInfo *> *segs;
+
+	n = 0.;
+	t.start();
+	if( !(segs = gse->getSegmentList()) ) {
+	    t.stop();
+	    benchSkip("gse_read", "20183590.gse", "cannot read the GSE file");
+	    delete gse;
+	    return;
+	}
+	for(int j = 0; j < (int)segs->size(); j++) {
+	    SegmentInfo *s = segs->at(j);
+	    if(gse->makeTimeSeries(s, s->start, s->end, 0, &ts, &err_msg)) {
+		n += ts->length();
+		ts->deleteObject();
+	    }
+	}
+	t.stop();
+	delete segs;
+    }
+    delete gse;
+    benchReport("gse_read", "20183590.gse", n, "samples", t);
+}
+
+/* Read all the waveforms of a SEED volume.
+ */
+static void
+seedRead(BenchArgs *a)
+{
+    BenchTimer t;
+    double n = 0.;
+
+    if(a->seed_file.empty()) {
+	benchSkip("seed_read", "-", "no seed= file");
+	return;
+    }
+    for(int i = 0; i < a->reps; i++)
+    {
+	cvector<CssWfdiscClass> wfdiscs;
+	vector<GSegment *> segments;
+
+	n = 0.;
+	t.start();
+	if( !SeedToCss::getWaveforms(a->seed_file, wfdiscs, segments) ) {
+	    t.stop();
+	    benchSkip("seed_read", "seed", "cannot read the SEED file");
+	    return;
+	}
+	for(int j = 0; j < (int)segments.size(); j++) {
+	    n += segments[j]->length();
+	    delete segments[j];
+	}
+	t.stop();
+    }
+    benchReport("seed_read", "seed", n, "samples", t);
+}
+
+/* Read the wfdisc file of a test_data set.
+ */
+static void
+tableRead(BenchArgs *a, const char *prefix)
+{
+    timeTable(a, prefix, a->data_dir + "/" + prefix + ".wfdisc");
+}
+
+/* Write a wfdisc file of scale*10^4 rows and read it.
+ */
+static void
+tableSynthetic(BenchArgs *a)
+{
+    char path[MAXPATHLEN+1];
+    const char *tmpdir, *err_msg = NULL;
+    int i, fd, nrows = 10000*a->scale;
+    FILE *fp;
+    CssWfdiscClass *w;
+
+    if( !(tmpdir = getenv("TMPDIR")) ) tmpdir = "/tmp";
+    snprintf(path, sizeof(path), "%s/benchXXXXXX", tmpdir);
+    if((fd = mkstemp(path)) < 0) {
+	benchSkip("table_read", "synthetic", "cannot create a tmp file");
+	return;
+    }
+    if( !(fp = fdopen(fd, "w")) ) {
+	benchSkip("table_read", "synthetic", "cannot open a tmp file");
+	close(fd);
+	unlink(path);
+	return;
+    }
+    w = new CssWfdiscClass();
+    w->nsamp = 864000;
+    w->samprate = BENCH_SAMPRATE;
+    strcpy(w->chan, "sz");
+    strcpy(w->datatype, "s4");
+    strcpy(w->dir, ".");
+
+    for(i = 0; i < nrows; i++) {
+	snprintf(w->sta, sizeof(w->sta), "B%02d", i%100);
+	w->wfid = i + 1;
+	w->time = 1.e+09 + (i/100)*86400.;
+	w->endtime = w->time + (w->nsamp-1)/w->samprate;
+	snprintf(w->dfile, sizeof(w->dfile), "B%02d.w", i%100);
+	w->foff = (long)(i/100)*w->nsamp*4;
+	if(w->write(fp, &err_msg)) break;
+    }
+    delete w;
+    if(fclose(fp) || i < nrows) {
+	benchSkip("table_read", "synthetic", "cannot write a tmp file");
+	unlink(path);
+	return;
+    }
+    timeTable(a, "synthetic", path);
+
+    unlink(path);
+}
+
+/* Read all the rows of a wfdisc file.
+ */
+static void
+timeTable(BenchArgs *a, const char *data, const string &file)
+{
+    BenchTimer t;
+    const char *err_msg;
+    double n = 0.;
+
+    for(int i = 0; i < a->reps; i++)
+    {
+	gvector<CssTableClass *> wf;
+
+	t.start();
+	if(CssTableClass::readFile(file, cssWfdisc, wf, &err_msg) < 0
+		|| wf.size() == 0)
+	{
+	    t.stop();
+	    benchSkip("table_read", data, "cannot read the wfdisc file");
+	    return;
+	}
+	t.stop();
+	n = (double)wf.size();
+    }
+    benchReport("table_read", data, n, "rows", t);
+}
+
+/* Decode a ca record of scale*10^6 samples whole, and decode 100 windows
+ * of 1000 samples from it.
+ */
+static void
+caDecode(BenchArgs *a)
+{
+    BenchTimer t1, t2;
+    int i, j, m, nb, nn;
+    uint32_t *y, v0;
+    int32_t *out;
+    unsigned char *b;
+    double v = 0.;
+
+    m = 1000000*a->scale;
+    y = (uint32_t *)malloc((m+1)*sizeof(uint32_t));
+    out = (int32_t *)malloc((m+1)*sizeof(int32_t));
+    b = (unsigned char *)malloc(5*m + 100);
+    if(!y || !out || !b) {
+	Free(y); Free(out); Free(b);
+	return;
+    }
+    srand48(48);
+    for(i = 0; i < m; i++) {
+	v = .99*v + 10000.*(drand48() - .5);
+	y[i] = (uint32_t)(int32_t)v;
+    }
+    v0 = y[m-1];
+    if(canada_compress(b, y, &nb, m, &v0) != CANCOMP_SUCCESS) {
+	benchSkip("ca_decode", "synthetic", "canada_compress failed");
+	Free(y); Free(out); Free(b);
+	return;
+    }
+
+    for(i = 0; i < a->reps; i++) {
+	nn = nb;
+	t1.start();
+	canada_uncompress(b, y, &nn, m, &v0);
+	t1.stop();
+    }
+    benchReport("ca_decode", "synthetic", (double)m, "samples", t1);
+
+    for(i = 0; i < a->reps; i++) {
+	t2.start();
+	for(j = 0; j < 100; j++) {
+	    canada_uncompress_window(b, nb, m, (int)((j/100.)*(m-1000)),
+			1000, out);
+	}
+	t2.stop();
+    }
+    benchReport("ca_decode_window", "synthetic", 100., "windows", t2);
+
+    Free(y); Free(out); Free(b);
+}